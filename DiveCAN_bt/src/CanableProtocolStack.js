@@ -59,6 +59,7 @@ export class CanableProtocolStack {
     this._uds.on('response', r => this.emit('udsResponse', r));
     this._uds.on('negativeResponse', r => this.emit('udsNegativeResponse', r));
     this._uds.on('logMessage', m => this.emit('logMessage', m));
+    this._uds.on('logTail', r => this.emit('logTail', r));
     this._uds.on('unsolicitedMessage', m => this.emit('unsolicitedMessage', m));
     this._ota.on('progress', p => this.emit('otaProgress', p));
     this._ota.on('staged', p => this.emit('otaStaged', p));
@@ -179,6 +179,7 @@ export class DiveCANProtocolStack extends EventEmitter {
 
     // Forward log streaming events
     this._uds.on('logMessage', (message) => this.emit('logMessage', message));
+    this._uds.on('logTail', (records) => this.emit('logTail', records));
     this._uds.on('unsolicitedMessage', (data) => this.emit('unsolicitedMessage', data));
 
     // Forward feature-manager events (OTA staging + log download progress)
@@ -5,7 +5,8 @@
  * (Test Rig/tests/test_dut_ota.py, dut.py:887-1025):
  *
  *   0x10 0x02 (programming session, surface only)
- *   -> 0x34 RequestDownload (size BIG-endian; erases slot1)
+ *   -> 0x34 RequestDownload (size BIG-endian; erases slot1, or on erase-ahead
+ *      heads leaves the erase to the transfer and answers at once)
  *   -> 0x36 TransferData x N (seq from 1, wrap & 0xFF)
  *   -> 0x37 RequestTransferExit (header-check slot1)
  *   -> 0x31 0x01 0xF001 activate (full SHA-256, boot_request_upgrade(TEST), reboot)
@@ -45,9 +46,9 @@ class EventEmitter {
 /** Default per-step timeouts (ms). Deliberately generous — see dut.py notes. */
 export const OTA_TIMEOUTS = {
   session: 8000,   // programming-session entry acks slowly (~2-3 s)
-  download: 30000, // 0x34 erases all of slot1 up front
+  download: 30000, // 0x34 erases all of slot1 up front (heads without erase-ahead)
   transfer: 15000, // first blocks lag while the flash-log writer flushes
-  exit: 10000,
+  exit: 10000,     // erase-ahead heads blank the rest of slot1 here; 0x78 keeps it alive
   activate: 12000,
   management: 8000
 };
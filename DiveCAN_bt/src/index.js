@@ -35,15 +35,17 @@ export {
   LOG_PROGRESS_INTERVAL_MS,
   LOG_PROGRESS_MIN_BYTES,
   LOG_RETRY_DEFAULTS,
-  LOG_TIMEOUTS
+  LOG_TIMEOUTS,
+  recordTypeMask
 } from './logs/LogDownloader.js';
 export { MemoryLogDownloadStore, OPFSLogDownloadStore } from './logs/LogDownloadStore.js';
 export {
   parseLogStream, parseDclgHeader, decodeRecord, makeRecordCounter,
+  inflateLogStream, createLzInflater,
   decodeBootMarker, decodeDiveMarker, decodeCanFrame, decodeLogText, decodeConsensus,
   decodePidSnapshot, decodeSolenoidFire, decodeSolenoidCurrent,
   decodeCellDiveO2, decodeCellO2S, decodeCellAnalog,
-  decodeErrorEvent, decodeDropMarker,
+  decodeErrorEvent, decodeDropMarker, decodeAggregate,
   unpackConsensusStatus, consensusStatusArray, consensusIncludeArray,
   PPO2_CBAR_PER_BAR, MILLIVOLT_LSB_PER_MV, DIVEO2_TEMP_LSB_PER_DEGC,
   DIVEO2_PRESSURE_LSB_PER_MBAR, DIVEO2_HUMIDITY_LSB_PER_PCT, MBAR_PER_METRE
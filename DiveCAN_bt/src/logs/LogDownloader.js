@@ -3,14 +3,27 @@
  *
  * Download sequence (one per selection):
  *
- *   0x31 0x01 <selector RID> <params>   (resolve a range: all / boot / dive)
- *   -> 0x31 0x01 0xF105                  (BeginStream)
+ *   0x31 0x01 <selector RID> <params>   (resolve a range: all / boot / dive / time)
+ *   -> 0x31 0x01 0xF105 [type_mask [bucket_s]]  (BeginStream, optionally filtered/decimated)
  *   -> 0x34 RequestDownload, sentinel addr 0xFFFFFFFE, size = max_chunk (LE)
  *   -> 0x36 TransferData x N             (seq from 1, wrap SKIPPING 0)
  *   -> 0x37 RequestTransferExit
  *
  * A chunk shorter than the negotiated block ends the stream. The result is a
- * 16-byte DCLG header + concatenated TLV records (parse with LogParser).
+ * 16-byte DCLG header + concatenated TLV records (parse with LogParser). With
+ * `compress` the 0x34 dataFormatIdentifier asks the head for an LZSS body; the
+ * stored bytes stay compressed and every LogParser entry point inflates them.
+ * With `types` the head sends only those record types (plus markers), already
+ * unpacked from their batch containers, behind a 24-byte header. With
+ * `decimateSeconds` consensus, cell raw and power records arrive as one
+ * AGGREGATE record (min/mean/max) per source and bucket instead.
+ *
+ * downloadLogResumable() continues a broken raw transfer from the head's
+ * resume token (DID 0xF285 -> RID 0xF107) when it has one, and otherwise
+ * restarts the selection and verifies the replayed prefix.
+ *
+ * startLiveTail() subscribes to the head's live tail instead: selected record
+ * types are pushed as they are logged, with no download cycle.
  *
  * "Download all" (downloadAll) uses the head's RID_SELECT_ALL selector, which
  * resolves the entire resident ring in one WALK-FREE selection: the complete
@@ -136,6 +149,41 @@ class StorePrefixVerifier {
   }
 }
 
+/**
+ * BeginStream record-type mask: bit t keeps record type t (FL_TYPE_*, below
+ * 64). Markers always pass on the head, so they need not be listed.
+ * @param {number[]} types
+ * @returns {bigint}
+ */
+export function recordTypeMask(types) {
+  let mask = 0n;
+  for (const type of types) {
+    if (!Number.isInteger(type) || type < 0 || type > 63) {
+      throw new RangeError(`Record type ${type} cannot be filtered`);
+    }
+    mask |= 1n << BigInt(type);
+  }
+  return mask;
+}
+
+/** Every record type the head can filter on (decimation without `types`). */
+const ALL_RECORD_TYPES = (1n << 64n) - 1n;
+
+/** BeginStream [typeMask, bucketSeconds] for download `opts`. */
+function beginStreamParams(opts) {
+  const decimate = opts.decimateSeconds ?? null;
+  let typeMask = opts.types ? recordTypeMask(opts.types) : null;
+  if (decimate !== null && typeMask === null) typeMask = ALL_RECORD_TYPES;
+  return [typeMask, decimate];
+}
+
+/** Bytes before the first record of a DCLG stream starting with `header`. */
+function dclgHeaderLength(header) {
+  return (header[5] & constants.LOG_DCLG_FLAG_FILTERED) !== 0
+    ? constants.LOG_DCLG_HEADER_LEN + constants.LOG_DCLG_MASK_LEN
+    : constants.LOG_DCLG_HEADER_LEN;
+}
+
 function decodeFcbStats(b) {
   const bootIdOldest = ByteUtils.leToUint32(b.slice(4, 8));
   const diveIdLatest = ByteUtils.leToUint16(b.slice(8, 10));
@@ -158,7 +206,9 @@ export class LogDownloader extends EventEmitter {
   /**
    * @param {import('../uds/UDSClient.js').UDSClient} uds
    * @param {Object} [options]
-   * @param {number} [options.maxChunk] - Client max receivable block (default BLE 61)
+   * @param {number} [options.maxChunk] - Client max receivable block (default BLE 61;
+   *   a direct-CAN transport may ask for up to LOG_DOWNLOAD_EXT_MAX_BLOCK)
+   * @param {boolean} [options.compress=false] - Request the compressed body
    * @param {Object} [options.timeouts] - Override LOG_TIMEOUTS
    */
   constructor(uds, options = {}) {
@@ -167,6 +217,7 @@ export class LogDownloader extends EventEmitter {
     this.options = options;
     this.timeouts = { ...LOG_TIMEOUTS, ...options.timeouts };
     this.maxChunk = options.maxChunk ?? constants.LOG_DOWNLOAD_BLE_CHUNK;
+    this.compress = options.compress ?? false;
   }
 
   // -------- management reads/writes --------
@@ -195,6 +246,19 @@ export class LogDownloader extends EventEmitter {
     };
   }
 
+  /** DID 0xF285 -> the head's checkpoint of its last raw download
+   * ({bytes} is the opaque token, {bodyOffset} the body bytes before it). */
+  async readResumeToken() {
+    const d = await this.uds.readDataByIdentifier(constants.DID_LOG_RESUME_TOKEN);
+    if (!d || d.length < constants.LOG_RESUME_TOKEN_LEN) return null;
+    const off = constants.LOG_RESUME_TOKEN_BODY_OFF;
+    return {
+      bytes: d.slice(0, constants.LOG_RESUME_TOKEN_LEN),
+      stream: d[0],
+      bodyOffset: ByteUtils.leToUint32(d.slice(off, off + 4))
+    };
+  }
+
   /** DID 0xF283 -> text-log verbosity (1=ERR..4=DBG). */
   async readVerbosity() {
     const d = await this.uds.readDataByIdentifier(constants.DID_LOG_VERBOSITY);
@@ -235,6 +299,18 @@ export class LogDownloader extends EventEmitter {
       [stream, ...ByteUtils.uint16ToLE(diveNumber)], this.timeouts.selector);
   }
 
+  /**
+   * Select one boot's entries stamped inside [startUs, endUs] (ts_boot_us,
+   * microseconds since that boot). The head seeks to the window, so a short
+   * window late in a long boot downloads without the boot's earlier sectors.
+   * Pass endUs = 0xFFFFFFFFFFFFFFFFn for an open-ended window.
+   */
+  selectByTimeRange(bootId, startUs, endUs, stream = constants.LOG_STREAM_TELEMETRY) {
+    return this.uds.routineControl(constants.LOG_RID_SELECT_BY_RANGE,
+      [stream, ...ByteUtils.uint32ToLE(bootId), ...ByteUtils.uint64ToLE(startUs),
+        ...ByteUtils.uint64ToLE(endUs)], this.timeouts.selector);
+  }
+
   selectLatestBoot(stream = constants.LOG_STREAM_TELEMETRY) {
     return this.uds.routineControl(constants.LOG_RID_SELECT_LATEST_BOOT,
       [stream], this.timeouts.selector);
@@ -255,8 +331,79 @@ export class LogDownloader extends EventEmitter {
       [stream], this.timeouts.selector);
   }
 
-  beginStream() {
-    return this.uds.routineControl(constants.LOG_RID_BEGIN_STREAM, [], this.timeouts.beginStream);
+  /**
+   * Select the rest of an interrupted raw download from its resume token
+   * (see readResumeToken). Walk-free, like selectAll.
+   * @param {Uint8Array} token - the 28-byte token
+   */
+  selectResume(token) {
+    return this.uds.routineControl(constants.LOG_RID_SELECT_RESUME,
+      [...token], this.timeouts.selector);
+  }
+
+  /**
+   * Arm the selected range for download.
+   * @param {bigint|null} [typeMask] - keep only these record types (see
+   *   recordTypeMask); null streams every entry.
+   * @param {number|null} [bucketSeconds] - decimate into buckets of this many
+   *   seconds (1..3600); needs a typeMask.
+   */
+  beginStream(typeMask = null, bucketSeconds = null) {
+    const params = typeMask === null ? [] : [...ByteUtils.uint64ToLE(typeMask)];
+    if (bucketSeconds !== null) {
+      if (typeMask === null) throw new TypeError('Decimation needs a record-type mask');
+      if (!Number.isInteger(bucketSeconds) || bucketSeconds < 1 || bucketSeconds > constants.LOG_DECIMATE_MAX_S) {
+        throw new RangeError(`Decimation bucket ${bucketSeconds} s is out of range`);
+      }
+      params.push(bucketSeconds & 0xFF, bucketSeconds >> 8);
+    }
+    return this.uds.routineControl(constants.LOG_RID_BEGIN_STREAM, params, this.timeouts.beginStream);
+  }
+
+  // -------- live tail --------
+
+  /**
+   * Subscribe to the head's live tail (RID 0xF108): records of `types` are
+   * pushed as they are logged (DID 0xA101) and re-emitted here, parsed, as
+   * 'tailRecords'. The head drops a subscription that is not renewed within
+   * LOG_TAIL_LEASE_MS, so it is re-sent every LOG_TAIL_RENEW_MS until
+   * stopLiveTail(); a failed renewal is emitted as 'tailError'. Calling again
+   * changes the types or budget.
+   * @param {number[]} types - FL_TYPE_* values to tail
+   * @param {Object} [opts]
+   * @param {number} [opts.budgetBps=0] - bytes/s, LOG_TAIL_BUDGET_MIN..MAX;
+   *   0 uses the head's default
+   */
+  async startLiveTail(types, opts = {}) {
+    const budget = opts.budgetBps ?? 0;
+    if (!types.length) throw new RangeError('Live tail needs at least one record type');
+    if (!Number.isInteger(budget) || (budget !== 0 &&
+        (budget < constants.LOG_TAIL_BUDGET_MIN || budget > constants.LOG_TAIL_BUDGET_MAX))) {
+      throw new RangeError(`Live-tail budget ${budget} B/s is out of range`);
+    }
+    const params = [...ByteUtils.uint64ToLE(recordTypeMask(types)), budget & 0xFF, budget >> 8];
+    await this.uds.routineControl(constants.LOG_RID_LIVE_TAIL, params);
+
+    if (!this._tail) {
+      const onTail = (payload) => this.emit('tailRecords', parseLogStream(payload));
+      this.uds.on('logTail', onTail);
+      this._tail = { onTail, timer: null };
+    }
+    clearInterval(this._tail.timer);
+    this._tail.timer = setInterval(() => {
+      this.uds.routineControl(constants.LOG_RID_LIVE_TAIL, params)
+        .catch((error) => this.emit('tailError', error));
+    }, constants.LOG_TAIL_RENEW_MS);
+  }
+
+  /** End the live tail (an all-zero mask) and stop renewing it. */
+  async stopLiveTail() {
+    if (this._tail) {
+      clearInterval(this._tail.timer);
+      this.uds.off('logTail', this._tail.onTail);
+      this._tail = null;
+    }
+    await this.uds.routineControl(constants.LOG_RID_LIVE_TAIL, new Array(8).fill(0));
   }
 
   /**
@@ -439,8 +586,7 @@ export class LogDownloader extends EventEmitter {
   }
 
   /** Find a unique byte sequence in the saved record stream using bounded reads. */
-  async _findStoredAnchor(store, total, needle) {
-    const firstOffset = constants.LOG_DCLG_HEADER_LEN;
+  async _findStoredAnchor(store, total, needle, firstOffset) {
     const lastOffset = total - needle.length;
     if (lastOffset < firstOffset) return null;
     let match = null;
@@ -481,7 +627,7 @@ export class LogDownloader extends EventEmitter {
     for (let i = 0; exact && i < exactLength; i++) exact = savedStart[i] === firstBody[i];
     if (exact) return { bodyOffset: 0, storedOffset: 0, reconciledFrom: 0 };
 
-    const headerLength = constants.LOG_DCLG_HEADER_LEN;
+    const headerLength = dclgHeaderLength(firstBody);
     const anchorLength = Math.min(LOG_RESUME_ANCHOR_BYTES, firstBody.length - headerLength);
     if (anchorLength < LOG_RESUME_MIN_ANCHOR_BYTES) {
       throw new LogResumeMismatchError(
@@ -489,10 +635,12 @@ export class LogDownloader extends EventEmitter {
         { availableAnchorBytes: Math.max(0, anchorLength), minimumAnchorBytes: LOG_RESUME_MIN_ANCHOR_BYTES });
     }
 
-    // Magic/version/flags/stream/reserved must describe the same stream. The
-    // two estimate fields may legitimately differ after selector re-resolution.
-    const savedHeader = await store.read(0, 8);
-    for (let i = 0; i < 8; i++) {
+    // Magic/version/flags/stream/codec (and a filter's type mask) must
+    // describe the same stream. The two estimate fields may legitimately
+    // differ after selector re-resolution.
+    const savedHeader = await store.read(0, headerLength);
+    for (let i = 0; i < headerLength; i++) {
+      if (i >= 8 && i < constants.LOG_DCLG_HEADER_LEN) continue;
       if (savedHeader[i] !== firstBody[i]) {
         throw new LogResumeMismatchError('Retried data is not the same DCLG stream', {
           offset: i, expected: savedHeader[i], actual: firstBody[i]
@@ -500,8 +648,15 @@ export class LogDownloader extends EventEmitter {
       }
     }
 
+    // A compressed body has no record boundaries to anchor on: the same
+    // records encode differently once the ring's oldest bytes move.
+    if ((firstBody[5] & constants.LOG_DCLG_FLAG_LZ) !== 0) {
+      throw new LogResumeMismatchError(
+        'Retried compressed ring changed; restart the download', { resumeBytes });
+    }
+
     const anchor = firstBody.subarray(headerLength, headerLength + anchorLength);
-    const storedOffset = await this._findStoredAnchor(store, resumeBytes, anchor);
+    const storedOffset = await this._findStoredAnchor(store, resumeBytes, anchor, headerLength);
     if (storedOffset === null) {
       throw new LogResumeMismatchError(
         'Retried ring cannot be reconciled with the saved partial log',
@@ -556,7 +711,11 @@ export class LogDownloader extends EventEmitter {
       if (store) {
         let bodyOffset = 0;
         if (transferred === 0 && resumeBytes > 0) {
-          const replay = await this._prepareStoredReplay(store, resumeBytes, body);
+          // A token resume continues the saved body at a known offset; a
+          // restarted selection has to be reconciled with the saved prefix.
+          const replay = io.resumeAt == null
+            ? await this._prepareStoredReplay(store, resumeBytes, body)
+            : { bodyOffset: dclgHeaderLength(body), storedOffset: io.resumeAt, reconciledFrom: io.resumeAt };
           bodyOffset = replay.bodyOffset;
           replayStoredOffset = replay.storedOffset;
           reconciledFrom = replay.reconciledFrom;
@@ -643,17 +802,21 @@ export class LogDownloader extends EventEmitter {
   async _downloadAttempt(opts, io = {}) {
     const stream = opts.stream ?? constants.LOG_STREAM_TELEMETRY;
     const maxChunk = opts.maxChunk ?? this.maxChunk;
+    const dataFormat = (opts.compress ?? this.compress)
+      ? constants.LOG_DOWNLOAD_DATA_FMT_LZ
+      : constants.LOG_DOWNLOAD_DATA_FMT_RAW;
 
     // 1. Resolve a range.
     await this._runSelector(opts, stream);
     const { selector, entryCount } = await this._readSelectorEstimate();
 
     // 2. Arm the stream.
-    await this.beginStream();
+    await this.beginStream(...beginStreamParams(opts));
 
     // 3. RequestDownload with the sentinel addr (LE) + client max_chunk (LE size).
     const negotiatedBlock = await this.uds.requestDownload(
-      constants.LOG_DOWNLOAD_SENTINEL_ADDR, maxChunk, { sizeEndian: 'LE' }, this.timeouts.block);
+      constants.LOG_DOWNLOAD_SENTINEL_ADDR, maxChunk, { sizeEndian: 'LE', dataFormat },
+      this.timeouts.block);
 
     // 4. Pull until the head sends a short end-of-stream block. Always attempt
     // 0x37, but after a failed pull use a short cleanup timeout so a rebooted
@@ -703,6 +866,50 @@ export class LogDownloader extends EventEmitter {
     });
   }
 
+  /**
+   * Where a saved raw partial can continue from the head's resume token, or
+   * null when it cannot (compressed/filtered/decimated download, no token,
+   * another stream's token, or a token past the saved bytes).
+   * @private
+   */
+  async _storedResumePoint(opts, store, resumeBytes) {
+    if ((opts.compress ?? this.compress) || opts.types || opts.decimateSeconds != null) return null;
+    let token = null;
+    try {
+      token = await this.readResumeToken();
+    } catch { /* NRC: the head has no checkpoint (e.g. it rebooted) */ }
+    if (!token || token.stream !== (opts.stream ?? constants.LOG_STREAM_TELEMETRY)) return null;
+    const header = await store.read(0, constants.LOG_DCLG_HEADER_LEN);
+    if (header.length < constants.LOG_DCLG_HEADER_LEN || header[5] !== 0) return null;
+    const storedOffset = constants.LOG_DCLG_HEADER_LEN + token.bodyOffset;
+    return storedOffset <= resumeBytes ? { token: token.bytes, storedOffset } : null;
+  }
+
+  /**
+   * One resumable attempt: continue from the head's resume token when it has
+   * a usable one, else restart the selection. A token the head refuses (its
+   * ring moved on), or whose stream disagrees with the saved bytes, falls back
+   * to the restart within the same attempt if nothing was appended yet.
+   * @private
+   */
+  async _resumableAttempt(opts, io) {
+    const point = io.resumeBytes > 0 ? await this._storedResumePoint(opts, io.store, io.resumeBytes) : null;
+    if (point !== null) {
+      try {
+        const result = await this._downloadAttempt(
+          { ...opts, selector: (downloader) => downloader.selectResume(point.token) },
+          { ...io, resumeAt: point.storedOffset });
+        return { ...result, resumedAt: point.storedOffset };
+      } catch (error) {
+        const refused = ((error?.nrc != null && error.nrc !== constants.NRC_BUSY_REPEAT_REQUEST) ||
+          error?.code === 'LOG_RESUME_MISMATCH') && (await io.store.size()) === io.resumeBytes;
+        if (!refused) throw error;
+        this.emit('resumeRefused', { error, storedOffset: point.storedOffset });
+      }
+    }
+    return { ...(await this._downloadAttempt(opts, io)), resumedAt: null };
+  }
+
   /**
    * Download a flash-log stream. Runs the selector, begins the stream, then
    * pulls chunks until a short chunk terminates it. This legacy/in-memory API
@@ -712,6 +919,10 @@ export class LogDownloader extends EventEmitter {
    * @param {number} [opts.stream=TELEMETRY]
    * @param {(dl:LogDownloader)=>Promise<Uint8Array>} [opts.selector] - defaults to latest boot
    * @param {number} [opts.maxChunk] - client max receivable block (overrides ctor)
+   * @param {boolean} [opts.compress] - request the compressed body (overrides ctor)
+   * @param {number[]} [opts.types] - download only these record types (FL_TYPE_*)
+   * @param {number} [opts.decimateSeconds] - aggregate consensus, cell raw and
+   *   power records into buckets of this many seconds (1..3600)
    * @param {number} [opts.maxBlocks] - Optional explicit block safety ceiling
    * @param {number} [opts.maxBytes=67108864] - Decoded-stream safety ceiling
    * @param {(received:number,total:number)=>void} [opts.onProgress]
@@ -733,10 +944,13 @@ export class LogDownloader extends EventEmitter {
   }
 
   /**
-   * Stream a log to a resumable store. On a transient failure, restart the
-   * selector and verify the retransmitted stream byte-for-byte against the
-   * saved prefix before appending. A changed ring raises LOG_RESUME_MISMATCH;
-   * incompatible data is never spliced into the partial artifact.
+   * Stream a log to a resumable store. On a transient failure of a raw
+   * download, continue from the head's resume token: the saved bytes past the
+   * token's offset are verified against the resumed stream, the rest is
+   * appended. Without a usable token, restart the selector and verify the
+   * retransmitted stream byte-for-byte against the saved prefix before
+   * appending. A changed ring raises LOG_RESUME_MISMATCH; incompatible data is
+   * never spliced into the partial artifact.
    *
    * @param {Object} opts downloadLog options plus:
    * @param {Object} opts.store LogDownloadStore-compatible sink
@@ -762,7 +976,7 @@ export class LogDownloader extends EventEmitter {
       const resumeBytes = await store.size();
       await store.beginAttempt();
       try {
-        const result = await this._downloadAttempt({ ...opts, retry }, { store, resumeBytes, attempt });
+        const result = await this._resumableAttempt({ ...opts, retry }, { store, resumeBytes, attempt });
         await store.finishAttempt({
           complete: true,
           attempts: (metadata.attempts || 0) + attempt,
@@ -778,6 +992,7 @@ export class LogDownloader extends EventEmitter {
           bytes: await store.size(),
           complete: true,
           resumedFrom: resumeBytes,
+          resumedAt: result.resumedAt,
           attempts: attempt,
           negotiatedBlock: result.negotiatedBlock,
           metrics: result.metrics,
@@ -1,5 +1,5 @@
 import { describe, it, expect, beforeEach, vi } from 'vitest';
-import { LogDownloader } from './LogDownloader.js';
+import { LogDownloader, recordTypeMask } from './LogDownloader.js';
 import { MemoryLogDownloadStore } from './LogDownloadStore.js';
 import { parseLogStream } from './LogParser.js';
 import { UDSClient } from '../uds/UDSClient.js';
@@ -392,6 +392,71 @@ describe('LogDownloader', () => {
     expect(sequences).not.toContain(0);
   });
 
+  it('requests the compressed body through the 0x34 dataFormatIdentifier', async () => {
+    const formats = [];
+    const fastUds = {
+      routineControl: async () => new Uint8Array(),
+      readDataByIdentifier: async () => new Uint8Array(20),
+      requestDownload: async (addr, size, options) => { formats.push(options.dataFormat); return 61; },
+      transferData: async (seq) => new Uint8Array([0x76, seq]),
+      requestTransferExit: async () => {}
+    };
+    const downloader = new LogDownloader(fastUds, { compress: true });
+
+    await downloader.downloadLog();
+    await downloader.downloadLog({ compress: false });
+
+    expect(formats).toEqual([0x10, 0x00]);
+  });
+
+  it('sends the record-type mask with BeginStream only when types are given', async () => {
+    const begins = [];
+    const fastUds = {
+      routineControl: async (rid, params) => {
+        if (rid === 0xF105) begins.push(Array.from(params));
+        return new Uint8Array();
+      },
+      readDataByIdentifier: async () => new Uint8Array(20),
+      requestDownload: async () => 61,
+      transferData: async (seq) => new Uint8Array([0x76, seq]),
+      requestTransferExit: async () => {}
+    };
+    const downloader = new LogDownloader(fastUds);
+
+    await downloader.downloadLog();
+    await downloader.downloadLog({ types: [0x10, 0x11] });
+
+    expect(begins).toEqual([[], [0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00]]);
+    expect(recordTypeMask([0x3F])).toBe(1n << 63n);
+    expect(() => recordTypeMask([0x40])).toThrow(RangeError);
+  });
+
+  it('appends the decimation bucket to BeginStream, defaulting the mask to every type', async () => {
+    const begins = [];
+    const fastUds = {
+      routineControl: async (rid, params) => {
+        if (rid === 0xF105) begins.push(Array.from(params));
+        return new Uint8Array();
+      },
+      readDataByIdentifier: async () => new Uint8Array(20),
+      requestDownload: async () => 61,
+      transferData: async (seq) => new Uint8Array([0x76, seq]),
+      requestTransferExit: async () => {}
+    };
+    const downloader = new LogDownloader(fastUds);
+
+    await downloader.downloadLog({ types: [0x10], decimateSeconds: 10 });
+    await downloader.downloadLog({ decimateSeconds: 300 });
+
+    expect(begins).toEqual([
+      [0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 10, 0],
+      [0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x2C, 0x01]
+    ]);
+    expect(() => downloader.beginStream(null, 10)).toThrow(TypeError);
+    expect(() => downloader.beginStream(1n, 0)).toThrow(RangeError);
+    expect(() => downloader.beginStream(1n, 3601)).toThrow(RangeError);
+  });
+
   it('rejects an explicit block ceiling before EOS and closes the transfer', async () => {
     let transferExitCount = 0;
     const fastUds = {
@@ -466,6 +531,92 @@ describe('LogDownloader', () => {
     });
   });
 
+  /** Head that breaks off attempt 1 at block 4 and holds a resume token at
+   * body offset `tokenBody`; `refuse` makes it NRC RID 0xF107. */
+  function resumingHead(stream, tokenBody, { refuse = false } = {}) {
+    const header = stream.slice(0, 16);
+    const token = new Uint8Array(28);
+    token[1] = 1;
+    token.set([tokenBody & 0xFF, tokenBody >> 8, 0, 0], 24);
+    const head = { attempt: 0, rids: [], resumed: null, token };
+    let chunks = [];
+    let index = 0;
+    head.uds = {
+      routineControl: async (rid, params) => {
+        head.rids.push(rid);
+        if (rid === 0xF107) {
+          if (refuse) throw Object.assign(new Error('stale token'), { nrc: 0x31 });
+          head.resumed = Array.from(params);
+        }
+        return new Uint8Array();
+      },
+      readDataByIdentifier: async (did) => (did === 0xF285 ? token : selectorResultPayload()),
+      requestDownload: async () => {
+        head.attempt++;
+        index = 0;
+        const body = head.rids[head.rids.length - 2] === 0xF107
+          ? new Uint8Array([...header, ...stream.slice(16 + tokenBody)])
+          : stream;
+        chunks = chunkify(body, 32);
+        return 32;
+      },
+      transferData: async (seq) => {
+        if (head.attempt === 1 && index === 3) throw new Error('bridge dropped the block');
+        return new Uint8Array([0x76, seq, ...(chunks[index++] || new Uint8Array(0))]);
+      },
+      requestTransferExit: async () => {}
+    };
+    return head;
+  }
+
+  it('continues a broken raw download from the head resume token', async () => {
+    const stream = buildStream([
+      buildRecord(FL_TYPE_LOG_TEXT, logTextPayload(1, 0, 'T'.repeat(300)), { tsUs: 1 })
+    ]);
+    const head = resumingHead(stream, 48);
+    const downloader = new LogDownloader(head.uds);
+    const store = new MemoryLogDownloadStore({ resumeKey: 'telemetry:all' });
+
+    const result = await downloader.downloadLogResumable({
+      store,
+      resumeKey: 'telemetry:all',
+      maxChunk: 32,
+      selector: (dl) => dl.selectAll(0),
+      retry: { maxAttempts: 3, initialDelayMs: 0, maxDelayMs: 0 }
+    });
+
+    // 96 B saved; the token resumes at 16 + 48, so 32 B are re-verified.
+    expect(result.resumedFrom).toBe(96);
+    expect(result.resumedAt).toBe(64);
+    expect(head.rids).toEqual([0xF106, 0xF105, 0xF107, 0xF105]);
+    expect(head.resumed).toEqual(Array.from(head.token));
+    expect(Array.from(await store.getBytes())).toEqual(Array.from(stream));
+  });
+
+  it('restarts the selection when the head refuses its resume token', async () => {
+    const stream = buildStream([
+      buildRecord(FL_TYPE_LOG_TEXT, logTextPayload(1, 0, 'U'.repeat(300)), { tsUs: 1 })
+    ]);
+    const head = resumingHead(stream, 48, { refuse: true });
+    const downloader = new LogDownloader(head.uds);
+    const store = new MemoryLogDownloadStore({ resumeKey: 'telemetry:all' });
+    const refused = [];
+    downloader.on('resumeRefused', event => refused.push(event));
+
+    const result = await downloader.downloadLogResumable({
+      store,
+      resumeKey: 'telemetry:all',
+      maxChunk: 32,
+      selector: (dl) => dl.selectAll(0),
+      retry: { maxAttempts: 3, initialDelayMs: 0, maxDelayMs: 0 }
+    });
+
+    expect(result.resumedAt).toBe(null);
+    expect(refused).toHaveLength(1);
+    expect(head.rids).toEqual([0xF106, 0xF105, 0xF107, 0xF106, 0xF105]);
+    expect(Array.from(await store.getBytes())).toEqual(Array.from(stream));
+  });
+
   it('reconciles an advanced full ring and resumes without overwriting the saved prefix', async () => {
     const records = Array.from({ length: 12 }, (_, i) => buildRecord(
       FL_TYPE_LOG_TEXT,
@@ -674,6 +825,19 @@ describe('LogDownloader', () => {
     expect(Array.from(transport.getLastSent())).toEqual([0x31, 0x01, 0xF1, 0x04, 0]);
   });
 
+  it('selectByTimeRange sends boot id and a 64-bit LE window', async () => {
+    transport.setResponder(logResponder(sampleStream()));
+
+    await logs.selectByTimeRange(0x0A0B0C0D, 0x0102030405n, 0xFFFFFFFFFFFFFFFFn, 1);
+    // RID 0xF100, params: stream(u8) + boot_id(u32 LE) + start_us(u64 LE) + end_us(u64 LE)
+    expect(Array.from(transport.getLastSent())).toEqual([
+      0x31, 0x01, 0xF1, 0x00, 1,
+      0x0D, 0x0C, 0x0B, 0x0A,
+      0x05, 0x04, 0x03, 0x02, 0x01, 0x00, 0x00, 0x00,
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+    ]);
+  });
+
   it('a throwing progress listener does not abort the download', async () => {
     const consoleError = vi.spyOn(console, 'error').mockImplementation(() => {});
     transport.setResponder(logResponder(sampleStream()));
@@ -704,3 +868,66 @@ describe('LogDownloader', () => {
     expect(await logs.readCanCapture()).toBe(3);
   });
 });
+
+describe('LogDownloader live tail', () => {
+  function tailUds() {
+    const listeners = new Set();
+    return {
+      routines: [],
+      listeners,
+      routineControl: async function (rid, params) {
+        this.routines.push([rid, Array.from(params)]);
+        return new Uint8Array();
+      },
+      on(event, cb) { if (event === 'logTail') listeners.add(cb); },
+      off(event, cb) { if (event === 'logTail') listeners.delete(cb); },
+      push(payload) { listeners.forEach((cb) => cb(payload)); }
+    };
+  }
+
+  it('subscribes with the type mask and budget, then re-emits pushed records', async () => {
+    const uds = tailUds();
+    const logs = new LogDownloader(uds);
+    const seen = [];
+    logs.on('tailRecords', (records) => seen.push(records));
+
+    await logs.startLiveTail([0x10, 0x11], { budgetBps: 512 });
+    expect(uds.routines).toEqual([[0xF108, [0x00, 0x00, 0x03, 0, 0, 0, 0, 0, 0x00, 0x02]]]);
+
+    const consensus = buildRecord(0x10, new Uint8Array(14).fill(7), { tsUs: 1500 });
+    const pid = buildRecord(0x11, new Uint8Array(11), { tsUs: 1600, flags: 0x01 });
+    uds.push(new Uint8Array([...consensus, ...pid]));
+
+    expect(seen).toHaveLength(1);
+    expect(seen[0].map((r) => r.type)).toEqual([0x10, 0x11]);
+    expect(seen[0][0].tsUs).toBe(1500n);
+    expect(seen[0][1].flags).toBe(0x01);
+
+    await logs.stopLiveTail();
+  });
+
+  it('stops with an all-zero mask and detaches from the pushes', async () => {
+    const uds = tailUds();
+    const logs = new LogDownloader(uds);
+    const seen = [];
+    logs.on('tailRecords', (records) => seen.push(records));
+
+    await logs.startLiveTail([0x12]);
+    await logs.stopLiveTail();
+    uds.push(buildRecord(0x12, new Uint8Array(9), { tsUs: 1 }));
+
+    expect(uds.routines.at(-1)).toEqual([0xF108, [0, 0, 0, 0, 0, 0, 0, 0]]);
+    expect(uds.listeners.size).toBe(0);
+    expect(seen).toHaveLength(0);
+  });
+
+  it('rejects an empty type list or an out-of-range budget before sending', async () => {
+    const uds = tailUds();
+    const logs = new LogDownloader(uds);
+
+    await expect(logs.startLiveTail([])).rejects.toThrow(RangeError);
+    await expect(logs.startLiveTail([0x10], { budgetBps: 32 })).rejects.toThrow(RangeError);
+    await expect(logs.startLiveTail([0x10], { budgetBps: 4096 })).rejects.toThrow(RangeError);
+    expect(uds.routines).toHaveLength(0);
+  });
+});
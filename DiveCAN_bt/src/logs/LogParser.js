@@ -1,11 +1,17 @@
 /**
  * Flash-log stream parser.
  *
- * A downloaded stream is a 16-byte DCLG header followed by concatenated TLV
+ * A downloaded stream is a 16-byte DCLG header (24 with the record-type mask
+ * of a filtered download, LOG_DCLG_FLAG_FILTERED) followed by concatenated TLV
  * records. Each TLV = 12-byte header [type u8, flags u8, length u16 LE,
  * ts_boot_us u64 LE] + `length` payload bytes. BATCH (0xFD) records are
- * containers that are flattened into their sub-records. Parsing stops at
- * END_OF_STREAM (0xFF) or a truncated tail.
+ * containers that are flattened into their sub-records; PACKED BATCH (0xFC)
+ * containers are first expanded back into that layout (expandPackedBatch).
+ * A decimated download (LOG_DCLG_FLAG_DECIMATED) carries AGGREGATE (0xFB)
+ * records in place of consensus, cell raw and power snapshots.
+ * Parsing stops at END_OF_STREAM (0xFF) or a truncated tail. A compressed
+ * download (header flag LOG_DCLG_FLAG_LZ) is inflated first
+ * (inflateLogStream).
  *
  * Mirrors dut.parse_log_stream and the module-level decode_* helpers.
  */
@@ -13,8 +19,13 @@
 import {
   LOG_DOWNLOAD_MAGIC,
   LOG_DCLG_HEADER_LEN,
+  LOG_DCLG_FLAG_LZ,
+  LOG_DCLG_FLAG_FILTERED,
+  LOG_DCLG_MASK_LEN,
+  LOG_LZ_MIN_MATCH,
   FL_ENTRY_HDR_LEN,
   FL_TYPE_BATCH,
+  FL_TYPE_BATCH_PACKED,
   FL_TYPE_END_OF_STREAM,
   FL_TYPE_BOOT_MARKER,
   FL_TYPE_DIVE_START,
@@ -28,11 +39,13 @@ import {
   FL_TYPE_SOLENOID_CURRENT,
   FL_TYPE_ATMOS_PRESSURE,
   FL_TYPE_POWER_SNAPSHOT,
+  FL_TYPE_LATENCY_SUMMARY,
   FL_TYPE_CELL_RAW_DIVEO2,
   FL_TYPE_CELL_RAW_O2S,
   FL_TYPE_CELL_RAW_ANALOG,
   FL_TYPE_ERROR_EVENT,
   FL_TYPE_DROP_MARKER,
+  FL_TYPE_AGGREGATE,
   FL_POWER_BATTERY_VALID,
   FL_POWER_VBUS_VALID,
   FL_POWER_VCC_VALID,
@@ -58,11 +71,30 @@ const LEN_SOLENOID_FIRE = 9;
 const LEN_SOLENOID_CURRENT = 14;
 const LEN_ATMOS_PRESSURE = 2;
 const LEN_POWER_SNAPSHOT = 32;
+const LEN_LATENCY_SUMMARY_HDR = 2;  // version u8, stage_count u8
+const LEN_LATENCY_STAGE = 20;       // count, min, p50, p99, max u32 (µs)
 const LEN_CELL_DIVEO2 = 30;
 const LEN_CELL_O2S = 3;
 const LEN_CELL_ANALOG = 8;   // packed: u8 + u8 + i32 + u16
 const LEN_ERROR_EVENT = 8;
 const LEN_DROP_MARKER = 5;
+const LEN_AGGREGATE_PREFIX = 8;  // source_type u8, key u8, count u16, span_us u32
+const LEN_AGGREGATE_CHANNEL = 12; // min, mean, max f32
+const AGGREGATE_NO_KEY = 0xFF;
+
+/* Channel names of an AGGREGATE record per source type, in the order the head
+ * writes them (firmware flash_log_aggregate.c). */
+const AGGREGATE_CHANNELS = {
+  [FL_TYPE_CONSENSUS]: ['consensusPpo2', 'ppo2_0', 'ppo2_1', 'ppo2_2',
+    'millivolts_0', 'millivolts_1', 'millivolts_2', 'confidence', 'setpoint'],
+  [FL_TYPE_POWER_SNAPSHOT]: ['vbusVoltage', 'vccVoltage', 'batteryVoltage',
+    'canVoltage', 'currentUa'],
+  [FL_TYPE_CELL_RAW_DIVEO2]: ['ppo2', 'temperatureMc', 'phaseMdeg',
+    'signalIntensityUv', 'ambientLightUv', 'ambientPressureUbar',
+    'housingHumidityMpercentRh'],
+  [FL_TYPE_CELL_RAW_O2S]: ['ppo2'],
+  [FL_TYPE_CELL_RAW_ANALOG]: ['ppo2', 'rawAdc', 'millivolts']
+};
 
 /* ---- Unit scale factors ----
  *
@@ -116,37 +148,282 @@ function readU64LE(bytes, offset) {
   return result;
 }
 
+/* ---- Packed batch containers ----
+ * Mirrors firmware src/flash_log/flash_log_codec.c (format in
+ * flash_log_codec.h) and scripts/telemetry_log.py::_walk_packed. Each
+ * sub-record is [tag u8][zig-zag varint ts delta] followed by either a raw
+ * [varint length][bytes] body or, when the tag's top bit is set, a
+ * field-coded body: [cell key u8 — cell types only][varint change mask]
+ * [zig-zag varint delta per changed field]. Deltas are against the previous
+ * record of the same type (and cell) in the same container, or zero.
+ */
+const PACKED_TAG_FIELDS = 0x80;
+const PACKED_CELL_SLOTS = 3;
+const PACKED_VARINT_MAX = 10;
+const U64_MASK = 0xFFFFFFFFFFFFFFFFn;
+
+/** type -> {keyed on cell_index, field widths after the key} */
+const PACKED_SCHEMAS = {
+  [FL_TYPE_CONSENSUS]: { keyed: false, widths: [1, 1, 1, 1, 2, 2, 2, 2, 1, 1] },
+  [FL_TYPE_PID_SNAPSHOT]: { keyed: false, widths: [4, 2, 4, 1] },
+  [FL_TYPE_CELL_RAW_DIVEO2]: { keyed: true, widths: [1, 4, 4, 4, 4, 4, 4, 4] },
+  [FL_TYPE_CELL_RAW_O2S]: { keyed: true, widths: [1, 1] },
+  [FL_TYPE_CELL_RAW_ANALOG]: { keyed: true, widths: [1, 4, 2] }
+};
+
+/** LEB128 varint → [BigInt value, next offset], or null when truncated. */
+function readVarint(buf, i, end) {
+  let value = 0n;
+  for (let n = 0; n < PACKED_VARINT_MAX && i + n < end; n++) {
+    const b = buf[i + n];
+    value |= BigInt(b & 0x7F) << BigInt(7 * n);
+    if (!(b & 0x80)) return [value, i + n + 1];
+  }
+  return null;
+}
+
+function unzigzag(v) {
+  return (v >> 1n) ^ -(v & 1n);
+}
+
+/** Field-coded body → [payload bytes, next offset], or null when malformed. */
+function decodePackedFields(buf, i, end, type, prev) {
+  const schema = PACKED_SCHEMAS[type];
+  if (!schema) return null;
+  const out = [];
+  let key = 0;
+  let at = i;
+  if (schema.keyed) {
+    if (at >= end) return null;
+    key = buf[at++];
+    out.push(key);
+  }
+  const mask = readVarint(buf, at, end);
+  if (!mask || (mask[0] >> BigInt(schema.widths.length)) !== 0n) return null;
+  at = mask[1];
+  const slot = (!schema.keyed || key < PACKED_CELL_SLOTS) ? `${type}:${key}` : null;
+  const ref = slot !== null ? prev.get(slot) : undefined;
+  for (let f = 0; f < schema.widths.length; f++) {
+    const width = schema.widths[f];
+    const off = out.length;
+    const span = 2 ** (8 * width);
+    let value = 0;
+    for (let b = 0; b < width; b++) value += (ref ? ref[off + b] : 0) * 2 ** (8 * b);
+    if ((mask[0] >> BigInt(f)) & 1n) {
+      const delta = readVarint(buf, at, end);
+      if (!delta) return null;
+      at = delta[1];
+      value = (((value + Number(unzigzag(delta[0]))) % span) + span) % span;
+    }
+    for (let b = 0; b < width; b++) out.push(Math.floor(value / 2 ** (8 * b)) & 0xFF);
+  }
+  if (slot !== null) prev.set(slot, out);
+  return [out, at];
+}
+
+/**
+ * Expand a PACKED BATCH (0xFC) container payload into the plain BATCH layout
+ * (concatenated 12-byte-header TLV records). A malformed or truncated
+ * sub-record ends the container; everything before it is kept, matching the
+ * firmware's flash_log_reader_expand_batch().
+ * @param {Uint8Array|Array} payload Container payload bytes.
+ * @param {bigint|number} baseTsUs Container header ts_boot_us.
+ * @returns {Uint8Array}
+ */
+export function expandPackedBatch(payload, baseTsUs) {
+  const buf = toBytes(payload);
+  const end = buf.length;
+  const prev = new Map();
+  const out = [];
+  let ts = BigInt(baseTsUs);
+  let i = 0;
+  while (i < end) {
+    const tag = buf[i];
+    const type = tag & ~PACKED_TAG_FIELDS & 0xFF;
+    const dt = readVarint(buf, i + 1, end);
+    if (!dt) break;
+    let body;
+    let next;
+    if (tag & PACKED_TAG_FIELDS) {
+      const fields = decodePackedFields(buf, dt[1], end, type, prev);
+      if (!fields) break;
+      [body, next] = fields;
+    } else {
+      const len = readVarint(buf, dt[1], end);
+      if (!len || len[1] + Number(len[0]) > end) break;
+      body = Array.from(buf.subarray(len[1], len[1] + Number(len[0])));
+      next = len[1] + body.length;
+    }
+    ts = (ts + unzigzag(dt[0])) & U64_MASK;
+    out.push(type, 0, body.length & 0xFF, (body.length >> 8) & 0xFF);
+    for (let b = 0n; b < 8n; b++) out.push(Number((ts >> (8n * b)) & 0xFFn));
+    for (const v of body) out.push(v);
+    i = next;
+  }
+  return new Uint8Array(out);
+}
+
 /**
- * Parse the 16-byte DCLG download header if present.
+ * Rewrite every top-level PACKED BATCH container in a downloaded stream as a
+ * plain BATCH container holding the same records, so offset-based walkers
+ * (TelemetryBuilder) see a single layout. Returns the input untouched when
+ * it holds no packed containers.
+ * @param {Uint8Array} bytes Raw stream, optional DCLG header included.
+ * @param {number} start Offset of the first TLV record.
+ * @returns {Uint8Array}
+ */
+export function expandPackedStream(bytes, start) {
+  const pieces = [];
+  let copied = 0;
+  let i = start;
+  const n = bytes.length;
+  while (i + FL_ENTRY_HDR_LEN <= n) {
+    const rtype = bytes[i];
+    const length = bytes[i + 2] | (bytes[i + 3] << 8);
+    const end = i + FL_ENTRY_HDR_LEN + length;
+    if (end > n || rtype === FL_TYPE_END_OF_STREAM) break;
+    if (rtype === FL_TYPE_BATCH_PACKED) {
+      const inner = expandPackedBatch(bytes.subarray(i + FL_ENTRY_HDR_LEN, end), readU64LE(bytes, i + 4));
+      const hdr = bytes.slice(i, i + FL_ENTRY_HDR_LEN);
+      hdr[0] = FL_TYPE_BATCH;
+      hdr[2] = inner.length & 0xFF;
+      hdr[3] = (inner.length >> 8) & 0xFF;
+      pieces.push(bytes.subarray(copied, i), hdr, inner);
+      copied = end;
+    }
+    i = end;
+  }
+  if (pieces.length === 0) return bytes;
+  pieces.push(bytes.subarray(copied));
+  const out = new Uint8Array(pieces.reduce((sum, p) => sum + p.length, 0));
+  let at = 0;
+  for (const p of pieces) {
+    out.set(p, at);
+    at += p.length;
+  }
+  return out;
+}
+
+/**
+ * Parse the DCLG download header if present. `headerLength` is where the TLV
+ * records start: 16 bytes, plus the record-type mask of a filtered download
+ * (`typeMask`, bit t = record type t; null when unfiltered).
  * @param {Uint8Array|Array} input
  * @returns {{magic:number, version:number, flags:number, stream:number,
- *   totalBytes:number, entryCount:number}|null}
+ *   codec:number, totalBytes:number, entryCount:number,
+ *   typeMask:bigint|null, headerLength:number}|null}
  */
 export function parseDclgHeader(input) {
   const bytes = toBytes(input);
   if (bytes.length < LOG_DCLG_HEADER_LEN) return null;
   const magic = ByteUtils.leToUint32(bytes.slice(0, 4));
   if (magic !== LOG_DOWNLOAD_MAGIC) return null;
+  const filtered = (bytes[5] & LOG_DCLG_FLAG_FILTERED) !== 0;
+  const headerLength = LOG_DCLG_HEADER_LEN + (filtered ? LOG_DCLG_MASK_LEN : 0);
+  if (bytes.length < headerLength) return null;
   return {
     magic,
     version: bytes[4],
     flags: bytes[5],
     stream: bytes[6],
+    codec: bytes[7],
     totalBytes: ByteUtils.leToUint32(bytes.slice(8, 12)),
-    entryCount: ByteUtils.leToUint32(bytes.slice(12, 16))
+    entryCount: ByteUtils.leToUint32(bytes.slice(12, 16)),
+    typeMask: filtered ? readU64LE(bytes, LOG_DCLG_HEADER_LEN) : null,
+    headerLength
+  };
+}
+
+/**
+ * Create an incremental decoder for the compressed download body (mirror of
+ * firmware src/flash_log/flash_log_lz.c). Items are MSB-first: `1` + literal
+ * byte, or `0` + (distance - 1) + (length - LOG_LZ_MIN_MATCH); a backref copies
+ * byte by byte so it may overlap its own output. Bits that do not complete an
+ * item wait for the next push (or are the zero padding of the final byte).
+ * @param {number} params DCLG codec byte: window bits << 4 | length bits.
+ * @returns {{push:(chunk:Uint8Array)=>void, bytes:()=>Uint8Array}}
+ */
+export function createLzInflater(params) {
+  const lengthBits = params & 0x0F;
+  const refBits = (params >> 4) + lengthBits;
+  let acc = 0;
+  let nbits = 0;
+  let out = new Uint8Array(4096);
+  let len = 0;
+
+  const reserve = (n) => {
+    if (len + n <= out.length) return;
+    const grown = new Uint8Array(Math.max(out.length * 2, len + n));
+    grown.set(out.subarray(0, len));
+    out = grown;
   };
+
+  return {
+    push(chunk) {
+      for (const byte of toBytes(chunk)) {
+        acc = (acc << 8) | byte;
+        nbits += 8;
+        for (;;) {
+          const literal = (acc >> (nbits - 1)) & 1;
+          const width = literal ? 8 : refBits;
+          if (nbits < 1 + width) break;
+          nbits -= 1 + width;
+          const value = (acc >> nbits) & ((1 << width) - 1);
+          acc &= (1 << nbits) - 1;
+          if (literal) {
+            reserve(1);
+            out[len++] = value;
+          } else {
+            const dist = (value >> lengthBits) + 1;
+            const run = (value & ((1 << lengthBits) - 1)) + LOG_LZ_MIN_MATCH;
+            if (dist > len) throw new Error(`LZ backref ${dist} before stream start`);
+            reserve(run);
+            for (let k = 0; k < run; k++, len++) out[len] = out[len - dist];
+          }
+          if (nbits === 0) break;
+        }
+      }
+    },
+    bytes() {
+      return out.subarray(0, len);
+    }
+  };
+}
+
+/**
+ * Return a compressed download as the plain stream it encodes: the DCLG header
+ * (LZ flag and codec byte cleared) followed by the inflated TLV records. Any
+ * other input is returned untouched.
+ * @param {Uint8Array|Array} input
+ * @returns {Uint8Array}
+ */
+export function inflateLogStream(input) {
+  const bytes = toBytes(input);
+  const header = parseDclgHeader(bytes);
+  if (!header || (header.flags & LOG_DCLG_FLAG_LZ) === 0) return bytes;
+  const inflater = createLzInflater(header.codec);
+  inflater.push(bytes.subarray(header.headerLength));
+  const body = inflater.bytes();
+  const out = new Uint8Array(header.headerLength + body.length);
+  out.set(bytes.subarray(0, header.headerLength));
+  out[5] &= ~LOG_DCLG_FLAG_LZ;
+  out[7] = 0;
+  out.set(body, header.headerLength);
+  return out;
 }
 
 /**
  * Parse a downloaded flash-log byte stream into a flat list of record dicts
- * {type, typeName, flags, tsUs, payload}. BATCH containers are flattened.
+ * {type, typeName, flags, tsUs, payload}. BATCH and PACKED BATCH containers
+ * are flattened.
  * @param {Uint8Array|Array} input
  * @returns {Array<{type:number, typeName:string, flags:number, tsUs:bigint, payload:Uint8Array}>}
  */
 export function parseLogStream(input) {
-  let body = toBytes(input);
-  if (parseDclgHeader(body)) {
-    body = body.slice(LOG_DCLG_HEADER_LEN);
+  let body = inflateLogStream(input);
+  const header = parseDclgHeader(body);
+  if (header) {
+    body = body.slice(header.headerLength);
   }
 
   const records = [];
@@ -164,6 +441,8 @@ export function parseLogStream(input) {
       if (rtype === FL_TYPE_END_OF_STREAM) break;
       if (rtype === FL_TYPE_BATCH) {
         walk(payload);
+      } else if (rtype === FL_TYPE_BATCH_PACKED) {
+        walk(expandPackedBatch(payload, tsUs));
       } else {
         records.push({
           type: rtype,
@@ -197,6 +476,8 @@ function countRecordsIn(buf) {
     if (rtype === FL_TYPE_END_OF_STREAM) break;
     if (rtype === FL_TYPE_BATCH) {
       count += countRecordsIn(buf.slice(i + FL_ENTRY_HDR_LEN, end));
+    } else if (rtype === FL_TYPE_BATCH_PACKED) {
+      count += countRecordsIn(expandPackedBatch(buf.slice(i + FL_ENTRY_HDR_LEN, end), readU64LE(buf, i + 4)));
     } else {
       count += 1;
     }
@@ -217,13 +498,26 @@ export function makeRecordCounter() {
   let offset = -1; // -1 until the DCLG header (if any) is resolved
   let count = 0;
   let done = false;
+  let inflater = null; // set for a compressed stream; offsets then index its output
+  let fed = 0;         // compressed bytes already pushed into the inflater
 
   return function next(buffer) {
     if (done) return count;
-    const bytes = toBytes(buffer);
+    let bytes = toBytes(buffer);
     if (offset < 0) {
       if (bytes.length < LOG_DCLG_HEADER_LEN) return count;
-      offset = parseDclgHeader(bytes) ? LOG_DCLG_HEADER_LEN : 0;
+      const header = parseDclgHeader(bytes);
+      offset = header ? header.headerLength : 0;
+      if (header && (header.flags & LOG_DCLG_FLAG_LZ) !== 0) {
+        inflater = createLzInflater(header.codec);
+        fed = header.headerLength;
+        offset = 0;
+      }
+    }
+    if (inflater) {
+      inflater.push(bytes.subarray(fed));
+      fed = bytes.length;
+      bytes = inflater.bytes();
     }
     let i = offset;
     const n = bytes.length;
@@ -235,6 +529,8 @@ export function makeRecordCounter() {
       if (rtype === FL_TYPE_END_OF_STREAM) { done = true; break; }
       if (rtype === FL_TYPE_BATCH) {
         count += countRecordsIn(bytes.slice(i + FL_ENTRY_HDR_LEN, end));
+      } else if (rtype === FL_TYPE_BATCH_PACKED) {
+        count += countRecordsIn(expandPackedBatch(bytes.slice(i + FL_ENTRY_HDR_LEN, end), readU64LE(bytes, i + 4)));
       } else {
         count += 1;
       }
@@ -460,6 +756,29 @@ export function decodePowerSnapshot(payload) {
   };
 }
 
+/**
+ * Decode a LATENCY_SUMMARY payload (same layout as DID 0xF216) -> per-stage
+ * sample-age statistics in µs, in LatencyStage_t order.
+ */
+export function decodeLatencySummary(payload) {
+  const p = toBytes(payload);
+  if (p.length < LEN_LATENCY_SUMMARY_HDR) return null;
+  const stageCount = p[1];
+  if (p.length < LEN_LATENCY_SUMMARY_HDR + stageCount * LEN_LATENCY_STAGE) return null;
+  const stages = [];
+  for (let i = 0; i < stageCount; i++) {
+    const o = LEN_LATENCY_SUMMARY_HDR + i * LEN_LATENCY_STAGE;
+    stages.push({
+      count: readU32LE(p, o),
+      minUs: readU32LE(p, o + 4),
+      p50Us: readU32LE(p, o + 8),
+      p99Us: readU32LE(p, o + 12),
+      maxUs: readU32LE(p, o + 16)
+    });
+  }
+  return { version: p[0], stages };
+}
+
 /**
  * Decode a CELL_RAW_DIVEO2 payload.
  *
@@ -537,6 +856,32 @@ export function decodeDropMarker(payload) {
   };
 }
 
+/**
+ * Decode an AGGREGATE payload (decimated download) ->
+ * {sourceType, cellIndex, count, spanUs, channels: {name: {min, mean, max}}}.
+ * Values are in the source record's raw units; cellIndex is null for
+ * consensus and power aggregates.
+ */
+export function decodeAggregate(payload) {
+  const p = toBytes(payload);
+  if (p.length < LEN_AGGREGATE_PREFIX) return null;
+  const sourceType = p[0];
+  const names = AGGREGATE_CHANNELS[sourceType];
+  if (!names || p.length < LEN_AGGREGATE_PREFIX + names.length * LEN_AGGREGATE_CHANNEL) return null;
+  const channels = {};
+  names.forEach((name, i) => {
+    const o = LEN_AGGREGATE_PREFIX + i * LEN_AGGREGATE_CHANNEL;
+    channels[name] = { min: readF32LE(p, o), mean: readF32LE(p, o + 4), max: readF32LE(p, o + 8) };
+  });
+  return {
+    sourceType,
+    cellIndex: p[1] === AGGREGATE_NO_KEY ? null : p[1],
+    count: readU16LE(p, 2),
+    spanUs: readU32LE(p, 4),
+    channels
+  };
+}
+
 /**
  * Decode a record's payload into a typed object based on its type.
  * @param {{type:number, payload:Uint8Array}} record
@@ -556,11 +901,13 @@ export function decodeRecord(record) {
     case FL_TYPE_SOLENOID_CURRENT: return decodeSolenoidCurrent(record.payload);
     case FL_TYPE_ATMOS_PRESSURE: return decodeAtmosPressure(record.payload);
     case FL_TYPE_POWER_SNAPSHOT: return decodePowerSnapshot(record.payload);
+    case FL_TYPE_LATENCY_SUMMARY: return decodeLatencySummary(record.payload);
     case FL_TYPE_CELL_RAW_DIVEO2: return decodeCellDiveO2(record.payload);
     case FL_TYPE_CELL_RAW_O2S: return decodeCellO2S(record.payload);
     case FL_TYPE_CELL_RAW_ANALOG: return decodeCellAnalog(record.payload);
     case FL_TYPE_ERROR_EVENT: return decodeErrorEvent(record.payload);
     case FL_TYPE_DROP_MARKER: return decodeDropMarker(record.payload);
+    case FL_TYPE_AGGREGATE: return decodeAggregate(record.payload);
     default: return null;
   }
 }
@@ -1,7 +1,9 @@
 import { describe, it, expect } from 'vitest';
 import {
   parseLogStream, parseDclgHeader, decodeBootMarker, decodeDiveMarker,
-  decodeCanFrame, decodeLogText, decodeConsensus, decodeRecord, makeRecordCounter
+  decodeCanFrame, decodeLogText, decodeConsensus, decodeRecord, makeRecordCounter,
+  decodeCellAnalog, decodeErrorEvent, expandPackedBatch, inflateLogStream,
+  decodeAggregate, decodeLatencySummary
 } from './LogParser.js';
 import {
   buildStream, buildRecord, buildDclgHeader,
@@ -10,9 +12,53 @@ import {
   FL_TYPE_BATCH, FL_TYPE_END_OF_STREAM
 } from '../../tests/fixtures/log-streams.js';
 import {
-  FL_TYPE_DIVE_END, FL_TYPE_CAN_TX, FL_TYPE_CONSENSUS
+  FL_TYPE_DIVE_END, FL_TYPE_CAN_TX, FL_TYPE_CONSENSUS, FL_TYPE_BATCH_PACKED,
+  FL_TYPE_ERROR_EVENT, FL_TYPE_CELL_RAW_ANALOG, FL_TYPE_AGGREGATE,
+  FL_TYPE_CELL_RAW_O2S, FL_TYPE_POWER_SNAPSHOT, FL_TYPE_LATENCY_SUMMARY
 } from '../uds/constants.js';
 
+/*
+ * A PACKED BATCH payload produced by the firmware codec
+ * (src/flash_log/flash_log_codec.c) for, relative to a 1 s container ts:
+ *   +0 us       CONSENSUS  ppo2 98, cells 97/98/99, 45.20/45.10/45.30 mV
+ *   +100000 us  CONSENSUS  ppo2 99, cell 1 at 45.00 mV (two fields change)
+ *   +100010 us  ERROR_EVENT code 3, detail 0xDEADBEEF (raw-coded)
+ *   +100020 us  CELL_RAW_ANALOG cell 1, ppo2 101, adc -12345, 45.20 mV
+ */
+const PACKED_BASE_TS_US = 1000000;
+const PACKED_PAYLOAD = [
+  0x90, 0x00, 0xff, 0x07, 0xc4, 0x01, 0xc2, 0x01, 0xc4, 0x01, 0xc6, 0x01,
+  0xd0, 0x46, 0xbc, 0x46, 0xe4, 0x46, 0xc8, 0x04, 0x06, 0x8c, 0x01, 0x90,
+  0xc0, 0x9a, 0x0c, 0x21, 0x02, 0x13, 0x30, 0x14, 0x08, 0x03, 0x00, 0x00,
+  0x00, 0xef, 0xbe, 0xad, 0xde, 0xa2, 0x14, 0x01, 0x07, 0xca, 0x01, 0xf1,
+  0xc0, 0x01, 0xd0, 0x46
+];
+
+/*
+ * The body of a three-record LOG_TEXT stream ('cell 1 ok' .. 'cell 3 ok' at
+ * 1000/2000/3000 us) as compressed by the firmware (src/flash_log/flash_log_lz.c,
+ * codec byte 0x94: 512-byte window, 4 length bits). 72 plain bytes.
+ */
+const LZ_CODEC = 0x94;
+const LZ_BODY = [
+  0xa0, 0x40, 0x21, 0x90, 0x0f, 0x44, 0x0e, 0x00, 0x00, 0x1c, 0x04, 0x02,
+  0x0b, 0x1d, 0x96, 0xd9, 0x6c, 0x90, 0x4c, 0x64, 0x16, 0xfb, 0x58, 0x2e,
+  0x5d, 0x08, 0x38, 0x2f, 0x93, 0x20, 0x5d, 0x77, 0x10, 0xb0, 0x5f, 0x26,
+  0x60, 0xb8, 0x80
+];
+
+function lzTextStreams() {
+  const plain = buildStream([
+    buildRecord(FL_TYPE_LOG_TEXT, logTextPayload(1, 0, 'cell 1 ok'), { tsUs: 1000 }),
+    buildRecord(FL_TYPE_LOG_TEXT, logTextPayload(1, 0, 'cell 2 ok'), { tsUs: 2000 }),
+    buildRecord(FL_TYPE_LOG_TEXT, logTextPayload(1, 0, 'cell 3 ok'), { tsUs: 3000 })
+  ]);
+  const header = plain.slice(0, 16);
+  header[5] = 0x01;
+  header[7] = LZ_CODEC;
+  return { plain, packed: new Uint8Array([...header, ...LZ_BODY]) };
+}
+
 describe('LogParser', () => {
   it('parses the DCLG header', () => {
     const bytes = new Uint8Array(buildDclgHeader({ stream: 1, totalBytes: 128, entryCount: 4 }));
@@ -60,6 +106,37 @@ describe('LogParser', () => {
     expect(Array.from(can.data.slice(0, 3))).toEqual([1, 2, 3]);
   });
 
+  it('expands PACKED BATCH containers produced by the firmware codec', () => {
+    const stream = buildStream([
+      buildRecord(FL_TYPE_BATCH_PACKED, PACKED_PAYLOAD, { tsUs: PACKED_BASE_TS_US })
+    ]);
+    const records = parseLogStream(stream);
+    expect(records.map(r => r.type)).toEqual([
+      FL_TYPE_CONSENSUS, FL_TYPE_CONSENSUS, FL_TYPE_ERROR_EVENT, FL_TYPE_CELL_RAW_ANALOG
+    ]);
+    expect(records.map(r => r.tsUs)).toEqual([1000000n, 1100000n, 1100010n, 1100020n]);
+    expect(decodeConsensus(records[0].payload)).toEqual({
+      consensusPpo2: 98, ppo2: [97, 98, 99], millivolts: [4520, 4510, 4530],
+      statusPacked: 0x0124, confidence: 3, setpoint: 70
+    });
+    expect(decodeConsensus(records[1].payload)).toMatchObject({
+      consensusPpo2: 99, millivolts: [4520, 4500, 4530]
+    });
+    expect(decodeErrorEvent(records[2].payload)).toEqual({ code: 3, detail: 0xDEADBEEF });
+    expect(decodeCellAnalog(records[3].payload)).toMatchObject({
+      cellIndex: 1, ppo2: 101, rawAdc: -12345, millivolts: 4520
+    });
+    expect(makeRecordCounter()(stream)).toBe(4);
+  });
+
+  it('keeps the records before a truncated PACKED BATCH sub-record', () => {
+    // Cut inside the second consensus record's field deltas.
+    const expanded = expandPackedBatch(PACKED_PAYLOAD.slice(0, 24), PACKED_BASE_TS_US);
+    const stream = buildStream([buildRecord(FL_TYPE_BATCH_PACKED, PACKED_PAYLOAD.slice(0, 24))]);
+    expect(expanded.length).toBe(12 + 14);
+    expect(parseLogStream(stream)).toHaveLength(1);
+  });
+
   it('stops at END_OF_STREAM', () => {
     const stream = buildStream([
       buildRecord(FL_TYPE_LOG_TEXT, logTextPayload(1, 0, 'a')),
@@ -119,11 +196,58 @@ describe('LogParser', () => {
       expect(decoded.setpoint).toBe(130);
     });
 
+    it('dispatches AGGREGATE', () => {
+      // O2S cell 2: 4 samples over a 10 s bucket, ppo2 min 68 / mean 70.5 / max 73
+      const p = new Uint8Array(8 + 12);
+      const v = new DataView(p.buffer);
+      p.set([FL_TYPE_CELL_RAW_O2S, 2]);
+      v.setUint16(2, 4, true);
+      v.setUint32(4, 10000000, true);
+      v.setFloat32(8, 68, true);
+      v.setFloat32(12, 70.5, true);
+      v.setFloat32(16, 73, true);
+      expect(decodeRecord({ type: FL_TYPE_AGGREGATE, payload: p })).toEqual({
+        sourceType: FL_TYPE_CELL_RAW_O2S,
+        cellIndex: 2,
+        count: 4,
+        spanUs: 10000000,
+        channels: { ppo2: { min: 68, mean: 70.5, max: 73 } }
+      });
+    });
+
+    it('dispatches LATENCY_SUMMARY', () => {
+      // version 1, 4 stages; only sample → fire has samples
+      const p = new Uint8Array(2 + 4 * 20);
+      const v = new DataView(p.buffer);
+      p.set([1, 4]);
+      [12, 4000, 96000, 180000, 201000].forEach((x, i) => v.setUint32(2 + 3 * 20 + i * 4, x, true));
+      const decoded = decodeRecord({ type: FL_TYPE_LATENCY_SUMMARY, payload: p });
+      expect(decoded.version).toBe(1);
+      expect(decoded.stages).toHaveLength(4);
+      expect(decoded.stages[0]).toEqual({ count: 0, minUs: 0, p50Us: 0, p99Us: 0, maxUs: 0 });
+      expect(decoded.stages[3]).toEqual({
+        count: 12, minUs: 4000, p50Us: 96000, p99Us: 180000, maxUs: 201000
+      });
+      expect(decodeLatencySummary(p.subarray(0, p.length - 1))).toBeNull();
+    });
+
     it('returns null for an unknown type', () => {
       expect(decodeRecord({ type: 0x99, payload: new Uint8Array(4) })).toBeNull();
     });
   });
 
+  it('decodeAggregate names every power channel and rejects short or unknown sources', () => {
+    const p = new Uint8Array(8 + 5 * 12);
+    p.set([FL_TYPE_POWER_SNAPSHOT, 0xFF, 1, 0]);
+    const decoded = decodeAggregate(p);
+    expect(decoded.cellIndex).toBeNull();
+    expect(Object.keys(decoded.channels)).toEqual(
+      ['vbusVoltage', 'vccVoltage', 'batteryVoltage', 'canVoltage', 'currentUa']);
+    expect(decodeAggregate(p.subarray(0, p.length - 1))).toBeNull();
+    p[0] = 0x11;
+    expect(decodeAggregate(p)).toBeNull();
+  });
+
   describe('decoder null-guards for short payloads', () => {
     it('decodeBootMarker returns null below 24 bytes', () => {
       expect(decodeBootMarker(new Uint8Array(23))).toBeNull();
@@ -163,6 +287,44 @@ describe('LogParser', () => {
     expect(records).toHaveLength(1);
   });
 
+  it('inflates a compressed download to the plain stream', () => {
+    const { plain, packed } = lzTextStreams();
+    expect(parseDclgHeader(packed).codec).toBe(LZ_CODEC);
+    expect(Array.from(inflateLogStream(packed))).toEqual(Array.from(plain));
+    expect(parseLogStream(packed)).toEqual(parseLogStream(plain));
+    expect(inflateLogStream(plain)).toBe(plain);
+  });
+
+  it('skips the type mask of a filtered download', () => {
+    const plain = buildStream([
+      buildRecord(FL_TYPE_BOOT_MARKER, bootMarkerPayload(42, 'v1.0.0', 3), { tsUs: 0 }),
+      buildRecord(FL_TYPE_CONSENSUS, new Uint8Array(14).fill(7), { tsUs: 1000 })
+    ]);
+    const header = plain.slice(0, 16);
+    header[5] = 0x02;
+    const mask = [0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00]; // 1 << 0x10
+    const filtered = new Uint8Array([...header, ...mask, ...plain.subarray(16)]);
+
+    const hdr = parseDclgHeader(filtered);
+    expect(hdr.typeMask).toBe(1n << 0x10n);
+    expect(hdr.headerLength).toBe(24);
+    expect(parseDclgHeader(plain).typeMask).toBeNull();
+    expect(parseLogStream(filtered)).toEqual(parseLogStream(plain));
+    expect(makeRecordCounter()(filtered)).toBe(2);
+  });
+
+  it('counts records of a compressed download as its bytes arrive', () => {
+    const { packed } = lzTextStreams();
+    const counter = makeRecordCounter();
+    let last = 0;
+    for (let i = 1; i <= packed.length; i++) {
+      const c = counter(packed.subarray(0, i));
+      expect(c).toBeGreaterThanOrEqual(last);
+      last = c;
+    }
+    expect(last).toBe(3);
+  });
+
   describe('makeRecordCounter (resumable progress)', () => {
     it('counts records incrementally as bytes arrive, resuming its cursor', () => {
       const stream = buildStream([
@@ -2,7 +2,7 @@
  * Build plottable typed-array channels from a flash-log telemetry stream.
  *
  * Input is the raw downloaded `.bin` (optional 16-byte DCLG header + TLV
- * records, BATCH containers flattened). Output is a `TelemetryModel`: one
+ * records, BATCH and PACKED BATCH containers flattened). Output is a `TelemetryModel`: one
  * table per record type (split per cell index where applicable), each holding
  * a Float64Array of times and a Float32Array per channel, plus discrete-event
  * arrays for the overlay layer.
@@ -22,7 +22,6 @@
  */
 
 import {
-  LOG_DCLG_HEADER_LEN,
   FL_ENTRY_HDR_LEN,
   FL_TYPE_BATCH,
   FL_TYPE_END_OF_STREAM,
@@ -39,6 +38,8 @@ import {
 } from '../uds/constants.js';
 import {
   parseDclgHeader,
+  expandPackedStream,
+  inflateLogStream,
   decodeBootMarker,
   decodeDiveMarker,
   DIVEO2_PRESSURE_LSB_PER_MBAR,
@@ -455,9 +456,13 @@ function buildSolenoidSpans(raw) {
  */
 export function buildTelemetry(input, opts = {}) {
   const report = opts.onProgress || (() => {});
-  const bytes = input instanceof Uint8Array ? input : new Uint8Array(input);
+  // A compressed download is inflated once; every later pass is offset-based.
+  const raw = inflateLogStream(input instanceof Uint8Array ? input : new Uint8Array(input));
+  const start = parseDclgHeader(raw)?.headerLength ?? 0;
+  // The offset-based walk below only knows plain BATCH containers; packed
+  // ones are expanded up front (a no-op copy-free pass on older logs).
+  const bytes = expandPackedStream(raw, start);
   const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
-  const start = parseDclgHeader(bytes) ? LOG_DCLG_HEADER_LEN : 0;
 
   report(0.05, 'Scanning records…');
   const scan = scanStream(bytes, view, start);
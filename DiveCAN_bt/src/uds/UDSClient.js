@@ -62,6 +62,7 @@ export class UDSClient extends EventEmitter {
     this.pendingResolve = null;
     this.pendingReject = null;
     this.pendingTimer = null;
+    this.pendingTimeout = null;
     this.pendingResponseMatcher = null;
     this.lastResponseTime = 0;
 
@@ -206,15 +207,18 @@ export class UDSClient extends EventEmitter {
       this.pendingReject = reject;
       this.pendingResponseMatcher = responseMatcher;
 
-      // Set timeout
-      this.pendingTimer = setTimeout(() => {
+      // Set timeout. Kept so a responsePending (NRC 0x78) can restart it.
+      const onTimeout = () => {
         this.pendingTimer = null;
+        this.pendingTimeout = null;
         this.pendingRequest = null;
         this.pendingResolve = null;
         this.pendingReject = null;
         this.pendingResponseMatcher = null;
         reject(new UDSError('Request timeout', sid, null, { timeout }));
-      }, timeout);
+      };
+      this.pendingTimeout = { ms: timeout, onTimeout };
+      this.pendingTimer = setTimeout(onTimeout, timeout);
 
       // Send request - handle rejection via promise chain
       this.transport.send(requestArray).catch(error => {
@@ -349,6 +353,17 @@ export class UDSClient extends EventEmitter {
       return;
     }
 
+    if (nrc === constants.NRC_RESPONSE_PENDING) {
+      // The head has the request and is still working on it (slow flash
+      // write, settings save): restart the timeout and keep waiting.
+      this.logger.debug(`Response pending: SID=0x${requestedSid.toString(16)}`);
+      if (this.pendingTimer && this.pendingTimeout) {
+        clearTimeout(this.pendingTimer);
+        this.pendingTimer = setTimeout(this.pendingTimeout.onTimeout, this.pendingTimeout.ms);
+      }
+      return;
+    }
+
     this.logger.warn(`Negative response: SID=0x${requestedSid.toString(16)}, NRC=0x${nrc.toString(16)}`);
 
     const error = new UDSError('Negative response', requestedSid, nrc);
@@ -453,6 +468,7 @@ export class UDSClient extends EventEmitter {
       clearTimeout(this.pendingTimer);
       this.pendingTimer = null;
     }
+    this.pendingTimeout = null;
   }
 
   /**
@@ -469,6 +485,8 @@ export class UDSClient extends EventEmitter {
     if (did === constants.DID_LOG_MESSAGE) {
       const message = new TextDecoder('utf-8').decode(payload);
       this.emit('logMessage', message);
+    } else if (did === constants.DID_LOG_TAIL) {
+      this.emit('logTail', payload);
     } else {
       this.emit('unsolicitedMessage', { did, payload });
     }
@@ -587,17 +605,20 @@ export class UDSClient extends EventEmitter {
    * @param {Object} [options]
    * @param {'BE'|'LE'} [options.sizeEndian='BE'] - Endianness of the SIZE field.
    *   OTA uses big-endian; log download uses little-endian.
+   * @param {number} [options.dataFormat=OTA_DATA_FMT] - dataFormatIdentifier
+   *   (compressionMethod << 4 | encryptingMethod).
    * @param {number} [timeout=30000] - Timeout in ms (slot1 erase is slow)
    * @returns {Promise<number>} Negotiated max block from the 0x74 response
    */
   async requestDownload(address, size, options = {}, timeout = 30000) {
     const sizeEndian = options.sizeEndian || 'BE';
+    const dataFormat = options.dataFormat ?? constants.OTA_DATA_FMT;
     const addrBytes = ByteUtils.uint32ToLE(address);
     const sizeBytes = sizeEndian === 'LE'
       ? ByteUtils.uint32ToLE(size)
       : ByteUtils.uint32ToBE(size);
     const request = ByteUtils.concat(
-      [constants.SID_REQUEST_DOWNLOAD, constants.OTA_DATA_FMT, constants.OTA_ADDR_LEN_FMT],
+      [constants.SID_REQUEST_DOWNLOAD, dataFormat, constants.OTA_ADDR_LEN_FMT],
       addrBytes,
       sizeBytes
     );
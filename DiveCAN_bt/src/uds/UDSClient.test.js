@@ -158,6 +158,34 @@ describe('UDSClient', () => {
         nrc: 0x31
       }));
     });
+
+    it('keeps waiting through responsePending and restarts the timeout', async () => {
+      vi.useFakeTimers();
+
+      const promise = client.readDataByIdentifier(0xF200);
+
+      vi.advanceTimersByTime(4000);
+      transport.emit('message', buildNegativeResponse(0x22, NRC.RESPONSE_PENDING));
+      vi.advanceTimersByTime(4000);
+      transport.emit('message', RESPONSES.RDBI.CONSENSUS_PPO2);
+
+      await expect(promise).resolves.toBeDefined();
+
+      vi.useRealTimers();
+    });
+
+    it('times out a full interval after the last responsePending', async () => {
+      vi.useFakeTimers();
+
+      const promise = client.readDataByIdentifier(0xF200);
+
+      transport.emit('message', buildNegativeResponse(0x22, NRC.RESPONSE_PENDING));
+      vi.advanceTimersByTime(6000);
+
+      await expect(promise).rejects.toThrow('timeout');
+
+      vi.useRealTimers();
+    });
   });
 
   describe('parseDIDValue', () => {
@@ -252,6 +280,13 @@ describe('UDSClient', () => {
       expect(handler).toHaveBeenCalledWith('USB');
     });
 
+    it('emits logTail with the raw record bytes for the live-tail DID', () => {
+      const handler = vi.fn();
+      client.on('logTail', handler);
+      expect(client.processUnsolicited([0x2E, 0xA1, 0x01, 0x10, 0x00, 0x00, 0x00])).toBe(true);
+      expect(handler).toHaveBeenCalledWith(new Uint8Array([0x10, 0x00, 0x00, 0x00]));
+    });
+
     it('does not feed non-WDBI side-channel traffic into a pending dialog', () => {
       const handler = vi.fn();
       client.on('response', handler);
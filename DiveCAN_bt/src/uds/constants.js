@@ -54,6 +54,7 @@ export const NRC_REQUEST_OUT_OF_RANGE = 0x31;
 export const NRC_SECURITY_ACCESS_DENIED = 0x33;
 export const NRC_GENERAL_PROGRAMMING_FAILURE = 0x72;
 export const NRC_WRONG_BLOCK_SEQUENCE = 0x73;
+export const NRC_RESPONSE_PENDING = 0x78;     // still working; keep waiting
 export const NRC_SERVICE_NOT_IN_SESSION = 0x7F;
 
 /** Human-readable NRC names, keyed by code. */
@@ -62,13 +63,14 @@ export const NRC_NAMES = {
   0x12: 'Sub-function Not Supported',
   0x13: 'Incorrect Message Length',
   0x14: 'Response Too Long',
-  0x21: 'Busy - Repeat Request (log index building; poll again)',
+  0x21: 'Busy - Repeat Request (another request or log index in progress; poll again)',
   0x22: 'Conditions Not Correct (dive gate / preconditions)',
   0x24: 'Request Sequence Error (out of state)',
   0x31: 'Request Out Of Range (unknown DID / bad value)',
   0x33: 'Security Access Denied',
   0x72: 'General Programming Failure',
   0x73: 'Wrong Block Sequence Counter',
+  0x78: 'Request Correctly Received - Response Pending',
   0x7F: 'Service Not Available In Active Session (needs programming session)'
 };
 
@@ -89,6 +91,11 @@ export const DID_SOLENOID_OVERRIDE = 0xF242;   // [channel, magic 0x5A] (HIL raw
 export const SOLENOID_OVERRIDE_MAGIC = 0x5A;
 export const DID_ERROR_HISTOGRAM = 0xF260;       // uint16[OP_ERR_MAX] LE (per-code counts)
 export const DID_ERROR_HISTOGRAM_CLEAR = 0xF261; // write any byte -> clear + persist
+export const DID_LATENCY_TRACE = 0xF216;         // [ver, count] + {count,min,p50,p99,max} u32 LE per stage
+export const DID_LATENCY_TRACE_CLEAR = 0xF217;   // write any byte -> clear (RAM only)
+export const DID_PLANT_ESTIMATE = 0xF218;        // 7 x f32 + updates/gain_updates u16 + converged u8, LE (33 B)
+/** Latency-trace stages in DID 0xF216 / LATENCY_SUMMARY order (LatencyStage_t). */
+export const LATENCY_STAGE_NAMES = ['Sample → Consensus', 'Consensus → Control', 'Sample → Control', 'Sample → Fire'];
 export const DID_CRASH_HISTORY = 0xF255;          // version/count + 5 x 24-byte records
 export const DID_REBOOT_HISTORY = 0xF256;         // version/count + 5 x 8-byte records
 
@@ -121,6 +128,8 @@ export const AUTOTUNE_ABORT_NAMES = ['None', 'Operator', 'Dive', 'Cell Fail', 'T
 
 // Unsolicited log-message push (Head -> client), sent as a WriteDataByIdentifier.
 export const DID_LOG_MESSAGE = 0xA100;
+// Unsolicited live-tail push: whole TLV records in DCLG body framing.
+export const DID_LOG_TAIL = 0xA101;
 
 // ============================================================================
 // MCUBoot / OTA management DIDs (0xF27x)
@@ -146,8 +155,20 @@ export const DID_LOG_SELECTOR_RESULT = 0xF281; // 20 bytes: last selector resolu
 export const DID_LOG_ERASE = 0xF282;           // write [stream_mask, magic 0xA5]
 export const DID_LOG_VERBOSITY = 0xF283;       // R/W u8 (1=ERR..4=DBG)
 export const DID_LOG_CAN_VERBOSE = 0xF284;     // R/W u8 bitmask bit0=RX bit1=TX
+export const DID_LOG_RESUME_TOKEN = 0xF285;    // 28 bytes: checkpoint of the last raw download
+export const LOG_RESUME_TOKEN_LEN = 28;
+export const LOG_RESUME_TOKEN_BODY_OFF = 24;   // u32 LE: body bytes before the checkpointed block
 export const LOG_ERASE_MAGIC = 0xA5;
 
+// ============================================================================
+// Transport DIDs (0xF29x)
+// ============================================================================
+export const DID_ISOTP_LINK_STATS = 0xF290;    // [ver, count] + 24 B per peer (see isotp_link.h)
+export const ISOTP_LINK_STATS_PEER_LEN = 24;
+export const DID_I2C1_BUS_STATS = 0xF291;      // [ver, count] + 34 B per i2c1 client (see i2c1_sched.h)
+export const I2C1_BUS_STATS_CLIENT_LEN = 34;
+export const DID_CAN_TX_STATS = 0xF292;        // 30 B: TX FIFO, frame counts, bus load (see divecan_counters.h)
+
 // ============================================================================
 // OTA pipeline constants (SID 0x34/0x36/0x37 + 0x31)
 // ============================================================================
@@ -168,15 +189,26 @@ export const LOG_DOWNLOAD_MAGIC = 0x47434C44;         // "DCLG" little-endian
 export const LOG_DOWNLOAD_MIN_BLOCK = 32;
 export const LOG_DOWNLOAD_DEFAULT_BLOCK = 253;
 export const LOG_DOWNLOAD_BLE_CHUNK = 61; // handset FC-overflows a 253-byte chunk
+export const LOG_DOWNLOAD_EXT_MAX_BLOCK = 4092; // >253 opts into extended-length ISO-TP (direct CAN only)
+// 0x34 dataFormatIdentifier (compressionMethod << 4 | encryptingMethod)
+export const LOG_DOWNLOAD_DATA_FMT_RAW = 0x00;
+export const LOG_DOWNLOAD_DATA_FMT_LZ = 0x10; // LZSS body, see LogParser.inflateLogStream
 
 // RoutineControl selector RIDs (0x31 0x01)
-export const LOG_RID_SELECT_BY_RANGE = 0xF100;    // UNIMPLEMENTED -> NRC 0x31
+export const LOG_RID_SELECT_BY_RANGE = 0xF100;    // params: stream(u8) + boot_id(u32 LE) + start_us(u64 LE) + end_us(u64 LE)
 export const LOG_RID_SELECT_BY_BOOT = 0xF101;     // params: stream(u8) + boot_id(u32 LE)
 export const LOG_RID_SELECT_BY_DIVE = 0xF102;     // params: stream(u8) + dive_id(u16 LE)
 export const LOG_RID_SELECT_LATEST_BOOT = 0xF103; // params: stream(u8)
 export const LOG_RID_SELECT_LATEST_DIVE = 0xF104; // params: stream(u8)
-export const LOG_RID_BEGIN_STREAM = 0xF105;       // no params (needs prior selection)
+export const LOG_RID_BEGIN_STREAM = 0xF105;       // optional type_mask u64 LE (needs prior selection)
 export const LOG_RID_SELECT_ALL = 0xF106;         // params: stream(u8); walk-free whole-ring select
+export const LOG_RID_SELECT_RESUME = 0xF107;      // params: the 0xF285 resume token (stream is its first byte)
+export const LOG_RID_LIVE_TAIL = 0xF108;          // params: type_mask u64 LE (+ budget u16 LE); zero mask ends it
+
+export const LOG_TAIL_LEASE_MS = 30000;  // head ends an unrenewed subscription after this
+export const LOG_TAIL_RENEW_MS = 10000;
+export const LOG_TAIL_BUDGET_MIN = 64;   // bytes/s, record headers included
+export const LOG_TAIL_BUDGET_MAX = 2048;
 
 export const LOG_STREAM_TELEMETRY = 0;
 export const LOG_STREAM_TEXT = 1;
@@ -193,11 +225,14 @@ export const FL_TYPE_SOLENOID_FIRE = 0x12;
 export const FL_TYPE_SOLENOID_CURRENT = 0x13;
 export const FL_TYPE_ATMOS_PRESSURE = 0x14;
 export const FL_TYPE_POWER_SNAPSHOT = 0x15;
+export const FL_TYPE_LATENCY_SUMMARY = 0x16;
 export const FL_TYPE_CELL_RAW_DIVEO2 = 0x20;
 export const FL_TYPE_CELL_RAW_O2S = 0x21;
 export const FL_TYPE_CELL_RAW_ANALOG = 0x22;
 export const FL_TYPE_ERROR_EVENT = 0x30;
 export const FL_TYPE_LOG_TEXT = 0x40;
+export const FL_TYPE_AGGREGATE = 0xFB; // decimated download only, see LogParser.decodeAggregate
+export const FL_TYPE_BATCH_PACKED = 0xFC; // delta/field-coded batch, see LogParser.expandPackedBatch
 export const FL_TYPE_BATCH = 0xFD;
 export const FL_TYPE_DROP_MARKER = 0xFE;
 export const FL_TYPE_END_OF_STREAM = 0xFF;
@@ -205,6 +240,12 @@ export const FL_TYPE_END_OF_STREAM = 0xFF;
 export const FL_ENTRY_HDR_LEN = 12; // type u8, flags u8, length u16 LE, ts u64 LE
 export const FL_FCB_STATS_LEN = 28; // natural-alignment C struct (not packed)
 export const LOG_DCLG_HEADER_LEN = 16;
+export const LOG_DCLG_FLAG_LZ = 0x01; // header flags: body is LZSS, codec byte = window<<4 | length bits
+export const LOG_DCLG_FLAG_FILTERED = 0x02; // header flags: type_mask u64 LE follows the header
+export const LOG_DCLG_MASK_LEN = 8;
+export const LOG_DCLG_FLAG_DECIMATED = 0x04; // header flags: records aggregated per BeginStream bucket
+export const LOG_DECIMATE_MAX_S = 3600; // BeginStream bucket_s ceiling
+export const LOG_LZ_MIN_MATCH = 2;
 
 /** Record type names for the log viewer. */
 export const FL_TYPE_NAMES = {
@@ -219,11 +260,14 @@ export const FL_TYPE_NAMES = {
   0x13: 'Solenoid Current',
   0x14: 'Atmospheric Pressure',
   0x15: 'Power Snapshot',
+  0x16: 'Latency Summary',
   0x20: 'Cell Raw (DiveO2)',
   0x21: 'Cell Raw (O2S)',
   0x22: 'Cell Raw (Analog)',
   0x30: 'Error Event',
   0x40: 'Log Text',
+  0xFB: 'Aggregate',
+  0xFC: 'Packed Batch',
   0xFD: 'Batch',
   0xFE: 'Drop Marker',
   0xFF: 'End Of Stream'
@@ -321,6 +365,7 @@ export const CELL_DID_AMBIENT_LIGHT = 0x0A;
 export const CELL_DID_PRESSURE = 0x0B;
 export const CELL_DID_HUMIDITY = 0x0C;
 export const CELL_DID_BROADCAST = 0x0D; // write-only: 0=stop, !=0=start cell #BCST
+export const CELL_DID_FILTER_STATS = 0x0E; // analog only, 32 B: filter shape, noise, group delay (Firmware/UDS.md)
 
 export const STATE_DIDS = {
   // PPO2 control state (0xF2xx)
@@ -330,6 +375,8 @@ export const STATE_DIDS = {
   DUTY_CYCLE:        { did: 0xF210, size: 4, type: 'float32', label: 'Duty Cycle' },
   INTEGRAL_STATE:    { did: 0xF211, size: 4, type: 'float32', label: 'Integral State' },
   SATURATION_COUNT:  { did: 0xF212, size: 2, type: 'uint16',  label: 'Saturation Count' },
+  SAMPLE_TO_CONSENSUS: { did: 0xF214, size: 4, type: 'uint32', label: 'Sample → Consensus', unit: 'µs' },
+  SAMPLE_TO_CONTROL: { did: 0xF215, size: 4, type: 'uint32',  label: 'Sample → Control', unit: 'µs' },
   UPTIME_SEC:        { did: 0xF220, size: 4, type: 'uint32',  label: 'Uptime (sec)' },
 
   // Power monitoring (0xF23x)
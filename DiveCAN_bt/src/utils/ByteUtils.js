@@ -214,6 +214,15 @@ export class ByteUtils {
     return bytes;
   }
 
+  /**
+   * Convert BigInt to 8 bytes little-endian
+   * @param {bigint|number} value - 64-bit value
+   * @returns {Uint8Array} 8 bytes in little-endian
+   */
+  static uint64ToLE(value) {
+    return ByteUtils.uint64ToBE(value).reverse();
+  }
+
   /**
    * Trim trailing padding characters (e.g. NUL/space) from a decoded string.
    * A plain linear scan, not a regex — avoids the non-linear-backtracking
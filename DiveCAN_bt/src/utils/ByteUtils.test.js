@@ -283,6 +283,18 @@ describe('ByteUtils', () => {
     });
   });
 
+  describe('uint64ToLE', () => {
+    it('converts BigInt to 8 bytes, low byte first', () => {
+      const result = ByteUtils.uint64ToLE(0x123456789ABCDEFn);
+      expect(Array.from(result)).toEqual([0xEF, 0xCD, 0xAB, 0x89, 0x67, 0x45, 0x23, 0x01]);
+    });
+
+    it('converts number to 8 bytes', () => {
+      const result = ByteUtils.uint64ToLE(256);
+      expect(Array.from(result)).toEqual([0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00]);
+    });
+  });
+
   describe('uint64ToBE/beToUint64 round-trip', () => {
     it('preserves values through round-trip', () => {
       const values = [0n, 1n, 0xFFFFFFFFn, 0x123456789ABCDEFn, 0xFFFFFFFFFFFFFFFFn];
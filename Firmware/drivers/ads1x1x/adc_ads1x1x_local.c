@@ -39,6 +39,7 @@
 
 #define ADC_CONTEXT_USES_KERNEL_TIMER
 #include "adc_context.h"
+#include "ads1x1x_scan.h"
 
 LOG_MODULE_REGISTER(ADS1X1X, CONFIG_ADC_LOG_LEVEL);
 
@@ -59,8 +60,41 @@ struct ads1x1x_channel_cfg {
 	uint16_t config;        /* CONFIG word (MUX/PGA/DR/MODE/COMP), without OS */
 	k_timeout_t ready_time; /* DR-derived data-ready delay for this channel */
 	bool differential;      /* selects resolution (16 diff / 15 single-ended) */
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+	uint32_t scan_period_us; /* continuous-mode pacing without RDY, see channel_setup */
+#endif
 };
 
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+#define ADS1X1X_SCAN_RING_MASK ((uint32_t)CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH - 1U)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH),
+	     "scan ring depth must be a power of two");
+BUILD_ASSERT(CONFIG_ADC_ADS1X1X_LOCAL_SCAN_BURST <= CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH,
+	     "a whole burst must fit in the scan ring");
+
+/* Back-off before re-selecting a channel after an I2C error or a missed RDY. */
+static const uint32_t ADS1X1X_SCAN_RETRY_MS = 10U;
+
+/* A slot keeps the low tick word only (8 B instead of 16 B per slot);
+ * ads1x1x_scan_drain() widens it against the current uptime, which is exact
+ * for any sample younger than 2^32 ticks. */
+struct ads1x1x_scan_slot {
+	uint32_t ticks_lo;
+	int16_t counts;
+};
+
+/* Single-producer/single-consumer ring: `head` is only advanced by the
+ * acquisition thread and `tail` only by the channel's consumer, so neither
+ * side takes a lock. Both indices run free and are masked on access. */
+struct ads1x1x_scan_ring {
+	atomic_t head;
+	atomic_t tail;
+	struct k_sem burst_sem; /* given once per completed burst */
+	struct ads1x1x_scan_slot slot[CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH];
+};
+#endif
+
 #if DT_ANY_COMPAT_HAS_PROP_STATUS_OKAY(ti_ads1115, alert_rdy_gpios) || \
 	DT_ANY_COMPAT_HAS_PROP_STATUS_OKAY(ti_ads1114, alert_rdy_gpios) || \
 	DT_ANY_COMPAT_HAS_PROP_STATUS_OKAY(ti_ads1015, alert_rdy_gpios) || \
@@ -213,6 +247,15 @@ struct ads1x1x_data {
 #ifdef ADC_ADS1X1X_TRIGGER
 	struct gpio_callback gpio_cb;
 	struct k_work work;
+#endif
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+	/* Set once by ads1x1x_scan_start() under the adc_context lock and never
+	 * cleared: from then on the acquisition thread owns the chip. */
+	atomic_t scanning;
+	struct ads1x1x_scan_ring scan_ring[ADS1X1X_MAX_CHANNELS];
+#ifdef ADC_ADS1X1X_TRIGGER
+	struct k_sem rdy_sem; /* one give per RDY pulse while scanning */
+#endif
 #endif
 
 	K_KERNEL_STACK_MEMBER(stack, CONFIG_ADC_ADS1X1X_LOCAL_ACQUISITION_THREAD_STACK_SIZE);
@@ -250,6 +293,18 @@ static inline int ads1x1x_setup_rdy_interrupt(const struct device *dev, bool ena
 }
 #endif
 
+static inline bool ads1x1x_has_rdy(const struct device *dev)
+{
+#ifdef ADC_ADS1X1X_TRIGGER
+	const struct ads1x1x_config *config = dev->config;
+
+	return (NULL != config->alert_rdy.port);
+#else
+	ARG_UNUSED(dev);
+	return false;
+#endif
+}
+
 static int ads1x1x_read_reg(const struct device *dev, enum ads1x1x_reg reg_addr, uint16_t *buf)
 {
 	const struct ads1x1x_config *config = dev->config;
@@ -542,6 +597,14 @@ static int ads1x1x_channel_setup(const struct device *dev,
 						data->ready_time;
 					data->channel_cfg[channel_cfg->channel_id].differential =
 						channel_cfg->differential;
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+					/* Timer-paced scan reads run 1/8 slower than the
+					 * nominal rate so the +/-10% oscillator can only
+					 * make them skip a conversion, never read one
+					 * twice. */
+					data->channel_cfg[channel_cfg->channel_id].scan_period_us =
+						ads_config->odr_delay[dr] + (ads_config->odr_delay[dr] / 8U);
+#endif
 					atomic_or(&data->channels, BIT(channel_cfg->channel_id));
 				}
 			}
@@ -638,8 +701,9 @@ static void adc_context_start_sampling(struct adc_context *ctx)
 		 */
 		adc_context_complete(ctx, ret);
 	} else {
-		/* Give semaphore only if the thread is running */
-		if (NULL != data->tid) {
+		/* Give semaphore only if the thread is running and paces reads;
+		 * with an RDY pin the thread exists only to run a scan. */
+		if ((NULL != data->tid) && (false == ads1x1x_has_rdy(data->dev))) {
 			k_sem_give(&data->acq_sem);
 		}
 	}
@@ -651,6 +715,12 @@ static int ads1x1x_adc_start_read(const struct device *dev, const struct adc_seq
 	struct ads1x1x_data *data = dev->data;
 
 	rc = ads1x1x_validate_sequence(dev, sequence);
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+	if ((0 == rc) && (0 != atomic_get(&data->scanning))) {
+		/* The acquisition thread owns this chip's I2C traffic now. */
+		rc = -EBUSY;
+	}
+#endif
 	if (0 == rc) {
 		/* Single bit, guaranteed by validate_sequence. Latch the channel for
 		 * start_conversion (runs under the adc_context lock taken by the caller). */
@@ -722,25 +792,31 @@ static int ads1x1x_adc_read_async(const struct device *dev, const struct adc_seq
 	return rc;
 }
 
+static int16_t ads1x1x_conv_to_counts(const struct device *dev, uint16_t raw)
+{
+	const struct ads1x1x_config *config = dev->config;
+
+	/* The ads101x stores it's 12b data in the upper part
+	 * while the ads111x uses all 16b in the register, so
+	 * shift down. Data is also signed, so perform
+	 * division rather than shifting
+	 */
+	int16_t divisor = (int16_t)((uint32_t)1 << (uint32_t)(ADS1X1X_FULL_SCALE_BITS - config->resolution));
+
+	return (int16_t)raw / divisor;
+}
+
 static int ads1x1x_adc_perform_read(const struct device *dev)
 {
 	int rc = 0;
 	struct ads1x1x_data *data = dev->data;
-	const struct ads1x1x_config *config = dev->config;
-	int16_t buf = 0;
+	uint16_t buf = 0;
 
 	rc = ads1x1x_read_reg(dev, ADS1X1X_REG_CONV, &buf);
 	if (0 != rc) {
 		adc_context_complete(&data->ctx, rc);
 	} else {
-		/* The ads101x stores it's 12b data in the upper part
-		 * while the ads111x uses all 16b in the register, so
-		 * shift down. Data is also signed, so perform
-		 * division rather than shifting
-		 */
-		int16_t divisor = (int16_t)((uint32_t)1 << (uint32_t)(ADS1X1X_FULL_SCALE_BITS - config->resolution));
-
-		*data->buffer++ = buf / divisor;
+		*data->buffer++ = ads1x1x_conv_to_counts(dev, buf);
 
 		adc_context_on_sampling_done(&data->ctx, dev);
 	}
@@ -753,6 +829,215 @@ static int ads1x1x_read(const struct device *dev, const struct adc_sequence *seq
 	return ads1x1x_adc_read_async(dev, sequence, NULL);
 }
 
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+/* Next set-up channel after `from`, wrapping; `from` itself when it is the
+ * only one. */
+static uint8_t ads1x1x_scan_next_channel(uint32_t channels, uint8_t from)
+{
+	uint8_t next = from;
+	bool found = false;
+
+	for (uint8_t i = 1U; (i <= ADS1X1X_MAX_CHANNELS) && (false == found); ++i) {
+		uint8_t ch = (uint8_t)((from + i) % ADS1X1X_MAX_CHANNELS);
+
+		if (0U != (channels & BIT(ch))) {
+			next = ch;
+			found = true;
+		}
+	}
+
+	return next;
+}
+
+/* Block until the chip has finished one more continuous conversion. */
+static int ads1x1x_scan_wait_conversion(const struct device *dev,
+					const struct ads1x1x_channel_cfg *cfg)
+{
+	int rc = 0;
+
+#ifdef ADC_ADS1X1X_TRIGGER
+	struct ads1x1x_data *data = dev->data;
+
+	if (ads1x1x_has_rdy(dev)) {
+		/* Two periods: a missed edge re-selects instead of stalling. */
+		rc = k_sem_take(&data->rdy_sem, K_USEC(2U * cfg->scan_period_us));
+	} else
+#else
+	ARG_UNUSED(dev);
+#endif
+	{
+		(void)k_sleep(K_USEC(cfg->scan_period_us));
+	}
+
+	return rc;
+}
+
+/* Point the MUX at a channel in continuous mode and let the input settle.
+ * Whether the write aborts the conversion in flight or lets it finish on the
+ * old MUX, the conversion after it is clean, so one discard covers both. */
+static int ads1x1x_scan_select(const struct device *dev, uint8_t ch)
+{
+	struct ads1x1x_data *data = dev->data;
+	const struct ads1x1x_channel_cfg *cfg = &data->channel_cfg[ch];
+	int rc = 0;
+
+#ifdef ADC_ADS1X1X_TRIGGER
+	k_sem_reset(&data->rdy_sem);
+#endif
+	rc = ads1x1x_write_reg(dev, ADS1X1X_REG_CONFIG,
+			       (uint16_t)(cfg->config & ~ADS1X1X_CONFIG_MODE));
+
+	for (uint32_t i = 0U; (0 == rc) && (i < CONFIG_ADC_ADS1X1X_LOCAL_SCAN_SETTLE); ++i) {
+		rc = ads1x1x_scan_wait_conversion(dev, cfg);
+	}
+
+	return rc;
+}
+
+static void ads1x1x_scan_push(struct ads1x1x_scan_ring *ring, int16_t counts, int64_t ticks)
+{
+	uint32_t head = (uint32_t)atomic_get(&ring->head);
+	uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+
+	if ((head - tail) >= (uint32_t)CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH) {
+		/* Consumer behind: the producer may not move `tail`, so the
+		 * newest sample is the one that goes. */
+		LOG_DBG("scan ring full, sample dropped");
+	} else {
+		ring->slot[head & ADS1X1X_SCAN_RING_MASK].ticks_lo = (uint32_t)ticks;
+		ring->slot[head & ADS1X1X_SCAN_RING_MASK].counts = counts;
+		(void)atomic_set(&ring->head, (atomic_val_t)(head + 1U));
+	}
+}
+
+/* Acquisition-thread body once scanning: visit each set-up channel for a
+ * burst, then move the MUX on. A lone channel is never re-selected, so it
+ * streams every conversion after the first settle. */
+static FUNC_NORETURN void ads1x1x_scan_run(const struct device *dev)
+{
+	struct ads1x1x_data *data = dev->data;
+	uint8_t ch = ads1x1x_scan_next_channel((uint32_t)atomic_get(&data->channels),
+					       ADS1X1X_MAX_CHANNELS - 1U);
+	bool selected = false;
+	uint16_t raw = 0;
+	int rc = 0;
+
+	LOG_DBG("scan started");
+
+	while (true) {
+		const struct ads1x1x_channel_cfg *cfg = &data->channel_cfg[ch];
+		struct ads1x1x_scan_ring *ring = &data->scan_ring[ch];
+		uint8_t next = ch;
+
+		if (false == selected) {
+			rc = ads1x1x_scan_select(dev, ch);
+			selected = (0 == rc);
+		}
+
+		for (uint32_t i = 0U; (0 == rc) && (i < CONFIG_ADC_ADS1X1X_LOCAL_SCAN_BURST); ++i) {
+			rc = ads1x1x_scan_wait_conversion(dev, cfg);
+			if (0 == rc) {
+				rc = ads1x1x_read_reg(dev, ADS1X1X_REG_CONV, &raw);
+			}
+			if (0 == rc) {
+				ads1x1x_scan_push(ring, ads1x1x_conv_to_counts(dev, raw),
+						  k_uptime_ticks());
+			}
+		}
+
+		if (0 != rc) {
+			LOG_ERR("scan of channel %u failed (err %d)", ch, rc);
+			selected = false;
+			rc = 0;
+			(void)k_sleep(K_MSEC(ADS1X1X_SCAN_RETRY_MS));
+		} else {
+			k_sem_give(&ring->burst_sem);
+			/* Re-read the mask: a channel set up after scan_start
+			 * joins on the next rotation. */
+			next = ads1x1x_scan_next_channel((uint32_t)atomic_get(&data->channels), ch);
+			selected = (next == ch);
+			ch = next;
+		}
+	}
+}
+
+int ads1x1x_scan_start(const struct device *dev)
+{
+	struct ads1x1x_data *data = dev->data;
+	int rc = 0;
+
+	/* Under the lock, so a read in flight finishes before the thread
+	 * takes over and every later read sees `scanning`. */
+	adc_context_lock(&data->ctx, false, NULL);
+
+	if (0U == (uint32_t)atomic_get(&data->channels)) {
+		rc = -EINVAL;
+	} else if (0 != atomic_get(&data->scanning)) {
+		/* Another consumer on this chip already started it. */
+	} else {
+#ifdef ADC_ADS1X1X_TRIGGER
+		if (ads1x1x_has_rdy(dev)) {
+			rc = ads1x1x_setup_rdy_pin(dev, true);
+			if (0 == rc) {
+				rc = ads1x1x_setup_rdy_interrupt(dev, true);
+			}
+		}
+#endif
+		if (0 == rc) {
+			(void)atomic_set(&data->scanning, 1);
+			k_sem_give(&data->acq_sem);
+		}
+	}
+
+	adc_context_release(&data->ctx, rc);
+
+	return rc;
+}
+
+int ads1x1x_scan_wait(const struct device *dev, uint8_t channel, k_timeout_t timeout)
+{
+	struct ads1x1x_data *data = dev->data;
+	int rc = 0;
+
+	if (channel >= ADS1X1X_MAX_CHANNELS) {
+		rc = -EINVAL;
+	} else {
+		rc = k_sem_take(&data->scan_ring[channel].burst_sem, timeout);
+	}
+
+	return rc;
+}
+
+size_t ads1x1x_scan_drain(const struct device *dev, uint8_t channel,
+			  struct ads1x1x_scan_sample *out, size_t max)
+{
+	struct ads1x1x_data *data = dev->data;
+	size_t n = 0U;
+
+	if ((channel < ADS1X1X_MAX_CHANNELS) && (NULL != out)) {
+		struct ads1x1x_scan_ring *ring = &data->scan_ring[channel];
+		uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+		uint32_t head = (uint32_t)atomic_get(&ring->head);
+		/* Read after `head`, so no slot is newer than `now`. */
+		int64_t now = k_uptime_ticks();
+
+		while ((tail != head) && (n < max)) {
+			const struct ads1x1x_scan_slot *slot = &ring->slot[tail & ADS1X1X_SCAN_RING_MASK];
+			uint32_t age = (uint32_t)now - slot->ticks_lo;
+
+			out[n].ticks = now - (int64_t)age;
+			out[n].counts = slot->counts;
+			++n;
+			++tail;
+		}
+
+		(void)atomic_set(&ring->tail, (atomic_val_t)tail);
+	}
+
+	return n;
+}
+#endif /* CONFIG_ADC_ADS1X1X_LOCAL_SCAN */
+
 static void ads1x1x_acquisition_thread(void *p1, void *p2, void *p3)
 {
 	ARG_UNUSED(p2);
@@ -765,6 +1050,13 @@ static void ads1x1x_acquisition_thread(void *p1, void *p2, void *p3)
 	while (true) {
 		k_sem_take(&data->acq_sem, K_FOREVER);
 
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+		if (0 != atomic_get(&data->scanning)) {
+			/* Scan mode is one-way: the thread stays in there. */
+			ads1x1x_scan_run(dev);
+		}
+#endif
+
 		rc = ads1x1x_wait_data_ready(dev);
 		if (0 != rc) {
 			LOG_ERR("failed to get ready status (err %d)", rc);
@@ -802,6 +1094,15 @@ static void ads1x1x_conv_ready_cb(const struct device *gpio_dev,
 	dev = data->dev;
 	config = dev->config;
 
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+	if (0 != atomic_get(&data->scanning)) {
+		/* Continuous mode pulses RDY once per conversion: leave the
+		 * interrupt armed and just pace the scan loop. */
+		k_sem_give(&data->rdy_sem);
+		return;
+	}
+#endif
+
 	if (config->alert_rdy.port) {
 		rc = ads1x1x_setup_rdy_pin(dev, false);
 		if (rc < 0) {
@@ -865,6 +1166,14 @@ static int ads1x1x_init(const struct device *dev)
 	data->last_converted_channel = -1;
 
 	k_sem_init(&data->acq_sem, 0, 1);
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+	for (uint8_t ch = 0U; ch < ADS1X1X_MAX_CHANNELS; ++ch) {
+		k_sem_init(&data->scan_ring[ch].burst_sem, 0, 1);
+	}
+#ifdef ADC_ADS1X1X_TRIGGER
+	k_sem_init(&data->rdy_sem, 0, 1);
+#endif
+#endif
 
 	if (!device_is_ready(config->bus.bus)) {
 		LOG_ERR("I2C bus %s not ready", config->bus.bus->name);
@@ -876,9 +1185,12 @@ static int ads1x1x_init(const struct device *dev)
 				LOG_ERR("Failed to initialize interrupt.");
 				rc = -EIO;
 			}
-		} else
+		}
 #endif
-		{
+		/* Without RDY the thread paces every read; with RDY it is only
+		 * needed to run a scan. */
+		if ((0 == rc) &&
+		    ((false == ads1x1x_has_rdy(dev)) || IS_ENABLED(CONFIG_ADC_ADS1X1X_LOCAL_SCAN))) {
 			LOG_DBG("Using acquisition thread");
 
 			data->tid =
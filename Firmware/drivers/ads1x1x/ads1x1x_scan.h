@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file ads1x1x_scan.h
+ * @brief Continuous-conversion scan mode of the board-local ADS1X1X driver.
+ *
+ * Once ads1x1x_scan_start() has been called on a chip, its acquisition
+ * thread owns the I2C traffic to it: the chip free-runs in continuous
+ * conversion, the thread walks the MUX across every set-up channel
+ * (discarding CONFIG_ADC_ADS1X1X_LOCAL_SCAN_SETTLE conversions after each
+ * switch) and pushes CONFIG_ADC_ADS1X1X_LOCAL_SCAN_BURST kept conversions
+ * per visit into that channel's ring. Each ring has one producer (the
+ * acquisition thread) and must have one consumer thread.
+ *
+ * Only built with CONFIG_ADC_ADS1X1X_LOCAL_SCAN.
+ */
+#ifndef ADS1X1X_SCAN_H
+#define ADS1X1X_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief One kept conversion. */
+struct ads1x1x_scan_sample {
+	int64_t ticks;  /**< k_uptime_ticks() when the conversion was read */
+	int16_t counts; /**< Same scaling as adc_read() on the channel */
+};
+
+/**
+ * @brief Switch a chip into scan mode.
+ *
+ * Waits for an in-flight adc_read() to finish. Idempotent, so every consumer
+ * on a shared chip may call it; a channel set up afterwards joins the scan
+ * on the next MUX rotation. From here on adc_read() on the chip returns
+ * -EBUSY.
+ *
+ * @param dev ADS1X1X device
+ * @return 0 on success, -EINVAL when no channel has been set up yet, or a
+ *         negative errno from configuring the ALERT/RDY interrupt
+ */
+int ads1x1x_scan_start(const struct device *dev);
+
+/**
+ * @brief Wait for the next completed burst on a channel.
+ *
+ * @param dev     ADS1X1X device
+ * @param channel DT channel_id
+ * @param timeout How long to wait
+ * @return 0 when a burst landed, -EAGAIN on timeout, -EINVAL on a bad channel
+ */
+int ads1x1x_scan_wait(const struct device *dev, uint8_t channel, k_timeout_t timeout);
+
+/**
+ * @brief Move buffered samples of a channel out of its ring, oldest first.
+ *
+ * Never blocks. Call from the channel's single consumer thread only.
+ *
+ * @param dev     ADS1X1X device
+ * @param channel DT channel_id
+ * @param out     Destination
+ * @param max     Capacity of @p out
+ * @return Number of samples written to @p out
+ */
+size_t ads1x1x_scan_drain(const struct device *dev, uint8_t channel,
+			  struct ads1x1x_scan_sample *out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADS1X1X_SCAN_H */
@@ -55,6 +55,7 @@ typedef enum {
     FL_TYPE_SOLENOID_CURRENT    = 0x13, /* T */
     FL_TYPE_ATMOS_PRESSURE      = 0x14, /* T */
     FL_TYPE_POWER_SNAPSHOT      = 0x15, /* T */
+    FL_TYPE_LATENCY_SUMMARY     = 0x16, /* T */
     FL_TYPE_CELL_RAW_DIVEO2     = 0x20, /* T */
     FL_TYPE_CELL_RAW_O2S        = 0x21, /* T */
     FL_TYPE_CELL_RAW_ANALOG     = 0x22, /* T */
@@ -65,6 +66,16 @@ typedef enum {
      * by FLUSH count, not record count (see fl_write_telemetry_batch). Payload is
      * a packed sequence of [fl_entry_hdr_t + sub-payload]. T-stream only; markers
      * stay as individual entries so the boot index walk still finds them. */
+    /* Packed batch container: the same telemetry sub-records as FL_TYPE_BATCH
+     * with delta-coded timestamps and field-coded consensus / PID / cell
+     * payloads (format in src/flash_log/flash_log_codec.h). This is what the
+     * writer emits; FL_TYPE_BATCH stays defined so clients can still decode
+     * downloads taken from older firmware. */
+    /* Aggregate: min/mean/max of one source type's numeric channels over a
+     * time bucket, computed by a decimated download (see
+     * src/flash_log/flash_log_aggregate.h). Never written to flash. */
+    FL_TYPE_AGGREGATE           = 0xFB, /* synthetic, download-only */
+    FL_TYPE_BATCH_PACKED        = 0xFC, /* T (container) */
     FL_TYPE_BATCH               = 0xFD, /* T (container) */
     FL_TYPE_DROP_MARKER         = 0xFE, /* synthetic, per-FCB */
     FL_TYPE_END_OF_STREAM       = 0xFF, /* synthetic, download-only */
@@ -128,6 +139,8 @@ typedef struct {
     uint8_t  kind;             /* one of the SOL_FIRE_EVT constants */
     uint32_t requested_on_us;
     uint32_t off_us;
+    uint32_t sample_seq;       /* traced cell sample behind an inject; 0 otherwise */
+    int64_t  sample_ticks;     /* that sample's timestamp_ticks; not written to flash */
 } SolenoidFireEvent_t;
 
 /* ---- PID snapshot payload ---- */
@@ -271,6 +284,14 @@ void flash_log_enqueue_atmos_pressure(uint16_t pressure_mbar);
 /** @brief Enqueue the periodic rail/current/battery status snapshot. */
 void flash_log_enqueue_power_snapshot(const FlashLogPowerSnapshot_t *snapshot);
 
+/**
+ * @brief Enqueue a latency-trace summary.
+ *
+ * @param summary Output of latency_trace_serialise()
+ * @param length  LATENCY_SUMMARY_BYTES; any other length is dropped
+ */
+void flash_log_enqueue_latency_summary(const uint8_t *summary, uint16_t length);
+
 /** @brief Enqueue a per-cell raw sample. */
 void flash_log_enqueue_cell_raw(const OxygenCellMsg_t *cell);
 
@@ -0,0 +1,207 @@
+/**
+ * @file i2c1_sched.h
+ * @brief Transaction scheduler for the shared i2c1 controller.
+ *
+ * Every STM32-initiated i2c1 transfer (analog cell and tank-pressure ADS1115
+ * reads, Poseidon HUD/battery frames) is described by an I2c1Txn_t and handed
+ * to i2c1_sched_run() / i2c1_sched_run_batch(). With CONFIG_I2C1_SCHEDULER a
+ * single thread owns the bus and works the queue:
+ *
+ *  - Order: lowest priority value first, then earliest deadline, then FIFO.
+ *  - Deadlines: a descriptor whose deadline passes before it gets the bus is
+ *    dropped with -ETIMEDOUT instead of running late.
+ *  - Retries: a retryable failure goes back on the queue behind its backoff,
+ *    so one client's collision storm no longer sleeps while holding the bus.
+ *    Exhausted retries get one classify+recover and a final try, exactly as
+ *    i2c1_transact().
+ *  - Merging: a descriptor to the same device as the one that just finished
+ *    runs back-to-back under the same bus hold, skipping the quiet-bus guard
+ *    (bounded by CONFIG_I2C1_SCHED_MERGE_MAX).
+ *  - Cell slot: while analog cells submit, every CONFIG_I2C1_SCHED_CELL_SLOT_MS
+ *    the first CONFIG_I2C1_SCHED_CELL_WINDOW_MS are reserved for cell reads,
+ *    and another client only starts if its typical occupancy ends before the
+ *    next reserved window.
+ *
+ * Without CONFIG_I2C1_SCHEDULER the same calls run inline in the caller with
+ * the pre-scheduler behaviour: a single descriptor through i2c1_transact(),
+ * a batch under one i2c1_bus_lock() hold with in-lock retries. Priority,
+ * deadline and the cell slot are then ignored. Per-client occupancy and
+ * wait statistics are kept in both modes.
+ */
+#ifndef I2C1_SCHED_H
+#define I2C1_SCHED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util_macro.h>
+
+#include "common.h"
+#include "i2c_bus_lock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Bus clients, for the per-client statistics and the cell slot. */
+typedef enum {
+    I2C1_CLIENT_CELL = 0,   /**< Analog oxygen cell ADS1115 reads */
+    I2C1_CLIENT_TANK,       /**< Tank pressure ADS1115 reads */
+    I2C1_CLIENT_POSEIDON,   /**< Poseidon HUD/battery frames */
+    I2C1_CLIENT_COUNT
+} I2c1Client_t;
+
+/** @brief Priorities, lowest value first. */
+#define I2C1_PRIO_CELL       0U  /**< Oxygen cell samples feed the PPO2 loop */
+#define I2C1_PRIO_URGENT     1U  /**< Time-bound one-off frames (fire-synchronous current read) */
+#define I2C1_PRIO_ACCESSORY  2U  /**< Poseidon output and heartbeat groups */
+#define I2C1_PRIO_BACKGROUND 3U  /**< Display-only readings (tank pressure) */
+
+/** @brief Device key of a transfer that must never be merged. */
+#define I2C1_DEVICE_NONE 0xFFFFU
+
+/**
+ * @brief 7-bit address of the ADC behind zephyr,user io-channels entry @p idx.
+ *
+ * I2C1_DEVICE_NONE when that ADC has no bus address (native_sim's adc-emul).
+ */
+#define I2C1_ADC_CHANNEL_ADDR(idx)                                            \
+    COND_CODE_1(DT_REG_HAS_IDX(DT_IO_CHANNELS_CTLR_BY_IDX(                    \
+                    DT_PATH(zephyr_user), idx), 0),                           \
+                ((uint16_t)DT_REG_ADDR(DT_IO_CHANNELS_CTLR_BY_IDX(            \
+                    DT_PATH(zephyr_user), idx))),                             \
+                (I2C1_DEVICE_NONE))
+
+/**
+ * @brief One queued i2c1 transfer.
+ *
+ * The caller fills the request fields (I2C1_TXN() does so) and keeps the
+ * descriptor alive until i2c1_sched_run*() returns; the scheduler owns the
+ * remaining fields meanwhile.
+ */
+typedef struct I2c1Txn {
+    /* Request */
+    I2c1XferFn_t xfer;           /**< Performs the transfer; runs on the scheduler thread */
+    void *ctx;                   /**< Passed through to @ref xfer */
+    I2c1Client_t client;
+    uint8_t priority;            /**< I2C1_PRIO_*; lower runs first */
+    uint8_t attempts;            /**< Tries before recovery (>= 1), as i2c1_transact() */
+    uint16_t device;             /**< 7-bit target address, or I2C1_DEVICE_NONE */
+    uint16_t backoff_base_ms;    /**< Backoff = base << (try - 1) + jitter */
+    uint16_t backoff_jitter_ms;
+    uint16_t deadline_ms;        /**< Drop if not started this long after submission; 0 = never */
+
+    /* Scheduler-owned */
+    Status_t result;             /**< Outcome once i2c1_sched_run*() returns */
+    sys_snode_t node;
+    struct I2c1Txn *next;        /**< Next member of the same batch */
+    struct k_sem *done;
+    uint32_t queued_ticks;       /**< Low 32 bits of k_uptime_ticks(); compared wrap-safe */
+    uint32_t not_before_ticks;
+    uint32_t deadline_ticks;
+    uint32_t seq;
+    uint8_t tries;
+    bool recovered;
+    bool started;
+} I2c1Txn_t;
+
+/**
+ * @brief Initialiser for the request fields of an I2c1Txn_t.
+ */
+#define I2C1_TXN(_xfer, _ctx, _client, _prio, _device, _attempts, _base_ms,   \
+                 _jitter_ms, _deadline_ms)                                    \
+    {                                                                         \
+        .xfer = (_xfer), .ctx = (_ctx), .client = (_client),                  \
+        .priority = (_prio), .attempts = (_attempts), .device = (_device),    \
+        .backoff_base_ms = (_base_ms), .backoff_jitter_ms = (_jitter_ms),     \
+        .deadline_ms = (_deadline_ms),                                        \
+    }
+
+/** @brief Statistics of one client since boot. */
+typedef struct {
+    uint32_t txns;               /**< Descriptors completed, successfully or not */
+    uint32_t merged;             /**< Transfers run back-to-back without the quiet-bus guard */
+    uint32_t retries;            /**< Tries after the first, recovery try included */
+    uint32_t failed;             /**< Descriptors completed with an error (expired included) */
+    uint32_t expired;            /**< Descriptors dropped at their deadline */
+    uint16_t occupancy_permille; /**< Share of uptime the bus spent on this client's transfers */
+    uint32_t busy_max_us;        /**< Longest single transfer */
+    uint32_t wait_mean_us;       /**< Mean submission → first start */
+    uint32_t wait_max_us;
+} I2c1ClientStats_t;
+
+/** @brief Version byte leading the serialised statistics. */
+#define I2C1_SCHED_STATS_VERSION 1U
+
+/** @brief Serialised form of one client's I2c1ClientStats_t. */
+#define I2C1_SCHED_CLIENT_BYTES ((8U * sizeof(uint32_t)) + sizeof(uint16_t))
+
+/** @brief Serialised statistics: version, client count, then every client. */
+#define I2C1_SCHED_STATS_BYTES \
+    (2U + ((size_t)I2C1_CLIENT_COUNT * I2C1_SCHED_CLIENT_BYTES))
+
+/**
+ * @brief Run one transfer and wait for its outcome.
+ *
+ * Must not be called from an xfer callback.
+ *
+ * @param txn Descriptor (see I2C1_TXN())
+ * @return 0 on success, -EINVAL on a malformed descriptor, -ETIMEDOUT when
+ *         its deadline passed before it could start, -EDEADLK from the
+ *         scheduler thread itself, or the last xfer / bus error.
+ */
+Status_t i2c1_sched_run(I2c1Txn_t *txn);
+
+/**
+ * @brief Run several transfers strictly in order and wait for all of them.
+ *
+ * Member n + 1 is queued only once member n has completed, so a failing
+ * frame's retries never let a later one overtake it; every member runs even
+ * if an earlier one failed. Consecutive members to the same device are
+ * merged into one bus hold.
+ *
+ * @param txns  Members, in order
+ * @param count Number of members (>= 1)
+ * @return 0 if every member succeeded, else the first member's error;
+ *         per-member outcomes are in each txns[i].result.
+ */
+Status_t i2c1_sched_run_batch(I2c1Txn_t *txns, size_t count);
+
+/**
+ * @brief Absolute timeout at the start of the next reserved cell window.
+ *
+ * Cell samplers sleep on this between reads so they stay phase-locked to
+ * the slot. K_NO_WAIT without CONFIG_I2C1_SCHEDULER.
+ */
+k_timeout_t i2c1_sched_next_cell_slot(void);
+
+/**
+ * @brief Copy one client's statistics.
+ *
+ * @param client Client to read; an out-of-range client reads as all zero
+ * @param out    Destination
+ */
+void i2c1_sched_stats(I2c1Client_t client, I2c1ClientStats_t *out);
+
+/**
+ * @brief Serialise every client's statistics, little-endian.
+ *
+ * Layout: version, client count, then per client txns, merged, retries,
+ * failed, expired (u32), occupancy ‰ (u16), busy max, wait mean, wait max
+ * (u32, µs).
+ *
+ * @param buf  Destination
+ * @param size Capacity of @p buf
+ * @return I2C1_SCHED_STATS_BYTES, or 0 when @p buf is NULL or too small
+ */
+size_t i2c1_sched_serialise(uint8_t *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* I2C1_SCHED_H */
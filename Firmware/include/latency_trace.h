@@ -0,0 +1,145 @@
+/**
+ * @file latency_trace.h
+ * @brief End-to-end latency tracing from cell sample to solenoid fire.
+ *
+ * Every real cell sample gets a sequence number from latency_trace_next_seq()
+ * when its driver publishes it. The sequence number and the sample's
+ * timestamp_ticks then ride along the control chain:
+ *
+ *   OxygenCellMsg_t → ConsensusMsg_t → PPO2ControlSnapshot_t → SolenoidFireEvent_t
+ *
+ * and each stage records how old the sample was when it got there. A stage
+ * records a sample once — the first time it acts on a new sequence number —
+ * so an idle re-vote or a PID cycle reusing the same consensus does not pile
+ * up inflated ages.
+ *
+ * Each stage keeps a log-scale histogram (two buckets per octave, so a
+ * percentile is good to within a quarter of its value) plus the exact min,
+ * max and count. Read over UDS DID 0xF216, cleared through 0xF217, and with
+ * CONFIG_FLASH_LOG written periodically as an FL_TYPE_LATENCY_SUMMARY record.
+ */
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Traced hops of the control chain. */
+typedef enum {
+    LATENCY_STAGE_SAMPLE_TO_CONSENSUS = 0, /**< Cell sample → consensus vote */
+    LATENCY_STAGE_CONSENSUS_TO_CONTROL,    /**< Consensus vote → first PID update using it */
+    LATENCY_STAGE_SAMPLE_TO_CONTROL,       /**< Cell sample → first PID update using it */
+    LATENCY_STAGE_SAMPLE_TO_FIRE,          /**< Cell sample behind the duty → inject solenoid opens */
+    LATENCY_STAGE_COUNT
+} LatencyStage_t;
+
+/** @brief Histogram buckets per stage; the last one is open-ended (≥ ~2.1 s). */
+#define LATENCY_BUCKET_COUNT     30U
+
+/** @brief Version byte leading the serialised summary. */
+#define LATENCY_SUMMARY_VERSION  1U
+
+/** @brief Serialised summary: version, stage count, then five u32 per stage. */
+#define LATENCY_SUMMARY_BYTES \
+    (2U + ((size_t)LATENCY_STAGE_COUNT * 5U * sizeof(uint32_t)))
+
+/** @brief Summary of one stage. All times in µs; all zero when count is 0. */
+typedef struct {
+    uint32_t count;   /**< Samples recorded since the last clear */
+    uint32_t min_us;
+    uint32_t p50_us;  /**< Upper edge of the median bucket, clamped to [min, max] */
+    uint32_t p99_us;  /**< Upper edge of the 99th-percentile bucket, clamped to [min, max] */
+    uint32_t max_us;
+} LatencyStats_t;
+
+/**
+ * @brief Start the periodic FL_TYPE_LATENCY_SUMMARY record.
+ *
+ * No-op without CONFIG_FLASH_LOG or when
+ * CONFIG_LATENCY_TRACE_LOG_INTERVAL_S is 0. Recording works without it.
+ */
+void latency_trace_init(void);
+
+/**
+ * @brief Allocate the sequence number for a new cell sample.
+ *
+ * Safe from any thread. Never returns 0, which marks an untraced message
+ * (init publishes, boot defaults, flush events).
+ */
+uint32_t latency_trace_next_seq(void);
+
+/**
+ * @brief Convert a tick interval to µs, clamped to [0, UINT32_MAX].
+ *
+ * @param ticks Interval in kernel ticks; negative reads as 0
+ * @return Interval in µs
+ */
+uint32_t latency_trace_ticks_to_us(int64_t ticks);
+
+/**
+ * @brief Record one latency sample against a stage.
+ *
+ * Safe from any thread; never blocks.
+ *
+ * @param stage  Stage to record; out-of-range values are ignored
+ * @param us     Latency in µs
+ */
+void latency_trace_record(LatencyStage_t stage, uint32_t us);
+
+/**
+ * @brief Record the interval between two tick stamps against a stage.
+ *
+ * @param stage      Stage to record
+ * @param from_ticks Start stamp; ≤ 0 means "no sample" and records nothing
+ * @param to_ticks   End stamp
+ * @return The interval in µs, or 0 when nothing was recorded
+ */
+uint32_t latency_trace_record_span(LatencyStage_t stage, int64_t from_ticks,
+                                   int64_t to_ticks);
+
+/**
+ * @brief Summarise one stage.
+ *
+ * @param stage Stage to read
+ * @param out   Destination; zeroed for an out-of-range stage
+ */
+void latency_trace_stats(LatencyStage_t stage, LatencyStats_t *out);
+
+/**
+ * @brief Serialise every stage's summary.
+ *
+ * Layout: [version u8][stage_count u8] then per stage
+ * {count, min, p50, p99, max} as u32 LE — shared by DID 0xF216 and the
+ * FL_TYPE_LATENCY_SUMMARY payload.
+ *
+ * @param buf    Destination
+ * @param size   Capacity of @p buf
+ * @return LATENCY_SUMMARY_BYTES, or 0 on NULL or a short buffer
+ */
+size_t latency_trace_serialise(uint8_t *buf, size_t size);
+
+/** @brief Discard every stage's histogram. Safe from any thread. */
+void latency_trace_clear(void);
+
+/**
+ * @brief Histogram bucket for a latency.
+ *
+ * Bucket 0 holds everything below 128 µs; above that each octave splits in
+ * two. Exposed for the unit tests.
+ */
+uint8_t latency_trace_bucket(uint32_t us);
+
+/** @brief Exclusive upper edge of a bucket in µs (UINT32_MAX for the last). */
+uint32_t latency_trace_bucket_upper_us(uint8_t bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_TRACE_H */
@@ -7,15 +7,18 @@
  * never live at the same time:
  *
  *   - UDS OTA:   `struct flash_img_context` (write-coalescing buffer for the
- *                slot1 download, CONFIG_IMG_BLOCK_BUF_SIZE inside) — live from
- *                RequestDownload (0x34) until the SM returns to IDLE.
+ *                slot1 download, CONFIG_IMG_BLOCK_BUF_SIZE inside) plus two
+ *                253 B TransferData staging slots for the background writer
+ *                — live from RequestDownload (0x34) until the SM returns to
+ *                IDLE.
  *   - Factory:   the capture/restore chunk buffer
  *                (CONFIG_FACTORY_IMAGE_CHUNK_SIZE) — live for one copy loop.
  *   - Log read:  the per-sector dive/boot index the UDS log-download
  *                selectors use — rebuilt lazily; contents are a pure cache
  *                of what is on flash.
- *   - Log stream: no scratch storage, but an exclusive reservation spanning
- *                 the external-flash download.
+ *   - Log stream: an exclusive reservation spanning the external-flash
+ *                 download; a compressed download also keeps its LZ window
+ *                 (≈ 780 B) here, see maint_arena_mark_scratch().
  *   - Flash ops: no scratch storage, but an exclusive reservation for short
  *                UDS maintenance operations such as log erase / force revert.
  *   - Autotune:  paired 80-sample effective-duty/PPO2 response traces, held
@@ -53,8 +56,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
-/** Arena byte size. Current tenants: flash_img_context ≈ 1080 B
- *  (CONFIG_IMG_BLOCK_BUF_SIZE=1024 + stream-flash bookkeeping), factory
+/** Arena byte size. Current tenants: OTA ≈ 1600 B (flash_img_context ≈
+ *  1080 B — CONFIG_IMG_BLOCK_BUF_SIZE=1024 + stream-flash bookkeeping — plus
+ *  2 × 256 B staging slots), factory
  *  chunk 1024 B, autotune trace 640 B, log index (192+32)×8 = 1792 B.
  *
  *  The 1792 B figure is tuned for the 32-bit STM32L431 target (which uses
@@ -108,6 +112,19 @@ void *maint_arena_claim(MaintArenaOwner_t owner);
  */
 void maint_arena_release(MaintArenaOwner_t owner);
 
+/**
+ * @brief Record that the current holder has started writing scratch bytes.
+ *
+ * For a reservation-only owner that decides mid-claim to use the arena
+ * memory (LOG_STREAM switches to a compressed download at 0x34, after its
+ * claim at BeginStream). Treated like a scratch-writing claim: the
+ * generation is bumped once, so a warm log-index cache is rebuilt on its
+ * next use rather than trusted over the overwritten bytes.
+ *
+ * @param owner Current holder; no-op if @p owner does not hold the arena.
+ */
+void maint_arena_mark_scratch(MaintArenaOwner_t owner);
+
 /**
  * @brief Pin/unpin the log-index cache against eviction during an async build.
  *
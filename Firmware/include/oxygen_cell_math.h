@@ -19,6 +19,10 @@
  * Pure function — no OS calls, no side effects. The caller provides the
  * current tick count so the function remains testable without mocks.
  *
+ * Votes with consensus_calculate_sorted() when CONFIG_CONSENSUS_SORTED_VOTER
+ * is set, else with consensus_calculate_fixed() when CONFIG_PPO2_FIXED_POINT
+ * is set, else with consensus_calculate_float().
+ *
  * @param cells           Array of cell messages (indexed 0..count-1)
  * @param count           Number of cells (1-3)
  * @param now_ticks       Current value of k_uptime_ticks()
@@ -30,6 +34,89 @@ ConsensusMsg_t consensus_calculate(const OxygenCellMsg_t cells[],
                                    int64_t now_ticks,
                                    int64_t staleness_ticks);
 
+/**
+ * @brief Float reference consensus: averages and deviation checks in
+ *        PrecisionPPO2_t, wire value through ppo2_centibar_to_wire().
+ *
+ * Parameters and result as consensus_calculate().
+ */
+ConsensusMsg_t consensus_calculate_float(const OxygenCellMsg_t cells[],
+                                         uint8_t count,
+                                         int64_t now_ticks,
+                                         int64_t staleness_ticks);
+
+/**
+ * @brief Fixed-point consensus: each included cell is converted once to
+ *        int32 centibar Q16 and the vote runs in integers.
+ *
+ * The mean of the cells it keeps is then taken and rounded exactly as
+ * consensus_calculate_float() does, so for the same vote consensus_ppo2 and
+ * precision_consensus match it to the bit. The votes agree for any reading
+ * on a 2^-10 bar grid up to 2.56 bar; off the grid they can differ only
+ * where a deviation is within ~1e-4 cbar of MAX_DEVIATION.
+ *
+ * Parameters and result as consensus_calculate().
+ */
+ConsensusMsg_t consensus_calculate_fixed(const OxygenCellMsg_t cells[],
+                                         uint8_t count,
+                                         int64_t now_ticks,
+                                         int64_t staleness_ticks);
+
+/**
+ * @brief Consensus through the N-sensor sorted-window voter
+ *        (consensus_vote_sorted()) over the included cells.
+ *
+ * Staleness, status and 1-cell handling are those of consensus_calculate();
+ * for two or three cells the result matches consensus_calculate_fixed()
+ * exactly.
+ *
+ * Parameters and result as consensus_calculate().
+ */
+ConsensusMsg_t consensus_calculate_sorted(const OxygenCellMsg_t cells[],
+                                          uint8_t count,
+                                          int64_t now_ticks,
+                                          int64_t staleness_ticks);
+
+/** @brief Most sensors consensus_vote_sorted() accepts (dual-head: 2 x 3). */
+#define CONSENSUS_MAX_SENSORS 6U
+
+/** @brief Outcome of consensus_vote_sorted(). */
+typedef struct {
+    PPO2_t ppo2;               /**< Voted PPO2 (centibar), PPO2_FAIL when no cluster */
+    PrecisionPPO2_t precision; /**< Voted PPO2 in bar */
+    uint8_t included_mask;     /**< Bit i set when sensor i is in the cluster */
+    uint8_t confidence;        /**< Sensors in the cluster (0 when none) */
+} ConsensusVote_t;
+
+/**
+ * @brief Vote up to CONSENSUS_MAX_SENSORS readings.
+ *
+ * Readings are converted once to centibar Q16 and sorted with a 6-input
+ * sorting network. A window of neighbouring sorted readings agrees when its
+ * tightest adjacent pair is within MAX_DEVIATION and every member lies within
+ * MAX_DEVIATION of that pair's weighted mean. The widest agreeing window wins;
+ * equal widths go to the smaller spread, then to the seed pair whose lower
+ * then higher sensor index is smaller. Its weighted mean, membership and size
+ * are the result.
+ *
+ * For two or three unit-weight sensors this is exactly the pairwise vote of
+ * consensus_calculate_fixed().
+ *
+ * A single candidate is reported with included_mask 0 and confidence 0, as
+ * consensus_calculate() reports a lone cell.
+ *
+ * @param ppo2_bar Readings in bar, indexed 0..count-1
+ * @param weights  Per-sensor weight, or NULL for all 1. A sensor with weight
+ *                 0 is not a candidate.
+ * @param count    Number of readings (at most CONSENSUS_MAX_SENSORS; any
+ *                 beyond are ignored)
+ * @param out      Result
+ */
+void consensus_vote_sorted(const PrecisionPPO2_t ppo2_bar[],
+                           const uint8_t weights[],
+                           uint8_t count,
+                           ConsensusVote_t *out);
+
 /**
  * @brief Count how many cells were included in the consensus vote.
  *
@@ -78,6 +165,86 @@ Millivolts_t analog_counts_to_mv(int16_t adc_counts);
  */
 Numeric_t analog_calculate_ppo2(int16_t adc_counts, CalCoeff_t cal_coeff);
 
+/* ---- Analog filter stage ---- */
+
+/**
+ * @brief State of one analog cell's fixed-point filter.
+ *
+ * All arithmetic is integer: the window holds raw counts, the IIR state is
+ * counts in Q8 and the noise tracker is a Q4 running mean of the squared
+ * first difference. Owned by a single cell thread; not thread-safe.
+ */
+typedef struct {
+    AnalogFilterConfig_t cfg;
+    int16_t window[ANALOG_FILTER_MAX_TAPS];
+    uint8_t fill;          /**< Samples in the current block */
+    bool primed;           /**< last_in/iir_q8 hold a sample */
+    int16_t last_in;
+    int32_t iir_q8;
+    uint32_t diff_sq_q4;   /**< Running mean of (x[n] - x[n-1])^2, Q4 */
+    uint32_t samples_in;
+    uint32_t samples_out;
+} AnalogFilter_t;
+
+/**
+ * @brief Reset a filter and apply its configuration.
+ *
+ * An out-of-range configuration is replaced by ANALOG_FILTER_NONE so a bad
+ * build setting degrades to unfiltered readings rather than no readings.
+ *
+ * @param filter Filter to reset
+ * @param cfg    Requested configuration
+ * @return true if @p cfg was applied as given
+ */
+bool analog_filter_init(AnalogFilter_t *filter, AnalogFilterConfig_t cfg);
+
+/**
+ * @brief Feed one ADC sample through the filter.
+ *
+ * Every filter except ANALOG_FILTER_NONE decimates by cfg.taps: an output is
+ * produced on every taps-th sample. Mean and median are computed over that
+ * block; the IIR runs on every sample and is read out once per block.
+ *
+ * @param filter Filter state
+ * @param counts Raw ADS1115 counts
+ * @param out    Receives the filtered counts when the return is true
+ * @return true when @p out holds a new filtered reading
+ */
+bool analog_filter_push(AnalogFilter_t *filter, int16_t counts, int16_t *out);
+
+/**
+ * @brief White-noise gain of a filter configuration.
+ *
+ * Mean: 1/sqrt(N). Median: sqrt(pi / 2N), the large-N Gaussian result, so
+ * slightly optimistic for N = 3..5. IIR: sqrt(alpha / (2 - alpha)).
+ *
+ * @param cfg Filter configuration
+ * @return Output / input RMS noise in permille (1000 = no reduction)
+ */
+uint16_t analog_filter_noise_gain_permille(AnalogFilterConfig_t cfg);
+
+/**
+ * @brief Group delay of a filter configuration at DC.
+ *
+ * Mean and median report the centre of their block, (N - 1) / 2 samples.
+ * The IIR reports (1 - alpha) / alpha = 2^shift - 1 samples.
+ *
+ * @param cfg Filter configuration
+ * @return Group delay in tenths of an input sample
+ */
+uint16_t analog_filter_group_delay_dsamples(AnalogFilterConfig_t cfg);
+
+/**
+ * @brief Fill a stats snapshot from a filter's state.
+ *
+ * @param filter           Filter state
+ * @param sample_period_us Interval between input samples, 0 if unknown
+ * @param out              Destination
+ */
+void analog_filter_stats(const AnalogFilter_t *filter,
+                         uint32_t sample_period_us,
+                         AnalogFilterStats_t *out);
+
 /* ---- Calibration math ---- */
 
 /**
@@ -92,11 +92,66 @@ typedef enum {
  */
 void diveo2_request_broadcast(uint8_t cell_number, bool on);
 
+/* ---- Analog filter stage ---- */
+
+/** @brief Longest analog filter window / decimation factor (samples). */
+#define ANALOG_FILTER_MAX_TAPS 16U
+
+/** @brief Filter applied to an analog cell's ADC samples before publishing.
+ *
+ * Values are the wire encoding on the 0xF4NE filter-stats DID.
+ */
+typedef enum {
+    ANALOG_FILTER_NONE = 0,   /**< Publish every sample unfiltered */
+    ANALOG_FILTER_MEAN = 1,   /**< Block mean (boxcar FIR) of taps samples */
+    ANALOG_FILTER_MEDIAN = 2, /**< Median of taps samples */
+    ANALOG_FILTER_IIR = 3,    /**< First-order IIR, alpha = 2^-iir_shift */
+} AnalogFilterKind_t;
+
+/** @brief Build-time configuration of one analog cell's filter. */
+typedef struct {
+    AnalogFilterKind_t kind;
+    uint8_t taps;       /**< Window length and decimation factor (1..ANALOG_FILTER_MAX_TAPS) */
+    uint8_t iir_shift;  /**< IIR alpha = 2^-iir_shift (1..8); ignored otherwise */
+} AnalogFilterConfig_t;
+
+/** @brief Noise and latency figures of an analog cell's filter.
+ *
+ * Noise is estimated from the first difference of successive input samples,
+ * so slow PPO2 changes do not read as noise. Output noise is the input noise
+ * scaled by the filter's white-noise gain.
+ */
+typedef struct {
+    AnalogFilterKind_t kind;
+    uint8_t taps;
+    uint8_t iir_shift;
+    uint32_t samples_in;           /**< ADC samples fed to the filter */
+    uint32_t samples_out;          /**< Filtered readings produced */
+    uint32_t sample_period_us;     /**< Mean interval between input samples; 0 = unknown */
+    uint32_t input_noise_nv;       /**< RMS input noise at the cell, nV */
+    uint32_t output_noise_nv;      /**< RMS output noise at the cell, nV */
+    uint16_t noise_gain_permille;  /**< Output / input RMS noise for white noise */
+    uint16_t group_delay_dsamples; /**< Group delay in tenths of an input sample */
+    uint32_t group_delay_us;       /**< Group delay at sample_period_us; 0 = unknown */
+} AnalogFilterStats_t;
+
+/**
+ * @brief Snapshot the filter figures of an analog cell.
+ *
+ * Safe to call from any thread; the cell thread refreshes the snapshot
+ * under a lock on every filter output.
+ *
+ * @param cell_number Zero-based cell index (0..CELL_MAX_COUNT-1).
+ * @param out         Destination for the snapshot.
+ * @return false if the cell is not an analog cell or @p out is NULL.
+ */
+bool analog_cell_filter_stats(uint8_t cell_number, AnalogFilterStats_t *out);
+
 /* ---- zbus message types ---- */
 
 /** @brief Per-cell reading published on chan_cell_1..3.
  *
- * Common fields (cell_number .. timestamp_ticks) are populated by every
+ * Common fields (cell_number .. sample_seq) are populated by every
  * driver. The trailing ancillary fields are populated by the cell type that
  * has the data — DiveO2 #DRAW responses fill temperature/err_code/phase/
  * intensity/ambient-light/backside-pressure/housing-humidity fields; analog
@@ -110,6 +165,7 @@ typedef struct {
     Millivolts_t millivolts;
     CellStatus_t status;
     int64_t timestamp_ticks;   /**< k_uptime_ticks() — 64-bit, no overflow */
+    uint32_t sample_seq;       /**< latency_trace_next_seq() for a real sample; 0 on init publishes */
     int32_t raw_sample;        /**< Cell-native raw reading (analog: ADC counts; DiveO2: PPO2 in 10^-3 hPa) */
     int32_t temperature_mc;    /**< Temperature in milli-°C (DiveO2 native, 10^-3 °C); 0 otherwise */
     uint32_t err_code;         /**< Digital cell raw error word; 0 otherwise */
@@ -130,6 +186,9 @@ typedef struct {
     CellStatus_t status_array[CELL_MAX_COUNT];
     bool include_array[CELL_MAX_COUNT];
     uint8_t confidence;        /**< Number of cells that voted in (0-3) */
+    int64_t sample_ticks;      /**< Newest cell timestamp_ticks behind this vote; 0 = none */
+    uint32_t sample_seq;       /**< sample_seq of that newest cell; 0 = untraced */
+    int64_t consensus_ticks;   /**< k_uptime_ticks() when the vote was computed */
 } ConsensusMsg_t;
 
 /* ---- Calibration types ---- */
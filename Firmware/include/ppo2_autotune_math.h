@@ -20,6 +20,7 @@ typedef struct {
     PIDNumeric_t baseline_duty;
     PIDNumeric_t final_ppo2_bar;
     PIDNumeric_t final_duty;
+    PIDNumeric_t settled_gain;       /**< mixed PPO2 bar per duty-second delivered */
     bool valid;
 } AutotunePlantModel_t;
 
@@ -31,6 +32,9 @@ bool autotune_identify_plant(const PIDNumeric_t *duty,
                  PIDNumeric_t baseline_noise_bar,
                  AutotunePlantModel_t *model);
 
+/** Robustness factor (1..3) for the mixing reversal relative to the settled rise. */
+PIDNumeric_t autotune_mixing_guard(const AutotunePlantModel_t *model);
+
 /** Derive conservative PI gains for the identified integrating delayed plant. */
 bool autotune_model_pid(const AutotunePlantModel_t *model,
             PIDNumeric_t controller_dt_s,
@@ -1,6 +1,6 @@
 /**
  * @file ppo2_control.h
- * @brief PPO2 control subsystem — PID and MK15 solenoid control.
+ * @brief PPO2 control subsystem — PID, MK15 and MPC solenoid control.
  *
  * Two `K_THREAD_DEFINE` threads (gated on CONFIG_HAS_O2_SOLENOID) that
  * subscribe to the consensus / setpoint / atmospheric-pressure zbus
@@ -24,12 +24,16 @@
 #include <stdint.h>
 #include "common.h"
 #include "runtime_settings.h"
+#include "ppo2_autotune_math.h"
 
 /** @brief Read-only snapshot of live PID state for UDS state DIDs. */
 typedef struct {
     Numeric_t duty_cycle;       /**< Latest computed duty cycle (0.0–1.0) */
     Numeric_t integral_state;   /**< Current integrator value */
     uint16_t saturation_count;  /**< Consecutive cycles spent at integral limit */
+    uint32_t sample_to_consensus_us; /**< Last PID input: cell sample → consensus vote */
+    uint32_t sample_to_control_us;   /**< Last PID input: cell sample → PID update */
+    uint32_t sample_seq;             /**< Last PID input: traced sample sequence number */
 } PPO2ControlSnapshot_t;
 
 /**
@@ -138,4 +142,25 @@ void ppo2_control_set_autotune_duty(bool enabled, Numeric_t duty);
 Numeric_t ppo2_control_effective_duty(Numeric_t commanded_duty,
                      uint16_t pressure_mbar);
 
+/**
+ * @brief Replace the plant model the MPC pulse planner works from.
+ *
+ * Boot uses a compiled-in model identified against the typical loop profile.
+ * A valid model supplied here (e.g. from plant identification) takes effect
+ * at the next fire cycle; the planner restarts its drift estimate from the
+ * new model's baseline but keeps the pulses already in flight.  Only consumed
+ * in `PPO2CONTROL_MPC` mode.  No-op on no-solenoid variants.
+ *
+ * @param model Identified model; ignored if NULL or not valid
+ * @return true if the model was accepted
+ */
+bool ppo2_control_set_plant_model(const AutotunePlantModel_t *model);
+
+/**
+ * @brief Copy out the plant model the MPC planner is currently using.
+ *
+ * @param out Destination (silent no-op if NULL); zeroed on no-solenoid variants
+ */
+void ppo2_control_get_plant_model(AutotunePlantModel_t *out);
+
 #endif /* PPO2_CONTROL_H */
@@ -95,6 +95,9 @@ void pid_state_reset_dynamic(PIDState_t *state);
  * count tracks consecutive cycles spent at integral_max/integral_min and
  * resets when the integrator leaves the limit.
  *
+ * Runs pid_update_fixed() when CONFIG_PPO2_FIXED_POINT is set, else
+ * pid_update_float().
+ *
  * @param d_setpoint Desired PPO2 in bar
  * @param measurement Current consensus PPO2 in bar
  * @param state PID state — integrator, derivative state, saturation count
@@ -104,6 +107,24 @@ void pid_state_reset_dynamic(PIDState_t *state);
 PIDNumeric_t pid_update(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
             PIDState_t *state);
 
+/**
+ * @brief Float reference PID step. Parameters and result as pid_update().
+ */
+PIDNumeric_t pid_update_float(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
+            PIDState_t *state);
+
+/**
+ * @brief Fixed-point PID step. Parameters and result as pid_update().
+ *
+ * Inputs, gains and state are converted to Q24 (saturating at +-127), the
+ * step runs in int64 with products rounded half away from zero, and the
+ * integrator is written back as a Q24 value, which a float holds exactly.
+ * Output tracks pid_update_float() to about 1e-6 per step; the sequence of
+ * outputs is identical on every build that runs it.
+ */
+PIDNumeric_t pid_update_fixed(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
+            PIDState_t *state);
+
 /**
  * @brief Compute the depth-compensation coefficient from ambient pressure.
  *
@@ -144,6 +165,9 @@ PIDNumeric_t pid_depth_comp_coeff(uint16_t pressure_mbar);
  * @param min_fire_ms Hardware-minimum on time (typically 200 ms)
  * @param max_fire_ms Hardware-maximum on time (typically 4900 ms)
  * @return Fire timing for this cycle
+ *
+ * Runs pid_compute_fire_timing_fixed() when CONFIG_PPO2_FIXED_POINT is set,
+ * else pid_compute_fire_timing_float().
  */
 FireTiming_t pid_compute_fire_timing(PIDNumeric_t duty,
                      uint16_t pressure_mbar,
@@ -152,6 +176,35 @@ FireTiming_t pid_compute_fire_timing(PIDNumeric_t duty,
                      uint32_t min_fire_ms,
                      uint32_t max_fire_ms);
 
+/**
+ * @brief Float reference fire timing. Parameters and result as
+ *        pid_compute_fire_timing().
+ */
+FireTiming_t pid_compute_fire_timing_float(PIDNumeric_t duty,
+                     uint16_t pressure_mbar,
+                     bool depth_comp_enabled,
+                     uint32_t total_cycle_ms,
+                     uint32_t min_fire_ms,
+                     uint32_t max_fire_ms);
+
+/**
+ * @brief Fixed-point fire timing. Parameters and result as
+ *        pid_compute_fire_timing().
+ *
+ * Duty bounds, depth compensation (duty * 1000 / pressure_mbar) and the
+ * microsecond split run in Q24. should_fire and depth_comp_skipped match the
+ * float path except within 2^-24 of the duty bounds. Durations agree to
+ * within 2 us down to 250 mbar; depth compensation scales the Q24 duty step
+ * by 1000 / pressure_mbar, so near vacuum they drift further apart. A zero
+ * total_cycle_ms never fires.
+ */
+FireTiming_t pid_compute_fire_timing_fixed(PIDNumeric_t duty,
+                     uint16_t pressure_mbar,
+                     bool depth_comp_enabled,
+                     uint32_t total_cycle_ms,
+                     uint32_t min_fire_ms,
+                     uint32_t max_fire_ms);
+
 /**
  * @brief Decide which flush solenoid (if any) a setpoint change calls for.
  *
@@ -0,0 +1,90 @@
+/**
+ * @file ppo2_mpc_math.h
+ * @brief Model-predictive pulse planner for the O2 inject solenoid.
+ *
+ * Plans one inject pulse per solenoid cycle from an identified
+ * AutotunePlantModel_t. The measured PPO2 lags the injector by the plant
+ * dead time and the mixing of earlier pulses, so the planner predicts the
+ * mixed PPO2 once recent pulses settle from the measurement, the
+ * not-yet-visible share of those pulses and an adaptive metabolic drift,
+ * and doses the drift plus part of the remaining gap.
+ *
+ * The measurement passed in should be the mean over the previous cycle:
+ * a single sample taken just before the pulse sits at the trough of the
+ * inject ripple and would bias the loop high.
+ *
+ * No kernel / zbus / logging dependencies so the host ztest target can
+ * exercise the planner in isolation.
+ */
+#ifndef PPO2_MPC_MATH_H
+#define PPO2_MPC_MATH_H
+
+#include "ppo2_autotune_math.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Pulses remembered for in-flight prediction. Must be #define — array size. */
+#define MPC_HISTORY_LEN 16U
+
+/** One delivered inject pulse. */
+typedef struct {
+    uint32_t start_ms;    /**< uptime at solenoid open */
+    PIDNumeric_t on_s;    /**< delivered on-time */
+} MpcPulse_t;
+
+/** Planner state carried between solenoid cycles. */
+typedef struct {
+    MpcPulse_t pulses[MPC_HISTORY_LEN]; /**< ring of recent pulses */
+    uint8_t next;                       /**< ring slot for the next pulse */
+    uint8_t count;                      /**< valid ring entries */
+    PIDNumeric_t drift_bar_s;           /**< un-injected PPO2 rate (metabolism, diluent) */
+    PIDNumeric_t ref_ppo2_bar;          /**< measurement opening the drift window */
+    uint32_t ref_ms;                    /**< uptime opening the drift window */
+    bool has_ref;                       /**< ref_ppo2_bar/ref_ms are usable */
+} MpcState_t;
+
+/** Actuation limits for one planned pulse. */
+typedef struct {
+    PIDNumeric_t cycle_s;   /**< time until the next plan */
+    PIDNumeric_t min_on_s;  /**< shortest pulse worth firing */
+    PIDNumeric_t max_on_s;  /**< longest pulse one cycle may fire */
+} MpcLimits_t;
+
+/** Seed the planner; the drift starts at the model's baseline consumption. */
+void mpc_state_init(MpcState_t *state, const AutotunePlantModel_t *model);
+
+/** Drop the open drift window (e.g. after a cell failure) so the drift is
+ *  not estimated across the gap. Pulses are kept. */
+void mpc_state_invalidate(MpcState_t *state);
+
+/** Record a pulse that was actually fired. */
+void mpc_record_pulse(MpcState_t *state, uint32_t start_ms,
+              PIDNumeric_t on_s);
+
+/** Mixed PPO2 bar per delivered duty-second used by the planner. */
+PIDNumeric_t mpc_dose_gain(const AutotunePlantModel_t *model);
+
+/** Duty-seconds of the recorded pulses that reached the cells between
+ *  @p from_ms and @p to_ms, per the model's dead time and mixing. Pulses
+ *  fired after @p from_ms count in full as they become visible. */
+PIDNumeric_t mpc_visible_dose_s(const MpcState_t *state,
+                const AutotunePlantModel_t *model,
+                uint32_t from_ms, uint32_t to_ms);
+
+/** Predicted mixed PPO2 once every recorded pulse has settled, net of the
+ *  drift while they land. */
+PIDNumeric_t mpc_predict_settled(const MpcState_t *state,
+                 const AutotunePlantModel_t *model,
+                 PIDNumeric_t measured_bar, uint32_t now_ms);
+
+/**
+ * @brief Adapt the drift to the latest measurement and plan this cycle's pulse.
+ *
+ * @return on-time in seconds; 0 when no pulse should fire.
+ */
+PIDNumeric_t mpc_plan_pulse(MpcState_t *state,
+                const AutotunePlantModel_t *model,
+                PIDNumeric_t setpoint_bar, PIDNumeric_t measured_bar,
+                uint32_t now_ms, const MpcLimits_t *limits);
+
+#endif /* PPO2_MPC_MATH_H */
@@ -0,0 +1,34 @@
+/**
+ * @file ppo2_plant_estimator.h
+ * @brief Background plant estimator: zbus channel for the tracked model.
+ *
+ * While the loop is under control, the estimator thread in
+ * ppo2_plant_estimator.c pairs the inject pulses published on
+ * chan_solenoid_fire with the consensus PPO2 and tracks the loop's dose
+ * gain and O2 drift (ppo2_plant_rls_math.h) against the plant model the
+ * controller holds. Each fitted window (one minute) publishes a
+ * PlantEstimate_t on chan_plant_estimate; the PLANT_ESTIMATE DID (0xF218)
+ * serves the latest one.
+ *
+ * The estimate is advisory: nothing feeds it back into the controller.
+ * balance_duty against ref_balance_duty shows a metabolic shift at any
+ * time; gain_ratio shows a loop-volume change only once a setpoint change
+ * or similar transient has excited it (see gain_updates and converged).
+ *
+ * Built with CONFIG_PPO2_PLANT_ESTIMATOR (solenoid variants with the flash
+ * log, which defines chan_solenoid_fire).
+ */
+#ifndef PPO2_PLANT_ESTIMATOR_H
+#define PPO2_PLANT_ESTIMATOR_H
+
+#include "ppo2_plant_rls_math.h"
+
+#ifdef CONFIG_ZBUS
+#include <zephyr/zbus/zbus.h>
+#endif
+
+#ifdef CONFIG_ZBUS
+ZBUS_CHAN_DECLARE(chan_plant_estimate);
+#endif
+
+#endif /* PPO2_PLANT_ESTIMATOR_H */
@@ -0,0 +1,104 @@
+/**
+ * @file ppo2_plant_rls_math.h
+ * @brief Recursive least-squares tracking of the loop's dose gain and drift.
+ *
+ * Fits the mixed PPO2 response of ordinary inject pulses while the loop is
+ * under control, so no excitation run is needed. Consensus is averaged over
+ * fixed windows; the change between consecutive window means is regressed
+ * on the change in pulse duty-seconds that had reached the cells (dead time
+ * and mixing taken from a reference AutotunePlantModel_t) and on the window
+ * length:
+ *
+ *     mean_k - mean_k-1 = settled_gain * visible_dose + drift * window
+ *
+ * settled_gain tracks the loop volume (bar per duty-second once mixed) and
+ * drift the un-injected PPO2 rate (metabolism, diluent; negative when the
+ * diver consumes O2). Their ratio is the balance duty, the share of time
+ * the inject solenoid must be open to hold PPO2 — a direct readout of the
+ * diver's O2 consumption.
+ *
+ * What the data can identify differs. The balance is pinned by every
+ * window, so a metabolic shift shows within a few minutes whatever the
+ * controller does. A loop-volume change scales gain and drift together and
+ * leaves the balance unchanged, so it only shows while the dose departs
+ * from the balance (setpoint change, descent, recovery after a flush);
+ * windows without that excitation update the drift alone.
+ *
+ * No kernel / zbus / logging dependencies so the host ztest target can
+ * exercise the estimator in isolation.
+ */
+#ifndef PPO2_PLANT_RLS_MATH_H
+#define PPO2_PLANT_RLS_MATH_H
+
+#include "ppo2_autotune_math.h"
+#include "ppo2_mpc_math.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Estimated parameters. Must be #define — array size. */
+#define PLANT_RLS_PARAMS 2U
+
+/** Estimator state carried between samples. */
+typedef struct {
+    PIDNumeric_t theta[PLANT_RLS_PARAMS];  /**< [settled gain, drift bar/s] */
+    PIDNumeric_t cov[PLANT_RLS_PARAMS][PLANT_RLS_PARAMS]; /**< parameter covariance */
+    MpcState_t pulses;          /**< recent inject pulses (ring only) */
+    PIDNumeric_t dose_level;    /**< visible duty-seconds accumulated, rebased per window */
+    PIDNumeric_t ppo2_sum;      /**< consensus sum over the open window */
+    PIDNumeric_t dose_sum;      /**< dose_level sum over the open window */
+    uint16_t samples;           /**< samples in the open window */
+    uint32_t window_start_ms;   /**< uptime of the open window's first sample */
+    uint32_t last_sample_ms;    /**< uptime of the previous sample */
+    PIDNumeric_t prev_mean_bar; /**< mean consensus of the previous window */
+    bool has_prev;              /**< prev_mean_bar is usable */
+    uint16_t updates;           /**< windows fitted since init (saturating) */
+    uint16_t gain_updates;      /**< of which excited the gain (saturating) */
+} PlantRlsState_t;
+
+/** Snapshot of the estimate against the reference model. */
+typedef struct {
+    PIDNumeric_t settled_gain;      /**< estimated bar per duty-second */
+    PIDNumeric_t drift_bar_s;       /**< estimated un-injected PPO2 rate */
+    PIDNumeric_t balance_duty;      /**< inject duty that holds PPO2 (-drift / gain) */
+    PIDNumeric_t ref_settled_gain;  /**< reference model's gain */
+    PIDNumeric_t ref_balance_duty;  /**< reference model's baseline duty */
+    PIDNumeric_t gain_ratio;        /**< estimate / reference gain */
+    PIDNumeric_t gain_stddev;       /**< 1-sigma gain uncertainty */
+    uint16_t updates;               /**< windows fitted since init */
+    uint16_t gain_updates;          /**< of which excited the gain */
+    bool converged;                 /**< enough fitted windows and a tight gain */
+} PlantEstimate_t;
+
+/** Seed the estimator at the reference model; pulses and windows are cleared. */
+void plant_rls_init(PlantRlsState_t *state, const AutotunePlantModel_t *model);
+
+/** Drop the open and previous windows so the next fit spans no disturbance
+ *  (flush, cell failure). Estimate and pulses are kept. */
+void plant_rls_invalidate(PlantRlsState_t *state);
+
+/** Record an inject pulse that was actually fired. */
+void plant_rls_record_pulse(PlantRlsState_t *state, uint32_t start_ms,
+                PIDNumeric_t on_s);
+
+/**
+ * @brief Add one consensus sample; fit when the window closes.
+ *
+ * Call at a steady cadence that divides @p window_ms so consecutive windows
+ * hold samples at the same phase. The sample that lands @p window_ms or more
+ * after the open window's first one closes that window and opens the next.
+ *
+ * @param state       Estimator state.
+ * @param model       Reference model (dead time and mixing).
+ * @param ppo2_bar    Consensus PPO2.
+ * @param now_ms      Sample uptime.
+ * @param window_ms   Averaging window.
+ * @return true when this sample closed a window and the estimate was updated.
+ */
+bool plant_rls_sample(PlantRlsState_t *state, const AutotunePlantModel_t *model,
+              PIDNumeric_t ppo2_bar, uint32_t now_ms, uint32_t window_ms);
+
+/** Fill @p out from the estimator and the reference model. */
+void plant_rls_estimate(const PlantRlsState_t *state,
+            const AutotunePlantModel_t *model, PlantEstimate_t *out);
+
+#endif /* PPO2_PLANT_RLS_MATH_H */
@@ -24,6 +24,7 @@ typedef enum {
     PPO2CONTROL_OFF = 0,   /**< No solenoid control */
     PPO2CONTROL_PID = 1,   /**< PID duty-cycle control */
     PPO2CONTROL_MK15 = 2,  /**< MK15-style bang-bang control */
+    PPO2CONTROL_MPC = 3,   /**< Model-predictive pulse planning */
 } PPO2ControlMode_t;
 
 static const PPO2ControlMode_t valid_ppo2_control_modes[] = {
@@ -31,6 +32,7 @@ static const PPO2ControlMode_t valid_ppo2_control_modes[] = {
 #ifdef CONFIG_HAS_O2_SOLENOID
     PPO2CONTROL_PID,
     PPO2CONTROL_MK15,
+    PPO2CONTROL_MPC,
 #endif
 };
 
@@ -38,6 +40,8 @@ static const PPO2ControlMode_t valid_ppo2_control_modes[] = {
 #define PPO2_CONTROL_MODE_DEFAULT PPO2CONTROL_PID
 #elif defined(CONFIG_PPO2_CONTROL_DEFAULT_MK15)
 #define PPO2_CONTROL_MODE_DEFAULT PPO2CONTROL_MK15
+#elif defined(CONFIG_PPO2_CONTROL_DEFAULT_MPC)
+#define PPO2_CONTROL_MODE_DEFAULT PPO2CONTROL_MPC
 #else
 #define PPO2_CONTROL_MODE_DEFAULT PPO2CONTROL_OFF
 #endif
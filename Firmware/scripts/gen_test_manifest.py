@@ -215,6 +215,7 @@ def build_manifest(
     ppo2_default = first_set(cfg, [
         ("PID", "CONFIG_PPO2_CONTROL_DEFAULT_PID"),
         ("MK15", "CONFIG_PPO2_CONTROL_DEFAULT_MK15"),
+        ("MPC", "CONFIG_PPO2_CONTROL_DEFAULT_MPC"),
         ("OFF", "CONFIG_PPO2_CONTROL_DEFAULT_OFF")], default="OFF")
 
     return {
@@ -303,7 +304,7 @@ def build_manifest(
             # Selectable control algorithms (mirror valid_ppo2_control_modes[],
             # which is gated on a solenoid being present). Switching modes is
             # boot-latched in ppo2_control_init -> the rig must persist + reboot.
-            "modes": (["OFF", "PID", "MK15"]
+            "modes": (["OFF", "PID", "MK15", "MPC"]
                       if is_set(cfg, "CONFIG_HAS_O2_SOLENOID") else ["OFF"]),
             "mode_switch_requires_reboot": True,
             "cal_default": first_set(cfg, [
@@ -37,6 +37,13 @@ from typing import Callable, Iterator
 
 DCLG_MAGIC = b"DLCG"          # "DCLG" as stored little-endian
 DCLG_HEADER_LEN = 16
+DCLG_FLAGS_IDX = 5
+DCLG_CODEC_IDX = 7            # LZ window/length bits when DCLG_FLAG_LZ is set
+DCLG_FLAG_LZ = 0x01           # body is an LZSS bit stream (see lz_decompress)
+DCLG_FLAG_FILTERED = 0x02     # a u64 record-type mask follows the header
+DCLG_MASK_LEN = 8
+DCLG_FLAG_DECIMATED = 0x04    # telemetry arrives as per-bucket AGGREGATE records
+LZ_MIN_MATCH = 2
 ENTRY_HDR_LEN = 12
 
 FL_BOOT_MARKER = 0x01
@@ -48,11 +55,15 @@ FL_CONSENSUS = 0x10
 FL_PID_SNAPSHOT = 0x11
 FL_SOLENOID_FIRE = 0x12
 FL_SOLENOID_CURRENT = 0x13
+FL_POWER_SNAPSHOT = 0x15
+FL_LATENCY_SUMMARY = 0x16
 FL_CELL_RAW_DIVEO2 = 0x20
 FL_CELL_RAW_O2S = 0x21
 FL_CELL_RAW_ANALOG = 0x22
 FL_ERROR_EVENT = 0x30
 FL_LOG_TEXT = 0x40
+FL_AGGREGATE = 0xFB
+FL_BATCH_PACKED = 0xFC
 FL_BATCH = 0xFD
 FL_DROP_MARKER = 0xFE
 FL_END_OF_STREAM = 0xFF
@@ -67,11 +78,15 @@ TYPE_NAMES = {
     FL_PID_SNAPSHOT: "PID Snapshot",
     FL_SOLENOID_FIRE: "Solenoid Fire",
     FL_SOLENOID_CURRENT: "Solenoid Current",
+    FL_POWER_SNAPSHOT: "Power Snapshot",
+    FL_LATENCY_SUMMARY: "Latency Summary",
     FL_CELL_RAW_DIVEO2: "Cell Raw (DiveO2)",
     FL_CELL_RAW_O2S: "Cell Raw (O2S)",
     FL_CELL_RAW_ANALOG: "Cell Raw (Analog)",
     FL_ERROR_EVENT: "Error Event",
     FL_LOG_TEXT: "Log Text",
+    FL_AGGREGATE: "Aggregate",
+    FL_BATCH_PACKED: "Packed Batch",
     FL_BATCH: "Batch",
     FL_DROP_MARKER: "Drop Marker",
     FL_END_OF_STREAM: "End Of Stream",
@@ -141,10 +156,20 @@ def iter_records(data: bytes) -> Iterator[Record]:
     """Yield every TLV record in a downloaded stream, flattening BATCH containers.
 
     Stops at END_OF_STREAM or a truncated tail, matching the firmware reader
-    and ``LogParser.parseLogStream`` in the browser client.
+    and ``LogParser.parseLogStream`` in the browser client. A compressed
+    download (DCLG_FLAG_LZ) is inflated first.
     """
-    start = DCLG_HEADER_LEN if data[:4] == DCLG_MAGIC else 0
-    yield from _walk(data, start, len(data))
+    data = inflate_stream(data)
+    yield from _walk(data, header_length(data), len(data))
+
+
+def header_length(data: bytes) -> int:
+    """Offset of the first record: the DCLG header plus a filter's type mask."""
+    if data[:4] != DCLG_MAGIC or len(data) < DCLG_HEADER_LEN:
+        return 0
+    if data[DCLG_FLAGS_IDX] & DCLG_FLAG_FILTERED:
+        return DCLG_HEADER_LEN + DCLG_MASK_LEN
+    return DCLG_HEADER_LEN
 
 
 def _walk(data: bytes, start: int, end: int) -> Iterator[Record]:
@@ -159,11 +184,171 @@ def _walk(data: bytes, start: int, end: int) -> Iterator[Record]:
             return
         if rtype == FL_BATCH:
             yield from _walk(data, body, stop)
+        elif rtype == FL_BATCH_PACKED:
+            yield from _walk_packed(data, body, stop, ts_us)
         else:
             yield Record(rtype, flags, ts_us, data[body:stop])
         i = stop
 
 
+# ---- Compressed download (mirror Firmware/src/flash_log/flash_log_lz.c) ----
+
+def lz_decompress(data: bytes, params: int) -> bytes:
+    """Inflate an LZSS download body.
+
+    ``params`` is the DCLG codec byte: window bits in the high nibble, length
+    bits in the low nibble. Items are MSB-first: ``1`` + literal byte, or
+    ``0`` + (distance - 1) + (length - LZ_MIN_MATCH). A trailing partial item is the
+    zero padding of the final byte and is ignored.
+    """
+    window_bits = params >> 4
+    length_bits = params & 0x0F
+    backref_bits = window_bits + length_bits
+    out = bytearray()
+    acc = 0
+    nbits = 0
+    i = 0
+    n = len(data)
+    item_max = 1 + max(8, backref_bits)
+    while True:
+        while nbits < item_max and i < n:
+            acc = (acc << 8) | data[i]
+            nbits += 8
+            i += 1
+        if nbits == 0:
+            break
+        literal = (acc >> (nbits - 1)) & 1
+        width = 8 if literal else backref_bits
+        if nbits < 1 + width:
+            break  # padding
+        nbits -= 1 + width
+        value = (acc >> nbits) & ((1 << width) - 1)
+        acc &= (1 << nbits) - 1
+        if literal:
+            out.append(value)
+        else:
+            dist = (value >> length_bits) + 1
+            length = (value & ((1 << length_bits) - 1)) + LZ_MIN_MATCH
+            if dist > len(out):
+                raise ValueError(f"LZ backref {dist} before stream start")
+            for _ in range(length):
+                out.append(out[-dist])
+    return bytes(out)
+
+
+def inflate_stream(data: bytes) -> bytes:
+    """Return ``data`` with a compressed DCLG body inflated (flag cleared)."""
+    if data[:4] != DCLG_MAGIC or len(data) < DCLG_HEADER_LEN:
+        return data
+    if not data[DCLG_FLAGS_IDX] & DCLG_FLAG_LZ:
+        return data
+    start = header_length(data)
+    header = bytearray(data[:start])
+    header[DCLG_FLAGS_IDX] &= ~DCLG_FLAG_LZ & 0xFF
+    header[DCLG_CODEC_IDX] = 0
+    body = lz_decompress(data[start:], data[DCLG_CODEC_IDX])
+    return bytes(header) + body
+
+
+# ---- Packed batch codec (mirror Firmware/src/flash_log/flash_log_codec.c) ---
+
+#: Tag bit marking a field-coded (rather than raw) packed sub-record.
+PACKED_TAG_FIELDS = 0x80
+#: Cell records with a cell_index at or above this code against zero.
+PACKED_CELL_SLOTS = 3
+
+#: type -> (keyed on cell_index, field widths after the key)
+PACKED_SCHEMAS: dict[int, tuple[bool, tuple[int, ...]]] = {
+    FL_CONSENSUS: (False, (1, 1, 1, 1, 2, 2, 2, 2, 1, 1)),
+    FL_PID_SNAPSHOT: (False, (4, 2, 4, 1)),
+    FL_CELL_RAW_DIVEO2: (True, (1, 4, 4, 4, 4, 4, 4, 4)),
+    FL_CELL_RAW_O2S: (True, (1, 1)),
+    FL_CELL_RAW_ANALOG: (True, (1, 4, 2)),
+}
+
+
+class PackedDecodeError(ValueError):
+    """A packed batch container is malformed or truncated."""
+
+
+def _varint(data: bytes, i: int, end: int) -> tuple[int, int]:
+    value = 0
+    for n in range(10):
+        if i + n >= end:
+            break
+        byte = data[i + n]
+        value |= (byte & 0x7F) << (7 * n)
+        if not byte & 0x80:
+            return value, i + n + 1
+    raise PackedDecodeError(f"bad varint at {i}")
+
+
+def _unzigzag(v: int) -> int:
+    return (v >> 1) ^ -(v & 1)
+
+
+def _walk_packed(data: bytes, start: int, end: int, base_ts: int) -> Iterator[Record]:
+    """Decode one FL_TYPE_BATCH_PACKED container into plain records.
+
+    A malformed sub-record ends the container (everything decoded before it is
+    kept), matching the firmware's flash_log_reader_expand_batch().
+    """
+    prev_ts = base_ts
+    prev: dict[tuple[int, int], bytes] = {}
+    i = start
+    try:
+        while i < end:
+            tag = data[i]
+            rtype = tag & ~PACKED_TAG_FIELDS & 0xFF
+            dt, i = _varint(data, i + 1, end)
+            ts_us = (prev_ts + _unzigzag(dt)) & 0xFFFF_FFFF_FFFF_FFFF
+            if tag & PACKED_TAG_FIELDS:
+                payload, i = _decode_fields(data, i, end, rtype, prev)
+            else:
+                length, i = _varint(data, i, end)
+                if i + length > end:
+                    raise PackedDecodeError("raw payload overruns container")
+                payload = bytes(data[i:i + length])
+                i += length
+            prev_ts = ts_us
+            yield Record(rtype, 0, ts_us, payload)
+    except PackedDecodeError:
+        return
+
+
+def _decode_fields(data: bytes, i: int, end: int, rtype: int,
+                   prev: dict[tuple[int, int], bytes]) -> tuple[bytes, int]:
+    schema = PACKED_SCHEMAS.get(rtype)
+    if schema is None:
+        raise PackedDecodeError(f"no field schema for type 0x{rtype:02x}")
+    keyed, widths = schema
+    key = 0
+    out = bytearray()
+    if keyed:
+        if i >= end:
+            raise PackedDecodeError("missing cell key")
+        key = data[i]
+        out.append(key)
+        i += 1
+    mask, i = _varint(data, i, end)
+    if mask >> len(widths):
+        raise PackedDecodeError("change mask names a missing field")
+    slot = (rtype, key) if (not keyed or key < PACKED_CELL_SLOTS) else None
+    ref = prev.get(slot) if slot is not None else None
+    off = len(out)
+    for f, width in enumerate(widths):
+        value = int.from_bytes(ref[off:off + width], "little") if ref else 0
+        if mask & (1 << f):
+            delta, i = _varint(data, i, end)
+            value = (value + _unzigzag(delta)) % (1 << (8 * width))
+        out += value.to_bytes(width, "little")
+        off += width
+    payload = bytes(out)
+    if slot is not None:
+        prev[slot] = payload
+    return payload, i
+
+
 # ---- Payload decoders ------------------------------------------------------
 
 _S_DIVE = struct.Struct("<HI")
@@ -325,6 +510,24 @@ def decode_error(p: bytes) -> dict | None:
     return {"code": code, "detail": detail}
 
 
+# LATENCY_SUMMARY / DID 0xF216 stages, in LatencyStage_t order
+# (Firmware/include/latency_trace.h).
+LATENCY_STAGE_NAMES = ("sampleToConsensus", "consensusToControl",
+                       "sampleToControl", "sampleToFire")
+_S_LATENCY_STAGE = struct.Struct("<IIIII")
+
+
+def decode_latency_summary(p: bytes) -> dict | None:
+    if len(p) < 2 or len(p) < 2 + p[1] * _S_LATENCY_STAGE.size:
+        return None
+    stages = []
+    for i in range(p[1]):
+        count, lo, p50, p99, hi = _S_LATENCY_STAGE.unpack_from(p, 2 + i * _S_LATENCY_STAGE.size)
+        stages.append({"count": count, "minUs": lo, "p50Us": p50,
+                       "p99Us": p99, "maxUs": hi})
+    return {"version": p[0], "stages": stages}
+
+
 def decode_drop(p: bytes) -> dict | None:
     if len(p) < _S_DROP.size:
         return None
@@ -332,6 +535,44 @@ def decode_drop(p: bytes) -> dict | None:
     return {"count": count, "lastDroppedType": last}
 
 
+# Channels of an AGGREGATE record per source type, in the order the head
+# writes them (Firmware/src/flash_log/flash_log_aggregate.c).
+AGGREGATE_CHANNELS = {
+    FL_CONSENSUS: ("consensusPpo2", "ppo2_0", "ppo2_1", "ppo2_2", "millivolts_0",
+                   "millivolts_1", "millivolts_2", "confidence", "setpoint"),
+    FL_POWER_SNAPSHOT: ("vbusVoltage", "vccVoltage", "batteryVoltage",
+                        "canVoltage", "currentUa"),
+    FL_CELL_RAW_DIVEO2: ("ppo2", "temperatureMc", "phaseMdeg", "signalIntensityUv",
+                         "ambientLightUv", "ambientPressureUbar",
+                         "housingHumidityMpercentRh"),
+    FL_CELL_RAW_O2S: ("ppo2",),
+    FL_CELL_RAW_ANALOG: ("ppo2", "rawAdc", "millivolts"),
+}
+_S_AGG_PREFIX = struct.Struct("<BBHI")
+_S_AGG_CHANNEL = struct.Struct("<fff")
+AGG_NO_KEY = 0xFF
+
+
+def decode_aggregate(p: bytes) -> dict | None:
+    if len(p) < _S_AGG_PREFIX.size:
+        return None
+    source, key, count, span_us = _S_AGG_PREFIX.unpack_from(p)
+    names = AGGREGATE_CHANNELS.get(source)
+    if names is None or len(p) < _S_AGG_PREFIX.size + len(names) * _S_AGG_CHANNEL.size:
+        return None
+    channels = {}
+    for i, name in enumerate(names):
+        lo, mean, hi = _S_AGG_CHANNEL.unpack_from(p, _S_AGG_PREFIX.size + i * _S_AGG_CHANNEL.size)
+        channels[name] = {"min": lo, "mean": mean, "max": hi}
+    return {
+        "sourceType": source,
+        "cellIndex": None if key == AGG_NO_KEY else key,
+        "count": count,
+        "spanUs": span_us,
+        "channels": channels,
+    }
+
+
 def decode_can_frame(p: bytes) -> dict | None:
     if len(p) < 13:
         return None
@@ -358,12 +599,14 @@ DECODERS: dict[int, Callable[[bytes], dict | None]] = {
     FL_PID_SNAPSHOT: decode_pid,
     FL_SOLENOID_FIRE: decode_solenoid_fire,
     FL_SOLENOID_CURRENT: decode_solenoid_current,
+    FL_LATENCY_SUMMARY: decode_latency_summary,
     FL_CELL_RAW_DIVEO2: decode_cell_diveo2,
     FL_CELL_RAW_O2S: decode_cell_o2s,
     FL_CELL_RAW_ANALOG: decode_cell_analog,
     FL_ERROR_EVENT: decode_error,
     FL_DROP_MARKER: decode_drop,
     FL_LOG_TEXT: decode_log_text,
+    FL_AGGREGATE: decode_aggregate,
 }
 
 
@@ -1,18 +1,33 @@
 /**
  * @file consensus_subscriber.c
- * @brief Timer-driven consensus thread — aggregates per-cell readings into a consensus PPO2
+ * @brief Event-driven consensus thread — aggregates per-cell readings into a consensus PPO2
  *
- * Wakes every CONSENSUS_PERIOD_MS, snapshots each active cell channel via
- * zbus_chan_read (latest-value semantics — no notification queue, no drain),
- * runs consensus_calculate(), and publishes the result on chan_consensus.
- * Cell slots that exceed STALENESS_TIMEOUT_MS or are compiled out
- * (CONFIG_CELL_COUNT < 2/3) are treated as failed by the per-cell
- * timestamp check in consensus_calculate().
+ * A zbus listener on chan_cell_1..3 gives a binary semaphore on every cell
+ * publish; the consensus thread takes it, snapshots each active cell channel
+ * via zbus_chan_read (latest-value semantics), runs consensus_calculate(),
+ * and publishes the result on chan_consensus. Cell slots that exceed
+ * STALENESS_TIMEOUT_MS or are compiled out (CONFIG_CELL_COUNT < 2/3) are
+ * treated as failed by the per-cell timestamp check in consensus_calculate().
  *
- * The previous design used a ZBUS_SUBSCRIBER + zbus_sub_wait + drain loop;
- * it was removed because the channel values are persistent and the
- * subscriber queue only signalled "something happened" — it added a wake-up
- * stage of latency without carrying data.
+ * Coalescing: the semaphore counts to one, so any number of publishes that
+ * land while a vote is being computed fold into a single recompute. A vote
+ * also never follows the previous one by less than CONSENSUS_MIN_INTERVAL_MS
+ * — a publish after a quiet spell is voted on at once (leading edge), while a
+ * burst of 100 Hz analog samples is voted at most once per interval on the
+ * freshest values. The consensus rate (and with it the flash-log and live-tail
+ * load) therefore never exceeds the old 10 Hz timer, while slow digital cells
+ * are voted the moment their frame arrives instead of up to a period later.
+ * With no publishes at all the thread still wakes every CONSENSUS_IDLE_MS so
+ * a silent cell ages past the staleness timeout and the heartbeat advances.
+ *
+ * Each ConsensusMsg_t carries sample_ticks and sample_seq (the newest cell
+ * sample it was computed from) and consensus_ticks (when it was computed), so
+ * consumers can measure the sample→consensus→control latency of what they act
+ * on; see latency_trace.h.
+ *
+ * The earlier ZBUS_SUBSCRIBER + zbus_sub_wait design queued one channel
+ * pointer per publish (no coalescing, so a full queue blocked the cell
+ * driver); a listener-fed semaphore carries the same wake-up without a queue.
  */
 
 #include <zephyr/kernel.h>
@@ -23,6 +38,7 @@
 #include "oxygen_cell_math.h"
 #include "heartbeat.h"
 #include "errors.h"
+#include "latency_trace.h"
 #ifdef CONFIG_ALARM
 #include "alarm.h"
 #include "divecan_channels.h"   /* chan_setpoint, for the alarm threshold */
@@ -34,9 +50,15 @@ LOG_MODULE_REGISTER(consensus, LOG_LEVEL_INF);
  * which has a slower update rate */
 #define STALENESS_TIMEOUT_MS 10000
 
-/* Consensus recompute period. Matches the PID controller cadence so the
- * PID thread always reads a consensus snapshot less than one period old. */
-static const uint32_t CONSENSUS_PERIOD_MS = 100U;
+/* Minimum spacing between two votes. Matches the PID controller cadence, so
+ * the PID still sees a fresh vote every cycle with analog cells, without the
+ * consensus rate outrunning it. */
+static const int64_t CONSENSUS_MIN_INTERVAL_MS = 100;
+
+/* Longest wait for a cell publish before voting anyway, so a cell that stops
+ * publishing still times out and the heartbeat keeps moving (the watchdog
+ * feeder checks every 2 s). */
+static const uint32_t CONSENSUS_IDLE_MS = 1000U;
 
 /* Index of cell 2 in the cells array */
 static const uint8_t CELL_IDX_2 = 2U;
@@ -47,9 +69,33 @@ static const uint8_t CELL_IDX_2 = 2U;
  * CELL_OK with ppo2 0 and gets voted out as a phantom zero (an intermittent
  * single-cell dropout). A K_NO_WAIT publish can likewise DROP, leaving consumers
  * reading the previous consensus as if current (stale). 10 ms is far longer than
- * the brief critical sections yet well under the 100 ms recompute period. */
+ * the brief critical sections yet well under the 100 ms minimum vote interval. */
 #define CHAN_OP_TIMEOUT_MS 10
 
+/* Given by the cell listener, taken by the consensus thread. A limit of one
+ * is the coalescing: publishes during a vote collapse into one pending wake. */
+static K_SEM_DEFINE(consensus_wake_sem, 0, 1);
+
+/**
+ * @brief zbus listener: a cell published, wake the consensus thread.
+ *
+ * Runs synchronously in the publishing cell thread, so it only signals.
+ */
+static void cell_published_cb(const struct zbus_channel *chan)
+{
+    ARG_UNUSED(chan);
+    k_sem_give(&consensus_wake_sem);
+}
+
+ZBUS_LISTENER_DEFINE(consensus_cell_listener, cell_published_cb);
+ZBUS_CHAN_ADD_OBS(chan_cell_1, consensus_cell_listener, 3);
+#if CONFIG_CELL_COUNT >= 2
+ZBUS_CHAN_ADD_OBS(chan_cell_2, consensus_cell_listener, 3);
+#endif
+#if CONFIG_CELL_COUNT >= 3
+ZBUS_CHAN_ADD_OBS(chan_cell_3, consensus_cell_listener, 3);
+#endif
+
 /**
  * @brief Snapshot one cell channel, marking it FAILED if the read can't complete.
  *
@@ -70,12 +116,59 @@ static void read_cell_or_fail(const struct zbus_channel *chan,
     }
 }
 
+/**
+ * @brief Stamp a vote with the newest cell sample fed to it.
+ *
+ * Only cells the vote included count: a failed, stale or voted-out cell
+ * never reached consensus_ppo2, so its timestamp must not stand in for the
+ * sample the PID acts on. Leaves sample_ticks and sample_seq at 0 when no
+ * included cell has published yet.
+ *
+ * @param cells  Cell snapshots (CELL_MAX_COUNT entries)
+ * @param result Vote to stamp (include_array already set)
+ */
+static void stamp_newest_sample(const OxygenCellMsg_t cells[],
+                                ConsensusMsg_t *result)
+{
+    result->sample_ticks = 0;
+    result->sample_seq = 0U;
+
+    for (uint8_t i = 0U; i < CELL_MAX_COUNT; ++i) {
+        if (result->include_array[i] &&
+            (cells[i].timestamp_ticks > result->sample_ticks)) {
+            result->sample_ticks = cells[i].timestamp_ticks;
+            result->sample_seq = cells[i].sample_seq;
+        }
+    }
+}
+
+/**
+ * @brief Wait for the next vote to be due.
+ *
+ * Blocks until a cell publishes (or CONSENSUS_IDLE_MS passes), then holds off
+ * until CONSENSUS_MIN_INTERVAL_MS after the previous vote. Publishes that land
+ * during the hold-off are consumed here — the vote about to run reads them.
+ *
+ * @param last_vote_ms k_uptime_get() of the previous vote
+ */
+static void wait_for_vote(int64_t last_vote_ms)
+{
+    (void)k_sem_take(&consensus_wake_sem, K_MSEC(CONSENSUS_IDLE_MS));
+
+    int64_t since_ms = k_uptime_get() - last_vote_ms;
+
+    if (since_ms < CONSENSUS_MIN_INTERVAL_MS) {
+        (void)k_msleep((int32_t)(CONSENSUS_MIN_INTERVAL_MS - since_ms));
+    }
+    (void)k_sem_take(&consensus_wake_sem, K_NO_WAIT);
+}
+
 /**
  * @brief Consensus thread entry point
  *
- * Periodically snapshots each cell channel, computes the voted consensus
- * PPO2, and publishes to chan_consensus. No subscription — the cell
- * channels carry their own latest value and we just read them.
+ * Waits for a cell publish, snapshots each cell channel, computes the voted
+ * consensus PPO2, and publishes to chan_consensus stamped with the sample and
+ * compute times.
  *
  * @param p1 Unused thread argument
  * @param p2 Unused thread argument
@@ -89,9 +182,15 @@ static void consensus_thread_fn(void *p1, void *p2, void *p3)
 
     heartbeat_register(HEARTBEAT_CONSENSUS);
 
+    int64_t last_vote_ms = k_uptime_get() - CONSENSUS_MIN_INTERVAL_MS;
+    uint32_t last_traced_seq = 0U;
+
     while (true) {
         heartbeat_kick(HEARTBEAT_CONSENSUS);
 
+        wait_for_vote(last_vote_ms);
+        last_vote_ms = k_uptime_get();
+
         OxygenCellMsg_t cells[CELL_MAX_COUNT] = {0};
 
         read_cell_or_fail(&chan_cell_1, &cells[0]);
@@ -116,6 +215,17 @@ static void consensus_thread_fn(void *p1, void *p2, void *p3)
         ConsensusMsg_t result = consensus_calculate(
             cells, CONFIG_CELL_COUNT, now, staleness);
 
+        stamp_newest_sample(cells, &result);
+        result.consensus_ticks = now;
+
+        /* An idle re-vote on the same sample is not a new sample→consensus
+         * hop; trace each sample once. */
+        if ((0U != result.sample_seq) && (result.sample_seq != last_traced_seq)) {
+            (void)latency_trace_record_span(LATENCY_STAGE_SAMPLE_TO_CONSENSUS,
+                                            result.sample_ticks, now);
+            last_traced_seq = result.sample_seq;
+        }
+
 #ifdef CONFIG_ALARM
         /* Read the active setpoint so the alarm can apply the hypoxic-diluent
          * (0.19 bar) low-threshold exception. Seed a non-hypoxic default so a
@@ -129,8 +239,6 @@ static void consensus_thread_fn(void *p1, void *p2, void *p3)
                                 setpoint_cb));
 #endif
         zbus_pub_checked(&chan_consensus, &result, K_MSEC(CHAN_OP_TIMEOUT_MS));
-
-        (void)k_msleep((int32_t)CONSENSUS_PERIOD_MS);
     }
 }
 
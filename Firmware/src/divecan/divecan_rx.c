@@ -5,6 +5,9 @@
  * This is the context in which we handle inbound CAN messages (which sometimes
  * requires a response). Dispatch of our other outgoing traffic may occur
  * elsewhere (PPO2 TX task, log push, etc.).
+ *
+ * UDS requests are only reassembled here; uds_worker.c executes them, so a
+ * slow handler never delays pings, setpoints or cal requests.
  */
 
 #include <zephyr/kernel.h>
@@ -20,11 +23,10 @@
 #include "divecan_counters.h"
 #include "isotp.h"
 #include "isotp_tx_queue.h"
+#include "isotp_link.h"
 #include "uds.h"
+#include "uds_worker.h"
 #include "uds_log_push.h"
-#ifdef CONFIG_FLASH_LOG
-#include "uds_log_download.h"
-#endif
 #include "oxygen_cell_channels.h"
 #ifdef CONFIG_FLASH_LOG
 #include "flash_log.h"
@@ -53,7 +55,19 @@ LOG_MODULE_REGISTER(divecan_rx, LOG_LEVEL_INF);
  * tripping the 1 s N_Cr timeout and stalling/aborting the transfer. 48 covers a
  * full burst plus margin for interleaved bus traffic. ~0.9 kB RAM. */
 #define RX_QUEUE_SIZE   48U
-#define RX_TIMEOUT_MS   1000
+
+/* Longest the RX thread sleeps with nothing due. The watchdog feeder checks
+ * every heartbeat each 2 s (watchdog_feeder.c), so an idle bus still wakes the
+ * thread once a second to kick its slot; protocol deadlines (STmin, N_Bs,
+ * N_Cr, UDS responsePending, handset loss) wake it sooner. */
+#define RX_IDLE_WAKE_MS 1000U
+
+/* k_poll slots of the RX thread's wait */
+enum {
+    RX_POLL_CAN = 0,    /* frame waiting in can_rx_msgq */
+    RX_POLL_ISOTP_TX,   /* request waiting to start in the ISO-TP TX queue */
+    RX_POLL_COUNT,
+};
 
 /* Cell index for the third oxygen cell (0-based) */
 static const uint8_t CELL_IDX_2 = 2U;
@@ -109,7 +123,6 @@ K_MSGQ_DEFINE(can_rx_msgq, sizeof(DiveCANMessage_t), RX_QUEUE_SIZE, 4);
 
 typedef struct {
     ISOTPContext_t isotp_context;
-    UDSContext_t uds_context;
     bool isotp_initialized;
     ISOTPContext_t log_push_isotp_context;
     bool log_push_initialized;
@@ -222,6 +235,7 @@ static bool ProcessMenuMessage(const DiveCANMessage_t *message);
 static void InitializeUDSContexts(void);
 static void NoteHandsetPing(const DiveCANMessage_t *message);
 static void DispatchMessage(const DiveCANMessage_t *message);
+static uint32_t NextWakeMs(uint32_t now);
 
 /* ---- CAN RX filter callback ---- */
 
@@ -256,6 +270,7 @@ static void can_rx_callback(const struct device *dev, struct can_frame *frame,
             .data = {0},
         };
         (void)memcpy(msg.data, frame->data, frame->dlc);
+        divecan_send_note_rx_frame(frame->dlc);
 
 #ifdef CONFIG_FLASH_LOG
         /* ISR-safe enqueue; the helper internally gates on the runtime
@@ -377,12 +392,78 @@ static void DispatchMessage(const DiveCANMessage_t *message)
     }
 }
 
+/**
+ * @brief Shorten @p wait_ms so the thread wakes by @p deadline.
+ *
+ * @param now      Current uptime (ms)
+ * @param pending  Whether @p deadline is set
+ * @param deadline Uptime (ms) something falls due; wrap-safe, may be past
+ * @param wait_ms  Sleep budget to shorten
+ */
+static void WakeBy(uint32_t now, bool pending, const uint32_t *deadline,
+           uint32_t *wait_ms)
+{
+    if (pending) {
+        int32_t remaining = (int32_t)(*deadline - now);
+        uint32_t due_ms = 0U;
+
+        if (remaining > 0) {
+            due_ms = (uint32_t)remaining;
+        }
+        *wait_ms = MIN(*wait_ms, due_ms);
+    }
+}
+
+/**
+ * @brief How long the RX thread may sleep before a protocol deadline.
+ *
+ * Incoming frames and newly queued ISO-TP TX requests (including the UDS
+ * worker's responses) end the sleep through k_poll; everything time-driven
+ * (STmin pacing, N_Bs, N_Cr, responsePending for a slow UDS request, held
+ * log pushes, handset loss) is collected here. The worker times the S3
+ * session lapse itself.
+ *
+ * @param now Current uptime (ms)
+ * @return Milliseconds until the earliest deadline, at most RX_IDLE_WAKE_MS
+ */
+static uint32_t NextWakeMs(uint32_t now)
+{
+    DiveCANUDSState_t *udsState = getUDSState();
+    const HandsetFailsafeState_t *hfState = getHandsetFailsafeState();
+    uint32_t wait_ms = RX_IDLE_WAKE_MS;
+    uint32_t deadline = 0U;
+    bool pending = false;
+
+    if (udsState->isotp_initialized) {
+        pending = ISOTP_NextDeadline(&udsState->isotp_context, &deadline);
+        WakeBy(now, pending, &deadline, &wait_ms);
+        pending = UDS_Worker_NextDeadline(&deadline);
+        WakeBy(now, pending, &deadline, &wait_ms);
+    }
+    if (udsState->log_push_initialized) {
+        pending = ISOTP_NextDeadline(&udsState->log_push_isotp_context, &deadline);
+        WakeBy(now, pending, &deadline, &wait_ms);
+        pending = UDS_LogPush_NextDeadline(&deadline);
+        WakeBy(now, pending, &deadline, &wait_ms);
+    }
+    pending = ISOTP_TxQueue_NextDeadline(&deadline);
+    WakeBy(now, pending, &deadline, &wait_ms);
+    pending = handset_failsafe_deadline(hfState->last_handset_ping_ms,
+                        hfState->handset_seen,
+                        hfState->handset_lost_applied,
+                        HANDSET_PING_TIMEOUT_MS, &deadline);
+    WakeBy(now, pending, &deadline, &wait_ms);
+
+    return wait_ms;
+}
+
 /**
  * @brief Thread entry: initialize CAN hardware then dispatch inbound DiveCAN messages
  *
  * Sets up CAN RX filters, initializes UDS/ISO-TP contexts, sends the bus-init
- * handshake, then loops forever dequeueing messages and dispatching them to
- * the appropriate Resp* handler.  Also polls ISO-TP timeout state each iteration.
+ * handshake, then loops forever dispatching messages to the appropriate Resp*
+ * handler. Each iteration sleeps in k_poll until a frame arrives, an ISO-TP
+ * TX request is queued, or the nearest protocol deadline (NextWakeMs) passes.
  *
  * @param p1 Unused (Zephyr thread parameter)
  * @param p2 Unused (Zephyr thread parameter)
@@ -454,18 +535,36 @@ static void divecan_rx_thread(void *p1, void *p2, void *p3)
     LOG_INF("DiveCAN RX thread started");
     heartbeat_register(HEARTBEAT_DIVECAN_RX);
 
+    struct k_poll_event events[RX_POLL_COUNT];
+
     while (true) {
         heartbeat_kick(HEARTBEAT_DIVECAN_RX);
-        DiveCANMessage_t message = {0};
-        Status_t rx_ret = k_msgq_get(&can_rx_msgq, &message,
-                    K_MSEC(RX_TIMEOUT_MS));
+        uint32_t now = k_uptime_get_32();
+
+        /* A TX request can only start from an idle queue; while a transfer
+         * is in flight its deadline (or the peer's FC) wakes us instead,
+         * else the still-queued request would spin this loop. */
+        uint32_t tx_poll_type = K_POLL_TYPE_MSGQ_DATA_AVAILABLE;
+        if (ISOTP_TxQueue_IsBusy()) {
+            tx_poll_type = K_POLL_TYPE_IGNORE;
+        }
+        k_poll_event_init(&events[RX_POLL_CAN], K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+                  K_POLL_MODE_NOTIFY_ONLY, &can_rx_msgq);
+        k_poll_event_init(&events[RX_POLL_ISOTP_TX], tx_poll_type,
+                  K_POLL_MODE_NOTIFY_ONLY, ISOTP_TxQueue_Msgq());
+
+        /* -EAGAIN just means a deadline passed; either way fall through */
+        (void)k_poll(events, RX_POLL_COUNT, K_MSEC(NextWakeMs(now)));
 
-        if (0 == rx_ret) {
+        /* One frame per pass: a completed ISO-TP request is handled below
+         * before the next frame can overwrite its RX buffer. */
+        DiveCANMessage_t message = {0};
+        if (0 == k_msgq_get(&can_rx_msgq, &message, K_NO_WAIT)) {
             DispatchMessage(&message);
         }
 
         /* Poll ISO-TP and process completed transfers */
-        uint32_t now = k_uptime_get_32();
+        now = k_uptime_get_32();
         PollISOTPContexts(now);
         ProcessISOTPCompletion(now);
 
@@ -501,8 +600,10 @@ static void divecan_rx_thread(void *p1, void *p2, void *p3)
  * 1280 B tripped K_ERR_STACK_CHK_FAIL during HIL fault-injection setup, and
  * 2048 B tripped it again once NVS_BLOCK_SIZE grew the settings-save frames
  * (256 B granule + 2048 stack = STACK_CHK_FAIL in the settings-heavy HIL
- * tests, run 31187089880). Now 2304 alongside the granule reduced to 128;
- * do not trim without INIT_STACKS-backed high-water data from the real rig. */
+ * tests, run 31187089880). Now 2304 alongside the granule reduced to 128.
+ * Those paths have since moved to the UDS worker (uds_worker.c), but this
+ * thread still runs dispatch, ISO-TP and the log push; do not trim without
+ * INIT_STACKS-backed high-water data from the real rig. */
 K_THREAD_DEFINE(divecan_rx, 2304,
         divecan_rx_thread, NULL, NULL, NULL,
         5, 0, 0);
@@ -803,15 +904,18 @@ static void RespSerialNumber(const DiveCANMessage_t *message)
 /**
  * @brief Initialize UDS contexts at task startup
  *
- * Initializes TX queue and log push ISO-TP context before message processing
- * begins. The main isotp_context is initialized on first MENU message since it
- * needs the target address from the incoming message.
+ * Initializes the TX queue, the UDS worker and the log push ISO-TP context
+ * before message processing begins. The main isotp_context is initialized on
+ * first MENU message since it needs the target address from the incoming
+ * message.
  */
 static void InitializeUDSContexts(void)
 {
     DiveCANUDSState_t *udsState = getUDSState();
 
     ISOTP_TxQueue_Init();
+    ISOTP_Link_Init();
+    UDS_Worker_Init();
 
     /* Log push ISO-TP uses broadcast target (0xFF) for BT client. We let
      * UDS_LogPush_Init() do the ISOTP_Init internally so the module's
@@ -830,16 +934,18 @@ static void PollISOTPContexts(uint32_t now)
 {
     DiveCANUDSState_t *udsState = getUDSState();
 
-    /* Poll main ISO-TP context */
+    /* Poll main ISO-TP context, and keep a slow UDS request's client
+     * waiting with responsePending */
     if (udsState->isotp_initialized) {
         ISOTP_Poll(&udsState->isotp_context, now);
+        UDS_Worker_Poll(now);
     }
 
     /* Poll the log-push ISO-TP context for timeouts here, but DON'T drive a new
      * log transmission yet — UDS_LogPush_Poll() runs at the end of
-     * ProcessISOTPCompletion (after the RX-completed dialog reply is enqueued and
-     * pumped) so a passive log push never claims the idle TX window ahead of an
-     * active dialog reply for this same iteration. */
+     * ProcessISOTPCompletion (after any dialog reply is enqueued and pumped) so a
+     * passive log push never claims the idle TX window ahead of an active
+     * dialog reply for this same iteration. */
     if (udsState->log_push_initialized) {
         ISOTP_Poll(&udsState->log_push_isotp_context, now);
     }
@@ -853,16 +959,15 @@ static void ProcessISOTPCompletion(uint32_t now)
 {
     DiveCANUDSState_t *udsState = getUDSState();
 
-    /* Check for completed ISO-TP RX transfers BEFORE polling TX queue
-     * so that responses are enqueued before we try to send them */
+    /* Check for completed ISO-TP RX transfers BEFORE polling TX queue so a
+     * busyRepeatRequest refusal goes out in this same pass */
     if (udsState->isotp_initialized && udsState->isotp_context.rx_complete) {
         /* A request arrived: an addressed reply is imminent. Re-arm the log-push
          * quiescent window so broadcasts don't interleave with the reply on the
          * handset's ISO-TP reassembly context. */
         UDS_LogPush_NoteDialogActivity(now);
-        UDS_ProcessRequest(&udsState->uds_context,
-                   udsState->isotp_context.rx_buffer,
-                   udsState->isotp_context.rx_data_length);
+        /* The worker copies the request, so the context can take the next */
+        (void)UDS_Worker_Submit(&udsState->isotp_context, now);
         udsState->isotp_context.rx_complete = false;
     }
 
@@ -872,15 +977,16 @@ static void ProcessISOTPCompletion(uint32_t now)
         udsState->isotp_context.tx_complete = false;
     }
 
-    /* Poll TX queue AFTER processing RX - ensures responses enqueued
-     * by UDS handler are sent immediately in the same iteration */
+    /* Poll TX queue AFTER processing RX - sends whatever the worker or this
+     * pass queued */
     ISOTP_TxQueue_Poll(now);
 
-    /* Keep the log-push window re-armed while an addressed reply is mid-flight
-     * (multi-frame TX parked in WAIT_FC or streaming CFs). Broadcasts never set
-     * IsBusy, so this only tracks addressed dialogs; the quiescent countdown
-     * therefore starts when the reply fully completes and the queue goes idle. */
-    if (ISOTP_TxQueue_IsBusy()) {
+    /* Keep the log-push window re-armed while the worker is still serving a
+     * request, or an addressed reply is mid-flight (multi-frame TX parked in
+     * WAIT_FC or streaming CFs). Broadcasts never set IsBusy, so this only
+     * tracks addressed dialogs; the quiescent countdown therefore starts when
+     * the reply fully completes and the queue goes idle. */
+    if (UDS_Worker_IsBusy() || ISOTP_TxQueue_IsBusy()) {
         UDS_LogPush_NoteDialogActivity(now);
     }
 
@@ -895,11 +1001,6 @@ static void ProcessISOTPCompletion(uint32_t now)
     if (udsState->log_push_initialized) {
         UDS_LogPush_Poll();
     }
-#ifdef CONFIG_FLASH_LOG
-    /* Resume the flash-log writer if a download stream was abandoned mid-
-     * transfer (safety net — see UDS_LogDownload_Poll). */
-    UDS_LogDownload_Poll();
-#endif
 }
 
 /**
@@ -912,7 +1013,7 @@ static bool ProcessMenuMessage(const DiveCANMessage_t *message)
     DiveCANUDSState_t *udsState = getUDSState();
     bool consumed = false;
 
-    /* Initialize ISO-TP + UDS context on first MENU message
+    /* Initialize the dialog ISO-TP context on first MENU message
      * (needs target address from the incoming message) */
     if (!udsState->isotp_initialized) {
         uint8_t targetType = (uint8_t)(message->id & 0xFFU);
@@ -927,7 +1028,6 @@ static bool ProcessMenuMessage(const DiveCANMessage_t *message)
         }
         ISOTP_Init(&udsState->isotp_context, divecan_get_dev_type(),
                (DiveCANType_t)targetType, MENU_ID);
-        UDS_Init(&udsState->uds_context, &udsState->isotp_context);
         udsState->isotp_initialized = true;
     }
 
@@ -1,13 +1,25 @@
 /**
  * @file divecan_send.c
- * @brief CAN driver interface — init, send, and blocking send
+ * @brief CAN driver interface — init, ordered TX FIFO, and bus statistics
  *
  * Separated from divecan_tx.c (protocol message composers) so that
  * tests can link the real composers against a stub send layer without
  * the compiler inlining across the boundary.
+ *
+ * Every outgoing frame goes through one software FIFO, and a pump thread
+ * keeps exactly one of them in the controller at a time. bxCAN picks among
+ * its three mailboxes by identifier and then by mailbox number, so frames
+ * sharing an ID (an ISO-TP transfer) queued in several mailboxes can leave
+ * out of order. A single frame in flight cannot. The TX-done callback frees
+ * the slot and the pump, which does nothing else and outranks every sender,
+ * refills it straight away: frames leave back to back, and senders only
+ * wait when the FIFO is full. The callback does not refill the mailbox
+ * itself because the STM32 driver's send path takes a mutex, which ISRs
+ * may not.
  */
 
 #include <zephyr/kernel.h>
+#include <zephyr/devicetree.h>
 #include <zephyr/drivers/can.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/atomic.h>
@@ -20,9 +32,137 @@
 
 LOG_MODULE_REGISTER(divecan_send, LOG_LEVEL_INF);
 
-/* Timeout for can_send (ms) — generous to handle bus contention */
+/* Timeout for can_send, a full FIFO and a stuck frame (ms) — generous to
+ * handle bus contention */
 #define CAN_SEND_TIMEOUT_MS 100
 
+/* divecan_send_blocking() wait: a full FIFO drains in ~35 ms at 125 kbit/s,
+ * the rest is the per-frame allowance above. */
+#define CAN_BLOCKING_TIMEOUT_MS 200
+
+/* Longest wait between controller restarts while no frame completes (ms).
+ * Each restart doubles the wait from CAN_SEND_TIMEOUT_MS up to this, so a
+ * head alone on the bus restarts its controller every few seconds rather
+ * than every frame. */
+#define CAN_STALL_BACKOFF_MAX_MS 6400U
+
+/** Pump thread: can_send() and the driver's locking, nothing else. */
+#define CAN_TX_PUMP_STACK_SIZE 1024
+/** Above every sender (PPO2 TX at 4, RX at 5) so a freed mailbox is
+ *  refilled before a sender runs again. */
+#define CAN_TX_PUMP_PRIORITY 3
+
+/** Nominal bus bitrate when the devicetree names none. */
+#define DIVECAN_DEFAULT_BITRATE 125000U
+
+/** OP_ERR_CAN_TX detail: a frame did not complete in time. */
+static const uint32_t CAN_TX_STUCK_DETAIL = 0xFFU;
+/** Bus bitrate for the load figures. */
+static const uint32_t BUS_BITRATE =
+    DT_PROP_OR(DT_CHOSEN(zephyr_canbus), bitrate, DIVECAN_DEFAULT_BITRATE);
+/** Extended data frame bits around the data field: SOF, 29-bit ID, SRR, IDE,
+ *  RTR, r1/r0, DLC, CRC and delimiter, ACK, EOF and intermission. Stuff bits
+ *  are not counted, so the load is a lower bound (worst-case stuffing adds
+ *  about a fifth). */
+static const uint32_t EXT_FRAME_OVERHEAD_BITS = 67U;
+static const uint32_t BITS_PER_BYTE = 8U;
+/** Bus load window (ms). */
+static const uint32_t LOAD_WINDOW_MS = 1000U;
+static const uint64_t PERMILLE = 1000U;
+static const uint64_t MS_PER_S = 1000U;
+
+/** One queued frame. */
+typedef struct {
+    struct can_frame frame;
+    uint32_t ticket;        /**< FIFO position, matched by divecan_send_blocking() */
+    uint32_t queued_cycles; /**< k_cycle_get_32() at enqueue */
+} CanTxSlot_t;
+
+/** What the TX-done callback needs to know about a frame in the controller. */
+typedef struct {
+    uint32_t ticket;
+    uint8_t dlc;
+} CanTxInFlight_t;
+
+/** Statistics accumulators, under tx_lock. */
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t tx_errors;
+    uint32_t dropped;
+    uint32_t rx_frames;
+    uint32_t wait_max_cycles;
+    uint64_t total_bits;
+    uint32_t window_bits;
+    uint32_t window_start_ms;
+    uint16_t load_permille;
+    uint16_t load_peak_permille;
+    uint8_t queue_high_water;
+} CanTxAcc_t;
+
+/** The one divecan_send_blocking() caller waiting on its frame, under tx_lock. */
+typedef struct {
+    uint32_t ticket;
+    Status_t result;
+    bool armed;
+} CanTxWaiter_t;
+
+K_MSGQ_DEFINE(can_tx_fifo, sizeof(CanTxSlot_t), CONFIG_DIVECAN_TX_FIFO_DEPTH, 4);
+BUILD_ASSERT(CONFIG_DIVECAN_TX_FIFO_DEPTH <= UINT8_MAX,
+         "FIFO occupancy is reported in a byte");
+
+/* Orders ticket assignment with FIFO order across senders. */
+static K_MUTEX_DEFINE(tx_enqueue_lock);
+/* One divecan_send_blocking() waiter at a time. */
+static K_MUTEX_DEFINE(tx_blocking_lock);
+/* The controller holds no frame of ours; the pump takes it per frame, and only
+ * the frame's completion (callback or refused can_send) gives it back. */
+static K_SEM_DEFINE(tx_slot_free, 1, 1);
+/* The blocking waiter's frame completed. */
+static K_SEM_DEFINE(tx_waiter_done, 0, 1);
+/* Accumulators and waiter; taken from the TX-done and RX ISRs. */
+static struct k_spinlock tx_lock;
+
+static CanTxAcc_t *getTxAcc(void)
+{
+    static CanTxAcc_t acc;
+    return &acc;
+}
+
+static CanTxWaiter_t *getTxWaiter(void)
+{
+    static CanTxWaiter_t waiter;
+    return &waiter;
+}
+
+/** The frame in the controller. One record is enough: the pump only
+ *  rewrites it after taking tx_slot_free, i.e. once its callback has fired. */
+static CanTxInFlight_t *getInFlight(void)
+{
+    static CanTxInFlight_t in_flight;
+    return &in_flight;
+}
+
+/** Set when a frame misses its deadline, cleared when any frame completes.
+ *  While set the bus has no one to ACK us (or is down): OP_ERR_CAN_TX has
+ *  been raised once for the episode and is not raised again per frame. */
+static atomic_t *getTxStalled(void)
+{
+    static atomic_t stalled;
+    return &stalled;
+}
+
+static bool tx_stalled(void)
+{
+    return 0 != atomic_get(getTxStalled());
+}
+
+/** Next ticket to hand out; under tx_enqueue_lock. */
+static uint32_t *getNextTicket(void)
+{
+    static uint32_t next_ticket;
+    return &next_ticket;
+}
+
 /**
  * @brief Return pointer to the file-scoped TX counter
  *
@@ -71,30 +211,267 @@ static const struct device **get_can_dev(void)
     return &dev;
 }
 
-/* Semaphore for blocking sends */
-static K_SEM_DEFINE(tx_done_sem, 0, 1);
+/* ---- Statistics ---- */
+
+/** Wire bits of an extended data frame with @p dlc data bytes (no stuffing). */
+static uint32_t frame_bits(uint8_t dlc)
+{
+    return EXT_FRAME_OVERHEAD_BITS + (BITS_PER_BYTE * (uint32_t)dlc);
+}
+
+/**
+ * @brief Close the load window once it spans LOAD_WINDOW_MS. Caller holds tx_lock.
+ *
+ * Windows close on traffic or on a statistics read, so after a quiet spell
+ * the window simply runs longer and its load is the mean over it.
+ */
+static void load_roll(CanTxAcc_t *acc, uint32_t now_ms)
+{
+    uint32_t elapsed_ms = now_ms - acc->window_start_ms;
+
+    if (elapsed_ms >= LOAD_WINDOW_MS) {
+        uint64_t capacity = ((uint64_t)BUS_BITRATE * elapsed_ms) / MS_PER_S;
+        uint64_t permille = ((uint64_t)acc->window_bits * PERMILLE) / capacity;
+
+        acc->load_permille = (uint16_t)MIN(permille, PERMILLE);
+        acc->load_peak_permille = MAX(acc->load_peak_permille, acc->load_permille);
+        acc->window_bits = 0U;
+        acc->window_start_ms = now_ms;
+    }
+}
+
+/** Account @p dlc bytes of bus traffic. Caller holds tx_lock. */
+static void load_add(CanTxAcc_t *acc, uint8_t dlc)
+{
+    uint32_t bits = frame_bits(dlc);
+
+    load_roll(acc, k_uptime_get_32());
+    acc->window_bits += bits;
+    acc->total_bits += bits;
+}
+
+void divecan_send_note_rx_frame(uint8_t dlc)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    CanTxAcc_t *acc = getTxAcc();
+
+    ++acc->rx_frames;
+    load_add(acc, dlc);
+    k_spin_unlock(&tx_lock, key);
+}
+
+void divecan_send_get_stats(DivecanTxStats_t *out)
+{
+    CanTxAcc_t copy;
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    load_roll(getTxAcc(), k_uptime_get_32());
+    copy = *getTxAcc();
+    k_spin_unlock(&tx_lock, key);
+
+    int64_t uptime_ms = k_uptime_get();
+
+    (void)memset(out, 0, sizeof(*out));
+    out->frames_sent = copy.frames_sent;
+    out->tx_errors = copy.tx_errors;
+    out->dropped = copy.dropped;
+    out->rx_frames = copy.rx_frames;
+    out->wait_max_us = k_cyc_to_us_floor32(copy.wait_max_cycles);
+    out->load_permille = copy.load_permille;
+    out->load_peak_permille = copy.load_peak_permille;
+    if (uptime_ms > 0) {
+        uint64_t capacity = ((uint64_t)BUS_BITRATE * (uint64_t)uptime_ms) / MS_PER_S;
+        uint64_t permille = (copy.total_bits * PERMILLE) / MAX(capacity, 1U);
+
+        out->load_mean_permille = (uint16_t)MIN(permille, PERMILLE);
+    }
+    out->queue_depth = (uint8_t)CONFIG_DIVECAN_TX_FIFO_DEPTH;
+    out->queued = (uint8_t)k_msgq_num_used_get(&can_tx_fifo);
+    out->queue_high_water = copy.queue_high_water;
+}
+
+/** @brief Little-endian u32 store (the DID payload byte order). */
+static void put_u32(uint8_t *buf, uint32_t v)
+{
+    buf[0] = (uint8_t)(v & 0xFFU);
+    buf[1] = (uint8_t)((v >> 8) & 0xFFU);
+    buf[2] = (uint8_t)((v >> 16) & 0xFFU);
+    buf[3] = (uint8_t)((v >> 24) & 0xFFU);
+}
+
+/** @brief Little-endian u16 store. */
+static void put_u16(uint8_t *buf, uint16_t v)
+{
+    buf[0] = (uint8_t)(v & 0xFFU);
+    buf[1] = (uint8_t)(v >> 8);
+}
+
+size_t divecan_send_serialise_stats(uint8_t *buf, size_t size)
+{
+    size_t written = 0U;
+
+    if ((buf != NULL) && (size >= DIVECAN_TX_STATS_BYTES)) {
+        DivecanTxStats_t st;
+
+        divecan_send_get_stats(&st);
+        buf[0] = DIVECAN_TX_STATS_VERSION;
+        buf[1] = st.queue_depth;
+        buf[2] = st.queued;
+        buf[3] = st.queue_high_water;
+        put_u32(&buf[4], st.frames_sent);
+        put_u32(&buf[8], st.tx_errors);
+        put_u32(&buf[12], st.dropped);
+        put_u32(&buf[16], st.rx_frames);
+        put_u32(&buf[20], st.wait_max_us);
+        put_u16(&buf[24], st.load_permille);
+        put_u16(&buf[26], st.load_peak_permille);
+        put_u16(&buf[28], st.load_mean_permille);
+        written = DIVECAN_TX_STATS_BYTES;
+    }
+    return written;
+}
+
+/* ---- TX completion ---- */
+
+/**
+ * @brief Account a frame that left the FIFO, successfully or not.
+ *
+ * Runs in the TX-done ISR, or in the pump when the controller refused the
+ * frame. Wakes divecan_send_blocking() if it is waiting on this frame.
+ */
+static void complete_frame(const CanTxInFlight_t *rec, Status_t error)
+{
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    CanTxAcc_t *acc = getTxAcc();
+    CanTxWaiter_t *waiter = getTxWaiter();
+    bool wake = false;
+
+    if (0 != error) {
+        ++acc->tx_errors;
+    } else {
+        ++acc->frames_sent;
+        load_add(acc, rec->dlc);
+    }
+    if (waiter->armed && (waiter->ticket == rec->ticket)) {
+        waiter->result = error;
+        waiter->armed = false;
+        wake = true;
+    }
+    k_spin_unlock(&tx_lock, key);
+
+    if (0 != error) {
+        if (!tx_stalled()) {
+            OP_ERROR_DETAIL(OP_ERR_CAN_TX, (uint32_t)(-error));
+        }
+    } else {
+        (void)atomic_clear(getTxStalled());
+        bump_tx_count();
+    }
+    if (wake) {
+        k_sem_give(&tx_waiter_done);
+    }
+}
 
 /**
  * @brief CAN TX completion callback, called from ISR context
  *
- * Signals the blocking-send semaphore and logs any TX error.
+ * Accounts the frame and frees the controller slot for the pump.
  *
  * @param dev       CAN device that completed the transmission (unused)
  * @param error     Zero on success; negative errno on failure
- * @param user_data User data pointer passed to can_send (unused)
+ * @param user_data The frame's CanTxInFlight_t record
  */
 static void tx_done_callback(const struct device *dev, int error,
                  void *user_data)
 {
     ARG_UNUSED(dev);
-    ARG_UNUSED(user_data);
 
-    if (0 != error) {
-        OP_ERROR_DETAIL(OP_ERR_CAN_TX, (uint32_t)(-error));
+    complete_frame((const CanTxInFlight_t *)user_data, error);
+    k_sem_give(&tx_slot_free);
+}
+
+/* ---- Pump ---- */
+
+/**
+ * @brief Wait until the controller holds no frame of ours.
+ *
+ * A frame that never completes (no ACK, bus-off) is aborted rather than left
+ * in its mailbox: a second frame sent beside it could leave first from
+ * another mailbox and break the FIFO order. Stopping the controller fails
+ * every pending TX with -ENETDOWN through its callback, which completes that
+ * frame's ticket and frees the slot. If the controller was already stopped by
+ * someone else it is left stopped, and the pump keeps waiting for the
+ * callback.
+ *
+ * No ACK is the normal state of a head alone on the bus, and a restart drops
+ * whatever the controller was receiving, so the first abort comes after
+ * CAN_SEND_TIMEOUT_MS and each one after that waits twice as long, up to
+ * CAN_STALL_BACKOFF_MAX_MS. Until then the frame keeps retrying in its
+ * mailbox and leaves as soon as a peer ACKs it. The episode raises
+ * OP_ERR_CAN_TX once; the first frame that completes ends it and resets the
+ * wait.
+ *
+ * @param wait_ms In/out: the pump's current restart wait (ms)
+ */
+static void take_tx_slot(uint32_t *wait_ms)
+{
+    const struct device *dev = *get_can_dev();
+
+    if (!tx_stalled()) {
+        *wait_ms = CAN_SEND_TIMEOUT_MS;
+    }
+    while (0 != k_sem_take(&tx_slot_free, K_MSEC(*wait_ms))) {
+        if (0 == atomic_set(getTxStalled(), 1)) {
+            OP_ERROR_DETAIL(OP_ERR_CAN_TX, CAN_TX_STUCK_DETAIL);
+        }
+        if (0 == can_stop(dev)) {
+            (void)can_start(dev);
+        }
+        *wait_ms = MIN(*wait_ms * 2U, CAN_STALL_BACKOFF_MAX_MS);
     }
-    k_sem_give(&tx_done_sem);
 }
 
+/**
+ * @brief Move frames from the FIFO into the controller, one at a time.
+ */
+static void can_tx_pump_fn(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    uint32_t restart_wait_ms = CAN_SEND_TIMEOUT_MS;
+
+    while (true) {
+        CanTxSlot_t slot = {0};
+
+        (void)k_msgq_get(&can_tx_fifo, &slot, K_FOREVER);
+        take_tx_slot(&restart_wait_ms);
+
+        uint32_t waited = k_cycle_get_32() - slot.queued_cycles;
+        k_spinlock_key_t key = k_spin_lock(&tx_lock);
+        getTxAcc()->wait_max_cycles = MAX(getTxAcc()->wait_max_cycles, waited);
+        k_spin_unlock(&tx_lock, key);
+
+        CanTxInFlight_t *rec = getInFlight();
+        rec->ticket = slot.ticket;
+        rec->dlc = slot.frame.dlc;
+
+        Status_t rc = can_send(*get_can_dev(), &slot.frame,
+                       K_MSEC(CAN_SEND_TIMEOUT_MS), tx_done_callback, rec);
+        if (0 != rc) {
+            complete_frame(rec, rc);
+            k_sem_give(&tx_slot_free);
+        }
+    }
+}
+
+K_THREAD_DEFINE(can_tx_pump, CAN_TX_PUMP_STACK_SIZE,
+        can_tx_pump_fn, NULL, NULL, NULL,
+        CAN_TX_PUMP_PRIORITY, 0, 0);
+
+/* ---- Senders ---- */
+
 /**
  * @brief Initialize the DiveCAN TX layer and start the CAN controller
  *
@@ -147,30 +524,77 @@ static struct can_frame msg_to_frame(const DiveCANMessage_t *msg)
 }
 
 /**
- * @brief Transmit a DiveCAN message (non-blocking)
+ * @brief Append @p msg to the TX FIFO.
  *
- * Builds a CAN frame and calls can_send() with a 100 ms timeout.
- * Does not wait for TX completion; use divecan_send_blocking() where
- * frame-ordering guarantees are required (e.g., ISO-TP consecutive frames).
+ * While the bus is stalled a full FIFO fails at once: it will not drain
+ * before the next controller restart, and senders must not stall with it.
  *
- * @param msg Message to transmit (must not be NULL)
- * @return 0 on success, negative errno on failure
+ * A @p may_block of false never waits, for the FIFO or for another sender,
+ * and leaves a refusal to the caller: it is not counted as a drop.
+ *
+ * @param msg       Message to queue
+ * @param wait      Arm the blocking waiter on this frame before it can complete
+ * @param may_block Wait up to CAN_SEND_TIMEOUT_MS for room in the FIFO
+ * @return 0 once queued, -ENODEV before divecan_tx_init(), -EAGAIN if the
+ *         FIFO stayed full for CAN_SEND_TIMEOUT_MS (or was full on a
+ *         stalled bus, or at all without @p may_block)
  */
-Status_t divecan_send(const DiveCANMessage_t *msg)
+static Status_t enqueue_frame(const DiveCANMessage_t *msg, bool wait, bool may_block)
 {
-    const struct device *dev = *get_can_dev();
     Status_t result = -ENODEV;
 
-    if (NULL == dev) {
+    if (NULL == *get_can_dev()) {
         OP_ERROR(OP_ERR_CAN_TX);
     } else {
-        struct can_frame frame = msg_to_frame(msg);
-        result = can_send(dev, &frame, K_MSEC(CAN_SEND_TIMEOUT_MS),
-                  NULL, NULL);
-        if (0 != result) {
-            OP_ERROR_DETAIL(OP_ERR_CAN_TX, (uint32_t)(-result));
+        CanTxSlot_t slot = {
+            .frame = msg_to_frame(msg),
+            .queued_cycles = k_cycle_get_32(),
+        };
+
+        k_timeout_t lock_timeout = K_NO_WAIT;
+        k_timeout_t put_timeout = K_NO_WAIT;
+
+        if (may_block) {
+            lock_timeout = K_MSEC(CAN_SEND_TIMEOUT_MS);
+            if (!tx_stalled()) {
+                put_timeout = K_MSEC(CAN_SEND_TIMEOUT_MS);
+            }
+        }
+        result = k_mutex_lock(&tx_enqueue_lock, lock_timeout);
+        if (0 == result) {
+            slot.ticket = *getNextTicket();
+            if (wait) {
+                k_spinlock_key_t key = k_spin_lock(&tx_lock);
+                *getTxWaiter() = (CanTxWaiter_t){ .ticket = slot.ticket, .armed = true };
+                k_spin_unlock(&tx_lock, key);
+            }
+            result = k_msgq_put(&can_tx_fifo, &slot, put_timeout);
+            if (0 == result) {
+                ++(*getNextTicket());
+            }
+            (void)k_mutex_unlock(&tx_enqueue_lock);
+        }
+
+        k_spinlock_key_t key = k_spin_lock(&tx_lock);
+        CanTxAcc_t *acc = getTxAcc();
+        if (0 == result) {
+            uint8_t used = (uint8_t)k_msgq_num_used_get(&can_tx_fifo);
+            acc->queue_high_water = MAX(acc->queue_high_water, used);
         } else {
-            bump_tx_count();
+            if (may_block) {
+                ++acc->dropped;
+            }
+            if (wait) {
+                getTxWaiter()->armed = false;
+            }
+        }
+        k_spin_unlock(&tx_lock, key);
+
+        if (0 != result) {
+            result = -EAGAIN;
+            if (may_block && (!tx_stalled())) {
+                OP_ERROR_DETAIL(OP_ERR_CAN_TX, (uint32_t)(-result));
+            }
         }
     }
 
@@ -178,46 +602,71 @@ Status_t divecan_send(const DiveCANMessage_t *msg)
 }
 
 /**
- * @brief Transmit a DiveCAN message and wait for TX completion
+ * @brief Queue a DiveCAN message for transmission (non-blocking)
  *
- * Like divecan_send() but blocks until the frame has left the bus (tx_done
- * callback fires).  Required for ISO-TP multi-frame sequences where frame
- * ordering must be preserved under CAN bus arbitration retries.
+ * Frames leave in the order they were queued, by any caller. Waits only
+ * while the FIFO is full. Send errors found later are counted (DID 0xF292)
+ * and reported as OP_ERR_CAN_TX.
  *
  * @param msg Message to transmit (must not be NULL)
- * @return 0 on success, -ETIMEDOUT if TX did not complete within 100 ms,
- *         other negative errno on CAN driver error
+ * @return 0 once queued, negative errno on failure
  */
-Status_t divecan_send_blocking(const DiveCANMessage_t *msg)
+Status_t divecan_send(const DiveCANMessage_t *msg)
 {
-    const struct device *dev = *get_can_dev();
-    Status_t result = -ENODEV;
+    return enqueue_frame(msg, false, true);
+}
 
-    if (NULL == dev) {
-        OP_ERROR(OP_ERR_CAN_TX);
-    } else {
-        struct can_frame frame = msg_to_frame(msg);
+/**
+ * @brief Queue a DiveCAN message only if the FIFO has room right now
+ *
+ * For callers holding a lock others wait on (the ISO-TP TX queue's
+ * broadcast bursts): they retry later instead of waiting here. A refusal
+ * is not counted as a drop.
+ *
+ * @param msg Message to transmit (must not be NULL)
+ * @return 0 once queued, -EAGAIN if the FIFO is full, other negative
+ *         errno on failure
+ */
+Status_t divecan_send_nowait(const DiveCANMessage_t *msg)
+{
+    return enqueue_frame(msg, false, false);
+}
 
-        k_sem_reset(&tx_done_sem);
-        result = can_send(dev, &frame, K_MSEC(CAN_SEND_TIMEOUT_MS),
-                  tx_done_callback, NULL);
-        if (0 != result) {
-            OP_ERROR_DETAIL(OP_ERR_CAN_TX, (uint32_t)(-result));
-        } else {
-            /* Wait for the frame to actually leave the bus.
-             * Required for ISO-TP where frame ordering is
-             * critical — with auto-retransmission enabled,
-             * frames that lose arbitration could be retried
-             * and transmitted out of order if we don't wait. */
-            if (0 != k_sem_take(&tx_done_sem,
-                       K_MSEC(CAN_SEND_TIMEOUT_MS))) {
-                OP_ERROR_DETAIL(OP_ERR_CAN_TX, 0xFFU);
-                result = -ETIMEDOUT;
-            } else {
-                bump_tx_count();
+/**
+ * @brief Queue a DiveCAN message and wait until it has left the bus
+ *
+ * For callers that need wire-time separation (ISO-TP STmin) or the frame's
+ * outcome. Ordering does not need it: every frame already leaves in FIFO
+ * order.
+ *
+ * @param msg Message to transmit (must not be NULL)
+ * @return 0 on success, -ETIMEDOUT if it did not complete within
+ *         CAN_BLOCKING_TIMEOUT_MS, other negative errno on a queue or CAN
+ *         driver error
+ */
+Status_t divecan_send_blocking(const DiveCANMessage_t *msg)
+{
+    Status_t result = 0;
+
+    (void)k_mutex_lock(&tx_blocking_lock, K_FOREVER);
+    k_sem_reset(&tx_waiter_done);
+    result = enqueue_frame(msg, true, true);
+    if (0 == result) {
+        if (0 != k_sem_take(&tx_waiter_done, K_MSEC(CAN_BLOCKING_TIMEOUT_MS))) {
+            k_spinlock_key_t key = k_spin_lock(&tx_lock);
+            getTxWaiter()->armed = false;
+            k_spin_unlock(&tx_lock, key);
+            if (!tx_stalled()) {
+                OP_ERROR_DETAIL(OP_ERR_CAN_TX, CAN_TX_STUCK_DETAIL);
             }
+            result = -ETIMEDOUT;
+        } else {
+            k_spinlock_key_t key = k_spin_lock(&tx_lock);
+            result = getTxWaiter()->result;
+            k_spin_unlock(&tx_lock, key);
         }
     }
+    (void)k_mutex_unlock(&tx_blocking_lock);
 
     return result;
 }
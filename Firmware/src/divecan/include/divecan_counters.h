@@ -10,17 +10,21 @@
  * Counters saturate at UINT32_MAX rather than wrap, so the POST check can
  * use a simple "did the counter advance by N since I last looked" pattern
  * without worrying about wrap-around during the deadline window.
+ *
+ * Also carries the TX FIFO and bus-load statistics kept by divecan_send.c,
+ * served on DID 0xF292.
  */
 #ifndef DIVECAN_COUNTERS_H
 #define DIVECAN_COUNTERS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
- * @brief Number of DiveCAN frames successfully handed to the CAN driver.
+ * @brief Number of DiveCAN frames that completed on the bus.
  *
- * Bumped on every divecan_send()/divecan_send_blocking() that returns 0.
- * Saturating; never wraps.
+ * Bumped from the TX-done callback for every frame the controller reports
+ * sent, whichever of divecan_send()/divecan_send_blocking() queued it.
  */
 uint32_t divecan_send_get_tx_count(void);
 
@@ -41,4 +45,53 @@ uint32_t divecan_rx_get_bus_init_count(void);
  */
 uint32_t divecan_rx_get_bus_id_count(void);
 
+/** @brief TX FIFO and bus statistics since boot. */
+typedef struct {
+    uint32_t frames_sent;        /**< Frames the controller reported sent */
+    uint32_t tx_errors;          /**< Frames refused or failed by the controller */
+    uint32_t dropped;            /**< Frames refused because the FIFO stayed full */
+    uint32_t rx_frames;          /**< DiveCAN frames received (counted into the load) */
+    uint32_t wait_max_us;        /**< Longest FIFO wait before a frame reached the controller */
+    uint16_t load_permille;      /**< Bus time taken by DiveCAN frames, last window (>= 1 s) */
+    uint16_t load_peak_permille; /**< Highest window load since boot */
+    uint16_t load_mean_permille; /**< Load averaged over uptime */
+    uint8_t queue_depth;         /**< FIFO capacity (CONFIG_DIVECAN_TX_FIFO_DEPTH) */
+    uint8_t queued;              /**< Frames waiting in the FIFO now */
+    uint8_t queue_high_water;    /**< Most frames ever waiting at once */
+} DivecanTxStats_t;
+
+/** @brief Version byte leading the serialised statistics. */
+#define DIVECAN_TX_STATS_VERSION 1U
+
+/** @brief Serialised DivecanTxStats_t: four bytes, five u32, three u16. */
+#define DIVECAN_TX_STATS_BYTES (4U + (5U * sizeof(uint32_t)) + (3U * sizeof(uint16_t)))
+
+/**
+ * @brief Account a received DiveCAN frame into the bus load.
+ *
+ * ISR-safe; called from the CAN RX filter callback.
+ *
+ * @param dlc Data length of the received frame
+ */
+void divecan_send_note_rx_frame(uint8_t dlc);
+
+/**
+ * @brief Snapshot the TX statistics.
+ *
+ * @param out Destination, must not be NULL
+ */
+void divecan_send_get_stats(DivecanTxStats_t *out);
+
+/**
+ * @brief Serialise the statistics (DID 0xF292), little-endian:
+ *        [version][queue_depth][queued][queue_high_water], then frames_sent,
+ *        tx_errors, dropped, rx_frames, wait_max_us (u32), then
+ *        load_permille, load_peak_permille, load_mean_permille (u16).
+ *
+ * @param buf  Destination
+ * @param size Capacity of @p buf
+ * @return DIVECAN_TX_STATS_BYTES, or 0 when @p buf is NULL or too small
+ */
+size_t divecan_send_serialise_stats(uint8_t *buf, size_t size);
+
 #endif /* DIVECAN_COUNTERS_H */
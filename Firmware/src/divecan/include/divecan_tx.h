@@ -30,6 +30,14 @@ Status_t divecan_tx_init(const struct device *can_dev);
  */
 Status_t divecan_send(const DiveCANMessage_t *msg);
 
+/**
+ * @brief Transmit a DiveCAN frame only if the TX queue has room now (never waits).
+ *
+ * @param msg Fully formed DiveCAN message to transmit
+ * @return 0 on success, -EAGAIN if the TX queue is full
+ */
+Status_t divecan_send_nowait(const DiveCANMessage_t *msg);
+
 /**
  * @brief Transmit a DiveCAN frame synchronously (blocks until sent or error).
  *
@@ -46,4 +46,32 @@ static inline bool handset_failsafe_should_revert(uint32_t now_ms,
            ((now_ms - last_ping_ms) > timeout_ms);
 }
 
+/**
+ * @brief Uptime at which handset_failsafe_should_revert() would next fire.
+ *
+ * Lets the RX thread sleep until the handset would count as lost rather
+ * than re-checking on a fixed tick.
+ *
+ * @param last_ping_ms     Uptime of the most recent handset (controller) ping.
+ * @param handset_seen     A controller ping has arrived at least once.
+ * @param fallback_applied The fallback has already been published for this loss.
+ * @param timeout_ms       Ping-gap threshold (HANDSET_PING_TIMEOUT_MS in prod).
+ * @param deadline_ms      Set to the first uptime the fallback fires at.
+ * @return true if the detector is armed and @p deadline_ms was set.
+ */
+static inline bool handset_failsafe_deadline(uint32_t last_ping_ms,
+                         bool handset_seen,
+                         bool fallback_applied,
+                         uint32_t timeout_ms,
+                         uint32_t *deadline_ms)
+{
+    bool armed = handset_seen && (!fallback_applied);
+
+    if (armed) {
+        /* should_revert() needs the gap to EXCEED the timeout. */
+        *deadline_ms = last_ping_ms + timeout_ms + 1U;
+    }
+    return armed;
+}
+
 #endif /* HANDSET_FAILSAFE_H */
@@ -14,6 +14,8 @@
  * Memory constraints:
  * - Buffer size configurable via ISOTP_MAX_PAYLOAD (default 256 bytes)
  * - Larger messages rejected with FC Overflow
+ * - TX of up to ISOTP_EXT_MAX_PAYLOAD bytes from a caller-owned buffer via
+ *   ISOTP_SendExternal() (no reassembly counterpart)
  *
  * @note Static allocation only (NASA Rule 10 compliance)
  */
@@ -30,10 +32,15 @@
 
 /* ISO-TP Configuration */
 #define ISOTP_MAX_PAYLOAD 256      /**< Maximum payload size (sized for binary state vector + overhead) */
+/* Extended-length TX: the FF length field is 12 bits and counts the DiveCAN
+ * pad byte, so one message carries at most 0xFFF - 1 payload bytes. */
+#define ISOTP_EXT_MAX_PAYLOAD 4094U /**< Maximum ISOTP_SendExternal() payload */
 #define ISOTP_TIMEOUT_N_BS 1000U   /**< ms - Timeout waiting for FC after sending FF */
 #define ISOTP_TIMEOUT_N_CR 1000    /**< ms - Timeout waiting for CF after FC or previous CF */
 #define ISOTP_DEFAULT_BLOCK_SIZE 0 /**< 0 = infinite (no additional FC frames needed) */
 #define ISOTP_DEFAULT_STMIN 0      /**< 0 ms minimum separation time between CF frames */
+/* The FC we advertise starts at these defaults and slows down per peer when
+ * the link drops frames — see isotp_link.h. */
 
 /* PCI (Protocol Control Information) byte values and masks
  * Note: These remain as #defines because they are used in switch case statements,
@@ -126,6 +133,9 @@ typedef struct {
     uint8_t rx_sequence_number;            /**< Expected next CF sequence number (0-15) */
     uint8_t rx_buffer[ISOTP_MAX_PAYLOAD]; /**< Reassembly buffer */
     uint32_t rx_last_frame_time;            /**< ms timestamp of last received frame */
+    uint8_t rx_block_size;                 /**< BS we advertised in the last FC (0 = infinite) */
+    uint8_t rx_stmin;                      /**< STmin we advertised in the last FC */
+    uint8_t rx_block_counter;              /**< CFs received in the current block */
     bool rx_complete;                     /**< RX transfer complete flag (caller must clear) */
 
     /* TX state */
@@ -170,6 +180,19 @@ typedef struct {
     bool current_consumed; /**< Set by handlers; read by ISOTP_ProcessRxFrame */
 } ISOTPContext_t;
 
+/**
+ * @brief Where a reply goes, kept apart from the context it came in on.
+ *
+ * A dialog context retargets to every new sender, so a reply produced after
+ * the request was handed off (the UDS worker) carries its own addressing.
+ */
+typedef struct {
+    DiveCANType_t source; /**< Our device type */
+    DiveCANType_t target; /**< Requester's device type */
+    uint32_t message_id;  /**< Base CAN ID */
+    bool tx_complete;     /**< Set once a reply is queued (caller must clear) */
+} ISOTPReply_t;
+
 /* Public API */
 
 /**
@@ -216,6 +239,41 @@ bool ISOTP_ProcessRxFrame(ISOTPContext_t *ctx, const DiveCANMessage_t *message);
  */
 bool ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *data, uint16_t length);
 
+/**
+ * @brief Send an extended-length message straight from the caller's buffer
+ *
+ * Like ISOTP_Send(), but the TX queue keeps a pointer to @p data instead of
+ * copying it into a 256-byte slot, so one message may be as long as the
+ * 12-bit First Frame length allows. @p data must stay untouched until
+ * ISOTP_TxQueue_ExternalPending() returns false.
+ *
+ * @param ctx ISO-TP context
+ * @param data Data to send (caller-owned, see above)
+ * @param length Data length (1 to ISOTP_EXT_MAX_PAYLOAD bytes)
+ * @return true if queued, false if invalid length or queue full
+ */
+bool ISOTP_SendExternal(ISOTPContext_t *ctx, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief ISOTP_Send() to the peer recorded in @p to
+ *
+ * @param to Reply addressing; tx_complete is set once queued
+ * @param data Data to send (must remain valid until transmitted)
+ * @param length Data length (1-256 bytes)
+ * @return true if queued, false if invalid length or queue full
+ */
+bool ISOTP_Reply(ISOTPReply_t *to, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief ISOTP_SendExternal() to the peer recorded in @p to
+ *
+ * @param to Reply addressing; tx_complete is set once queued
+ * @param data Data to send (caller-owned, as for ISOTP_SendExternal())
+ * @param length Data length (1 to ISOTP_EXT_MAX_PAYLOAD bytes)
+ * @return true if queued, false if invalid length or queue full
+ */
+bool ISOTP_ReplyExternal(ISOTPReply_t *to, const uint8_t *data, uint16_t length);
+
 /**
  * @brief Poll for timeouts (RX only — TX is handled by centralized queue)
  *
@@ -227,6 +285,17 @@ bool ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *data, uint16_t length);
  */
 void ISOTP_Poll(ISOTPContext_t *ctx, uint32_t currentTime);
 
+/**
+ * @brief Uptime at which ISOTP_Poll() next has work to do
+ *
+ * Lets the RX thread sleep until the N_Cr timeout instead of polling.
+ *
+ * @param ctx ISO-TP context
+ * @param deadline Set to the uptime (ms) the pending N_Cr timeout expires
+ * @return true if a reception is in progress and @p deadline was set
+ */
+bool ISOTP_NextDeadline(const ISOTPContext_t *ctx, uint32_t *deadline);
+
 /**
  * @brief Reset context to IDLE state (error recovery)
  *
@@ -0,0 +1,122 @@
+/**
+ * @file isotp_link.h
+ * @brief Per-peer ISO-TP link quality and adaptive flow parameters
+ *
+ * The head reaches its UDS clients over two very different paths on the same
+ * MENU_ID channel: directly on the bus, and through the handset's BLE bridge
+ * (source 0xFF), whose reassembly is slower and drops frames under load. A
+ * fixed BS/STmin and 0x36 block size is either too slow for the first or too
+ * lossy for the second, so each peer walks a small ladder of settings:
+ *
+ *   level 3: BS 0,  STmin 0 ms, full 0x36 block  (start; the legacy setting)
+ *   level 2: BS 16, STmin 1 ms, 192 B block
+ *   level 1: BS 8,  STmin 2 ms, 128 B block
+ *   level 0: BS 4,  STmin 5 ms,  64 B block
+ *
+ * A link fault (RX N_Cr timeout or CF sequence error, TX N_Bs timeout or an
+ * FC WAIT/OVFLW refusal) drops the peer one level at once;
+ * ISOTP_LINK_PROMOTE_STREAK clean multi-frame transfers in a row raise it one
+ * level again. The level sets the BS/STmin this node advertises in its own
+ * Flow Control and caps the block the UDS 0x34 handlers negotiate, so the
+ * 0x36 chunk size follows the link at the next download.
+ *
+ * Every frame to or from a peer is also counted, and a 1 s window turns the
+ * count into frames/s. Counters, rate and the current level are published on
+ * DID 0xF290 (ISOTP_Link_FillStats()).
+ *
+ * @note Not thread-safe: only the DiveCAN RX thread calls in (it owns the RX
+ *       contexts, the TX queue state machine and the UDS dispatcher).
+ */
+
+#ifndef ISOTP_LINK_H
+#define ISOTP_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "isotp.h"
+
+#define ISOTP_LINK_PEER_SLOTS     4U   /**< Peers tracked; the oldest is recycled */
+#define ISOTP_LINK_LEVELS         4U   /**< Rungs of the flow-parameter ladder */
+#define ISOTP_LINK_PROMOTE_STREAK 16U  /**< Clean transfers before stepping up */
+#define ISOTP_LINK_WINDOW_MS      1000U /**< frames/s measurement window */
+
+#define ISOTP_LINK_STATS_VERSION  1U   /**< DID 0xF290 layout version */
+#define ISOTP_LINK_STATS_HDR_LEN  2U   /**< version u8 + peer count u8 */
+#define ISOTP_LINK_STATS_PEER_LEN 24U  /**< Bytes per peer record */
+/** @brief Largest DID 0xF290 payload. */
+#define ISOTP_LINK_STATS_MAX_LEN \
+    (ISOTP_LINK_STATS_HDR_LEN + (ISOTP_LINK_PEER_SLOTS * ISOTP_LINK_STATS_PEER_LEN))
+
+/** @brief Link faults that step a peer down the ladder. */
+typedef enum {
+    ISOTP_LINK_FAULT_RX_TIMEOUT = 0, /**< N_Cr expired waiting for a CF */
+    ISOTP_LINK_FAULT_RX_SEQUENCE,    /**< CF arrived out of sequence */
+    ISOTP_LINK_FAULT_TX_TIMEOUT,     /**< N_Bs expired waiting for FC */
+    ISOTP_LINK_FAULT_TX_REFUSED,     /**< Peer answered FC WAIT or OVFLW */
+} IsotpLinkFault_e;
+
+/**
+ * @brief Forget every peer (all start again at the fastest level).
+ *
+ * Called once at startup from the RX thread alongside ISOTP_TxQueue_Init().
+ */
+void ISOTP_Link_Init(void);
+
+/**
+ * @brief Count one CAN frame sent to or received from @p peer.
+ *
+ * @param peer DiveCAN address of the remote node (0xFF = BLE bridge)
+ */
+void ISOTP_Link_NoteFrame(uint8_t peer);
+
+/**
+ * @brief Record a multi-frame transfer that completed without a fault.
+ *
+ * @param peer DiveCAN address of the remote node
+ * @param rx   true for a reassembled inbound message, false for a sent one
+ */
+void ISOTP_Link_NoteTransfer(uint8_t peer, bool rx);
+
+/**
+ * @brief Record a link fault and step @p peer one level down.
+ *
+ * @param peer  DiveCAN address of the remote node
+ * @param fault What went wrong
+ */
+void ISOTP_Link_NoteFault(uint8_t peer, IsotpLinkFault_e fault);
+
+/**
+ * @brief Flow Control parameters to advertise to @p peer.
+ *
+ * @param peer      DiveCAN address of the remote node
+ * @param blockSize Out: BS (0 = no further FC)
+ * @param stmin     Out: STmin in ms
+ */
+void ISOTP_Link_FlowParams(uint8_t peer, uint8_t *blockSize, uint8_t *stmin);
+
+/**
+ * @brief Largest 0x36 block a UDS transfer replying to @p to should negotiate.
+ *
+ * @param to   Reply addressing of the UDS dialog (NULL = no limit)
+ * @param full Block size the service would use on a perfect link
+ * @return @p full, or less while the requester is on a slower level
+ */
+uint16_t ISOTP_Link_BlockLimit(const ISOTPReply_t *to, uint16_t full);
+
+/**
+ * @brief Serialise the DID 0xF290 payload.
+ *
+ * [version u8][count u8] then per tracked peer, little-endian:
+ * peer u8, level u8, BS u8, STmin u8, block u16 (0xFFFF = the service's
+ * own maximum), frames/s u16, frames u32,
+ * rx_transfers u16, rx_timeouts u16, rx_seq_errors u16, tx_transfers u16,
+ * tx_timeouts u16, tx_refusals u16. Counters saturate.
+ *
+ * @param buf  Destination buffer
+ * @param size Capacity of @p buf
+ * @return Bytes written, or 0 when @p size < ISOTP_LINK_STATS_MAX_LEN
+ */
+uint16_t ISOTP_Link_FillStats(uint8_t *buf, uint16_t size);
+
+#endif /* ISOTP_LINK_H */
@@ -15,6 +15,8 @@
 
 #include "divecan_types.h"
 
+struct k_msgq;
+
 /* Queue configuration */
 #define ISOTP_TX_QUEUE_SIZE 2U       /**< Max pending ISO-TP TX requests */
 #define ISOTP_TX_BUFFER_SIZE 256U    /**< TX buffer size - matches ISOTP_MAX_PAYLOAD */
@@ -40,13 +42,49 @@ void ISOTP_TxQueue_Init(void);
  * @return true if enqueued successfully, false if queue full or invalid params
  *
  * @note A broadcast transfer (target == ISOTP_BROADCAST_ADDR) is sent
- *       fire-and-forget — the whole message goes out on the next poll without
- *       waiting for Flow Control — so it never stalls an addressed reply.
+ *       fire-and-forget — it goes out on the next poll without waiting for
+ *       Flow Control, or from later polls if the CAN TX FIFO is full — so it
+ *       never stalls an addressed reply.
  */
 bool ISOTP_TxQueue_Enqueue(DiveCANType_t source, DiveCANType_t target,
                 uint32_t message_id, const uint8_t *data,
                 uint16_t length);
 
+/**
+ * @brief Enqueue an ISO-TP message that is sent from the caller's buffer
+ *
+ * Zero-copy counterpart of ISOTP_TxQueue_Enqueue() for messages longer than
+ * ISOTP_TX_BUFFER_SIZE: only the pointer is queued. The buffer must stay
+ * valid and unmodified while ISOTP_TxQueue_ExternalPending() is true.
+ *
+ * @param source Source device type
+ * @param target Target device type
+ * @param message_id Base CAN message ID
+ * @param data Data to transmit (caller-owned)
+ * @param length Data length (1 to ISOTP_EXT_MAX_PAYLOAD bytes)
+ * @return true if enqueued successfully, false if queue full or invalid params
+ */
+bool ISOTP_TxQueue_EnqueueExternal(DiveCANType_t source, DiveCANType_t target,
+                   uint32_t message_id, const uint8_t *data,
+                   uint16_t length);
+
+/**
+ * @brief Check whether any external-buffer message is queued or in flight
+ *
+ * @return true while a buffer passed to ISOTP_TxQueue_EnqueueExternal() may
+ *         still be read by the TX queue
+ */
+bool ISOTP_TxQueue_ExternalPending(void);
+
+/**
+ * @brief Drop every external-buffer message, queued or in flight
+ *
+ * For an owner about to reuse or give up its buffer early. An in-flight
+ * transfer is cut off mid-message (the receiver times it out); copied
+ * messages keep their place in the queue.
+ */
+void ISOTP_TxQueue_AbortExternal(void);
+
 /**
  * @brief Process Flow Control frame for active TX
  *
@@ -61,19 +99,59 @@ bool ISOTP_TxQueue_ProcessFC(const DiveCANMessage_t *fc);
 /**
  * @brief Poll TX queue - sends pending frames and checks timeouts
  *
- * Must be called regularly from the RX thread main loop.
+ * Called from the RX thread main loop, at the latest by the uptime
+ * ISOTP_TxQueue_NextDeadline() reports.
  * Handles:
  * - Starting transmission of next queued message when idle
  * - Timeout detection for Flow Control wait
+ * - The next STmin-paced Consecutive Frame
  *
  * @param currentTime Current time in ms (from k_uptime_get_32)
  */
 void ISOTP_TxQueue_Poll(uint32_t currentTime);
 
+/**
+ * @brief Uptime at which ISOTP_TxQueue_Poll() next has work to do
+ *
+ * While waiting for Flow Control this is the N_Bs timeout; while streaming
+ * Consecutive Frames under a non-zero STmin it is when the next CF is due,
+ * and for a broadcast held up by a full CAN TX FIFO when it tries again.
+ *
+ * @param deadline Set to the uptime (ms) of the next due poll
+ * @return true if a deadline is pending and @p deadline was set; false when
+ *         idle (queued requests are signalled by ISOTP_TxQueue_Msgq())
+ */
+bool ISOTP_TxQueue_NextDeadline(uint32_t *deadline);
+
+/**
+ * @brief Message queue holding requests not yet started
+ *
+ * For k_poll(): data available while the queue is idle means
+ * ISOTP_TxQueue_Poll() has a message to start.
+ *
+ * @return The queue's k_msgq
+ */
+struct k_msgq *ISOTP_TxQueue_Msgq(void);
+
+/**
+ * @brief Hold the TX queue across a check and the enqueue that depends on it
+ *
+ * The lock is recursive, so the holder may still call the enqueue
+ * functions. ISOTP_Send() sets tx_complete inside the same hold as its
+ * enqueue, so a thread holding the queue sees a response either queued and
+ * marked, or neither. Release with ISOTP_TxQueue_Unlock().
+ */
+void ISOTP_TxQueue_Lock(void);
+
+/**
+ * @brief Release a hold taken with ISOTP_TxQueue_Lock()
+ */
+void ISOTP_TxQueue_Unlock(void);
+
 /**
  * @brief Check if TX queue is currently transmitting
  *
- * @return true if multi-frame TX in progress (waiting for FC or sending CFs)
+ * @return true if multi-frame TX in progress (waiting for FC or pacing CFs)
  */
 bool ISOTP_TxQueue_IsBusy(void);
 
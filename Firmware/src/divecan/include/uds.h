@@ -50,6 +50,7 @@ typedef enum {
     UDS_NRC_TRANSFER_DATA_SUSPENDED = 0x71,
     UDS_NRC_GENERAL_PROG_FAIL = 0x72,
     UDS_NRC_WRONG_BLOCK_SEQ_COUNTER = 0x73,
+    UDS_NRC_RESPONSE_PENDING = 0x78,
     UDS_NRC_SUBFUNC_NOT_IN_SESSION = 0x7E,
     UDS_NRC_SERVICE_NOT_IN_SESSION = 0x7F
 } UDS_NRC_t;
@@ -68,13 +69,40 @@ typedef enum {
  */
 #define UDS_S3_TIMEOUT_MS 30000U
 
+/**
+ * @brief ISO 14229-2 P2server: longest a request may wait for a response (ms).
+ */
+#define UDS_P2_SERVER_MS 50U
+
+/**
+ * @brief ISO 14229-2 P2*server: longest a request may wait for a response
+ * after NRC 0x78 responsePending (ms).
+ */
+#define UDS_P2_STAR_SERVER_MS 5000U
+
+/**
+ * @brief Time a request may go unanswered before its first NRC 0x78 (ms).
+ *
+ * Inside P2server, leaving 10 ms for the RX thread to wake and for the frame
+ * to get through the CAN TX FIFO.
+ */
+#define UDS_RESPONSE_PENDING_FIRST_MS 40U
+
+/**
+ * @brief Interval between later NRC 0x78s while the request is served (ms).
+ *
+ * Well inside P2*server, so one late frame does not time the client out.
+ */
+#define UDS_RESPONSE_PENDING_REPEAT_MS 2000U
+
 /* UDS Data Identifiers (DID) - custom for DiveCAN */
 typedef enum {
     UDS_DID_FIRMWARE_VERSION = 0xF000,
     UDS_DID_HARDWARE_VERSION = 0xF001,
     UDS_DID_VARIANT_NAME = 0xF002,
     UDS_DID_SERIAL_NUMBER = 0xF003,
-    UDS_DID_LOG_MESSAGE = 0xA100
+    UDS_DID_LOG_MESSAGE = 0xA100,
+    UDS_DID_LOG_TAIL = 0xA101  /* Pushed: live-tail telemetry records */
 } UDS_DID_t;
 
 /* Max bytes of the build-variant string served by UDS_DID_VARIANT_NAME. Sized
@@ -125,18 +153,18 @@ static const size_t SETTING_LABEL_MAX_LEN = 9U;
 typedef struct {
     uint8_t response_buffer[UDS_MAX_RESPONSE_LENGTH]; /**< Scratch buffer for building responses */
     uint16_t response_length;                         /**< Number of valid bytes in response_buffer */
-    ISOTPContext_t *isotp_context;                    /**< Underlying ISO-TP transport context */
+    ISOTPReply_t *reply;                              /**< Where responses go; tx_complete once one is queued */
     UDS_Session_t session;                           /**< Current diagnostic session (default/programming) */
     uint32_t last_activity_ms;                         /**< Uptime in ms of last UDS request (for S3 timeout) */
 } UDSContext_t;
 
 /**
- * @brief Initialize a UDS context, linking it to an ISO-TP context.
+ * @brief Initialize a UDS context, linking it to its reply addressing.
  *
- * @param ctx      UDS context to initialize
- * @param isotpCtx ISO-TP context to use for response transmission
+ * @param ctx   UDS context to initialize
+ * @param reply Addressing to use for response transmission
  */
-void UDS_Init(UDSContext_t *ctx, ISOTPContext_t *isotpCtx);
+void UDS_Init(UDSContext_t *ctx, ISOTPReply_t *reply);
 
 /**
  * @brief Dispatch an incoming UDS request to the appropriate service handler.
@@ -175,6 +203,27 @@ void UDS_SendNegativeResponse(UDSContext_t *ctx, uint8_t requestedSID,
  */
 void UDS_MaintainSession(UDSContext_t *ctx);
 
+/**
+ * @brief Expire an idle programming session without a request.
+ *
+ * Applies the S3 timeout (and the OTA teardown it implies) between
+ * requests, so an abandoned session lapses on time rather than when the
+ * next request arrives. Does not count as activity.
+ *
+ * @param ctx UDS context
+ * @param now Current uptime (ms)
+ */
+void UDS_PollSession(UDSContext_t *ctx, uint32_t now);
+
+/**
+ * @brief Uptime at which the S3 timeout expires the current session.
+ *
+ * @param ctx      UDS context
+ * @param deadline Set to the expiry uptime (ms) in a programming session
+ * @return true if a programming session is open and @p deadline was set
+ */
+bool UDS_SessionDeadline(const UDSContext_t *ctx, uint32_t *deadline);
+
 /**
  * @brief Test whether the unit is currently in a dive.
  *
@@ -59,6 +59,21 @@ void UDS_LogDownload_HandleRoutine(UDSContext_t *ctx,
  */
 void UDS_LogDownload_FillSelectorResult(uint8_t *buf, size_t buf_size);
 
+/** @brief Length of the LOG_RESUME_TOKEN payload. */
+#define UDS_LOG_RESUME_TOKEN_LEN 28U
+
+/**
+ * @brief Fill `buf` with the LOG_RESUME_TOKEN response payload.
+ *
+ * The token names where the last raw download stood when its latest 0x36
+ * was accepted, and how many body bytes came before that block. It is opaque
+ * to the client, which hands it back to RID 0xF107 to resume the stream.
+ *
+ * @return false when no stream has left a checkpoint (none yet, or the last
+ *         one was compressed, filtered or time-windowed) or `buf` is too small.
+ */
+bool UDS_LogDownload_FillResumeToken(uint8_t *buf, size_t buf_size);
+
 #ifdef CONFIG_ZTEST
 /**
  * @brief Clear the async selector-resolution handshake state.
@@ -75,7 +90,7 @@ void UDS_LogDownload_ResetForTest(void);
  * @brief Periodic tick — aborts a stalled stream and RESUMES the flash-log
  *        writer if a live download goes idle past the inactivity timeout.
  *
- * Must be called from the divecan_rx loop. The writer is paused for the
+ * Called from the UDS worker's housekeeping tick (uds_worker.c). The writer is paused for the
  * duration of a stream (bounded point-in-time capture); because log download
  * runs in the default session there is no session-lapse abort, so this poll is
  * the safety net that guarantees logging resumes if the client vanishes
@@ -11,6 +11,10 @@
  * Log push is always enabled - messages are sent immediately without requiring
  * explicit enable commands.
  *
+ * The same context carries the live tail (flash_log_tail.h): while a client is
+ * subscribed, queued telemetry records go out as WDBI UDS_DID_LOG_TAIL pushes,
+ * taking turns with the text messages so neither starves the other.
+ *
  * @note Requires dedicated ISO-TP context (separate from request/response context)
  */
 
@@ -72,4 +76,16 @@ void UDS_LogPush_SetSuspended(bool suspended);
  */
 void UDS_LogPush_NoteDialogActivity(uint32_t now);
 
+/**
+ * @brief Uptime at which held log messages may be pushed.
+ *
+ * Set while text messages are queued: the end of the quiescent window, or
+ * now when nothing else holds them. The RX thread wakes for them instead of
+ * waiting for unrelated traffic.
+ *
+ * @param deadline Set to the uptime (ms) the next push is possible
+ * @return true if messages are queued and @p deadline was set
+ */
+bool UDS_LogPush_NextDeadline(uint32_t *deadline);
+
 #endif /* UDS_LOG_PUSH_H */
@@ -42,4 +42,14 @@ void UDS_OTA_Handle(UDSContext_t *ctx, const uint8_t *request_data,
  */
 void UDS_OTA_Reset(void);
 
+#ifdef CONFIG_ZTEST
+/**
+ * @brief Block until the slot1 writer has programmed every queued 0x36 block.
+ *
+ * Test-only. 0x36 acknowledges a block once it is staged, so a test that
+ * inspects the flash writes must wait for the writer first.
+ */
+void UDS_OTA_DrainWriterForTest(void);
+#endif
+
 #endif /* UDS_OTA_H */
@@ -30,6 +30,11 @@
 #define UDS_DID_INTEGRAL_STATE      0xF211U  /**< float32: PID integral accumulator */
 #define UDS_DID_SATURATION_COUNT    0xF212U  /**< uint16: PID saturation events */
 #define UDS_DID_AUTOTUNE_STATUS     0xF213U  /**< 66 B: PID autotune status (see uds_state_did.c) */
+#define UDS_DID_SAMPLE_TO_CONSENSUS 0xF214U  /**< uint32: last PID input, cell sample → consensus vote (µs) */
+#define UDS_DID_SAMPLE_TO_CONTROL   0xF215U  /**< uint32: last PID input, cell sample → PID update (µs) */
+#define UDS_DID_LATENCY_TRACE       0xF216U  /**< 82 B: version, stage count, per-stage count/min/p50/p99/max µs (latency_trace.h) */
+#define UDS_DID_LATENCY_TRACE_CLEAR 0xF217U  /**< write-only: any value clears the latency histograms */
+#define UDS_DID_PLANT_ESTIMATE      0xF218U  /**< 33 B: background plant estimate (see uds_state_did.c) */
 #define UDS_DID_UPTIME_SEC          0xF220U  /**< uint32: Seconds since boot */
 
 /* Power Monitoring DIDs (0xF23x) */
@@ -86,6 +91,12 @@
 #define UDS_DID_LOG_ERASE             0xF282U  /**< write-only, 2 B: stream_mask u8 + magic 0xA5; gated to programming + !in_dive */
 #define UDS_DID_LOG_VERBOSITY         0xF283U  /**< RW, 1 B: text-FCB min level (1=ERR..4=DBG), persisted to NVS */
 #define UDS_DID_LOG_CAN_VERBOSE       0xF284U  /**< RW, 1 B: CAN-capture bitmask (bit0=RX, bit1=TX), persisted to NVS */
+#define UDS_DID_LOG_RESUME_TOKEN      0xF285U  /**< 28 B: opaque checkpoint of the last raw download, fed back to RID 0xF107 */
+
+/* Transport DIDs (0xF29x) — see isotp_link.h */
+#define UDS_DID_ISOTP_LINK_STATS      0xF290U  /**< 2 + N*24 B: per-peer ISO-TP flow level, frames/s and fault counters */
+#define UDS_DID_I2C1_BUS_STATS        0xF291U  /**< 104 B: version, client count, per-client i2c1 transfers/occupancy/wait (i2c1_sched.h) */
+#define UDS_DID_CAN_TX_STATS          0xF292U  /**< 30 B: CAN TX FIFO depth/high-water, frame and error counts, bus load (divecan_counters.h) */
 
 /* ============================================================================
  * Cell DIDs (0xF4Nx where N = cell number 0-2)
@@ -107,10 +118,11 @@
 #define CELL_DID_AMBIENT_LIGHT_UV   0x0AU
 #define CELL_DID_AMBIENT_PRESSURE_UBAR 0x0BU
 #define CELL_DID_HOUSING_HUMIDITY_MPERCENT_RH 0x0CU
-/* Highest READABLE cell offset; CELL_DID_BROADCAST below is write-only and is
- * handled by the WDBI dispatcher, not the read path. */
-#define CELL_DID_MAX_OFFSET         0x0CU
 #define CELL_DID_BROADCAST          0x0DU  /**< write-only, 1 B: 0=stop, nonzero=start this cell's UART broadcast (sends #BCST) */
+#define CELL_DID_FILTER_STATS       0x0EU  /**< analog only, 32 B: filter shape, noise and group delay */
+/* Highest READABLE cell offset. CELL_DID_BROADCAST sits below it but is
+ * write-only: no read handler claims it, so a read of it gets an NRC. */
+#define CELL_DID_MAX_OFFSET         0x0EU
 
 /**
  * @brief Check whether a DID falls within the state-DID ranges handled by this module.
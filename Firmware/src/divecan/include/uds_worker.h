@@ -0,0 +1,70 @@
+/**
+ * @file uds_worker.h
+ * @brief UDS request execution off the DiveCAN RX thread
+ *
+ * The RX thread reassembles requests and hands each completed one to a
+ * dedicated work queue, which runs UDS_ProcessRequest() and every handler
+ * behind it (settings saves, OTA flash writes, DID reads that wait on zbus).
+ * Pings, setpoints, cal requests and atmos frames therefore never wait
+ * behind a diagnostic client.
+ *
+ * One request is served at a time. A request that completes while another
+ * is still being served is answered NRC 0x21 busyRepeatRequest by the RX
+ * thread; one still unanswered after UDS_RESPONSE_PENDING_FIRST_MS (inside
+ * P2server) gets NRC 0x78 responsePending, repeated every
+ * UDS_RESPONSE_PENDING_REPEAT_MS (inside P2*server) until its response is
+ * queued.
+ *
+ * The worker owns the UDS context: its session, response buffer, the S3
+ * timeout and the log-download inactivity check all run on the worker.
+ */
+
+#ifndef UDS_WORKER_H
+#define UDS_WORKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "isotp.h"
+
+/**
+ * @brief Start the worker queue and initialise its UDS context.
+ *
+ * Call once from the RX thread before the first UDS_Worker_Submit().
+ */
+void UDS_Worker_Init(void);
+
+/**
+ * @brief Hand a completed request to the worker (RX thread).
+ *
+ * The worker serves a snapshot of @p dialog, so the RX thread may reuse the
+ * dialog context, and replies keep the requester's addressing even if the
+ * context is retargeted meanwhile. While a request is being served the new
+ * one is refused with NRC 0x21 instead.
+ *
+ * @param dialog Dialog ISO-TP context with rx_complete set
+ * @param now    Current uptime (ms)
+ * @return true if the worker took the request
+ */
+bool UDS_Worker_Submit(const ISOTPContext_t *dialog, uint32_t now);
+
+/**
+ * @brief Send NRC 0x78 for a slow request when due (RX thread).
+ *
+ * @param now Current uptime (ms)
+ */
+void UDS_Worker_Poll(uint32_t now);
+
+/**
+ * @brief Uptime at which the next responsePending is due.
+ *
+ * @param deadline Set to the due uptime (ms) while a request is unanswered
+ * @return true if a request is being served and has no response yet
+ */
+bool UDS_Worker_NextDeadline(uint32_t *deadline);
+
+/**
+ * @brief Whether the worker holds a request.
+ */
+bool UDS_Worker_IsBusy(void);
+
+#endif /* UDS_WORKER_H */
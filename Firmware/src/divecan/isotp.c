@@ -13,6 +13,7 @@
 
 #include "isotp.h"
 #include "isotp_tx_queue.h"
+#include "isotp_link.h"
 #include "divecan_tx.h"
 #include "errors.h"
 
@@ -80,6 +81,7 @@ static void isotp_idle_entry(void *obj)
     ctx->rx_bytes_received = 0;
     ctx->rx_sequence_number = 0;
     ctx->rx_last_frame_time = 0;
+    ctx->rx_block_counter = 0;
 }
 
 /**
@@ -129,6 +131,7 @@ static enum smf_state_result isotp_receiving_run(void *obj)
         (void)HandleFirstFrame(ctx, ctx->current_message);
     } else if (ISOTP_RX_EVT_TIMEOUT == ctx->current_event) {
         OP_ERROR_DETAIL(OP_ERR_ISOTP_TIMEOUT, (uint32_t)ctx->state);
+        ISOTP_Link_NoteFault((uint8_t)ctx->target, ISOTP_LINK_FAULT_RX_TIMEOUT);
         ISOTP_Reset(ctx);
     } else {
         /* NONE: no action. */
@@ -269,6 +272,7 @@ bool ISOTP_ProcessRxFrame(ISOTPContext_t *ctx, const DiveCANMessage_t *message)
                 if (ISOTP_RX_EVT_NONE == ev) {
                     OP_ERROR_DETAIL(OP_ERR_ISOTP_STATE, pci);
                 } else {
+                    ISOTP_Link_NoteFrame(msgSource);
                     ctx->current_event = ev;
                     ctx->current_message = message;
                     ctx->current_consumed = false;
@@ -362,8 +366,11 @@ static bool HandleFirstFrame(ISOTPContext_t *ctx, const DiveCANMessage_t *messag
         /* Update timestamp */
         ctx->rx_last_frame_time = k_uptime_get_32();
 
-        /* Send Flow Control (CTS, BS=0, STmin=0) */
-        SendFlowControl(ctx, ISOTP_FC_CTS, ISOTP_DEFAULT_BLOCK_SIZE, ISOTP_DEFAULT_STMIN);
+        /* Send Flow Control (CTS) with the pacing this peer's link sustains:
+         * BS=0/STmin=0 on a clean link, slower after dropped frames. */
+        ISOTP_Link_FlowParams((uint8_t)ctx->target, &ctx->rx_block_size, &ctx->rx_stmin);
+        ctx->rx_block_counter = 0;
+        SendFlowControl(ctx, ISOTP_FC_CTS, ctx->rx_block_size, ctx->rx_stmin);
 
         /* Transition to RECEIVING (entry stamps ctx->state). */
         smf_set_state(SMF_CTX(ctx), &isotp_states[ISOTP_RECEIVING]);
@@ -395,6 +402,7 @@ static bool HandleConsecutiveFrame(ISOTPContext_t *ctx, const DiveCANMessage_t *
     if (seqNum != ctx->rx_sequence_number) {
         /* Sequence error - abort reception */
         OP_ERROR_DETAIL(OP_ERR_ISOTP_SEQ, (uint8_t)((ctx->rx_sequence_number << DIVECAN_HALF_BYTE_WIDTH) | seqNum));
+        ISOTP_Link_NoteFault((uint8_t)ctx->target, ISOTP_LINK_FAULT_RX_SEQUENCE);
         ISOTP_Reset(ctx);
     } else {
         /* Calculate bytes to copy (7 bytes or remaining) */
@@ -421,7 +429,17 @@ static bool HandleConsecutiveFrame(ISOTPContext_t *ctx, const DiveCANMessage_t *
             /* Set completion flag, then return to IDLE. IDLE.entry
              * preserves rx_data_length because rx_complete is set. */
             ctx->rx_complete = true;
+            ISOTP_Link_NoteTransfer((uint8_t)ctx->target, true);
             ISOTP_Reset(ctx);
+        } else if (ctx->rx_block_size != 0U) {
+            /* End of an advertised block: clear the sender for the next. */
+            ++ctx->rx_block_counter;
+            if (ctx->rx_block_counter >= ctx->rx_block_size) {
+                ctx->rx_block_counter = 0;
+                SendFlowControl(ctx, ISOTP_FC_CTS, ctx->rx_block_size, ctx->rx_stmin);
+            }
+        } else {
+            /* BS=0: the sender streams to the end without another FC. */
         }
     }
 
@@ -436,6 +454,9 @@ static bool HandleConsecutiveFrame(ISOTPContext_t *ctx, const DiveCANMessage_t *
  * @param flowStatus FC status byte: ISOTP_FC_CTS (0x30), ISOTP_FC_WAIT (0x31), or ISOTP_FC_OVFLW (0x32)
  * @param blockSize  Maximum number of consecutive frames before next FC (0 = unlimited)
  * @param stmin      Minimum separation time between consecutive frames (ms, 0-127)
+ *
+ * Sent after a First Frame and, when blockSize is non-zero, again after every
+ * blockSize Consecutive Frames.
  */
 static void SendFlowControl(const ISOTPContext_t *ctx, uint8_t flowStatus,
                  uint8_t blockSize, uint8_t stmin)
@@ -449,16 +470,60 @@ static void SendFlowControl(const ISOTPContext_t *ctx, uint8_t flowStatus,
     fc.data[ISOTP_FC_BS_IDX] = blockSize;
     fc.data[ISOTP_FC_STMIN_IDX] = stmin;
 
+    ISOTP_Link_NoteFrame((uint8_t)ctx->target);
     (void)divecan_send(&fc);
 }
 
+/**
+ * @brief Queue @p data and mark @p tx_complete inside one TX queue hold.
+ *
+ * Holding the queue across both lets a caller that checks tx_complete under
+ * the same hold (the UDS worker's responsePending) know the answer is final.
+ *
+ * @param source     Our device type
+ * @param target     Remote device type
+ * @param message_id Base CAN ID
+ * @param data       Payload, copied unless @p external
+ * @param length     Payload length, already validated by the caller
+ * @param external   Queue a pointer to @p data instead of a copy
+ * @param tx_complete Set once the message is queued
+ * @return true if queued
+ */
+static bool isotp_enqueue(DiveCANType_t source, DiveCANType_t target,
+              uint32_t message_id, const uint8_t *data,
+              uint16_t length, bool external, bool *tx_complete)
+{
+    bool result = false;
+
+    /* Enqueue to centralized TX queue instead of direct send. This ensures
+     * all ISO-TP messages are serialized. Broadcast transfers (target 0xFF,
+     * e.g. log-push) are sent fire-and-forget by the queue so they never
+     * stall an addressed reply. */
+    ISOTP_TxQueue_Lock();
+    if (external) {
+        result = ISOTP_TxQueue_EnqueueExternal(source, target, message_id,
+                               data, length);
+    } else {
+        result = ISOTP_TxQueue_Enqueue(source, target, message_id, data,
+                           length);
+    }
+    if (result) {
+        /* Set completion flag - message is queued and will be sent in order */
+        *tx_complete = true;
+    }
+    ISOTP_TxQueue_Unlock();
+
+    return result;
+}
+
 /**
  * @brief Send data via ISO-TP
  *
  * Uses the centralized TX queue to ensure serialized transmission,
  * preventing interleaving when multiple ISO-TP contexts are active.
  *
- * Note: tx_complete is set immediately on successful queue. Callers that need
+ * Note: tx_complete is set immediately on successful queue, inside the same
+ * TX queue hold as the enqueue (see ISOTP_TxQueue_Lock()). Callers that need
  * to wait for actual transmission should check ISOTP_TxQueue_IsBusy() before
  * sending subsequent messages.
  *
@@ -478,17 +543,83 @@ bool ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *data, uint16_t length)
     else if ((0 == length) || (length > ISOTP_MAX_PAYLOAD)) {
         OP_ERROR_DETAIL(OP_ERR_ISOTP_OVERFLOW, length);
     } else {
-        /* Enqueue to centralized TX queue instead of direct send.
-         * This ensures all ISO-TP messages are serialized. Broadcast
-         * transfers (target 0xFF, e.g. log-push) are sent fire-and-forget by
-         * the queue so they never stall an addressed reply. */
-        result = ISOTP_TxQueue_Enqueue(ctx->source, ctx->target,
-                           ctx->message_id, data, length);
-
-        if (result) {
-            /* Set completion flag - message is queued and will be sent in order */
-            ctx->tx_complete = true;
-        }
+        result = isotp_enqueue(ctx->source, ctx->target, ctx->message_id,
+                       data, length, false, &ctx->tx_complete);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Queue an extended-length message sent straight from the caller's buffer
+ *
+ * Same as ISOTP_Send() except that the TX queue keeps only a pointer, so
+ * @p length may reach ISOTP_EXT_MAX_PAYLOAD (the 12-bit FF length limit).
+ *
+ * @param ctx    ISO-TP context providing addressing for the transmission (must not be NULL)
+ * @param data   Payload to send; must stay unmodified while ISOTP_TxQueue_ExternalPending()
+ * @param length Payload length in bytes (1 to ISOTP_EXT_MAX_PAYLOAD)
+ * @return true if message was successfully enqueued, false on NULL pointer or invalid length
+ */
+bool ISOTP_SendExternal(ISOTPContext_t *ctx, const uint8_t *data, uint16_t length)
+{
+    bool result = false;
+
+    if ((NULL == ctx) || (NULL == data)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if ((0 == length) || (length > ISOTP_EXT_MAX_PAYLOAD)) {
+        OP_ERROR_DETAIL(OP_ERR_ISOTP_OVERFLOW, length);
+    } else {
+        result = isotp_enqueue(ctx->source, ctx->target, ctx->message_id,
+                       data, length, true, &ctx->tx_complete);
+    }
+
+    return result;
+}
+
+/**
+ * @brief ISOTP_Send() to the peer recorded in @p to.
+ *
+ * @param to     Reply addressing; its tx_complete is set once queued (must not be NULL)
+ * @param data   Payload to send (must not be NULL)
+ * @param length Payload length in bytes (1 to ISOTP_MAX_PAYLOAD)
+ * @return true if message was successfully enqueued, false on NULL pointer or invalid length
+ */
+bool ISOTP_Reply(ISOTPReply_t *to, const uint8_t *data, uint16_t length)
+{
+    bool result = false;
+
+    if ((NULL == to) || (NULL == data)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if ((0 == length) || (length > ISOTP_MAX_PAYLOAD)) {
+        OP_ERROR_DETAIL(OP_ERR_ISOTP_OVERFLOW, length);
+    } else {
+        result = isotp_enqueue(to->source, to->target, to->message_id,
+                       data, length, false, &to->tx_complete);
+    }
+
+    return result;
+}
+
+/**
+ * @brief ISOTP_SendExternal() to the peer recorded in @p to.
+ *
+ * @param to     Reply addressing; its tx_complete is set once queued (must not be NULL)
+ * @param data   Payload to send; must stay unmodified while ISOTP_TxQueue_ExternalPending()
+ * @param length Payload length in bytes (1 to ISOTP_EXT_MAX_PAYLOAD)
+ * @return true if message was successfully enqueued, false on NULL pointer or invalid length
+ */
+bool ISOTP_ReplyExternal(ISOTPReply_t *to, const uint8_t *data, uint16_t length)
+{
+    bool result = false;
+
+    if ((NULL == to) || (NULL == data)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if ((0 == length) || (length > ISOTP_EXT_MAX_PAYLOAD)) {
+        OP_ERROR_DETAIL(OP_ERR_ISOTP_OVERFLOW, length);
+    } else {
+        result = isotp_enqueue(to->source, to->target, to->message_id,
+                       data, length, true, &to->tx_complete);
     }
 
     return result;
@@ -521,3 +652,27 @@ void ISOTP_Poll(ISOTPContext_t *ctx, uint32_t currentTime)
         }
     }
 }
+
+/**
+ * @brief Report when the pending N_Cr timeout expires
+ *
+ * @param ctx      ISO-TP context to check (must not be NULL)
+ * @param deadline Receives the expiry uptime (ms) when one is armed
+ * @return true while a reception is in progress
+ */
+bool ISOTP_NextDeadline(const ISOTPContext_t *ctx, uint32_t *deadline)
+{
+    bool pending = false;
+
+    if ((NULL == ctx) || (NULL == deadline)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (ISOTP_RECEIVING == ctx->state) {
+        /* ISOTP_Poll() fires once the gap EXCEEDS N_Cr. */
+        *deadline = ctx->rx_last_frame_time + (uint32_t)ISOTP_TIMEOUT_N_CR + 1U;
+        pending = true;
+    } else {
+        /* Idle or transmitting: no RX timeout armed */
+    }
+
+    return pending;
+}
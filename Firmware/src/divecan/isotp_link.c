@@ -0,0 +1,351 @@
+/**
+ * @file isotp_link.c
+ * @brief Per-peer ISO-TP link quality and adaptive flow parameters
+ *
+ * See isotp_link.h for the ladder and the fault/promotion rules. The peer
+ * table is tiny (a handful of nodes ever talk UDS to the head) and lives in
+ * static storage; an unknown peer takes a free slot or recycles the one that
+ * has been quiet longest.
+ *
+ * The RX thread records frames, transfers and faults and reads the flow
+ * parameters; the UDS worker reads the block limit and the DID 0xF290 stats
+ * (which also roll the rate windows). Every entry point therefore holds
+ * link_lock while it touches the table.
+ *
+ * @note Static allocation only (NASA Rule 10 compliance)
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "isotp_link.h"
+#include "errors.h"
+#include "common.h"
+
+LOG_MODULE_REGISTER(isotp_link, LOG_LEVEL_INF);
+
+/** @brief One rung of the flow-parameter ladder. */
+typedef struct {
+    uint8_t  block_size; /**< BS advertised in our FC */
+    uint8_t  stmin;      /**< STmin advertised in our FC (ms) */
+    uint16_t block;      /**< 0x36 block cap (UINT16_MAX = service default) */
+} IsotpLinkLevel_t;
+
+/* Slowest first; peers start on the last (fastest) rung. */
+static const IsotpLinkLevel_t LINK_LEVELS[ISOTP_LINK_LEVELS] = {
+    {4U, 5U, 64U},
+    {8U, 2U, 128U},
+    {16U, 1U, 192U},
+    {ISOTP_DEFAULT_BLOCK_SIZE, ISOTP_DEFAULT_STMIN, UINT16_MAX},
+};
+
+static const uint8_t LINK_TOP_LEVEL = (uint8_t)(ISOTP_LINK_LEVELS - 1U);
+
+/* Field offsets within one DID 0xF290 peer record (see isotp_link.h). */
+static const size_t STAT_PEER_IDX      = 0U;
+static const size_t STAT_LEVEL_IDX     = 1U;
+static const size_t STAT_BS_IDX        = 2U;
+static const size_t STAT_STMIN_IDX     = 3U;
+static const size_t STAT_BLOCK_OFF     = 4U;
+static const size_t STAT_RATE_OFF      = 6U;
+static const size_t STAT_FRAMES_OFF    = 8U;
+static const size_t STAT_RX_XFER_OFF   = 12U;
+static const size_t STAT_RX_TMO_OFF    = 14U;
+static const size_t STAT_RX_SEQ_OFF    = 16U;
+static const size_t STAT_TX_XFER_OFF   = 18U;
+static const size_t STAT_TX_TMO_OFF    = 20U;
+static const size_t STAT_TX_REFUSE_OFF = 22U;
+
+/** @brief Link statistics for one peer. */
+typedef struct {
+    bool     in_use;
+    uint8_t  peer;            /**< DiveCAN address of the remote node */
+    uint8_t  level;           /**< Index into LINK_LEVELS */
+    uint8_t  clean_streak;    /**< Clean transfers since the last step */
+    uint16_t frames_per_s;    /**< Rate over the last closed window */
+    uint16_t window_frames;   /**< Frames in the open window */
+    uint32_t window_start_ms; /**< Uptime the open window started */
+    uint32_t last_seen_ms;    /**< Uptime of the last frame (slot recycling) */
+    uint32_t frames;          /**< Frames in both directions */
+    uint16_t rx_transfers;
+    uint16_t rx_timeouts;
+    uint16_t rx_seq_errors;
+    uint16_t tx_transfers;
+    uint16_t tx_timeouts;
+    uint16_t tx_refusals;
+} IsotpLinkPeer_t;
+
+/* Guards the peer table between the RX thread and the UDS worker. */
+static struct k_spinlock link_lock;
+
+/**
+ * @brief Accessor for the peer table singleton.
+ */
+static IsotpLinkPeer_t *getLinkPeers(void)
+{
+    static IsotpLinkPeer_t peers[ISOTP_LINK_PEER_SLOTS] = {0};
+    return peers;
+}
+
+/**
+ * @brief Saturating increment for the 16-bit counters.
+ */
+static void bumpCounter(uint16_t *counter)
+{
+    if (*counter < UINT16_MAX) {
+        ++(*counter);
+    }
+}
+
+/**
+ * @brief Find the slot tracking @p peer.
+ *
+ * @return The slot, or NULL when the peer has never been seen
+ */
+static IsotpLinkPeer_t *findPeer(uint8_t peer)
+{
+    IsotpLinkPeer_t *peers = getLinkPeers();
+    IsotpLinkPeer_t *found = NULL;
+
+    for (size_t i = 0U; (i < ISOTP_LINK_PEER_SLOTS) && (NULL == found); ++i) {
+        if (peers[i].in_use && (peers[i].peer == peer)) {
+            found = &peers[i];
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Find or create the slot for @p peer.
+ *
+ * A new peer takes a free slot, else the one with the oldest last frame.
+ */
+static IsotpLinkPeer_t *claimPeer(uint8_t peer, uint32_t now)
+{
+    IsotpLinkPeer_t *slot = findPeer(peer);
+
+    if (NULL == slot) {
+        IsotpLinkPeer_t *peers = getLinkPeers();
+        bool freeSlot = false;
+        slot = &peers[0];
+        for (size_t i = 0U; (i < ISOTP_LINK_PEER_SLOTS) && (!freeSlot); ++i) {
+            if (!peers[i].in_use) {
+                slot = &peers[i];
+                freeSlot = true;
+            } else if ((now - peers[i].last_seen_ms) > (now - slot->last_seen_ms)) {
+                slot = &peers[i];
+            } else {
+                /* No action required */
+            }
+        }
+        (void)memset(slot, 0, sizeof(*slot));
+        slot->in_use = true;
+        slot->peer = peer;
+        slot->level = LINK_TOP_LEVEL;
+        slot->window_start_ms = now;
+        slot->last_seen_ms = now;
+    }
+    return slot;
+}
+
+/**
+ * @brief Close the frames/s window once it has run its length.
+ *
+ * A window left open across an idle gap of more than one extra window length
+ * reports 0 rather than averaging the burst over the silence.
+ */
+static void rollWindow(IsotpLinkPeer_t *p, uint32_t now)
+{
+    uint32_t elapsed = now - p->window_start_ms;
+
+    if (elapsed >= (2U * ISOTP_LINK_WINDOW_MS)) {
+        p->frames_per_s = 0U;
+        p->window_frames = 0U;
+        p->window_start_ms = now;
+    } else if (elapsed >= ISOTP_LINK_WINDOW_MS) {
+        uint32_t rate = ((uint32_t)p->window_frames * ISOTP_LINK_WINDOW_MS) / elapsed;
+        p->frames_per_s = (rate > UINT16_MAX) ? UINT16_MAX : (uint16_t)rate;
+        p->window_frames = 0U;
+        p->window_start_ms = now;
+    } else {
+        /* No action required */
+    }
+}
+
+/** @brief Store @p value little-endian at @p buf. */
+static void putLe16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = (uint8_t)(value & BYTE_MASK);
+    buf[1] = (uint8_t)((value >> BYTE_WIDTH) & BYTE_MASK);
+}
+
+/** @brief Store @p value little-endian at @p buf. */
+static void putLe32(uint8_t *buf, uint32_t value)
+{
+    putLe16(buf, (uint16_t)(value & UINT16_MAX));
+    putLe16(&buf[sizeof(uint16_t)], (uint16_t)(value >> TWO_BYTE_WIDTH));
+}
+
+void ISOTP_Link_Init(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&link_lock);
+
+    (void)memset(getLinkPeers(), 0, sizeof(IsotpLinkPeer_t) * ISOTP_LINK_PEER_SLOTS);
+    k_spin_unlock(&link_lock, key);
+}
+
+void ISOTP_Link_NoteFrame(uint8_t peer)
+{
+    uint32_t now = k_uptime_get_32();
+    k_spinlock_key_t key = k_spin_lock(&link_lock);
+    IsotpLinkPeer_t *p = claimPeer(peer, now);
+
+    rollWindow(p, now);
+    if (p->window_frames < UINT16_MAX) {
+        ++p->window_frames;
+    }
+    if (p->frames < UINT32_MAX) {
+        ++p->frames;
+    }
+    p->last_seen_ms = now;
+    k_spin_unlock(&link_lock, key);
+}
+
+void ISOTP_Link_NoteTransfer(uint8_t peer, bool rx)
+{
+    uint32_t now = k_uptime_get_32();
+    k_spinlock_key_t key = k_spin_lock(&link_lock);
+    IsotpLinkPeer_t *p = claimPeer(peer, now);
+
+    if (rx) {
+        bumpCounter(&p->rx_transfers);
+    } else {
+        bumpCounter(&p->tx_transfers);
+    }
+
+    if (p->level < LINK_TOP_LEVEL) {
+        ++p->clean_streak;
+        if (p->clean_streak >= ISOTP_LINK_PROMOTE_STREAK) {
+            ++p->level;
+            p->clean_streak = 0U;
+        }
+    }
+    k_spin_unlock(&link_lock, key);
+}
+
+void ISOTP_Link_NoteFault(uint8_t peer, IsotpLinkFault_e fault)
+{
+    uint32_t now = k_uptime_get_32();
+    bool known = true;
+    k_spinlock_key_t key = k_spin_lock(&link_lock);
+    IsotpLinkPeer_t *p = claimPeer(peer, now);
+
+    switch (fault) {
+    case ISOTP_LINK_FAULT_RX_TIMEOUT:
+        bumpCounter(&p->rx_timeouts);
+        break;
+    case ISOTP_LINK_FAULT_RX_SEQUENCE:
+        bumpCounter(&p->rx_seq_errors);
+        break;
+    case ISOTP_LINK_FAULT_TX_TIMEOUT:
+        bumpCounter(&p->tx_timeouts);
+        break;
+    case ISOTP_LINK_FAULT_TX_REFUSED:
+        bumpCounter(&p->tx_refusals);
+        break;
+    default:
+        known = false;
+        break;
+    }
+
+    if (p->level > 0U) {
+        --p->level;
+    }
+    p->clean_streak = 0U;
+    k_spin_unlock(&link_lock, key);
+
+    /* Reported outside the lock: the error path publishes on zbus. */
+    if (!known) {
+        OP_ERROR_DETAIL(OP_ERR_ISOTP_STATE, (uint32_t)fault);
+    }
+}
+
+void ISOTP_Link_FlowParams(uint8_t peer, uint8_t *blockSize, uint8_t *stmin)
+{
+    k_spinlock_key_t key = k_spin_lock(&link_lock);
+    const IsotpLinkPeer_t *p = findPeer(peer);
+    uint8_t level = (NULL == p) ? LINK_TOP_LEVEL : p->level;
+
+    k_spin_unlock(&link_lock, key);
+
+    if ((NULL == blockSize) || (NULL == stmin)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else {
+        *blockSize = LINK_LEVELS[level].block_size;
+        *stmin = LINK_LEVELS[level].stmin;
+    }
+}
+
+uint16_t ISOTP_Link_BlockLimit(const ISOTPReply_t *to, uint16_t full)
+{
+    uint16_t limit = full;
+
+    if (NULL != to) {
+        k_spinlock_key_t key = k_spin_lock(&link_lock);
+        const IsotpLinkPeer_t *p = findPeer((uint8_t)to->target);
+        if ((NULL != p) && (LINK_LEVELS[p->level].block < full)) {
+            limit = LINK_LEVELS[p->level].block;
+        }
+        k_spin_unlock(&link_lock, key);
+    }
+    return limit;
+}
+
+uint16_t ISOTP_Link_FillStats(uint8_t *buf, uint16_t size)
+{
+    uint16_t written = 0U;
+
+    if (NULL == buf) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (size < ISOTP_LINK_STATS_MAX_LEN) {
+        /* Expected: caller bundled this DID with others and ran short */
+    } else {
+        IsotpLinkPeer_t *peers = getLinkPeers();
+        uint32_t now = k_uptime_get_32();
+        uint8_t count = 0U;
+        uint8_t *rec = &buf[ISOTP_LINK_STATS_HDR_LEN];
+        k_spinlock_key_t key = k_spin_lock(&link_lock);
+
+        for (size_t i = 0U; i < ISOTP_LINK_PEER_SLOTS; ++i) {
+            IsotpLinkPeer_t *p = &peers[i];
+            if (p->in_use) {
+                const IsotpLinkLevel_t *lvl = &LINK_LEVELS[p->level];
+
+                /* Let an idle link's rate decay to 0 instead of freezing. */
+                rollWindow(p, now);
+                rec[STAT_PEER_IDX] = p->peer;
+                rec[STAT_LEVEL_IDX] = p->level;
+                rec[STAT_BS_IDX] = lvl->block_size;
+                rec[STAT_STMIN_IDX] = lvl->stmin;
+                putLe16(&rec[STAT_BLOCK_OFF], lvl->block);
+                putLe16(&rec[STAT_RATE_OFF], p->frames_per_s);
+                putLe32(&rec[STAT_FRAMES_OFF], p->frames);
+                putLe16(&rec[STAT_RX_XFER_OFF], p->rx_transfers);
+                putLe16(&rec[STAT_RX_TMO_OFF], p->rx_timeouts);
+                putLe16(&rec[STAT_RX_SEQ_OFF], p->rx_seq_errors);
+                putLe16(&rec[STAT_TX_XFER_OFF], p->tx_transfers);
+                putLe16(&rec[STAT_TX_TMO_OFF], p->tx_timeouts);
+                putLe16(&rec[STAT_TX_REFUSE_OFF], p->tx_refusals);
+                rec = &rec[ISOTP_LINK_STATS_PEER_LEN];
+                ++count;
+            }
+        }
+        k_spin_unlock(&link_lock, key);
+        buf[0] = ISOTP_LINK_STATS_VERSION;
+        buf[1] = count;
+        written = (uint16_t)(ISOTP_LINK_STATS_HDR_LEN +
+                     ((uint16_t)count * ISOTP_LINK_STATS_PEER_LEN));
+    }
+    return written;
+}
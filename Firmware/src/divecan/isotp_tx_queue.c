@@ -15,6 +15,24 @@
  *                      next block boundary (stay) or to payload exhaustion
  *                      (back to IDLE). FC_WAIT/FC_OVFLW -> abort to IDLE.
  *                      A TICK while in WAIT_FC checks the N_Bs timeout.
+ *   TX_STATE_SEND_CF - FC_CTS asked for a non-zero STmin; one CF goes out
+ *                      per TICK once STmin has elapsed since the last, so
+ *                      the RX thread never sleeps between CFs. A broadcast
+ *                      whose CFs found the CAN TX FIFO full waits here too,
+ *                      and retries every ISOTP_BROADCAST_RETRY_MS.
+ *                      ISOTP_TxQueue_NextDeadline() tells it when to tick.
+ *
+ * Frames sent, completed transfers and FC faults are reported per peer to
+ * isotp_link.c, which tunes the pacing this node asks for in return.
+ *
+ * The RX thread drives the queue (Poll, ProcessFC); the UDS worker
+ * (uds_worker.c) enqueues its responses from its own thread, so every entry
+ * point that touches the state machine or the scratch request buffer holds
+ * isotp_tx_lock.
+ *
+ * Most requests are copied into the queue. An extended-length request
+ * (ISOTP_TxQueue_EnqueueExternal) only queues a pointer to its owner's
+ * buffer; external_pending counts those until each is sent or dropped.
  *
  * @note Static allocation only (NASA Rule 10 compliance)
  * @note Uses Zephyr k_msgq for thread-safe queuing
@@ -27,6 +45,7 @@
 
 #include "isotp_tx_queue.h"
 #include "isotp.h"
+#include "isotp_link.h"
 #include "divecan_tx.h"
 #include "errors.h"
 #include "common.h"
@@ -45,6 +64,10 @@ static const size_t DIVECAN_FF_PAD_IDX = 2U;    /**< FF padding byte position */
 static const size_t DIVECAN_FF_DATA_START = 3U; /**< FF data start position (after padding) */
 static const size_t DIVECAN_PAD_BYTE_SIZE = 1U; /**< Size of DiveCAN padding byte */
 
+/** Retry period (ms) of a broadcast whose CF found the CAN TX FIFO full:
+ *  about one frame time at 125 kbit/s, so a slot has freed by then. */
+static const uint32_t ISOTP_BROADCAST_RETRY_MS = 1U;
+
 /* Error detail code for RX abort (FC OVFLW or WAIT received) */
 #define ISOTP_RX_ABORT_ERR OP_ERR_ISOTP_STATE
 
@@ -53,6 +76,7 @@ static const size_t DIVECAN_PAD_BYTE_SIZE = 1U; /**< Size of DiveCAN padding byt
  */
 typedef struct {
     uint8_t data[ISOTP_TX_BUFFER_SIZE]; /**< Copy of data to transmit */
+    const uint8_t *external;            /**< Caller-owned payload (NULL = data) */
     uint16_t length;                    /**< Data length */
     DiveCANType_t source;               /**< Source address */
     DiveCANType_t target;               /**< Target address */
@@ -64,6 +88,7 @@ typedef struct {
 typedef enum {
     TX_STATE_IDLE = 0,    /**< No active TX; ready to dequeue */
     TX_STATE_WAIT_FC,     /**< FF sent (or block boundary); awaiting FC */
+    TX_STATE_SEND_CF,     /**< Streaming CFs paced by STmin or FIFO room */
     TX_STATE_COUNT,
 } TxState_e;
 
@@ -75,6 +100,13 @@ typedef enum {
     TX_EVT_FC_OVFLW,      /**< Flow Control: Overflow (receiver rejected) */
 } TxEvent_e;
 
+/** Where a run of send_consecutive_frames() stopped. */
+typedef enum {
+    TX_CF_DONE = 0,       /**< Payload exhausted */
+    TX_CF_BLOCK_END,      /**< Block size reached; next FC needed */
+    TX_CF_PACED,          /**< STmin (or FIFO room) needed before the next CF */
+} TxCfResult_e;
+
 typedef struct {
     struct smf_ctx          smf;
     ISOTPTxRequest_t        current;
@@ -84,8 +116,10 @@ typedef struct {
     uint8_t                 tx_stmin;
     uint8_t                 tx_block_counter;
     uint32_t                tx_last_frame_time;
+    uint32_t                tx_progress_time; /**< Last CF that was queued (broadcast give-up) */
     TxEvent_e               event;
     const DiveCANMessage_t *fc_message;
+    uint8_t                 external_pending; /**< External requests queued or in flight */
 } TxSmCtx_t;
 
 static const struct smf_state tx_states[TX_STATE_COUNT];
@@ -95,7 +129,7 @@ static const struct smf_state tx_states[TX_STATE_COUNT];
  *
  * Uses `smf.current == NULL` as the uninitialised sentinel — first
  * access falls into the initial state via smf_set_initial. Production
- * access is serialised by the RX thread (the sole caller).
+ * access is serialised by isotp_tx_lock.
  */
 static TxSmCtx_t *getTxSm(void)
 {
@@ -109,6 +143,12 @@ static TxSmCtx_t *getTxSm(void)
 /* Statically allocated message queue */
 K_MSGQ_DEFINE(isotp_tx_msgq, sizeof(ISOTPTxRequest_t), ISOTP_TX_QUEUE_SIZE, 4);
 
+/* Serialises the SM and the scratch request buffer between the RX thread and
+ * the UDS worker. Held across a Poll that sends CFs; those are short: one
+ * blocking CF when STmin is set, else FIFO puts. A broadcast's CFs never
+ * wait for FIFO room, so a long one cannot hold the worker up. */
+static K_MUTEX_DEFINE(isotp_tx_lock);
+
 /**
  * @brief Return pointer to the static scratch buffer used when building TX requests
  *
@@ -124,6 +164,18 @@ static ISOTPTxRequest_t *getTxRequestBuffer(void)
 
 /* ---- Wire-format helpers (no state-machine knowledge) ---- */
 
+/**
+ * @brief Payload bytes of `tx`: its own copy, or the caller's buffer.
+ */
+static const uint8_t *tx_payload(const ISOTPTxRequest_t *tx)
+{
+    const uint8_t *payload = tx->data;
+    if (NULL != tx->external) {
+        payload = tx->external;
+    }
+    return payload;
+}
+
 /**
  * @brief Build and send a Single Frame for `tx`.
  */
@@ -134,8 +186,9 @@ static void send_single_frame(const ISOTPTxRequest_t *tx)
     sf.length = ISOTP_CAN_FRAME_LEN;
     sf.data[DIVECAN_SF_PCI_IDX] = (uint8_t)tx->length + DIVECAN_PAD_BYTE_SIZE;
     sf.data[DIVECAN_SF_PAD_IDX] = 0;
-    (void)memcpy(&sf.data[DIVECAN_SF_DATA_START], tx->data, tx->length);
-    (void)divecan_send_blocking(&sf);
+    (void)memcpy(&sf.data[DIVECAN_SF_DATA_START], tx_payload(tx), tx->length);
+    ISOTP_Link_NoteFrame((uint8_t)tx->target);
+    (void)divecan_send(&sf);
 }
 
 /**
@@ -153,35 +206,70 @@ static void send_first_frame(const ISOTPTxRequest_t *tx)
     ff.data[DIVECAN_FF_PCI_HI_IDX] = ISOTP_PCI_FF | ((totalLength >> DIVECAN_BYTE_WIDTH) & ISOTP_PCI_LEN_MASK);
     ff.data[DIVECAN_FF_LEN_LO_IDX] = (uint8_t)(totalLength & DIVECAN_BYTE_MASK);
     ff.data[DIVECAN_FF_PAD_IDX] = 0x00U;
-    (void)memcpy(&ff.data[DIVECAN_FF_DATA_START], tx->data, ISOTP_FF_DATA_WITH_PAD);
-    (void)divecan_send_blocking(&ff);
+    (void)memcpy(&ff.data[DIVECAN_FF_DATA_START], tx_payload(tx), ISOTP_FF_DATA_WITH_PAD);
+    ISOTP_Link_NoteFrame((uint8_t)tx->target);
+    (void)divecan_send(&ff);
 }
 
 /**
- * @brief Stream Consecutive Frames until block boundary or payload exhausted.
+ * @brief STmin from the current FC in milliseconds.
  *
- * Respects STmin pacing between frames. Returns true if all payload was
- * sent (caller should transition back to IDLE), false if the block size
- * was hit before completion (caller stays in WAIT_FC).
+ * The sub-millisecond range (0xF1-0xF9) and reserved values read as 0:
+ * the bus takes longer than that to carry a frame anyway.
+ */
+static uint32_t tx_stmin_ms(const TxSmCtx_t *sm)
+{
+    uint32_t stminMs = 0;
+    if (sm->tx_stmin <= ISOTP_STMIN_MS_MAX) {
+        stminMs = sm->tx_stmin;
+    }
+    return stminMs;
+}
+
+/**
+ * @brief Whether the current request goes to the broadcast address.
  */
-static bool send_consecutive_frames(TxSmCtx_t *sm)
+static bool tx_is_broadcast(const TxSmCtx_t *sm)
+{
+    return (uint8_t)sm->current.target == ISOTP_BROADCAST_ADDR;
+}
+
+/**
+ * @brief Time (ms) a SEND_CF TICK waits after the last CF, or attempt.
+ */
+static uint32_t tx_cf_gap_ms(const TxSmCtx_t *sm)
+{
+    uint32_t gapMs = tx_stmin_ms(sm);
+    if (tx_is_broadcast(sm)) {
+        gapMs = ISOTP_BROADCAST_RETRY_MS;
+    }
+    return gapMs;
+}
+
+/**
+ * @brief Send Consecutive Frames until block boundary, payload end or STmin.
+ *
+ * Without STmin the whole block is queued at once. With STmin only one CF
+ * is sent; the caller sends the next from a later TICK once STmin has
+ * elapsed (TX_STATE_SEND_CF), so the RX thread keeps servicing frames in
+ * between.
+ *
+ * A broadcast's CFs are queued only while the CAN TX FIFO has room
+ * (divecan_send_nowait): the caller holds isotp_tx_lock, and a long
+ * broadcast waiting on the FIFO frame by frame would hold it for the whole
+ * burst. A CF that finds it full is built again on a later TICK.
+ *
+ * @return Where the run stopped
+ */
+static TxCfResult_e send_consecutive_frames(TxSmCtx_t *sm)
 {
     const ISOTPTxRequest_t *tx = &sm->current;
-    bool waitingForFC = false;
-
-    while ((sm->tx_bytes_sent < tx->length) && (!waitingForFC)) {
-        /* STmin delay handling.
-         * k_msleep is a lower bound — the scheduler may overshoot,
-         * but STmin is a minimum separation time so overshooting
-         * is compliant with ISO 15765-2. */
-        uint32_t stminMs = 0;
-        if (sm->tx_stmin <= ISOTP_STMIN_MS_MAX) {
-            stminMs = sm->tx_stmin;
-        }
-        if (stminMs > 0) {
-            (void)k_msleep((int32_t)stminMs);
-        }
+    uint32_t stminMs = tx_stmin_ms(sm);
+    bool broadcast = tx_is_broadcast(sm);
+    TxCfResult_e result = TX_CF_DONE;
+    bool stop = false;
 
+    while ((sm->tx_bytes_sent < tx->length) && (!stop)) {
         /* Build CF */
         DiveCANMessage_t cf = {0};
         cf.id = tx->message_id | ((uint32_t)tx->target << DIVECAN_BYTE_WIDTH) | (uint32_t)tx->source;
@@ -195,40 +283,85 @@ static bool send_consecutive_frames(TxSmCtx_t *sm)
         } else {
             bytesToCopy = (uint8_t)remaining;
         }
-        (void)memcpy(&cf.data[ISOTP_CF_DATA_START], &tx->data[sm->tx_bytes_sent], bytesToCopy);
-
-        sm->tx_bytes_sent += bytesToCopy;
+        (void)memcpy(&cf.data[ISOTP_CF_DATA_START], &tx_payload(tx)[sm->tx_bytes_sent], bytesToCopy);
+
+        /* The send layer keeps frames in order, so CFs are only queued.
+         * Under STmin the next frame's delay must start once this one
+         * is on the wire, not once it is queued. */
+        Status_t queued = 0;
+        if (broadcast) {
+            queued = divecan_send_nowait(&cf);
+        } else if (stminMs > 0) {
+            (void)divecan_send_blocking(&cf);
+        } else {
+            (void)divecan_send(&cf);
+        }
         sm->tx_last_frame_time = k_uptime_get_32();
 
-        (void)divecan_send_blocking(&cf);
+        if (0 != queued) {
+            /* FIFO full: nothing went out, the CF is built again later */
+            result = TX_CF_PACED;
+            stop = true;
+        } else {
+            ISOTP_Link_NoteFrame((uint8_t)tx->target);
+            sm->tx_bytes_sent += bytesToCopy;
+            sm->tx_progress_time = sm->tx_last_frame_time;
+            sm->tx_sequence_number = (sm->tx_sequence_number + 1U) & ISOTP_SEQ_MASK;
+
+            /* Block size handling. A block that ends exactly on the last CF
+             * needs no further FC — the transfer is complete. */
+            ++sm->tx_block_counter;
+            if (sm->tx_bytes_sent >= tx->length) {
+                /* Payload exhausted; the loop ends with TX_CF_DONE */
+            } else if ((sm->tx_block_size != 0) &&
+                       (sm->tx_block_counter >= sm->tx_block_size)) {
+                result = TX_CF_BLOCK_END;
+                stop = true;
+            } else if (stminMs > 0) {
+                result = TX_CF_PACED;
+                stop = true;
+            } else {
+                /* Next CF straight away */
+            }
+        }
+    }
 
-        sm->tx_sequence_number = (sm->tx_sequence_number + 1U) & ISOTP_SEQ_MASK;
+    return result;
+}
 
-        /* Block size handling */
-        ++sm->tx_block_counter;
-        if ((sm->tx_block_size != 0) &&
-            (sm->tx_block_counter >= sm->tx_block_size)) {
-            waitingForFC = true;
+/**
+ * @brief Let go of the current request's external buffer, if it has one.
+ *
+ * Called whenever the current request is finished with — sent, aborted or
+ * timed out — so its owner may reuse the buffer.
+ */
+static void tx_release_external(TxSmCtx_t *sm)
+{
+    if (NULL != sm->current.external) {
+        sm->current.external = NULL;
+        if (sm->external_pending > 0U) {
+            --sm->external_pending;
         }
     }
-
-    return (!waitingForFC);
 }
 
 /* ---- State action functions ---- */
 
 /**
- * @brief TX_STATE_IDLE entry: zero the TX progress fields.
+ * @brief TX_STATE_IDLE entry: release the finished request and zero the TX
+ *        progress fields.
  */
 static void tx_idle_entry(void *obj)
 {
     TxSmCtx_t *sm = (TxSmCtx_t *)obj;
+    tx_release_external(sm);
     sm->tx_bytes_sent = 0;
     sm->tx_sequence_number = 0;
     sm->tx_block_size = 0;
     sm->tx_stmin = 0;
     sm->tx_block_counter = 0;
     sm->tx_last_frame_time = 0;
+    sm->tx_progress_time = 0;
 }
 
 /**
@@ -242,23 +375,24 @@ static enum smf_state_result tx_idle_run(void *obj)
     TxSmCtx_t *sm = (TxSmCtx_t *)obj;
 
     if (TX_EVT_TICK == sm->event) {
-        ISOTPTxRequest_t *reqBuffer = getTxRequestBuffer();
-        (void)memset(reqBuffer, 0, sizeof(ISOTPTxRequest_t));
-        if (0 == k_msgq_get(&isotp_tx_msgq, reqBuffer, K_NO_WAIT)) {
-            (void)memcpy(&sm->current, reqBuffer, sizeof(ISOTPTxRequest_t));
+        /* Dequeue straight into `current`, not the shared request scratch:
+         * the enqueue reaper ticks this state while that scratch still holds
+         * the request it is about to retry. */
+        if (0 == k_msgq_get(&isotp_tx_msgq, &sm->current, K_NO_WAIT)) {
             sm->tx_bytes_sent = 0;
             sm->tx_sequence_number = 0;
 
             if (sm->current.length <= ISOTP_SF_MAX_WITH_PAD) {
                 /* SF: send and stay IDLE. */
                 send_single_frame(&sm->current);
+                tx_release_external(sm);
             } else if ((uint8_t)sm->current.target == ISOTP_BROADCAST_ADDR) {
                 /* Broadcast multi-frame is fire-and-forget. A broadcast
                  * (e.g. the always-on log-push to the BT bridge at 0xFF)
                  * can NEVER receive a Flow Control frame — nobody is
                  * addressed to answer it — so parking in WAIT_FC for the
                  * N_Bs (1 s) timeout would only head-of-line-block the next
-                 * addressed UDS reply. Instead stream the FF then all CFs
+                 * addressed UDS reply. Instead stream the FF then the CFs
                  * immediately (implicit CTS, BS=0, STmin=0) and stay IDLE.
                  * This separation of the broadcast traffic class from the
                  * FC-driven dialog class is what keeps UDS replies prompt;
@@ -268,8 +402,14 @@ static enum smf_state_result tx_idle_run(void *obj)
                 sm->tx_block_size = 0;
                 sm->tx_stmin = 0;
                 sm->tx_block_counter = 0;
-                (void)send_consecutive_frames(sm);
-                /* Payload exhausted; remain IDLE for the next message. */
+                sm->tx_progress_time = k_uptime_get_32();
+                /* STmin is 0, so this runs to the payload end unless the
+                 * CAN TX FIFO fills; the rest then goes from SEND_CF. */
+                if (TX_CF_DONE == send_consecutive_frames(sm)) {
+                    tx_release_external(sm);
+                } else {
+                    smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_SEND_CF]);
+                }
             } else {
                 /* Addressed multi-frame: send FF, expect FC. */
                 send_first_frame(&sm->current);
@@ -284,11 +424,28 @@ static enum smf_state_result tx_idle_run(void *obj)
     return SMF_EVENT_HANDLED;
 }
 
+/**
+ * @brief Move the SM on after a run of Consecutive Frames.
+ *
+ * Payload end completes the transfer (IDLE), a block boundary awaits the
+ * next FC (WAIT_FC) and STmin pacing continues from TX_STATE_SEND_CF.
+ */
+static void tx_after_cfs(TxSmCtx_t *sm, TxCfResult_e sent)
+{
+    if (TX_CF_DONE == sent) {
+        ISOTP_Link_NoteTransfer((uint8_t)sm->current.target, false);
+        smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
+    } else if (TX_CF_BLOCK_END == sent) {
+        smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_WAIT_FC]);
+    } else {
+        smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_SEND_CF]);
+    }
+}
+
 /**
  * @brief TX_STATE_WAIT_FC.run: handle FC frames and N_Bs timeout.
  *
- * FC_CTS triggers a block-bounded CF send; full payload returns the
- * SM to IDLE, block boundary keeps it in WAIT_FC for the next FC.
+ * FC_CTS starts a run of CFs (see tx_after_cfs for where it leads).
  * FC_WAIT and FC_OVFLW abort to IDLE.
  * TICK checks the N_Bs timeout and aborts on expiry.
  */
@@ -301,20 +458,20 @@ static enum smf_state_result tx_wait_fc_run(void *obj)
         sm->tx_block_size = fc->data[ISOTP_FC_BS_IDX];
         sm->tx_stmin = fc->data[ISOTP_FC_STMIN_IDX];
         sm->tx_block_counter = 0;
-        bool payload_complete = send_consecutive_frames(sm);
-        if (payload_complete) {
-            smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
-        }
-        /* else: still in WAIT_FC awaiting the next FC. */
+        /* STmin separates CFs; the first may follow the FC at once. */
+        tx_after_cfs(sm, send_consecutive_frames(sm));
     } else if (TX_EVT_FC_WAIT == sm->event) {
         OP_ERROR_DETAIL(OP_ERR_ISOTP_STATE, ISOTP_FC_WAIT);
+        ISOTP_Link_NoteFault((uint8_t)sm->current.target, ISOTP_LINK_FAULT_TX_REFUSED);
         smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
     } else if (TX_EVT_FC_OVFLW == sm->event) {
         OP_ERROR_DETAIL(ISOTP_RX_ABORT_ERR, ISOTP_FC_OVFLW);
+        ISOTP_Link_NoteFault((uint8_t)sm->current.target, ISOTP_LINK_FAULT_TX_REFUSED);
         smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
     } else if (TX_EVT_TICK == sm->event) {
         uint32_t currentTime = k_uptime_get_32();
         if ((currentTime - sm->tx_last_frame_time) > ISOTP_TIMEOUT_N_BS) {
+            ISOTP_Link_NoteFault((uint8_t)sm->current.target, ISOTP_LINK_FAULT_TX_TIMEOUT);
             smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
         }
     } else {
@@ -323,9 +480,37 @@ static enum smf_state_result tx_wait_fc_run(void *obj)
     return SMF_EVENT_HANDLED;
 }
 
+/**
+ * @brief TX_STATE_SEND_CF.run: send the next CF once STmin has elapsed.
+ *
+ * A broadcast that has not got a CF into the CAN TX FIFO for N_Bs is
+ * dropped: the bus is not draining, and the replies queued behind it
+ * should not wait for it. FC frames are not expected mid-block and are
+ * ignored.
+ */
+static enum smf_state_result tx_send_cf_run(void *obj)
+{
+    TxSmCtx_t *sm = (TxSmCtx_t *)obj;
+
+    if (TX_EVT_TICK == sm->event) {
+        uint32_t currentTime = k_uptime_get_32();
+        if (tx_is_broadcast(sm) &&
+            ((currentTime - sm->tx_progress_time) > ISOTP_TIMEOUT_N_BS)) {
+            ISOTP_Link_NoteFault((uint8_t)sm->current.target, ISOTP_LINK_FAULT_TX_TIMEOUT);
+            smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
+        } else if ((currentTime - sm->tx_last_frame_time) >= tx_cf_gap_ms(sm)) {
+            tx_after_cfs(sm, send_consecutive_frames(sm));
+        } else {
+            /* Not yet */
+        }
+    }
+    return SMF_EVENT_HANDLED;
+}
+
 static const struct smf_state tx_states[TX_STATE_COUNT] = {
     [TX_STATE_IDLE]    = SMF_CREATE_STATE(tx_idle_entry, tx_idle_run,    NULL, NULL, NULL),
     [TX_STATE_WAIT_FC] = SMF_CREATE_STATE(NULL,          tx_wait_fc_run, NULL, NULL, NULL),
+    [TX_STATE_SEND_CF] = SMF_CREATE_STATE(NULL,          tx_send_cf_run, NULL, NULL, NULL),
 };
 
 /**
@@ -336,14 +521,61 @@ static bool tx_sm_is_idle(const TxSmCtx_t *sm)
     return sm->smf.current == &tx_states[TX_STATE_IDLE];
 }
 
+/**
+ * @brief Put a built request on the queue, reaping a dead transfer if full.
+ *
+ * @param req Request to copy into the queue
+ * @return true if queued, false if the queue is full
+ */
+static bool tx_enqueue(const ISOTPTxRequest_t *req)
+{
+    bool result = false;
+
+    /* Non-blocking put */
+    Status_t ret = k_msgq_put(&isotp_tx_msgq, req, K_NO_WAIT);
+    if (0 != ret) {
+        /* Queue full. The drain only stalls when an in-flight multi-frame
+         * TX is stuck in WAIT_FC (its FC was lost or never came): the SM
+         * stops pulling new requests, so every subsequent UDS reply is
+         * dropped HERE and UDS stays dead until reboot — while broadcasts
+         * (which don't use this queue) keep flowing, so the stall is
+         * invisible to liveness checks. If the current transfer has blown
+         * the N_Bs deadline it is dead: reap it back to IDLE, drain one
+         * pending request to free a slot, and retry so the responder
+         * self-heals instead of wedging. */
+        TxSmCtx_t *sm = getTxSm();
+        if ((!tx_sm_is_idle(sm)) &&
+            ((k_uptime_get_32() - sm->tx_last_frame_time) > ISOTP_TIMEOUT_N_BS)) {
+            ISOTP_Link_NoteFault((uint8_t)sm->current.target, ISOTP_LINK_FAULT_TX_TIMEOUT);
+            smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
+            sm->event = TX_EVT_TICK;
+            (void)smf_run_state(SMF_CTX(sm));
+            sm->event = TX_EVT_NONE;
+            ret = k_msgq_put(&isotp_tx_msgq, req, K_NO_WAIT);
+        }
+        if (0 != ret) {
+            OP_ERROR(OP_ERR_QUEUE);
+        } else {
+            result = true;
+        }
+    } else {
+        result = true;
+    }
+
+    return result;
+}
+
 /* ---- Public API ---- */
 
 void ISOTP_TxQueue_Init(void)
 {
+    (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
     TxSmCtx_t *sm = getTxSm();
     /* Force back to IDLE — clears progress fields via the entry. */
     smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
     k_msgq_purge(&isotp_tx_msgq);
+    sm->external_pending = 0U;
+    (void)k_mutex_unlock(&isotp_tx_lock);
 }
 
 bool ISOTP_TxQueue_Enqueue(DiveCANType_t source, DiveCANType_t target,
@@ -362,6 +594,7 @@ bool ISOTP_TxQueue_Enqueue(DiveCANType_t source, DiveCANType_t target,
          * never sit in WAIT_FC and cannot head-of-line-block an addressed UDS
          * reply. This replaces the former preemptible-purge/in-flight-abort
          * dance. */
+        (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
         ISOTPTxRequest_t *reqBuffer = getTxRequestBuffer();
 
         (void)memset(reqBuffer, 0, sizeof(ISOTPTxRequest_t));
@@ -371,43 +604,83 @@ bool ISOTP_TxQueue_Enqueue(DiveCANType_t source, DiveCANType_t target,
         reqBuffer->target = target;
         reqBuffer->message_id = message_id;
 
-        /* Non-blocking put */
-        Status_t ret = k_msgq_put(&isotp_tx_msgq, reqBuffer, K_NO_WAIT);
-        if (0 != ret) {
-            /* Queue full. The drain only stalls when an in-flight multi-frame
-             * TX is stuck in WAIT_FC (its FC was lost or never came): the SM
-             * stops pulling new requests, so every subsequent UDS reply is
-             * dropped HERE and UDS stays dead until reboot — while broadcasts
-             * (which don't use this queue) keep flowing, so the stall is
-             * invisible to liveness checks. If the current transfer has blown
-             * the N_Bs deadline it is dead: reap it back to IDLE, drain one
-             * pending request to free a slot, and retry so the responder
-             * self-heals instead of wedging. */
-            TxSmCtx_t *sm = getTxSm();
-            if ((!tx_sm_is_idle(sm)) &&
-                ((k_uptime_get_32() - sm->tx_last_frame_time) > ISOTP_TIMEOUT_N_BS)) {
-                smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
-                sm->event = TX_EVT_TICK;
-                (void)smf_run_state(SMF_CTX(sm));
-                sm->event = TX_EVT_NONE;
-                ret = k_msgq_put(&isotp_tx_msgq, reqBuffer, K_NO_WAIT);
-            }
-            if (0 != ret) {
-                OP_ERROR(OP_ERR_QUEUE);
-            } else {
-                result = true;
-            }
-        } else {
-            result = true;
+        result = tx_enqueue(reqBuffer);
+        (void)k_mutex_unlock(&isotp_tx_lock);
+    }
+
+    return result;
+}
+
+bool ISOTP_TxQueue_EnqueueExternal(DiveCANType_t source, DiveCANType_t target,
+                   uint32_t message_id, const uint8_t *data,
+                   uint16_t length)
+{
+    bool result = false;
+
+    if ((NULL == data) || (0U == length) || (length > ISOTP_EXT_MAX_PAYLOAD)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else {
+        (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
+        ISOTPTxRequest_t *reqBuffer = getTxRequestBuffer();
+
+        (void)memset(reqBuffer, 0, sizeof(ISOTPTxRequest_t));
+        reqBuffer->external = data;
+        reqBuffer->length = length;
+        reqBuffer->source = source;
+        reqBuffer->target = target;
+        reqBuffer->message_id = message_id;
+
+        /* Count it before the put: a reap inside tx_enqueue may start (and,
+         * for a short message, finish) it straight away. */
+        TxSmCtx_t *sm = getTxSm();
+        ++sm->external_pending;
+        result = tx_enqueue(reqBuffer);
+        if (!result) {
+            --sm->external_pending;
         }
+        (void)k_mutex_unlock(&isotp_tx_lock);
     }
 
     return result;
 }
 
+bool ISOTP_TxQueue_ExternalPending(void)
+{
+    const TxSmCtx_t *sm = getTxSm();
+    return (0U != sm->external_pending);
+}
+
+void ISOTP_TxQueue_AbortExternal(void)
+{
+    (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
+    TxSmCtx_t *sm = getTxSm();
+
+    if ((!tx_sm_is_idle(sm)) && (NULL != sm->current.external)) {
+        /* IDLE entry releases the buffer. */
+        smf_set_state(SMF_CTX(sm), &tx_states[TX_STATE_IDLE]);
+    }
+
+    /* Rotate the queue once, putting back every copied request in order. */
+    ISOTPTxRequest_t *reqBuffer = getTxRequestBuffer();
+    uint32_t queued = k_msgq_num_used_get(&isotp_tx_msgq);
+    for (uint32_t i = 0U; i < queued; ++i) {
+        if (0 == k_msgq_get(&isotp_tx_msgq, reqBuffer, K_NO_WAIT)) {
+            if (NULL == reqBuffer->external) {
+                (void)k_msgq_put(&isotp_tx_msgq, reqBuffer, K_NO_WAIT);
+            } else if (sm->external_pending > 0U) {
+                --sm->external_pending;
+            } else {
+                /* No action required */
+            }
+        }
+    }
+    (void)k_mutex_unlock(&isotp_tx_lock);
+}
+
 bool ISOTP_TxQueue_ProcessFC(const DiveCANMessage_t *fc)
 {
     bool result = false;
+    (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
     TxSmCtx_t *sm = getTxSm();
 
     if (NULL == fc) {
@@ -444,6 +717,7 @@ bool ISOTP_TxQueue_ProcessFC(const DiveCANMessage_t *fc)
             }
 
             if (ev != TX_EVT_NONE) {
+                ISOTP_Link_NoteFrame((uint8_t)sm->current.target);
                 sm->event = ev;
                 sm->fc_message = fc;
                 (void)smf_run_state(SMF_CTX(sm));
@@ -462,6 +736,7 @@ bool ISOTP_TxQueue_ProcessFC(const DiveCANMessage_t *fc)
             }
         }
     }
+    (void)k_mutex_unlock(&isotp_tx_lock);
 
     return result;
 }
@@ -469,10 +744,48 @@ bool ISOTP_TxQueue_ProcessFC(const DiveCANMessage_t *fc)
 void ISOTP_TxQueue_Poll(uint32_t currentTime)
 {
     ARG_UNUSED(currentTime);  /* read inside the WAIT_FC run via k_uptime_get_32 */
+    (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
     TxSmCtx_t *sm = getTxSm();
     sm->event = TX_EVT_TICK;
     (void)smf_run_state(SMF_CTX(sm));
     sm->event = TX_EVT_NONE;
+    (void)k_mutex_unlock(&isotp_tx_lock);
+}
+
+bool ISOTP_TxQueue_NextDeadline(uint32_t *deadline)
+{
+    bool pending = false;
+    const TxSmCtx_t *sm = getTxSm();
+
+    if (NULL == deadline) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (sm->smf.current == &tx_states[TX_STATE_WAIT_FC]) {
+        /* The WAIT_FC tick fires once the gap EXCEEDS N_Bs. */
+        *deadline = sm->tx_last_frame_time + ISOTP_TIMEOUT_N_BS + 1U;
+        pending = true;
+    } else if (sm->smf.current == &tx_states[TX_STATE_SEND_CF]) {
+        *deadline = sm->tx_last_frame_time + tx_cf_gap_ms(sm);
+        pending = true;
+    } else {
+        /* IDLE: queued requests wake the caller through the msgq */
+    }
+
+    return pending;
+}
+
+struct k_msgq *ISOTP_TxQueue_Msgq(void)
+{
+    return &isotp_tx_msgq;
+}
+
+void ISOTP_TxQueue_Lock(void)
+{
+    (void)k_mutex_lock(&isotp_tx_lock, K_FOREVER);
+}
+
+void ISOTP_TxQueue_Unlock(void)
+{
+    (void)k_mutex_unlock(&isotp_tx_lock);
 }
 
 bool ISOTP_TxQueue_IsBusy(void)
@@ -28,6 +28,7 @@
 #include "solenoid_roles.h"
 #include "errors.h"
 #include "error_histogram.h"
+#include "latency_trace.h"
 #include "factory_image.h"
 #include "flash_mass_erase.h"
 #include "external_flash.h"
@@ -98,9 +99,9 @@ static const uint16_t AUTOTUNE_ABORT_LEN = 6U;  /* pad+SID+DID_HI+DID_LO+cmd+mag
  * down. Matches the equivalent delay inside uds_ota.c's 0x31 path. */
 static const uint32_t OTA_WRITE_REBOOT_DELAY_MS = 200U;
 
-/* Pump count/interval to flush a queued UDS response from the handler thread
- * before the factory-flash-erase blocks the divecan_rx poll loop (which would
- * otherwise be the only thing that transmits it). 30 x 10 ms = 300 ms ceiling;
+/* Pump count/interval to flush a queued UDS response from the worker before
+ * the factory-flash-erase starts: the wipe stalls the whole part, the
+ * divecan_rx poll loop that would otherwise transmit it included. 30 x 10 ms = 300 ms ceiling;
  * a single-frame ACK drains in the first poll or two. */
 static const uint32_t FLASH_ERASE_TX_FLUSH_POLLS = 30U;
 static const uint32_t FLASH_ERASE_TX_FLUSH_POLL_MS = 10U;
@@ -166,16 +167,16 @@ static void faultInjectionTimerHandler(struct k_timer *timer)
  *
  * Zeroes the context and binds the ISO-TP transport.
  *
- * @param ctx      UDS context to initialise; must not be NULL
- * @param isotpCtx ISO-TP context to bind for request/response transport
+ * @param ctx   UDS context to initialise; must not be NULL
+ * @param reply Addressing to bind for response transport
  */
-void UDS_Init(UDSContext_t *ctx, ISOTPContext_t *isotpCtx)
+void UDS_Init(UDSContext_t *ctx, ISOTPReply_t *reply)
 {
     if (NULL == ctx) {
         OP_ERROR(OP_ERR_NULL_PTR);
     } else {
         (void)memset(ctx, 0, sizeof(UDSContext_t));
-        ctx->isotp_context = isotpCtx;
+        ctx->reply = reply;
         ctx->session = UDS_SESSION_DEFAULT;
         ctx->last_activity_ms = k_uptime_get_32();
     }
@@ -192,24 +193,37 @@ bool UDS_IsInDive(void)
     return in_dive;
 }
 
+/**
+ * @brief Revert a programming session idle for longer than S3.
+ *
+ * @param ctx UDS context; must not be NULL
+ * @param now Current uptime (ms)
+ * @return true if the session was downgraded
+ */
+static bool expireIdleSession(UDSContext_t *ctx, uint32_t now)
+{
+    bool downgraded = false;
+
+    /* S3 timeout: programming session reverts to default after
+     * UDS_S3_TIMEOUT_MS of inactivity. */
+    if (UDS_SESSION_PROGRAMMING == ctx->session) {
+        uint32_t elapsed = now - ctx->last_activity_ms;
+        if (elapsed > UDS_S3_TIMEOUT_MS) {
+            LOG_INF("S3 timeout: programming session -> default");
+            ctx->session = UDS_SESSION_DEFAULT;
+            downgraded = true;
+        }
+    }
+    return downgraded;
+}
+
 void UDS_MaintainSession(UDSContext_t *ctx)
 {
     if (NULL == ctx) {
         OP_ERROR(OP_ERR_NULL_PTR);
     } else {
         uint32_t now = k_uptime_get_32();
-        bool downgraded = false;
-
-        /* S3 timeout: programming session reverts to default after
-         * UDS_S3_TIMEOUT_MS of inactivity. */
-        if (UDS_SESSION_PROGRAMMING == ctx->session) {
-            uint32_t elapsed = now - ctx->last_activity_ms;
-            if (elapsed > UDS_S3_TIMEOUT_MS) {
-                LOG_INF("S3 timeout: programming session -> default");
-                ctx->session = UDS_SESSION_DEFAULT;
-                downgraded = true;
-            }
-        }
+        bool downgraded = expireIdleSession(ctx, now);
 
         /* Forced downgrade if we observe a dive in progress — any
          * programming session that was alive when the diver descended
@@ -237,6 +251,34 @@ void UDS_MaintainSession(UDSContext_t *ctx)
     }
 }
 
+void UDS_PollSession(UDSContext_t *ctx, uint32_t now)
+{
+    if (NULL == ctx) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (expireIdleSession(ctx, now)) {
+        /* Same teardown as a lapse noticed by the next request. */
+        UDS_OTA_Reset();
+    } else {
+        /* Session still live, or already default */
+    }
+}
+
+bool UDS_SessionDeadline(const UDSContext_t *ctx, uint32_t *deadline)
+{
+    bool pending = false;
+
+    if ((NULL == ctx) || (NULL == deadline)) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (UDS_SESSION_PROGRAMMING == ctx->session) {
+        *deadline = ctx->last_activity_ms + UDS_S3_TIMEOUT_MS + 1U;
+        pending = true;
+    } else {
+        /* Default session never times out */
+    }
+
+    return pending;
+}
+
 /**
  * @brief Route SID 0x34/0x36/0x37 (RequestDownload / TransferData /
  *        RequestTransferExit) to the log-download reader or firmware OTA.
@@ -353,14 +395,14 @@ void UDS_ProcessRequest(UDSContext_t *ctx, const uint8_t *request_data,
 /**
  * @brief Send a UDS negative response (NRC) to the requester
  *
- * @param ctx          UDS context; must not be NULL and must have a bound ISO-TP context
+ * @param ctx          UDS context; must not be NULL and must have bound reply addressing
  * @param requestedSID SID from the failing request (echoed in the response)
  * @param nrc          Negative response code (UDS_NRC_* constant)
  */
 void UDS_SendNegativeResponse(UDSContext_t *ctx, uint8_t requestedSID,
                   uint8_t nrc)
 {
-    if ((NULL == ctx) || (NULL == ctx->isotp_context)) {
+    if ((NULL == ctx) || (NULL == ctx->reply)) {
         OP_ERROR(OP_ERR_NULL_PTR);
     } else {
         ctx->response_buffer[UDS_PAD_IDX] = UDS_SID_NEGATIVE_RESPONSE;
@@ -368,8 +410,8 @@ void UDS_SendNegativeResponse(UDSContext_t *ctx, uint8_t requestedSID,
         ctx->response_buffer[UDS_DID_HI_IDX] = nrc;
         ctx->response_length = UDS_NEG_RESP_LEN;
 
-        (void)ISOTP_Send(ctx->isotp_context, ctx->response_buffer,
-                 ctx->response_length);
+        (void)ISOTP_Reply(ctx->reply, ctx->response_buffer,
+                  ctx->response_length);
     }
 }
 
@@ -380,12 +422,12 @@ void UDS_SendNegativeResponse(UDSContext_t *ctx, uint8_t requestedSID,
  */
 void UDS_SendResponse(UDSContext_t *ctx)
 {
-    if ((NULL == ctx) || (NULL == ctx->isotp_context) ||
+    if ((NULL == ctx) || (NULL == ctx->reply) ||
         (0U == ctx->response_length)) {
         OP_ERROR(OP_ERR_NULL_PTR);
     } else {
-        (void)ISOTP_Send(ctx->isotp_context, ctx->response_buffer,
-                 ctx->response_length);
+        (void)ISOTP_Reply(ctx->reply, ctx->response_buffer,
+                  ctx->response_length);
     }
 }
 
@@ -1273,6 +1315,33 @@ static bool writeHistogramClearDID(UDSContext_t *ctx,
     return true;
 }
 
+/**
+ * @brief Handle write to UDS_DID_LATENCY_TRACE_CLEAR (0xF217).
+ *
+ * Like the error-histogram clear, any payload triggers it. The histograms
+ * live in RAM only, so the clear cannot fail.
+ *
+ * @param ctx           UDS context
+ * @param request_data   Request bytes
+ * @param request_length Total byte count of request_data
+ * @return true (always)
+ */
+static bool writeLatencyTraceClearDID(UDSContext_t *ctx,
+                      const uint8_t *request_data,
+                      uint16_t request_length)
+{
+    ARG_UNUSED(request_length);
+
+    latency_trace_clear();
+
+    ctx->response_buffer[UDS_PAD_IDX] = UDS_SID_WRITE_DATA_BY_ID + UDS_RESPONSE_SID_OFFSET;
+    ctx->response_buffer[UDS_SID_IDX] = request_data[UDS_DID_HI_IDX];
+    ctx->response_buffer[UDS_DID_HI_IDX] = request_data[UDS_DID_LO_IDX];
+    ctx->response_length = UDS_POS_RESP_HDR;
+    UDS_SendResponse(ctx);
+    return true;
+}
+
 /**
  * @brief Common precondition checks for the OTA-action write DIDs.
  *
@@ -1432,10 +1501,10 @@ static bool writeFactoryFlashEraseDID(UDSContext_t *ctx,
     } else if (claimFlashMaintenance(ctx)) {
         LOG_WRN("Factory flash erase: wiping external NOR (~minutes), then reboot");
         /* ACK now. The ISO-TP TX queue is normally drained by the divecan_rx
-         * poll loop — which THIS handler is about to block for minutes in the
-         * erase — so pump it here until the ACK is physically transmitted before
-         * we start. Without this the queued ACK is never sent and the tool sees
-         * a timeout even though the erase proceeds. After the ACK the bus goes
+         * poll loop — which the erase is about to stall for minutes — so pump
+         * it here until the ACK is physically transmitted before we start.
+         * Without this the queued ACK is never sent and the tool sees a
+         * timeout even though the erase proceeds. After the ACK the bus goes
          * dark; the tool should expect the unit to drop off then reboot. */
         buildWriteDidPositiveResponse(ctx, request_data);
         UDS_SendResponse(ctx);
@@ -1769,6 +1838,7 @@ static const struct {
     { UDS_DID_AUTOTUNE_CONTROL,      writeAutotuneControlDID },
 #endif
     { UDS_DID_ERROR_HISTOGRAM_CLEAR, writeHistogramClearDID },
+    { UDS_DID_LATENCY_TRACE_CLEAR,   writeLatencyTraceClearDID },
     { UDS_DID_OTA_FORCE_REVERT,      writeForceRevertDID },
     { UDS_DID_OTA_RESTORE_FACTORY,   writeRestoreFactoryDID },
     { UDS_DID_OTA_FACTORY_CAPTURE,   writeFactoryCaptureDID },
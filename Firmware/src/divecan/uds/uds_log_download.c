@@ -10,18 +10,43 @@
  * State machine:
  *   IDLE      -> selectors are accepted; 0x34/0x36/0x37 NRC-out.
  *   SELECTED  -> after a selector resolved a range; 0xF105 (BeginStream)
- *                arms the next 0x34 to be claimed.
+ *                arms the next 0x34 to be claimed, optionally with a
+ *                record-type mask that filters the stream on the device,
+ *                and a bucket length that decimates it.
  *   STREAMING -> 0x34 accepted, 0x36 chunks served from the FCB. 0x37
  *                returns to IDLE.
  *
+ * A client that asks at 0x34 for blocks larger than one standard ISO-TP
+ * message (a direct-CAN client) gets extended-length blocks: each 0x36
+ * response is built in the stream's arena reservation and sent from there as
+ * one message of up to ISOTP_EXT_MAX_PAYLOAD bytes, so a download takes far
+ * fewer request/response round trips.
+ *
+ * A raw stream checkpoints its reader at every accepted 0x36; after a broken
+ * transfer the client reads the checkpoint back as a resume token
+ * (UDS_DID_LOG_RESUME_TOKEN) and selects the rest of the stream with
+ * RID_SELECT_RESUME.
+ *
+ * RID_LIVE_TAIL shares the 0xF1xx block but not the state machine: it
+ * (re)arms the live-tail subscription in flash_log_tail.c, whose records are
+ * pushed by uds_log_push.c rather than downloaded.
+ *
  * Wire format on the byte stream (carried inside 0x36 payloads):
- *   header (16 B): magic "DCLG", version, flags, stream u8, reserved,
+ *   header (16 B): magic "DCLG", version, flags, stream u8, codec,
  *                  total_bytes (estimate), entry_count (estimate)
- *   body: raw TLV entries from flash_log_reader_next()
+ *   body: raw TLV entries from flash_log_reader_next(), or — when the 0x34
+ *         dataFormatIdentifier selected compression and flags has
+ *         LOG_HEADER_FLAG_LZ — those same bytes as one LZSS bit stream
+ *         (flash_log_lz.h), with the codec byte carrying its parameters.
+ *         The header itself is never compressed. A filtered stream sets
+ *         LOG_HEADER_FLAG_FILTERED and follows the header with the applied
+ *         type mask (u64 LE), also uncompressed; a decimated one also sets
+ *         LOG_HEADER_FLAG_DECIMATED.
  */
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
 
 #include <errno.h>
 #include <string.h>
@@ -29,8 +54,12 @@
 #include "uds.h"
 #include "uds_log_download.h"
 #include "uds_log_push.h"
+#include "isotp_link.h"
+#include "isotp_tx_queue.h"
 #include "flash_log.h"
 #include "flash_log_reader.h"
+#include "flash_log_lz.h"
+#include "flash_log_tail.h"
 #include "maintenance_arena.h"
 #include "errors.h"
 
@@ -42,14 +71,35 @@ static const uint32_t LOG_DOWNLOAD_SENTINEL_ADDR = 0xFFFFFFFEU;
 static const uint32_t LOG_HEADER_MAGIC = 0x47434C44U; /* "DCLG" little-endian */
 static const uint8_t  LOG_HEADER_VERSION = 0x01U;
 static const size_t   LOG_HEADER_BYTES = 16U;
+/* Header flags bit: the body after the header is LZSS-compressed. */
+static const uint8_t  LOG_HEADER_FLAG_LZ = 0x01U;
+/* Header flags bit 1: the body holds only the record types in the mask that
+ * follows the header. */
+static const uint8_t  LOG_HEADER_FLAG_FILTERED = 0x02U;
+static const size_t   LOG_HEADER_MASK_BYTES = 8U;
+/* Header flags bit 2: consensus, cell raw and power records are replaced by
+ * per-bucket FL_TYPE_AGGREGATE records. */
+static const uint8_t  LOG_HEADER_FLAG_DECIMATED = 0x04U;
 
 /* 0x34 request: [pad][SID][dataFmt][addrLenFmt][addr 4][size 4] = 12 B */
 static const uint16_t LOG_DOWNLOAD_REQ_LEN = 12U;
 /* Floor for a client-negotiated chunk (0x34 size field): the first chunk must
  * carry the 16-byte DCLG stream header with room left for record bytes. */
 static const uint16_t LOG_DOWNLOAD_MIN_BLOCK = 32U;
+/* Largest block that fits response_buffer as one standard ISO-TP message:
+ * UDS_MAX_RESPONSE_LENGTH minus the 0x36 framing (pad + SID + seq = 3 B). */
+static const uint16_t LOG_DOWNLOAD_STD_BLOCK = UDS_MAX_RESPONSE_LENGTH - 3U;
+/* Largest extended-length block: one ISOTP_SendExternal() message minus the
+ * [SID][seq] response header. */
+static const uint16_t LOG_DOWNLOAD_EXT_MAX_BLOCK = ISOTP_EXT_MAX_PAYLOAD - 2U;
 static const uint16_t LOG_DOWNLOAD_RESP_LEN = 4U;
 static const uint8_t  LOG_DOWNLOAD_ADDR_LEN_FMT = 0x44U;
+/* 0x34 dataFormatIdentifier (ISO 14229: compressionMethod in the upper
+ * nibble, encryptingMethod in the lower). Compression method 1 is the LZSS
+ * stream of flash_log_lz.h; nothing else is accepted. */
+static const size_t   LOG_DOWNLOAD_DATA_FMT_IDX = 2U;
+static const uint8_t  LOG_DOWNLOAD_DATA_FMT_RAW = 0x00U;
+static const uint8_t  LOG_DOWNLOAD_DATA_FMT_LZ = 0x10U;
 /* Byte offset of addrLenFmt within the 0x34 request (see layout above). */
 static const size_t   LOG_DOWNLOAD_ADDR_LEN_FMT_IDX = 3U;
 /* 0x34 positive-response lengthFormatIdentifier: upper nibble = number of
@@ -85,13 +135,22 @@ static const uint8_t  ROUTINE_CONTROL_RESP_LEN = 4U;
 /* Select the entire resident ring (walk-free "download all"). Streams every
  * retained entry oldest→newest with no marker-index build — see
  * flash_log_reader_resolve_all(). Numerically above BEGIN_STREAM, so the
- * selector range check below runs to RID_SELECT_ALL and BEGIN_STREAM is
- * diverted by its own earlier branch. */
+ * selector range check below runs past it (to RID_SELECT_RESUME) and
+ * BEGIN_STREAM is diverted by its own earlier branch. */
 #define RID_SELECT_ALL        0xF106U
+/* Select the rest of an interrupted raw stream from a resume token (see the
+ * resume-token section below). */
+#define RID_SELECT_RESUME     0xF107U
+/* Subscribe to / renew / end the live tail (flash_log_tail.h). Not a
+ * selector: it leaves any selection or stream untouched. */
+#define RID_LIVE_TAIL         0xF108U
 
 static const size_t BYTE_SHIFT_8  = 8U;
 static const size_t BYTE_SHIFT_16 = 16U;
 static const size_t BYTE_SHIFT_24 = 24U;
+static const size_t BYTES_PER_U16 = 2U;
+static const size_t BYTES_PER_U32 = 4U;
+static const size_t BYTES_PER_U64 = 8U;
 /* Byte-extraction mask comes from common.h (BYTE_MASK, included transitively). */
 
 /* ---- SM state ---- */
@@ -112,9 +171,12 @@ typedef struct {
      * UDS_DID_LOG_SELECTOR_RESULT. */
     uint8_t  selector_result[20];
     bool     selector_result_valid;
-    /* Max chunk size negotiated in 0x34 response — equals
-     * UDS_MAX_RESPONSE_LENGTH minus the 0x36 response framing (2 B). */
+    /* Max chunk size negotiated in 0x34 response — LOG_DOWNLOAD_STD_BLOCK or
+     * less, or an extended-length block built in xfer_buf. */
     uint16_t max_block_length;
+    /* [SID][seq][body] buffer in the arena for an extended-length block
+     * (NULL = the block is built in response_buffer). */
+    uint8_t *xfer_buf;
     /* Async selector-resolution handshake (all guarded by fl_resolve_lock).
      * The index-backed selectors are resolved on fl_resolve_worker_tid; the
      * RoutineControl handler kicks the worker and answers busyRepeatRequest
@@ -123,10 +185,82 @@ typedef struct {
     bool     resolve_done;        /* worker published resolve_rc for it */
     Status_t resolve_rc;          /* worker's resolve outcome */
     uint16_t resolve_rid;         /* selector RID in flight */
-    uint8_t  resolve_params[8];   /* selector payload snapshot (stream + id) */
+    uint8_t  resolve_params[21];  /* selector payload snapshot (by-range is the largest) */
     uint8_t  resolve_params_len;
+    /* Maintenance arena granted to the LOG_STREAM claim while streaming, the
+     * compressor placed in it when 0x34 selected a compressed body (NULL =
+     * raw), the filter scratch placed behind it when BeginStream carried
+     * a type mask (NULL = unfiltered), and the aggregator behind that when
+     * it also carried a bucket length (NULL = not decimated). */
+    void *arena;
+    FlashLogLz_t *lz;
+    FlashLogFilterScratch_t *filter;
+    FlashLogAggregator_t *agg;
+    uint64_t type_mask;
+    /* Resume checkpoint: the reader position when the latest 0x36 was
+     * accepted and the body bytes sent before that block (raw streams only,
+     * kept across an aborted stream). `resuming` marks a selection made by
+     * RID_SELECT_RESUME, whose body continues at resume_body. */
+    FlashLogResumePoint_t checkpoint;
+    uint32_t checkpoint_body;
+    bool     checkpoint_valid;
+    uint32_t body_sent;
+    bool     resuming;
+    FlashLogResumePoint_t resume_point;
+    uint32_t resume_body;
 } LogDownloadSM_t;
 
+/* Arena layout while streaming:
+ * [FlashLogLz_t | FlashLogFilterScratch_t | FlashLogAggregator_t]. */
+#define LOG_STREAM_FILTER_OFF ROUND_UP(sizeof(FlashLogLz_t), sizeof(uint64_t))
+#define LOG_STREAM_AGG_OFF                                                    \
+    ROUND_UP(LOG_STREAM_FILTER_OFF + sizeof(FlashLogFilterScratch_t),         \
+             sizeof(uint64_t))
+
+BUILD_ASSERT((LOG_STREAM_AGG_OFF + sizeof(FlashLogAggregator_t)) <=
+             MAINT_ARENA_SIZE,
+             "compressed + decimated log download state must fit the maintenance arena");
+
+/**
+ * @brief Largest free arena span left by the stream's other tenants.
+ *
+ * The extended-length block buffer takes either the gap before the first
+ * live tenant or the space after the last one, whichever is bigger.
+ *
+ * @param sm  Log-download SM (lz/filter/agg already placed)
+ * @param off Out: arena offset of the span
+ * @return Span length in bytes
+ */
+static size_t fl_xfer_span(const LogDownloadSM_t *sm, size_t *off)
+{
+    size_t head = MAINT_ARENA_SIZE;  /* start of the first live tenant */
+    size_t end = 0U;                 /* end of the last live tenant */
+    size_t span = 0U;
+
+    if (NULL != sm->agg) {
+        head = LOG_STREAM_AGG_OFF;
+        end = LOG_STREAM_AGG_OFF + sizeof(FlashLogAggregator_t);
+    }
+    if (NULL != sm->filter) {
+        head = LOG_STREAM_FILTER_OFF;
+        end = MAX(end, LOG_STREAM_FILTER_OFF + sizeof(FlashLogFilterScratch_t));
+    }
+    if (NULL != sm->lz) {
+        head = 0U;
+        end = MAX(end, sizeof(FlashLogLz_t));
+    }
+    end = ROUND_UP(end, sizeof(uint64_t));
+
+    if ((MAINT_ARENA_SIZE - end) >= head) {
+        *off = end;
+        span = MAINT_ARENA_SIZE - end;
+    } else {
+        *off = 0U;
+        span = head;
+    }
+    return span;
+}
+
 static LogDownloadSM_t *fl_sm(void)
 {
     static LogDownloadSM_t sm;
@@ -143,7 +277,7 @@ static LogDownloadSM_t *fl_sm(void)
  * SAFETY: the writer MUST resume even if the client abandons the stream. Log
  * download runs in the DEFAULT session, so the OTA-style S3/dive session-lapse
  * abort never fires here — instead fl_maybe_abort_stale() (driven by
- * UDS_LogDownload_Poll from the divecan_rx loop) resumes logging if no 0x36
+ * UDS_LogDownload_Poll from the UDS worker's housekeeping) resumes logging if no 0x36
  * arrives for LOG_STREAM_INACTIVITY_MS. Every transition OUT of LD_STREAMING
  * goes through fl_stop_streaming() so neither release can be missed. The
  * exclusive LOG_STREAM arena claim also holds off periodic histogram NVS
@@ -161,7 +295,8 @@ static bool fl_start_streaming(void)
 {
     LogDownloadSM_t *sm = fl_sm();
 
-    if (NULL == maint_arena_claim(MAINT_ARENA_OWNER_LOG_STREAM)) {
+    sm->arena = maint_arena_claim(MAINT_ARENA_OWNER_LOG_STREAM);
+    if (NULL == sm->arena) {
         return false;
     }
     flash_log_pause();
@@ -182,8 +317,17 @@ static void fl_stop_streaming(LogDownloadState_t next_state)
     if (sm->state == LD_STREAMING) {
         flash_log_resume();
         UDS_LogPush_SetSuspended(false);
+        if (NULL != sm->xfer_buf) {
+            /* An extended block still on its way out reads the arena. */
+            ISOTP_TxQueue_AbortExternal();
+        }
         maint_arena_release(MAINT_ARENA_OWNER_LOG_STREAM);
     }
+    sm->arena = NULL;
+    sm->xfer_buf = NULL;
+    sm->lz = NULL;
+    sm->filter = NULL;
+    sm->agg = NULL;
     sm->state = next_state;
 }
 
@@ -267,19 +411,162 @@ void UDS_LogDownload_FillSelectorResult(uint8_t *buf, size_t buf_size)
     }
 }
 
+/* ---- Resume token ----
+ *
+ * A raw stream (no LZ body, no type filter, no time window) can be picked up
+ * where it broke off instead of downloaded again. Before building each block
+ * the 0x36 handler checkpoints the reader along with the body bytes already
+ * sent: the client asked for that block, so it holds every byte before it.
+ * The checkpoint outlives an aborted stream and reads back as this token. A
+ * head reboot drops it, and a sector the writer recycles in between turns it
+ * stale (the resume selector then fails), so the client falls back to a
+ * fresh download.
+ *
+ * Layout (all LE): stream u8, version u8, position u8 (FlashLogResumeAt_t),
+ * flags u8, sector index u16, sector id u16, entry offset u32, bytes of the
+ * entry emitted u32, end sector index u16, end sector id u16, end entry
+ * offset u32, body offset u32. */
+static const uint8_t LOG_RESUME_VERSION = 0x01U;
+/* Token flags bit 0: the range ends at the end sector fields. */
+static const uint8_t LOG_RESUME_FLAG_BOUNDED = 0x01U;
+static const size_t RES_STREAM_IDX      = 0U;
+static const size_t RES_VERSION_IDX     = 1U;
+static const size_t RES_AT_IDX          = 2U;
+static const size_t RES_FLAGS_IDX       = 3U;
+static const size_t RES_SECTOR_IDX_IDX  = 4U;
+static const size_t RES_SECTOR_ID_IDX   = 6U;
+static const size_t RES_ELEM_OFF_IDX    = 8U;
+static const size_t RES_EMIT_OFF_IDX    = 12U;
+static const size_t RES_END_IDX_IDX     = 16U;
+static const size_t RES_END_ID_IDX      = 18U;
+static const size_t RES_END_OFF_IDX     = 20U;
+static const size_t RES_BODY_OFF_IDX    = 24U;
+
+/* Store the low @p n bytes of @p v little-endian at @p p. */
+static void fl_put_le(uint8_t *p, uint32_t v, size_t n)
+{
+    for (size_t i = 0U; i < n; ++i) {
+        p[i] = (uint8_t)((v >> (BYTE_SHIFT_8 * i)) & BYTE_MASK);
+    }
+}
+
+/* Little-endian value of @p n (<= 4) bytes at @p p. */
+static uint32_t fl_get_le(const uint8_t *p, size_t n)
+{
+    uint32_t v = 0U;
+
+    for (size_t i = n; i > 0U; --i) {
+        v = (v << BYTE_SHIFT_8) | (uint32_t)p[i - 1U];
+    }
+    return v;
+}
+
+bool UDS_LogDownload_FillResumeToken(uint8_t *buf, size_t buf_size)
+{
+    const LogDownloadSM_t *sm = fl_sm();
+    const FlashLogResumePoint_t *p = &sm->checkpoint;
+    bool filled = false;
+
+    if ((buf != NULL) && (buf_size >= UDS_LOG_RESUME_TOKEN_LEN) &&
+        sm->checkpoint_valid) {
+        buf[RES_STREAM_IDX] = (uint8_t)p->dest;
+        buf[RES_VERSION_IDX] = LOG_RESUME_VERSION;
+        buf[RES_AT_IDX] = (uint8_t)p->at;
+        buf[RES_FLAGS_IDX] = p->bounded ? LOG_RESUME_FLAG_BOUNDED : 0U;
+        fl_put_le(&buf[RES_SECTOR_IDX_IDX], p->sector_idx, BYTES_PER_U16);
+        fl_put_le(&buf[RES_SECTOR_ID_IDX], p->sector_id, BYTES_PER_U16);
+        fl_put_le(&buf[RES_ELEM_OFF_IDX], p->elem_off, BYTES_PER_U32);
+        fl_put_le(&buf[RES_EMIT_OFF_IDX], p->emit_off, BYTES_PER_U32);
+        fl_put_le(&buf[RES_END_IDX_IDX], p->end_idx, BYTES_PER_U16);
+        fl_put_le(&buf[RES_END_ID_IDX], p->end_id, BYTES_PER_U16);
+        fl_put_le(&buf[RES_END_OFF_IDX], p->end_elem_off, BYTES_PER_U32);
+        fl_put_le(&buf[RES_BODY_OFF_IDX], sm->checkpoint_body, BYTES_PER_U32);
+        filled = true;
+    }
+    return filled;
+}
+
+/**
+ * @brief Checkpoint the stream ahead of the block about to be built.
+ *
+ * Only a raw body maps byte for byte onto reader output; the reader itself
+ * refuses a filtered or windowed cursor.
+ */
+static void fl_take_checkpoint(LogDownloadSM_t *sm)
+{
+    sm->checkpoint_valid = (NULL == sm->lz) &&
+        (0 == flash_log_reader_checkpoint(&sm->reader, &sm->checkpoint));
+    sm->checkpoint_body = sm->body_sent;
+}
+
+/**
+ * @brief Resolve a RID_SELECT_RESUME token into the resumed selection.
+ *
+ * The reader is opened at the token once here to validate it, and again at
+ * BeginStream, since the writer runs until then.
+ *
+ * @return 0 on success, -EINVAL for a malformed token, -ESTALE when the
+ *         ring has moved past it.
+ */
+static Status_t fl_select_resume(const uint8_t *token)
+{
+    LogDownloadSM_t *sm = fl_sm();
+    FlashLogResumePoint_t *p = &sm->resume_point;
+    Status_t rc = 0;
+
+    (void)memset(p, 0, sizeof(*p));
+    p->dest = (FlashLogDest_t)token[RES_STREAM_IDX];
+    p->at = (FlashLogResumeAt_t)token[RES_AT_IDX];
+    p->bounded = (0U != (token[RES_FLAGS_IDX] & LOG_RESUME_FLAG_BOUNDED));
+    p->sector_idx = (uint16_t)fl_get_le(&token[RES_SECTOR_IDX_IDX], BYTES_PER_U16);
+    p->sector_id = (uint16_t)fl_get_le(&token[RES_SECTOR_ID_IDX], BYTES_PER_U16);
+    p->elem_off = fl_get_le(&token[RES_ELEM_OFF_IDX], BYTES_PER_U32);
+    p->emit_off = fl_get_le(&token[RES_EMIT_OFF_IDX], BYTES_PER_U32);
+    p->end_idx = (uint16_t)fl_get_le(&token[RES_END_IDX_IDX], BYTES_PER_U16);
+    p->end_id = (uint16_t)fl_get_le(&token[RES_END_ID_IDX], BYTES_PER_U16);
+    p->end_elem_off = fl_get_le(&token[RES_END_OFF_IDX], BYTES_PER_U32);
+    sm->resume_body = fl_get_le(&token[RES_BODY_OFF_IDX], BYTES_PER_U32);
+
+    if (LOG_RESUME_VERSION != token[RES_VERSION_IDX]) {
+        rc = -EINVAL;
+    } else {
+        rc = flash_log_reader_resume(&sm->reader, p);
+    }
+
+    if (0 == rc) {
+        sm->range = sm->reader.range;
+        sm->resuming = true;
+    }
+    return rc;
+}
+
 /* ---- Selector resolution ---- */
 
 /* Minimum selector-payload lengths (stream byte + RID-specific params). */
 static const uint16_t LOG_SELECT_BOOT_MIN_LEN = 5U;
 static const uint16_t LOG_SELECT_DIVE_MIN_LEN = 3U;
+/* By-range: stream u8 + boot_id u32 + start_us u64 + end_us u64, all LE. */
+static const uint16_t LOG_SELECT_RANGE_MIN_LEN = 21U;
+static const size_t   LOG_SELECT_RANGE_START_IDX = 5U;
+static const size_t   LOG_SELECT_RANGE_END_IDX = 13U;
+/* BeginStream payload: none, the record-type mask (u64 LE), or the mask
+ * followed by the decimation bucket in seconds (u16 LE, 1..1 h). */
+static const uint16_t LOG_BEGIN_FILTER_LEN = 8U;
+static const uint16_t LOG_BEGIN_DECIMATE_LEN = 10U;
+static const uint16_t LOG_DECIMATE_MAX_S = 3600U;
+static const uint32_t LOG_DECIMATE_US_PER_S = 1000000U;
+/* Live-tail payload: the record-type mask (u64 LE; 0 ends the subscription),
+ * optionally followed by the byte budget per second (u16 LE; 0 = default). */
+static const uint16_t LOG_TAIL_MASK_LEN = 8U;
+static const uint16_t LOG_TAIL_BUDGET_LEN = 10U;
 
 /* ---- Async selector resolution ----
  *
- * The four index-backed selectors (latest boot/dive, by boot/dive) need a
+ * The index-backed selectors (latest boot/dive, by boot/dive, by range) need a
  * full-ring FCB index build the first time the index is cold. On a populated
  * telemetry ring that walk runs well past the DiveCAN client's response
- * timeout AND, run inline, would block the divecan_rx thread (which must keep
- * servicing the bus) for its whole duration. So the walk runs on this
+ * timeout AND, run inline, would block the UDS worker (and every other
+ * diagnostic request behind it) for its whole duration. So the walk runs on this
  * dedicated, lower-priority worker thread: the RoutineControl handler kicks
  * the worker and answers 0x21 busyRepeatRequest until the worker publishes a
  * result, which the client polls for by re-issuing the identical selector.
@@ -316,6 +603,17 @@ static struct k_mutex *fl_resolve_lock(void)
 #define FL_RESOLVE_RETRY_MS  100U
 #define FL_RESOLVE_MAX_TRIES 300U   /* ~30 s worst-case wait for the arena */
 
+/* Little-endian u64 at @p p. */
+static uint64_t fl_get_le64(const uint8_t *p)
+{
+    uint64_t v = 0U;
+
+    for (size_t i = BYTES_PER_U64; i > 0U; --i) {
+        v = (v << BYTE_SHIFT_8) | (uint64_t)p[i - 1U];
+    }
+    return v;
+}
+
 /* Parse the selector payload and call the matching (synchronous) reader
  * resolver. Runs on the worker thread only. */
 static Status_t fl_call_resolver(uint16_t rid, const uint8_t *params,
@@ -341,6 +639,16 @@ static Status_t fl_call_resolver(uint16_t rid, const uint8_t *params,
                    (uint16_t)((uint16_t)params[2] << BYTE_SHIFT_8));
 
         rc = flash_log_reader_resolve_dive_id(stream, dive_id, range);
+    } else if (rid == RID_SELECT_BY_RANGE) {
+        uint32_t boot_id =
+            (uint32_t)params[1] |
+            ((uint32_t)params[2] << BYTE_SHIFT_8) |
+            ((uint32_t)params[3] << BYTE_SHIFT_16) |
+            ((uint32_t)params[4] << BYTE_SHIFT_24);
+
+        rc = flash_log_reader_resolve_time_range(
+            stream, boot_id, fl_get_le64(&params[LOG_SELECT_RANGE_START_IDX]),
+            fl_get_le64(&params[LOG_SELECT_RANGE_END_IDX]), range);
     } else {
         rc = -EINVAL;
     }
@@ -428,8 +736,8 @@ static void fl_resolve_worker(void *a, void *b, void *c)
  * ~100 % RAM-allocated (a 2048 B stack overflowed `noinit` by 960 B), so this
  * cannot grow without reclaiming RAM elsewhere. Per CLAUDE.md's stack rule,
  * confirm the runtime high-water mark (CONFIG_THREAD_ANALYZER) on hardware
- * before trusting this near a boundary. Priority 10: below divecan_rx (5) so
- * bus servicing always preempts the walk, above the watchdog feeder (14). */
+ * before trusting this near a boundary. Priority 10: below divecan_rx (5) and the
+ * UDS worker (7) so bus servicing always preempts the walk, above the watchdog feeder (14). */
 K_THREAD_DEFINE(fl_resolve_worker_tid, 1024, fl_resolve_worker,
         NULL, NULL, NULL, 10, 0, 0);
 
@@ -477,7 +785,7 @@ static uint8_t fl_finish_selector(FlashLogDest_t stream, Status_t rc)
 /* Kick/poll the async worker for one index-backed selector. Returns
  * busyRepeatRequest while the worker is running and, once it publishes,
  * consumes the result via fl_finish_selector (sm->range is already populated).
- * Runs on the divecan_rx thread. */
+ * Runs on the UDS worker. */
 static uint8_t fl_async_selector(uint16_t rid, const uint8_t *data,
                  uint16_t data_len, FlashLogDest_t stream)
 {
@@ -538,6 +846,13 @@ static uint8_t fl_resolve_selector(uint16_t rid, const uint8_t *data,
             Status_t rc = flash_log_reader_resolve_all(stream, &sm->range);
 
             nrc = fl_finish_selector(stream, rc);
+        } else if (rid == RID_SELECT_RESUME) {
+            /* Index-free as well: the token names its sectors directly. */
+            if (data_len != UDS_LOG_RESUME_TOKEN_LEN) {
+                nrc = UDS_NRC_INCORRECT_MSG_LEN;
+            } else {
+                nrc = fl_finish_selector(stream, fl_select_resume(data));
+            }
         } else if (!flash_log_boot_marker_flushed()) {
             /* Index-backed selectors must not walk a ring the current boot
              * has not stamped yet: a resolve racing flash_log_init (or the
@@ -559,13 +874,18 @@ static uint8_t fl_resolve_selector(uint16_t rid, const uint8_t *data,
             } else {
                 nrc = fl_async_selector(rid, data, data_len, stream);
             }
+        } else if (rid == RID_SELECT_BY_RANGE) {
+            if (data_len < LOG_SELECT_RANGE_MIN_LEN) {
+                nrc = UDS_NRC_INCORRECT_MSG_LEN;
+            } else {
+                nrc = fl_async_selector(rid, data, data_len, stream);
+            }
         } else if ((rid == RID_SELECT_LATEST_BOOT) ||
                (rid == RID_SELECT_LATEST_DIVE)) {
             nrc = fl_async_selector(rid, data, data_len, stream);
         } else {
-            /* RID_SELECT_BY_RANGE (explicit fcb-id pairs are unimplemented —
-             * exposing fcb_entry internals to the wire is fragile) and any
-             * other in-range RID map to out-of-range via -ENOTSUP. */
+            /* No other RID in the selector block — out of range via
+             * -ENOTSUP. */
             nrc = fl_finish_selector(stream, -ENOTSUP);
         }
     }
@@ -578,34 +898,140 @@ static uint8_t fl_resolve_selector(uint16_t rid, const uint8_t *data,
 /* Run one start-routine RID: BeginStream arms the transfer, a selector RID
  * resolves a new range (superseding any live stream). Returns 0 on success,
  * else the NRC to answer with. */
+/* Decimation bucket of a BeginStream payload, in seconds (0 = none). */
+static uint16_t fl_begin_bucket_s(const uint8_t *params, uint16_t params_len)
+{
+    uint16_t bucket_s = 0U;
+
+    if (LOG_BEGIN_DECIMATE_LEN == params_len) {
+        bucket_s = (uint16_t)((uint16_t)params[LOG_BEGIN_FILTER_LEN] |
+                              ((uint16_t)params[LOG_BEGIN_FILTER_LEN + 1U]
+                               << BYTE_SHIFT_8));
+    }
+    return bucket_s;
+}
+
+/**
+ * @brief Open the reader for the selected range, filtered when BeginStream
+ *        carried a type mask and decimated when it carried a bucket too.
+ *
+ * The filter scratch and aggregator go in the stream's arena claim, behind
+ * the space a compressed 0x34 will use. A resumed selection reopens the
+ * reader at its token instead, and its body offsets carry on from there.
+ *
+ * @return 0, or the flash_log_reader_resume() error of a resumed selection.
+ */
+static Status_t fl_open_stream(const uint8_t *params, uint16_t params_len)
+{
+    LogDownloadSM_t *sm = fl_sm();
+    uint16_t bucket_s = fl_begin_bucket_s(params, params_len);
+    Status_t rc = 0;
+
+    sm->body_sent = 0U;
+    sm->checkpoint_valid = false;
+    if (sm->resuming) {
+        rc = flash_log_reader_resume(&sm->reader, &sm->resume_point);
+        sm->body_sent = sm->resume_body;
+    } else {
+        flash_log_reader_open(&sm->reader, &sm->range);
+    }
+    sm->header_sent = false;
+    sm->filter = NULL;
+    sm->agg = NULL;
+    if (params_len >= LOG_BEGIN_FILTER_LEN) {
+        maint_arena_mark_scratch(MAINT_ARENA_OWNER_LOG_STREAM);
+        sm->filter = (FlashLogFilterScratch_t *)
+            &((uint8_t *)sm->arena)[LOG_STREAM_FILTER_OFF];
+        sm->type_mask = fl_get_le64(params);
+        (void)flash_log_reader_set_filter(&sm->reader, sm->type_mask,
+                                          sm->filter);
+    }
+    if (0U != bucket_s) {
+        sm->agg = (FlashLogAggregator_t *)
+            &((uint8_t *)sm->arena)[LOG_STREAM_AGG_OFF];
+        (void)flash_log_reader_set_decimation(
+            &sm->reader, (uint32_t)bucket_s * LOG_DECIMATE_US_PER_S, sm->agg);
+    }
+    return rc;
+}
+
+/**
+ * @brief Handle RID_LIVE_TAIL: subscribe, renew or (all-zero mask) end.
+ *
+ * @return 0, or the NRC to answer with
+ */
+static uint8_t fl_live_tail(const uint8_t *params, uint16_t params_len)
+{
+    uint8_t nrc = 0U;
+
+    if ((LOG_TAIL_MASK_LEN != params_len) && (LOG_TAIL_BUDGET_LEN != params_len)) {
+        nrc = UDS_NRC_INCORRECT_MSG_LEN;
+    } else {
+        uint64_t mask = fl_get_le64(params);
+        uint16_t budget = 0U;
+
+        if (LOG_TAIL_BUDGET_LEN == params_len) {
+            budget = (uint16_t)((uint16_t)params[LOG_TAIL_MASK_LEN] |
+                                ((uint16_t)params[LOG_TAIL_MASK_LEN + 1U]
+                                 << BYTE_SHIFT_8));
+        }
+        if (0U == mask) {
+            flash_log_tail_unsubscribe();
+        } else if (0 != flash_log_tail_subscribe(mask, budget,
+                                                 k_uptime_get_32())) {
+            nrc = UDS_NRC_REQUEST_OUT_OF_RANGE;
+        } else {
+            /* No action required — subscribed */
+        }
+    }
+    return nrc;
+}
+
 static uint8_t fl_start_routine(uint16_t rid, const uint8_t *request_data,
                 uint16_t request_length)
 {
     LogDownloadSM_t *sm = fl_sm();
     uint8_t nrc = 0U;
+    const uint8_t *params = &request_data[UDS_SID_IDX + 4U];
+    uint16_t params_len = 0U;
+
+    if (request_length > ROUTINE_CONTROL_MIN_REQ_LEN) {
+        params_len = (uint16_t)(request_length - ROUTINE_CONTROL_MIN_REQ_LEN);
+    }
 
     if (rid == RID_BEGIN_STREAM) {
-        if (sm->state != LD_SELECTED) {
+        uint16_t bucket_s = fl_begin_bucket_s(params, params_len);
+
+        if ((0U != params_len) && (LOG_BEGIN_FILTER_LEN != params_len) &&
+            (LOG_BEGIN_DECIMATE_LEN != params_len)) {
+            nrc = UDS_NRC_INCORRECT_MSG_LEN;
+        } else if ((LOG_BEGIN_DECIMATE_LEN == params_len) &&
+                   ((0U == bucket_s) || (bucket_s > LOG_DECIMATE_MAX_S))) {
+            nrc = UDS_NRC_REQUEST_OUT_OF_RANGE;
+        } else if (sm->state != LD_SELECTED) {
             nrc = UDS_NRC_REQUEST_SEQUENCE_ERR;
+        } else if (sm->resuming && (0U != params_len)) {
+            /* The resumed body must continue the raw stream it came from. */
+            nrc = UDS_NRC_REQUEST_OUT_OF_RANGE;
         } else if (!fl_start_streaming()) {
             nrc = UDS_NRC_CONDITIONS_NOT_CORRECT;
+        } else if (0 != fl_open_stream(params, params_len)) {
+            /* The writer recycled a sector of the token since the select. */
+            fl_stop_streaming(LD_IDLE);
+            nrc = UDS_NRC_CONDITIONS_NOT_CORRECT;
         } else {
-            flash_log_reader_open(&sm->reader, &sm->range);
-            sm->header_sent = false;
+            /* No action required — streaming */
         }
     } else if ((rid >= RID_SELECT_BY_RANGE) &&
-           (rid <= RID_SELECT_ALL)) {
+           (rid <= RID_SELECT_RESUME)) {
         /* A fresh selector supersedes any live stream — resume the
          * writer before re-resolving (the resolve below sets
          * LD_SELECTED). */
-        const uint8_t *params = &request_data[UDS_SID_IDX + 4U];
-        uint16_t params_len = 0U;
-
         fl_stop_streaming(LD_IDLE);
-        if (request_length > ROUTINE_CONTROL_MIN_REQ_LEN) {
-            params_len = (uint16_t)(request_length - ROUTINE_CONTROL_MIN_REQ_LEN);
-        }
+        sm->resuming = false;
         nrc = fl_resolve_selector(rid, params, params_len);
+    } else if (rid == RID_LIVE_TAIL) {
+        nrc = fl_live_tail(params, params_len);
     } else {
         nrc = UDS_NRC_REQUEST_OUT_OF_RANGE;
     }
@@ -694,11 +1120,36 @@ static void fl_handle_request_download(UDSContext_t *ctx,
     } else if (request_data[LOG_DOWNLOAD_ADDR_LEN_FMT_IDX] != LOG_DOWNLOAD_ADDR_LEN_FMT) {
         UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_DOWNLOAD,
                      UDS_NRC_REQUEST_OUT_OF_RANGE);
+    } else if ((request_data[LOG_DOWNLOAD_DATA_FMT_IDX] != LOG_DOWNLOAD_DATA_FMT_RAW) &&
+           (request_data[LOG_DOWNLOAD_DATA_FMT_IDX] != LOG_DOWNLOAD_DATA_FMT_LZ)) {
+        UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_DOWNLOAD,
+                     UDS_NRC_REQUEST_OUT_OF_RANGE);
+    } else if ((request_data[LOG_DOWNLOAD_DATA_FMT_IDX] == LOG_DOWNLOAD_DATA_FMT_LZ) &&
+           (NULL == fl_sm()->arena)) {
+        /* The compressor lives in the arena the stream claimed at 0xF105. */
+        UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_DOWNLOAD,
+                     UDS_NRC_CONDITIONS_NOT_CORRECT);
     } else {
         LogDownloadSM_t *sm = fl_sm();
 
-        /* Block size = UDS_MAX_RESPONSE_LENGTH minus 0x36 response framing
-         * (pad + SID + seq = 3 B) so the body fits a single ISO-TP message.
+        if (NULL != sm->xfer_buf) {
+            /* A re-sent 0x34 reuses the arena; drop the last block first. */
+            ISOTP_TxQueue_AbortExternal();
+            sm->xfer_buf = NULL;
+        }
+        sm->next_seq = 0x01U;
+        sm->header_sent = false;
+        sm->lz = NULL;
+        if (request_data[LOG_DOWNLOAD_DATA_FMT_IDX] == LOG_DOWNLOAD_DATA_FMT_LZ) {
+            /* First scratch use of the stream's reservation: any log-index
+             * cache in the arena is about to be overwritten. */
+            maint_arena_mark_scratch(MAINT_ARENA_OWNER_LOG_STREAM);
+            sm->lz = (FlashLogLz_t *)sm->arena;
+            flash_log_lz_init(sm->lz);
+        }
+
+        /* Block size = LOG_DOWNLOAD_STD_BLOCK so the body fits a single
+         * ISO-TP message.
          *
          * The request's SIZE field (historically unused zeros for the log
          * sentinel) is the CLIENT's maximum receivable block, little-endian to
@@ -708,13 +1159,31 @@ static void fl_handle_request_download(UDSContext_t *ctx,
          * overflow" on the handset display), so a BT client must be able to ask
          * for chunks its bridge can reassemble. 0 keeps the full size (existing
          * clients unchanged); nonzero requests below the floor are raised to it
-         * (the 16-byte stream header must fit the first chunk with headroom). */
-        uint16_t cap = UDS_MAX_RESPONSE_LENGTH - 3U;
+         * (the 16-byte stream header must fit the first chunk with headroom).
+         * A request ABOVE the full size comes from a client that reassembles
+         * extended-length ISO-TP itself (direct CAN): its blocks are built in
+         * the free part of the arena instead, up to that span or the 12-bit
+         * FF limit. Either size is capped while this peer's link has been
+         * dropping frames (isotp_link.h), so a lossy path gets short chunks
+         * without the client having to know. */
+        uint16_t full = LOG_DOWNLOAD_STD_BLOCK;
+        size_t xfer_off = 0U;
         uint32_t req_max = ((uint32_t)request_data[8]) |
                    ((uint32_t)request_data[9] << BYTE_SHIFT_8) |
                    ((uint32_t)request_data[10] << BYTE_SHIFT_16) |
                    ((uint32_t)request_data[11] << BYTE_SHIFT_24);
 
+        if ((req_max > (uint32_t)LOG_DOWNLOAD_STD_BLOCK) && (NULL != sm->arena)) {
+            size_t span = fl_xfer_span(sm, &xfer_off);
+
+            if (span > (LOG_TRANSFER_RESP_HDR_LEN + LOG_DOWNLOAD_STD_BLOCK)) {
+                full = (uint16_t)MIN(span - LOG_TRANSFER_RESP_HDR_LEN,
+                             (size_t)LOG_DOWNLOAD_EXT_MAX_BLOCK);
+            }
+        }
+
+        uint16_t cap = ISOTP_Link_BlockLimit(ctx->reply, full);
+
         if ((req_max != 0U) && (req_max < (uint32_t)cap)) {
             if (req_max < LOG_DOWNLOAD_MIN_BLOCK) {
                 sm->max_block_length = LOG_DOWNLOAD_MIN_BLOCK;
@@ -724,8 +1193,10 @@ static void fl_handle_request_download(UDSContext_t *ctx,
         } else {
             sm->max_block_length = cap;
         }
-        sm->next_seq = 0x01U;
-        sm->header_sent = false;
+        if (sm->max_block_length > LOG_DOWNLOAD_STD_BLOCK) {
+            maint_arena_mark_scratch(MAINT_ARENA_OWNER_LOG_STREAM);
+            sm->xfer_buf = &((uint8_t *)sm->arena)[xfer_off];
+        }
 
         /* 0x34 positive response: [pad][SID+0x40][lengthFmt][maxBlock_hi][maxBlock_lo] */
         ctx->response_buffer[UDS_PAD_IDX] =
@@ -751,7 +1222,7 @@ static const size_t HDR_MAGIC_B3_IDX       = 3U;
 static const size_t HDR_VERSION_IDX        = 4U;
 static const size_t HDR_FLAGS_IDX          = 5U;
 static const size_t HDR_STREAM_IDX         = 6U;
-static const size_t HDR_RESERVED_IDX       = 7U;
+static const size_t HDR_CODEC_IDX          = 7U;
 static const size_t HDR_TOTAL_BYTES_B0_IDX = 8U;
 static const size_t HDR_TOTAL_BYTES_B1_IDX = 9U;
 static const size_t HDR_TOTAL_BYTES_B2_IDX = 10U;
@@ -761,6 +1232,17 @@ static const size_t HDR_ENTRY_CNT_B1_IDX   = 13U;
 static const size_t HDR_ENTRY_CNT_B2_IDX   = 14U;
 static const size_t HDR_ENTRY_CNT_B3_IDX   = 15U;
 
+/* Stream header length, including the filter mask that follows it. */
+static size_t fl_header_len(const LogDownloadSM_t *sm)
+{
+    size_t len = LOG_HEADER_BYTES;
+
+    if (NULL != sm->filter) {
+        len += LOG_HEADER_MASK_BYTES;
+    }
+    return len;
+}
+
 static size_t fl_build_header(uint8_t *buf)
 {
     const LogDownloadSM_t *sm = fl_sm();
@@ -772,9 +1254,13 @@ static size_t fl_build_header(uint8_t *buf)
     buf[HDR_MAGIC_B2_IDX] = (uint8_t)((LOG_HEADER_MAGIC >> BYTE_SHIFT_16) & BYTE_MASK);
     buf[HDR_MAGIC_B3_IDX] = (uint8_t)((LOG_HEADER_MAGIC >> BYTE_SHIFT_24) & BYTE_MASK);
     buf[HDR_VERSION_IDX] = LOG_HEADER_VERSION;
-    buf[HDR_FLAGS_IDX] = 0U;  /* flags */
+    buf[HDR_FLAGS_IDX] = 0U;
+    buf[HDR_CODEC_IDX] = 0U;
+    if (NULL != sm->lz) {
+        buf[HDR_FLAGS_IDX] |= LOG_HEADER_FLAG_LZ;
+        buf[HDR_CODEC_IDX] = FL_LZ_PARAMS;
+    }
     buf[HDR_STREAM_IDX] = stream;
-    buf[HDR_RESERVED_IDX] = 0U;  /* reserved */
     /* total_bytes — unknown without a pre-walk; emit 0 = "streaming" */
     buf[HDR_TOTAL_BYTES_B0_IDX] = 0U;
     buf[HDR_TOTAL_BYTES_B1_IDX] = 0U;
@@ -784,7 +1270,17 @@ static size_t fl_build_header(uint8_t *buf)
     buf[HDR_ENTRY_CNT_B1_IDX] = (uint8_t)((entry_count >> BYTE_SHIFT_8) & BYTE_MASK);
     buf[HDR_ENTRY_CNT_B2_IDX] = (uint8_t)((entry_count >> BYTE_SHIFT_16) & BYTE_MASK);
     buf[HDR_ENTRY_CNT_B3_IDX] = (uint8_t)((entry_count >> BYTE_SHIFT_24) & BYTE_MASK);
-    return LOG_HEADER_BYTES;
+    if (NULL != sm->filter) {
+        buf[HDR_FLAGS_IDX] |= LOG_HEADER_FLAG_FILTERED;
+        for (size_t b = 0U; b < LOG_HEADER_MASK_BYTES; ++b) {
+            buf[LOG_HEADER_BYTES + b] =
+                (uint8_t)((sm->type_mask >> (BYTE_SHIFT_8 * b)) & BYTE_MASK);
+        }
+    }
+    if (NULL != sm->agg) {
+        buf[HDR_FLAGS_IDX] |= LOG_HEADER_FLAG_DECIMATED;
+    }
+    return fl_header_len(sm);
 }
 
 /**
@@ -806,7 +1302,7 @@ static bool fl_prime_header(LogDownloadSM_t *sm, uint8_t *out, size_t cap,
     bool fail = false;
 
     if (!sm->header_sent) {
-        if (cap < LOG_HEADER_BYTES) {
+        if (cap < fl_header_len(sm)) {
             fail = true;
         } else {
             *used = fl_build_header(out);
@@ -856,6 +1352,55 @@ static bool fl_fill_chunk_body(FlashLogReader_t *reader, uint8_t *out,
     return fail;
 }
 
+/**
+ * @brief Fill the chunk buffer with compressed reader output.
+ *
+ * Alternates between draining the compressor into @p out and topping up its
+ * lookahead from the reader, until the chunk is full or the range is
+ * exhausted and the compressor has flushed its final byte. A chunk may end a
+ * byte or two short of @p cap (the next item might not fit); only a chunk
+ * with nothing left to send is empty, so the raw path's empty-terminator
+ * contract still holds.
+ *
+ * @param reader Flash-log reader positioned at the next entry
+ * @param lz     Compressor state (in the maintenance arena)
+ * @param out    Chunk buffer (compressed bytes appended starting at *used)
+ * @param cap    Total chunk buffer capacity
+ * @param used   In/out: bytes already used in @p out; advanced by this call
+ * @return true on a hard read failure (caller should fail the chunk), false otherwise
+ */
+static bool fl_fill_chunk_compressed(FlashLogReader_t *reader, FlashLogLz_t *lz,
+                     uint8_t *out, size_t cap, size_t *used)
+{
+    bool fail = false;
+    bool progress = true;
+
+    while ((!fail) && progress && (*used < cap)) {
+        size_t produced = flash_log_lz_poll(lz, &out[*used], cap - *used);
+
+        *used += produced;
+        progress = (produced > 0U);
+
+        if (flash_log_lz_wants_input(lz)) {
+            uint8_t *dst = NULL;
+            size_t space = flash_log_lz_sink(lz, &dst);
+            Status_t rc = flash_log_reader_next(reader, dst, space);
+
+            if (rc > 0) {
+                flash_log_lz_commit(lz, (size_t)rc);
+            } else if (0 == rc) {
+                /* Range exhausted — the next poll flushes the tail. */
+                flash_log_lz_finish(lz);
+            } else {
+                fail = true;
+            }
+            progress = true;
+        }
+    }
+
+    return fail;
+}
+
 static void fl_handle_transfer_data(UDSContext_t *ctx,
                     const uint8_t *request_data,
                     uint16_t request_length)
@@ -871,35 +1416,64 @@ static void fl_handle_transfer_data(UDSContext_t *ctx,
         if (seq != sm->next_seq) {
             UDS_SendNegativeResponse(ctx, UDS_SID_TRANSFER_DATA,
                          UDS_NRC_WRONG_BLOCK_SEQ_COUNTER);
+        } else if ((NULL != sm->xfer_buf) && ISOTP_TxQueue_ExternalPending()) {
+            /* The previous extended block is still being sent from xfer_buf
+             * (a client that timed out and asked again). */
+            UDS_SendNegativeResponse(ctx, UDS_SID_TRANSFER_DATA,
+                         UDS_NRC_BUSY_REPEAT_REQUEST);
         } else {
             /* Build the chunk body immediately after the [SID][seq] response
              * header. The DiveCAN pad byte is prepended by the ISO-TP TX
              * layer, not stored in response_buffer, so the body starts at
              * index 2 — writing it at index 3 would leave a stale byte at
              * index 2 and truncate the final body byte (response_length
-             * counts from index 0), corrupting one byte per chunk. */
-            uint8_t *out = &ctx->response_buffer[LOG_TRANSFER_RESP_HDR_LEN];
+             * counts from index 0), corrupting one byte per chunk. An
+             * extended block uses the same layout in xfer_buf. */
+            uint8_t *resp = ctx->response_buffer;
+            if (NULL != sm->xfer_buf) {
+                resp = sm->xfer_buf;
+            }
+            uint8_t *out = &resp[LOG_TRANSFER_RESP_HDR_LEN];
             size_t cap = (size_t)sm->max_block_length;
             size_t used = 0U;
+            size_t body_start = 0U;
             bool fail = false;
 
             *fl_stream_activity_ms() = k_uptime_get_32();   /* stall-abort watchdog */
 
+            fl_take_checkpoint(sm);
             fail = fl_prime_header(sm, out, cap, &used);
+            body_start = used;
 
-            if (!fail) {
+            if (fail) {
+                /* No action required — header did not fit. */
+            } else if (NULL != sm->lz) {
+                fail = fl_fill_chunk_compressed(&sm->reader, sm->lz, out, cap,
+                                &used);
+            } else {
                 fail = fl_fill_chunk_body(&sm->reader, out, cap, &used);
             }
 
             if (fail) {
+                /* Rewind a raw stream to the checkpoint, so a retried block
+                 * re-reads what this one lost. */
+                if (sm->checkpoint_valid) {
+                    (void)flash_log_reader_resume(&sm->reader, &sm->checkpoint);
+                }
                 UDS_SendNegativeResponse(ctx, UDS_SID_TRANSFER_DATA,
                              UDS_NRC_GENERAL_PROG_FAIL);
             } else {
-                ctx->response_buffer[UDS_PAD_IDX] =
+                sm->body_sent += (uint32_t)(used - body_start);
+                resp[UDS_PAD_IDX] =
                     UDS_SID_TRANSFER_DATA + UDS_RESPONSE_SID_OFFSET;
-                ctx->response_buffer[UDS_SID_IDX] = seq;
-                ctx->response_length = (uint16_t)(LOG_TRANSFER_RESP_HDR_LEN + used);
-                UDS_SendResponse(ctx);
+                resp[UDS_SID_IDX] = seq;
+                if (NULL != sm->xfer_buf) {
+                    (void)ISOTP_ReplyExternal(ctx->reply, resp,
+                                  (uint16_t)(LOG_TRANSFER_RESP_HDR_LEN + used));
+                } else {
+                    ctx->response_length = (uint16_t)(LOG_TRANSFER_RESP_HDR_LEN + used);
+                    UDS_SendResponse(ctx);
+                }
 
                 sm->next_seq += 1U;
                 if (0U == sm->next_seq) {
@@ -3,7 +3,8 @@
  * @brief UDS log message push implementation
  *
  * Implements push-based log streaming from Head to bluetooth client.
- * Uses a k_msgq to avoid blocking calling tasks.
+ * Uses a k_msgq to avoid blocking calling tasks. Live-tail records (queued by
+ * flash_log_tail.c) share the push context and alternate with the text.
  */
 
 #include <zephyr/kernel.h>
@@ -16,6 +17,9 @@
 #include "isotp_tx_queue.h"
 #include "divecan_types.h"
 #include "errors.h"
+#ifdef CONFIG_FLASH_LOG
+#include "flash_log_tail.h"
+#endif
 
 LOG_MODULE_REGISTER(uds_log_push, LOG_LEVEL_INF);
 
@@ -58,6 +62,7 @@ typedef struct {
     bool tx_pending;
     bool in_send_log_message;  /* Reentrancy guard */
     bool suspended;         /* Set while a large UDS transfer owns the bridge */
+    bool tail_turn;         /* Next send offers the live tail first */
     uint32_t last_dialog_activity_ms; /* k_uptime of last addressed-dialog activity */
     uint8_t tx_buffer[UDS_LOG_MAX_PAYLOAD + WDBI_HEADER_SIZE];
 } LogPushState_t;
@@ -196,6 +201,19 @@ bool UDS_LogPush_SendLogMessage(const char *message, uint16_t length)
     return result;
 }
 
+/**
+ * @brief Write the WDBI header for @p did into the TX buffer
+ *
+ * @param state Log push module state; must not be NULL
+ * @param did   Pushed data identifier
+ */
+static void putWdbiHeader(LogPushState_t *state, uint16_t did)
+{
+    state->tx_buffer[WDBI_SID_IDX] = UDS_SID_WRITE_DATA_BY_ID;
+    state->tx_buffer[WDBI_DID_HI_IDX] = (uint8_t)(did >> DIVECAN_BYTE_WIDTH);
+    state->tx_buffer[WDBI_DID_LO_IDX] = (uint8_t)(did & DIVECAN_BYTE_MASK);
+}
+
 /**
  * @brief Build a WDBI frame from a queue item and transmit it via ISO-TP
  *
@@ -207,9 +225,7 @@ static bool sendQueuedItem(const UDSLogQueueItem_t *item)
     LogPushState_t *state = getLogPushState();
 
     /* Build WDBI frame: [SID, DID_high, DID_low, data...] */
-    state->tx_buffer[WDBI_SID_IDX] = UDS_SID_WRITE_DATA_BY_ID;
-    state->tx_buffer[WDBI_DID_HI_IDX] = (uint8_t)(UDS_DID_LOG_MESSAGE >> DIVECAN_BYTE_WIDTH);
-    state->tx_buffer[WDBI_DID_LO_IDX] = (uint8_t)(UDS_DID_LOG_MESSAGE & DIVECAN_BYTE_MASK);
+    putWdbiHeader(state, UDS_DID_LOG_MESSAGE);
     (void)memcpy(&state->tx_buffer[WDBI_HEADER_SIZE], item->data, item->length);
 
     bool sent = ISOTP_Send(state->isotp_context,
@@ -219,6 +235,46 @@ static bool sendQueuedItem(const UDSLogQueueItem_t *item)
     return sent;
 }
 
+/**
+ * @brief Dequeue the next text log item and transmit it
+ *
+ * @return true if a message was handed to ISO-TP
+ */
+static bool sendNextText(void)
+{
+    UDSLogQueueItem_t *rx_buffer = getRxItemBuffer();
+
+    return (0 == k_msgq_get(&log_push_msgq, rx_buffer, K_NO_WAIT)) &&
+           sendQueuedItem(rx_buffer);
+}
+
+/**
+ * @brief Pack queued live-tail records into one WDBI push and transmit it
+ *
+ * The records are drained straight into the TX buffer behind the header.
+ *
+ * @param state Log push module state; must not be NULL
+ * @return true if a push was handed to ISO-TP
+ */
+static bool sendNextTail(LogPushState_t *state)
+{
+    bool sent = false;
+#ifdef CONFIG_FLASH_LOG
+    uint16_t length = flash_log_tail_drain(&state->tx_buffer[WDBI_HEADER_SIZE],
+                                           UDS_LOG_MAX_PAYLOAD,
+                                           k_uptime_get_32());
+
+    if (length > 0U) {
+        putWdbiHeader(state, UDS_DID_LOG_TAIL);
+        sent = ISOTP_Send(state->isotp_context, state->tx_buffer,
+                          WDBI_HEADER_SIZE + length);
+    }
+#else
+    (void)state;
+#endif
+    return sent;
+}
+
 /**
  * @brief Check TX completion and update pending state
  *
@@ -259,10 +315,18 @@ static void trySendNextItem(LogPushState_t *state)
                (ISOTP_TxQueue_GetPendingCount() > 0U)) {
         /* TX queue busy, try again on next poll */
     } else {
-        UDSLogQueueItem_t *rx_buffer = getRxItemBuffer();
-        if ((0 == k_msgq_get(&log_push_msgq, rx_buffer, K_NO_WAIT)) &&
-            sendQueuedItem(rx_buffer)) {
+        /* Text and live tail take turns; either goes alone when the other
+         * has nothing queued. */
+        bool tail = state->tail_turn;
+        bool sent = tail ? sendNextTail(state) : sendNextText();
+
+        if (!sent) {
+            tail = !tail;
+            sent = tail ? sendNextTail(state) : sendNextText();
+        }
+        if (sent) {
             state->tx_pending = true;
+            state->tail_turn = !tail;
         }
     }
 }
@@ -283,6 +347,39 @@ void UDS_LogPush_NoteDialogActivity(uint32_t now)
     getLogPushState()->last_dialog_activity_ms = now;
 }
 
+/**
+ * @brief Report when the queued text messages can next be pushed
+ *
+ * @param deadline Receives the uptime (ms) the next push is possible
+ * @return true if messages are queued and a push time is known
+ */
+bool UDS_LogPush_NextDeadline(uint32_t *deadline)
+{
+    bool pending = false;
+    const LogPushState_t *state = getLogPushState();
+    uint32_t now = k_uptime_get_32();
+
+    if (NULL == deadline) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if ((NULL == state->isotp_context) || state->suspended ||
+               (0U == k_msgq_num_used_get(&log_push_msgq))) {
+        /* Nothing queued, or held for a transfer that resumes the push */
+    } else if ((now - state->last_dialog_activity_ms) < LOG_PUSH_QUIESCENT_MS) {
+        *deadline = state->last_dialog_activity_ms + LOG_PUSH_QUIESCENT_MS;
+        pending = true;
+    } else if ((ISOTP_IDLE == state->isotp_context->state) &&
+               (!ISOTP_TxQueue_IsBusy()) &&
+               (0U == ISOTP_TxQueue_GetPendingCount())) {
+        /* Free to send: the next poll pushes one more message */
+        *deadline = now;
+        pending = true;
+    } else {
+        /* Held behind other TX; that transfer's progress wakes the poll */
+    }
+
+    return pending;
+}
+
 void UDS_LogPush_Poll(void)
 {
     LogPushState_t *state = getLogPushState();
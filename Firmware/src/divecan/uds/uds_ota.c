@@ -31,6 +31,7 @@
 #include <zephyr/dfu/flash_img.h>
 #include <zephyr/dfu/mcuboot.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
 #include <string.h>
 
 #include "uds_ota.h"
@@ -39,6 +40,7 @@
 #include "flash_log.h"
 #endif
 #include "isotp.h"
+#include "isotp_link.h"
 #include "uds_log_push.h"
 #include "errors.h"
 #include "common.h"
@@ -48,13 +50,6 @@
 
 LOG_MODULE_REGISTER(uds_ota, LOG_LEVEL_INF);
 
-/* The flash_img context (with its CONFIG_IMG_BLOCK_BUF_SIZE coalescing
- * buffer inside) lives in the shared maintenance arena while an OTA is in
- * flight, instead of as a permanent static. */
-BUILD_ASSERT(sizeof(struct flash_img_context) <= MAINT_ARENA_SIZE,
-             "flash_img_context must fit the maintenance arena "
-             "(did CONFIG_IMG_BLOCK_BUF_SIZE grow?)");
-
 /* ---- Wire-format constants ---- */
 
 /* SID 0x34 request: [pad][SID][dataFmt][addrLenFmt][addr 4 bytes][size 4 bytes]
@@ -100,6 +95,77 @@ static const uint32_t BYTE_SHIFT_8  = 8U;
 static const uint32_t BYTE_SHIFT_16 = 16U;
 static const uint32_t BYTE_SHIFT_24 = 24U;
 
+/* ---- Pipelined slot1 writer ----
+ *
+ * A 0x36 block is copied into one of two staging slots and acknowledged at
+ * once; the ota_writer thread programs the slots into slot1 in arrival order
+ * while the client is already sending the next block, so the NOR program
+ * time (and any wait for the external-flash lock) overlaps bus time instead
+ * of adding to it. With both slots full the 0x36 handler blocks until one
+ * drains; the UDS worker's responsePending keepalive covers the client.
+ *
+ * The first failed write is latched in `status`. Blocks still queued behind
+ * it are dropped, and the next 0x36 or the 0x37 is refused with NRC 0x72 —
+ * one request later than the synchronous writer reported it, but the
+ * transfer still cannot reach AWAITING_ACTIVATE with a hole in slot1. The
+ * sequence counter only advances for blocks that were queued, so a 0x73
+ * refusal never touches the slots.
+ */
+
+/* #define rather than static const: both size arrays (see the TLV note). */
+#define OTA_STAGE_COUNT 2U
+/* A 0x36 payload is the request less pad + SID + seq */
+#define OTA_STAGE_BYTES ((uint16_t)UDS_MAX_REQUEST_LENGTH - 3U)
+
+/* Below the UDS worker (7), which queues blocks and must never wait on a
+ * program cycle it could overlap; above the factory queue (9). */
+#define OTA_WRITER_PRIORITY 8
+
+#ifdef CONFIG_OTA_ERASE_AHEAD
+/* Erase-ahead: the writer erases slot1 one unit at a time just before the
+ * blocks that land in it, instead of 0x34 erasing the whole slot while the
+ * client waits. A 4 KiB sector erase fits inside the two staged blocks'
+ * worth of bus time, so the erase overlaps the transfer like the program
+ * does; larger units cost less in total but stall the pipeline for longer. */
+static const uint32_t OTA_ERASE_UNIT = (uint32_t)CONFIG_OTA_ERASE_AHEAD_UNIT;
+BUILD_ASSERT((CONFIG_OTA_ERASE_AHEAD_UNIT % 4096) == 0,
+             "OTA erase-ahead unit must be whole 4 KiB NOR sectors");
+#endif
+
+typedef struct {
+    uint16_t length;
+    uint8_t  data[OTA_STAGE_BYTES];
+} OtaStage_t;
+
+/* Everything an in-flight OTA needs beyond the SM lives in the shared
+ * maintenance arena instead of as a permanent static: the flash_img context
+ * (with its CONFIG_IMG_BLOCK_BUF_SIZE coalescing buffer inside) and the two
+ * staging slots. */
+typedef struct {
+    struct flash_img_context flash;
+    OtaStage_t               stage[OTA_STAGE_COUNT];
+} OtaArena_t;
+
+BUILD_ASSERT(sizeof(OtaArena_t) <= MAINT_ARENA_SIZE,
+             "OTA flash_img_context + staging slots must fit the maintenance "
+             "arena (did CONFIG_IMG_BLOCK_BUF_SIZE grow?)");
+
+typedef struct {
+    OtaArena_t *arena;  /**< Set before the first block of a transfer is queued */
+    uint8_t     head;   /**< Next slot to fill (UDS worker only) */
+    uint8_t     tail;   /**< Next slot to program (writer only) */
+    atomic_t    status; /**< First write failure (negative errno), latched; 0 = healthy */
+#ifdef CONFIG_OTA_ERASE_AHEAD
+    uint32_t    written; /**< Bytes handed to flash_img so far */
+    uint32_t    erased;  /**< slot1 is blank from here on up to this offset */
+#endif
+} OtaWriter_t;
+
+/* Slot hand-off: `free` counts slots the worker may fill, `filled` counts
+ * slots queued for the writer. Each give publishes the slot contents. */
+static K_SEM_DEFINE(ota_stage_free, OTA_STAGE_COUNT, OTA_STAGE_COUNT);
+static K_SEM_DEFINE(ota_stage_filled, 0, OTA_STAGE_COUNT);
+
 /* ---- OTA pipeline state ----
  *
  * Modelled as a flat Zephyr SMF: each SID arriving via UDS_OTA_Handle
@@ -133,10 +199,10 @@ typedef enum {
 
 typedef struct {
     struct smf_ctx           smf;
-    /* Points into the maintenance arena while the SM is out of IDLE
+    /* Points at the maintenance arena while the SM is out of IDLE
      * (claimed in the 0x34 handler, released on every return to IDLE);
      * NULL otherwise. */
-    struct flash_img_context *flash_ctx;
+    OtaArena_t              *arena;
     uint32_t                 bytes_expected;
     uint32_t                 bytes_received;
     uint8_t                  next_seq;
@@ -201,7 +267,7 @@ static void reject_sequence_error(OtaSmCtx_t *sm)
  *
  * Uses `smf.current == NULL` as the uninitialised sentinel so the SM
  * is set up on first reference (no separate init hook needed).
- * Production access is single-threaded (divecan_rx thread).
+ * Production access is single-threaded (UDS worker).
  */
 static OtaSmCtx_t *getOtaSm(void)
 {
@@ -218,6 +284,188 @@ void UDS_OTA_Reset(void)
     smf_set_state(SMF_CTX(sm), &ota_states[OTA_STATE_IDLE]);
 }
 
+/* ---- Slot1 writer ---- */
+
+/**
+ * @brief Return pointer to the slot1 writer state singleton.
+ */
+static OtaWriter_t *getOtaWriter(void)
+{
+    static OtaWriter_t writer = {0};
+    return &writer;
+}
+
+/**
+ * @brief Arm the writer for a new transfer into @p arena (UDS worker).
+ *
+ * Only called with every slot free (IDLE entry drains the writer), so the
+ * writer thread is parked on `filled` and nothing races the reset.
+ */
+static void ota_writer_arm(OtaArena_t *arena)
+{
+    OtaWriter_t *writer = getOtaWriter();
+    writer->arena = arena;
+    writer->head = 0U;
+    writer->tail = 0U;
+#ifdef CONFIG_OTA_ERASE_AHEAD
+    writer->written = 0U;
+    writer->erased = 0U;
+#endif
+    (void)atomic_set(&writer->status, 0);
+}
+
+#ifdef CONFIG_OTA_ERASE_AHEAD
+/**
+ * @brief Erase slot1 in OTA_ERASE_UNIT steps until it is blank up to @p end.
+ *
+ * The last unit is clipped to the partition. Runs on the writer before each
+ * block, and on the UDS worker for the tail at 0x37 once the writer has
+ * drained, so `erased` only ever has one user at a time.
+ *
+ * @param writer Writer state; `erased` advances past each unit erased
+ * @param end    Offset slot1 must be blank up to (clipped to the partition)
+ * @return 0, or the open/erase failure
+ */
+static Status_t ota_erase_ahead(OtaWriter_t *writer, uint32_t end)
+{
+    const struct flash_area *fa = NULL;
+    Status_t rc = 0;
+
+    if (writer->erased < end) {
+        rc = flash_area_open(PARTITION_ID(slot1_partition), &fa);
+        if (0 == rc) {
+            uint32_t limit = MIN(end, (uint32_t)fa->fa_size);
+
+            while ((0 == rc) && (writer->erased < limit)) {
+                uint32_t unit = MIN(OTA_ERASE_UNIT,
+                            (uint32_t)fa->fa_size - writer->erased);
+                rc = external_flash_area_erase(fa, (off_t)writer->erased,
+                                   unit);
+                if (0 == rc) {
+                    writer->erased += unit;
+                }
+            }
+            (void)flash_area_close(fa);
+        }
+    }
+    return rc;
+}
+#endif
+
+/**
+ * @brief Copy one block into the next staging slot and queue it (UDS worker).
+ *
+ * Blocks while both slots are queued. Nothing is queued once a write has
+ * failed, so the caller can refuse the block without advancing the sequence.
+ *
+ * @return 0 if queued, else the latched write failure
+ */
+static Status_t ota_writer_queue(const uint8_t *data, uint16_t length)
+{
+    OtaWriter_t *writer = getOtaWriter();
+
+    (void)k_sem_take(&ota_stage_free, K_FOREVER);
+    Status_t rc = (Status_t)atomic_get(&writer->status);
+    if (0 != rc) {
+        k_sem_give(&ota_stage_free);
+    } else {
+        OtaStage_t *slot = &writer->arena->stage[writer->head];
+        (void)memcpy(slot->data, data, length);
+        slot->length = length;
+        writer->head = (uint8_t)((writer->head + 1U) % OTA_STAGE_COUNT);
+        k_sem_give(&ota_stage_filled);
+    }
+    return rc;
+}
+
+/**
+ * @brief Wait until every queued block has been programmed (UDS worker).
+ *
+ * @return 0, or the latched failure of the first write that went wrong
+ */
+static Status_t ota_writer_drain(void)
+{
+    for (uint32_t i = 0U; i < OTA_STAGE_COUNT; ++i) {
+        (void)k_sem_take(&ota_stage_free, K_FOREVER);
+    }
+    for (uint32_t i = 0U; i < OTA_STAGE_COUNT; ++i) {
+        k_sem_give(&ota_stage_free);
+    }
+    return (Status_t)atomic_get(&getOtaWriter()->status);
+}
+
+/**
+ * @brief Drop whatever is still queued and wait for the writer to let go
+ *        of the arena (UDS worker).
+ */
+static void ota_writer_abort(void)
+{
+    OtaWriter_t *writer = getOtaWriter();
+    (void)atomic_cas(&writer->status, 0, -ECANCELED);
+    (void)ota_writer_drain();
+    writer->arena = NULL;
+}
+
+/**
+ * @brief ota_writer thread: program queued slots into slot1 in order.
+ *
+ * Runs only while a transfer has blocks queued; idles on `filled` otherwise.
+ * No heartbeat slot: like the UDS worker it is a maintenance path, and a
+ * stuck NOR write must not reboot the head.
+ */
+static void ota_writer_thread(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+    OtaWriter_t *writer = getOtaWriter();
+
+    while (true) {
+        (void)k_sem_take(&ota_stage_filled, K_FOREVER);
+        const OtaStage_t *slot = &writer->arena->stage[writer->tail];
+
+        if (0 == atomic_get(&writer->status)) {
+#ifdef CONFIG_OTA_ERASE_AHEAD
+            Status_t rc = ota_erase_ahead(writer,
+                              writer->written + slot->length);
+            writer->written += slot->length;
+            if (0 == rc) {
+                rc = external_flash_acquire(K_FOREVER);
+            }
+#else
+            Status_t rc = external_flash_acquire(K_FOREVER);
+#endif
+            if (0 == rc) {
+                rc = flash_img_buffered_write(&writer->arena->flash,
+                                  slot->data, slot->length,
+                                  false);
+                external_flash_release();
+            }
+            if (0 != rc) {
+                OP_ERROR_DETAIL(OP_ERR_FLASH, (uint32_t)(-rc));
+                (void)atomic_cas(&writer->status, 0, rc);
+            }
+        }
+        writer->tail = (uint8_t)((writer->tail + 1U) % OTA_STAGE_COUNT);
+        k_sem_give(&ota_stage_free);
+    }
+}
+
+/* Stack: 1024 B. flash_img_buffered_write → stream_flash → SPI-NOR program is
+ * the same depth class as the flash-log writer's fcb_append path, which runs
+ * on CONFIG_FLASH_LOG_WRITER_STACK=1024; the 0x37 flush stays on the UDS
+ * worker. Confirm the high-water mark (CONFIG_THREAD_ANALYZER) on hardware
+ * before trimming. */
+K_THREAD_DEFINE(ota_writer, 1024, ota_writer_thread,
+        NULL, NULL, NULL, OTA_WRITER_PRIORITY, 0, 0);
+
+#ifdef CONFIG_ZTEST
+void UDS_OTA_DrainWriterForTest(void)
+{
+    (void)ota_writer_drain();
+}
+#endif
+
 /* ---- State action implementations ---- */
 
 /**
@@ -226,7 +474,9 @@ void UDS_OTA_Reset(void)
  * Runs on initial SM setup and on EVERY transition back to IDLE
  * (UDS_OTA_Reset on session lapse / dive, completion paths), so it is the
  * single release point for the maintenance-arena claim taken in the 0x34
- * handler. maint_arena_release is a no-op when OTA is not the holder.
+ * handler. Blocks still staged for the writer are dropped and the writer is
+ * waited out first, so it never touches the arena after the release.
+ * maint_arena_release is a no-op when OTA is not the holder.
  */
 static void ota_idle_entry(void *obj)
 {
@@ -234,7 +484,8 @@ static void ota_idle_entry(void *obj)
     sm->bytes_expected = 0;
     sm->bytes_received = 0;
     sm->next_seq = 1U;
-    sm->flash_ctx = NULL;
+    ota_writer_abort();
+    sm->arena = NULL;
     maint_arena_release(MAINT_ARENA_OWNER_OTA);
 }
 
@@ -243,9 +494,12 @@ static void ota_idle_entry(void *obj)
  *
  * The OTA writer (flash_img/stream_flash) is built WITHOUT erase
  * (CONFIG_IMG_ERASE_PROGRESSIVELY and CONFIG_STREAM_FLASH_ERASE are both
- * off), so it assumes slot1 is already blank. Erase it up front here — a
+ * off), so it assumes slot1 is already blank. With CONFIG_OTA_ERASE_AHEAD
+ * the ota_writer thread keeps it so, erasing just ahead of each block
+ * (ota_erase_ahead), and this only initialises the writer: 0x34 answers
+ * without waiting on the NOR. Otherwise erase it up front here — a
  * multi-second SPI NOR erase — guarded by the heartbeat long-op flag so
- * divecan_rx's heartbeat going stale during the blocking erase doesn't trip
+ * a heartbeat going stale during the blocking erase doesn't trip
  * the watchdog (same pattern as factory_image restore). Without this, a
  * slot1 holding prior content makes the streamed writes land on un-erased
  * NOR and the upload stalls/corrupts (the first such write stalled >30 s
@@ -259,7 +513,7 @@ static void ota_idle_entry(void *obj)
  * negative response on any failure (erase or flash_img_init_id) — the
  * caller only needs to check the return value.
  *
- * @param sm     OTA SM context; sm->flash_ctx must already point at the claimed arena
+ * @param sm     OTA SM context; sm->arena must already point at the claimed arena
  * @param fa     Open slot1 flash area (closed by this function before returning)
  * @param length Declared download length (bytes); staged into sm->bytes_expected on success
  * @return true on success, false on erase/init failure (NRC already sent)
@@ -271,6 +525,9 @@ static bool ota_erase_and_init_download(OtaSmCtx_t *sm,
     UDSContext_t *ctx = sm->uds_ctx;
     bool ok = false;
 
+#ifdef CONFIG_OTA_ERASE_AHEAD
+    Status_t rc = 0;
+#else
     heartbeat_set_long_op(true);
 #ifdef CONFIG_FLASH_LOG
     flash_log_pause();
@@ -280,6 +537,7 @@ static bool ota_erase_and_init_download(OtaSmCtx_t *sm,
     flash_log_resume();
 #endif
     heartbeat_set_long_op(false);
+#endif
     (void)flash_area_close(fa);
 
     if (0 != rc) {
@@ -287,9 +545,9 @@ static bool ota_erase_and_init_download(OtaSmCtx_t *sm,
         UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_DOWNLOAD,
                      UDS_NRC_GENERAL_PROG_FAIL);
     } else {
-        (void)memset(sm->flash_ctx, 0, sizeof(*sm->flash_ctx));
+        (void)memset(&sm->arena->flash, 0, sizeof(sm->arena->flash));
 
-        rc = flash_img_init_id(sm->flash_ctx,
+        rc = flash_img_init_id(&sm->arena->flash,
                        PARTITION_ID(slot1_partition));
         if (0 != rc) {
             OP_ERROR_DETAIL(OP_ERR_FLASH, (uint32_t)(-rc));
@@ -299,6 +557,7 @@ static bool ota_erase_and_init_download(OtaSmCtx_t *sm,
             sm->bytes_expected = length;
             sm->bytes_received = 0;
             sm->next_seq = 1U;
+            ota_writer_arm(sm->arena);
             LOG_INF("OTA 0x34 download accepted: %u bytes", length);
             ok = true;
         }
@@ -365,8 +624,8 @@ static void ota_handle_request_download(OtaSmCtx_t *sm)
                         UDS_NRC_REQUEST_OUT_OF_RANGE);
                 UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_DOWNLOAD,
                              UDS_NRC_REQUEST_OUT_OF_RANGE);
-            } else if (NULL == (sm->flash_ctx = maint_arena_claim(
-                                    MAINT_ARENA_OWNER_OTA))) {
+            } else if (NULL == (sm->arena = maint_arena_claim(
+                                MAINT_ARENA_OWNER_OTA))) {
                 /* Maintenance arena busy — a factory capture/restore is
                  * using the shared scratch region. Transient (capture is a
                  * one-shot on a freshly-flashed unit); the tester retries. */
@@ -381,22 +640,27 @@ static void ota_handle_request_download(OtaSmCtx_t *sm)
         }
 
         if (ok) {
+            /* Offer shorter blocks while this peer's link drops frames; the
+             * 0x36 handler still accepts anything up to the full size. */
+            uint16_t maxBlock = ISOTP_Link_BlockLimit(ctx->reply,
+                                  OTA_MAX_BLOCK_LENGTH);
+
             ctx->response_buffer[UDS_PAD_IDX] =
                 UDS_SID_REQUEST_DOWNLOAD + UDS_RESPONSE_SID_OFFSET;
             ctx->response_buffer[UDS_SID_IDX] = OTA_DOWNLOAD_LENGTH_FMT;
             ctx->response_buffer[UDS_DID_HI_IDX] =
-                (uint8_t)(OTA_MAX_BLOCK_LENGTH >> BYTE_SHIFT_8);
+                (uint8_t)(maxBlock >> BYTE_SHIFT_8);
             ctx->response_buffer[UDS_DID_LO_IDX] =
-                (uint8_t)OTA_MAX_BLOCK_LENGTH;
+                (uint8_t)maxBlock;
             ctx->response_length = OTA_DOWNLOAD_RESP_LEN;
             UDS_SendResponse(ctx);
             smf_set_state(SMF_CTX(sm),
                       &ota_states[OTA_STATE_DOWNLOADING]);
-        } else if (NULL != sm->flash_ctx) {
+        } else if (NULL != sm->arena) {
             /* Claimed the arena but failed before entering DOWNLOADING —
              * the SM stays IDLE (no transition, so ota_idle_entry will not
              * re-run) and the claim must be handed back here. */
-            sm->flash_ctx = NULL;
+            sm->arena = NULL;
             maint_arena_release(MAINT_ARENA_OWNER_OTA);
         } else {
             /* No action required */
@@ -424,8 +688,9 @@ static enum smf_state_result ota_idle_run(void *obj)
 /**
  * @brief DOWNLOADING.run handler for OTA_EVT_TRANSFER_DATA (SID 0x36).
  *
- * Validates the sequence counter, streams the payload into slot1 via
- * flash_img_buffered_write(), and replies echoing the seq byte.
+ * Validates the sequence counter, queues the payload for the slot1 writer,
+ * and replies echoing the seq byte without waiting for the NOR program. A
+ * write failure on an earlier block refuses this one with NRC 0x72.
  */
 static void ota_handle_transfer_data(OtaSmCtx_t *sm)
 {
@@ -433,7 +698,8 @@ static void ota_handle_transfer_data(OtaSmCtx_t *sm)
     const uint8_t *request_data   = sm->request_data;
     uint16_t       request_length = sm->request_length;
 
-    if (request_length < OTA_TRANSFER_MIN_REQ_LEN) {
+    if ((request_length < OTA_TRANSFER_MIN_REQ_LEN) ||
+        (request_length > (OTA_STAGE_BYTES + OTA_TRANSFER_OVERHEAD))) {
         OP_ERROR_DETAIL(OP_ERR_UDS_NRC, UDS_NRC_INCORRECT_MSG_LEN);
         UDS_SendNegativeResponse(ctx, UDS_SID_TRANSFER_DATA,
                      UDS_NRC_INCORRECT_MSG_LEN);
@@ -445,16 +711,11 @@ static void ota_handle_transfer_data(OtaSmCtx_t *sm)
             UDS_SendNegativeResponse(ctx, UDS_SID_TRANSFER_DATA,
                          UDS_NRC_WRONG_BLOCK_SEQ_COUNTER);
         } else {
-            size_t dataLen = request_length - OTA_TRANSFER_OVERHEAD;
+            uint16_t dataLen = request_length - OTA_TRANSFER_OVERHEAD;
             const uint8_t *data = &request_data[UDS_SID_IDX + 2U];
-            Status_t rc = external_flash_acquire(K_FOREVER);
-            if (0 == rc) {
-                rc = flash_img_buffered_write(sm->flash_ctx, data,
-                                  dataLen, false);
-                external_flash_release();
-            }
-            if (0 != rc) {
-                OP_ERROR_DETAIL(OP_ERR_FLASH, (uint32_t)(-rc));
+            if (0 != ota_writer_queue(data, dataLen)) {
+                /* The writer already logged the flash error */
+                OP_ERROR_DETAIL(OP_ERR_UDS_NRC, UDS_NRC_GENERAL_PROG_FAIL);
                 UDS_SendNegativeResponse(ctx, UDS_SID_TRANSFER_DATA,
                              UDS_NRC_GENERAL_PROG_FAIL);
             } else {
@@ -475,7 +736,9 @@ static void ota_handle_transfer_data(OtaSmCtx_t *sm)
 /**
  * @brief DOWNLOADING.run handler for OTA_EVT_TRANSFER_EXIT (SID 0x37).
  *
- * Flushes the streaming-flash writer and verifies slot1 carries a sane
+ * Waits for the slot1 writer to program every queued block, erases the
+ * rest of slot1 (erase-ahead builds), flushes the
+ * streaming-flash writer and verifies slot1 carries a sane
  * MCUBoot header. On success, transitions to OTA_STATE_AWAITING_ACTIVATE.
  * Full SHA-256 validation is deferred to the Activate routine in
  * OTA_STATE_AWAITING_ACTIVATE.
@@ -489,13 +752,35 @@ static void ota_handle_transfer_exit(OtaSmCtx_t *sm)
         OP_ERROR_DETAIL(OP_ERR_UDS_NRC, UDS_NRC_INCORRECT_MSG_LEN);
         UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_TRANSFER_EXIT,
                      UDS_NRC_INCORRECT_MSG_LEN);
+    } else if (0 != ota_writer_drain()) {
+        /* A queued block failed to program; the writer logged it */
+        OP_ERROR_DETAIL(OP_ERR_UDS_NRC, UDS_NRC_GENERAL_PROG_FAIL);
+        UDS_SendNegativeResponse(ctx, UDS_SID_REQUEST_TRANSFER_EXIT,
+                     UDS_NRC_GENERAL_PROG_FAIL);
     } else {
+        Status_t rc = 0;
+#ifdef CONFIG_OTA_ERASE_AHEAD
+        /* Blank the part of slot1 the image never reached — MCUBoot's
+         * image trailer included — as the up-front erase used to. That can
+         * be most of the slot, so it gets the same heartbeat long-op guard.
+         * The flash-log writer is already held off: DOWNLOADING pauses it on
+         * entry and only its exit resumes it, so a failed erase (which
+         * leaves the transfer in DOWNLOADING) cannot unpause it early. */
+        heartbeat_set_long_op(true);
+        rc = ota_erase_ahead(getOtaWriter(), UINT32_MAX);
+        heartbeat_set_long_op(false);
+        if (0 == rc) {
+            rc = external_flash_acquire(K_FOREVER);
+        }
+#else
+        rc = external_flash_acquire(K_FOREVER);
+#endif
         /* Flush any unwritten bytes from flash_img_buffered_write's
          * internal block buffer. Pass an empty data buffer so only
-         * the flush flag has effect. */
-        Status_t rc = external_flash_acquire(K_FOREVER);
+         * the flush flag has effect. The writer is idle (drained above)
+         * and nothing else queues until the next 0x36. */
         if (0 == rc) {
-            rc = flash_img_buffered_write(sm->flash_ctx, NULL, 0, true);
+            rc = flash_img_buffered_write(&sm->arena->flash, NULL, 0, true);
             external_flash_release();
         }
         if (0 != rc) {
@@ -942,18 +1227,18 @@ static Status_t validateSlot1(void)
             result = -EBADMSG;
         } else {
             /* Only reachable from AWAITING_ACTIVATE, where the OTA claim
-             * taken at 0x34 is still held and flash_ctx points at the
-             * arena. */
+             * taken at 0x34 is still held and sm->arena points at it;
+             * the writer went idle at 0x37. */
             OtaSmCtx_t *sm = getOtaSm();
-            __ASSERT(NULL != sm->flash_ctx,
+            __ASSERT(NULL != sm->arena,
                  "validateSlot1 outside an active OTA claim");
-            (void)memset(sm->flash_ctx, 0, sizeof(*sm->flash_ctx));
+            (void)memset(&sm->arena->flash, 0, sizeof(sm->arena->flash));
 
             const struct flash_img_check check = {
                 .match = expectedHash,
                 .clen = hashedLen,
             };
-            rc = flash_img_check(sm->flash_ctx, &check,
+            rc = flash_img_check(&sm->arena->flash, &check,
                          PARTITION_ID(slot1_partition));
             if (0 != rc) {
                 LOG_ERR("validateSlot1: hash mismatch (%d)", rc);
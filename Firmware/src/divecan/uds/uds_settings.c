@@ -74,7 +74,7 @@ static bool setting_is_cell_bcst(uint8_t idx, uint8_t *cell)
 #endif
 
 #define FW_COMMIT_OPTION_COUNT   2U
-#define PPO2_MODE_OPTION_COUNT   4U
+#define PPO2_MODE_OPTION_COUNT   5U
 #define CAL_MODE_OPTION_COUNT    6U
 #define BOOL_OPTION_COUNT        3U
 #define BATTERY_TYPE_OPTION_COUNT 5U
@@ -89,6 +89,7 @@ static const char * const ppo2ModeOptions[PPO2_MODE_OPTION_COUNT] = {
     "Off",
     "PID",
     "MK15",
+    "MPC",
     NULL
 };
 
@@ -139,9 +140,9 @@ static const SettingDefinition_t settings[SETTING_COUNT] = {
         .label = "PPO2 Mode",
         .kind = SETTING_KIND_TEXT,
         .editable = true,
-        .max_value = 2,
+        .max_value = 3,
         .options = ppo2ModeOptions,
-        .option_count = 3
+        .option_count = 4
     },
     /* Index 2: Calibration Mode */
     {
@@ -291,7 +292,7 @@ static const int16_t menuConfigSlots[MENU_CONFIG_SLOTS] = {
 /* Wire (handset-facing) index -> storage index into settings[]. Full permutation
  * of the SETTING_COUNT present settings, built once, lazily (0 == not yet
  * built; SETTING_COUNT is always >= 1). UDS runs single-threaded on the
- * divecan_rx thread, so the lazy build needs no lock. */
+ * UDS worker, so the lazy build needs no lock. */
 static uint8_t menuOrder[SETTING_COUNT];
 static uint8_t menuOrderLen;
 
@@ -23,11 +23,15 @@
 #include "ppo2_control.h"
 #include "ppo2_autotune.h"
 #include "error_histogram.h"
+#include "latency_trace.h"
+#include "i2c1_sched.h"
 #include "factory_image.h"
 #include "firmware_confirm.h"
 #include "errors.h"
 #include "boot_history.h"
 #include "external_flash.h"
+#include "isotp_link.h"
+#include "divecan_counters.h"
 #include "common.h"
 #ifdef CONFIG_ALARM
 #include "alarm.h"
@@ -38,6 +42,9 @@
 #ifdef CONFIG_HAS_PRESSURE_TRANSDUCER
 #include "tank_pressure.h"
 #endif
+#ifdef CONFIG_PPO2_PLANT_ESTIMATOR
+#include "ppo2_plant_estimator.h"
+#endif
 #ifdef CONFIG_FLASH_LOG
 #include "flash_log.h"
 #include "uds_log_download.h"
@@ -62,7 +69,7 @@ static const uint8_t BYTE_IDX_1 = 1U;
 static const uint8_t BYTE_IDX_2 = 2U;
 static const uint8_t BYTE_IDX_3 = 3U;
 
-/* UDS state DID handlers run synchronously on the single DiveCAN RX thread.
+/* UDS state DID handlers run synchronously on the single UDS worker thread.
  * Keep history serialization scratch off that thread's stack; the expanded
  * crash record is large enough to trip hardware stack checks on HIL.
  *
@@ -576,6 +583,61 @@ static bool handleAutotuneStatusDID(uint8_t *buf, uint16_t maxLen, uint16_t *len
     return result;
 }
 
+#ifdef CONFIG_PPO2_PLANT_ESTIMATOR
+/* PLANT_ESTIMATE DID (0xF218) payload, little-endian: the PlantEstimate_t
+ * last published on chan_plant_estimate (all zero before the first window).
+ *   [0]  settled_gain f32      [4]  gain_ratio f32     [8]  gain_stddev f32
+ *   [12] drift_bar_s f32       [16] balance_duty f32   [20] ref_balance_duty f32
+ *   [24] ref_settled_gain f32  [28] updates u16        [30] gain_updates u16
+ *   [32] converged u8                                                    */
+static const size_t PLANT_ESTIMATE_LEN = 33U;
+static const size_t PE_OFF_GAIN         = 0U;
+static const size_t PE_OFF_GAIN_RATIO   = 4U;
+static const size_t PE_OFF_GAIN_STDDEV  = 8U;
+static const size_t PE_OFF_DRIFT        = 12U;
+static const size_t PE_OFF_BALANCE      = 16U;
+static const size_t PE_OFF_REF_BALANCE  = 20U;
+static const size_t PE_OFF_REF_GAIN     = 24U;
+static const size_t PE_OFF_UPDATES      = 28U;
+static const size_t PE_OFF_GAIN_UPDATES = 30U;
+static const size_t PE_OFF_CONVERGED    = 32U;
+
+/**
+ * @brief Handle a read of the PLANT_ESTIMATE DID.
+ *
+ * @param buf    Destination buffer
+ * @param maxLen Caller-supplied response buffer capacity
+ * @param len    Out: number of bytes written to buf
+ * @return true if the payload fit and was written, false on overflow
+ */
+static bool handlePlantEstimateDID(uint8_t *buf, uint16_t maxLen, uint16_t *len)
+{
+    bool result = true;
+
+    if (maxLen < PLANT_ESTIMATE_LEN) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+        result = false;
+    } else {
+        PlantEstimate_t est = {0};
+
+        (void)zbus_chan_read(&chan_plant_estimate, &est,
+                     K_MSEC(STATE_DID_READ_TIMEOUT_MS));
+        writeFloat32(&buf[PE_OFF_GAIN], est.settled_gain);
+        writeFloat32(&buf[PE_OFF_GAIN_RATIO], est.gain_ratio);
+        writeFloat32(&buf[PE_OFF_GAIN_STDDEV], est.gain_stddev);
+        writeFloat32(&buf[PE_OFF_DRIFT], est.drift_bar_s);
+        writeFloat32(&buf[PE_OFF_BALANCE], est.balance_duty);
+        writeFloat32(&buf[PE_OFF_REF_BALANCE], est.ref_balance_duty);
+        writeFloat32(&buf[PE_OFF_REF_GAIN], est.ref_settled_gain);
+        writeUint16(&buf[PE_OFF_UPDATES], est.updates);
+        writeUint16(&buf[PE_OFF_GAIN_UPDATES], est.gain_updates);
+        buf[PE_OFF_CONVERGED] = est.converged ? 1U : 0U;
+        *len = (uint16_t)PLANT_ESTIMATE_LEN;
+    }
+    return result;
+}
+#endif
+
 #ifdef CONFIG_POSEIDON_ACCESSORIES
 /* Byte layout of the 4-byte POSEIDON_GAUGE DID payload. */
 static const uint8_t POSEIDON_GAUGE_LEN          = 4U;
@@ -908,6 +970,93 @@ static bool buildErrorHistogramStatus(uint8_t *buf, uint16_t maxLen, uint16_t *l
     return result;
 }
 
+/**
+ * @brief Serialise the LATENCY_TRACE DID payload.
+ *
+ * @param buf    Destination buffer
+ * @param maxLen Caller-supplied response buffer capacity
+ * @param len    Out: number of bytes written to buf
+ * @return true if the summary fit and was written, false on overflow
+ */
+static bool buildLatencyTraceStatus(uint8_t *buf, uint16_t maxLen, uint16_t *len)
+{
+    bool result = true;
+    size_t written = latency_trace_serialise(buf, maxLen);
+
+    if (0U == written) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+        result = false;
+    } else {
+        *len = (uint16_t)written;
+    }
+    return result;
+}
+
+/**
+ * @brief Serialise the ISOTP_LINK_STATS DID payload.
+ *
+ * @param buf    Destination buffer
+ * @param maxLen Caller-supplied response buffer capacity
+ * @param len    Out: number of bytes written to buf
+ * @return true if the per-peer table fit and was written, false on overflow
+ */
+static bool buildIsotpLinkStatus(uint8_t *buf, uint16_t maxLen, uint16_t *len)
+{
+    bool result = true;
+
+    if (maxLen < ISOTP_LINK_STATS_MAX_LEN) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+        result = false;
+    } else {
+        *len = ISOTP_Link_FillStats(buf, maxLen);
+    }
+    return result;
+}
+
+/**
+ * @brief Serialise the I2C1_BUS_STATS DID payload (i2c1_sched_serialise()).
+ *
+ * @param buf    Destination buffer
+ * @param maxLen Caller-supplied response buffer capacity
+ * @param len    Out: number of bytes written to buf
+ * @return true if the per-client table fit and was written, false on overflow
+ */
+static bool buildI2c1BusStats(uint8_t *buf, uint16_t maxLen, uint16_t *len)
+{
+    bool result = true;
+    size_t written = i2c1_sched_serialise(buf, maxLen);
+
+    if (0U == written) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+        result = false;
+    } else {
+        *len = (uint16_t)written;
+    }
+    return result;
+}
+
+/**
+ * @brief Serialise the CAN_TX_STATS DID payload (divecan_send_serialise_stats()).
+ *
+ * @param buf    Destination buffer
+ * @param maxLen Caller-supplied response buffer capacity
+ * @param len    Out: number of bytes written to buf
+ * @return true if the record fit and was written, false on overflow
+ */
+static bool buildCanTxStats(uint8_t *buf, uint16_t maxLen, uint16_t *len)
+{
+    bool result = true;
+    size_t written = divecan_send_serialise_stats(buf, maxLen);
+
+    if (0U == written) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+        result = false;
+    } else {
+        *len = (uint16_t)written;
+    }
+    return result;
+}
+
 #ifdef CONFIG_FLASH_LOG
 /**
  * @brief Serialise the LOG_STATS DID payload (raw FlashLogStats_t).
@@ -964,6 +1113,32 @@ static bool buildLogSelectorResultStatus(uint8_t *buf, uint16_t maxLen, uint16_t
     }
     return result;
 }
+
+/**
+ * @brief Serialise the LOG_RESUME_TOKEN DID payload.
+ *
+ * Fails (caller emits an NRC) until a raw log download has checkpointed its
+ * reader — see uds_log_download.c.
+ *
+ * @param buf    Destination buffer
+ * @param maxLen Caller-supplied response buffer capacity
+ * @param len    Out: number of bytes written to buf
+ * @return true if a token was written, false on overflow or no checkpoint
+ */
+static bool buildLogResumeTokenStatus(uint8_t *buf, uint16_t maxLen, uint16_t *len)
+{
+    bool result = true;
+
+    if (maxLen < UDS_LOG_RESUME_TOKEN_LEN) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+        result = false;
+    } else if (!UDS_LogDownload_FillResumeToken(buf, UDS_LOG_RESUME_TOKEN_LEN)) {
+        result = false;
+    } else {
+        *len = (uint16_t)UDS_LOG_RESUME_TOKEN_LEN;
+    }
+    return result;
+}
 #endif
 
 /**
@@ -1115,10 +1290,41 @@ static bool handleControlStateDID(uint16_t did, uint8_t *buf,
         break;
     }
 
+    case UDS_DID_SAMPLE_TO_CONSENSUS:
+    {
+        PPO2ControlSnapshot_t snap = {0};
+        ppo2_control_get_snapshot(&snap);
+        writeUint32(buf, snap.sample_to_consensus_us);
+        *len = sizeof(uint32_t);
+        break;
+    }
+
+    case UDS_DID_SAMPLE_TO_CONTROL:
+    {
+        PPO2ControlSnapshot_t snap = {0};
+        ppo2_control_get_snapshot(&snap);
+        writeUint32(buf, snap.sample_to_control_us);
+        *len = sizeof(uint32_t);
+        break;
+    }
+
     case UDS_DID_AUTOTUNE_STATUS:
         result = handleAutotuneStatusDID(buf, maxLen, len);
         break;
 
+    case UDS_DID_LATENCY_TRACE:
+        result = buildLatencyTraceStatus(buf, maxLen, len);
+        break;
+
+    case UDS_DID_PLANT_ESTIMATE:
+#ifdef CONFIG_PPO2_PLANT_ESTIMATOR
+        result = handlePlantEstimateDID(buf, maxLen, len);
+        break;
+#else
+        result = false;
+        break;
+#endif
+
     case UDS_DID_UPTIME_SEC:
         writeUint32(buf, k_uptime_get_32() / MS_PER_SECOND);
         *len = sizeof(uint32_t);
@@ -1200,6 +1406,10 @@ static bool handleControlStateDID(uint16_t did, uint8_t *buf,
         result = buildLogSelectorResultStatus(buf, maxLen, len);
         break;
 
+    case UDS_DID_LOG_RESUME_TOKEN:
+        result = buildLogResumeTokenStatus(buf, maxLen, len);
+        break;
+
     case UDS_DID_LOG_VERBOSITY:
         (void)flash_log_init();
         buf[0] = flash_log_get_rtt_level();
@@ -1215,13 +1425,21 @@ static bool handleControlStateDID(uint16_t did, uint8_t *buf,
 
     default:
     {
-        /* Crash/reboot-history DIDs first, then the OTA/MCUBoot helper for
-         * 0xF270-0xF274. Unknown DIDs land back here returning false →
-         * caller emits REQUEST_OUT_OF_RANGE NRC. */
+        /* Crash/reboot-history DIDs first, then the ISO-TP link, i2c1
+         * bus and CAN TX tables, then the OTA/MCUBoot helper for 0xF270-0xF274. Unknown DIDs land
+         * back here returning false → caller emits REQUEST_OUT_OF_RANGE NRC. */
         bool crashDid = false;
 
         result = handleCrashHistoryDID(did, buf, maxLen, len, &crashDid);
-        if (!crashDid) {
+        if (crashDid) {
+            /* Handled above */
+        } else if (UDS_DID_ISOTP_LINK_STATS == did) {
+            result = buildIsotpLinkStatus(buf, maxLen, len);
+        } else if (UDS_DID_I2C1_BUS_STATS == did) {
+            result = buildI2c1BusStats(buf, maxLen, len);
+        } else if (UDS_DID_CAN_TX_STATS == did) {
+            result = buildCanTxStats(buf, maxLen, len);
+        } else {
             result = handleOtaStatusDID(did, buf, maxLen, len);
         }
         break;
@@ -1310,20 +1528,87 @@ static bool handleUniversalCellDID(uint8_t cellNum, uint8_t offset,
     return result;
 }
 
+#ifdef CONFIG_HAS_ANALOG_CELL
+/* Analog cell filter-stats DID (0xF4NE) payload, little-endian:
+ *   [0]  version u8        [1]  kind u8 (AnalogFilterKind_t)
+ *   [2]  taps u8           [3]  iir_shift u8
+ *   [4]  samples_in u32    [8]  samples_out u32
+ *   [12] sample_period_us u32
+ *   [16] input_noise_nv u32  [20] output_noise_nv u32
+ *   [24] noise_gain_permille u16  [26] group_delay_dsamples u16
+ *   [28] group_delay_us u32                                      */
+static const size_t FILTER_STATS_LEN            = 32U;
+static const uint8_t FILTER_STATS_VERSION       = 1U;
+static const size_t FS_OFF_VERSION       = 0U;
+static const size_t FS_OFF_KIND          = 1U;
+static const size_t FS_OFF_TAPS          = 2U;
+static const size_t FS_OFF_IIR_SHIFT     = 3U;
+static const size_t FS_OFF_SAMPLES_IN    = 4U;
+static const size_t FS_OFF_SAMPLES_OUT   = 8U;
+static const size_t FS_OFF_PERIOD_US     = 12U;
+static const size_t FS_OFF_IN_NOISE_NV   = 16U;
+static const size_t FS_OFF_OUT_NOISE_NV  = 20U;
+static const size_t FS_OFF_NOISE_GAIN    = 24U;
+static const size_t FS_OFF_DELAY_DSAMPLE = 26U;
+static const size_t FS_OFF_DELAY_US      = 28U;
+
+/**
+ * @brief Serialise an analog cell's filter figures (CELL_DID_FILTER_STATS).
+ *
+ * @param cellNum Zero-based cell index
+ * @param buf     Response data buffer
+ * @param maxLen  Caller-supplied response buffer capacity
+ * @param len     Out: number of bytes written to buf
+ * @return true if the payload was written, false if the buffer is too small
+ *         or the cell has no filter
+ */
+static bool handleAnalogFilterStatsDID(uint8_t cellNum, uint8_t *buf,
+                       uint16_t maxLen, uint16_t *len)
+{
+    bool result = false;
+    AnalogFilterStats_t st = {0};
+
+    if (maxLen < FILTER_STATS_LEN) {
+        OP_ERROR_DETAIL(OP_ERR_UDS_TOO_FULL, maxLen);
+    } else if (analog_cell_filter_stats(cellNum, &st)) {
+        buf[FS_OFF_VERSION] = FILTER_STATS_VERSION;
+        buf[FS_OFF_KIND] = (uint8_t)st.kind;
+        buf[FS_OFF_TAPS] = st.taps;
+        buf[FS_OFF_IIR_SHIFT] = st.iir_shift;
+        writeUint32(&buf[FS_OFF_SAMPLES_IN], st.samples_in);
+        writeUint32(&buf[FS_OFF_SAMPLES_OUT], st.samples_out);
+        writeUint32(&buf[FS_OFF_PERIOD_US], st.sample_period_us);
+        writeUint32(&buf[FS_OFF_IN_NOISE_NV], st.input_noise_nv);
+        writeUint32(&buf[FS_OFF_OUT_NOISE_NV], st.output_noise_nv);
+        writeUint16(&buf[FS_OFF_NOISE_GAIN], st.noise_gain_permille);
+        writeUint16(&buf[FS_OFF_DELAY_DSAMPLE], st.group_delay_dsamples);
+        writeUint32(&buf[FS_OFF_DELAY_US], st.group_delay_us);
+        *len = (uint16_t)FILTER_STATS_LEN;
+        result = true;
+    } else {
+        /* Cell is not an analog cell in this build */
+    }
+
+    return result;
+}
+#endif
+
 /**
  * @brief Handle a cell DID offset specific to analog galvanic cells
  *
- * Currently covers the millivolts offset only.
+ * Covers the raw ADC, millivolts and filter-stats offsets.
  *
+ * @param cellNum Zero-based cell index
  * @param offset  DID sub-offset within the cell's DID block
  * @param cellMsg Latest oxygen cell message from zbus; must not be NULL
- * @param buf     Response data buffer; caller must ensure sufficient space
+ * @param buf     Response data buffer
+ * @param maxLen  Caller-supplied response buffer capacity
  * @param len     Out: number of bytes written to buf
  * @return true if the offset was handled, false if it is not an analog-specific offset
  */
-static bool handleAnalogCellDID(uint8_t offset,
+static bool handleAnalogCellDID(uint8_t cellNum, uint8_t offset,
                 const OxygenCellMsg_t *cellMsg,
-                uint8_t *buf, uint16_t *len)
+                uint8_t *buf, uint16_t maxLen, uint16_t *len)
 {
     bool result = false;
 
@@ -1337,7 +1622,13 @@ static bool handleAnalogCellDID(uint8_t offset,
         writeUint16(buf, cellMsg->millivolts);
         *len = sizeof(uint16_t);
         result = true;
-    } else {
+    }
+#ifdef CONFIG_HAS_ANALOG_CELL
+    else if (CELL_DID_FILTER_STATS == offset) {
+        result = handleAnalogFilterStatsDID(cellNum, buf, maxLen, len);
+    }
+#endif
+    else {
         /* Not an analog-specific DID */
     }
 
@@ -1411,11 +1702,12 @@ static bool handleDigitalCellDID(uint8_t offset,
  * @param cellNum Zero-based cell index (0–CELL_MAX_COUNT-1)
  * @param offset  DID sub-offset within the cell's DID block (0–CELL_DID_MAX_OFFSET)
  * @param buf     Response data buffer; caller must ensure sufficient space
+ * @param maxLen  Caller-supplied response buffer capacity
  * @param len     Out: number of bytes written to buf
  * @return true if the DID was handled, false if the offset is unrecognised
  */
 static bool handleCellDID(uint8_t cellNum, uint8_t offset,
-              uint8_t *buf, uint16_t *len)
+              uint8_t *buf, uint16_t maxLen, uint16_t *len)
 {
     bool result = false;
 
@@ -1449,7 +1741,7 @@ static bool handleCellDID(uint8_t cellNum, uint8_t offset,
         if (handleUniversalCellDID(cellNum, offset, &cellMsg, buf, len)) {
             result = true;
         } else if ((CELL_KIND_ANALOG == kind) &&
-               handleAnalogCellDID(offset, &cellMsg, buf, len)) {
+               handleAnalogCellDID(cellNum, offset, &cellMsg, buf, maxLen, len)) {
             result = true;
         } else if ((CELL_KIND_DIVEO2 == kind) &&
                handleDigitalCellDID(offset, &cellMsg, buf, len)) {
@@ -1525,7 +1817,8 @@ bool UDS_StateDID_HandleRead(uint16_t did, uint8_t *response_buffer,
              (did < (UDS_DID_CELL_BASE + (CELL_MAX_COUNT * UDS_DID_CELL_RANGE)))) {
             uint8_t cellNum = (uint8_t)((did - UDS_DID_CELL_BASE) / UDS_DID_CELL_RANGE);
             uint8_t offset = (uint8_t)((did - UDS_DID_CELL_BASE) % UDS_DID_CELL_RANGE);
-            result = handleCellDID(cellNum, offset, response_buffer, response_length);
+            result = handleCellDID(cellNum, offset, response_buffer,
+                           maxLength, response_length);
         }
         else {
             /* DID not in any known range — result remains false */
@@ -0,0 +1,267 @@
+/**
+ * @file uds_worker.c
+ * @brief UDS request worker queue
+ *
+ * Runs UDS_ProcessRequest() on a dedicated work queue so that slow handlers
+ * (settings saves, OTA flash writes, zbus-bound DID reads) never hold up the
+ * DiveCAN RX thread. See uds_worker.h for the request lifecycle.
+ *
+ * Threading: UDS_Worker_Submit/Poll/NextDeadline run on the RX thread; the
+ * work handlers run on the worker. The request snapshot (the request bytes and
+ * the requester's addressing, not the whole ISO-TP context) is written by the
+ * RX thread only while `busy` is clear and read by the worker only while it is
+ * set. The worker's response shows up as the snapshot's tx_complete, which
+ * is what stops the responsePending keepalive. ISOTP_Reply() sets it inside
+ * the same TX queue hold as the enqueue, and the RX thread re-checks it under
+ * that hold before queuing a 0x78, so a 0x78 never follows the response. The
+ * RX thread queues its own NRCs straight onto the TX queue so it never sets
+ * tx_complete.
+ *
+ * The worker registers no heartbeat slot: like the factory-image queue, a
+ * wedged diagnostic handler must not reboot the head mid-dive.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <string.h>
+
+#include "uds_worker.h"
+#include "uds.h"
+#include "isotp_tx_queue.h"
+#ifdef CONFIG_FLASH_LOG
+#include "uds_log_download.h"
+#endif
+#include "errors.h"
+#include "common.h"
+
+LOG_MODULE_REGISTER(uds_worker, LOG_LEVEL_INF);
+
+/* The UDS/state-DID and settings-save paths that set the divecan_rx stack at
+ * 2304 B (see the history in divecan_rx.c) run here now, so the budget moves
+ * with them; do not trim without INIT_STACKS-backed high-water data. */
+#define UDS_WORKER_STACK_SIZE 2304
+/* Below divecan_rx (5) and the control threads (6): a slow handler never
+ * delays a frame or a fire cycle, and the responsePending keepalive covers
+ * the client while it waits. */
+#define UDS_WORKER_PRIORITY 7
+
+BUILD_ASSERT(UDS_RESPONSE_PENDING_FIRST_MS < UDS_P2_SERVER_MS,
+             "the first responsePending must beat P2server");
+BUILD_ASSERT(UDS_RESPONSE_PENDING_REPEAT_MS < UDS_P2_STAR_SERVER_MS,
+             "responsePending must repeat within P2*server");
+
+/* Housekeeping period for the S3 session lapse and the log-download
+ * inactivity abort (both formerly ticked by the RX loop's 1 s wake). */
+static const uint32_t UDS_WORKER_MAINT_MS = 1000U;
+
+/** The request being served, copied out of the dialog context. */
+typedef struct {
+    ISOTPReply_t reply;                 /**< Requester's addressing */
+    uint16_t length;                    /**< Request length */
+    uint8_t payload[ISOTP_MAX_PAYLOAD]; /**< Request bytes */
+} UdsWorkerRequest_t;
+
+typedef struct {
+    UDSContext_t uds;           /**< Session and response buffer (worker only) */
+    UdsWorkerRequest_t request; /**< Request snapshot */
+    uint32_t pending_due_ms;    /**< Next responsePending (RX thread only) */
+    uint8_t sid;                /**< SID being served (RX thread only) */
+    atomic_t busy;              /**< Set while the worker owns `request` */
+} UdsWorker_t;
+
+/**
+ * @brief Return pointer to the worker state singleton.
+ */
+static UdsWorker_t *getWorker(void)
+{
+    static UdsWorker_t worker = {0};
+    return &worker;
+}
+
+K_THREAD_STACK_DEFINE(uds_work_stack, UDS_WORKER_STACK_SIZE);
+
+static struct k_work_q *getWorkQ(void)
+{
+    static struct k_work_q uds_work_q;
+    return &uds_work_q;
+}
+
+/* ---- Work handlers (worker thread) ---- */
+
+static void request_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+    UdsWorker_t *worker = getWorker();
+
+    UDS_ProcessRequest(&worker->uds, worker->request.payload,
+               worker->request.length);
+
+    /* The RX thread may overwrite the snapshot from here on. */
+    (void)atomic_clear(&worker->busy);
+}
+
+static K_WORK_DEFINE(request_work, request_work_handler);
+
+static void maint_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(maint_work, maint_work_handler);
+
+/**
+ * @brief Lapse an idle session and an abandoned log download, then re-arm.
+ *
+ * Re-arms for the S3 deadline when that comes before the next period, so a
+ * programming session still lapses on time.
+ */
+static void maint_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+    UdsWorker_t *worker = getWorker();
+    uint32_t now = k_uptime_get_32();
+    uint32_t delay_ms = UDS_WORKER_MAINT_MS;
+    uint32_t deadline = 0U;
+
+    UDS_PollSession(&worker->uds, now);
+#ifdef CONFIG_FLASH_LOG
+    UDS_LogDownload_Poll();
+#endif
+
+    if (UDS_SessionDeadline(&worker->uds, &deadline)) {
+        int32_t remaining = (int32_t)(deadline - now);
+
+        if (remaining <= 0) {
+            delay_ms = 0U;
+        } else if ((uint32_t)remaining < delay_ms) {
+            delay_ms = (uint32_t)remaining;
+        } else {
+            /* The period comes first */
+        }
+    }
+    (void)k_work_schedule_for_queue(getWorkQ(), &maint_work, K_MSEC(delay_ms));
+}
+
+/* ---- RX thread side ---- */
+
+/**
+ * @brief Queue a negative response to the peer addressed by @p to.
+ *
+ * Built here rather than with UDS_SendNegativeResponse(): the response
+ * buffer belongs to the worker, and going through ISOTP_Reply() would mark
+ * the snapshot answered.
+ */
+static void send_nrc(const ISOTPReply_t *to, uint8_t sid, uint8_t nrc)
+{
+    const uint8_t response[] = {UDS_SID_NEGATIVE_RESPONSE, sid, nrc};
+
+    (void)ISOTP_TxQueue_Enqueue(to->source, to->target, to->message_id,
+                    response, (uint16_t)sizeof(response));
+}
+
+/**
+ * @brief Record the peer @p dialog is talking to now, not yet answered.
+ */
+static void reply_to(const ISOTPContext_t *dialog, ISOTPReply_t *out)
+{
+    out->source = dialog->source;
+    out->target = dialog->target;
+    out->message_id = dialog->message_id;
+    out->tx_complete = false;
+}
+
+void UDS_Worker_Init(void)
+{
+    UdsWorker_t *worker = getWorker();
+    const struct k_work_queue_config cfg = {
+        .name = "uds_wq",
+        .no_yield = false,
+        .essential = false,
+        .work_timeout_ms = 0U,
+    };
+
+    UDS_Init(&worker->uds, &worker->request.reply);
+    k_work_queue_init(getWorkQ());
+    k_work_queue_start(getWorkQ(), uds_work_stack,
+               K_THREAD_STACK_SIZEOF(uds_work_stack),
+               UDS_WORKER_PRIORITY, &cfg);
+    (void)k_work_schedule_for_queue(getWorkQ(), &maint_work,
+                    K_MSEC(UDS_WORKER_MAINT_MS));
+}
+
+bool UDS_Worker_Submit(const ISOTPContext_t *dialog, uint32_t now)
+{
+    UdsWorker_t *worker = getWorker();
+    bool accepted = false;
+
+    if (NULL == dialog) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (0 != atomic_get(&worker->busy)) {
+        /* One request at a time; the client retries. */
+        ISOTPReply_t requester;
+
+        reply_to(dialog, &requester);
+        OP_ERROR_DETAIL(OP_ERR_UDS_NRC, UDS_NRC_BUSY_REPEAT_REQUEST);
+        send_nrc(&requester, dialog->rx_buffer[UDS_SID_IDX],
+             UDS_NRC_BUSY_REPEAT_REQUEST);
+    } else {
+        uint16_t length = MIN(dialog->rx_data_length,
+                      (uint16_t)ISOTP_MAX_PAYLOAD);
+
+        reply_to(dialog, &worker->request.reply);
+        worker->request.length = length;
+        (void)memcpy(worker->request.payload, dialog->rx_buffer, length);
+        worker->sid = dialog->rx_buffer[UDS_SID_IDX];
+        worker->pending_due_ms = now + UDS_RESPONSE_PENDING_FIRST_MS;
+        (void)atomic_set(&worker->busy, 1);
+
+        Status_t rc = k_work_submit_to_queue(getWorkQ(), &request_work);
+        if (rc < 0) {
+            OP_ERROR_DETAIL(OP_ERR_QUEUE, (uint32_t)(-rc));
+            (void)atomic_clear(&worker->busy);
+        } else {
+            accepted = true;
+        }
+    }
+
+    return accepted;
+}
+
+void UDS_Worker_Poll(uint32_t now)
+{
+    UdsWorker_t *worker = getWorker();
+    uint32_t due = 0U;
+
+    if (UDS_Worker_NextDeadline(&due) && ((int32_t)(now - due) >= 0)) {
+        /* The worker may have queued its response since the unlocked check
+         * above; only under the queue hold is the answer final. */
+        ISOTP_TxQueue_Lock();
+        if (UDS_Worker_IsBusy() && (!worker->request.reply.tx_complete)) {
+            LOG_DBG("responsePending for SID 0x%02x", worker->sid);
+            send_nrc(&worker->request.reply, worker->sid,
+                 UDS_NRC_RESPONSE_PENDING);
+        }
+        ISOTP_TxQueue_Unlock();
+        worker->pending_due_ms = now + UDS_RESPONSE_PENDING_REPEAT_MS;
+    }
+}
+
+bool UDS_Worker_NextDeadline(uint32_t *deadline)
+{
+    const UdsWorker_t *worker = getWorker();
+    bool pending = false;
+
+    if (NULL == deadline) {
+        OP_ERROR(OP_ERR_NULL_PTR);
+    } else if (UDS_Worker_IsBusy() && (!worker->request.reply.tx_complete)) {
+        *deadline = worker->pending_due_ms;
+        pending = true;
+    } else {
+        /* Idle, or the response is already queued */
+    }
+
+    return pending;
+}
+
+bool UDS_Worker_IsBusy(void)
+{
+    return (0 != atomic_get(&getWorker()->busy));
+}
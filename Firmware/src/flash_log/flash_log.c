@@ -17,7 +17,10 @@
 #include "flash_log_entries.h"
 #include "flash_log_internal.h"
 #include "flash_log_fastseek.h"
+#include "flash_log_codec.h"
 #include "flash_log_reader.h"
+#include "flash_log_tail.h"
+#include "latency_trace.h"
 #include "heartbeat.h"
 #include "watchdog_feeder.h"
 #include "external_flash.h"
@@ -52,7 +55,8 @@ LOG_MODULE_REGISTER(flash_log, LOG_LEVEL_NONE);
  * Counts stay <= FCB's max (255) so f_sector_cnt (uint8_t) and the static
  * f_sectors[] arrays stay small (8 B/sector: 1536 B telemetry + 256 B
  * text). Capacity: telemetry 192 × 256 KiB = 48 MiB, text
- * 32 × 256 KiB = 8 MiB — matching the partition sizes in divecan_jr.dts.
+ * 32 × 256 KiB = 8 MiB — the partitions in divecan_jr.dts add one
+ * FL_SECTOR_SUMMARY_RESERVE unit per sector behind that.
  */
 #define FL_SECTOR_SIZE  CONFIG_FLASH_LOG_SECTOR_SIZE
 /* "DCLH" — bumped from "DCLG" (0x44434C47) when the FCB geometry changed from
@@ -65,12 +69,21 @@ LOG_MODULE_REGISTER(flash_log, LOG_LEVEL_NONE);
  * entry walk), so the watchdog-safe recovery erase below cleans the partition
  * once and subsequent mounts are fast. Bump this again on any future on-flash
  * format/geometry change. */
-#define FL_FCB_MAGIC    0x44434C4CU  /* "DCLL" — CRC-disabled fixed-end-marker +
-                                      * batched-telemetry entry format. Bump on any
-                                      * on-flash format change (also forces a
-                                      * one-shot recovery erase of older data). */
+#define FL_FCB_MAGIC    0x44434C4FU  /* "DCLO" — sector summaries moved out of
+                                      * the sector tails into a summary area
+                                      * behind the FCB, which owns whole
+                                      * sectors again (was "DCLN": packed
+                                      * FL_TYPE_BATCH_PACKED telemetry batches).
+                                      * Bump on any on-flash format change (also
+                                      * forces a one-shot recovery erase of older
+                                      * data). */
 #define FL_FCB_VERSION  2
 
+BUILD_ASSERT((FL_SECTOR_SUMMARY_RESERVE % FL_ERASE_BLOCK) == 0U,
+             "sector summary reserve must be a whole number of erase blocks");
+BUILD_ASSERT(FL_SECTOR_SUMMARY_RESERVE < FL_SECTOR_SIZE,
+             "sector summary reserve must be smaller than a sector");
+
 /* Ingest slot layout — header + bounded payload. The msgq is statically
  * sized to absorb a single block-erase worst case (~400 ms) at the peak
  * producer rate of a few hundred bytes/sec. */
@@ -83,6 +96,12 @@ typedef struct {
              (sizeof(uint8_t) * 2) - sizeof(uint16_t) - sizeof(uint64_t)];
 } LogIngestSlot_t;
 
+BUILD_ASSERT(sizeof(fl_payload_latency_summary_t) == LATENCY_SUMMARY_BYTES,
+             "latency summary payload must match latency_trace_serialise()");
+BUILD_ASSERT(sizeof(fl_payload_latency_summary_t) <=
+             sizeof(((LogIngestSlot_t *)0)->payload),
+             "latency summary must fit one ingest slot");
+
 K_MSGQ_DEFINE(fl_ingest_msgq, sizeof(LogIngestSlot_t),
               CONFIG_FLASH_LOG_QUEUE_DEPTH, 4);
 
@@ -238,15 +257,175 @@ static void fl_bump_index_epoch(void)
     (void)atomic_inc(&fl_index_epoch);
 }
 
+/* ---- Active-sector summary tracking ----
+ *
+ * The writer keeps a running FlashLogSectorSummary_t for each FCB's active
+ * sector, seeded at mount from the fast-seek scan and folded on every marker
+ * it writes. When an append lands in a new sector the previous one is closed:
+ * its summary is programmed into that sector's summary unit (see
+ * flash_log_sector_summary_off()), which is what lets a cold reader index
+ * build read one record per sector instead of walking the ring. `complete` is
+ * false when the mount-time scan could not read the whole active sector —
+ * that sector then gets no summary and the reader falls back to walking it.
+ * Touched only under the external-flash lock (writer thread, mount, erase). */
+typedef struct {
+    const struct flash_sector *sector; /* sector `summary` describes */
+    bool complete;                     /* summary covers every entry in it */
+    FlashLogSectorSummary_t summary;
+} fl_sector_track_t;
+
+static fl_sector_track_t *fl_get_sector_track(const struct fcb *fcb_p)
+{
+    static fl_sector_track_t telemetry;
+    static fl_sector_track_t text;
+    fl_sector_track_t *result = NULL;
+
+    if (fcb_p == &fl_telemetry_fcb) {
+        result = &telemetry;
+    } else if (fcb_p == &fl_text_fcb) {
+        result = &text;
+    } else {
+        result = NULL;
+    }
+    return result;
+}
+
+/* Restart tracking on the FCB's current active sector. */
+static void fl_sector_track_restart(const struct fcb *fcb_p, bool complete)
+{
+    fl_sector_track_t *t = fl_get_sector_track(fcb_p);
+
+    if (t != NULL) {
+        flash_log_sector_summary_reset(&t->summary);
+        t->sector = fcb_p->f_active.fe_sector;
+        t->complete = complete;
+    }
+}
+
+/* fl_fast_seek_active_visit() callback: fold each active-sector entry. */
+static void fl_sector_track_visit(void *arg, const uint8_t *data, uint16_t len)
+{
+    flash_log_sector_summary_fold_entry(arg, data, len);
+}
+
+/* True when a summary unit read back from flash is still erased. */
+static bool fl_summary_unit_blank(const FlashLogSectorSummary_t *unit)
+{
+    const uint8_t *bytes = (const uint8_t *)unit;
+    bool blank = true;
+
+    for (size_t i = 0U; i < sizeof(*unit); ++i) {
+        if (0xFFU != bytes[i]) {
+            blank = false;
+        }
+    }
+    return blank;
+}
+
+/**
+ * @brief Program a closed sector's summary into its summary unit.
+ *
+ * The unit is normally blank already: fl_rotate() erases it when the sector
+ * leaves the ring, so closing a sector costs a 20 B program. It is erased
+ * here only when a reset fell between a rotation and that erase.
+ *
+ * Skipped when the tracked copy is incomplete, or when the sector already
+ * left the ring (fcb_rotate on a one-sector ring erases the sector it moves
+ * off). A failure is not propagated — the reader just walks that sector.
+ */
+static void fl_sector_summary_commit(const struct fcb *fcb_p,
+                                     fl_sector_track_t *t)
+{
+    uint16_t id = 0U;
+
+    if (t->complete && (t->sector != NULL) &&
+        flash_log_sector_live_id(fcb_p, t->sector, &id)) {
+        off_t off = flash_log_sector_summary_off(fcb_p, t->sector);
+        FlashLogSectorSummary_t unit = {0};
+        Status_t rc = flash_area_read(fcb_p->fap, off, &unit, sizeof(unit));
+
+        flash_log_sector_summary_seal(&t->summary, id);
+        if ((0 == rc) && (!fl_summary_unit_blank(&unit))) {
+            rc = flash_area_erase(fcb_p->fap, off, FL_SECTOR_SUMMARY_RESERVE);
+        }
+        if (0 == rc) {
+            (void)flash_area_write(fcb_p->fap, off, &t->summary,
+                                   sizeof(t->summary));
+        }
+    }
+}
+
+/**
+ * @brief fcb_rotate(), then erase the rotated-out sector's summary unit so
+ *        it is blank before FCB reuses the sector.
+ *
+ * FCB erases only the whole, block-aligned sector it owns; the unit lives in
+ * the summary area behind it, so a rotation costs one extra FL_ERASE_BLOCK
+ * erase. Caller holds the external-flash lock.
+ */
+static Status_t fl_rotate(struct fcb *fcb_p)
+{
+    const struct flash_sector *oldest = fcb_p->f_oldest;
+    Status_t rc = fcb_rotate(fcb_p);
+
+    if ((0 == rc) && (oldest != NULL)) {
+        (void)flash_area_erase(fcb_p->fap,
+                               flash_log_sector_summary_off(fcb_p, oldest),
+                               FL_SECTOR_SUMMARY_RESERVE);
+    }
+    return rc;
+}
+
+/* Called after every successful fcb_append: an entry landing outside the
+ * tracked sector means FCB opened a new one, so close out the old. */
+static void fl_sector_track_append(const struct fcb *fcb_p,
+                                   const struct fcb_entry *loc)
+{
+    fl_sector_track_t *t = fl_get_sector_track(fcb_p);
+
+    if ((t != NULL) && (loc->fe_sector != t->sector)) {
+        fl_sector_summary_commit(fcb_p, t);
+        /* The new sector was empty until this append. */
+        fl_sector_track_restart(fcb_p, true);
+    }
+}
+
+Status_t flash_log_internal_active_summary(FlashLogDest_t dest,
+                                           FlashLogIndexEntry_t *out)
+{
+    Status_t rc = -ENODATA;
+    const struct fcb *fcb_p = fl_get_fcb(dest);
+    const fl_sector_track_t *t = fl_get_sector_track(fcb_p);
+
+    if ((t != NULL) && (out != NULL) && t->complete &&
+        (t->sector != NULL) && (t->sector == fcb_p->f_active.fe_sector)) {
+        out->first_boot_id = t->summary.first_boot_id;
+        out->first_dive_id = t->summary.first_dive_id;
+        out->flags = t->summary.flags;
+        rc = 0;
+    }
+    return rc;
+}
+
 /* ---- Enqueue dispatch (producer side) ----
  *
  * Build a slot, push to k_msgq with K_NO_WAIT. On overflow bump the
  * per-FCB drop counter and stash the last-dropped type. Never blocks,
  * never calls LOG_x.
+ *
+ * Telemetry records are also offered to the live tail (flash_log_tail.h)
+ * before the mount check, so a bench subscriber still sees them when the
+ * NOR failed to mount.
  */
 static void fl_enqueue(FlashLogDest_t dest, uint8_t type,
                const void *payload, uint16_t length)
 {
+    uint64_t ts_us = fl_now_us();
+
+    if (FL_DEST_TELEMETRY == dest) {
+        flash_log_tail_offer(type, ts_us, payload, length);
+    }
+
     if (0 != atomic_get(&fl_initialized)) {
         uint16_t copy_length = length;
 
@@ -259,7 +438,7 @@ static void fl_enqueue(FlashLogDest_t dest, uint8_t type,
             .dest = (uint8_t)dest,
             .type = type,
             .length = copy_length,
-            .ts_us = fl_now_us(),
+            .ts_us = ts_us,
             .payload = {0},
         };
         if ((payload != NULL) && (copy_length > 0U)) {
@@ -443,6 +622,13 @@ void flash_log_enqueue_power_snapshot(const FlashLogPowerSnapshot_t *snapshot)
     }
 }
 
+void flash_log_enqueue_latency_summary(const uint8_t *summary, uint16_t length)
+{
+    if ((summary != NULL) && (sizeof(fl_payload_latency_summary_t) == length)) {
+        fl_enqueue(FL_DEST_TELEMETRY, FL_TYPE_LATENCY_SUMMARY, summary, length);
+    }
+}
+
 void flash_log_enqueue_cell_raw(const OxygenCellMsg_t *cell)
 {
     /* DiveO2 cells fill the temp/err/phase/intensity/ambient/pressure/
@@ -571,6 +757,14 @@ void flash_log_enqueue_text(uint8_t level, uint16_t module_id,
  * the larger of the two original buffers. */
 static uint8_t fl_writer_scratch[sizeof(fl_entry_hdr_t) + CONFIG_FLASH_LOG_MAX_ENTRY_BYTES];
 
+/* A packed batch sub-record is encoded whole into the scratch before it is
+ * programmed, so the scratch must hold the worst-case encoding of any slot. */
+BUILD_ASSERT(sizeof(fl_writer_scratch) >= FL_CODEC_FIELDS_MAX_BYTES,
+             "writer scratch too small for a field-coded batch record");
+BUILD_ASSERT(sizeof(fl_writer_scratch) >=
+             FL_CODEC_RAW_MAX_BYTES(sizeof(((LogIngestSlot_t *)0)->payload)),
+             "writer scratch too small for a raw batch record");
+
 /**
  * @brief Flash-area byte offset of an FCB entry's data, as an off_t.
  *
@@ -640,7 +834,7 @@ static Status_t fl_write_entry_to_fcb(struct fcb *fcb_p, uint8_t type,
         rc = fcb_append(fcb_p, (uint16_t)(sizeof(hdr) + length), &loc);
         if ((0 != rc) && (-ENOSPC == rc)) {
             /* Ring is full — erase oldest sector and retry once. */
-            rc = fcb_rotate(fcb_p);
+            rc = fl_rotate(fcb_p);
             if (0 == rc) {
                 rc = fcb_append(fcb_p,
                         (uint16_t)(sizeof(hdr) + length),
@@ -649,10 +843,19 @@ static Status_t fl_write_entry_to_fcb(struct fcb *fcb_p, uint8_t type,
         }
 
         if (0 == rc) {
+            fl_sector_track_append(fcb_p, &loc);
             rc = fl_program_entry(fcb_p, &loc, &hdr, payload, length);
             if (0 == rc) {
                 rc = fcb_append_finish(fcb_p, &loc);
             }
+            if ((0 == rc) && fl_is_marker_type(type)) {
+                fl_sector_track_t *t = fl_get_sector_track(fcb_p);
+
+                if (t != NULL) {
+                    flash_log_sector_summary_fold(&t->summary, type,
+                                                  payload, length);
+                }
+            }
         }
         external_flash_release();
     }
@@ -758,74 +961,28 @@ static uint64_t fl_batch_decode_ts(const uint8_t *p)
 }
 
 /**
- * @brief Write one telemetry sub-record ([fl_entry_hdr_t + payload]) into the
- *        already-reserved FL_TYPE_BATCH entry, coalescing header + payload into
- *        a single flash write where they fit the writer scratch buffer.
+ * @brief Pass B: packed-encode every staged telemetry sub-record into the
+ *        reserved container entry, one flash write per sub-record.
  *
- * @param fcb_p   Target FCB (telemetry).
- * @param woff    In/out flash write offset; advanced by the bytes written.
- * @param type    Sub-record entry type.
- * @param ts      Sub-record boot timestamp (us).
- * @param payload Sub-record payload bytes (may be NULL when length is 0).
- * @param length  Payload length in bytes.
- * @return 0 on success or a negative flash_area_write error code.
- */
-static Status_t fl_write_batch_subrecord(const struct fcb *fcb_p, off_t *woff,
-                     uint8_t type, uint64_t ts,
-                     const uint8_t *payload, uint16_t length)
-{
-    fl_entry_hdr_t sh = {
-        .type = type,
-        .flags = 0U,
-        .length = length,
-        .ts_boot_us = ts,
-    };
-    size_t wlen = sizeof(sh) + length;
-    Status_t rc = 0;
-
-    if (wlen <= sizeof(fl_writer_scratch)) {
-        (void)memcpy(fl_writer_scratch, &sh, sizeof(sh));
-        if (length > 0U) {
-            (void)memcpy(&fl_writer_scratch[sizeof(sh)], payload, length);
-        }
-        rc = flash_area_write(fcb_p->fap, *woff, fl_writer_scratch, wlen);
-    } else {
-        rc = flash_area_write(fcb_p->fap, *woff, &sh, sizeof(sh));
-        if ((0 == rc) && (length > 0U)) {
-            rc = flash_area_write(fcb_p->fap, *woff + (off_t)sizeof(sh),
-                          payload, length);
-        }
-    }
-    *woff += (off_t)wlen;
-    return rc;
-}
-
-/**
- * @brief Reserve, fill, and finish the single FCB container entry for one
- *        telemetry batch flush (flash-side half of fl_write_telemetry_batch).
- *
- * Acquires the shared NOR, appends one FL_TYPE_BATCH entry sized for the whole
- * batch (rotating once on a full ring), streams each staged telemetry
- * sub-record into it, and finishes the entry only when every write succeeded.
- *
- * @param fcb_p    Telemetry FCB.
- * @param total    Total packed sub-record bytes (from the caller's Pass A).
- * @param first_ts Timestamp of the first sub-record, used as the entry's.
- */
-/**
- * @brief Pass B: stream every staged telemetry sub-record into the reserved
- *        container entry, one coalesced flash write per sub-record.
+ * Each record is encoded into the writer scratch buffer (an encoded record
+ * is never larger than the ingest slot it came from) and programmed straight
+ * behind the previous one.
  *
  * @param fcb_p Telemetry FCB.
  * @param woff  In/out: write offset inside the reserved entry.
+ * @param codec Codec state, re-initialised here against the container ts.
+ * @param first_ts Container header ts_boot_us.
  * @return 0 when every sub-record landed, else the first write error.
  */
-static Status_t fl_batch_write_subrecords(struct fcb *fcb_p, off_t *woff)
+static Status_t fl_batch_write_subrecords(struct fcb *fcb_p, off_t *woff,
+                                          FlashLogCodec_t *codec,
+                                          uint64_t first_ts)
 {
     Status_t rc = 0;
     size_t off = 0U;
     bool truncated = false;
 
+    flash_log_codec_init(codec, fl_batch_buf, first_ts);
     while ((0 == rc) && ((off + FL_BATCH_HDR_BYTES) <= fl_batch_len) &&
            (!truncated)) {
         const uint8_t *p = &fl_batch_buf[off];
@@ -838,9 +995,16 @@ static Status_t fl_batch_write_subrecords(struct fcb *fcb_p, off_t *woff)
             truncated = true;
         } else {
             if ((FL_DEST_TELEMETRY == dest) && (!fl_is_marker_type(type))) {
-                rc = fl_write_batch_subrecord(fcb_p, woff, type,
+                size_t wlen = flash_log_codec_encode(codec, type,
                                   fl_batch_decode_ts(p),
-                                  &p[FL_BATCH_HDR_BYTES], length);
+                                  &p[FL_BATCH_HDR_BYTES], length,
+                                  fl_writer_scratch);
+
+                if (wlen > 0U) {
+                    rc = flash_area_write(fcb_p->fap, *woff,
+                                  fl_writer_scratch, wlen);
+                    *woff += (off_t)wlen;
+                }
             }
             off += rec;
         }
@@ -848,8 +1012,22 @@ static Status_t fl_batch_write_subrecords(struct fcb *fcb_p, off_t *woff)
     return rc;
 }
 
+/**
+ * @brief Reserve, fill, and finish the single FCB container entry for one
+ *        telemetry batch flush (flash-side half of fl_write_telemetry_batch).
+ *
+ * Acquires the shared NOR, appends one FL_TYPE_BATCH_PACKED entry sized for
+ * the whole batch (rotating once on a full ring), streams each staged
+ * telemetry sub-record into it, and finishes the entry only when every write
+ * succeeded.
+ *
+ * @param fcb_p    Telemetry FCB.
+ * @param total    Total encoded sub-record bytes (from the caller's Pass A).
+ * @param first_ts Timestamp of the first sub-record, used as the entry's.
+ * @param codec    Caller's codec state, reused for Pass B.
+ */
 static void fl_batch_write_container(struct fcb *fcb_p, size_t total,
-                                     uint64_t first_ts)
+                                     uint64_t first_ts, FlashLogCodec_t *codec)
 {
     Status_t rc = external_flash_acquire(K_FOREVER);
 
@@ -859,7 +1037,7 @@ static void fl_batch_write_container(struct fcb *fcb_p, size_t total,
         /* Reserve one FCB entry for the whole batch (rotate once on a full
          * ring). */
         fl_entry_hdr_t bhdr = {
-            .type = FL_TYPE_BATCH,
+            .type = FL_TYPE_BATCH_PACKED,
             .flags = 0U,
             .length = (uint16_t)total,
             .ts_boot_us = first_ts,
@@ -868,7 +1046,7 @@ static void fl_batch_write_container(struct fcb *fcb_p, size_t total,
 
         rc = fcb_append(fcb_p, (uint16_t)(sizeof(bhdr) + total), &loc);
         if (-ENOSPC == rc) {
-            rc = fcb_rotate(fcb_p);
+            rc = fl_rotate(fcb_p);
             if (0 == rc) {
                 rc = fcb_append(fcb_p, (uint16_t)(sizeof(bhdr) + total), &loc);
             }
@@ -876,10 +1054,11 @@ static void fl_batch_write_container(struct fcb *fcb_p, size_t total,
         if (0 == rc) {
             off_t woff = fl_entry_data_off(&loc);
 
+            fl_sector_track_append(fcb_p, &loc);
             rc = flash_area_write(fcb_p->fap, woff, &bhdr, sizeof(bhdr));
             woff += (off_t)sizeof(bhdr);
             if (0 == rc) {
-                rc = fl_batch_write_subrecords(fcb_p, &woff);
+                rc = fl_batch_write_subrecords(fcb_p, &woff, codec, first_ts);
             }
             if (0 == rc) {
                 (void)fcb_append_finish(fcb_p, &loc);
@@ -890,12 +1069,19 @@ static void fl_batch_write_container(struct fcb *fcb_p, size_t total,
 }
 
 /* Write all TELEMETRY non-marker records staged in fl_batch_buf as ONE FCB entry
- * (a FL_TYPE_BATCH container). The fast-filling telemetry ring then gets ~one FCB
- * entry per 2 s flush instead of one per record, so fcb_init()'s per-boot
- * active-sector walk is bounded by FLUSH count, not RECORD count — the fix for the
- * boot grind on the 48 MB / 256 KiB geometry over slow SPI NOR. The batch payload
- * is a packed sequence of [fl_entry_hdr_t + sub-payload], identical to how
- * standalone entries are laid out on flash, so a reader just recurses into it. */
+ * (a FL_TYPE_BATCH_PACKED container). The fast-filling telemetry ring then gets
+ * ~one FCB entry per 2 s flush instead of one per record, so fcb_init()'s
+ * per-boot active-sector walk is bounded by FLUSH count, not RECORD count — the
+ * fix for the boot grind on the 48 MB / 256 KiB geometry over slow SPI NOR.
+ *
+ * The payload is the packed encoding from flash_log_codec.h rather than the
+ * legacy [fl_entry_hdr_t + sub-payload] sequence: the 12-byte per-record
+ * header (mostly an absolute u64 timestamp) outweighed the 14-byte consensus
+ * payload it framed, and consensus at 10 Hz dominates the telemetry budget.
+ * Delta timestamps plus per-field deltas roughly halve the bytes per record,
+ * which stretches the ring's retention and shortens downloads by the same
+ * factor. The codec needs a sizing pass before fcb_append() can reserve the
+ * entry, so Pass A runs the encoder without output. */
 static void fl_write_telemetry_batch(void)
 {
     struct fcb *fcb_p = fl_get_fcb(FL_DEST_TELEMETRY);
@@ -903,7 +1089,8 @@ static void fl_write_telemetry_batch(void)
         return;
     }
 
-    /* Pass A: total sub-record bytes + first timestamp. */
+    /* Pass A: total encoded bytes + first timestamp. */
+    FlashLogCodec_t codec;
     size_t total = 0U;
     uint64_t first_ts = 0U;
     bool have = false;
@@ -923,15 +1110,18 @@ static void fl_write_telemetry_batch(void)
             if ((FL_DEST_TELEMETRY == dest) && (!fl_is_marker_type(type))) {
                 if (!have) {
                     first_ts = fl_batch_decode_ts(p);
+                    flash_log_codec_init(&codec, fl_batch_buf, first_ts);
                     have = true;
                 }
-                total += sizeof(fl_entry_hdr_t) + length;
+                total += flash_log_codec_encode(&codec, type,
+                                  fl_batch_decode_ts(p),
+                                  &p[FL_BATCH_HDR_BYTES], length, NULL);
             }
             off += rec;
         }
     }
     if (have) {
-        fl_batch_write_container(fcb_p, total, first_ts);
+        fl_batch_write_container(fcb_p, total, first_ts, &codec);
     }
 }
 
@@ -990,9 +1180,9 @@ static void fl_flush_marker_or_text(FlashLogDest_t dest, uint8_t type,
 
 /* Write every staged entry to its FCB in one burst, then reset. Markers (mirrored
  * to both FCBs) and TEXT records go as individual entries; TELEMETRY records are
- * coalesced into one FL_TYPE_BATCH entry (see fl_write_telemetry_batch). Wrapped
- * in heartbeat_set_long_op so a sector rotation/erase mid-burst can't trip the
- * watchdog. */
+ * coalesced into one FL_TYPE_BATCH_PACKED entry (see fl_write_telemetry_batch).
+ * Wrapped in heartbeat_set_long_op so a sector rotation/erase mid-burst can't
+ * trip the watchdog. */
 static void fl_batch_flush(void)
 {
     if (fl_batch_len != 0U) {
@@ -1163,10 +1353,20 @@ static void fl_populate_sectors(struct flash_sector *arr, off_t base,
     ARG_UNUSED(base);
     for (size_t i = 0; i < count; ++i) {
         arr[i].fs_off = (off_t)i * FL_SECTOR_SIZE;
+        /* Whole sectors, so every FCB erase stays erase-block aligned. The
+         * summary units live behind the last sector. */
         arr[i].fs_size = FL_SECTOR_SIZE;
     }
 }
 
+/* Partition bytes an FCB of @p count sectors needs: the sectors plus their
+ * summary area. */
+static size_t fl_partition_bytes(uint8_t count)
+{
+    return (size_t)count *
+           ((size_t)FL_SECTOR_SIZE + (size_t)FL_SECTOR_SUMMARY_RESERVE);
+}
+
 /* Mount diagnostics (struct fl_mount_stats in flash_log_fastseek.h). */
 volatile struct fl_mount_stats *fl_mount_stats_telemetry(void)
 {
@@ -1182,30 +1382,58 @@ volatile struct fl_mount_stats *fl_mount_stats_text(void)
     return &stats;
 }
 
+/* Seek the active-sector cursor and, from the same bulk reads, rebuild the
+ * writer's running summary of whatever that sector already holds. */
+static void fl_mount_seek(struct fcb *fcb_p,
+                          volatile struct fl_mount_stats *stats)
+{
+    fl_sector_track_t *t = fl_get_sector_track(fcb_p);
+    bool complete = false;
+
+    flash_log_sector_summary_reset(&t->summary);
+    complete = fl_fast_seek_active_visit(fcb_p, stats, fl_batch_buf,
+                                         FL_BATCH_BUF_BYTES,
+                                         fl_sector_track_visit, &t->summary);
+    t->sector = fcb_p->f_active.fe_sector;
+    t->complete = complete;
+}
+
 static Status_t fl_mount_fcb(struct fcb *fcb_p, struct flash_sector *sectors,
             int32_t area_id, off_t partition_offset, uint8_t sector_count,
             volatile struct fl_mount_stats *stats)
 {
-    fl_populate_sectors(sectors, partition_offset, sector_count);
+    const struct flash_area *fa = NULL;
+    Status_t rc = flash_area_open((uint8_t)area_id, &fa);
 
-    fcb_p->f_magic = FL_FCB_MAGIC;
-    fcb_p->f_version = FL_FCB_VERSION;
-    fcb_p->f_sector_cnt = sector_count;
-    fcb_p->f_scratch_cnt = 1U;
-    fcb_p->f_sectors = sectors;
-    Status_t rc = external_flash_acquire(K_FOREVER);
+    /* A partition without room for the summary area is a build
+     * misconfiguration: refuse it (-ENOSPC reaches OP_ERR_FLASH) rather than
+     * recovery-erase it. */
     if (0 == rc) {
-        rc = fcb_init(area_id, fcb_p);
-        if (0 == rc) {
-            fl_fast_seek_active(fcb_p, stats, fl_batch_buf, FL_BATCH_BUF_BYTES);
+        if (fa->fa_size < fl_partition_bytes(sector_count)) {
+            rc = -ENOSPC;
         }
-        external_flash_release();
-        watchdog_kick();
+        flash_area_close(fa);
     }
-    if (0 != rc) {
-        const struct flash_area *fa = NULL;
 
-        if (0 == flash_area_open((uint8_t)area_id, &fa)) {
+    if (0 == rc) {
+        fl_populate_sectors(sectors, partition_offset, sector_count);
+
+        fcb_p->f_magic = FL_FCB_MAGIC;
+        fcb_p->f_version = FL_FCB_VERSION;
+        fcb_p->f_sector_cnt = sector_count;
+        fcb_p->f_scratch_cnt = 1U;
+        fcb_p->f_sectors = sectors;
+        rc = external_flash_acquire(K_FOREVER);
+        if (0 == rc) {
+            rc = fcb_init(area_id, fcb_p);
+            if (0 == rc) {
+                fl_mount_seek(fcb_p, stats);
+            }
+            external_flash_release();
+            watchdog_kick();
+        }
+        if ((0 != rc) && (0 == flash_area_open((uint8_t)area_id, &fa))) {
+            /* The whole partition, summary area included. */
             heartbeat_set_long_op(true);
             (void)external_flash_area_erase(fa, 0U, fa->fa_size);
             heartbeat_set_long_op(false);
@@ -1214,7 +1442,7 @@ static Status_t fl_mount_fcb(struct fcb *fcb_p, struct flash_sector *sectors,
             if (0 == rc) {
                 rc = fcb_init(area_id, fcb_p);
                 if (0 == rc) {
-                    fl_fast_seek_active(fcb_p, stats, fl_batch_buf, FL_BATCH_BUF_BYTES);
+                    fl_mount_seek(fcb_p, stats);
                 }
                 external_flash_release();
             }
@@ -1462,9 +1690,13 @@ static Status_t fl_fcb_clear_fed(struct fcb *fcbp)
     if (0 == rc) {
         while ((!empty) && (0 == rc)) {
             watchdog_kick();
-            rc = fcb_rotate(fcbp);
+            rc = fl_rotate(fcbp);
             empty = (0 != fcb_is_empty(fcbp));
         }
+        if (empty) {
+            /* Every sector and its summary unit was erased. */
+            fl_sector_track_restart(fcbp, true);
+        }
         external_flash_release();
     }
     watchdog_kick();
@@ -0,0 +1,303 @@
+/**
+ * @file flash_log_aggregate.c
+ * @brief Time-bucket aggregation — see flash_log_aggregate.h.
+ *
+ * Each aggregated type is described as a list of numeric fields (offset and
+ * width in its packed payload), in the order its aggregate carries them.
+ * Bit fields, error codes, ages and sentinel-bearing fields (status_packed,
+ * err_code, battery_threshold, the Poseidon percentage) are left out: a
+ * min / mean / max of them means nothing. The mean is a running mean, so a
+ * long bucket of large values (ambient pressure in µbar) does not lose
+ * precision to a float sum.
+ */
+
+#include "flash_log_aggregate.h"
+#include "flash_log.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/sys/util.h>
+
+#define FL_AGG_SLOT_CONSENSUS  0U
+#define FL_AGG_SLOT_POWER      1U
+#define FL_AGG_SLOT_CELL0      2U
+#define FL_AGG_CELL_CHANNELS   7U
+
+/** @brief Encoding of one aggregated payload field. */
+typedef enum {
+    FL_AGG_U8,
+    FL_AGG_U16,
+    FL_AGG_I32,
+    FL_AGG_F32,
+} fl_agg_kind_t;
+
+typedef struct {
+    uint8_t offset;
+    uint8_t kind;   /* fl_agg_kind_t */
+} fl_agg_field_t;
+
+/** @brief Numeric channels of one aggregated payload type. */
+typedef struct {
+    uint8_t type;
+    uint8_t keyed;          /* 1 = first byte is the cell_index key */
+    uint8_t payload_len;
+    uint8_t field_count;
+    fl_agg_field_t fields[FL_AGG_MAX_CHANNELS];
+} fl_agg_schema_t;
+
+#define FL_AGG_FIELD(type_t, member, extra, kind) \
+    { (uint8_t)(offsetof(type_t, member) + (extra)), (kind) }
+
+static const fl_agg_schema_t fl_agg_schemas[] = {
+    /* consensus_ppo2, ppo2_array[3], milli_array[3], confidence, setpoint */
+    { FL_TYPE_CONSENSUS, 0U, (uint8_t)sizeof(fl_payload_consensus_t), 9U, {
+        FL_AGG_FIELD(fl_payload_consensus_t, consensus_ppo2, 0U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_consensus_t, ppo2_array, 0U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_consensus_t, ppo2_array, 1U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_consensus_t, ppo2_array, 2U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_consensus_t, milli_array, 0U, FL_AGG_U16),
+        FL_AGG_FIELD(fl_payload_consensus_t, milli_array, 2U, FL_AGG_U16),
+        FL_AGG_FIELD(fl_payload_consensus_t, milli_array, 4U, FL_AGG_U16),
+        FL_AGG_FIELD(fl_payload_consensus_t, confidence, 0U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_consensus_t, setpoint, 0U, FL_AGG_U8),
+    } },
+    /* vbus, vcc, battery, CAN voltages, current_ua */
+    { FL_TYPE_POWER_SNAPSHOT, 0U, (uint8_t)sizeof(fl_payload_power_snapshot_t), 5U, {
+        FL_AGG_FIELD(fl_payload_power_snapshot_t, vbus_voltage, 0U, FL_AGG_F32),
+        FL_AGG_FIELD(fl_payload_power_snapshot_t, vcc_voltage, 0U, FL_AGG_F32),
+        FL_AGG_FIELD(fl_payload_power_snapshot_t, battery_voltage, 0U, FL_AGG_F32),
+        FL_AGG_FIELD(fl_payload_power_snapshot_t, can_voltage, 0U, FL_AGG_F32),
+        FL_AGG_FIELD(fl_payload_power_snapshot_t, current_ua, 0U, FL_AGG_I32),
+    } },
+    /* ppo2, temperature, phase, intensity, ambient light, ambient pressure,
+     * humidity */
+    { FL_TYPE_CELL_RAW_DIVEO2, 1U, (uint8_t)sizeof(fl_payload_cell_diveo2_t), 7U, {
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, ppo2, 0U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, temperature_mc, 0U, FL_AGG_I32),
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, phase_mdeg, 0U, FL_AGG_I32),
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, signal_intensity_uv, 0U, FL_AGG_I32),
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, ambient_light_uv, 0U, FL_AGG_I32),
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, ambient_pressure_ubar, 0U, FL_AGG_I32),
+        FL_AGG_FIELD(fl_payload_cell_diveo2_t, housing_humidity_mpercent_rh, 0U, FL_AGG_I32),
+    } },
+    /* ppo2 */
+    { FL_TYPE_CELL_RAW_O2S, 1U, (uint8_t)sizeof(fl_payload_cell_o2s_t), 1U, {
+        FL_AGG_FIELD(fl_payload_cell_o2s_t, ppo2, 0U, FL_AGG_U8),
+    } },
+    /* ppo2, raw_adc, millivolts */
+    { FL_TYPE_CELL_RAW_ANALOG, 1U, (uint8_t)sizeof(fl_payload_cell_analog_t), 3U, {
+        FL_AGG_FIELD(fl_payload_cell_analog_t, ppo2, 0U, FL_AGG_U8),
+        FL_AGG_FIELD(fl_payload_cell_analog_t, raw_adc, 0U, FL_AGG_I32),
+        FL_AGG_FIELD(fl_payload_cell_analog_t, millivolts, 0U, FL_AGG_U16),
+    } },
+};
+
+/* First channel of each accumulator in FlashLogAggregator_t::channels. */
+static const uint8_t fl_agg_slot_base[FL_AGG_SLOT_COUNT] = {
+    0U, 9U, 14U, 14U + FL_AGG_CELL_CHANNELS, 14U + (2U * FL_AGG_CELL_CHANNELS),
+};
+
+BUILD_ASSERT((14U + (FL_AGG_CELL_SLOTS * FL_AGG_CELL_CHANNELS)) ==
+             FL_AGG_CHANNEL_STORE, "aggregate channel store layout");
+BUILD_ASSERT(sizeof(fl_agg_channel_t) == 12U, "aggregate channel layout");
+BUILD_ASSERT(sizeof(fl_payload_aggregate_t) == 8U, "aggregate prefix layout");
+
+static const fl_agg_schema_t *fl_agg_schema(uint8_t type)
+{
+    const fl_agg_schema_t *found = NULL;
+
+    for (size_t i = 0U; (i < ARRAY_SIZE(fl_agg_schemas)) && (NULL == found); ++i) {
+        if (fl_agg_schemas[i].type == type) {
+            found = &fl_agg_schemas[i];
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Accumulator for a record of schema @p s.
+ * @return Slot index, or FL_AGG_SLOT_COUNT when the record has none.
+ */
+static size_t fl_agg_slot(const fl_agg_schema_t *s, const fl_entry_hdr_t *hdr,
+                          const uint8_t *payload)
+{
+    size_t slot = FL_AGG_SLOT_COUNT;
+
+    if (0U == s->keyed) {
+        slot = (FL_TYPE_CONSENSUS == s->type) ? FL_AGG_SLOT_CONSENSUS
+                                               : FL_AGG_SLOT_POWER;
+    } else if ((NULL != payload) && (hdr->length > 0U) &&
+               (payload[0] < FL_AGG_CELL_SLOTS)) {
+        slot = FL_AGG_SLOT_CELL0 + payload[0];
+    } else {
+        /* No action required — no accumulator for this cell */
+    }
+    return slot;
+}
+
+static float fl_agg_field_value(const uint8_t *payload, const fl_agg_field_t *f)
+{
+    float value = 0.0f;
+    const uint8_t *at = &payload[f->offset];
+
+    if (FL_AGG_U8 == f->kind) {
+        value = (float)at[0];
+    } else if (FL_AGG_U16 == f->kind) {
+        uint16_t v = 0U;
+
+        (void)memcpy(&v, at, sizeof(v));
+        value = (float)v;
+    } else if (FL_AGG_I32 == f->kind) {
+        int32_t v = 0;
+
+        (void)memcpy(&v, at, sizeof(v));
+        value = (float)v;
+    } else {
+        (void)memcpy(&value, at, sizeof(value));
+    }
+    return value;
+}
+
+void flash_log_agg_init(FlashLogAggregator_t *a, uint32_t bucket_us)
+{
+    (void)memset(a, 0, sizeof(*a));
+    a->bucket_us = bucket_us;
+}
+
+bool flash_log_agg_handles(uint8_t type)
+{
+    return NULL != fl_agg_schema(type);
+}
+
+size_t flash_log_agg_next_pending(const FlashLogAggregator_t *a, size_t from)
+{
+    size_t slot = from;
+
+    while ((slot < FL_AGG_SLOT_COUNT) && (0U == a->slots[slot].count)) {
+        ++slot;
+    }
+    return slot;
+}
+
+bool flash_log_agg_must_flush(const FlashLogAggregator_t *a,
+                              const fl_entry_hdr_t *hdr, const uint8_t *payload)
+{
+    bool flush = false;
+    const fl_agg_schema_t *s = fl_agg_schema(hdr->type);
+
+    if (flash_log_agg_next_pending(a, 0U) >= FL_AGG_SLOT_COUNT) {
+        /* No action required — nothing pending */
+    } else if ((FL_TYPE_BOOT_MARKER == hdr->type) ||
+               ((hdr->ts_boot_us / a->bucket_us) != a->bucket)) {
+        flush = true;
+    } else if ((NULL != s) && (0U != s->keyed)) {
+        size_t slot = fl_agg_slot(s, hdr, payload);
+
+        flush = (slot < FL_AGG_SLOT_COUNT) && (0U != a->slots[slot].count) &&
+                (a->slots[slot].type != hdr->type);
+    } else {
+        /* No action required */
+    }
+    return flush;
+}
+
+Status_t flash_log_agg_fold(FlashLogAggregator_t *a, const fl_entry_hdr_t *hdr,
+                            const uint8_t *payload)
+{
+    Status_t rc = 0;
+    const fl_agg_schema_t *s = fl_agg_schema(hdr->type);
+    size_t slot = FL_AGG_SLOT_COUNT;
+
+    if ((NULL == s) || (hdr->length != s->payload_len)) {
+        rc = -EINVAL;
+    } else {
+        slot = fl_agg_slot(s, hdr, payload);
+        if (slot >= FL_AGG_SLOT_COUNT) {
+            rc = -EINVAL;
+        }
+    }
+
+    if ((0 == rc) && (UINT16_MAX != a->slots[slot].count)) {
+        FlashLogAggSlot_t *acc = &a->slots[slot];
+        fl_agg_channel_t *ch = &a->channels[fl_agg_slot_base[slot]];
+
+        if (flash_log_agg_next_pending(a, 0U) >= FL_AGG_SLOT_COUNT) {
+            a->bucket = hdr->ts_boot_us / a->bucket_us;
+        }
+        if (0U == acc->count) {
+            acc->type = hdr->type;
+            acc->key = (0U != s->keyed) ? payload[0] : FL_AGG_NO_KEY;
+        }
+        acc->count += 1U;
+        for (uint8_t f = 0U; f < s->field_count; ++f) {
+            float x = fl_agg_field_value(payload, &s->fields[f]);
+
+            if (1U == acc->count) {
+                ch[f].min = x;
+                ch[f].mean = x;
+                ch[f].max = x;
+            } else {
+                ch[f].min = MIN(ch[f].min, x);
+                ch[f].max = MAX(ch[f].max, x);
+                ch[f].mean += (x - ch[f].mean) / (float)acc->count;
+            }
+        }
+    }
+    return rc;
+}
+
+uint16_t flash_log_agg_record_len(const FlashLogAggregator_t *a, size_t slot)
+{
+    uint16_t len = 0U;
+    const fl_agg_schema_t *s = NULL;
+
+    if (slot < FL_AGG_SLOT_COUNT) {
+        s = fl_agg_schema(a->slots[slot].type);
+    }
+    if (NULL != s) {
+        len = (uint16_t)(sizeof(fl_entry_hdr_t) + sizeof(fl_payload_aggregate_t) +
+                         ((size_t)s->field_count * sizeof(fl_agg_channel_t)));
+    }
+    return len;
+}
+
+void flash_log_agg_read(const FlashLogAggregator_t *a, size_t slot, size_t off,
+                        uint8_t *dst, size_t n)
+{
+    uint16_t len = flash_log_agg_record_len(a, slot);
+    uint8_t prefix[sizeof(fl_entry_hdr_t) + sizeof(fl_payload_aggregate_t)];
+
+    if ((0U != len) && (off < len)) {
+        const FlashLogAggSlot_t *acc = &a->slots[slot];
+        const uint8_t *channels = (const uint8_t *)&a->channels[fl_agg_slot_base[slot]];
+        fl_entry_hdr_t hdr = {
+            .type = FL_TYPE_AGGREGATE,
+            .flags = 0U,
+            .length = (uint16_t)(len - sizeof(fl_entry_hdr_t)),
+            .ts_boot_us = a->bucket * a->bucket_us,
+        };
+        fl_payload_aggregate_t agg = {
+            .source_type = acc->type,
+            .key = acc->key,
+            .count = acc->count,
+            .span_us = a->bucket_us,
+        };
+        size_t end = MIN(off + n, (size_t)len);
+
+        (void)memcpy(prefix, &hdr, sizeof(hdr));
+        (void)memcpy(&prefix[sizeof(hdr)], &agg, sizeof(agg));
+        for (size_t i = off; i < end; ++i) {
+            dst[i - off] = (i < sizeof(prefix)) ? prefix[i]
+                                                : channels[i - sizeof(prefix)];
+        }
+    }
+}
+
+void flash_log_agg_clear(FlashLogAggregator_t *a)
+{
+    for (size_t slot = 0U; slot < FL_AGG_SLOT_COUNT; ++slot) {
+        a->slots[slot].count = 0U;
+    }
+}
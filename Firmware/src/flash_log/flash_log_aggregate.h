@@ -0,0 +1,130 @@
+/**
+ * @file flash_log_aggregate.h
+ * @brief Time-bucket aggregation for decimated log downloads.
+ *
+ * A decimated download replaces the high-rate numeric records (consensus,
+ * cell raw, power snapshots) by one FL_TYPE_AGGREGATE record per source
+ * stream and time bucket, carrying min / mean / max of every numeric
+ * channel. Buckets are aligned to multiples of the bucket length in
+ * ts_boot_us, so the aggregate is stamped with the bucket start.
+ *
+ * The aggregator keeps one accumulator per source stream (consensus, power,
+ * and one per cell index, whichever raw type that cell reports) and never
+ * buffers records: a record that belongs to a later bucket, or a boot
+ * marker, first closes the open bucket (flash_log_agg_must_flush()), the
+ * caller emits the pending aggregates (flash_log_agg_read()), then clears
+ * the aggregator and carries on with the record.
+ */
+#ifndef FLASH_LOG_AGGREGATE_H
+#define FLASH_LOG_AGGREGATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "flash_log_entries.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Key of an aggregate whose source type is not per-cell. */
+#define FL_AGG_NO_KEY        0xFFU
+/** @brief Accumulators: consensus, power, one per cell index. */
+#define FL_AGG_SLOT_COUNT    5U
+/** @brief Cell indices with an accumulator of their own. */
+#define FL_AGG_CELL_SLOTS    3U
+/** @brief Most numeric channels of one source type (consensus). */
+#define FL_AGG_MAX_CHANNELS  9U
+/** @brief Channel store: consensus 9, power 5, 3 cells × up to 7 (DiveO2). */
+#define FL_AGG_CHANNEL_STORE 35U
+/** @brief Largest aggregate record, entry header included. */
+#define FL_AGG_RECORD_MAX                                                  \
+    (sizeof(fl_entry_hdr_t) + sizeof(fl_payload_aggregate_t) +             \
+     (FL_AGG_MAX_CHANNELS * sizeof(fl_agg_channel_t)))
+
+/** @brief Samples folded into one accumulator during the open bucket. */
+typedef struct {
+    uint8_t  type;    /* source type being accumulated */
+    uint8_t  key;     /* cell_index, or FL_AGG_NO_KEY */
+    uint16_t count;   /* 0 = nothing pending */
+} FlashLogAggSlot_t;
+
+/** @brief Aggregator state. Initialise with flash_log_agg_init(). */
+typedef struct {
+    uint64_t bucket;      /* open bucket index (ts_boot_us / bucket_us) */
+    uint32_t bucket_us;   /* bucket length */
+    FlashLogAggSlot_t slots[FL_AGG_SLOT_COUNT];
+    fl_agg_channel_t channels[FL_AGG_CHANNEL_STORE];
+} FlashLogAggregator_t;
+
+/**
+ * @brief Reset the aggregator for a new stream.
+ *
+ * @param a         Aggregator state.
+ * @param bucket_us Bucket length in microseconds (non-zero).
+ */
+void flash_log_agg_init(FlashLogAggregator_t *a, uint32_t bucket_us);
+
+/** @brief True for the record types a decimated download aggregates. */
+bool flash_log_agg_handles(uint8_t type);
+
+/**
+ * @brief Must the open bucket be emitted before @p hdr is taken?
+ *
+ * True when aggregates are pending and the record is a boot marker
+ * (timestamps restart), lies in another bucket, or is a cell record whose
+ * cell changed raw type mid-bucket.
+ *
+ * @param a       Aggregator state.
+ * @param hdr     Header of the record about to be folded or emitted.
+ * @param payload Its payload (read only for the cell_index of cell types).
+ */
+bool flash_log_agg_must_flush(const FlashLogAggregator_t *a,
+                              const fl_entry_hdr_t *hdr, const uint8_t *payload);
+
+/**
+ * @brief Fold one record into its accumulator.
+ *
+ * Call only when flash_log_agg_must_flush() is false.
+ *
+ * @param a       Aggregator state.
+ * @param hdr     Record header (an aggregated type).
+ * @param payload Record payload, hdr->length bytes.
+ * @return 0 on success, -EINVAL for a type that is not aggregated, a
+ *         payload of the wrong length, or a cell_index with no accumulator.
+ */
+Status_t flash_log_agg_fold(FlashLogAggregator_t *a, const fl_entry_hdr_t *hdr,
+                            const uint8_t *payload);
+
+/**
+ * @brief Next accumulator with pending samples.
+ *
+ * @param a    Aggregator state.
+ * @param from First slot to look at.
+ * @return Slot index, or FL_AGG_SLOT_COUNT when none is pending.
+ */
+size_t flash_log_agg_next_pending(const FlashLogAggregator_t *a, size_t from);
+
+/** @brief Length of slot @p slot's aggregate record, entry header included. */
+uint16_t flash_log_agg_record_len(const FlashLogAggregator_t *a, size_t slot);
+
+/**
+ * @brief Copy bytes [off, off + n) of slot @p slot's aggregate record.
+ *
+ * The record is [fl_entry_hdr_t | fl_payload_aggregate_t | channels]; it is
+ * serialised on the fly, so an emitter can slice it across chunks without
+ * a staging buffer.
+ */
+void flash_log_agg_read(const FlashLogAggregator_t *a, size_t slot, size_t off,
+                        uint8_t *dst, size_t n);
+
+/** @brief Drop every pending sample (after the open bucket was emitted). */
+void flash_log_agg_clear(FlashLogAggregator_t *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_LOG_AGGREGATE_H */
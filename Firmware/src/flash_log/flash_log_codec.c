@@ -0,0 +1,456 @@
+/**
+ * @file flash_log_codec.c
+ * @brief Packed telemetry batch codec — see flash_log_codec.h for the format.
+ *
+ * The field-coded types are the high-rate ones that dominate the telemetry
+ * budget: consensus at 10 Hz, the PID snapshot, and the per-cell raw
+ * records. Their payloads are fixed little-endian structs, so each one is
+ * described as a list of field widths; a field is delta-coded against the
+ * same field of the previous record of that type (and, for cell records,
+ * the same cell). Deltas wrap at the field width, which keeps the coding
+ * exact for signed fields and for the Numeric_t bit patterns alike.
+ * Anything else, or a payload whose length does not match its schema, is
+ * stored raw.
+ */
+
+#include "flash_log_codec.h"
+#include "flash_log.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/sys/util.h>
+
+#define FL_CODEC_MAX_FIELDS   10U
+#define FL_CODEC_NO_PREV      0xFFFFU
+#define FL_CODEC_VARINT_MORE  0x80U
+#define FL_CODEC_VARINT_BITS  7U
+#define FL_CODEC_VARINT_MASK  0x7FU
+#define FL_CODEC_MAX_WIDTH    8U
+
+/** @brief Fixed field layout of one field-coded payload type. */
+typedef struct {
+    uint8_t type;
+    uint8_t keyed;        /* 1 = first byte is the cell_index key */
+    uint8_t slot_base;    /* first prev_off[] slot for this type */
+    uint8_t field_count;  /* fields after the key */
+    uint8_t widths[FL_CODEC_MAX_FIELDS];
+} fl_codec_schema_t;
+
+/* Field widths mirror the packed structs in flash_log_entries.h; the
+ * BUILD_ASSERTs below catch a struct change that forgets this table. */
+static const fl_codec_schema_t fl_codec_schemas[] = {
+    /* consensus_ppo2, ppo2_array[3], milli_array[3], status_packed,
+     * confidence, setpoint */
+    { FL_TYPE_CONSENSUS, 0U, 0U, 10U, { 1U, 1U, 1U, 1U, 2U, 2U, 2U, 2U, 1U, 1U } },
+    /* integral, saturation_count, duty, setpoint */
+    { FL_TYPE_PID_SNAPSHOT, 0U, 1U, 4U, { 4U, 2U, 4U, 1U } },
+    /* ppo2, temperature, err_code, phase, intensity, ambient light,
+     * ambient pressure, humidity */
+    { FL_TYPE_CELL_RAW_DIVEO2, 1U, 2U, 8U, { 1U, 4U, 4U, 4U, 4U, 4U, 4U, 4U } },
+    /* ppo2, status */
+    { FL_TYPE_CELL_RAW_O2S, 1U, 5U, 2U, { 1U, 1U } },
+    /* ppo2, raw_adc, millivolts */
+    { FL_TYPE_CELL_RAW_ANALOG, 1U, 8U, 3U, { 1U, 4U, 2U } },
+};
+
+BUILD_ASSERT(sizeof(fl_payload_consensus_t) == 14U, "codec consensus schema");
+BUILD_ASSERT(sizeof(fl_payload_pid_t) == 11U, "codec PID schema");
+BUILD_ASSERT(sizeof(fl_payload_cell_diveo2_t) == 30U, "codec DiveO2 schema");
+BUILD_ASSERT(sizeof(fl_payload_cell_o2s_t) == 3U, "codec O2S schema");
+BUILD_ASSERT(sizeof(fl_payload_cell_analog_t) == 8U, "codec analog schema");
+BUILD_ASSERT(FL_CODEC_SLOT_STORE_BYTES == 148U, "codec slot store layout");
+
+static const fl_codec_schema_t *fl_codec_schema(uint8_t type)
+{
+    const fl_codec_schema_t *found = NULL;
+
+    for (size_t i = 0U; (i < ARRAY_SIZE(fl_codec_schemas)) && (NULL == found); ++i) {
+        if (fl_codec_schemas[i].type == type) {
+            found = &fl_codec_schemas[i];
+        }
+    }
+    return found;
+}
+
+static uint16_t fl_codec_schema_len(const fl_codec_schema_t *s)
+{
+    uint16_t len = s->keyed;
+
+    for (uint8_t f = 0U; f < s->field_count; ++f) {
+        len += s->widths[f];
+    }
+    return len;
+}
+
+/**
+ * @brief Resolve the previous-record slot for a field-coded payload.
+ * @return Slot index, or FL_CODEC_SLOT_COUNT when the record has none (a
+ *         cell_index outside the fixed slot range codes against zero).
+ */
+static size_t fl_codec_slot(const fl_codec_schema_t *s, uint8_t key)
+{
+    size_t slot = FL_CODEC_SLOT_COUNT;
+
+    if (0U == s->keyed) {
+        slot = s->slot_base;
+    } else if (key < FL_CODEC_CELL_SLOTS) {
+        slot = (size_t)s->slot_base + key;
+    } else {
+        /* No action required */
+    }
+    return slot;
+}
+
+static uint64_t fl_codec_zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t fl_codec_unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1U);
+}
+
+/* Append a LEB128 varint; out == NULL only counts. */
+static size_t fl_codec_put_varint(uint8_t *out, uint64_t v)
+{
+    size_t n = 0U;
+    uint64_t rest = v;
+
+    do {
+        uint8_t b = (uint8_t)(rest & FL_CODEC_VARINT_MASK);
+
+        rest >>= FL_CODEC_VARINT_BITS;
+        if (0U != rest) {
+            b |= FL_CODEC_VARINT_MORE;
+        }
+        if (NULL != out) {
+            out[n] = b;
+        }
+        ++n;
+    } while (0U != rest);
+    return n;
+}
+
+/* Parse a LEB128 varint; returns bytes consumed, 0 on truncation/overlong. */
+static size_t fl_codec_get_varint(const uint8_t *in, size_t in_len, uint64_t *v)
+{
+    size_t n = 0U;
+    size_t used = 0U;
+    uint64_t acc = 0U;
+
+    while ((0U == used) && (n < in_len) && (n < FL_CODEC_VARINT_MAX)) {
+        acc |= ((uint64_t)(in[n] & FL_CODEC_VARINT_MASK)) <<
+               (FL_CODEC_VARINT_BITS * n);
+        if (0U == (in[n] & FL_CODEC_VARINT_MORE)) {
+            used = n + 1U;
+        }
+        ++n;
+    }
+    *v = acc;
+    return used;
+}
+
+static uint64_t fl_codec_read_le(const uint8_t *p, uint8_t width)
+{
+    uint64_t v = 0U;
+
+    for (uint8_t b = 0U; b < width; ++b) {
+        v |= ((uint64_t)p[b]) << (BYTE_WIDTH * b);
+    }
+    return v;
+}
+
+static void fl_codec_write_le(uint8_t *p, uint8_t width, uint64_t v)
+{
+    for (uint8_t b = 0U; b < width; ++b) {
+        p[b] = (uint8_t)((v >> (BYTE_WIDTH * b)) & BYTE_MASK);
+    }
+}
+
+/* Wrapped difference at `width` bytes, sign-extended from the field's top bit. */
+static int64_t fl_codec_field_delta(uint64_t cur, uint64_t prev, uint8_t width)
+{
+    uint64_t d = cur - prev;
+    int64_t s = (int64_t)d;
+
+    if (width < FL_CODEC_MAX_WIDTH) {
+        uint32_t bits = BYTE_WIDTH * width;
+        uint64_t mask = (1ULL << bits) - 1U;
+        uint64_t sign = 1ULL << (bits - 1U);
+
+        d &= mask;
+        s = (0U != (d & sign)) ? (int64_t)(d | ~mask) : (int64_t)d;
+    }
+    return s;
+}
+
+void flash_log_codec_init(FlashLogCodec_t *c, const uint8_t *base,
+                          uint64_t base_ts)
+{
+    c->base = base;
+    c->store = NULL;
+    c->prev_ts = base_ts;
+    for (size_t i = 0U; i < FL_CODEC_SLOT_COUNT; ++i) {
+        c->prev_off[i] = FL_CODEC_NO_PREV;
+    }
+}
+
+/* Previous same-slot payload, or NULL to code against zero. */
+static const uint8_t *fl_codec_prev(const FlashLogCodec_t *c, size_t slot)
+{
+    const uint8_t *prev = NULL;
+
+    if ((slot < FL_CODEC_SLOT_COUNT) && (FL_CODEC_NO_PREV != c->prev_off[slot])) {
+        prev = &c->base[c->prev_off[slot]];
+    }
+    return prev;
+}
+
+void flash_log_codec_init_slots(FlashLogCodec_t *c, uint8_t *store,
+                                uint64_t base_ts)
+{
+    flash_log_codec_init(c, store, base_ts);
+    c->store = store;
+}
+
+/* Fixed offset of `slot` in a slot store: the schemas' slots laid out in
+ * table order, each one payload long. */
+static uint16_t fl_codec_store_off(size_t slot)
+{
+    uint16_t off = 0U;
+    bool found = false;
+
+    for (size_t i = 0U; (i < ARRAY_SIZE(fl_codec_schemas)) && (!found); ++i) {
+        const fl_codec_schema_t *s = &fl_codec_schemas[i];
+        size_t slots = (0U != s->keyed) ? FL_CODEC_CELL_SLOTS : 1U;
+
+        if (slot < ((size_t)s->slot_base + slots)) {
+            off = (uint16_t)(off + ((slot - s->slot_base) * fl_codec_schema_len(s)));
+            found = true;
+        } else {
+            off = (uint16_t)(off + (slots * fl_codec_schema_len(s)));
+        }
+    }
+    return off;
+}
+
+static void fl_codec_remember(FlashLogCodec_t *c, const fl_codec_schema_t *s,
+                              size_t slot, const uint8_t *payload)
+{
+    if (slot >= FL_CODEC_SLOT_COUNT) {
+        /* No action required — codes against zero */
+    } else if (NULL != c->store) {
+        uint16_t off = fl_codec_store_off(slot);
+
+        (void)memcpy(&c->store[off], payload, fl_codec_schema_len(s));
+        c->prev_off[slot] = off;
+    } else {
+        c->prev_off[slot] = (uint16_t)(payload - c->base);
+    }
+}
+
+/**
+ * @brief Encode the field-coded body (key, change mask, deltas).
+ * @return Encoded body length; out == NULL only counts.
+ */
+static size_t fl_codec_encode_fields(const fl_codec_schema_t *s,
+                                     const uint8_t *payload,
+                                     const uint8_t *prev, uint8_t *out)
+{
+    size_t n = 0U;
+    uint32_t mask = 0U;
+    size_t off = s->keyed;
+
+    if (0U != s->keyed) {
+        if (NULL != out) {
+            out[0] = payload[0];
+        }
+        n = 1U;
+    }
+    for (uint8_t f = 0U; f < s->field_count; ++f) {
+        uint64_t cur = fl_codec_read_le(&payload[off], s->widths[f]);
+        uint64_t old = (NULL != prev) ? fl_codec_read_le(&prev[off], s->widths[f]) : 0U;
+
+        if (cur != old) {
+            mask |= (1UL << f);
+        }
+        off += s->widths[f];
+    }
+    n += fl_codec_put_varint((NULL != out) ? &out[n] : NULL, mask);
+    off = s->keyed;
+    for (uint8_t f = 0U; f < s->field_count; ++f) {
+        if (0U != (mask & (1UL << f))) {
+            uint64_t cur = fl_codec_read_le(&payload[off], s->widths[f]);
+            uint64_t old = (NULL != prev) ? fl_codec_read_le(&prev[off], s->widths[f]) : 0U;
+            int64_t d = fl_codec_field_delta(cur, old, s->widths[f]);
+
+            n += fl_codec_put_varint((NULL != out) ? &out[n] : NULL,
+                                     fl_codec_zigzag(d));
+        }
+        off += s->widths[f];
+    }
+    return n;
+}
+
+size_t flash_log_codec_encode(FlashLogCodec_t *c, uint8_t type, uint64_t ts,
+                              const uint8_t *payload, uint16_t length,
+                              uint8_t *out)
+{
+    size_t n = 0U;
+
+    if (type < FL_CODEC_TAG_FIELDS) {
+        const fl_codec_schema_t *s = fl_codec_schema(type);
+        bool fields = (NULL != s) && (fl_codec_schema_len(s) == length);
+        int64_t dt = (int64_t)(ts - c->prev_ts);
+
+        if (NULL != out) {
+            out[0] = fields ? (uint8_t)(type | FL_CODEC_TAG_FIELDS) : type;
+        }
+        n = 1U;
+        n += fl_codec_put_varint((NULL != out) ? &out[n] : NULL,
+                                 fl_codec_zigzag(dt));
+        if (fields) {
+            size_t slot = fl_codec_slot(s, payload[0]);
+
+            n += fl_codec_encode_fields(s, payload, fl_codec_prev(c, slot),
+                                        (NULL != out) ? &out[n] : NULL);
+            fl_codec_remember(c, s, slot, payload);
+        } else {
+            n += fl_codec_put_varint((NULL != out) ? &out[n] : NULL, length);
+            if ((NULL != out) && (length > 0U)) {
+                (void)memcpy(&out[n], payload, length);
+            }
+            n += length;
+        }
+        c->prev_ts = ts;
+    }
+    return n;
+}
+
+/**
+ * @brief Decode a field-coded body into `payload` (schema length bytes).
+ * @return Encoded body bytes consumed, 0 on a malformed body.
+ */
+static size_t fl_codec_decode_fields(FlashLogCodec_t *c,
+                                     const fl_codec_schema_t *s,
+                                     const uint8_t *in, size_t in_len,
+                                     uint8_t *payload)
+{
+    size_t n = 0U;
+    bool ok = true;
+    uint64_t mask = 0U;
+    size_t slot = FL_CODEC_SLOT_COUNT;
+    const uint8_t *prev = NULL;
+    size_t off = s->keyed;
+    uint8_t key = 0U;
+
+    if (0U != s->keyed) {
+        if (in_len < 1U) {
+            ok = false;
+        } else {
+            key = in[0];
+            payload[0] = key;
+            n = 1U;
+        }
+    }
+    if (ok) {
+        size_t used = fl_codec_get_varint(&in[n], in_len - n, &mask);
+
+        ok = (0U != used) && ((mask >> s->field_count) == 0U);
+        n += used;
+        slot = fl_codec_slot(s, key);
+        prev = fl_codec_prev(c, slot);
+    }
+    for (uint8_t f = 0U; ok && (f < s->field_count); ++f) {
+        uint8_t w = s->widths[f];
+        uint64_t v = (NULL != prev) ? fl_codec_read_le(&prev[off], w) : 0U;
+
+        if (0U != (mask & (1ULL << f))) {
+            uint64_t zz = 0U;
+            size_t used = fl_codec_get_varint(&in[n], in_len - n, &zz);
+
+            if (0U == used) {
+                ok = false;
+            } else {
+                v += (uint64_t)fl_codec_unzigzag(zz);
+                n += used;
+            }
+        }
+        fl_codec_write_le(&payload[off], w, v);
+        off += w;
+    }
+    if (ok) {
+        fl_codec_remember(c, s, slot, payload);
+    }
+    return ok ? n : 0U;
+}
+
+Status_t flash_log_codec_decode(FlashLogCodec_t *c, const uint8_t *in,
+                                size_t in_len, size_t *consumed,
+                                fl_entry_hdr_t *hdr, uint8_t *payload,
+                                size_t cap)
+{
+    Status_t rc = 0;
+    size_t n = 1U;
+    uint64_t zz = 0U;
+    size_t used = 0U;
+    uint8_t type = 0U;
+    bool fields = false;
+
+    if (in_len < 1U) {
+        rc = -EBADMSG;
+    } else {
+        type = (uint8_t)(in[0] & (uint8_t)~FL_CODEC_TAG_FIELDS);
+        fields = (0U != (in[0] & FL_CODEC_TAG_FIELDS));
+        used = fl_codec_get_varint(&in[n], in_len - n, &zz);
+        if (0U == used) {
+            rc = -EBADMSG;
+        }
+        n += used;
+    }
+
+    if (0 != rc) {
+        /* Malformed tag or timestamp — rc already set */
+    } else if (fields) {
+        const fl_codec_schema_t *s = fl_codec_schema(type);
+
+        if (NULL == s) {
+            rc = -EBADMSG;
+        } else if (fl_codec_schema_len(s) > cap) {
+            rc = -ENOSPC;
+        } else {
+            used = fl_codec_decode_fields(c, s, &in[n], in_len - n, payload);
+            if (0U == used) {
+                rc = -EBADMSG;
+            }
+            n += used;
+            hdr->length = fl_codec_schema_len(s);
+        }
+    } else {
+        uint64_t len = 0U;
+
+        used = fl_codec_get_varint(&in[n], in_len - n, &len);
+        if ((0U == used) || (len > (in_len - n - used)) || (len > UINT16_MAX)) {
+            rc = -EBADMSG;
+        } else if (len > cap) {
+            rc = -ENOSPC;
+        } else {
+            n += used;
+            (void)memcpy(payload, &in[n], (size_t)len);
+            n += (size_t)len;
+            hdr->length = (uint16_t)len;
+        }
+    }
+
+    if (0 == rc) {
+        c->prev_ts += (uint64_t)fl_codec_unzigzag(zz);
+        hdr->type = type;
+        hdr->flags = 0U;
+        hdr->ts_boot_us = c->prev_ts;
+        *consumed = n;
+    }
+    return rc;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file flash_log_codec.h
+ * @brief Packed telemetry batch codec (FL_TYPE_BATCH_PACKED payloads).
+ *
+ * A packed container carries the same telemetry sub-records as a legacy
+ * FL_TYPE_BATCH, but without the 12-byte fl_entry_hdr_t per record:
+ *
+ *   tag      u8      sub-record type; bit 7 set = field-coded payload
+ *   ts       varint  zig-zag (ts_boot_us - previous record's ts), where the
+ *                    first record is coded against the container header's
+ *                    ts_boot_us
+ *   raw:     varint length, then `length` payload bytes verbatim
+ *   fields:  [key u8 — cell types only, the cell_index, stored verbatim]
+ *            varint change mask (bit i = field i differs from the previous
+ *            record of the same type/cell in this container), then one
+ *            zig-zag varint per set bit holding the wrapped field delta
+ *
+ * Every container is self-contained: the delta reference for the first
+ * record of each type/cell is all-zero, so a reader can decode any one
+ * container without state from its neighbours.
+ *
+ * Pure code with no Zephyr subsystem dependencies, shared by the writer
+ * (flash_log.c) and the reader (flash_log_reader.c) and unit-tested on its
+ * own. Both directions resolve "the previous record" as an offset into a
+ * caller-owned buffer that holds every payload seen so far in the container
+ * (the writer's staging buffer, or the reader's expansion buffer), so the
+ * codec itself carries no payload copies. A decoder that cannot keep the
+ * whole container (the filtered download unpacks one sub-record at a time)
+ * uses flash_log_codec_init_slots() instead, which copies each slot's latest
+ * payload into a small caller-owned store.
+ */
+#ifndef FLASH_LOG_CODEC_H
+#define FLASH_LOG_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "common.h"
+#include "flash_log_entries.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Tag bit marking a field-coded (rather than raw) sub-record. */
+#define FL_CODEC_TAG_FIELDS      0x80U
+/** @brief Longest LEB128 encoding of a 64-bit value. */
+#define FL_CODEC_VARINT_MAX      10U
+/** @brief Previous-record slots: consensus, PID, 3 × each raw cell type. */
+#define FL_CODEC_SLOT_COUNT      11U
+/** @brief Slots per keyed (per-cell) type. */
+#define FL_CODEC_CELL_SLOTS      3U
+/** @brief Bytes of a flash_log_codec_init_slots() store: one payload per slot. */
+#define FL_CODEC_SLOT_STORE_BYTES                                            \
+    (sizeof(fl_payload_consensus_t) + sizeof(fl_payload_pid_t) +             \
+     (FL_CODEC_CELL_SLOTS * (sizeof(fl_payload_cell_diveo2_t) +               \
+                             sizeof(fl_payload_cell_o2s_t) +                  \
+                             sizeof(fl_payload_cell_analog_t))))
+/** @brief Upper bound on one encoded field-coded sub-record (DiveO2 cell). */
+#define FL_CODEC_FIELDS_MAX_BYTES 64U
+/** @brief Upper bound on one encoded raw sub-record of `len` payload bytes. */
+#define FL_CODEC_RAW_MAX_BYTES(len) (1U + FL_CODEC_VARINT_MAX + 3U + (len))
+
+/**
+ * @brief Per-container codec state. Initialise with flash_log_codec_init()
+ *        before the first record of every container.
+ */
+typedef struct {
+    const uint8_t *base;   /* buffer the prev_off[] offsets index into */
+    uint8_t *store;        /* slot store (init_slots only), else NULL */
+    uint64_t prev_ts;      /* timestamp of the previous record */
+    uint16_t prev_off[FL_CODEC_SLOT_COUNT];
+} FlashLogCodec_t;
+
+/**
+ * @brief Reset codec state for a new container.
+ *
+ * @param c       Codec state.
+ * @param base    Buffer holding (encoder) or receiving (decoder) every
+ *                plain payload of this container; at most 64 KiB.
+ * @param base_ts Container header ts_boot_us.
+ */
+void flash_log_codec_init(FlashLogCodec_t *c, const uint8_t *base,
+                          uint64_t base_ts);
+
+/**
+ * @brief Reset codec state for a container decoded one record at a time.
+ *
+ * Decoded payloads may land anywhere (and be overwritten straight away):
+ * every field-coded payload is copied into @p store, at a fixed place for
+ * its slot, and later records of that slot code against the copy.
+ *
+ * @param c       Codec state.
+ * @param store   FL_CODEC_SLOT_STORE_BYTES bytes, owned by the caller for
+ *                the life of the container.
+ * @param base_ts Container header ts_boot_us.
+ */
+void flash_log_codec_init_slots(FlashLogCodec_t *c, uint8_t *store,
+                                uint64_t base_ts);
+
+/**
+ * @brief Encode one sub-record and advance the codec state.
+ *
+ * @param c       Codec state.
+ * @param type    Sub-record type (must be below FL_CODEC_TAG_FIELDS).
+ * @param ts      Sub-record ts_boot_us.
+ * @param payload Plain payload; must lie inside c->base.
+ * @param length  Payload length in bytes.
+ * @param out     Destination, at least FL_CODEC_RAW_MAX_BYTES(length) or
+ *                FL_CODEC_FIELDS_MAX_BYTES bytes; NULL to only size it.
+ * @return Encoded length in bytes, or 0 when `type` cannot be tagged.
+ */
+size_t flash_log_codec_encode(FlashLogCodec_t *c, uint8_t type, uint64_t ts,
+                              const uint8_t *payload, uint16_t length,
+                              uint8_t *out);
+
+/**
+ * @brief Decode one sub-record and advance the codec state.
+ *
+ * @param c        Codec state.
+ * @param in       Encoded bytes at the current container position.
+ * @param in_len   Encoded bytes remaining in the container.
+ * @param consumed Receives the encoded length of this sub-record.
+ * @param hdr      Receives the reconstructed entry header (flags 0).
+ * @param payload  Receives the plain payload; must lie inside c->base so
+ *                 later records of the same type can reference it (any
+ *                 buffer after flash_log_codec_init_slots()).
+ * @param cap      Bytes available at `payload`.
+ * @return 0 on success, -EBADMSG on a malformed or truncated record,
+ *         -ENOSPC when the payload does not fit `cap`.
+ */
+Status_t flash_log_codec_decode(FlashLogCodec_t *c, const uint8_t *in,
+                                size_t in_len, size_t *consumed,
+                                fl_entry_hdr_t *hdr, uint8_t *payload,
+                                size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_LOG_CODEC_H */
@@ -113,6 +113,22 @@ typedef struct {
     uint8_t flags;
 } __packed fl_payload_power_snapshot_t;
 
+/** @brief One stage of FL_TYPE_LATENCY_SUMMARY, all µs except count. */
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} __packed fl_latency_stage_t;
+
+/** @brief Payload for FL_TYPE_LATENCY_SUMMARY — latency_trace_serialise(). */
+typedef struct {
+    uint8_t version;
+    uint8_t stage_count;
+    fl_latency_stage_t stages[4];
+} __packed fl_payload_latency_summary_t;
+
 /** @brief Payload for FL_TYPE_CELL_RAW_DIVEO2. */
 typedef struct {
     uint8_t  cell_index;
@@ -160,4 +176,24 @@ typedef struct {
     uint8_t  last_dropped_type;
 } __packed fl_payload_drop_marker_t;
 
+/** @brief One aggregated channel of an FL_TYPE_AGGREGATE record. */
+typedef struct {
+    float min;
+    float mean;
+    float max;
+} __packed fl_agg_channel_t;
+
+/**
+ * @brief Payload prefix for FL_TYPE_AGGREGATE (download-only). The source
+ *        type's numeric channels follow as fl_agg_channel_t, in the order
+ *        listed in flash_log_aggregate.c. The record is stamped with the
+ *        bucket start.
+ */
+typedef struct {
+    uint8_t  source_type;  /* FlashLogType_t that was aggregated */
+    uint8_t  key;          /* cell_index, or FL_AGG_NO_KEY */
+    uint16_t count;        /* samples folded into the bucket */
+    uint32_t span_us;      /* bucket length */
+} __packed fl_payload_aggregate_t;
+
 #endif /* FLASH_LOG_ENTRIES_H */
@@ -25,6 +25,11 @@
 #define FL_ENTRY_LEN2_SHIFT  7U    /* second byte's contribution starts at bit 7 */
 #define FL_ENTRY_MARKER_SZ   1U    /* fixed end marker (0xAB) */
 #define FL_ENTRY_PEEK_BYTES  2U    /* max length-field size == terminator size */
+/* Largest entry that is re-read (instead of hopped) when it straddles a chunk
+ * boundary during a visiting seek. Covers every marker entry (a boot marker is
+ * 2 + 12 + 36 + 1 = 51 B) so the visitor sees them all, while BATCH containers
+ * and text lines keep being hopped unread. */
+#define FL_ENTRY_REREAD_MAX  64U
 
 /**
  * @brief Decode one entry length field from a chunk buffer.
@@ -56,6 +61,8 @@ static uint32_t fl_entry_decode_len(const uint8_t *hdr, uint8_t ev,
 
 /** Result of scanning one bulk-read chunk for whole FCB entries. */
 struct fl_chunk_scan {
+    fl_fast_seek_visit_t visit; /**< In: per-entry visitor, or NULL. */
+    void *visit_arg;            /**< In: visitor context. */
     uint32_t consumed; /**< Bytes of whole entries parsed from the chunk. */
     uint32_t hop;      /**< Skip distance for an entry spanning past the chunk. */
     uint32_t entries;  /**< Whole entries counted. */
@@ -69,6 +76,10 @@ struct fl_chunk_scan {
  * past the chunk is hopped whether or not its end marker would validate (the
  * stock EBADMSG path hops identically) — this is what keeps the cursor
  * bit-exact with fcb_getnext on rings that carry torn/garbage regions.
+ *
+ * With a visitor attached, a SMALL entry straddling the chunk end is not
+ * hopped but left unconsumed, so the next chunk starts on it and the visitor
+ * sees it whole. The cursor lands in the same place either way.
  */
 static void fl_scan_chunk(const uint8_t *buf, uint32_t chunk, uint8_t ev,
                           struct fl_chunk_scan *scan)
@@ -91,9 +102,17 @@ static void fl_scan_chunk(const uint8_t *buf, uint32_t chunk, uint8_t ev,
             uint32_t entry_total = len_sz + (uint32_t)data_len + FL_ENTRY_MARKER_SZ;
 
             if (entry_total > (chunk - pos)) {
-                scan->hop = entry_total;
+                if ((scan->visit != NULL) && (pos > 0U) &&
+                    (entry_total <= FL_ENTRY_REREAD_MAX)) {
+                    scan->hop = 0U; /* re-read from its start next chunk */
+                } else {
+                    scan->hop = entry_total;
+                }
                 stop = true;
             } else {
+                if (scan->visit != NULL) {
+                    scan->visit(scan->visit_arg, &buf[pos + len_sz], data_len);
+                }
                 pos += entry_total;
                 scan->entries += 1U;
             }
@@ -105,6 +124,15 @@ static void fl_scan_chunk(const uint8_t *buf, uint32_t chunk, uint8_t ev,
 void fl_fast_seek_active(struct fcb *fcb_p,
                          volatile struct fl_mount_stats *stats,
                          uint8_t *scratch, uint32_t scratch_len)
+{
+    (void)fl_fast_seek_active_visit(fcb_p, stats, scratch, scratch_len,
+                                    NULL, NULL);
+}
+
+bool fl_fast_seek_active_visit(struct fcb *fcb_p,
+                               volatile struct fl_mount_stats *stats,
+                               uint8_t *scratch, uint32_t scratch_len,
+                               fl_fast_seek_visit_t visit, void *visit_arg)
 {
     const struct flash_sector *sector = fcb_p->f_active.fe_sector;
     uint32_t sector_size = sector->fs_size;
@@ -113,6 +141,7 @@ void fl_fast_seek_active(struct fcb *fcb_p,
     uint32_t entries = 0U;
     uint32_t reads = 0U;
     bool done = false;
+    bool complete = true;
 
     while ((!done) && (cursor < sector_size)) {
         uint32_t remain = sector_size - cursor;
@@ -126,9 +155,11 @@ void fl_fast_seek_active(struct fcb *fcb_p,
                                       scratch, chunk);
         reads += 1U;
         if (0 != rc) {
+            complete = false;
             done = true;
         } else {
-            struct fl_chunk_scan scan = { 0 };
+            struct fl_chunk_scan scan = { .visit = visit,
+                                          .visit_arg = visit_arg };
 
             fl_scan_chunk(scratch, chunk, ev, &scan);
             entries += scan.entries;
@@ -155,4 +186,5 @@ void fl_fast_seek_active(struct fcb *fcb_p,
         stats->active_bytes = cursor;
         stats->bulk_reads = reads;
     }
+    return complete;
 }
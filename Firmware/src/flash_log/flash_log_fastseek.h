@@ -6,6 +6,7 @@
 #define FLASH_LOG_FASTSEEK_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <zephyr/fs/fcb.h>
 
 /** Boot-time FCB mount diagnostics — readable via debugger after boot. */
@@ -39,4 +40,32 @@ void fl_fast_seek_active(struct fcb *fcb_p,
                          volatile struct fl_mount_stats *stats,
                          uint8_t *scratch, uint32_t scratch_len);
 
+/**
+ * @brief Per-entry visitor for fl_fast_seek_active_visit().
+ *
+ * @param arg  Caller context.
+ * @param data Entry data (what fcb_append reserved) inside the scratch chunk;
+ *             only valid for the duration of the call.
+ * @param len  Entry data length.
+ */
+typedef void (*fl_fast_seek_visit_t)(void *arg, const uint8_t *data,
+                                     uint16_t len);
+
+/**
+ * @brief fl_fast_seek_active() that also hands every whole entry it parses
+ *        to @p visit.
+ *
+ * Used at mount to rebuild the writer's summary of the active sector from
+ * the same bulk reads the seek already does. Entries of up to 64 B that
+ * straddle a chunk boundary are re-read rather than hopped so that no marker
+ * is missed; the resulting cursor is identical to fl_fast_seek_active().
+ *
+ * @return true when the whole active sector was scanned, false if a flash
+ *         read failed part-way (the visitor has not seen every entry).
+ */
+bool fl_fast_seek_active_visit(struct fcb *fcb_p,
+                               volatile struct fl_mount_stats *stats,
+                               uint8_t *scratch, uint32_t scratch_len,
+                               fl_fast_seek_visit_t visit, void *visit_arg);
+
 #endif /* FLASH_LOG_FASTSEEK_H */
@@ -5,10 +5,13 @@
  * Kept separate from flash_log_reader.c so the summarizer can be
  * unit-tested without linking the FCB stack. The reader path owns
  * the index storage and the walk that fills it; this TU only knows
- * how to reduce a fully-built index array to a summary.
+ * how to reduce a fully-built index array to a summary, and how to
+ * build / validate the persistent per-sector summary the writer
+ * programs into each closed sector's summary unit.
  */
 
 #include "flash_log_internal.h"
+#include "flash_log_entries.h"
 
 #include <stddef.h>
 #include <stdbool.h>
@@ -84,3 +87,156 @@ void flash_log_index_summarize(const FlashLogIndexEntry_t *index,
         }
     }
 }
+
+/* ---- Persistent per-sector summary ---- */
+
+/* Seed for the summary check word, so an all-zero unit (one programmed over
+ * by something else) does not validate either. */
+static const uint16_t FL_SECTOR_SUMMARY_CHECK_SEED = 0xA55AU;
+static const uint32_t FL_SECTOR_SUMMARY_WORD_SHIFT = 16U;
+static const uint32_t FL_SECTOR_SUMMARY_WORD_MASK = 0xFFFFU;
+static const uint16_t FL_SECTOR_SUMMARY_RESERVED = 0xFFFFU;
+
+static uint16_t fl_sector_summary_check(const FlashLogSectorSummary_t *s)
+{
+    uint32_t fold = FL_SECTOR_SUMMARY_CHECK_SEED;
+
+    fold ^= s->magic;
+    fold ^= s->sector_id;
+    fold ^= s->first_boot_id & FL_SECTOR_SUMMARY_WORD_MASK;
+    fold ^= s->first_boot_id >> FL_SECTOR_SUMMARY_WORD_SHIFT;
+    fold ^= s->last_boot_id & FL_SECTOR_SUMMARY_WORD_MASK;
+    fold ^= s->last_boot_id >> FL_SECTOR_SUMMARY_WORD_SHIFT;
+    fold ^= s->first_dive_id;
+    fold ^= s->flags;
+    return (uint16_t)(fold & FL_SECTOR_SUMMARY_WORD_MASK);
+}
+
+void flash_log_sector_summary_reset(FlashLogSectorSummary_t *s)
+{
+    if (s != NULL) {
+        (void)memset(s, 0, sizeof(*s));
+        s->first_boot_id = FL_INVALID_BOOT_ID;
+        s->last_boot_id = FL_INVALID_BOOT_ID;
+        s->first_dive_id = FL_INVALID_DIVE_ID;
+        s->reserved = FL_SECTOR_SUMMARY_RESERVED;
+    }
+}
+
+void flash_log_sector_summary_fold(FlashLogSectorSummary_t *s, uint8_t type,
+                                   const uint8_t *payload, size_t length)
+{
+    if ((s == NULL) || (payload == NULL)) {
+        /* No action required */
+    } else if ((FL_TYPE_BOOT_MARKER == type) &&
+               (length >= sizeof(fl_payload_boot_marker_t))) {
+        fl_payload_boot_marker_t p = {0};
+
+        (void)memcpy(&p, payload, sizeof(p));
+        if (s->first_boot_id == FL_INVALID_BOOT_ID) {
+            s->first_boot_id = p.boot_id;
+        }
+        s->last_boot_id = p.boot_id;
+        s->flags |= FL_INDEX_FLAG_HAS_BOOT;
+    } else if (((FL_TYPE_DIVE_START == type) || (FL_TYPE_DIVE_END == type)) &&
+               (length >= sizeof(fl_payload_dive_marker_t))) {
+        fl_payload_dive_marker_t p = {0};
+
+        (void)memcpy(&p, payload, sizeof(p));
+        if (s->first_dive_id == FL_INVALID_DIVE_ID) {
+            s->first_dive_id = p.dive_number;
+        }
+        if (FL_TYPE_DIVE_START == type) {
+            s->flags |= FL_INDEX_FLAG_HAS_DIVE_START;
+        } else {
+            s->flags |= FL_INDEX_FLAG_HAS_DIVE_END;
+        }
+    } else {
+        /* Not a marker — nothing to summarise. */
+    }
+}
+
+void flash_log_sector_summary_fold_entry(FlashLogSectorSummary_t *s,
+                                         const uint8_t *data, size_t length)
+{
+    if ((data != NULL) && (length >= sizeof(fl_entry_hdr_t))) {
+        fl_entry_hdr_t hdr = {0};
+
+        (void)memcpy(&hdr, data, sizeof(hdr));
+        if (((size_t)hdr.length + sizeof(hdr)) <= length) {
+            flash_log_sector_summary_fold(s, hdr.type, &data[sizeof(hdr)],
+                                          hdr.length);
+        }
+    }
+}
+
+void flash_log_sector_summary_seal(FlashLogSectorSummary_t *s,
+                                   uint16_t sector_id)
+{
+    if (s != NULL) {
+        s->magic = FL_SECTOR_SUMMARY_MAGIC;
+        s->sector_id = sector_id;
+        s->reserved = FL_SECTOR_SUMMARY_RESERVED;
+        s->check = fl_sector_summary_check(s);
+    }
+}
+
+bool flash_log_sector_summary_open(const FlashLogSectorSummary_t *s,
+                                   uint16_t expected_id,
+                                   FlashLogIndexEntry_t *out)
+{
+    bool valid = false;
+
+    if ((s != NULL) && (out != NULL) &&
+        (s->magic == FL_SECTOR_SUMMARY_MAGIC) &&
+        (s->sector_id == expected_id) &&
+        (s->check == fl_sector_summary_check(s))) {
+        out->first_boot_id = s->first_boot_id;
+        out->first_dive_id = s->first_dive_id;
+        out->flags = s->flags;
+        valid = true;
+    }
+    return valid;
+}
+
+/* Needs the flash-log Kconfig geometry, which the pure-logic
+ * flash_log_index_summary test builds this TU without. */
+#ifdef CONFIG_FLASH_LOG
+off_t flash_log_sector_summary_off(const struct fcb *fcb_p,
+                                   const struct flash_sector *sector)
+{
+    const struct flash_sector *last =
+        &fcb_p->f_sectors[fcb_p->f_sector_cnt - 1U];
+    off_t idx = (off_t)(sector - fcb_p->f_sectors);
+
+    return last->fs_off + (off_t)last->fs_size +
+           (idx * (off_t)FL_SECTOR_SUMMARY_RESERVE);
+}
+#endif
+
+bool flash_log_sector_live_id(const struct fcb *fcb_p,
+                              const struct flash_sector *sector,
+                              uint16_t *id)
+{
+    bool live = false;
+
+    if ((fcb_p != NULL) && (sector != NULL) && (id != NULL) &&
+        (fcb_p->f_oldest != NULL) && (fcb_p->f_active.fe_sector != NULL) &&
+        (0U != fcb_p->f_sector_cnt)) {
+        size_t cnt = (size_t)fcb_p->f_sector_cnt;
+        size_t idx = (size_t)(sector - fcb_p->f_sectors);
+        size_t oldest = (size_t)(fcb_p->f_oldest - fcb_p->f_sectors);
+        size_t active = (size_t)(fcb_p->f_active.fe_sector - fcb_p->f_sectors);
+
+        if ((idx < cnt) && (oldest < cnt) && (active < cnt)) {
+            size_t span = ((active + cnt) - oldest) % cnt;
+            size_t behind = ((active + cnt) - idx) % cnt;
+
+            if (behind <= span) {
+                *id = (uint16_t)(fcb_p->f_active_id - (uint16_t)behind);
+                live = true;
+            }
+        }
+    }
+    return live;
+}
@@ -11,6 +11,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <zephyr/fs/fcb.h>
 
 #include "flash_log.h"
@@ -23,7 +24,8 @@ extern "C" {
  * flash_log.c (FCB geometry, f_sectors[] arrays) and the reader (index
  * arrays sized to match). 256 KiB sectors → telemetry 48 MiB, text
  * 8 MiB. Must stay <= 255 (FCB's uint8_t f_sector_cnt) and match the
- * partition sizes in boards/quickrecon/divecan_jr/divecan_jr.dts. */
+ * partition sizes in boards/quickrecon/divecan_jr/divecan_jr.dts (which
+ * also hold one summary unit per sector). */
 #define FL_TELEMETRY_SECTOR_COUNT CONFIG_FLASH_LOG_TELEMETRY_SECTOR_COUNT
 #define FL_TEXT_SECTOR_COUNT      CONFIG_FLASH_LOG_TEXT_SECTOR_COUNT
 
@@ -44,6 +46,116 @@ typedef struct {
     uint16_t flags;          /**< FL_INDEX_FLAG_* */
 } FlashLogIndexEntry_t;
 
+/* ---- Persistent per-sector summary ----
+ *
+ * Every logical sector has one FL_SECTOR_SUMMARY_RESERVE-byte summary unit in
+ * a summary area that follows the FCB's last sector in the same partition
+ * (flash_log_sector_summary_off()). The unit holds one FlashLogSectorSummary_t,
+ * programmed by the writer when the sector closes. A cold index build then
+ * costs one small read per closed sector instead of an fcb_walk over every
+ * entry. The FCB keeps whole logical sectors, so each rotation erase stays
+ * erase-block aligned; the writer erases a sector's unit right after FCB
+ * rotates the sector out, which is why the unit is a whole number of
+ * FL_ERASE_BLOCK. */
+#define FL_SECTOR_SUMMARY_RESERVE CONFIG_FLASH_LOG_SECTOR_SUMMARY_RESERVE
+
+/** @brief Smallest erase unit of the W25Q512 and the native_sim flash
+ *         simulator. */
+#define FL_ERASE_BLOCK 4096U
+
+/** @brief "SS" — an erased (0xFFFF) or torn unit never matches. */
+#define FL_SECTOR_SUMMARY_MAGIC 0x5353U
+
+/**
+ * @brief On-flash summary of one closed sector (20 B, naturally aligned).
+ *
+ * `sector_id` is the FCB sector-header id (fcb_disk_area.fd_id) the sector
+ * carried when it closed. Sector ids are consecutive in ring order, so the
+ * reader derives the expected id of every in-use sector from f_active_id
+ * alone; a unit left over from a previous lap of the ring carries an older
+ * id and is rejected without reading the sector header.
+ */
+typedef struct {
+    uint16_t magic;          /**< FL_SECTOR_SUMMARY_MAGIC */
+    uint16_t sector_id;      /**< fd_id of the summarised sector */
+    uint32_t first_boot_id;  /**< FL_INVALID_BOOT_ID if no boot marker landed here */
+    uint32_t last_boot_id;   /**< FL_INVALID_BOOT_ID if no boot marker landed here */
+    uint16_t first_dive_id;  /**< FL_INVALID_DIVE_ID if no dive marker landed here */
+    uint16_t flags;          /**< FL_INDEX_FLAG_* */
+    uint16_t check;          /**< XOR fold of the fields above, seeded */
+    uint16_t reserved;       /**< Written as 0xFFFF (left erased) */
+} FlashLogSectorSummary_t;
+
+/** @brief Start an empty summary (no markers seen). */
+void flash_log_sector_summary_reset(FlashLogSectorSummary_t *s);
+
+/**
+ * @brief Fold one marker entry into a running sector summary.
+ *
+ * Non-marker types and short payloads are ignored, so callers can offer
+ * every entry they see.
+ *
+ * @param s       Summary being accumulated.
+ * @param type    Entry type (FlashLogType_t).
+ * @param payload Entry payload bytes (after fl_entry_hdr_t).
+ * @param length  Payload length in bytes.
+ */
+void flash_log_sector_summary_fold(FlashLogSectorSummary_t *s, uint8_t type,
+                                   const uint8_t *payload, size_t length);
+
+/**
+ * @brief Fold one raw entry ([fl_entry_hdr_t + payload] as stored in the
+ *        FCB) into a running summary. Used by the mount-time active-sector
+ *        scan, which sees entries only as byte runs.
+ */
+void flash_log_sector_summary_fold_entry(FlashLogSectorSummary_t *s,
+                                         const uint8_t *data, size_t length);
+
+/** @brief Stamp magic, sector id and check word ready for programming. */
+void flash_log_sector_summary_seal(FlashLogSectorSummary_t *s,
+                                   uint16_t sector_id);
+
+/**
+ * @brief Validate a summary read back from flash and convert it to an index
+ *        row.
+ *
+ * @param s           Summary as read from the sector's summary unit.
+ * @param expected_id Sector id the reader expects for this sector.
+ * @param out         Receives the index row on success.
+ * @return true when magic, id and check word all match.
+ */
+bool flash_log_sector_summary_open(const FlashLogSectorSummary_t *s,
+                                   uint16_t expected_id,
+                                   FlashLogIndexEntry_t *out);
+
+/**
+ * @brief Flash-area offset of a sector's summary unit.
+ *
+ * The summary area starts right after the FCB's last sector and holds one
+ * FL_SECTOR_SUMMARY_RESERVE unit per sector, in f_sectors[] order.
+ *
+ * @param fcb_p  Mounted FCB.
+ * @param sector One of @p fcb_p's sectors.
+ * @return Offset within @p fcb_p's flash area.
+ */
+off_t flash_log_sector_summary_off(const struct fcb *fcb_p,
+                                   const struct flash_sector *sector);
+
+/**
+ * @brief Sector id a sector currently carries, derived from FCB RAM state.
+ *
+ * FCB opens sectors in ring order with consecutive ids, so a sector k steps
+ * behind the active one carries f_active_id - k. No flash access.
+ *
+ * @param fcb_p  Mounted FCB.
+ * @param sector One of @p fcb_p's sectors.
+ * @param id     Receives the sector's id when it is in use.
+ * @return true if @p sector lies in the in-use span [f_oldest, active].
+ */
+bool flash_log_sector_live_id(const struct fcb *fcb_p,
+                              const struct flash_sector *sector,
+                              uint16_t *id);
+
 /**
  * @brief Reduced view over a built FlashLogIndexEntry_t[] array.
  *
@@ -89,6 +201,22 @@ uint8_t flash_log_internal_sector_count(FlashLogDest_t dest);
  * the PREVIOUS dive) until a reboot. */
 uint32_t flash_log_internal_index_epoch(void);
 
+/**
+ * @brief Summary of the destination's ACTIVE sector, as tracked by the writer.
+ *
+ * The active sector has no on-flash summary yet (it is written when the
+ * sector closes), so the reader takes it from the writer's RAM copy instead
+ * of walking the sector. Call with the external-flash lock held — the writer
+ * only updates the copy under that lock.
+ *
+ * @param dest Telemetry or text FCB.
+ * @param out  Receives the index row.
+ * @return 0 on success, -ENODATA when the writer's copy does not cover the
+ *         whole active sector (the reader then walks it).
+ */
+Status_t flash_log_internal_active_summary(FlashLogDest_t dest,
+                                           FlashLogIndexEntry_t *out);
+
 #ifdef __cplusplus
 }
 #endif
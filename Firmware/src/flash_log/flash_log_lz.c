@@ -0,0 +1,179 @@
+/**
+ * @file flash_log_lz.c
+ * @brief Streaming LZSS compressor — see flash_log_lz.h for the bit format.
+ *
+ * The log stream is dominated by 12-byte entry headers whose type, flags,
+ * length and upper timestamp bytes repeat from one entry to the next, plus
+ * text records that repeat their module prefixes. A 512-byte window holds
+ * several dozen entries, which is where nearly all of those repeats are.
+ *
+ * Matching is a brute-force scan of the window, nearest candidate first:
+ * no hash chains, so the whole state is the window plus the input staging
+ * area and fits the maintenance arena with room to spare. At the download
+ * rate (a few KiB/s on the bus) the scan cost is well inside the budget of
+ * one 0x36 request.
+ */
+
+#include "flash_log_lz.h"
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+/** Bits of the longest item (a backref). */
+#define FL_LZ_ITEM_MAX_BITS  (1U + FL_LZ_WINDOW_BITS + FL_LZ_LENGTH_BITS)
+#define FL_LZ_LITERAL_BITS   9U
+#define FL_LZ_LITERAL_FLAG   0x100U
+#define FL_LZ_BITS_PER_BYTE  8U
+#define FL_LZ_BYTE_MASK      0xFFU
+
+void flash_log_lz_init(FlashLogLz_t *lz)
+{
+    (void)memset(lz, 0, sizeof(*lz));
+}
+
+bool flash_log_lz_wants_input(const FlashLogLz_t *lz)
+{
+    return (!lz->finishing) &&
+           ((uint16_t)(lz->fill - lz->pos) < FL_LZ_MAX_MATCH);
+}
+
+size_t flash_log_lz_sink(FlashLogLz_t *lz, uint8_t **dst)
+{
+    size_t space = 0U;
+
+    if (lz->pos > FL_LZ_WINDOW_BYTES) {
+        uint16_t shift = (uint16_t)(lz->pos - FL_LZ_WINDOW_BYTES);
+
+        (void)memmove(lz->buf, &lz->buf[shift], (size_t)lz->fill - shift);
+        lz->pos = (uint16_t)(lz->pos - shift);
+        lz->fill = (uint16_t)(lz->fill - shift);
+    }
+    *dst = &lz->buf[lz->fill];
+    if (!lz->finishing) {
+        space = sizeof(lz->buf) - lz->fill;
+    }
+    return space;
+}
+
+void flash_log_lz_commit(FlashLogLz_t *lz, size_t n)
+{
+    size_t room = sizeof(lz->buf) - lz->fill;
+
+    if (n > room) {
+        n = room;
+    }
+    lz->fill = (uint16_t)(lz->fill + n);
+}
+
+void flash_log_lz_finish(FlashLogLz_t *lz)
+{
+    lz->finishing = true;
+}
+
+bool flash_log_lz_done(const FlashLogLz_t *lz)
+{
+    return lz->finishing && (lz->pos == lz->fill) && (0U == lz->nbits);
+}
+
+/**
+ * @brief Append @p count bits of @p value and move whole bytes to @p out.
+ *
+ * The caller has checked that @p out can take every byte this produces.
+ */
+static void fl_lz_put_bits(FlashLogLz_t *lz, uint32_t value, uint8_t count,
+                           uint8_t *out, size_t *written)
+{
+    lz->bits = (lz->bits << count) | value;
+    lz->nbits = (uint8_t)(lz->nbits + count);
+    while (lz->nbits >= FL_LZ_BITS_PER_BYTE) {
+        lz->nbits = (uint8_t)(lz->nbits - FL_LZ_BITS_PER_BYTE);
+        out[*written] = (uint8_t)((lz->bits >> lz->nbits) & FL_LZ_BYTE_MASK);
+        *written += 1U;
+    }
+    lz->bits &= (1UL << lz->nbits) - 1UL;
+}
+
+/**
+ * @brief Longest match for the bytes at the cursor, nearest first.
+ *
+ * @param lz    Compressor state.
+ * @param avail Lookahead bytes usable for the match (≤ FL_LZ_MAX_MATCH).
+ * @param dist  Receives the distance of the returned match.
+ * @return Match length (0 when nothing in the window matches).
+ */
+static uint16_t fl_lz_longest_match(const FlashLogLz_t *lz, uint16_t avail,
+                                    uint16_t *dist)
+{
+    const uint8_t *cur = &lz->buf[lz->pos];
+    uint16_t lo = 0U;
+    uint16_t best_len = 0U;
+    uint16_t best_dist = 0U;
+
+    if (lz->pos > FL_LZ_WINDOW_BYTES) {
+        lo = (uint16_t)(lz->pos - FL_LZ_WINDOW_BYTES);
+    }
+    for (uint16_t s = lz->pos; (s > lo) && (best_len < avail); --s) {
+        const uint8_t *cand = &lz->buf[s - 1U];
+
+        /* Cheap reject: a longer match must also agree at best_len. The
+         * candidate may run into the cursor's own bytes (an overlapping
+         * copy), which the decoder reproduces byte by byte. */
+        if (cand[best_len] == cur[best_len]) {
+            uint16_t len = 0U;
+
+            while ((len < avail) && (cand[len] == cur[len])) {
+                ++len;
+            }
+            if (len > best_len) {
+                best_len = len;
+                best_dist = (uint16_t)(lz->pos - (s - 1U));
+            }
+        }
+    }
+    *dist = best_dist;
+    return best_len;
+}
+
+size_t flash_log_lz_poll(FlashLogLz_t *lz, uint8_t *out, size_t cap)
+{
+    size_t written = 0U;
+    bool encoding = true;
+
+    while (encoding) {
+        uint16_t ahead = (uint16_t)(lz->fill - lz->pos);
+        size_t need = ((size_t)lz->nbits + FL_LZ_ITEM_MAX_BITS) / FL_LZ_BITS_PER_BYTE;
+
+        if ((0U == ahead) || ((!lz->finishing) && (ahead < FL_LZ_MAX_MATCH))) {
+            /* Out of input, or waiting for a full lookahead. */
+            encoding = false;
+        } else if ((cap - written) < need) {
+            encoding = false;
+        } else {
+            uint16_t dist = 0U;
+            uint16_t len = fl_lz_longest_match(lz, MIN(ahead, FL_LZ_MAX_MATCH), &dist);
+
+            if (len >= FL_LZ_MIN_MATCH) {
+                fl_lz_put_bits(lz, (uint32_t)dist - 1U, 1U + FL_LZ_WINDOW_BITS,
+                               out, &written);
+                fl_lz_put_bits(lz, (uint32_t)len - FL_LZ_MIN_MATCH,
+                               FL_LZ_LENGTH_BITS, out, &written);
+                lz->pos = (uint16_t)(lz->pos + len);
+            } else {
+                fl_lz_put_bits(lz, FL_LZ_LITERAL_FLAG | lz->buf[lz->pos],
+                               FL_LZ_LITERAL_BITS, out, &written);
+                lz->pos += 1U;
+            }
+        }
+    }
+
+    /* Flush the zero-padded final byte once the input is fully encoded. */
+    if (lz->finishing && (lz->pos == lz->fill) && (lz->nbits > 0U) &&
+        (written < cap)) {
+        out[written] = (uint8_t)((lz->bits << (FL_LZ_BITS_PER_BYTE - lz->nbits)) &
+                                 FL_LZ_BYTE_MASK);
+        written += 1U;
+        lz->bits = 0U;
+        lz->nbits = 0U;
+    }
+    return written;
+}
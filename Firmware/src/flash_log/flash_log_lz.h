@@ -0,0 +1,106 @@
+/**
+ * @file flash_log_lz.h
+ * @brief Streaming LZSS compressor for the compressed UDS log download.
+ *
+ * Heatshrink-style bit stream, MSB first, no framing of its own:
+ *
+ *   literal:  1, byte (8 bits)
+ *   backref:  0, (distance - 1) in FL_LZ_WINDOW_BITS bits,
+ *                (length - FL_LZ_MIN_MATCH) in FL_LZ_LENGTH_BITS bits
+ *
+ * A backref copies `length` bytes starting `distance` bytes behind the
+ * output cursor, byte by byte, so it may overlap the bytes it produces. The
+ * final byte is zero-padded; no item is shorter than 9 bits, so a decoder
+ * simply stops when fewer bits than a whole item remain.
+ *
+ * The state is one caller-owned struct (the download places it in the
+ * maintenance arena) that holds the history window and the pending input.
+ * Input and output are both pull-driven so the caller can interleave flash
+ * reads with bounded output chunks: ask flash_log_lz_sink() for free input
+ * space, fill it, flash_log_lz_commit() the bytes, and drain with
+ * flash_log_lz_poll(). Pure code with no Zephyr subsystem dependencies.
+ */
+#ifndef FLASH_LOG_LZ_H
+#define FLASH_LOG_LZ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief log2 of the history window (512 B). */
+#define FL_LZ_WINDOW_BITS   9U
+/** @brief Bits of the backref length field. */
+#define FL_LZ_LENGTH_BITS   4U
+/** @brief Shortest backref; a 2-byte match (14 bits) beats two literals (18). */
+#define FL_LZ_MIN_MATCH     2U
+/** @brief Longest backref. */
+#define FL_LZ_MAX_MATCH     (FL_LZ_MIN_MATCH + (1U << FL_LZ_LENGTH_BITS) - 1U)
+/** @brief History window in bytes. */
+#define FL_LZ_WINDOW_BYTES  (1U << FL_LZ_WINDOW_BITS)
+/** @brief Input staged ahead of the encoder cursor per refill. */
+#define FL_LZ_INPUT_BYTES   256U
+/** @brief Window/length parameters packed into one byte (window << 4 | length). */
+#define FL_LZ_PARAMS        ((uint8_t)((FL_LZ_WINDOW_BITS << 4U) | FL_LZ_LENGTH_BITS))
+
+/** @brief Compressor state; initialise with flash_log_lz_init(). */
+typedef struct {
+    /* [history | pending input]; history is at most FL_LZ_WINDOW_BYTES
+     * behind `pos`, slid down by flash_log_lz_sink() as the input advances. */
+    uint8_t buf[FL_LZ_WINDOW_BYTES + FL_LZ_INPUT_BYTES];
+    uint16_t pos;      /* next byte to encode */
+    uint16_t fill;     /* valid bytes in buf */
+    uint32_t bits;     /* pending output bits, right-aligned */
+    uint8_t nbits;     /* count of pending output bits (< 8 between items) */
+    bool finishing;    /* no more input; flush everything */
+} FlashLogLz_t;
+
+/** @brief Reset the compressor for a new stream. */
+void flash_log_lz_init(FlashLogLz_t *lz);
+
+/**
+ * @brief True when the encoder is short of lookahead and more input can be
+ *        accepted (not yet finishing).
+ */
+bool flash_log_lz_wants_input(const FlashLogLz_t *lz);
+
+/**
+ * @brief Get the free input space, sliding the history window down first.
+ *
+ * @param lz  Compressor state.
+ * @param dst Receives where to write up to the returned number of bytes.
+ * @return Free input bytes at *dst (0 once finishing).
+ */
+size_t flash_log_lz_sink(FlashLogLz_t *lz, uint8_t **dst);
+
+/** @brief Account @p n bytes written at the flash_log_lz_sink() pointer. */
+void flash_log_lz_commit(FlashLogLz_t *lz, size_t n);
+
+/** @brief Mark the end of the input; the next polls flush everything. */
+void flash_log_lz_finish(FlashLogLz_t *lz);
+
+/**
+ * @brief Encode pending input into @p out.
+ *
+ * Stops when the next item might not fit @p cap, or when more lookahead is
+ * needed and the input is not finished. Partial-byte output is carried to
+ * the next call.
+ *
+ * @param lz  Compressor state.
+ * @param out Destination.
+ * @param cap Bytes available at @p out.
+ * @return Bytes written to @p out.
+ */
+size_t flash_log_lz_poll(FlashLogLz_t *lz, uint8_t *out, size_t cap);
+
+/** @brief True once finishing and every input bit has been emitted. */
+bool flash_log_lz_done(const FlashLogLz_t *lz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_LOG_LZ_H */
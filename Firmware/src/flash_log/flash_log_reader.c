@@ -10,15 +10,25 @@
  * The index is (192+32) × 8 B = 1792 B and lives in the shared
  * maintenance arena (see maintenance_arena.h) rather than as permanent
  * statics — STM32L431 RAM is tight and the index is never needed while
- * an OTA download or factory copy is running. Built by one fcb_walk per
- * FCB that inspects only marker TLV entries (BOOT_MARKER / DIVE_START /
- * DIVE_END), so it costs ~one flash read per sector at index-build
- * time and only happens after a UDS selector call.
+ * an OTA download or factory copy is running. Each closed sector's row
+ * comes from the persistent summary the writer programmed into the
+ * sector's summary unit (one 20 B read per sector); the active sector's row
+ * comes from the writer's RAM copy. Only a sector with neither — closed
+ * before its summary could be written, or with an unreadable unit — falls back
+ * to an fcb_walk over its entries that inspects only marker TLV entries
+ * (BOOT_MARKER / DIVE_START / DIVE_END). Built only after a UDS selector
+ * call.
+ *
+ * A filtered cursor (flash_log_reader_set_filter()) unpacks batch
+ * containers on the device, one sub-record at a time, and streams only the
+ * selected record types. A decimated one (flash_log_reader_set_decimation())
+ * further folds the high-rate numeric records into per-bucket aggregates.
  */
 
 #include "flash_log_reader.h"
 #include "flash_log_entries.h"
 #include "flash_log_internal.h"
+#include "flash_log_codec.h"
 #include "watchdog_feeder.h"
 #include "maintenance_arena.h"
 #include "external_flash.h"
@@ -161,6 +171,7 @@ typedef struct {
     uint32_t walked;      /* entries visited so far — drives periodic IWDG feed */
     uint32_t read_errors; /* header/payload reads that failed during the walk */
     uint32_t marker_hits; /* marker entries successfully indexed */
+    uint32_t summaries;   /* sectors indexed from a persistent summary */
 } fl_index_build_ctx_t;
 
 static size_t fl_sector_index(const struct fcb *fcb_p,
@@ -274,6 +285,79 @@ static int fl_index_walk_cb(struct fcb_entry_ctx *loc_ctx, void *arg)
     return 0;
 }
 
+/**
+ * @brief Fill one sector's index row from its persistent summary.
+ *
+ * @param ctx    Build context (index array, FCB).
+ * @param dest   Destination, for the writer's active-sector copy.
+ * @param sector Sector to index.
+ * @param id     Sector id FCB RAM state says this sector carries.
+ * @return true if the row was filled; false means walk the sector.
+ */
+static bool fl_index_from_summary(fl_index_build_ctx_t *ctx,
+                                  FlashLogDest_t dest,
+                                  const struct flash_sector *sector,
+                                  uint16_t id)
+{
+    bool have = false;
+    FlashLogIndexEntry_t *e = &ctx->index[fl_sector_index(ctx->fcb_p, sector)];
+
+    if (sector == ctx->fcb_p->f_active.fe_sector) {
+        have = (0 == flash_log_internal_active_summary(dest, e));
+    } else {
+        FlashLogSectorSummary_t unit = {0};
+        off_t off = flash_log_sector_summary_off(ctx->fcb_p, sector);
+
+        if (0 == flash_area_read(ctx->fcb_p->fap, off, &unit, sizeof(unit))) {
+            have = flash_log_sector_summary_open(&unit, id, e);
+        }
+    }
+    if (have) {
+        ctx->summaries += 1U;
+        if (0U != e->flags) {
+            ctx->marker_hits += 1U;
+        }
+    }
+    return have;
+}
+
+/**
+ * @brief Index every in-use sector, oldest to active.
+ *
+ * Sectors are visited in ring order so a fallback walk sees markers in the
+ * same order the old whole-ring walk did. Runs under the external-flash lock
+ * (the walk callback still yields it every FL_INDEX_WALK_WDT_KICK entries).
+ */
+static Status_t fl_index_sectors(FlashLogDest_t dest, struct fcb *fcb_p,
+                                 fl_index_build_ctx_t *ctx)
+{
+    Status_t rc = 0;
+    struct flash_sector *sector = fcb_p->f_oldest;
+    const struct flash_sector *end = fcb_p->f_sectors + fcb_p->f_sector_cnt;
+    bool done = (sector == NULL) || (fcb_p->f_active.fe_sector == NULL);
+
+    while ((!done) && (0 == rc)) {
+        uint16_t id = 0U;
+
+        if (!flash_log_sector_live_id(fcb_p, sector, &id)) {
+            done = true;
+        } else {
+            if (!fl_index_from_summary(ctx, dest, sector, id)) {
+                rc = fcb_walk(fcb_p, sector, fl_index_walk_cb, ctx);
+            }
+            if (sector == fcb_p->f_active.fe_sector) {
+                done = true;
+            } else {
+                ++sector;
+                if (sector == end) {
+                    sector = fcb_p->f_sectors;
+                }
+            }
+        }
+    }
+    return rc;
+}
+
 static Status_t fl_build_index(FlashLogDest_t dest)
 {
     Status_t rc = 0;
@@ -298,12 +382,12 @@ static Status_t fl_build_index(FlashLogDest_t dest)
         uint32_t epoch = flash_log_internal_index_epoch();
         fl_index_build_ctx_t ctx = { .index = index, .fcb_p = fcb_p,
                          .walked = 0U, .read_errors = 0U,
-                         .marker_hits = 0U };
+                         .marker_hits = 0U, .summaries = 0U };
 
         watchdog_kick();   /* feed once before the walk begins */
         rc = external_flash_acquire(K_FOREVER);
         if (0 == rc) {
-            rc = fcb_walk(fcb_p, NULL, fl_index_walk_cb, &ctx);
+            rc = fl_index_sectors(dest, fcb_p, &ctx);
             external_flash_release();
         }
         if ((0 == rc) && (0U != ctx.read_errors) &&
@@ -787,6 +871,234 @@ Status_t flash_log_reader_resolve_dive_id(FlashLogDest_t dest, uint16_t dive_id,
     return rc;
 }
 
+/* ---- Time-range selector ----
+ *
+ * The index row stays at 8 B: (192+32) rows already fill the maintenance
+ * arena, so there is no room to keep a timestamp per sector in RAM. Instead
+ * the selector reads a sector's start time on demand — the first non-marker
+ * entry header, one small read — and binary-searches the boot's sectors,
+ * whose start times are monotonic. A 5-minute window on a long boot costs a
+ * handful of header reads, not a walk.
+ */
+
+static bool fl_is_marker_type(uint8_t type)
+{
+    return (FL_TYPE_BOOT_MARKER == type) ||
+           (FL_TYPE_DIVE_START == type) ||
+           (FL_TYPE_DIVE_END == type);
+}
+
+static bool fl_is_batch_type(uint8_t type)
+{
+    return (FL_TYPE_BATCH_PACKED == type) || (FL_TYPE_BATCH == type);
+}
+
+/* Physical sector index of ring position @p k (0 = oldest). */
+static size_t fl_ring_sector(const struct fcb *fcb_p, size_t k)
+{
+    size_t cnt = (size_t)fcb_p->f_sector_cnt;
+    size_t oldest = (size_t)(fcb_p->f_oldest - fcb_p->f_sectors);
+
+    return (oldest + k) % cnt;
+}
+
+/* Sectors in use, oldest through active. */
+static size_t fl_ring_used(const struct fcb *fcb_p)
+{
+    size_t cnt = (size_t)fcb_p->f_sector_cnt;
+    size_t oldest = (size_t)(fcb_p->f_oldest - fcb_p->f_sectors);
+    size_t active = (size_t)(fcb_p->f_active.fe_sector - fcb_p->f_sectors);
+
+    return (((active + cnt) - oldest) % cnt) + 1U;
+}
+
+/**
+ * @brief Start time of one sector: ts of its first non-marker entry.
+ *
+ * Markers are flushed immediately, ahead of the telemetry batch that is
+ * still filling, so only the entries after them put the ring in time order.
+ *
+ * @param fcb_p  Mounted FCB.
+ * @param sector Sector to probe.
+ * @param ts_us  Receives the start time.
+ * @return false when the sector has no such entry, a header is unreadable,
+ *         or a boot marker comes first (what follows it is another boot).
+ */
+static bool fl_sector_start_ts(struct fcb *fcb_p, struct flash_sector *sector,
+                               uint64_t *ts_us)
+{
+    struct fcb_entry loc = { .fe_sector = sector, .fe_elem_off = 0U };
+    bool found = false;
+    bool done = false;
+
+    while (!done) {
+        fl_entry_hdr_t hdr = {0};
+
+        if ((0 != fcb_getnext(fcb_p, &loc)) || (loc.fe_sector != sector)) {
+            done = true;
+        } else if (0 != flash_area_read(fcb_p->fap, fl_entry_data_off(&loc),
+                                        &hdr, sizeof(hdr))) {
+            done = true;
+        } else if (FL_TYPE_BOOT_MARKER == hdr.type) {
+            done = true;
+        } else if (!fl_is_marker_type(hdr.type)) {
+            *ts_us = hdr.ts_boot_us;
+            found = true;
+            done = true;
+        } else {
+            /* Dive marker — look at the next entry. */
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief First ring position in [lo, hi) whose sector starts after @p ts_us.
+ *
+ * @param unreadable_after How to order a sector whose start cannot be read;
+ *        callers pick the side that widens the range rather than cutting it.
+ * @return The position, or @p hi when every sector starts at or before it.
+ */
+static size_t fl_first_sector_after(struct fcb *fcb_p, size_t lo, size_t hi,
+                                    uint64_t ts_us, bool unreadable_after)
+{
+    while (lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2U);
+        uint64_t start = 0U;
+        bool after = unreadable_after;
+
+        if (fl_sector_start_ts(fcb_p, &fcb_p->f_sectors[fl_ring_sector(fcb_p, mid)],
+                               &start)) {
+            after = (start > ts_us);
+        }
+        if (after) {
+            hi = mid;
+        } else {
+            lo = mid + 1U;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Ring positions of the boot's first sector and of the sector holding
+ *        the next boot's marker (or the active sector).
+ *
+ * @return false when the boot is not on flash.
+ */
+static bool fl_boot_ring_span(struct fcb *fcb_p,
+                              const FlashLogIndexEntry_t *index,
+                              uint32_t boot_id, size_t *first, size_t *last)
+{
+    size_t used = fl_ring_used(fcb_p);
+    size_t found = SIZE_MAX;
+
+    *last = used - 1U;
+    for (size_t k = 0U; (k < used) && (found == SIZE_MAX); ++k) {
+        const FlashLogIndexEntry_t *e = &index[fl_ring_sector(fcb_p, k)];
+
+        if ((0U != (e->flags & FL_INDEX_FLAG_HAS_BOOT)) &&
+            (e->first_boot_id == boot_id)) {
+            found = k;
+        }
+    }
+    if (found == SIZE_MAX) {
+        /* Second boot in a shared sector — same fallback as by-boot. */
+        size_t phys = fl_scan_for_marker(fcb_p, FL_TYPE_BOOT_MARKER, boot_id);
+
+        if (phys != SIZE_MAX) {
+            size_t cnt = (size_t)fcb_p->f_sector_cnt;
+            size_t oldest = (size_t)(fcb_p->f_oldest - fcb_p->f_sectors);
+
+            found = ((phys + cnt) - oldest) % cnt;
+        }
+    }
+    *first = found;
+    for (size_t k = found + 1U; (found != SIZE_MAX) && (k < *last); ++k) {
+        if (0U != (index[fl_ring_sector(fcb_p, k)].flags & FL_INDEX_FLAG_HAS_BOOT)) {
+            *last = k;
+        }
+    }
+    return found != SIZE_MAX;
+}
+
+static Status_t fl_resolve_time_range_impl(FlashLogDest_t dest,
+                                           uint32_t boot_id,
+                                           uint64_t start_us, uint64_t end_us,
+                                           FlashLogRange_t *out)
+{
+    Status_t rc = fl_ensure_index(dest);
+
+    if (0 == rc) {
+        const FlashLogIndexEntry_t *index = fl_index_for(dest);
+        struct fcb *fcb_p = flash_log_internal_get_fcb(dest);
+        size_t first = 0U;
+        size_t last = 0U;
+
+        if ((index == NULL) || (fcb_p == NULL)) {
+            rc = -EINVAL;
+        } else if ((fcb_p->f_oldest == NULL) ||
+                   (fcb_p->f_active.fe_sector == NULL) ||
+                   (!fl_boot_ring_span(fcb_p, index, boot_id, &first, &last))) {
+            rc = -ENOENT;
+        } else {
+            size_t used = fl_ring_used(fcb_p);
+            size_t begin = 0U;
+            size_t stop = 0U;
+
+            watchdog_kick();
+            if (0 == external_flash_acquire(K_FOREVER)) {
+                /* Begin: the last sector of the boot that starts at or
+                 * before start_us (never before the marker's own sector). */
+                begin = fl_first_sector_after(fcb_p, first + 1U, last + 1U,
+                                              start_us, true) - 1U;
+                /* End (exclusive): the first sector starting after end_us. */
+                stop = fl_first_sector_after(fcb_p, begin + 1U, last + 1U,
+                                             end_us, false);
+                external_flash_release();
+            } else {
+                begin = first;
+                stop = last + 1U;
+            }
+
+            fl_range_clear(out, dest);
+            out->begin.fe_sector = &fcb_p->f_sectors[fl_ring_sector(fcb_p, begin)];
+            out->begin.fe_elem_off = 0;
+            if (stop < used) {
+                out->end.fe_sector = &fcb_p->f_sectors[fl_ring_sector(fcb_p, stop)];
+                out->end.fe_elem_off = 0;
+            }
+            out->window.active = true;
+            out->window.await_boot = (begin == first);
+            out->window.boot_id = boot_id;
+            out->window.start_us = start_us;
+            out->window.end_us = end_us;
+        }
+    }
+    return rc;
+}
+
+Status_t flash_log_reader_resolve_time_range(FlashLogDest_t dest,
+                                             uint32_t boot_id,
+                                             uint64_t start_us,
+                                             uint64_t end_us,
+                                             FlashLogRange_t *out)
+{
+    Status_t rc = 0;
+
+    if ((out == NULL) || (dest >= FL_DEST_COUNT) || (start_us > end_us)) {
+        rc = -EINVAL;
+    } else {
+        rc = fl_index_claim();
+        if (0 == rc) {
+            rc = fl_resolve_time_range_impl(dest, boot_id, start_us, end_us,
+                                            out);
+            fl_index_unclaim();
+        }
+    }
+    return rc;
+}
+
 /* ---- Streaming cursor ---- */
 
 void flash_log_reader_open(FlashLogReader_t *r, const FlashLogRange_t *range)
@@ -798,38 +1110,722 @@ void flash_log_reader_open(FlashLogReader_t *r, const FlashLogRange_t *range)
         r->finished = false;
         r->have_entry = false;
         r->emit_off = 0U;
+        r->in_window = false;
+        r->boot_seen = !range->window.await_boot;
+        r->have_held = false;
+        (void)memset(&r->held, 0, sizeof(r->held));
+        r->filtered = false;
+        r->in_container = false;
+        r->type_mask = 0U;
+        r->scratch = NULL;
+        (void)memset(&r->container, 0, sizeof(r->container));
+        r->sub_off = 0U;
+        r->sub_base = 0U;
+        r->agg_flushing = false;
+        r->sub_held = false;
+        r->agg_slot = 0U;
+        r->agg_off = 0U;
+        r->agg = NULL;
+    }
+}
+
+Status_t flash_log_reader_set_filter(FlashLogReader_t *r, uint64_t type_mask,
+                                     FlashLogFilterScratch_t *scratch)
+{
+    Status_t rc = 0;
+
+    if ((NULL == r) || (NULL == scratch) || r->started) {
+        rc = -EINVAL;
+    } else {
+        r->filtered = true;
+        r->type_mask = type_mask;
+        r->scratch = scratch;
+    }
+    return rc;
+}
+
+Status_t flash_log_reader_set_decimation(FlashLogReader_t *r, uint32_t bucket_us,
+                                         FlashLogAggregator_t *agg)
+{
+    Status_t rc = 0;
+
+    if ((NULL == r) || (NULL == agg) || (0U == bucket_us) || (!r->filtered) ||
+        r->started) {
+        rc = -EINVAL;
+    } else {
+        flash_log_agg_init(agg, bucket_us);
+        r->agg = agg;
     }
+    return rc;
+}
+
+/**
+ * @brief Name a sector by its array index and current FCB sector id.
+ *
+ * A NULL sector (the "oldest" end of a range) is FL_RESUME_NO_SECTOR.
+ *
+ * @return false when the sector is not on the ring.
+ */
+static bool fl_sector_ref(const struct fcb *fcb_p,
+                          const struct flash_sector *sector,
+                          uint16_t *idx, uint16_t *id)
+{
+    bool live = true;
+
+    *idx = FL_RESUME_NO_SECTOR;
+    *id = 0U;
+    if (NULL != sector) {
+        *idx = (uint16_t)(sector - fcb_p->f_sectors);
+        live = flash_log_sector_live_id(fcb_p, sector, id);
+    }
+    return live;
+}
+
+/**
+ * @brief Look a sector named by fl_sector_ref() up again.
+ *
+ * @param sector Receives the sector, or NULL for FL_RESUME_NO_SECTOR.
+ * @return false when the index is out of range or the sector now carries
+ *         another id.
+ */
+static bool fl_sector_deref(const struct fcb *fcb_p, uint16_t idx, uint16_t id,
+                            struct flash_sector **sector)
+{
+    bool live = true;
+    uint16_t now = 0U;
+
+    *sector = NULL;
+    if (FL_RESUME_NO_SECTOR == idx) {
+        /* No action required — the oldest sector */
+    } else if ((idx >= fcb_p->f_sector_cnt) ||
+               (!flash_log_sector_live_id(fcb_p, &fcb_p->f_sectors[idx], &now)) ||
+               (now != id)) {
+        live = false;
+    } else {
+        *sector = &fcb_p->f_sectors[idx];
+    }
+    return live;
+}
+
+Status_t flash_log_reader_checkpoint(const FlashLogReader_t *r,
+                                     FlashLogResumePoint_t *out)
+{
+    Status_t rc = 0;
+    const struct fcb *fcb_p = NULL;
+
+    if ((NULL == r) || (NULL == out)) {
+        rc = -EINVAL;
+    } else if (r->filtered || r->range.window.active) {
+        rc = -ENOTSUP;
+    } else {
+        fcb_p = flash_log_internal_get_fcb(r->range.dest);
+        if (NULL == fcb_p) {
+            rc = -EINVAL;
+        }
+    }
+
+    if (0 == rc) {
+        const struct fcb_entry *at = &r->cursor;
+
+        (void)memset(out, 0, sizeof(*out));
+        out->dest = r->range.dest;
+        if (!r->started) {
+            out->at = FL_RESUME_AT_BEGIN;
+            at = &r->range.begin;
+        } else if (r->finished) {
+            out->at = FL_RESUME_FINISHED;
+        } else if (r->have_entry) {
+            out->at = FL_RESUME_IN_ENTRY;
+            out->emit_off = r->emit_off;
+        } else {
+            out->at = FL_RESUME_AFTER_ENTRY;
+        }
+
+        out->elem_off = at->fe_elem_off;
+        out->bounded = (NULL != r->range.end.fe_sector);
+        out->end_elem_off = r->range.end.fe_elem_off;
+        if ((FL_RESUME_FINISHED != out->at) &&
+            (!fl_sector_ref(fcb_p, at->fe_sector, &out->sector_idx,
+                            &out->sector_id))) {
+            rc = -ESTALE;
+        } else if (!fl_sector_ref(fcb_p, r->range.end.fe_sector,
+                                  &out->end_idx, &out->end_id)) {
+            rc = -ESTALE;
+        } else {
+            /* No action required */
+        }
+    }
+    return rc;
+}
+
+/**
+ * @brief Find the entry at @p elem_off of @p sector again.
+ *
+ * FCB entries are only reachable by walking a sector from its start, and
+ * the walk also proves the entry is still there and intact.
+ *
+ * @return true with @p loc on the entry, false when no entry starts there.
+ */
+static bool fl_find_entry(struct fcb *fcb_p, struct flash_sector *sector,
+                          uint32_t elem_off, struct fcb_entry *loc)
+{
+    bool walking = true;
+    bool found = false;
+
+    (void)memset(loc, 0, sizeof(*loc));
+    loc->fe_sector = sector;
+    while (walking) {
+        if ((0 != fcb_getnext(fcb_p, loc)) || (loc->fe_sector != sector) ||
+            (loc->fe_elem_off > elem_off)) {
+            walking = false;
+        } else if (loc->fe_elem_off == elem_off) {
+            found = true;
+            walking = false;
+        } else {
+            /* No action required — keep walking */
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Body of flash_log_reader_resume(), under the external-flash lock.
+ */
+static Status_t fl_reader_resume_locked(FlashLogReader_t *r, struct fcb *fcb_p,
+                                        const FlashLogResumePoint_t *p)
+{
+    Status_t rc = 0;
+    FlashLogRange_t range = {0};
+    struct flash_sector *sector = NULL;
+    struct fcb_entry at = {0};
+
+    range.dest = p->dest;
+    if (!p->bounded) {
+        /* No action required — the range runs to the newest entry */
+    } else if (FL_RESUME_NO_SECTOR == p->end_idx) {
+        rc = -EINVAL;
+    } else if (!fl_sector_deref(fcb_p, p->end_idx, p->end_id,
+                                &range.end.fe_sector)) {
+        rc = -ESTALE;
+    } else {
+        range.end.fe_elem_off = p->end_elem_off;
+    }
+
+    if ((0 != rc) || (FL_RESUME_FINISHED == p->at)) {
+        /* No action required — nothing left to place */
+    } else if (!fl_sector_deref(fcb_p, p->sector_idx, p->sector_id, &sector)) {
+        rc = -ESTALE;
+    } else if (FL_RESUME_AT_BEGIN == p->at) {
+        range.begin.fe_sector = sector;
+        range.begin.fe_elem_off = p->elem_off;
+    } else if ((NULL == sector) ||
+               (!fl_find_entry(fcb_p, sector, p->elem_off, &at))) {
+        rc = -ESTALE;
+    } else if ((FL_RESUME_IN_ENTRY == p->at) &&
+               (p->emit_off >= at.fe_data_len)) {
+        rc = -EINVAL;
+    } else {
+        /* No action required — the entry is still there */
+    }
+
+    if (0 == rc) {
+        flash_log_reader_open(r, &range);
+        if (FL_RESUME_AT_BEGIN != p->at) {
+            r->cursor = at;
+            r->started = true;
+            r->finished = (FL_RESUME_FINISHED == p->at);
+            r->have_entry = (FL_RESUME_IN_ENTRY == p->at);
+            r->emit_off = r->have_entry ? p->emit_off : 0U;
+        }
+    }
+    return rc;
+}
+
+Status_t flash_log_reader_resume(FlashLogReader_t *r,
+                                 const FlashLogResumePoint_t *p)
+{
+    Status_t rc = 0;
+    struct fcb *fcb_p = NULL;
+
+    if ((NULL == r) || (NULL == p) || (p->dest >= FL_DEST_COUNT) ||
+        (p->at > FL_RESUME_FINISHED)) {
+        rc = -EINVAL;
+    } else {
+        fcb_p = flash_log_internal_get_fcb(p->dest);
+        if (NULL == fcb_p) {
+            rc = -EINVAL;
+        }
+    }
+
+    if (0 == rc) {
+        rc = external_flash_acquire(K_FOREVER);
+        if (0 == rc) {
+            rc = fl_reader_resume_locked(r, fcb_p, p);
+            external_flash_release();
+        }
+    }
+    return rc;
+}
+
+/**
+ * @brief Step the cursor to the next FCB entry of the range.
+ *
+ * @return true if the cursor now sits on an entry before range.end.
+ */
+static bool fl_reader_step(FlashLogReader_t *r, struct fcb *fcb_p)
+{
+    bool on_entry = false;
+
+    if (0 == fcb_getnext(fcb_p, &r->cursor)) {
+        r->started = true;
+
+        /* End test: if range.end is set and we walked past it, stop. */
+        on_entry = !((r->range.end.fe_sector != NULL) &&
+                     (r->cursor.fe_sector == r->range.end.fe_sector) &&
+                     (r->cursor.fe_elem_off >= r->range.end.fe_elem_off));
+    }
+    return on_entry;
+}
+
+typedef enum {
+    FL_WINDOW_EMIT = 0,
+    FL_WINDOW_SKIP,
+    FL_WINDOW_STOP,
+} fl_window_verdict_t;
+
+/**
+ * @brief Place the entry at the cursor relative to the range's time window.
+ *
+ * A non-marker entry past end_us ends the window: on telemetry that is a
+ * batch container, and every later container starts later still. A marker
+ * never does on its own timestamp — it is written ahead of the batch that
+ * was filling when it fired. Entries before start_us are skipped, except
+ * that the last such batch container is remembered in r->held.
+ */
+static fl_window_verdict_t fl_reader_window_check(FlashLogReader_t *r,
+                                                  const struct fcb *fcb_p)
+{
+    const FlashLogWindow_t *w = &r->range.window;
+    fl_window_verdict_t verdict = FL_WINDOW_EMIT;
+    fl_entry_hdr_t hdr = {0};
+    off_t off = fl_entry_data_off(&r->cursor);
+
+    if (0 != flash_area_read(fcb_p->fap, off, &hdr, sizeof(hdr))) {
+        /* Unreadable header: let the emit path surface the read error. */
+    } else {
+        if (FL_TYPE_BOOT_MARKER == hdr.type) {
+            fl_payload_boot_marker_t p = { .boot_id = FL_INVALID_BOOT_ID };
+
+            (void)flash_area_read(fcb_p->fap, off + (off_t)sizeof(hdr),
+                                  &p, sizeof(p));
+            if (p.boot_id == w->boot_id) {
+                r->boot_seen = true;
+                r->have_held = false;
+            } else if (r->boot_seen) {
+                verdict = FL_WINDOW_STOP;   /* the next boot begins */
+            } else {
+                /* An earlier boot sharing the begin sector. */
+            }
+        }
+
+        if (FL_WINDOW_STOP == verdict) {
+            /* No action required */
+        } else if (!r->boot_seen) {
+            verdict = FL_WINDOW_SKIP;
+        } else if ((hdr.ts_boot_us > w->end_us) &&
+                   (!fl_is_marker_type(hdr.type))) {
+            verdict = FL_WINDOW_STOP;
+        } else if (r->in_window || (hdr.ts_boot_us >= w->start_us)) {
+            verdict = FL_WINDOW_EMIT;
+        } else {
+            if (fl_is_batch_type(hdr.type)) {
+                r->held = r->cursor;
+                r->have_held = true;
+            }
+            verdict = FL_WINDOW_SKIP;
+        }
+    }
+    return verdict;
+}
+
+/* ---- Record-type filter ---- */
+
+/** Record types at or above this are outside the mask and always pass. */
+#define FL_FILTER_MASK_BITS 64U
+
+static bool fl_filter_accepts(const FlashLogReader_t *r, uint8_t type)
+{
+    bool accept = true;
+
+    if (fl_is_marker_type(type) || (FL_TYPE_DROP_MARKER == type)) {
+        /* No action required — the host segments the stream on these */
+    } else if (type < FL_FILTER_MASK_BITS) {
+        accept = (0U != (r->type_mask & (1ULL << type)));
+    } else {
+        /* No action required — outside the mask (LOG_TEXT) */
+    }
+    return accept;
+}
+
+static bool fl_window_contains(const FlashLogWindow_t *w, uint64_t ts)
+{
+    return (!w->active) || ((ts >= w->start_us) && (ts <= w->end_us));
+}
+
+/**
+ * @brief Start unpacking the placed entry as a container whose records
+ *        begin @p base bytes into the entry.
+ */
+static void fl_reader_enter(FlashLogReader_t *r, const fl_entry_hdr_t *hdr,
+                            uint8_t base)
+{
+    FlashLogFilterScratch_t *s = r->scratch;
+    uint16_t room = 0U;
+
+    if (r->cursor.fe_data_len > base) {
+        room = (uint16_t)(r->cursor.fe_data_len - base);
+    }
+    r->container = *hdr;
+    r->container.length = MIN(hdr->length, room);
+    r->in_container = true;
+    r->sub_off = 0U;
+    r->sub_base = base;
+    s->in_off = 0U;
+    s->in_len = 0U;
+    s->out_len = 0U;
+    flash_log_codec_init_slots(&s->codec, s->slots, hdr->ts_boot_us);
+}
+
+/**
+ * @brief Decide what a filtered cursor does with the entry it landed on.
+ *
+ * A batch container is entered, to be unpacked by fl_reader_emit_sub().
+ * When decimating, so is a lone entry of an aggregated type (as a
+ * one-record legacy container), since its payload must be read to fold it.
+ * Any other entry is kept or skipped on its own type.
+ *
+ * @return false to skip the entry.
+ */
+static bool fl_reader_filter_place(FlashLogReader_t *r, const struct fcb *fcb_p)
+{
+    bool keep = true;
+    fl_entry_hdr_t hdr = {0};
+
+    if (0 != flash_area_read(fcb_p->fap, fl_entry_data_off(&r->cursor),
+                             &hdr, sizeof(hdr))) {
+        /* Unreadable header: let the emit path surface the read error. */
+    } else if (fl_is_batch_type(hdr.type)) {
+        fl_reader_enter(r, &hdr, (uint8_t)sizeof(hdr));
+    } else if ((NULL != r->agg) && flash_log_agg_handles(hdr.type) &&
+               fl_filter_accepts(r, hdr.type)) {
+        fl_entry_hdr_t lone = hdr;
+
+        lone.type = FL_TYPE_BATCH;
+        lone.length = r->cursor.fe_data_len;
+        fl_reader_enter(r, &lone, 0U);
+    } else {
+        r->container = hdr;
+        keep = fl_filter_accepts(r, hdr.type);
+    }
+    return keep;
+}
+
+/**
+ * @brief Make sure scratch->in holds a whole sub-record at sub_off (or the
+ *        rest of the container, when that is shorter).
+ *
+ * @return 0, or a negative errno from the flash read.
+ */
+static Status_t fl_reader_stage_sub(FlashLogReader_t *r, const struct fcb *fcb_p)
+{
+    FlashLogFilterScratch_t *s = r->scratch;
+    Status_t rc = 0;
+    size_t left = (size_t)r->container.length - r->sub_off;
+    size_t staged = ((size_t)s->in_off + s->in_len) - r->sub_off;
+
+    if (staged < MIN(left, FL_FILTER_RECORD_MAX)) {
+        size_t n = MIN(left, sizeof(s->in));
+
+        rc = flash_area_read(fcb_p->fap,
+                             fl_entry_data_off(&r->cursor) +
+                                 (off_t)r->sub_base + (off_t)r->sub_off,
+                             s->in, n);
+        if (0 == rc) {
+            s->in_off = r->sub_off;
+            s->in_len = (uint16_t)n;
+        }
+    }
+    return rc;
+}
+
+/**
+ * @brief Unpack the sub-record at sub_off into scratch->out and step past it.
+ *
+ * @param r   Cursor inside a container, with the sub-record staged.
+ * @param sub Receives the sub-record's rebuilt header.
+ * @return 0, or non-zero on a malformed or oversized sub-record.
+ */
+static Status_t fl_reader_unpack_sub(FlashLogReader_t *r, fl_entry_hdr_t *sub)
+{
+    FlashLogFilterScratch_t *s = r->scratch;
+    const uint8_t *at = &s->in[r->sub_off - s->in_off];
+    size_t avail = ((size_t)s->in_off + s->in_len) - r->sub_off;
+    size_t used = 0U;
+    Status_t rc = 0;
+
+    if (FL_TYPE_BATCH_PACKED == r->container.type) {
+        rc = flash_log_codec_decode(&s->codec, at, avail, &used, sub,
+                                    &s->out[sizeof(*sub)],
+                                    sizeof(s->out) - sizeof(*sub));
+    } else if (avail < sizeof(*sub)) {
+        rc = -EBADMSG;
+    } else {
+        (void)memcpy(sub, at, sizeof(*sub));
+        used = sizeof(*sub) + sub->length;
+        if ((used > avail) || (used > sizeof(s->out))) {
+            rc = -EBADMSG;
+        } else {
+            (void)memcpy(&s->out[sizeof(*sub)], &at[sizeof(*sub)], sub->length);
+        }
+    }
+
+    if (0 == rc) {
+        (void)memcpy(s->out, sub, sizeof(*sub));
+        s->out_len = (uint16_t)(sizeof(*sub) + sub->length);
+        r->sub_off = (uint16_t)(r->sub_off + used);
+    }
+    return rc;
+}
+
+/**
+ * @brief Close the open bucket ahead of @p hdr when it belongs to a later
+ *        one (any record when @p hdr is NULL): emission switches to the
+ *        pending aggregates.
+ *
+ * @return true when a flush was started.
+ */
+static bool fl_reader_begin_flush(FlashLogReader_t *r, const fl_entry_hdr_t *hdr,
+                                  const uint8_t *payload)
+{
+    bool flush = false;
+
+    if (NULL == r->agg) {
+        /* No action required — not decimating */
+    } else if (NULL == hdr) {
+        flush = flash_log_agg_next_pending(r->agg, 0U) < FL_AGG_SLOT_COUNT;
+    } else {
+        flush = flash_log_agg_must_flush(r->agg, hdr, payload);
+    }
+
+    if (flush) {
+        r->agg_flushing = true;
+        r->agg_slot = (uint8_t)flash_log_agg_next_pending(r->agg, 0U);
+        r->agg_off = 0U;
+    }
+    return flush;
+}
+
+/**
+ * @brief Route the selected sub-record staged in scratch->out.
+ *
+ * Without decimation it is emitted. With it, an aggregated type is folded
+ * instead, and a record that closes the open bucket is held until the
+ * bucket's aggregates are out.
+ *
+ * @return true when scratch->out is to be emitted (possibly after a flush).
+ */
+static bool fl_reader_take_sub(FlashLogReader_t *r)
+{
+    FlashLogFilterScratch_t *s = r->scratch;
+    const uint8_t *payload = &s->out[sizeof(fl_entry_hdr_t)];
+    fl_entry_hdr_t sub = {0};
+    bool emit = true;
+
+    (void)memcpy(&sub, s->out, sizeof(sub));
+    if (NULL == r->agg) {
+        /* No action required — not decimating */
+    } else if (fl_reader_begin_flush(r, &sub, payload)) {
+        r->sub_held = true;
+    } else if (flash_log_agg_handles(sub.type)) {
+        /* A malformed record has no accumulator and is dropped. */
+        (void)flash_log_agg_fold(r->agg, &sub, payload);
+        s->out_len = 0U;
+        emit = false;
+    } else {
+        /* No action required — streams as is */
+    }
+    return emit;
+}
+
+/**
+ * @brief Stage the container's next selected sub-record in scratch->out.
+ *
+ * Every sub-record is decoded, since packed ones delta-code against their
+ * predecessors, but only a selected one ends the scan. A malformed
+ * sub-record ends the container early: the bytes after it cannot be framed,
+ * and the entries after the container are unaffected.
+ *
+ * @return 0 when a record is staged, -ENOENT once the container is done,
+ *         or a negative errno from the flash read.
+ */
+static Status_t fl_reader_next_sub(FlashLogReader_t *r, const struct fcb *fcb_p)
+{
+    Status_t rc = -ENOENT;
+    bool searching = true;
+
+    while (searching && (r->sub_off < r->container.length)) {
+        fl_entry_hdr_t sub = {0};
+        Status_t stage_rc = fl_reader_stage_sub(r, fcb_p);
+
+        if (0 != stage_rc) {
+            rc = stage_rc;
+            searching = false;
+        } else if (0 != fl_reader_unpack_sub(r, &sub)) {
+            r->sub_off = r->container.length;
+        } else if (fl_filter_accepts(r, sub.type) &&
+                   fl_window_contains(&r->range.window, sub.ts_boot_us) &&
+                   fl_reader_take_sub(r)) {
+            rc = 0;
+            searching = false;
+        } else {
+            /* No action required — not selected */
+        }
+    }
+    return rc;
+}
+
+/**
+ * @brief Emit up to buf_size bytes of the container's selected sub-records.
+ *
+ * As with fl_reader_emit_chunk(), one record may span several calls. Once
+ * the container is exhausted this returns 0 with have_entry cleared, which
+ * the caller takes as "advance", not as the end of the stream.
+ *
+ * @return Bytes emitted (>=0), or a negative errno from the flash read.
+ */
+static Status_t fl_reader_emit_sub(FlashLogReader_t *r, const struct fcb *fcb_p,
+                                   uint8_t *buf, size_t buf_size)
+{
+    FlashLogFilterScratch_t *s = r->scratch;
+    Status_t result = 0;
+
+    if (r->sub_held) {
+        /* The bucket it closed is out: route it again. */
+        r->sub_held = false;
+        (void)fl_reader_take_sub(r);
+    }
+
+    if (r->emit_off >= s->out_len) {
+        r->emit_off = 0U;
+        s->out_len = 0U;
+        result = fl_reader_next_sub(r, fcb_p);
+    }
+
+    if (-ENOENT == result) {
+        r->in_container = false;
+        r->have_entry = false;
+        result = 0;
+    } else if (result < 0) {
+        /* Flash read error — surfaced to the caller, retried next call */
+    } else if (r->agg_flushing) {
+        result = 0;   /* the staged sub-record waits behind the aggregates */
+    } else {
+        size_t n = MIN(buf_size, (size_t)s->out_len - r->emit_off);
+
+        (void)memcpy(buf, &s->out[r->emit_off], n);
+        r->emit_off += (uint32_t)n;
+        result = (Status_t)n;
+    }
+    return result;
+}
+
+/**
+ * @brief Emit up to buf_size bytes of the pending aggregate records.
+ *
+ * Slices the current slot's record straight out of the aggregator; once the
+ * last pending slot is out, the aggregator is cleared and the cursor goes
+ * back to the entry (or held sub-record) that closed the bucket.
+ *
+ * @return Bytes emitted (> 0).
+ */
+static Status_t fl_reader_emit_agg(FlashLogReader_t *r, uint8_t *buf,
+                                   size_t buf_size)
+{
+    size_t len = flash_log_agg_record_len(r->agg, r->agg_slot);
+    size_t n = MIN(buf_size, len - r->agg_off);
+
+    flash_log_agg_read(r->agg, r->agg_slot, r->agg_off, buf, n);
+    r->agg_off += (uint16_t)n;
+    if (r->agg_off >= len) {
+        r->agg_slot = (uint8_t)flash_log_agg_next_pending(r->agg,
+                                                          (size_t)r->agg_slot + 1U);
+        r->agg_off = 0U;
+        if (r->agg_slot >= FL_AGG_SLOT_COUNT) {
+            flash_log_agg_clear(r->agg);
+            r->agg_flushing = false;
+        }
+    }
+    return (Status_t)n;
 }
 
 /**
  * @brief Advance the cursor to the next FCB entry when none is in flight.
  *
  * Advance happens only once the current entry is fully emitted. A single FCB
- * entry may span several next() calls (see have_entry).
+ * entry may span several next() calls (see have_entry). With a time window,
+ * entries before it are skipped here; when the window opens (or the range
+ * runs out) while a container that began before start_us is held, the cursor
+ * rewinds to that container, since its sub-records may reach into the window.
+ * A filtered cursor also skips entries of unselected types here.
  *
- * @return true if the walk stopped (end of ring or end of range).
+ * @return true if the walk stopped (end of ring, range or window).
  */
 static bool fl_reader_advance(FlashLogReader_t *r, struct fcb *fcb_p)
 {
     bool stopped = false;
-    Status_t rc = fcb_getnext(fcb_p, &r->cursor);
+    bool placed = false;
+    uint32_t skipped = 0U;
 
-    if (0 != rc) {
-        r->finished = true;
-        stopped = true;
-    } else {
-        r->started = true;
+    while ((!stopped) && (!placed)) {
+        fl_window_verdict_t verdict = FL_WINDOW_STOP;
 
-        /* End test: if range.end is set and we walked past it, stop. */
-        if ((r->range.end.fe_sector != NULL) &&
-            (r->cursor.fe_sector == r->range.end.fe_sector) &&
-            (r->cursor.fe_elem_off >= r->range.end.fe_elem_off)) {
-            r->finished = true;
-            stopped = true;
+        if (fl_reader_step(r, fcb_p)) {
+            verdict = FL_WINDOW_EMIT;
+            if (r->range.window.active) {
+                verdict = fl_reader_window_check(r, fcb_p);
+            }
+        }
+
+        if (FL_WINDOW_SKIP == verdict) {
+            /* No action required — keep walking */
+        } else if (r->range.window.active && (!r->in_window) && r->have_held) {
+            r->cursor = r->held;
+            r->have_held = false;
+            r->in_window = true;
+            placed = true;
+        } else if (FL_WINDOW_EMIT == verdict) {
+            r->in_window = true;
+            placed = true;
         } else {
-            r->have_entry = true;
-            r->emit_off = 0U;
+            stopped = true;
+        }
+
+        if (placed && r->filtered) {
+            placed = fl_reader_filter_place(r, fcb_p);
         }
+        if ((!placed) && (!stopped)) {
+            skipped += 1U;
+            if (0U == (skipped % FL_INDEX_WALK_WDT_KICK)) {
+                watchdog_kick();
+            }
+        }
+    }
+
+    if (placed) {
+        r->have_entry = true;
+        r->emit_off = 0U;
+    } else {
+        r->finished = true;
     }
     return stopped;
 }
@@ -882,13 +1878,56 @@ static Status_t fl_reader_emit_chunk(FlashLogReader_t *r,
     return result;
 }
 
+/**
+ * @brief Body of flash_log_reader_next(), under the external-flash lock.
+ *
+ * Loops only past a container whose sub-records were all filtered out (or
+ * folded), and into a decimation flush, so a 0 return still means the range
+ * is exhausted. A flush is started ahead of the entry that closes the open
+ * bucket, and at the end of the range.
+ */
+static Status_t fl_reader_next_locked(FlashLogReader_t *r, struct fcb *fcb_p,
+                                      uint8_t *buf, size_t buf_size)
+{
+    Status_t result = 0;
+    bool again = true;
+
+    while (again) {
+        bool stopped = false;
+
+        again = false;
+        if ((!r->have_entry) && (!r->agg_flushing)) {
+            stopped = fl_reader_advance(r, fcb_p);
+        }
+
+        if (r->agg_flushing) {
+            result = fl_reader_emit_agg(r, buf, buf_size);
+        } else if (stopped) {
+            result = 0;
+            again = fl_reader_begin_flush(r, NULL, NULL);
+        } else if (r->in_container) {
+            result = fl_reader_emit_sub(r, fcb_p, buf, buf_size);
+            again = (0 == result) && ((!r->have_entry) || r->agg_flushing);
+            if (again) {
+                watchdog_kick();
+            }
+        } else if ((0U == r->emit_off) &&
+                   fl_reader_begin_flush(r, &r->container, NULL)) {
+            again = true;
+        } else {
+            result = fl_reader_emit_chunk(r, fcb_p, buf, buf_size);
+        }
+    }
+    return result;
+}
+
 Status_t flash_log_reader_next(FlashLogReader_t *r, uint8_t *buf, size_t buf_size)
 {
     Status_t result = 0;
 
     if ((r == NULL) || (buf == NULL) || (buf_size == 0U)) {
         result = -EINVAL;
-    } else if (r->finished) {
+    } else if (r->finished && (!r->agg_flushing)) {
         result = 0;
     } else {
         struct fcb *fcb_p = flash_log_internal_get_fcb(r->range.dest);
@@ -901,20 +1940,54 @@ Status_t flash_log_reader_next(FlashLogReader_t *r, uint8_t *buf, size_t buf_siz
             if (0 != lock_rc) {
                 result = lock_rc;
             } else {
-                bool stopped = false;
-
-                if (!r->have_entry) {
-                    stopped = fl_reader_advance(r, fcb_p);
-                }
-
-                if (stopped) {
-                    result = 0;
-                } else {
-                    result = fl_reader_emit_chunk(r, fcb_p, buf, buf_size);
-                }
+                result = fl_reader_next_locked(r, fcb_p, buf, buf_size);
                 external_flash_release();
             }
         }
     }
     return result;
 }
+
+Status_t flash_log_reader_expand_batch(const fl_entry_hdr_t *hdr,
+                                       const uint8_t *in, uint8_t *out,
+                                       size_t out_cap, size_t *out_len)
+{
+    Status_t rc = 0;
+    FlashLogCodec_t codec;
+    size_t pos = 0U;
+    size_t olen = 0U;
+
+    if ((NULL == hdr) || (NULL == out) || (NULL == out_len) ||
+        ((NULL == in) && (hdr->length > 0U))) {
+        rc = -EINVAL;
+    } else if (FL_TYPE_BATCH_PACKED != hdr->type) {
+        rc = -EINVAL;
+    } else {
+        flash_log_codec_init(&codec, out, hdr->ts_boot_us);
+    }
+
+    /* Each decoded payload lands directly behind its rebuilt header in
+     * `out`, which doubles as the codec's previous-record store. */
+    while ((0 == rc) && (pos < hdr->length)) {
+        fl_entry_hdr_t sub = {0};
+        size_t used = 0U;
+
+        if ((out_cap - olen) < sizeof(sub)) {
+            rc = -ENOSPC;
+        } else {
+            rc = flash_log_codec_decode(&codec, &in[pos], hdr->length - pos,
+                                        &used, &sub,
+                                        &out[olen + sizeof(sub)],
+                                        out_cap - olen - sizeof(sub));
+        }
+        if (0 == rc) {
+            (void)memcpy(&out[olen], &sub, sizeof(sub));
+            olen += sizeof(sub) + sub.length;
+            pos += used;
+        }
+    }
+    if (NULL != out_len) {
+        *out_len = olen;
+    }
+    return rc;
+}
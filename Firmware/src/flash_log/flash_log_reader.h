@@ -3,8 +3,9 @@
  * @brief Walk / filter / stream-out API for the flash log.
  *
  * Used by the UDS download path (uds_log_download.c) to resolve a
- * selection (latest boot, by dive id, by absolute fcb id range) and
- * iterate the matched entries in order.
+ * selection (latest boot, by dive id, by boot-relative time window) and
+ * iterate the matched entries in order, optionally keeping only chosen
+ * record types.
  *
  * Indexes are built lazily on first selector call and refreshed when
  * `flash_log_reader_invalidate_index()` is called (e.g. on entering a
@@ -21,11 +22,30 @@
 #include "common.h"
 #include "flash_log.h"
 #include "flash_log_internal.h"
+#include "flash_log_entries.h"
+#include "flash_log_codec.h"
+#include "flash_log_aggregate.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief Time window the cursor applies inside a resolved range.
+ *
+ * Set only by flash_log_reader_resolve_time_range(); every other resolver
+ * leaves it inactive and the cursor streams [begin, end) verbatim.
+ */
+typedef struct {
+    bool active;
+    /* The begin sector also holds the tail of earlier boots: emit nothing
+     * before the BOOT_MARKER for boot_id. */
+    bool await_boot;
+    uint32_t boot_id;
+    uint64_t start_us;  /* ts_boot_us, inclusive */
+    uint64_t end_us;    /* ts_boot_us, inclusive */
+} FlashLogWindow_t;
+
 /** @brief Resolved selection range over a single FCB. */
 typedef struct {
     FlashLogDest_t dest;
@@ -35,21 +55,73 @@ typedef struct {
     struct fcb_entry begin;
     struct fcb_entry end;
     uint32_t entry_count_estimate;
+    FlashLogWindow_t window;
 } FlashLogRange_t;
 
+/** @brief Largest encoded batch sub-record the filtered cursor decodes. */
+#define FL_FILTER_RECORD_MAX  FL_CODEC_RAW_MAX_BYTES(CONFIG_FLASH_LOG_MAX_ENTRY_BYTES)
+
+/**
+ * @brief Scratch for a record-type filtered cursor (see
+ *        flash_log_reader_set_filter()).
+ *
+ * Batch containers are unpacked one sub-record at a time: `in` stages the
+ * container bytes around the decode position, `out` holds the one expanded
+ * [fl_entry_hdr_t | payload] record being emitted, and `slots` is the
+ * codec's previous-record store.
+ */
+typedef struct {
+    FlashLogCodec_t codec;
+    uint8_t slots[FL_CODEC_SLOT_STORE_BYTES];
+    uint8_t in[2U * FL_FILTER_RECORD_MAX];
+    uint8_t out[CONFIG_FLASH_LOG_MAX_ENTRY_BYTES];
+    uint16_t in_off;   /* container payload offset of in[0] */
+    uint16_t in_len;   /* valid bytes in `in` */
+    uint16_t out_len;  /* valid bytes in `out` */
+} FlashLogFilterScratch_t;
+
 /** @brief Cursor for iterating a previously-resolved range. */
 typedef struct {
     FlashLogRange_t range;
     struct fcb_entry cursor;
     bool started;
     bool finished;
-    /* Partial-entry streaming: an FCB entry (esp. a FL_TYPE_BATCH container,
+    /* Partial-entry streaming: an FCB entry (esp. a batch container,
      * up to FL_BATCH_BUF_BYTES) can be larger than one download chunk, so a
      * single entry is emitted across multiple next() calls. have_entry means
      * `cursor` is positioned on an entry being streamed; emit_off is how many
      * of its bytes have already been emitted. */
     bool have_entry;
     uint32_t emit_off;
+    /* Time-window seek (range.window.active only). in_window flips at the
+     * first entry at or after start_us; boot_seen once the selected boot's
+     * marker has passed; `held` is the last batch container that began
+     * before start_us, whose later sub-records may fall inside the window. */
+    bool in_window;
+    bool boot_seen;
+    bool have_held;
+    struct fcb_entry held;
+    /* Record-type filter (flash_log_reader_set_filter() only). While
+     * in_container the cursor sits on a batch container and emits its
+     * selected sub-records from scratch->out; sub_off is the next
+     * sub-record's offset in the container payload, which starts sub_base
+     * bytes into the entry. `container` is the placed entry's header. */
+    bool filtered;
+    bool in_container;
+    uint64_t type_mask;
+    FlashLogFilterScratch_t *scratch;
+    fl_entry_hdr_t container;
+    uint16_t sub_off;
+    uint8_t sub_base;
+    /* Decimation (flash_log_reader_set_decimation() only). While
+     * agg_flushing the cursor emits the closed bucket's aggregates, slot
+     * agg_slot from byte agg_off; sub_held marks a sub-record waiting in
+     * scratch->out behind that flush. */
+    bool agg_flushing;
+    bool sub_held;
+    uint8_t agg_slot;
+    uint16_t agg_off;
+    FlashLogAggregator_t *agg;
 } FlashLogReader_t;
 
 /** @brief Force the next selector call to rebuild its in-RAM index. */
@@ -87,12 +159,142 @@ Status_t flash_log_reader_resolve_boot_id(FlashLogDest_t dest, uint32_t boot_id,
 Status_t flash_log_reader_resolve_dive_id(FlashLogDest_t dest, uint16_t dive_id,
                      FlashLogRange_t *out);
 
+/**
+ * @brief Resolve "boot N between two uptime timestamps on `dest`".
+ *
+ * The boot's sectors come from the marker index; the begin and end sectors
+ * are then found by binary search on each sector's first timestamp (sectors
+ * start in time order within one boot), so the cursor seeks straight to the
+ * window instead of walking the boot from its marker. The cursor finishes
+ * the job per entry: it skips entries before @p start_us, and stops at the
+ * first entry after @p end_us or at the next boot's marker.
+ *
+ * @param dest     Telemetry or text FCB.
+ * @param boot_id  Boot whose uptime clock the bounds refer to.
+ * @param start_us First ts_boot_us to include.
+ * @param end_us   Last ts_boot_us to include (UINT64_MAX = end of boot).
+ * @param out      Receives the range.
+ * @return 0 on success, -EINVAL on bad arguments (including start > end),
+ *         -ENOENT when the boot is not on flash, -EBUSY while another tenant
+ *         holds the maintenance arena.
+ */
+Status_t flash_log_reader_resolve_time_range(FlashLogDest_t dest,
+                                             uint32_t boot_id,
+                                             uint64_t start_us,
+                                             uint64_t end_us,
+                                             FlashLogRange_t *out);
+
 /** @brief Resolve "everything on `dest`" into an iterable range. */
 Status_t flash_log_reader_resolve_all(FlashLogDest_t dest, FlashLogRange_t *out);
 
 /** @brief Prepare a cursor to stream `range`. */
 void flash_log_reader_open(FlashLogReader_t *r, const FlashLogRange_t *range);
 
+/**
+ * @brief Keep only the chosen record types in an opened cursor's stream.
+ *
+ * Bit `t` of @p type_mask selects record type `t` (FlashLogType_t values
+ * below 64, i.e. every telemetry type). Boot, dive and drop markers, and
+ * types outside the mask's range (LOG_TEXT), always pass. Batch containers
+ * are unpacked on the device: a filtered stream carries no containers, only
+ * the selected sub-records as plain [fl_entry_hdr_t | payload] entries, and
+ * sub-records outside the range's time window are dropped too.
+ *
+ * @param r         Cursor from flash_log_reader_open(), before its first
+ *                  flash_log_reader_next().
+ * @param type_mask Selected record types.
+ * @param scratch   Decode state, owned by the caller until the stream ends.
+ * @return 0 on success, -EINVAL on a NULL argument or a started cursor.
+ */
+Status_t flash_log_reader_set_filter(FlashLogReader_t *r, uint64_t type_mask,
+                                     FlashLogFilterScratch_t *scratch);
+
+/**
+ * @brief Replace the high-rate numeric records of a filtered cursor by
+ *        per-bucket aggregates.
+ *
+ * Consensus, cell raw and power snapshot records selected by the filter are
+ * folded into FL_TYPE_AGGREGATE records (min / mean / max per channel, see
+ * flash_log_aggregate.h), one per source stream and @p bucket_us bucket;
+ * every other selected record streams as before. A bucket's aggregates are
+ * emitted ahead of the first record of a later bucket, ahead of a boot
+ * marker, and at the end of the range.
+ *
+ * @param r         Cursor with a filter set, before its first
+ *                  flash_log_reader_next().
+ * @param bucket_us Bucket length in microseconds (non-zero).
+ * @param agg       Aggregator, owned by the caller until the stream ends.
+ * @return 0 on success, -EINVAL on a NULL argument, a zero bucket, an
+ *         unfiltered cursor or a started cursor.
+ */
+Status_t flash_log_reader_set_decimation(FlashLogReader_t *r, uint32_t bucket_us,
+                                         FlashLogAggregator_t *agg);
+
+/** @brief Sector index of a resume point that means "the oldest sector". */
+#define FL_RESUME_NO_SECTOR  0xFFFFU
+
+/** @brief Where a resumed cursor picks up its range. */
+typedef enum {
+    FL_RESUME_AT_BEGIN = 0,   /* nothing emitted yet: the start of the range */
+    FL_RESUME_IN_ENTRY,       /* emit_off bytes of the entry are out */
+    FL_RESUME_AFTER_ENTRY,    /* the entry is out; go on with the next one */
+    FL_RESUME_FINISHED,       /* the range is exhausted */
+} FlashLogResumeAt_t;
+
+/**
+ * @brief A raw cursor's position, in terms that outlive the cursor.
+ *
+ * Sectors are named by their index in the FCB's sector array together with
+ * the FCB sector id they held when the checkpoint was taken, so a resume
+ * can tell that the ring has since recycled one. Offsets are FCB element
+ * offsets within the sector (0 = the sector start).
+ */
+typedef struct {
+    FlashLogDest_t dest;
+    FlashLogResumeAt_t at;
+    uint16_t sector_idx;     /* cursor (AT_BEGIN: range.begin) sector */
+    uint16_t sector_id;
+    uint32_t elem_off;
+    uint32_t emit_off;       /* IN_ENTRY only */
+    bool bounded;            /* range.end is set */
+    uint16_t end_idx;
+    uint16_t end_id;
+    uint32_t end_elem_off;
+} FlashLogResumePoint_t;
+
+/**
+ * @brief Capture where a raw cursor stands.
+ *
+ * Only a cursor that streams entries verbatim has a position that can be
+ * restored on its own: a filtered, decimated or time-windowed cursor also
+ * carries decode and window state. Call while the writer is paused (as it
+ * is for a live download), so the sector ids are stable.
+ *
+ * @param r   Open cursor.
+ * @param out Receives the position.
+ * @return 0 on success, -EINVAL on a NULL argument, -ENOTSUP for a
+ *         filtered or windowed cursor, -ESTALE when the cursor's sector is
+ *         no longer on the ring.
+ */
+Status_t flash_log_reader_checkpoint(const FlashLogReader_t *r,
+                                     FlashLogResumePoint_t *out);
+
+/**
+ * @brief Open a cursor at a position taken by flash_log_reader_checkpoint().
+ *
+ * The cursor then streams exactly the bytes the checkpointed one still had
+ * to stream, provided the ring has not recycled a sector in between. The
+ * resumed range carries no entry-count estimate.
+ *
+ * @param r Cursor to open.
+ * @param p Checkpoint.
+ * @return 0 on success, -EINVAL on a NULL argument or a malformed
+ *         checkpoint, -ESTALE when a sector it names was recycled or its
+ *         entry is gone, or a negative errno from the flash lock.
+ */
+Status_t flash_log_reader_resume(FlashLogReader_t *r,
+                                 const FlashLogResumePoint_t *p);
+
 /**
  * @brief Read the next entry's TLV-header + payload bytes into `buf`.
  *
@@ -101,6 +303,28 @@ void flash_log_reader_open(FlashLogReader_t *r, const FlashLogRange_t *range);
  */
 Status_t flash_log_reader_next(FlashLogReader_t *r, uint8_t *buf, size_t buf_size);
 
+/**
+ * @brief Expand one FL_TYPE_BATCH_PACKED container into the legacy
+ *        FL_TYPE_BATCH payload layout (a sequence of [fl_entry_hdr_t + payload]).
+ *
+ * For on-target consumers that need individual telemetry records rather than
+ * the raw entry bytes flash_log_reader_next() streams. The expanded form is
+ * never larger than the writer's staging buffer (FL_BATCH_BUF_BYTES), so an
+ * `out` of that size always suffices.
+ *
+ * @param hdr     Container entry header (type FL_TYPE_BATCH_PACKED).
+ * @param in      Container payload, hdr->length bytes.
+ * @param out     Receives the expanded sub-records.
+ * @param out_cap Bytes available at `out`.
+ * @param out_len Receives the expanded length; on error, the bytes of the
+ *                sub-records decoded before the failure.
+ * @return 0 on success, -EINVAL on bad arguments or a non-packed entry,
+ *         -EBADMSG on a malformed container, -ENOSPC when `out` is too small.
+ */
+Status_t flash_log_reader_expand_batch(const fl_entry_hdr_t *hdr,
+                                       const uint8_t *in, uint8_t *out,
+                                       size_t out_cap, size_t *out_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,220 @@
+/**
+ * @file flash_log_tail.c
+ * @brief Live tail of telemetry records — see flash_log_tail.h.
+ *
+ * Producers run on many threads (consensus, PID, solenoid, power) and CAN
+ * capture runs in an ISR, so the subscription and the token bucket sit
+ * behind a spinlock; the copy into the queue happens outside it. The bucket
+ * is kept in milli-bytes so a budget of a few hundred bytes a second still
+ * refills on records only a few milliseconds apart.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include "flash_log_tail.h"
+
+#define FL_TAIL_MILLI        1000U  /* milli-bytes per byte; ms per second */
+#define FL_TAIL_TYPE_BITS    64U
+
+BUILD_ASSERT(sizeof(fl_payload_power_snapshot_t) <= FL_TAIL_MAX_PAYLOAD,
+             "largest tailed payload must fit a tail slot");
+BUILD_ASSERT(sizeof(fl_payload_cell_diveo2_t) <= FL_TAIL_MAX_PAYLOAD,
+             "largest tailed payload must fit a tail slot");
+BUILD_ASSERT(((uint64_t)FL_TAIL_BUDGET_MAX * FL_TAIL_MILLI) <= UINT32_MAX,
+             "bucket level must fit a u32 in milli-bytes");
+BUILD_ASSERT((CONFIG_FLASH_LOG_TAIL_DEFAULT_BUDGET >= FL_TAIL_BUDGET_MIN) &&
+             (CONFIG_FLASH_LOG_TAIL_DEFAULT_BUDGET <= FL_TAIL_BUDGET_MAX),
+             "default tail budget outside the accepted range");
+
+/* One queued record, laid out as it goes on the wire. */
+typedef struct {
+    fl_entry_hdr_t hdr;
+    uint8_t payload[FL_TAIL_MAX_PAYLOAD];
+} __packed FlTailSlot_t;
+
+K_MSGQ_DEFINE(fl_tail_msgq, sizeof(FlTailSlot_t),
+              CONFIG_FLASH_LOG_TAIL_QUEUE_DEPTH, 1);
+
+typedef struct {
+    uint64_t type_mask;
+    uint32_t budget_bps;
+    uint32_t level_mb;       /* bucket level, milli-bytes */
+    uint32_t refill_ms;      /* bucket clock at the last refill */
+    uint32_t lease_ms;       /* uptime of the last (re)subscribe */
+    bool     drop_pending;   /* a record was lost since the last one queued */
+} FlTailState_t;
+
+static struct k_spinlock fl_tail_lock;
+static FlTailState_t fl_tail;
+/* Non-zero while subscribed — the lock-free early-out on the producer path. */
+static atomic_t fl_tail_on = ATOMIC_INIT(0);
+
+/* RX-thread scratch for peeking at the head of the queue. */
+static FlTailSlot_t fl_tail_peek;
+
+/* Signed: a record stamped just before the (re)subscribe is still in lease. */
+static bool fl_tail_lease_lapsed(uint32_t now_ms)
+{
+    return (int32_t)(now_ms - fl_tail.lease_ms) >= (int32_t)FL_TAIL_LEASE_MS;
+}
+
+/* Credit the bucket for the time since the last refill. Record timestamps are
+ * taken before the lock, so two producers may arrive slightly out of order;
+ * a clock that steps back earns nothing and keeps the later refill point. */
+static void fl_tail_refill(uint32_t now_ms)
+{
+    int32_t elapsed = (int32_t)(now_ms - fl_tail.refill_ms);
+
+    if (elapsed > 0) {
+        uint32_t cap_mb = fl_tail.budget_bps * FL_TAIL_MILLI;
+        uint32_t ms = MIN((uint32_t)elapsed, FL_TAIL_MILLI);
+        uint32_t level = fl_tail.level_mb + (fl_tail.budget_bps * ms);
+
+        fl_tail.level_mb = MIN(level, cap_mb);
+        fl_tail.refill_ms = now_ms;
+    }
+}
+
+Status_t flash_log_tail_subscribe(uint64_t type_mask, uint16_t budget_bps,
+                                  uint32_t now_ms)
+{
+    Status_t rc = 0;
+    uint32_t budget = budget_bps;
+
+    if (0U == budget) {
+        budget = CONFIG_FLASH_LOG_TAIL_DEFAULT_BUDGET;
+    }
+
+    if ((0U == type_mask) || (0U != (type_mask & ~FL_TAIL_TYPES_ALLOWED))) {
+        rc = -EINVAL;
+    } else if ((budget < FL_TAIL_BUDGET_MIN) || (budget > FL_TAIL_BUDGET_MAX)) {
+        rc = -EINVAL;
+    } else {
+        bool fresh = (0 == atomic_get(&fl_tail_on));
+        k_spinlock_key_t key;
+
+        if (fresh) {
+            /* Nothing left over from a lapsed subscription. */
+            k_msgq_purge(&fl_tail_msgq);
+        }
+
+        key = k_spin_lock(&fl_tail_lock);
+        if (fresh) {
+            /* Fresh subscription: start with one second of burst. */
+            fl_tail.level_mb = budget * FL_TAIL_MILLI;
+            fl_tail.refill_ms = now_ms;
+            fl_tail.drop_pending = false;
+        } else {
+            fl_tail.level_mb = MIN(fl_tail.level_mb, budget * FL_TAIL_MILLI);
+        }
+        fl_tail.type_mask = type_mask;
+        fl_tail.budget_bps = budget;
+        fl_tail.lease_ms = now_ms;
+        (void)atomic_set(&fl_tail_on, 1);
+
+        k_spin_unlock(&fl_tail_lock, key);
+    }
+
+    return rc;
+}
+
+void flash_log_tail_unsubscribe(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&fl_tail_lock);
+
+    (void)atomic_set(&fl_tail_on, 0);
+    fl_tail.type_mask = 0U;
+
+    k_spin_unlock(&fl_tail_lock, key);
+
+    k_msgq_purge(&fl_tail_msgq);
+}
+
+void flash_log_tail_offer(uint8_t type, uint64_t ts_us, const void *payload,
+                          uint16_t length)
+{
+    if ((0 != atomic_get(&fl_tail_on)) && (type < FL_TAIL_TYPE_BITS) &&
+        (length <= FL_TAIL_MAX_PAYLOAD) &&
+        ((payload != NULL) || (0U == length))) {
+        uint32_t now_ms = (uint32_t)(ts_us / FL_TAIL_MILLI);
+        uint32_t cost_mb = (uint32_t)(sizeof(fl_entry_hdr_t) + length) * FL_TAIL_MILLI;
+        bool accept = false;
+        bool dropped_before = false;
+        k_spinlock_key_t key = k_spin_lock(&fl_tail_lock);
+
+        if ((0U == (fl_tail.type_mask & (1ULL << type))) ||
+            fl_tail_lease_lapsed(now_ms)) {
+            /* Not selected, or the lease ran out — drain() ends it. */
+        } else {
+            fl_tail_refill(now_ms);
+            if (fl_tail.level_mb >= cost_mb) {
+                fl_tail.level_mb -= cost_mb;
+                dropped_before = fl_tail.drop_pending;
+                fl_tail.drop_pending = false;
+                accept = true;
+            } else {
+                fl_tail.drop_pending = true;
+            }
+        }
+
+        k_spin_unlock(&fl_tail_lock, key);
+
+        if (accept) {
+            FlTailSlot_t slot = {
+                .hdr = {
+                    .type = type,
+                    .flags = dropped_before ? FL_ENTRY_FLAG_DROP_PRECEDED : 0U,
+                    .length = length,
+                    .ts_boot_us = ts_us,
+                },
+            };
+
+            if (length > 0U) {
+                (void)memcpy(slot.payload, payload, length);
+            }
+            if (0 != k_msgq_put(&fl_tail_msgq, &slot, K_NO_WAIT)) {
+                key = k_spin_lock(&fl_tail_lock);
+                fl_tail.drop_pending = true;
+                k_spin_unlock(&fl_tail_lock, key);
+            }
+        }
+    }
+}
+
+uint16_t flash_log_tail_drain(uint8_t *buf, uint16_t size, uint32_t now_ms)
+{
+    uint16_t used = 0U;
+
+    if ((buf != NULL) && (0 != atomic_get(&fl_tail_on))) {
+        k_spinlock_key_t key = k_spin_lock(&fl_tail_lock);
+        bool lapsed = fl_tail_lease_lapsed(now_ms);
+
+        k_spin_unlock(&fl_tail_lock, key);
+
+        if (lapsed) {
+            flash_log_tail_unsubscribe();
+        } else {
+            bool room = true;
+
+            while (room && (0 == k_msgq_peek(&fl_tail_msgq, &fl_tail_peek))) {
+                uint16_t rec_len = (uint16_t)(sizeof(fl_entry_hdr_t) +
+                                              fl_tail_peek.hdr.length);
+
+                if (((uint32_t)used + rec_len) > size) {
+                    room = false;
+                } else {
+                    (void)k_msgq_get(&fl_tail_msgq, &fl_tail_peek, K_NO_WAIT);
+                    (void)memcpy(&buf[used], &fl_tail_peek, rec_len);
+                    used += rec_len;
+                }
+            }
+        }
+    }
+
+    return used;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file flash_log_tail.h
+ * @brief Live tail — telemetry records pushed over CAN as they are logged.
+ *
+ * A client subscribes (RID_LIVE_TAIL, 0xF108) with a record-type mask and a
+ * byte budget. From then on every telemetry record of a selected type that
+ * the producers hand to the flash log (the zbus listeners in
+ * flash_log_listeners.c, plus the PID loop's direct snapshot) is also copied
+ * into a small queue, framed exactly like a DCLG body entry:
+ * [fl_entry_hdr_t | payload]. The UDS log-push poller drains that queue onto
+ * the broadcast push ISO-TP context as WDBI UDS_DID_LOG_TAIL (0xA101), packing
+ * as many whole records as fit into one push.
+ *
+ * The budget is a token bucket in bytes per second (header + payload, one
+ * second of burst). A record the bucket cannot cover — or one the queue has
+ * no room for — is dropped and the next record that does go out carries
+ * FL_ENTRY_FLAG_DROP_PRECEDED, so a plot can mark the gap.
+ *
+ * A subscription is a lease: it lapses FL_TAIL_LEASE_MS after the last
+ * RID_LIVE_TAIL, so a client that walks away does not leave the head
+ * broadcasting telemetry forever. Re-issue the routine to renew; an all-zero
+ * mask ends it at once.
+ *
+ * Only fixed-size records up to FL_TAIL_MAX_PAYLOAD bytes are offered. CAN
+ * frame capture is never tailed: the push itself is CAN traffic, and tailing
+ * it would feed back.
+ *
+ * flash_log_tail_offer() is ISR-safe and never blocks (producers call it under
+ * the zbus mutex); flash_log_tail_drain() runs on the DiveCAN RX thread.
+ */
+#ifndef FLASH_LOG_TAIL_H
+#define FLASH_LOG_TAIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common.h"
+#include "flash_log.h"
+#include "flash_log_entries.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FL_TAIL_MAX_PAYLOAD    32U     /**< Largest payload carried (power snapshot) */
+#define FL_TAIL_RECORD_MAX     (sizeof(fl_entry_hdr_t) + FL_TAIL_MAX_PAYLOAD)
+#define FL_TAIL_BUDGET_MIN     64U     /**< Bytes/s floor: two records a second */
+#define FL_TAIL_BUDGET_MAX     2048U   /**< Bytes/s ceiling: ~30% of the 125 kbit/s bus */
+#define FL_TAIL_LEASE_MS       30000U  /**< Subscription lifetime without renewal */
+
+/** @brief Record types a subscription may select (bit t = FlashLogType_t t). */
+#define FL_TAIL_TYPES_ALLOWED \
+    ((1ULL << FL_TYPE_DIVE_START) | (1ULL << FL_TYPE_DIVE_END) | \
+     (1ULL << FL_TYPE_CONSENSUS) | (1ULL << FL_TYPE_PID_SNAPSHOT) | \
+     (1ULL << FL_TYPE_SOLENOID_FIRE) | (1ULL << FL_TYPE_SOLENOID_CURRENT) | \
+     (1ULL << FL_TYPE_ATMOS_PRESSURE) | (1ULL << FL_TYPE_POWER_SNAPSHOT) | \
+     (1ULL << FL_TYPE_CELL_RAW_DIVEO2) | (1ULL << FL_TYPE_CELL_RAW_O2S) | \
+     (1ULL << FL_TYPE_CELL_RAW_ANALOG) | (1ULL << FL_TYPE_ERROR_EVENT))
+
+/**
+ * @brief Start, renew or change the live-tail subscription.
+ *
+ * A renewal keeps the queue and the bucket's current level; only the mask,
+ * budget and lease change.
+ *
+ * @param type_mask  Record types to tail; must be a non-empty subset of
+ *                   FL_TAIL_TYPES_ALLOWED
+ * @param budget_bps Byte budget per second; 0 selects
+ *                   CONFIG_FLASH_LOG_TAIL_DEFAULT_BUDGET
+ * @param now_ms     k_uptime_get_32() at the request
+ * @return 0, or -EINVAL for an empty or disallowed mask or a budget outside
+ *         [FL_TAIL_BUDGET_MIN, FL_TAIL_BUDGET_MAX]
+ */
+Status_t flash_log_tail_subscribe(uint64_t type_mask, uint16_t budget_bps,
+                                  uint32_t now_ms);
+
+/** @brief End the subscription and discard anything still queued. */
+void flash_log_tail_unsubscribe(void);
+
+/**
+ * @brief Offer one telemetry record to the tail.
+ *
+ * Called by the flash-log enqueue path for every telemetry record. Cheap
+ * when no subscription is live (one atomic read).
+ *
+ * @param type    FlashLogType_t of the record
+ * @param ts_us   Record timestamp (boot-relative µs), also the bucket clock
+ * @param payload Encoded payload, as written to flash
+ * @param length  Payload bytes
+ */
+void flash_log_tail_offer(uint8_t type, uint64_t ts_us, const void *payload,
+                          uint16_t length);
+
+/**
+ * @brief Move queued records, whole, into @p buf.
+ *
+ * Ends a subscription whose lease has lapsed (dropping its queue).
+ *
+ * @param buf    Destination for [fl_entry_hdr_t | payload] records
+ * @param size   Capacity of @p buf; at least FL_TAIL_RECORD_MAX
+ * @param now_ms k_uptime_get_32()
+ * @return Bytes written (0 when nothing is queued)
+ */
+uint16_t flash_log_tail_drain(uint8_t *buf, uint16_t size, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_LOG_TAIL_H */
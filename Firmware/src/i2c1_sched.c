@@ -0,0 +1,696 @@
+/**
+ * @file i2c1_sched.c
+ * @brief Queue, worker thread and statistics for STM32-initiated i2c1 transfers.
+ *
+ * See i2c1_sched.h for the policy. The worker still takes i2c1_bus_lock() /
+ * i2c1_bus_lock_quiet() around every hold so i2c1_bus_recover() and any
+ * remaining direct lock user stay serialised against it; with the scheduler
+ * enabled it is simply the only thread that ever waits on that mutex for a
+ * transfer.
+ *
+ * The translation unit is unconditional, like i2c_bus_lock.c: without
+ * CONFIG_I2C1_SCHEDULER it compiles to the inline path and the statistics.
+ */
+
+#include "i2c1_sched.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <errno.h>
+#include <string.h>
+
+#define SCHED_PERMILLE 1000U
+/* Weight of a new transfer in a client's typical occupancy (2^-n). */
+#define SCHED_TYPICAL_SHIFT 2U
+#define SCHED_CLIENT_U32_FIELDS 8U
+
+#ifdef CONFIG_I2C1_SCHEDULER
+/* Above every client (cells, tank, Poseidon run at 7) so a finished transfer
+ * is followed by the next pick without waiting for a client's time slice;
+ * below the consensus thread. */
+#define I2C1_SCHED_THREAD_PRIORITY 6
+
+BUILD_ASSERT(CONFIG_I2C1_SCHED_CELL_WINDOW_MS < CONFIG_I2C1_SCHED_CELL_SLOT_MS,
+             "the reserved cell window must leave room for other clients");
+#endif
+
+BUILD_ASSERT(I2C1_SCHED_STATS_BYTES <= UINT8_MAX,
+             "i2c1 statistics must fit one UDS response");
+
+/** @brief Running totals of one client, in kernel ticks. */
+typedef struct {
+    uint32_t txns;
+    uint32_t merged;
+    uint32_t retries;
+    uint32_t failed;
+    uint32_t expired;
+    uint32_t waited;          /* descriptors whose wait is in wait_ticks */
+    uint32_t busy_max_ticks;
+    uint32_t wait_max_ticks;
+    uint32_t typical_ticks;   /* running mean of one transfer, for the slot guard */
+    uint64_t busy_ticks;
+    uint64_t wait_ticks;
+} SchedClientAcc_t;
+
+/* ---- File-statics ----
+ *
+ * Updated from the scheduler (or, inline, every client) thread and read from
+ * the UDS thread, so the totals need one stable address behind one lock.
+ * M23_388 is accepted per-issue on SonarCloud for these declarations (see
+ * docs/SONARQUBE_ACCEPTED_ISSUES.md).
+ */
+static struct k_spinlock sched_lock;
+static SchedClientAcc_t sched_acc[I2C1_CLIENT_COUNT];
+
+#ifdef CONFIG_I2C1_SCHEDULER
+static sys_slist_t sched_queue = SYS_SLIST_STATIC_INIT(&sched_queue);
+static uint32_t sched_seq;
+static int64_t sched_cell_seen_ticks;
+static bool sched_cell_seen;
+/* Given on every submission; the worker sleeps on it when nothing is due. */
+K_SEM_DEFINE(sched_wake, 0, 1);
+#endif
+
+static uint32_t ticks_to_u32(int64_t ticks)
+{
+    uint32_t result = 0U;
+
+    if (ticks > (int64_t)UINT32_MAX) {
+        result = UINT32_MAX;
+    } else if (ticks > 0) {
+        result = (uint32_t)ticks;
+    } else {
+        /* A clock step back reads as zero. */
+    }
+    return result;
+}
+
+static uint32_t ticks_to_us(uint64_t ticks)
+{
+    uint64_t us = k_ticks_to_us_floor64(ticks);
+
+    return (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+}
+
+/* ---- Statistics ---- */
+
+static void acc_record_wait(I2c1Client_t client, int64_t wait)
+{
+    uint32_t w = ticks_to_u32(wait);
+    k_spinlock_key_t key = k_spin_lock(&sched_lock);
+    SchedClientAcc_t *a = &sched_acc[client];
+
+    ++a->waited;
+    a->wait_ticks += w;
+    a->wait_max_ticks = MAX(a->wait_max_ticks, w);
+    k_spin_unlock(&sched_lock, key);
+}
+
+static void acc_record_transfer(I2c1Client_t client, int64_t busy, bool merged)
+{
+    uint32_t b = ticks_to_u32(busy);
+    k_spinlock_key_t key = k_spin_lock(&sched_lock);
+    SchedClientAcc_t *a = &sched_acc[client];
+
+    a->busy_ticks += b;
+    a->busy_max_ticks = MAX(a->busy_max_ticks, b);
+    if (a->typical_ticks == 0U) {
+        a->typical_ticks = b;
+    } else {
+        a->typical_ticks = a->typical_ticks - (a->typical_ticks >> SCHED_TYPICAL_SHIFT) +
+                           (b >> SCHED_TYPICAL_SHIFT);
+    }
+    if (merged) {
+        ++a->merged;
+    }
+    k_spin_unlock(&sched_lock, key);
+}
+
+static void acc_record_retry(I2c1Client_t client)
+{
+    k_spinlock_key_t key = k_spin_lock(&sched_lock);
+
+    ++sched_acc[client].retries;
+    k_spin_unlock(&sched_lock, key);
+}
+
+static void acc_record_done(I2c1Client_t client, Status_t rc, bool expired)
+{
+    k_spinlock_key_t key = k_spin_lock(&sched_lock);
+    SchedClientAcc_t *a = &sched_acc[client];
+
+    ++a->txns;
+    if (rc != 0) {
+        ++a->failed;
+    }
+    if (expired) {
+        ++a->expired;
+    }
+    k_spin_unlock(&sched_lock, key);
+}
+
+void i2c1_sched_stats(I2c1Client_t client, I2c1ClientStats_t *out)
+{
+    if (out != NULL) {
+        (void)memset(out, 0, sizeof(*out));
+
+        if ((uint32_t)client < (uint32_t)I2C1_CLIENT_COUNT) {
+            SchedClientAcc_t copy;
+            k_spinlock_key_t key = k_spin_lock(&sched_lock);
+
+            copy = sched_acc[client];
+            k_spin_unlock(&sched_lock, key);
+
+            int64_t uptime = k_uptime_ticks();
+
+            out->txns = copy.txns;
+            out->merged = copy.merged;
+            out->retries = copy.retries;
+            out->failed = copy.failed;
+            out->expired = copy.expired;
+            if (uptime > 0) {
+                uint64_t permille = (copy.busy_ticks * SCHED_PERMILLE) /
+                                    (uint64_t)uptime;
+
+                out->occupancy_permille = (uint16_t)MIN(permille, SCHED_PERMILLE);
+            }
+            out->busy_max_us = ticks_to_us(copy.busy_max_ticks);
+            if (copy.waited > 0U) {
+                out->wait_mean_us = ticks_to_us(copy.wait_ticks / copy.waited);
+            }
+            out->wait_max_us = ticks_to_us(copy.wait_max_ticks);
+        }
+    }
+}
+
+/** @brief Little-endian u32 store (the DID payload byte order). */
+static void put_u32(uint8_t *buf, uint32_t v)
+{
+    buf[0] = (uint8_t)(v & 0xFFU);
+    buf[1] = (uint8_t)((v >> 8) & 0xFFU);
+    buf[2] = (uint8_t)((v >> 16) & 0xFFU);
+    buf[3] = (uint8_t)((v >> 24) & 0xFFU);
+}
+
+size_t i2c1_sched_serialise(uint8_t *buf, size_t size)
+{
+    size_t written = 0U;
+
+    if ((buf != NULL) && (size >= I2C1_SCHED_STATS_BYTES)) {
+        size_t pos = 2U;
+
+        buf[0] = I2C1_SCHED_STATS_VERSION;
+        buf[1] = (uint8_t)I2C1_CLIENT_COUNT;
+
+        for (uint32_t c = 0U; c < (uint32_t)I2C1_CLIENT_COUNT; ++c) {
+            I2c1ClientStats_t st;
+
+            i2c1_sched_stats((I2c1Client_t)c, &st);
+            put_u32(&buf[pos], st.txns);
+            put_u32(&buf[pos + 4U], st.merged);
+            put_u32(&buf[pos + 8U], st.retries);
+            put_u32(&buf[pos + 12U], st.failed);
+            put_u32(&buf[pos + 16U], st.expired);
+            buf[pos + 20U] = (uint8_t)(st.occupancy_permille & 0xFFU);
+            buf[pos + 21U] = (uint8_t)(st.occupancy_permille >> 8);
+            put_u32(&buf[pos + 22U], st.busy_max_us);
+            put_u32(&buf[pos + 26U], st.wait_mean_us);
+            put_u32(&buf[pos + 30U], st.wait_max_us);
+            pos += I2C1_SCHED_CLIENT_BYTES;
+        }
+
+        written = I2C1_SCHED_STATS_BYTES;
+    }
+
+    return written;
+}
+
+/* ---- Transfers (both modes) ---- */
+
+static bool sched_txn_valid(const I2c1Txn_t *txn)
+{
+    return (txn->xfer != NULL) && (txn->attempts != 0U) &&
+           ((uint32_t)txn->client < (uint32_t)I2C1_CLIENT_COUNT);
+}
+
+/** @brief Account for one more try of @p txn. */
+static void sched_count_try(I2c1Txn_t *txn)
+{
+    if (txn->tries > 0U) {
+        acc_record_retry(txn->client);
+    }
+    ++txn->tries;
+}
+
+/**
+ * @brief Run one try of @p txn. Caller holds the bus mutex.
+ *
+ * @param merged True when it follows a transfer to the same device under the
+ *               same hold, without a quiet-bus guard of its own.
+ */
+static Status_t sched_transfer(I2c1Txn_t *txn, bool merged)
+{
+    int64_t start = k_uptime_ticks();
+
+    if (!txn->started) {
+        txn->started = true;
+        acc_record_wait(txn->client, (int32_t)((uint32_t)start - txn->queued_ticks));
+    }
+    sched_count_try(txn);
+
+    Status_t rc = txn->xfer(txn->ctx);
+
+    acc_record_transfer(txn->client, k_uptime_ticks() - start, merged);
+    return rc;
+}
+
+/** @brief Backoff before the next try, after txn->tries tries. */
+static uint32_t sched_backoff_ms(const I2c1Txn_t *txn)
+{
+    uint32_t delay = (uint32_t)txn->backoff_base_ms << (txn->tries - 1U);
+
+    if (txn->backoff_jitter_ms != 0U) {
+        delay += k_cycle_get_32() % txn->backoff_jitter_ms;
+    }
+    return delay;
+}
+
+static void sched_reset(I2c1Txn_t *txn, int64_t now)
+{
+    txn->result = -EINPROGRESS;
+    txn->queued_ticks = (uint32_t)now;
+    txn->not_before_ticks = (uint32_t)now;
+    txn->deadline_ticks = (uint32_t)now + k_ms_to_ticks_ceil32(txn->deadline_ms);
+    txn->tries = 0U;
+    txn->recovered = false;
+    txn->started = false;
+}
+
+static Status_t sched_first_error(const I2c1Txn_t *txns, size_t count)
+{
+    Status_t ret = 0;
+
+    for (size_t i = 0U; i < count; ++i) {
+        if ((ret == 0) && (txns[i].result != 0)) {
+            ret = txns[i].result;
+        }
+    }
+    return ret;
+}
+
+#ifdef CONFIG_I2C1_SCHEDULER
+
+/* ---- Scheduler thread ---- */
+
+static int64_t sched_slot_ticks(void)
+{
+    return (int64_t)k_ms_to_ticks_ceil64(CONFIG_I2C1_SCHED_CELL_SLOT_MS);
+}
+
+static void wake_at(int64_t *wake, int64_t at)
+{
+    *wake = MIN(*wake, at);
+}
+
+/** @brief Absolute 64-bit tick of a 32-bit descriptor stamp near @p now. */
+static int64_t stamp_abs(int64_t now, uint32_t stamp)
+{
+    return now + (int32_t)(stamp - (uint32_t)now);
+}
+
+static bool txn_expired(const I2c1Txn_t *txn, int64_t now)
+{
+    return (txn->deadline_ms != 0U) &&
+           ((int32_t)((uint32_t)now - txn->deadline_ticks) > 0);
+}
+
+/** @brief Queue a descriptor that has not been seen before. */
+static void sched_enqueue(I2c1Txn_t *txn)
+{
+    int64_t now = k_uptime_ticks();
+    k_spinlock_key_t key;
+
+    sched_reset(txn, now);
+    key = k_spin_lock(&sched_lock);
+    txn->seq = sched_seq;
+    ++sched_seq;
+    if (txn->client == I2C1_CLIENT_CELL) {
+        sched_cell_seen_ticks = now;
+        sched_cell_seen = true;
+    }
+    sys_slist_append(&sched_queue, &txn->node);
+    k_spin_unlock(&sched_lock, key);
+
+    k_sem_give(&sched_wake);
+}
+
+/** @brief Put a descriptor back behind its backoff. Worker thread only. */
+static void sched_requeue(I2c1Txn_t *txn, uint32_t delay_ms)
+{
+    k_spinlock_key_t key;
+
+    txn->not_before_ticks = (uint32_t)k_uptime_ticks() + k_ms_to_ticks_ceil32(delay_ms);
+    key = k_spin_lock(&sched_lock);
+    sys_slist_append(&sched_queue, &txn->node);
+    k_spin_unlock(&sched_lock, key);
+}
+
+/**
+ * @brief Finish a descriptor: record it, then queue the next batch member or
+ *        release the submitter. @p txn must not be touched afterwards.
+ */
+static void sched_complete(I2c1Txn_t *txn, Status_t rc, bool expired)
+{
+    I2c1Txn_t *next = txn->next;
+    struct k_sem *done = txn->done;
+
+    txn->result = rc;
+    acc_record_done(txn->client, rc, expired);
+    if (next != NULL) {
+        sched_enqueue(next);
+    } else {
+        k_sem_give(done);
+    }
+}
+
+/**
+ * @brief Decide what happens to @p txn after a try that returned @p rc.
+ *
+ * Same policy as i2c1_transact(): hard errors and success complete; a
+ * retryable error is retried after its backoff, then gets one recovery and a
+ * final try. The difference is that the backoff is spent on the queue, not
+ * asleep on the bus.
+ */
+static void sched_settle(I2c1Txn_t *txn, Status_t rc)
+{
+    if ((rc == 0) || (!i2c1_error_is_retryable(rc))) {
+        sched_complete(txn, rc, false);
+    } else if (txn->tries < txn->attempts) {
+        sched_requeue(txn, sched_backoff_ms(txn));
+    } else if (!txn->recovered) {
+        txn->recovered = true;
+        if (i2c1_bus_recover() == 0) {
+            sched_requeue(txn, 0U);
+        } else {
+            sched_complete(txn, rc, false);
+        }
+    } else {
+        sched_complete(txn, rc, false);
+    }
+}
+
+/** @brief True when @p a should run before @p b (NULL loses to anything). */
+static bool sched_better(const I2c1Txn_t *a, const I2c1Txn_t *b)
+{
+    bool better = false;
+
+    if (b == NULL) {
+        better = true;
+    } else if (a->priority != b->priority) {
+        better = a->priority < b->priority;
+    } else if ((a->deadline_ms != 0U) != (b->deadline_ms != 0U)) {
+        better = a->deadline_ms != 0U;
+    } else if ((a->deadline_ms != 0U) && (a->deadline_ticks != b->deadline_ticks)) {
+        better = (int32_t)(a->deadline_ticks - b->deadline_ticks) < 0;
+    } else {
+        better = (int32_t)(a->seq - b->seq) < 0;
+    }
+    return better;
+}
+
+/**
+ * @brief Reserved cell window: may @p txn start now? Caller holds sched_lock.
+ *
+ * Only enforced while cells have submitted within the last two slots. Inside
+ * the window only cell reads start; outside it, another client starts only
+ * if its typical transfer ends before the next window. A client that can
+ * never fit between two windows is let through right after one, rather than
+ * starved.
+ */
+static bool sched_slot_allows(const I2c1Txn_t *txn, int64_t now, int64_t *wake)
+{
+    bool allow = true;
+    int64_t slot = sched_slot_ticks();
+
+    if ((txn->client != I2C1_CLIENT_CELL) && sched_cell_seen &&
+        ((now - sched_cell_seen_ticks) < (2 * slot))) {
+        int64_t window = (int64_t)k_ms_to_ticks_ceil64(CONFIG_I2C1_SCHED_CELL_WINDOW_MS);
+        int64_t slot_start = now - (now % slot);
+        int64_t typical = (int64_t)sched_acc[txn->client].typical_ticks;
+
+        if ((now - slot_start) < window) {
+            allow = false;
+            wake_at(wake, slot_start + window);
+        } else if ((typical <= (slot - window)) && ((now + typical) > (slot_start + slot))) {
+            allow = false;
+            wake_at(wake, slot_start + slot + window);
+        } else {
+            /* Fits before the next window. */
+        }
+    }
+    return allow;
+}
+
+/**
+ * @brief Take the best runnable descriptor off the queue.
+ *
+ * Descriptors past their deadline move to @p expired. @p wake is lowered to
+ * the earliest moment something blocked may become runnable or expire.
+ */
+static I2c1Txn_t *sched_pick(int64_t now, int64_t *wake, sys_slist_t *expired)
+{
+    I2c1Txn_t *best = NULL;
+    I2c1Txn_t *it = NULL;
+    I2c1Txn_t *tmp = NULL;
+    k_spinlock_key_t key = k_spin_lock(&sched_lock);
+
+    SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&sched_queue, it, tmp, node) {
+        if (txn_expired(it, now)) {
+            (void)sys_slist_find_and_remove(&sched_queue, &it->node);
+            sys_slist_append(expired, &it->node);
+        } else if ((int32_t)(it->not_before_ticks - (uint32_t)now) > 0) {
+            wake_at(wake, stamp_abs(now, it->not_before_ticks));
+        } else if (!sched_slot_allows(it, now, wake)) {
+            /* Waits for the cell window to pass. */
+        } else if (sched_better(it, best)) {
+            best = it;
+        } else {
+            /* A better descriptor is already chosen. */
+        }
+
+        if ((it->deadline_ms != 0U) && (it != best)) {
+            wake_at(wake, stamp_abs(now, it->deadline_ticks) + 1);
+        }
+    }
+    if (best != NULL) {
+        (void)sys_slist_find_and_remove(&sched_queue, &best->node);
+    }
+    k_spin_unlock(&sched_lock, key);
+
+    return best;
+}
+
+static void sched_release(void)
+{
+    i2c1_bus_note_activity();
+    i2c1_bus_unlock();
+}
+
+/**
+ * @brief Scheduler thread: pick, hold the bus, transfer, settle.
+ *
+ * The bus is held across consecutive transfers to one device and released as
+ * soon as the next pick is for another device, a try fails, or nothing is
+ * runnable.
+ */
+static void i2c1_sched_thread(void *p1, void *p2, void *p3)
+{
+    bool held = false;
+    uint16_t held_device = I2C1_DEVICE_NONE;
+    uint8_t run = 0U;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (true) {
+        sys_slist_t expired;
+        sys_snode_t *n = NULL;
+        int64_t wake = INT64_MAX;
+
+        sys_slist_init(&expired);
+        I2c1Txn_t *txn = sched_pick(k_uptime_ticks(), &wake, &expired);
+
+        n = sys_slist_get(&expired);
+        while (n != NULL) {
+            sched_complete(CONTAINER_OF(n, I2c1Txn_t, node), -ETIMEDOUT, true);
+            n = sys_slist_get(&expired);
+        }
+
+        bool merge = held && (txn != NULL) && (txn->device != I2C1_DEVICE_NONE) &&
+                     (txn->device == held_device) &&
+                     (run < (uint8_t)CONFIG_I2C1_SCHED_MERGE_MAX);
+
+        if (held && (!merge)) {
+            sched_release();
+            held = false;
+        }
+
+        if (txn == NULL) {
+            k_timeout_t timeout = K_FOREVER;
+
+            if (wake != INT64_MAX) {
+                timeout = K_TIMEOUT_ABS_TICKS(wake);
+            }
+            (void)k_sem_take(&sched_wake, timeout);
+        } else {
+            Status_t rc = 0;
+
+            if (!merge) {
+                rc = i2c1_bus_lock_quiet();
+                held = (rc == 0);
+                run = 0U;
+            }
+            if (rc == 0) {
+                rc = sched_transfer(txn, merge);
+                held_device = txn->device;
+                ++run;
+            } else {
+                /* No quiet window: counts as a failed try, as in i2c1_transact(). */
+                sched_count_try(txn);
+            }
+            if ((rc != 0) && held) {
+                sched_release();
+                held = false;
+            }
+            sched_settle(txn, rc);
+        }
+    }
+}
+
+K_THREAD_DEFINE(i2c1_sched, CONFIG_I2C1_SCHED_STACK_SIZE,
+        i2c1_sched_thread, NULL, NULL, NULL,
+        I2C1_SCHED_THREAD_PRIORITY, 0, 0);
+
+static Status_t sched_execute(I2c1Txn_t *txns, size_t count)
+{
+    Status_t ret = 0;
+
+    if (k_current_get() == i2c1_sched) {
+        ret = -EDEADLK;
+    } else {
+        struct k_sem done;
+
+        (void)k_sem_init(&done, 0, 1);
+        for (size_t i = 0U; i < count; ++i) {
+            txns[i].done = &done;
+            txns[i].next = ((i + 1U) < count) ? &txns[i + 1U] : NULL;
+        }
+        sched_enqueue(&txns[0]);
+        (void)k_sem_take(&done, K_FOREVER);
+        ret = sched_first_error(txns, count);
+    }
+    return ret;
+}
+
+k_timeout_t i2c1_sched_next_cell_slot(void)
+{
+    int64_t slot = sched_slot_ticks();
+    int64_t now = k_uptime_ticks();
+
+    return K_TIMEOUT_ABS_TICKS(now - (now % slot) + slot);
+}
+
+#else /* !CONFIG_I2C1_SCHEDULER */
+
+/* ---- Inline path ---- */
+
+/* i2c1_transact adapter: one try of the descriptor in ctx. */
+static Status_t sched_inline_xfer(void *ctx)
+{
+    return sched_transfer((I2c1Txn_t *)ctx, false);
+}
+
+/**
+ * @brief Try one batch member under the caller's hold: retries with backoff
+ *        inside the hold, then recover (recursive lock) and a final try.
+ */
+static Status_t sched_inline_locked(I2c1Txn_t *txn, bool merged)
+{
+    Status_t rc = -EBUSY;
+
+    while ((txn->tries < txn->attempts) && i2c1_error_is_retryable(rc)) {
+        if (txn->tries > 0U) {
+            (void)k_msleep((int32_t)sched_backoff_ms(txn));
+        }
+        rc = sched_transfer(txn, merged);
+    }
+    if (i2c1_error_is_retryable(rc) && (i2c1_bus_recover() == 0)) {
+        rc = sched_transfer(txn, merged);
+    }
+    return rc;
+}
+
+static Status_t sched_execute(I2c1Txn_t *txns, size_t count)
+{
+    int64_t now = k_uptime_ticks();
+
+    for (size_t i = 0U; i < count; ++i) {
+        sched_reset(&txns[i], now);
+    }
+
+    if (count == 1U) {
+        txns[0].result = i2c1_transact(sched_inline_xfer, &txns[0], txns[0].attempts,
+                                       txns[0].backoff_base_ms,
+                                       txns[0].backoff_jitter_ms);
+        acc_record_done(txns[0].client, txns[0].result, false);
+    } else {
+        /* Reserve the controller for the whole group so its frames stay
+         * adjacent. This only blocks our own masters; external ones still
+         * arbitrate in hardware. */
+        i2c1_bus_lock();
+        for (size_t i = 0U; i < count; ++i) {
+            bool merged = (i > 0U) && (txns[i].device != I2C1_DEVICE_NONE) &&
+                          (txns[i].device == txns[i - 1U].device);
+
+            txns[i].result = sched_inline_locked(&txns[i], merged);
+            acc_record_done(txns[i].client, txns[i].result, false);
+        }
+        i2c1_bus_note_activity();
+        i2c1_bus_unlock();
+    }
+
+    return sched_first_error(txns, count);
+}
+
+k_timeout_t i2c1_sched_next_cell_slot(void)
+{
+    return K_NO_WAIT;
+}
+
+#endif /* CONFIG_I2C1_SCHEDULER */
+
+Status_t i2c1_sched_run_batch(I2c1Txn_t *txns, size_t count)
+{
+    Status_t ret = 0;
+
+    if ((txns == NULL) || (count == 0U)) {
+        ret = -EINVAL;
+    } else {
+        for (size_t i = 0U; i < count; ++i) {
+            if ((ret == 0) && (!sched_txn_valid(&txns[i]))) {
+                ret = -EINVAL;
+            }
+        }
+        if (ret == 0) {
+            ret = sched_execute(txns, count);
+        }
+    }
+    return ret;
+}
+
+Status_t i2c1_sched_run(I2c1Txn_t *txn)
+{
+    return i2c1_sched_run_batch(txn, 1U);
+}
@@ -0,0 +1,312 @@
+/**
+ * @file latency_trace.c
+ * @brief Per-stage latency histograms for the sample → fire chain.
+ *
+ * Producers are the consensus, PID and solenoid fire threads; readers are the
+ * UDS handler and the periodic flash-log work item. A spinlock covers each
+ * record and each summary — the critical section is a handful of integer
+ * operations, so the control threads never wait on a reader for long.
+ *
+ * Bucket counts are uint16 to keep the four histograms at 240 B. When a
+ * bucket would saturate, every bucket of that stage is halved: the shape of
+ * the distribution is kept and older samples gradually lose weight. The
+ * count, min and max stay exact until the next clear.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <string.h>
+
+#include "latency_trace.h"
+#ifdef CONFIG_FLASH_LOG
+#include "flash_log.h"
+#endif
+
+/** @brief Bucket 0 holds latencies below 2^LT_FIRST_OCTAVE µs (128 µs). */
+#define LT_FIRST_OCTAVE   7U
+/** @brief Histogram buckets per octave above bucket 0. */
+#define LT_OCTAVE_SPLIT   2U
+#define LT_PERCENT        100U
+#define LT_P50            50U
+#define LT_P99            99U
+#define LT_STAGE_FIELDS   5U
+
+BUILD_ASSERT(LATENCY_BUCKET_COUNT <= (1U + (LT_OCTAVE_SPLIT * (31U - LT_FIRST_OCTAVE))),
+             "latency buckets must stay inside a u32 µs range");
+BUILD_ASSERT(LATENCY_SUMMARY_BYTES <= UINT8_MAX,
+             "latency summary must fit one UDS response / flash-log slot");
+
+typedef struct {
+    uint16_t buckets[LATENCY_BUCKET_COUNT];
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+} LatencyHistogram_t;
+
+/* ---- File-statics ----
+ *
+ * Written from three control threads and read from the UDS thread, so the
+ * histograms need a stable address behind one lock rather than per-thread
+ * accessors. M23_388 is accepted per-issue on SonarCloud for these
+ * declarations (see docs/SONARQUBE_ACCEPTED_ISSUES.md).
+ */
+static struct k_spinlock lt_lock;
+static LatencyHistogram_t lt_hist[LATENCY_STAGE_COUNT];
+static atomic_t lt_seq;
+/* Non-zero once a sample has been recorded since the last flash-log summary. */
+static atomic_t lt_dirty;
+
+uint8_t latency_trace_bucket(uint32_t us)
+{
+    uint8_t bucket = 0U;
+
+    if (us >= BIT(LT_FIRST_OCTAVE)) {
+        uint32_t msb = 31U - (uint32_t)__builtin_clz(us);
+        uint32_t half = (us >> (msb - 1U)) & 1U;
+        uint32_t idx = 1U + (LT_OCTAVE_SPLIT * (msb - LT_FIRST_OCTAVE)) + half;
+
+        bucket = (uint8_t)MIN(idx, LATENCY_BUCKET_COUNT - 1U);
+    }
+
+    return bucket;
+}
+
+uint32_t latency_trace_bucket_upper_us(uint8_t bucket)
+{
+    uint32_t upper = UINT32_MAX;
+
+    if (0U == bucket) {
+        upper = BIT(LT_FIRST_OCTAVE);
+    } else if (bucket < (LATENCY_BUCKET_COUNT - 1U)) {
+        uint32_t octave = ((uint32_t)bucket - 1U) / LT_OCTAVE_SPLIT;
+        uint32_t half = ((uint32_t)bucket - 1U) % LT_OCTAVE_SPLIT;
+        uint32_t step = BIT(LT_FIRST_OCTAVE + octave - 1U);
+
+        upper = ((2U + half) * step) + step;
+    } else {
+        /* No action required — the last bucket is open-ended */
+    }
+
+    return upper;
+}
+
+uint32_t latency_trace_next_seq(void)
+{
+    uint32_t seq = (uint32_t)atomic_inc(&lt_seq) + 1U;
+
+    if (0U == seq) {
+        /* Wrapped onto the "untraced" marker — take the next one */
+        seq = (uint32_t)atomic_inc(&lt_seq) + 1U;
+    }
+
+    return seq;
+}
+
+uint32_t latency_trace_ticks_to_us(int64_t ticks)
+{
+    uint32_t us = 0U;
+
+    if (ticks > 0) {
+        us = (uint32_t)MIN(k_ticks_to_us_floor64((uint64_t)ticks),
+                           (uint64_t)UINT32_MAX);
+    }
+
+    return us;
+}
+
+void latency_trace_record(LatencyStage_t stage, uint32_t us)
+{
+    if ((uint32_t)stage < (uint32_t)LATENCY_STAGE_COUNT) {
+        uint8_t bucket = latency_trace_bucket(us);
+        k_spinlock_key_t key = k_spin_lock(&lt_lock);
+        LatencyHistogram_t *h = &lt_hist[stage];
+
+        if (UINT16_MAX == h->buckets[bucket]) {
+            for (uint8_t i = 0U; i < LATENCY_BUCKET_COUNT; ++i) {
+                h->buckets[i] /= 2U;
+            }
+        }
+        h->buckets[bucket]++;
+
+        if ((0U == h->count) || (us < h->min_us)) {
+            h->min_us = us;
+        }
+        if (us > h->max_us) {
+            h->max_us = us;
+        }
+        if (h->count < UINT32_MAX) {
+            h->count++;
+        }
+
+        k_spin_unlock(&lt_lock, key);
+        (void)atomic_set(&lt_dirty, 1);
+    }
+}
+
+uint32_t latency_trace_record_span(LatencyStage_t stage, int64_t from_ticks,
+                                   int64_t to_ticks)
+{
+    uint32_t us = 0U;
+
+    if (from_ticks > 0) {
+        us = latency_trace_ticks_to_us(to_ticks - from_ticks);
+        latency_trace_record(stage, us);
+    }
+
+    return us;
+}
+
+/**
+ * @brief Latency at a percentile, read from a histogram copy.
+ *
+ * Reports the upper edge of the bucket holding the rank, clamped to the
+ * exact [min, max] so a single-bucket histogram reads back its true bounds.
+ */
+static uint32_t histogram_percentile(const LatencyHistogram_t *h, uint32_t pct)
+{
+    uint32_t total = 0U;
+    uint32_t result = 0U;
+
+    for (uint8_t i = 0U; i < LATENCY_BUCKET_COUNT; ++i) {
+        total += h->buckets[i];
+    }
+
+    if (total > 0U) {
+        uint32_t rank = (uint32_t)((((uint64_t)total * pct) + (LT_PERCENT - 1U)) /
+                                   LT_PERCENT);
+        uint32_t seen = 0U;
+        uint8_t bucket = 0U;
+
+        rank = MAX(rank, 1U);
+        for (uint8_t i = 0U; i < LATENCY_BUCKET_COUNT; ++i) {
+            if (seen < rank) {
+                seen += h->buckets[i];
+                bucket = i;
+            }
+        }
+
+        result = CLAMP(latency_trace_bucket_upper_us(bucket), h->min_us,
+                       h->max_us);
+    }
+
+    return result;
+}
+
+void latency_trace_stats(LatencyStage_t stage, LatencyStats_t *out)
+{
+    if (out != NULL) {
+        (void)memset(out, 0, sizeof(*out));
+
+        if ((uint32_t)stage < (uint32_t)LATENCY_STAGE_COUNT) {
+            LatencyHistogram_t copy;
+            k_spinlock_key_t key = k_spin_lock(&lt_lock);
+
+            copy = lt_hist[stage];
+            k_spin_unlock(&lt_lock, key);
+
+            if (copy.count > 0U) {
+                out->count = copy.count;
+                out->min_us = copy.min_us;
+                out->p50_us = histogram_percentile(&copy, LT_P50);
+                out->p99_us = histogram_percentile(&copy, LT_P99);
+                out->max_us = copy.max_us;
+            }
+        }
+    }
+}
+
+/** @brief Little-endian u32 store (the DID and flash payload byte order). */
+static void put_u32(uint8_t *buf, uint32_t v)
+{
+    buf[0] = (uint8_t)(v & 0xFFU);
+    buf[1] = (uint8_t)((v >> 8) & 0xFFU);
+    buf[2] = (uint8_t)((v >> 16) & 0xFFU);
+    buf[3] = (uint8_t)((v >> 24) & 0xFFU);
+}
+
+size_t latency_trace_serialise(uint8_t *buf, size_t size)
+{
+    size_t written = 0U;
+
+    if ((buf != NULL) && (size >= LATENCY_SUMMARY_BYTES)) {
+        size_t pos = 2U;
+
+        buf[0] = LATENCY_SUMMARY_VERSION;
+        buf[1] = (uint8_t)LATENCY_STAGE_COUNT;
+
+        for (uint32_t s = 0U; s < (uint32_t)LATENCY_STAGE_COUNT; ++s) {
+            LatencyStats_t st;
+
+            latency_trace_stats((LatencyStage_t)s, &st);
+            put_u32(&buf[pos], st.count);
+            put_u32(&buf[pos + 4U], st.min_us);
+            put_u32(&buf[pos + 8U], st.p50_us);
+            put_u32(&buf[pos + 12U], st.p99_us);
+            put_u32(&buf[pos + 16U], st.max_us);
+            pos += LT_STAGE_FIELDS * sizeof(uint32_t);
+        }
+
+        written = LATENCY_SUMMARY_BYTES;
+    }
+
+    return written;
+}
+
+void latency_trace_clear(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lt_lock);
+
+    (void)memset(lt_hist, 0, sizeof(lt_hist));
+    k_spin_unlock(&lt_lock, key);
+    (void)atomic_set(&lt_dirty, 0);
+}
+
+#if defined(CONFIG_FLASH_LOG) && (CONFIG_LATENCY_TRACE_LOG_INTERVAL_S > 0)
+
+/**
+ * @brief Write the current summary to the flash log.
+ *
+ * Skipped when nothing was recorded since the last one, so a head that is
+ * not controlling (PPO2 mode OFF, no cells) does not fill the log with
+ * identical summaries.
+ */
+static void summary_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    if (0 != atomic_set(&lt_dirty, 0)) {
+        uint8_t buf[LATENCY_SUMMARY_BYTES] = {0};
+        size_t len = latency_trace_serialise(buf, sizeof(buf));
+
+        flash_log_enqueue_latency_summary(buf, (uint16_t)len);
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(summary_work, summary_work_handler);
+
+static void summary_timer_expiry(struct k_timer *t)
+{
+    ARG_UNUSED(t);
+    /* Timer (ISR) context: the enqueue happens on the system workqueue. A
+     * failed schedule only skips one summary; lt_dirty stays set. */
+    (void)k_work_schedule(&summary_work, K_NO_WAIT);
+}
+
+static K_TIMER_DEFINE(summary_timer, summary_timer_expiry, NULL);
+
+void latency_trace_init(void)
+{
+    k_timer_start(&summary_timer, K_SECONDS(CONFIG_LATENCY_TRACE_LOG_INTERVAL_S),
+                  K_SECONDS(CONFIG_LATENCY_TRACE_LOG_INTERVAL_S));
+}
+
+#else
+
+void latency_trace_init(void)
+{
+    /* No action required — no periodic summary on this build */
+}
+
+#endif /* CONFIG_FLASH_LOG && CONFIG_LATENCY_TRACE_LOG_INTERVAL_S > 0 */
@@ -29,6 +29,7 @@
 #include "ppo2_control.h"
 #include "runtime_settings.h"
 #include "error_histogram.h"
+#include "latency_trace.h"
 #include "errors.h"
 #include "boot_history.h"
 #include "common.h"
@@ -202,6 +203,8 @@ static void boot_led_toggle(void)
 #define COMPILE_PPO2_DEFAULT_STR "PID"
 #elif defined(CONFIG_PPO2_CONTROL_DEFAULT_MK15)
 #define COMPILE_PPO2_DEFAULT_STR "MK15"
+#elif defined(CONFIG_PPO2_CONTROL_DEFAULT_MPC)
+#define COMPILE_PPO2_DEFAULT_STR "MPC"
 #else
 #define COMPILE_PPO2_DEFAULT_STR "OFF"
 #endif
@@ -229,6 +232,8 @@ static const char *ppo2_mode_name(PPO2ControlMode_t m)
         s = "PID";
     } else if (PPO2CONTROL_MK15 == m) {
         s = "MK15";
+    } else if (PPO2CONTROL_MPC == m) {
+        s = "MPC";
     } else {
         /* No action required */
     }
@@ -680,6 +685,10 @@ Status_t main(void)
      * persisted error histogram and start its periodic save timer. */
     error_histogram_init();
 
+    /* Periodic latency-trace summary into the flash log (no-op when the
+     * interval is 0 or the flash log is compiled out). */
+    latency_trace_init();
+
     /* If MCUBoot left a freshly-swapped image in test mode, the POST
      * thread wakes up here and walks every subsystem (cells, consensus,
      * CAN TX, handset RX, solenoid). It calls boot_write_img_confirmed()
@@ -98,6 +98,17 @@ void maint_arena_release(MaintArenaOwner_t owner)
     (void)k_mutex_unlock(&arena_lock);
 }
 
+void maint_arena_mark_scratch(MaintArenaOwner_t owner)
+{
+    (void)k_mutex_lock(&arena_lock, K_FOREVER);
+    if ((MAINT_ARENA_FREE != owner) && (owner == arena_state.owner) &&
+        (owner != arena_state.content_owner)) {
+        ++arena_state.generation;
+        arena_state.content_owner = owner;
+    }
+    (void)k_mutex_unlock(&arena_lock);
+}
+
 void maint_arena_set_index_building(bool building)
 {
     (void)k_mutex_lock(&arena_lock, K_FOREVER);
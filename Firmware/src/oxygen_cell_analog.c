@@ -6,6 +6,17 @@
  * using a stored calibration coefficient, and publishes OxygenCellMsg_t to
  * the per-cell zbus channel. One Zephyr thread is spawned per cell that is
  * configured as analog via Kconfig (CONFIG_CELL_n_TYPE_ANALOG).
+ *
+ * Every ADC sample passes through the cell's fixed-point filter stage
+ * (oxygen_cell_math.c, CONFIG_CELL_n_ANALOG_FILTER) and a reading is
+ * published once per filter output, so the filter also decimates the ADC
+ * rate down to the publish rate.
+ *
+ * With CONFIG_ADC_ADS1X1X_LOCAL_SCAN the thread does not read the ADC itself:
+ * the ADS1115 driver free-runs the chip through its channels and the thread
+ * feeds each burst it drains from its channel's ring through the filter.
+ * Otherwise, with CONFIG_I2C1_SCHEDULER, each read is a cell transaction on
+ * the i2c1 scheduler and the thread samples once per reserved cell slot.
  */
 
 #include <zephyr/kernel.h>
@@ -21,7 +32,12 @@
 #include "errors.h"
 #include "common.h"
 #include "heartbeat.h"
+#include "latency_trace.h"
 #include "runtime_settings.h"
+#include "i2c1_sched.h"
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+#include "ads1x1x_scan.h"
+#endif
 
 LOG_MODULE_REGISTER(cell_analog, LOG_LEVEL_INF);
 
@@ -39,6 +55,29 @@ LOG_MODULE_REGISTER(cell_analog, LOG_LEVEL_INF);
  * edge the solenoid-fire thread already hit. 1024 B restores margin. */
 #define ANALOG_CELL_STACK_SIZE 1024
 
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+/* Scan samples drained per publish: at most a full ring. */
+#define ANALOG_SCAN_BATCH_MAX CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH
+#endif
+
+/* Build-time filter choice for cell n (CONFIG_CELL_n_ANALOG_FILTER). */
+#define ANALOG_FILTER_KIND(n) \
+    (IS_ENABLED(CONFIG_CELL_##n##_ANALOG_FILTER_MEAN) ? ANALOG_FILTER_MEAN : \
+     IS_ENABLED(CONFIG_CELL_##n##_ANALOG_FILTER_MEDIAN) ? ANALOG_FILTER_MEDIAN : \
+     IS_ENABLED(CONFIG_CELL_##n##_ANALOG_FILTER_IIR) ? ANALOG_FILTER_IIR : \
+     ANALOG_FILTER_NONE)
+#define ANALOG_FILTER_CFG(n) {                          \
+    .kind = ANALOG_FILTER_KIND(n),                      \
+    .taps = CONFIG_ANALOG_FILTER_TAPS,                  \
+    .iir_shift = CONFIG_ANALOG_FILTER_IIR_SHIFT,        \
+}
+
+BUILD_ASSERT(CONFIG_ANALOG_FILTER_TAPS <= ANALOG_FILTER_MAX_TAPS,
+         "ANALOG_FILTER_TAPS exceeds the filter window");
+
+/* Weight of a new interval in the running sample-period mean (2^-n). */
+static const uint8_t SAMPLE_PERIOD_EMA_SHIFT = 3U;
+
 /* Timeout for the zbus_pub_checked() calls in this file. */
 static const uint32_t ZBUS_PUB_TIMEOUT_MS = 100U;
 static const uint32_t SETTINGS_BOOT_WAIT_TIMEOUT_MS = 10000U;
@@ -82,36 +121,156 @@ struct analog_cell_state {
     uint8_t cell_number;
     CalCoeff_t cal_coeff;
     CellStatus_t status;
-    int16_t last_counts;
-    int64_t last_reading_ticks;
+    int16_t last_counts;             /* latest filter output */
+    int64_t last_reading_ticks;      /* newest sample behind last_counts */
     const struct zbus_channel *out_chan;
     const struct adc_dt_spec *adc;   /* device + channel config, from DT */
+    uint16_t bus_addr;               /* i2c1 address of that ADC, for merging */
     int16_t adc_sample_buf;
     struct adc_sequence adc_seq;
+    AnalogFilterConfig_t filter_cfg;
+    AnalogFilter_t filter;
+    int64_t last_sample_ticks;       /* previous filter input, for the period */
+    uint32_t sample_period_us;       /* running mean input interval */
+    struct k_spinlock stats_lock;    /* guards stats against UDS readers */
+    AnalogFilterStats_t stats;
 };
 
 /**
- * @brief Trigger a single ADC read and store the raw count result in cell state.
+ * @brief Feed one ADC sample through the cell's filter.
+ *
+ * On a filter output, stores it as last_counts with the sample's tick stamp
+ * and refreshes the stats snapshot read by analog_cell_filter_stats().
+ *
+ * @param cell   Cell state
+ * @param counts Raw ADC counts
+ * @param ticks  k_uptime_ticks() when the sample was taken
+ * @return true when a new filtered reading is ready to publish
+ */
+static bool analog_filter_sample(struct analog_cell_state *cell,
+                                 int16_t counts, int64_t ticks)
+{
+    int16_t filtered = 0;
+
+    if ((0 != cell->last_sample_ticks) && (ticks > cell->last_sample_ticks)) {
+        uint32_t interval_us = (uint32_t)k_ticks_to_us_near64(
+            (uint64_t)(ticks - cell->last_sample_ticks));
+
+        if (0U == cell->sample_period_us) {
+            cell->sample_period_us = interval_us;
+        } else {
+            cell->sample_period_us = (uint32_t)((int32_t)cell->sample_period_us +
+                (((int32_t)interval_us - (int32_t)cell->sample_period_us) >>
+                 SAMPLE_PERIOD_EMA_SHIFT));
+        }
+    }
+    cell->last_sample_ticks = ticks;
+
+    bool ready = analog_filter_push(&cell->filter, counts, &filtered);
+
+    if (ready) {
+        AnalogFilterStats_t stats = {0};
+
+        cell->last_counts = filtered;
+        cell->last_reading_ticks = ticks;
+
+        analog_filter_stats(&cell->filter, cell->sample_period_us, &stats);
+        k_spinlock_key_t key = k_spin_lock(&cell->stats_lock);
+
+        cell->stats = stats;
+        k_spin_unlock(&cell->stats_lock, key);
+    }
+
+    return ready;
+}
+
+#ifndef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+/**
+ * @brief Trigger a single ADC read and feed the result through the filter.
  *
- * @param cell Cell state containing the ADC device handle and sequence config.
+ * @param cell  Cell state containing the ADC device handle and sequence config.
+ * @param ready Set true when the filter produced a reading to publish.
  * @return 0 on success, negative errno on ADC driver failure.
  */
-static Status_t analog_adc_read(struct analog_cell_state *cell)
+#ifdef CONFIG_I2C1_SCHEDULER
+/* i2c1 transfer callback — one conversion of the cell's channel. */
+static Status_t analog_adc_xfer(void *ctx)
+{
+    struct analog_cell_state *cell = ctx;
+
+    return adc_read_dt(cell->adc, &cell->adc_seq);
+}
+#endif
+
+static Status_t analog_adc_read(struct analog_cell_state *cell, bool *ready)
 {
     cell->adc_seq.buffer = &cell->adc_sample_buf;
     cell->adc_seq.buffer_size = sizeof(cell->adc_sample_buf);
 
+#ifdef CONFIG_I2C1_SCHEDULER
+    /* One try, no backoff: a missed sample is simply taken next slot, and a
+     * read that cannot start within its slot is dropped (-ETIMEDOUT). */
+    I2c1Txn_t txn = I2C1_TXN(analog_adc_xfer, cell, I2C1_CLIENT_CELL,
+                             I2C1_PRIO_CELL, cell->bus_addr, 1U, 0U, 0U,
+                             CONFIG_I2C1_SCHED_CELL_SLOT_MS);
+    Status_t ret = i2c1_sched_run(&txn);
+#else
     Status_t ret = adc_read_dt(cell->adc, &cell->adc_seq);
+#endif
 
+    *ready = false;
     if (0 == ret) {
-        cell->last_counts = cell->adc_sample_buf;
-        cell->last_reading_ticks = k_uptime_ticks();
+        *ready = analog_filter_sample(cell, cell->adc_sample_buf,
+                                      k_uptime_ticks());
     } else {
         OP_ERROR_DETAIL(OP_ERR_EXT_ADC, (uint32_t)ret);
     }
 
     return ret;
 }
+#else
+/**
+ * @brief Wait for the next scan burst on the cell's channel and feed every
+ *        drained sample through the filter.
+ *
+ * Paces the cell thread: blocks until the driver completes a burst or
+ * ANALOG_RESPONSE_TIMEOUT_MS. When the burst yields more than one filter
+ * output only the newest is kept for publishing.
+ *
+ * @param cell  Cell state containing the ADC device handle and channel.
+ * @param ready Set true when the filter produced a reading to publish.
+ * @return 0 on success, -EAGAIN when no burst arrived in time, -ENODATA when
+ *         the ring was empty.
+ */
+static Status_t analog_scan_read(struct analog_cell_state *cell, bool *ready)
+{
+    struct ads1x1x_scan_sample batch[ANALOG_SCAN_BATCH_MAX];
+    size_t count = 0U;
+    Status_t ret = ads1x1x_scan_wait(cell->adc->dev, cell->adc->channel_id,
+                                     K_MSEC(ANALOG_RESPONSE_TIMEOUT_MS));
+
+    if (0 == ret) {
+        count = ads1x1x_scan_drain(cell->adc->dev, cell->adc->channel_id,
+                                   batch, ARRAY_SIZE(batch));
+        if (0U == count) {
+            ret = -ENODATA;
+        }
+    }
+
+    *ready = false;
+    if (0 == ret) {
+        for (size_t i = 0U; i < count; ++i) {
+            if (analog_filter_sample(cell, batch[i].counts, batch[i].ticks)) {
+                *ready = true;
+            }
+        }
+    } else {
+        OP_ERROR_DETAIL(OP_ERR_EXT_ADC, (uint32_t)ret);
+    }
+
+    return ret;
+}
+#endif
 
 /**
  * @brief Convert the latest ADC counts to PPO2 and millivolts, then publish
@@ -153,7 +312,8 @@ static void analog_publish(struct analog_cell_state *cell)
         .precision_ppo2 = (PrecisionPPO2_t)cal_ppo2 / 100.0f,
         .millivolts = millivolts,
         .status = cell->status,
-        .timestamp_ticks = k_uptime_ticks(),
+        .timestamp_ticks = cell->last_reading_ticks,
+        .sample_seq = latency_trace_next_seq(),
         .raw_sample = (int32_t)cell->last_counts,
         .temperature_mc = 0,
         .err_code = 0U,
@@ -195,6 +355,16 @@ static Status_t analog_cell_init_adc(struct analog_cell_state *cell)
             (void)adc_sequence_init_dt(cell->adc, &cell->adc_seq);
             cell->adc_seq.buffer = &cell->adc_sample_buf;
             cell->adc_seq.buffer_size = sizeof(cell->adc_sample_buf);
+
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+            /* Idempotent: the first cell on a shared chip starts the
+             * scan, the second just joins it with its own channel. */
+            result = ads1x1x_scan_start(cell->adc->dev);
+            if (0 != result) {
+                LOG_ERR("ADC scan start failed for cell %u: %d",
+                    cell->cell_number, result);
+            }
+#endif
         }
     }
 
@@ -276,6 +446,7 @@ static void analog_cell_thread(void *p1, void *p2, void *p3)
         .millivolts = 0,
         .status = cell->status,
         .timestamp_ticks = k_uptime_ticks(),
+        .sample_seq = 0U,
         .raw_sample = 0,
         .temperature_mc = 0,
         .err_code = 0U,
@@ -287,15 +458,33 @@ static void analog_cell_thread(void *p1, void *p2, void *p3)
     };
     zbus_pub_checked(cell->out_chan, &init_msg, K_MSEC(ZBUS_PUB_TIMEOUT_MS));
 
+    if (!analog_filter_init(&cell->filter, cell->filter_cfg)) {
+        LOG_WRN("Cell %u: invalid filter config, filtering disabled",
+            cell->cell_number);
+    }
+
     if (0 != analog_cell_init_adc(cell)) {
         cell->status = CELL_FAIL;
     } else {
         heartbeat_register((HeartbeatId_t)(HEARTBEAT_CELL_1 + cell->cell_number));
         while (true) {
+            bool ready = false;
+
             heartbeat_kick((HeartbeatId_t)(HEARTBEAT_CELL_1 + cell->cell_number));
-            if (0 == analog_adc_read(cell)) {
+#ifdef CONFIG_ADC_ADS1X1X_LOCAL_SCAN
+            /* Blocks until the driver finishes a burst on this
+             * channel, so the scan paces the loop. */
+            if ((0 == analog_scan_read(cell, &ready)) && ready) {
+                analog_publish(cell);
+            }
+#else
+            if ((0 == analog_adc_read(cell, &ready)) && ready) {
                 analog_publish(cell);
             }
+#ifdef CONFIG_I2C1_SCHEDULER
+            /* Phase-lock to the scheduler's reserved cell window. */
+            (void)k_sleep(i2c1_sched_next_cell_slot());
+#else
             /* ADS1115 at 128 SPS takes ~8 ms per conversion on real
              * hardware; adc_read() blocks until complete.  Emulated
              * back-ends (zephyr,adc-emul on native_sim) return
@@ -303,6 +492,8 @@ static void analog_cell_thread(void *p1, void *p2, void *p3)
              * here to avoid spinning at maximum speed and starving
              * other threads of the publisher's zbus queue. */
             (void)k_msleep(ANALOG_SAMPLE_INTERVAL_MS);
+#endif
+#endif
         }
     }
 }
@@ -360,8 +551,10 @@ static struct analog_cell_state cell_1_state = {
     .last_reading_ticks = 0,
     .out_chan = &chan_cell_1,
     .adc = &cell_1_adc,
+    .bus_addr = I2C1_ADC_CHANNEL_ADDR(0),
     .adc_sample_buf = 0,
     .adc_seq = {0},
+    .filter_cfg = ANALOG_FILTER_CFG(1),
 };
 K_THREAD_DEFINE(analog_cell_1, ANALOG_CELL_STACK_SIZE,
         analog_cell_thread, &cell_1_state, NULL, NULL,
@@ -379,8 +572,10 @@ static struct analog_cell_state cell_2_state = {
     .last_reading_ticks = 0,
     .out_chan = &chan_cell_2,
     .adc = &cell_2_adc,
+    .bus_addr = I2C1_ADC_CHANNEL_ADDR(1),
     .adc_sample_buf = 0,
     .adc_seq = {0},
+    .filter_cfg = ANALOG_FILTER_CFG(2),
 };
 K_THREAD_DEFINE(analog_cell_2, ANALOG_CELL_STACK_SIZE,
         analog_cell_thread, &cell_2_state, NULL, NULL,
@@ -398,10 +593,58 @@ static struct analog_cell_state cell_3_state = {
     .last_reading_ticks = 0,
     .out_chan = &chan_cell_3,
     .adc = &cell_3_adc,
+    .bus_addr = I2C1_ADC_CHANNEL_ADDR(2),
     .adc_sample_buf = 0,
     .adc_seq = {0},
+    .filter_cfg = ANALOG_FILTER_CFG(3),
 };
 K_THREAD_DEFINE(analog_cell_3, ANALOG_CELL_STACK_SIZE,
         analog_cell_thread, &cell_3_state, NULL, NULL,
         7, 0, 0);
 #endif
+
+/* ---- Filter figures for UDS ---- */
+
+bool analog_cell_filter_stats(uint8_t cell_number, AnalogFilterStats_t *out)
+{
+    struct analog_cell_state *cell = NULL;
+    bool found = false;
+
+#if defined(CONFIG_CELL_1_TYPE_ANALOG)
+    if (0U == cell_number) {
+        cell = &cell_1_state;
+    }
+#endif
+#if CONFIG_CELL_COUNT >= 2 && defined(CONFIG_CELL_2_TYPE_ANALOG)
+    if (1U == cell_number) {
+        cell = &cell_2_state;
+    }
+#endif
+#if CONFIG_CELL_COUNT >= 3 && defined(CONFIG_CELL_3_TYPE_ANALOG)
+    if (2U == cell_number) {
+        cell = &cell_3_state;
+    }
+#endif
+
+    if ((NULL != cell) && (NULL != out)) {
+        k_spinlock_key_t key = k_spin_lock(&cell->stats_lock);
+
+        *out = cell->stats;
+        k_spin_unlock(&cell->stats_lock, key);
+
+        /* Before the first output the snapshot is empty; still report
+         * the configured shape and its nominal figures. */
+        if (0U == out->samples_out) {
+            out->kind = cell->filter_cfg.kind;
+            out->taps = cell->filter_cfg.taps;
+            out->iir_shift = cell->filter_cfg.iir_shift;
+            out->noise_gain_permille =
+                analog_filter_noise_gain_permille(cell->filter_cfg);
+            out->group_delay_dsamples =
+                analog_filter_group_delay_dsamples(cell->filter_cfg);
+        }
+        found = true;
+    }
+
+    return found;
+}
@@ -9,7 +9,7 @@
  * One thread is spawned per cell enabled via CONFIG_CELL_n_TYPE_DIVEO2.
  */
 
-/* strtok_r requires POSIX source on native_sim (host libc) */
+/* strnlen requires POSIX source on native_sim (host libc) */
 #if !defined(_POSIX_C_SOURCE)
 #define _POSIX_C_SOURCE 200809L
 #endif
@@ -30,6 +30,7 @@
 #include "calibration_store.h"
 #include "errors.h"
 #include "heartbeat.h"
+#include "latency_trace.h"
 
 #include <zephyr/sys/printk.h>
 #include <string.h>
@@ -59,7 +60,7 @@ LOG_MODULE_REGISTER(cell_diveo2, LOG_LEVEL_INF);
 #define DIVEO2_DETAILED_FIELD_COUNT 8U
 #define DIVEO2_SIMPLE_FIELD_COUNT   3U
 
-/* Field indices within the strtok_r result array */
+/* Field indices, in order after the header */
 #define FIELD_IDX_PPO2          0U
 #define FIELD_IDX_TEMPERATURE   1U
 #define FIELD_IDX_ERR_CODE      2U
@@ -78,6 +79,9 @@ LOG_MODULE_REGISTER(cell_diveo2, LOG_LEVEL_INF);
 #define STRTOL_BASE          10
 /* Length of the "#D"/"#M" family prefix, before the 3-char command suffix. */
 #define DIVEO2_HEADER_PREFIX_LEN 2U
+#define DIVEO2_HEADER_LEN        5U
+/* Largest magnitude a numeric field accumulates before it saturates. */
+#define DIVEO2_I32_MAGNITUDE_MAX ((int64_t)INT32_MAX + 1)
 /* Auto-detect cycles through 3 phases: passive listen, DiveO2 poll, Pyro poll. */
 #define DIVEO2_DETECT_PHASE_COUNT 3U
 /* Zero-based index of the third cell slot. */
@@ -147,171 +151,236 @@ typedef struct {
     CellStatus_t status;
 } DiveO2DetailedReading_t;
 
-/* ---- Parse functions (pure, no OS deps — testable) ---- */
+/* ---- Parse functions (pure, no OS deps — testable) ----
+ *
+ * Frames are parsed where they were received (the UART DMA buffer, see
+ * diveo2_feed_rx), so none of these functions expects a NUL terminator: each
+ * takes the message as a pointer plus length and walks it once with a
+ * DiveO2Cursor_t, converting numeric fields as it goes. Nothing is copied.
+ */
+
+/** @brief Read cursor over a message viewed in place. */
+typedef struct {
+    const char *pos;   /**< Next unread byte */
+    const char *end;   /**< One past the last byte of the message */
+} DiveO2Cursor_t;
 
 /**
- * @brief Decode a DiveO2 numeric error-code string into a CellStatus_t severity.
+ * @brief Map a DiveO2 error word to a CellStatus_t severity.
  *
  * Bit-tests the error word against defined error and warning masks.  Fatal
  * sensor errors map to CELL_FAIL; humidity/pressure warnings to CELL_DEGRADED;
  * unknown non-zero codes to CELL_FAIL; zero to CELL_OK.
  *
- * @param err_str  Null-terminated decimal string of the error code field.
+ * @param errCode  Error word as reported by the cell (16 significant bits).
  * @return CELL_OK, CELL_DEGRADED, or CELL_FAIL.
  */
-CellStatus_t diveo2_parse_error_code(const char *err_str)
+static CellStatus_t diveo2_error_status(uint32_t errCode)
 {
     CellStatus_t status = CELL_OK;
 
-    if (err_str != NULL) {
-        uint32_t errCode = (uint16_t)(strtol(err_str, NULL,
-                             STRTOL_BASE));
-        /* Check for error states */
-        if (0U != (errCode &
-                   (ERR_LOW_INTENSITY | ERR_HIGH_SIGNAL |
-                    ERR_LOW_SIGNAL | ERR_HIGH_REF | ERR_TEMP))) {
-            OP_ERROR_DETAIL(OP_ERR_CELL_FAILURE, errCode);
-            status = CELL_FAIL;
-        } else if (0U != (errCode &
-                          (WARN_HUMIDITY_FAIL | WARN_PRESSURE |
-                           WARN_HUMIDITY_HIGH | WARN_NEAR_SAT))) {
-            OP_ERROR_DETAIL(OP_ERR_CELL_FAILURE, errCode);
-            status = CELL_DEGRADED;
-        } else if (errCode > 0U) {
-            /* Unknown error */
-            OP_ERROR_DETAIL(OP_ERR_UNKNOWN, errCode);
-            status = CELL_FAIL;
-        } else {
-            /* No action — status already CELL_OK */
-        }
-    } else {
+    /* Check for error states */
+    if (0U != (errCode &
+               (ERR_LOW_INTENSITY | ERR_HIGH_SIGNAL |
+                ERR_LOW_SIGNAL | ERR_HIGH_REF | ERR_TEMP))) {
+        OP_ERROR_DETAIL(OP_ERR_CELL_FAILURE, errCode);
+        status = CELL_FAIL;
+    } else if (0U != (errCode &
+                      (WARN_HUMIDITY_FAIL | WARN_PRESSURE |
+                       WARN_HUMIDITY_HIGH | WARN_NEAR_SAT))) {
+        OP_ERROR_DETAIL(OP_ERR_CELL_FAILURE, errCode);
+        status = CELL_DEGRADED;
+    } else if (errCode > 0U) {
+        /* Unknown error */
+        OP_ERROR_DETAIL(OP_ERR_UNKNOWN, errCode);
         status = CELL_FAIL;
+    } else {
+        /* No action — status already CELL_OK */
+    }
+
+    return status;
+}
+
+/**
+ * @brief Decode a DiveO2 numeric error-code string into a CellStatus_t severity.
+ *
+ * String front end to diveo2_error_status() for callers holding a
+ * null-terminated field.
+ *
+ * @param err_str  Null-terminated decimal string of the error code field.
+ * @return CELL_OK, CELL_DEGRADED, or CELL_FAIL (also for a NULL string).
+ */
+CellStatus_t diveo2_parse_error_code(const char *err_str)
+{
+    CellStatus_t status = CELL_FAIL;
+
+    if (err_str != NULL) {
+        status = diveo2_error_status(
+            (uint16_t)(strtol(err_str, NULL, STRTOL_BASE)));
     }
 
     return status;
 }
 
 /**
- * @brief Strip leading CR/nulls and trailing CR/LF from a raw DiveO2 UART buffer.
+ * @brief Locate the message inside a received frame, without copying it.
  *
  * DiveO2 uses CR (0x0D) as its line terminator, so leading CRs are treated as
- * junk in the same way O2S treats leading LFs.
+ * junk in the same way O2S treats leading LFs. Leading NULs and CRs are
+ * skipped and the view ends at the first NUL, CR or LF.
  *
- * @param rawBuffer    Source buffer as received from UART.
- * @param outBuffer    Destination buffer for the cleaned, null-terminated string.
- * @param outBufferLen Size of outBuffer including space for the null terminator.
- * @return Number of leading bytes skipped.
+ * @param raw      Frame bytes as received; need not be null-terminated.
+ * @param raw_len  Number of bytes available at @p raw.
+ * @param msg_len  Output: length of the message view (0 on bad arguments).
+ * @return Start of the message inside @p raw, or NULL on bad arguments.
  */
-size_t diveo2_prepare_message_buffer(const char *rawBuffer, char *outBuffer,
-                                     size_t outBufferLen)
+const char *diveo2_frame_view(const char *raw, size_t raw_len, size_t *msg_len)
 {
-    size_t skipped = 0U;
+    const char *msg = NULL;
+    size_t len = 0U;
 
-    if ((rawBuffer != NULL) && (outBuffer != NULL) && (outBufferLen > 0U)) {
-        const char *msgBuf = rawBuffer;
+    if ((raw != NULL) && (msg_len != NULL)) {
+        size_t start = 0U;
 
         /* Skip leading junk (nulls and newlines). '\r' is DIVEO2_NEWLINE. */
-        while ((('\0' == msgBuf[0]) || ('\r' == msgBuf[0])) &&
-               (skipped < (outBufferLen - 1U))) {
-            ++msgBuf;
-            ++skipped;
+        while ((start < raw_len) &&
+               (('\0' == raw[start]) || ('\r' == raw[start]))) {
+            ++start;
         }
 
-        /* Copy to output buffer */
-        size_t copyLen = outBufferLen - skipped;
-
-        if (copyLen > outBufferLen) {
-            copyLen = outBufferLen;
+        /* Message runs up to the first terminator */
+        while (((start + len) < raw_len) && ('\0' != raw[start + len]) &&
+               ('\r' != raw[start + len]) && ('\n' != raw[start + len])) {
+            ++len;
         }
-        (void)strncpy(outBuffer, msgBuf, copyLen);
-        outBuffer[outBufferLen - 1U] = '\0';
+        msg = &raw[start];
+    }
 
-        /* Null-terminate at first newline */
-        outBuffer[strcspn(outBuffer, "\r\n")] = '\0';
-    } else if (outBuffer != NULL) {
-        outBuffer[0] = '\0';
-    } else {
-        /* No outBuffer — caller will see skipped == 0 */
+    if (msg_len != NULL) {
+        *msg_len = len;
     }
 
-    return skipped;
+    return msg;
 }
 
 /**
- * @brief Return true if every pointer in a field array is non-null.
+ * @brief Return the next space-delimited token and advance past it.
  *
- * Factored out to avoid S1067 (long `&&` chains) when checking strtok_r results.
+ * Runs of spaces separate tokens, as strtok_r with a " " delimiter would.
  *
- * @param fields  Array of C-string pointers produced by strtok_r.
- * @param count   Number of elements to check.
- * @return true if all fields[0..count-1] are non-NULL.
+ * @param cur  Cursor, advanced to the byte after the token.
+ * @param tok  Output: start of the token.
+ * @return Token length; 0 once the message is exhausted.
  */
-/* Returns true if all pointers in the array are non-null. Loops to avoid an
- * S1067 long chain of `&&` operators in callers. */
-static bool diveo2_all_non_null(const char *const *fields, uint8_t count)
+static size_t diveo2_next_token(DiveO2Cursor_t *cur, const char **tok)
 {
-    bool all_present = true;
-
-    for (uint8_t i = 0U; i < count; ++i) {
-        if (NULL == fields[i]) {
-            all_present = false;
-        }
+    while ((cur->pos < cur->end) && (' ' == *cur->pos)) {
+        ++cur->pos;
+    }
+    *tok = cur->pos;
+    while ((cur->pos < cur->end) && (' ' != *cur->pos)) {
+        ++cur->pos;
     }
-    return all_present;
+
+    return (size_t)(cur->pos - *tok);
 }
 
 /**
- * @brief Strictly parse a whole token as a base-10 int32.
+ * @brief Strictly parse the next token as a base-10 int32, in place.
  *
  * Unlike a bare strtol(tok, NULL, 10) — which silently returns 0 for an empty
- * or non-numeric token — this requires the token to be non-empty and FULLY
- * consumed (no leading/trailing garbage). A genuine "0" parses to 0 and is
- * preserved; only a corrupt/partial field is rejected, so a garbage field
- * surfaces as a parse failure (a visible cell FAIL) instead of a bogus zero.
+ * or non-numeric token — this requires the token to be non-empty and made up
+ * ENTIRELY of an optional sign and decimal digits. A genuine "0" parses to 0
+ * and is preserved; only a corrupt/partial field is rejected, so a garbage
+ * field surfaces as a parse failure (a visible cell FAIL) instead of a bogus
+ * zero. Out-of-range values saturate at the int32 limits, as strtol does with
+ * the target's 32-bit long.
  *
- * @param tok  Null-terminated field token from strtok_r (may be NULL).
+ * @param cur  Cursor, advanced past the token.
  * @param out  Output value, written only on success.
  * @return true if the entire token is a valid integer.
  */
-static bool diveo2_parse_i32(const char *tok, int32_t *out)
+static bool diveo2_next_i32(DiveO2Cursor_t *cur, int32_t *out)
 {
-    bool success = false;
+    const char *tok = NULL;
+    size_t len = diveo2_next_token(cur, &tok);
+    size_t i = 0U;
+    bool negative = false;
+    int64_t val = 0;
+
+    if ((len > 0U) && (('-' == tok[0]) || ('+' == tok[0]))) {
+        negative = ('-' == tok[0]);
+        i = 1U;
+    }
 
-    if ((tok != NULL) && (out != NULL) && ('\0' != tok[0])) {
-        char *end = NULL;
-        int64_t val = strtol(tok, &end, STRTOL_BASE);
+    /* At least one digit after the optional sign */
+    bool success = (i < len);
 
-        /* Accept only if something was consumed and no trailing chars remain. */
-        if ((tok != end) && ('\0' == *end)) {
-            *out = (int32_t)val;
-            success = true;
+    for (; success && (i < len); ++i) {
+        if ((tok[i] >= '0') && (tok[i] <= '9')) {
+            /* Stop growing once past the int32 range; the clamp below
+             * saturates it. Keeps val far from int64 overflow. */
+            if (val <= DIVEO2_I32_MAGNITUDE_MAX) {
+                val = (val * STRTOL_BASE) + (int64_t)(tok[i] - '0');
+            }
+        } else {
+            success = false;
         }
     }
 
+    if (success) {
+        if (negative) {
+            val = -val;
+        }
+        *out = (int32_t)CLAMP(val, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+    }
+
     return success;
 }
 
+/**
+ * @brief Parse the next @p count tokens as integers.
+ *
+ * @param cur    Cursor, positioned after the header.
+ * @param vals   Output array of @p count values.
+ * @param count  Number of fields expected.
+ * @return true if every field was present and fully numeric.
+ */
+static bool diveo2_next_fields(DiveO2Cursor_t *cur, int32_t *vals,
+                               uint8_t count)
+{
+    bool all_numeric = true;
+
+    for (uint8_t i = 0U; all_numeric && (i < count); ++i) {
+        all_numeric = diveo2_next_i32(cur, &vals[i]);
+    }
+
+    return all_numeric;
+}
+
 /**
  * @brief Test whether a command header matches either protocol family.
  *
  * Accepts "#D<suffix>" (DiveO2) or "#M<suffix>" (Pyroscience) — the two
  * families differ only in the prefix letter, so a single check parses both.
  *
- * @param hdr     Header token (e.g. "#DRAW" / "#MRAW").
+ * @param hdr     Header token (e.g. "#DRAW" / "#MRAW"), not null-terminated.
+ * @param len     Length of the header token.
  * @param suffix  Expected 3-char body after the prefix letter (e.g. "RAW","OXY").
  * @return true if hdr is "#D<suffix>" or "#M<suffix>".
  */
-static bool diveo2_header_is(const char *hdr, const char *suffix)
+static bool diveo2_header_is(const char *hdr, size_t len, const char *suffix)
 {
-    bool valid_prefix = (hdr != NULL) && ('#' == hdr[0]) &&
+    bool valid_prefix = (DIVEO2_HEADER_LEN == len) && ('#' == hdr[0]) &&
                         (('D' == hdr[1]) || ('M' == hdr[1]));
 
     return valid_prefix &&
-           (0 == strcmp(&hdr[DIVEO2_HEADER_PREFIX_LEN], suffix));
+           (0 == memcmp(&hdr[DIVEO2_HEADER_PREFIX_LEN], suffix,
+                        DIVEO2_HEADER_LEN - DIVEO2_HEADER_PREFIX_LEN));
 }
 
 /**
- * @brief True if the cleaned message begins with a #?RAW or #?OXY measurement
+ * @brief True if the message begins with a #?RAW or #?OXY measurement
  *        header (either protocol family).
  *
  * Lets diveo2_process_rx tell a CORRUPT measurement (right header, unparseable
@@ -319,44 +388,44 @@ static bool diveo2_header_is(const char *hdr, const char *suffix)
  * frame such as a #BCST command echo or a cross-family probe reply (which must
  * be skipped quietly, never flagged — see the process_rx comment).
  *
- * @param msg  Cleaned, null-terminated message string.
+ * @param msg  Message view (see diveo2_frame_view()).
+ * @param len  Length of the message.
  * @return true if the first token is a measurement header.
  */
-static bool diveo2_is_measurement(const char *msg)
+static bool diveo2_is_measurement(const char *msg, size_t len)
 {
     bool result = false;
 
     if (msg != NULL) {
-        char copy[DIVEO2_RX_BUFFER_LEN] = {0};
-
-        (void)strncpy(copy, msg, sizeof(copy) - 1U);
-        copy[sizeof(copy) - 1U] = '\0';
+        DiveO2Cursor_t cur = { .pos = msg, .end = &msg[len] };
+        const char *hdr = NULL;
+        size_t hdr_len = diveo2_next_token(&cur, &hdr);
 
-        char *saveptr = NULL;
-        const char *hdr = strtok_r(copy, " ", &saveptr);
-
-        result = diveo2_header_is(hdr, "RAW") || diveo2_header_is(hdr, "OXY");
+        result = diveo2_header_is(hdr, hdr_len, "RAW") ||
+                 diveo2_header_is(hdr, hdr_len, "OXY");
     }
 
     return result;
 }
 
 /**
- * @brief Classify the protocol family of a (cleaned) cell message by its prefix.
+ * @brief Classify the protocol family of a cell message by its prefix.
  *
  * Pure helper used by both the runtime auto-detection and the parser tests.
  * Only the family-distinguishing prefix letter is inspected; field validation
  * is the parse functions' job.
  *
- * @param message  Cleaned, null-terminated message (e.g. "#DRAW 12340 ...").
+ * @param message  Message view (e.g. "#DRAW 12340 ...").
+ * @param len      Length of the message.
  * @return CELL_PROTO_DIVEO2 for a '#D...' header, CELL_PROTO_PYRO for '#M...',
  *         else CELL_PROTO_UNKNOWN.
  */
-CellProtocol_t diveo2_detect_protocol(const char *message)
+CellProtocol_t diveo2_detect_protocol(const char *message, size_t len)
 {
     CellProtocol_t proto = CELL_PROTO_UNKNOWN;
 
-    if ((message != NULL) && ('#' == message[0])) {
+    if ((message != NULL) && (len >= DIVEO2_HEADER_PREFIX_LEN) &&
+        ('#' == message[0])) {
         if ('D' == message[1]) {
             proto = CELL_PROTO_DIVEO2;
         } else if ('M' == message[1]) {
@@ -372,14 +441,15 @@ CellProtocol_t diveo2_detect_protocol(const char *message)
 /**
  * @brief Parse a DiveO2 "#DOXY <ppo2> <temp> <errcode>" simple response.
  *
- * @param message      Cleaned, null-terminated message string.
+ * @param message      Message view (see diveo2_frame_view()).
+ * @param len          Length of the message.
  * @param raw_ppo2_millihpa Output: raw PPO2 in units of 10^-3 hPa.
  * @param temperature_mc Output: cell temperature in milli-degrees Celsius
  *                       (10^-3 degC).
  * @param status       Output: cell status derived from the error code field.
  * @return true if parsing succeeded and all outputs are valid.
  */
-bool diveo2_parse_simple_response(const char *message,
+bool diveo2_parse_simple_response(const char *message, size_t len,
                                   int32_t *raw_ppo2_millihpa,
                                   int32_t *temperature_mc, CellStatus_t *status)
 {
@@ -387,33 +457,18 @@ bool diveo2_parse_simple_response(const char *message,
 
     if ((message != NULL) && (raw_ppo2_millihpa != NULL) &&
         (temperature_mc != NULL) && (status != NULL)) {
-        char msgCopy[DIVEO2_RX_BUFFER_LEN] = {0};
-
-        (void)strncpy(msgCopy, message, sizeof(msgCopy) - 1U);
-        msgCopy[sizeof(msgCopy) - 1U] = '\0';
-
-        const char *const sep = " ";
-        char *saveptr = NULL;
-        const char *cmdName = strtok_r(msgCopy, sep, &saveptr);
-
-        if (diveo2_header_is(cmdName, "OXY")) {
-            const char *fields[DIVEO2_SIMPLE_FIELD_COUNT] = {0};
-
-            for (uint8_t i = 0U; i < DIVEO2_SIMPLE_FIELD_COUNT; ++i) {
-                fields[i] = strtok_r(NULL, sep, &saveptr);
-            }
-
-            int32_t p = 0;
-            int32_t t = 0;
-            int32_t e = 0;
-
-            if (diveo2_all_non_null(fields, DIVEO2_SIMPLE_FIELD_COUNT) &&
-                diveo2_parse_i32(fields[FIELD_IDX_PPO2], &p) &&
-                diveo2_parse_i32(fields[FIELD_IDX_TEMPERATURE], &t) &&
-                diveo2_parse_i32(fields[FIELD_IDX_ERR_CODE], &e)) {
-                *raw_ppo2_millihpa = p;
-                *temperature_mc = t;
-                *status = diveo2_parse_error_code(fields[FIELD_IDX_ERR_CODE]);
+        DiveO2Cursor_t cur = { .pos = message, .end = &message[len] };
+        const char *cmdName = NULL;
+        size_t cmdLen = diveo2_next_token(&cur, &cmdName);
+
+        if (diveo2_header_is(cmdName, cmdLen, "OXY")) {
+            int32_t vals[DIVEO2_SIMPLE_FIELD_COUNT] = {0};
+
+            if (diveo2_next_fields(&cur, vals, DIVEO2_SIMPLE_FIELD_COUNT)) {
+                *raw_ppo2_millihpa = vals[FIELD_IDX_PPO2];
+                *temperature_mc = vals[FIELD_IDX_TEMPERATURE];
+                *status = diveo2_error_status(
+                    (uint16_t)vals[FIELD_IDX_ERR_CODE]);
                 success = true;
             } else {
                 /* Right header but a field is missing OR non-numeric/garbage —
@@ -442,43 +497,25 @@ bool diveo2_parse_simple_response(const char *message,
  * @brief Parse a DiveO2 "#DRAW <ppo2> <temp> <err> <phase> <intensity>
  *        <ambient> <pressure> <humidity>" detailed response.
  *
- * @param message  Cleaned, null-terminated message string.
+ * @param message  Message view (see diveo2_frame_view()).
+ * @param len      Length of the message.
  * @param out      Output struct populated with all eight fields and derived status.
  * @return true if all eight fields were present and parsed successfully.
  */
-bool diveo2_parse_detailed_response(const char *message,
+bool diveo2_parse_detailed_response(const char *message, size_t len,
                                     DiveO2DetailedReading_t *out)
 {
     bool success = false;
 
     if ((message != NULL) && (out != NULL)) {
-        char msgCopy[DIVEO2_RX_BUFFER_LEN] = {0};
-
-        (void)strncpy(msgCopy, message, sizeof(msgCopy) - 1U);
-        msgCopy[sizeof(msgCopy) - 1U] = '\0';
-
-        const char *const sep = " ";
-        char *saveptr = NULL;
-        const char *cmdName = strtok_r(msgCopy, sep, &saveptr);
-
-        if (diveo2_header_is(cmdName, "RAW")) {
-            const char *fields[DIVEO2_DETAILED_FIELD_COUNT] = {0};
-
-            for (uint8_t i = 0U; i < DIVEO2_DETAILED_FIELD_COUNT; ++i) {
-                fields[i] = strtok_r(NULL, sep, &saveptr);
-            }
+        DiveO2Cursor_t cur = { .pos = message, .end = &message[len] };
+        const char *cmdName = NULL;
+        size_t cmdLen = diveo2_next_token(&cur, &cmdName);
 
+        if (diveo2_header_is(cmdName, cmdLen, "RAW")) {
             int32_t vals[DIVEO2_DETAILED_FIELD_COUNT] = {0};
-            bool all_numeric = diveo2_all_non_null(
-                fields, DIVEO2_DETAILED_FIELD_COUNT);
-
-            for (uint8_t i = 0U; i < DIVEO2_DETAILED_FIELD_COUNT; ++i) {
-                if (all_numeric && (!diveo2_parse_i32(fields[i], &vals[i]))) {
-                    all_numeric = false;
-                }
-            }
 
-            if (all_numeric) {
+            if (diveo2_next_fields(&cur, vals, DIVEO2_DETAILED_FIELD_COUNT)) {
                 out->raw_ppo2_millihpa = vals[FIELD_IDX_PPO2];
                 out->temperature_mc = vals[FIELD_IDX_TEMPERATURE];
                 out->err_code = vals[FIELD_IDX_ERR_CODE];
@@ -487,7 +524,8 @@ bool diveo2_parse_detailed_response(const char *message,
                 out->ambient_light_uv = vals[FIELD_IDX_AMBIENT];
                 out->ambient_pressure_ubar = vals[FIELD_IDX_PRESSURE];
                 out->housing_humidity_mpercent_rh = vals[FIELD_IDX_HUMIDITY];
-                out->status = diveo2_parse_error_code(fields[FIELD_IDX_ERR_CODE]);
+                out->status = diveo2_error_status(
+                    (uint16_t)vals[FIELD_IDX_ERR_CODE]);
                 success = true;
             } else {
                 /* Right header but a field is missing OR non-numeric/garbage —
@@ -533,6 +571,30 @@ void diveo2_format_tx_command(const char *command, uint8_t *txBuf,
 
 /* ---- Thread state and implementation ---- */
 
+/* Storage a received frame can live in: either DMA buffer, or rx_line for a
+ * frame split across the DMA buffer swap. Indexes rx_gen. */
+#define DIVEO2_RX_SRC_STITCH 2U
+#define DIVEO2_RX_SRC_COUNT  3U
+
+BUILD_ASSERT(DIVEO2_RX_BUFFER_LEN <= UINT8_MAX,
+             "DiveO2RxSpan_t stores offsets and lengths as uint8_t");
+
+/**
+ * @brief A complete CR/LF-delimited frame, viewed where it was received.
+ *
+ * The bytes are only valid while rx_gen[src] still equals gen: the callback
+ * bumps it before the storage can be rewritten (a DMA buffer when it is
+ * handed back to the UART, rx_line when a new head is saved into it), so the
+ * thread parses first and checks afterwards (see diveo2_rx_span_intact()).
+ */
+typedef struct {
+    const char *buf;   /**< rx_buf[src] or rx_line */
+    uint8_t offset;
+    uint8_t len;
+    uint8_t src;       /**< 0/1 = DMA buffer, DIVEO2_RX_SRC_STITCH = rx_line */
+    atomic_val_t gen;  /**< rx_gen[src] when the frame completed */
+} DiveO2RxSpan_t;
+
 struct diveo2_cell_state {
     uint8_t cell_number;
     const struct device *uart_dev;
@@ -551,61 +613,247 @@ struct diveo2_cell_state {
     int32_t ambient_pressure_ubar;
     int32_t housing_humidity_mpercent_rh;
     int64_t last_ppo2_ticks;
-    char last_message[DIVEO2_RX_BUFFER_LEN];
-    /* Continuous RX with CR line accumulation. RX stays enabled for the cell's
-     * lifetime (double-buffered) so a broadcast stream is never re-synced
-     * mid-frame; bytes accumulate in rx_line until a CR delivers a complete
-     * frame to last_message. */
+    /* Continuous RX with in-place CR/LF framing. RX stays enabled for the
+     * cell's lifetime (double-buffered) so a broadcast stream is never
+     * re-synced mid-frame. The callback scans each DMA chunk for terminators
+     * and publishes a complete frame as rx_span, pointing into rx_buf; only a
+     * frame split across the buffer swap, or one still unread when its buffer
+     * is handed back to the DMA, is copied, into rx_line. */
     uint8_t rx_buf[2][DIVEO2_RX_BUFFER_LEN];
     uint8_t rx_active;
+    const uint8_t *rx_frag_buf;  /**< DMA buffer holding the unterminated line, or NULL */
+    size_t rx_frag_off;
+    size_t rx_frag_len;
     char rx_line[DIVEO2_RX_BUFFER_LEN];
-    size_t rx_line_len;
+    size_t rx_line_off;          /**< Start of that head, after a kept frame */
+    size_t rx_line_len;          /**< Head of a split frame held in rx_line */
+    atomic_t rx_gen[DIVEO2_RX_SRC_COUNT];
+    DiveO2RxSpan_t rx_span;      /**< Latest complete frame; guarded by irq_lock */
     uint8_t tx_buf[DIVEO2_TX_BUFFER_LEN];
     struct k_sem rx_sem;
     struct k_sem tx_sem;   /**< Available(1) when tx_buf is free; given on TX done */
-    size_t rx_len;
     const struct zbus_channel *out_chan;
 };
 
 /**
- * @brief Copy a UART_RX_RDY payload into the cell's last_message buffer.
+ * @brief Hand a complete frame to the cell thread.
+ *
+ * The frame is the @p len bytes at @p buf + @p offset, preceded by any head
+ * of a split frame already in rx_line. Empty lines (back-to-back CR/LF) are
+ * ignored so framing survives CR+LF terminators.
+ *
+ * @param cell    Cell state whose rx_span is replaced.
+ * @param buf     DMA buffer holding the (tail of the) frame.
+ * @param offset  Start of the frame's bytes in @p buf.
+ * @param len     Number of the frame's bytes in @p buf.
+ */
+static void diveo2_publish_rx(struct diveo2_cell_state *cell,
+                              const uint8_t *buf, size_t offset, size_t len)
+{
+    bool ready = false;
+
+    if (cell->rx_line_len > 0U) {
+        /* Tail of a frame whose head was saved at the buffer swap. */
+        size_t head_end = cell->rx_line_off + cell->rx_line_len;
+
+        if ((cell->rx_line_off > 0U) &&
+            ((head_end + len) >= DIVEO2_RX_BUFFER_LEN)) {
+            /* No room behind the frame kept at the swap, which this one
+             * supersedes anyway: move the head to the front. */
+            (void)atomic_inc(&cell->rx_gen[DIVEO2_RX_SRC_STITCH]);
+            (void)memmove(cell->rx_line, &cell->rx_line[cell->rx_line_off],
+                          cell->rx_line_len);
+            cell->rx_line_off = 0U;
+            head_end = cell->rx_line_len;
+        }
+        if ((head_end + len) < DIVEO2_RX_BUFFER_LEN) {
+            (void)memcpy(&cell->rx_line[head_end], &buf[offset], len);
+            cell->rx_span.buf = cell->rx_line;
+            cell->rx_span.offset = (uint8_t)cell->rx_line_off;
+            cell->rx_span.len = (uint8_t)(cell->rx_line_len + len);
+            cell->rx_span.src = DIVEO2_RX_SRC_STITCH;
+            ready = true;
+        }
+        cell->rx_line_off = 0U;
+        cell->rx_line_len = 0U;
+    } else if ((len > 0U) && (len < DIVEO2_RX_BUFFER_LEN)) {
+        cell->rx_span.buf = (const char *)buf;
+        cell->rx_span.offset = (uint8_t)offset;
+        cell->rx_span.len = (uint8_t)len;
+        cell->rx_span.src = (buf == cell->rx_buf[1]) ? 1U : 0U;
+        ready = true;
+    } else {
+        /* Empty line — nothing to deliver. */
+    }
+
+    if (ready) {
+        cell->rx_span.gen = atomic_get(&cell->rx_gen[cell->rx_span.src]);
+        k_sem_give(&cell->rx_sem);
+    }
+}
+
+/**
+ * @brief Frame a UART_RX_RDY chunk in place.
  *
- * Factored out of the UART callback to keep the switch-case body small (S1151).
+ * Scans only the new bytes for CR/LF; each terminator completes a frame that
+ * starts where the previous one ended, possibly in an earlier chunk of the
+ * same DMA buffer. The bytes after the last terminator are remembered as the
+ * unterminated fragment.
  *
- * @param cell  Cell state whose last_message field is written.
+ * @param cell  Cell state receiving the frames.
  * @param rx    RX event data containing buf pointer, offset, and byte count.
  */
 /* The Zephyr UART async callback dispatches RX-ready events. The case body
  * size and the framework-fixed parameter types are not negotiable, so the
- * memcpy step is factored out to satisfy S1151 and the suppressions in
+ * framing step is factored out to satisfy S1151 and the suppressions in
  * sonar-project.properties cover the rest. */
 static void diveo2_feed_rx(struct diveo2_cell_state *cell,
                            const struct uart_event_rx *rx)
 {
-    for (size_t i = 0U; i < rx->len; ++i) {
+    size_t end = rx->offset + rx->len;
+    size_t start = rx->offset;
+
+    /* Continue the fragment only if these bytes directly follow it. */
+    if ((cell->rx_frag_buf == rx->buf) &&
+        ((cell->rx_frag_off + cell->rx_frag_len) == rx->offset)) {
+        start = cell->rx_frag_off;
+    }
+
+    for (size_t i = rx->offset; i < end; ++i) {
         /* Raw numeric byte from the UART DMA buffer — kept as uint8_t (not
-         * plain char) until it is stored into the char-typed line
-         * accumulator below, per project char/byte typing convention. */
-        uint8_t byte = rx->buf[rx->offset + i];
+         * plain char) per project char/byte typing convention. */
+        uint8_t byte = rx->buf[i];
 
         if (('\r' == byte) || ('\n' == byte)) {
-            /* Complete frame — hand it to the thread. Empty lines (back-to-back
-             * CR/LF) are ignored so framing survives CR+LF terminators. */
-            if (cell->rx_line_len > 0U) {
-                (void)memcpy(cell->last_message, cell->rx_line,
-                             cell->rx_line_len);
-                cell->last_message[cell->rx_line_len] = '\0';
-                cell->rx_len = cell->rx_line_len;
-                cell->rx_line_len = 0U;
-                k_sem_give(&cell->rx_sem);
-            }
-        } else if (cell->rx_line_len < (DIVEO2_RX_BUFFER_LEN - 1U)) {
-            cell->rx_line[cell->rx_line_len++] = (char)byte;
+            diveo2_publish_rx(cell, rx->buf, start, i - start);
+            start = i + 1U;
+        }
+    }
+
+    cell->rx_frag_buf = rx->buf;
+    cell->rx_frag_off = start;
+    cell->rx_frag_len = end - start;
+}
+
+/**
+ * @brief True if the bytes behind @p span were not reused since it was published.
+ *
+ * @param cell  Cell state.
+ * @param span  Frame snapshot taken by the thread.
+ */
+static bool diveo2_rx_span_intact(struct diveo2_cell_state *cell,
+                                  const DiveO2RxSpan_t *span)
+{
+    return atomic_get(&cell->rx_gen[span->src]) == span->gen;
+}
+
+/**
+ * @brief Handle UART_RX_BUF_REQUEST: hand the spare buffer to the DMA.
+ *
+ * Frames viewed in the spare buffer become stale here, before the buffer is
+ * queued: once uart_rx_buf_rsp() returns the DMA may start writing it at the
+ * next swap, ahead of the UART_RX_BUF_RELEASED for the current one.
+ *
+ * @param cell  Cell state.
+ * @param dev   UART device to supply the buffer to.
+ */
+static void diveo2_request_rx(struct diveo2_cell_state *cell,
+                              const struct device *dev)
+{
+    cell->rx_active ^= 1U;
+    (void)atomic_inc(&cell->rx_gen[cell->rx_active]);
+    (void)uart_rx_buf_rsp(dev, cell->rx_buf[cell->rx_active],
+                          DIVEO2_RX_BUFFER_LEN);
+}
+
+/**
+ * @brief Handle UART_RX_BUF_RELEASED: the DMA moved on to the other buffer.
+ *
+ * The released buffer is handed straight back by the UART_RX_BUF_REQUEST that
+ * follows, which invalidates every view into it. Two things in it must
+ * outlive that, so both are copied to rx_line first:
+ *  - the latest published frame, if it lies there and is still intact — the
+ *    thread may not have run since it completed (a frame ending on the last
+ *    byte of a buffer is published in the same ISR as the swap);
+ *  - an unterminated fragment at its end, the head of a frame that continues
+ *    in the next buffer. It goes after a frame kept in rx_line. A head that
+ *    no longer fits is an overrun (no terminator within a frame) — drop it
+ *    and resync.
+ *
+ * @param cell  Cell state.
+ * @param buf   The released DMA buffer.
+ */
+static void diveo2_release_rx(struct diveo2_cell_state *cell,
+                              const uint8_t *buf)
+{
+    uint8_t released = (buf == cell->rx_buf[1]) ? 1U : 0U;
+    bool keep = (cell->rx_span.len > 0U) &&
+                diveo2_rx_span_intact(cell, &cell->rx_span);
+    bool rescue = keep && (cell->rx_span.src == released);
+    bool save_head = (cell->rx_frag_buf == buf) && (cell->rx_frag_len > 0U);
+
+    if (rescue || save_head) {
+        /* Invalidate views the thread may hold into rx_line before any of it
+         * is rewritten; a frame kept in place is re-stamped below. */
+        (void)atomic_inc(&cell->rx_gen[DIVEO2_RX_SRC_STITCH]);
+    }
+
+    /* With a head already held (no terminator in this buffer) no frame can
+     * lie in the released buffer, and rx_line_off is already placed. */
+    if (0U == cell->rx_line_len) {
+        cell->rx_line_off = 0U;
+        if (rescue) {
+            (void)memcpy(cell->rx_line, &buf[cell->rx_span.offset],
+                         cell->rx_span.len);
+            cell->rx_span.buf = cell->rx_line;
+            cell->rx_span.offset = 0U;
+            cell->rx_span.src = DIVEO2_RX_SRC_STITCH;
+            cell->rx_line_off = cell->rx_span.len;
+        } else if (keep && (DIVEO2_RX_SRC_STITCH == cell->rx_span.src) &&
+                   ((cell->rx_span.offset + cell->rx_span.len +
+                     cell->rx_frag_len) < DIVEO2_RX_BUFFER_LEN)) {
+            cell->rx_line_off = cell->rx_span.offset + cell->rx_span.len;
+        } else {
+            /* The head overwrites rx_line from the start. */
+            keep = false;
+        }
+    }
+    if (keep && (DIVEO2_RX_SRC_STITCH == cell->rx_span.src)) {
+        cell->rx_span.gen = atomic_get(&cell->rx_gen[DIVEO2_RX_SRC_STITCH]);
+    }
+
+    if (save_head) {
+        size_t head_end = cell->rx_line_off + cell->rx_line_len;
+
+        if ((head_end + cell->rx_frag_len) < DIVEO2_RX_BUFFER_LEN) {
+            (void)memcpy(&cell->rx_line[head_end],
+                         &buf[cell->rx_frag_off], cell->rx_frag_len);
+            cell->rx_line_len += cell->rx_frag_len;
         } else {
-            /* Overrun (no terminator within a frame) — drop and resync. */
             cell->rx_line_len = 0U;
         }
     }
+    cell->rx_frag_buf = NULL;
+    cell->rx_frag_len = 0U;
+}
+
+/**
+ * @brief Forget any partial frame and invalidate every published view.
+ *
+ * Must run with the callback excluded (from the callback itself or under
+ * irq_lock).
+ *
+ * @param cell  Cell state whose framing state is reset.
+ */
+static void diveo2_reset_framing(struct diveo2_cell_state *cell)
+{
+    cell->rx_frag_buf = NULL;
+    cell->rx_frag_len = 0U;
+    cell->rx_line_off = 0U;
+    cell->rx_line_len = 0U;
+    for (uint8_t i = 0U; i < DIVEO2_RX_SRC_COUNT; ++i) {
+        (void)atomic_inc(&cell->rx_gen[i]);
+    }
 }
 
 /**
@@ -614,11 +862,11 @@ static void diveo2_feed_rx(struct diveo2_cell_state *cell,
  * Factored out of the UART callback's switch case to keep the case body
  * short (S1151).
  *
- * @param cell  Cell state whose RX line accumulator/buffer are reset.
+ * @param cell  Cell state whose framing state/buffer are reset.
  */
 static void diveo2_rearm_rx(struct diveo2_cell_state *cell)
 {
-    cell->rx_line_len = 0U;
+    diveo2_reset_framing(cell);
     cell->rx_active = 0U;
     (void)uart_rx_enable(cell->uart_dev, cell->rx_buf[0],
                          DIVEO2_RX_BUFFER_LEN,
@@ -629,9 +877,10 @@ static void diveo2_rearm_rx(struct diveo2_cell_state *cell)
  * @brief UART async callback for the DiveO2 cell driver.
  *
  * RX is kept continuously enabled (double-buffered) so a broadcast stream is
- * never re-synced mid-frame. On UART_RX_RDY bytes are accumulated into a line
- * buffer and a complete CR/LF-delimited frame wakes the cell thread. On
- * UART_RX_BUF_REQUEST the spare buffer is handed back so reception never stops;
+ * never re-synced mid-frame. On UART_RX_RDY the new bytes are framed in place
+ * and a complete CR/LF-delimited frame wakes the cell thread. On
+ * UART_RX_BUF_REQUEST the spare buffer is handed back so reception never
+ * stops; UART_RX_BUF_RELEASED carries a split frame's head across the swap;
  * UART_RX_DISABLED (buffer exhaustion / error) re-enables RX.
  *
  * @param dev        UART device (unused; Zephyr callback contract).
@@ -654,9 +903,10 @@ static void diveo2_uart_callback(const struct device *dev,
         break;
     case UART_RX_BUF_REQUEST:
         /* Supply the spare buffer so async RX double-buffers and never stops. */
-        cell->rx_active ^= 1U;
-        (void)uart_rx_buf_rsp(dev, cell->rx_buf[cell->rx_active],
-                              DIVEO2_RX_BUFFER_LEN);
+        diveo2_request_rx(cell, dev);
+        break;
+    case UART_RX_BUF_RELEASED:
+        diveo2_release_rx(cell, evt->data.rx_buf.buf);
         break;
     case UART_RX_DISABLED:
         /* Should not happen in steady state; re-arm to recover. */
@@ -776,6 +1026,7 @@ static void diveo2_broadcast(struct diveo2_cell_state *cell)
         .millivolts = 0U,
         .status = cell->status,
         .timestamp_ticks = k_uptime_ticks(),
+        .sample_seq = latency_trace_next_seq(),
         .raw_sample = cell->raw_ppo2_millihpa,
         .temperature_mc = cell->temperature_mc,
         .err_code = cell->err_code,
@@ -876,22 +1127,24 @@ static void diveo2_apply_simple(struct diveo2_cell_state *cell,
 }
 
 /**
- * @brief Clean and parse the last received UART message, updating cell state.
+ * @brief Parse a received frame in place, updating cell state.
  *
  * Attempts the detailed (#?RAW) format first, falls back to simple (#?OXY),
  * accepting either the DiveO2 ('D') or Pyroscience ('M') prefix. On a valid
  * measurement the cell's protocol family is latched from the message prefix.
- * Backs off briefly on parse failure to avoid flooding logs.
+ * The frame is parsed straight out of the RX storage; the result is only
+ * applied if that storage was not reused meanwhile.
  *
- * @param cell  Cell state containing last_message and per-cell fields to update.
+ * @param cell  Cell state whose per-cell fields are updated.
+ * @param span  Snapshot of the frame published by the UART callback.
  * @return true if a valid measurement frame was parsed and applied.
  */
-static bool diveo2_process_rx(struct diveo2_cell_state *cell)
+static bool diveo2_process_rx(struct diveo2_cell_state *cell,
+                              const DiveO2RxSpan_t *span)
 {
-    char msgArray[DIVEO2_RX_BUFFER_LEN] = {0};
-
-    (void)diveo2_prepare_message_buffer(
-        cell->last_message, msgArray, sizeof(msgArray));
+    size_t msg_len = 0U;
+    const char *msg = diveo2_frame_view(&span->buf[span->offset], span->len,
+                                        &msg_len);
 
     DiveO2DetailedReading_t reading = {0};
     int32_t raw_ppo2_millihpa = 0;
@@ -900,15 +1153,25 @@ static bool diveo2_process_rx(struct diveo2_cell_state *cell)
     bool valid = false;
 
     /* Try detailed response first, then simple */
-    if (diveo2_parse_detailed_response(msgArray, &reading)) {
+    bool detailed = diveo2_parse_detailed_response(msg, msg_len, &reading);
+    bool simple = (!detailed) &&
+                  diveo2_parse_simple_response(msg, msg_len, &raw_ppo2_millihpa,
+                                               &temp_mc, &rx_status);
+    CellProtocol_t proto = diveo2_detect_protocol(msg, msg_len);
+
+    if (!diveo2_rx_span_intact(cell, span)) {
+        /* The DMA (or the next split frame) reused the bytes while they were
+         * being parsed, so whatever was read may mix two frames. Drop it
+         * without a verdict: the next frame replaces it, and a persistent
+         * loss still trips the diveo2_broadcast staleness timeout. */
+        LOG_DBG("Cell %u: frame overwritten during parse", cell->cell_number);
+    } else if (detailed) {
         diveo2_apply_detailed(cell, &reading);
         valid = true;
-    } else if (diveo2_parse_simple_response(msgArray, &raw_ppo2_millihpa,
-                                            &temp_mc,
-                                            &rx_status)) {
+    } else if (simple) {
         diveo2_apply_simple(cell, raw_ppo2_millihpa, temp_mc, rx_status);
         valid = true;
-    } else if (diveo2_is_measurement(msgArray)) {
+    } else if (diveo2_is_measurement(msg, msg_len)) {
         /* Right measurement header (#?RAW / #?OXY) but neither parser accepted
          * it: a field is missing, non-numeric, or truncated. This is a genuine
          * reception fault — surface it as CELL_FAIL for THIS cycle rather than
@@ -919,8 +1182,13 @@ static bool diveo2_process_rx(struct diveo2_cell_state *cell)
          * A parsing problem must be VISIBLE as a fail, never a wrong reading. */
         cell->status = CELL_FAIL;
         OP_ERROR(OP_ERR_CELL_FAILURE);
+
+        /* Only this rare path copies the frame, to log it as a string. */
+        char text[DIVEO2_RX_BUFFER_LEN] = {0};
+
+        (void)memcpy(text, msg, MIN(msg_len, sizeof(text) - 1U));
         LOG_WRN("Cell %u: malformed measurement: %s",
-                cell->cell_number, msgArray);
+                cell->cell_number, text);
     } else {
         /* Not a measurement (e.g. an #ERRO from the wrong-family probe, or a
          * #BCST command echo) — let the caller decide whether to retry/re-detect.
@@ -929,13 +1197,13 @@ static bool diveo2_process_rx(struct diveo2_cell_state *cell)
          * LOG_DBG, not LOG_WRN: command echoes arrive on EVERY broadcast toggle,
          * and a warning here lands in the flash log + UDS log-push every time,
          * flooding the log/flash path (and starving fl_writer) during toggling. */
-        LOG_DBG("Cell %u: unknown message: %s",
-                cell->cell_number, msgArray);
+        LOG_DBG("Cell %u: unknown %u-byte message",
+                cell->cell_number, (unsigned int)msg_len);
     }
 
     if (valid) {
         /* Latch the protocol family from the first valid frame. */
-        cell->protocol = diveo2_detect_protocol(msgArray);
+        cell->protocol = proto;
     }
 
     return valid;
@@ -945,7 +1213,7 @@ static bool diveo2_process_rx(struct diveo2_cell_state *cell)
  * @brief Drop any stale frame and partial line so the next wait gets a fresh one.
  *
  * RX stays continuously enabled (see diveo2_setup); this only clears the
- * completion semaphore and the in-progress line accumulator. Use before a
+ * completion semaphore and the in-progress framing state. Use before a
  * polled request so the response — not a leftover broadcast frame — is matched.
  *
  * @param cell  Cell state.
@@ -954,7 +1222,7 @@ static void diveo2_rx_sync(struct diveo2_cell_state *cell)
 {
     unsigned int key = irq_lock();
 
-    cell->rx_line_len = 0U;
+    diveo2_reset_framing(cell);
     irq_unlock(key);
     k_sem_reset(&cell->rx_sem);
 }
@@ -962,9 +1230,9 @@ static void diveo2_rx_sync(struct diveo2_cell_state *cell)
 /**
  * @brief Wait up to @p timeout_ms for a complete UART frame, then parse it.
  *
- * RX is always enabled; the callback delivers a CR/LF-delimited frame via the
- * semaphore. On timeout the line accumulator is cleared so a future partial
- * does not prepend to the next frame.
+ * RX is always enabled; the callback publishes a CR/LF-delimited frame and
+ * gives the semaphore. The frame descriptor is snapshotted under irq_lock so
+ * a frame completing mid-parse cannot change it underneath the parser.
  *
  * @param cell        Cell state.
  * @param timeout_ms  Maximum time to wait for the next frame.
@@ -975,7 +1243,11 @@ static bool diveo2_wait_frame(struct diveo2_cell_state *cell, int32_t timeout_ms
     bool valid = false;
 
     if (0 == k_sem_take(&cell->rx_sem, K_MSEC(timeout_ms))) {
-        valid = diveo2_process_rx(cell);
+        unsigned int key = irq_lock();
+        DiveO2RxSpan_t span = cell->rx_span;
+
+        irq_unlock(key);
+        valid = diveo2_process_rx(cell, &span);
     } else {
         OP_ERROR(OP_ERR_TIMEOUT);
     }
@@ -1210,7 +1482,7 @@ static bool diveo2_setup(struct diveo2_cell_state *cell)
     cell->protocol = CELL_PROTO_UNKNOWN;
     cell->mode = CELL_MODE_POLLED;
     cell->detect_phase = 0U;
-    cell->rx_line_len = 0U;
+    diveo2_reset_framing(cell);
     cell->rx_active = 0U;
     (void)atomic_set(&cell->broadcast_req, BCST_REQ_NONE);
 
@@ -1256,6 +1528,7 @@ static bool diveo2_setup(struct diveo2_cell_state *cell)
             .millivolts = 0U,
             .status = cell->status,
             .timestamp_ticks = k_uptime_ticks(),
+            .sample_seq = 0U,
             .raw_sample = 0,
             .temperature_mc = 0,
             .err_code = 0U,
@@ -1377,11 +1650,12 @@ __maybe_unused static void diveo2_cell_thread(void *p1, void *p2, void *p3)
  * a comfortable margin (the deepest path — a parser OP_ERROR + its
  * error-histogram/logging chain on a header mismatch — is now removed from the
  * hot echo path, so 1536 leaves ~600 B over the observed 928 B peak while still
- * fitting the STM32L431's tight RAM). */
+ * fitting the STM32L431's tight RAM). Frames are now parsed in place, so the
+ * msgArray/msgCopy pair is gone from that chain too; the size is left as is. */
 #define DIVEO2_THREAD_STACK_SIZE 1536
 
-/* rx_buf/rx_active/rx_line/rx_line_len/tx_buf/rx_len below are all
- * re-established by diveo2_setup() before first use on every (re)start;
+/* The rx_buf/rx_frag/rx_line/rx_gen/rx_span framing state and tx_buf below
+ * are all re-established by diveo2_setup() before first use on every (re)start;
  * zero-initialised here purely to satisfy explicit-struct-init (S6871).
  * The embedded semaphores use Zephyr's initializer because their internal
  * aggregate layout is configuration-dependent. */
@@ -1405,15 +1679,19 @@ static struct diveo2_cell_state diveo2_cell_1 = {
     .ambient_pressure_ubar = 0,
     .housing_humidity_mpercent_rh = 0,
     .last_ppo2_ticks = 0,
-    .last_message = {0},
     .rx_buf = {{0}, {0}},
     .rx_active = 0U,
+    .rx_frag_buf = NULL,
+    .rx_frag_off = 0U,
+    .rx_frag_len = 0U,
     .rx_line = {0},
+    .rx_line_off = 0U,
     .rx_line_len = 0U,
+    .rx_gen = {ATOMIC_INIT(0), ATOMIC_INIT(0), ATOMIC_INIT(0)},
+    .rx_span = {0},
     .tx_buf = {0},
     .rx_sem = Z_SEM_INITIALIZER(diveo2_cell_1.rx_sem, 0, 1),
     .tx_sem = Z_SEM_INITIALIZER(diveo2_cell_1.tx_sem, 1, 1),
-    .rx_len = 0U,
     .out_chan = &chan_cell_1,
 };
 K_THREAD_DEFINE(diveo2_thread_1, DIVEO2_THREAD_STACK_SIZE,
@@ -1440,15 +1718,19 @@ static struct diveo2_cell_state diveo2_cell_2 = {
     .ambient_pressure_ubar = 0,
     .housing_humidity_mpercent_rh = 0,
     .last_ppo2_ticks = 0,
-    .last_message = {0},
     .rx_buf = {{0}, {0}},
     .rx_active = 0U,
+    .rx_frag_buf = NULL,
+    .rx_frag_off = 0U,
+    .rx_frag_len = 0U,
     .rx_line = {0},
+    .rx_line_off = 0U,
     .rx_line_len = 0U,
+    .rx_gen = {ATOMIC_INIT(0), ATOMIC_INIT(0), ATOMIC_INIT(0)},
+    .rx_span = {0},
     .tx_buf = {0},
     .rx_sem = Z_SEM_INITIALIZER(diveo2_cell_2.rx_sem, 0, 1),
     .tx_sem = Z_SEM_INITIALIZER(diveo2_cell_2.tx_sem, 1, 1),
-    .rx_len = 0U,
     .out_chan = &chan_cell_2,
 };
 K_THREAD_DEFINE(diveo2_thread_2, DIVEO2_THREAD_STACK_SIZE,
@@ -1475,15 +1757,19 @@ static struct diveo2_cell_state diveo2_cell_3 = {
     .ambient_pressure_ubar = 0,
     .housing_humidity_mpercent_rh = 0,
     .last_ppo2_ticks = 0,
-    .last_message = {0},
     .rx_buf = {{0}},
     .rx_active = 0U,
+    .rx_frag_buf = NULL,
+    .rx_frag_off = 0U,
+    .rx_frag_len = 0U,
     .rx_line = {0},
+    .rx_line_off = 0U,
     .rx_line_len = 0U,
+    .rx_gen = {ATOMIC_INIT(0), ATOMIC_INIT(0), ATOMIC_INIT(0)},
+    .rx_span = {0},
     .tx_buf = {0},
     .rx_sem = Z_SEM_INITIALIZER(diveo2_cell_3.rx_sem, 0, 1),
     .tx_sem = Z_SEM_INITIALIZER(diveo2_cell_3.tx_sem, 1, 1),
-    .rx_len = 0U,
     .out_chan = &chan_cell_3,
 };
 K_THREAD_DEFINE(diveo2_thread_3, DIVEO2_THREAD_STACK_SIZE,
@@ -6,12 +6,18 @@
  * coefficient computation for each cell type (analog, DiveO2, O2S), and
  * the multi-cell consensus voting algorithm.  No OS dependencies except
  * optional error reporting when CONFIG_ZBUS is defined.
+ *
+ * Consensus has three engines: the pairwise 2/3-cell vote as a float
+ * reference and as a centibar-Q16 integer twin, and the N-sensor sorted-window
+ * voter. CONFIG_CONSENSUS_SORTED_VOTER and CONFIG_PPO2_FIXED_POINT select
+ * which one consensus_calculate() runs.
  */
 
 #include "oxygen_cell_math.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <zephyr/sys/util.h>
 
 #if defined(CONFIG_ZBUS)
 #include "errors.h"
@@ -36,6 +42,50 @@ static const Numeric_t O2S_COEFF_REPORT_SCALE = 1000.0f;
 #endif
 static const uint32_t MBAR_PER_FRACTIONAL_UNIT = 1000U;
 
+/* Fixed-point consensus: PPO2 as int32 centibar in Q16 */
+static const int32_t PPO2_Q_ONE_CB = 65536;                     /**< 1 centibar */
+static const PrecisionPPO2_t PPO2_Q_PER_BAR = 6553600.0f;       /**< 100 cbar in Q16 */
+static const PrecisionPPO2_t PPO2_Q_LIMIT_BAR = 64.0f;
+static const int32_t PPO2_Q_LIMIT = 64 * 6553600;               /**< 4 x limit fits int32 */
+static const int32_t MAX_DEVIATION_Q = (int32_t)MAX_DEVIATION * 65536;
+
+/* Sorted-window voter */
+static const int32_t VOTE_PAD_Q = INT32_MAX;  /**< Sorts unused slots last */
+static const uint8_t VOTE_PAD_IDX = 0xFFU;
+
+/** @brief Consensus engines behind consensus_vote(). */
+typedef enum {
+    VOTE_PAIRWISE_FLOAT = 0,
+    VOTE_PAIRWISE_FIXED,
+    VOTE_SORTED_WINDOW,
+} VoteEngine_t;
+
+#if defined(CONFIG_CONSENSUS_SORTED_VOTER)
+static const VoteEngine_t CONSENSUS_ENGINE = VOTE_SORTED_WINDOW;
+#elif defined(CONFIG_PPO2_FIXED_POINT)
+static const VoteEngine_t CONSENSUS_ENGINE = VOTE_PAIRWISE_FIXED;
+#else
+static const VoteEngine_t CONSENSUS_ENGINE = VOTE_PAIRWISE_FLOAT;
+#endif
+
+BUILD_ASSERT(CELL_MAX_COUNT <= CONSENSUS_MAX_SENSORS,
+             "the sorted voter must cover every cell of a ConsensusMsg_t");
+BUILD_ASSERT(CELL_MAX_COUNT == 3U,
+             "the pairwise engines and their mean helpers take three cells");
+BUILD_ASSERT(CONSENSUS_MAX_SENSORS <= 8U, "included_mask is a uint8_t");
+
+/* Analog filter stage */
+static const int32_t FILTER_IIR_ONE_Q8 = 256;          /**< 1.0 in the IIR's Q8 state */
+static const uint8_t FILTER_IIR_SHIFT_MAX = 8U;        /**< Q8 leaves no bits for more */
+static const int32_t FILTER_NOISE_DIFF_CLAMP = 4095;   /**< Keeps diff^2 in Q4 inside 32 bits */
+static const uint8_t FILTER_NOISE_FRAC_BITS = 4U;
+static const Numeric_t FILTER_NOISE_Q4_ONE = 16.0f;
+static const uint8_t FILTER_NOISE_EMA_SHIFT = 5U;      /**< ~32-sample noise memory */
+static const Numeric_t FILTER_HALF_PI = 1.5707963f;
+static const Numeric_t FILTER_PERMILLE = 1000.0f;
+static const uint32_t FILTER_DSAMPLES_PER_SAMPLE = 10U;
+static const Numeric_t FILTER_NV_PER_CENTI_MV = 10000.0f; /**< COUNTS_TO_MILLIS is 0.01 mV */
+
 /* ---- PPO2 wire-format conversion ---- */
 
 PPO2_t ppo2_centibar_to_wire(PrecisionPPO2_t centibar_ppo2)
@@ -52,6 +102,75 @@ PPO2_t ppo2_centibar_to_wire(PrecisionPPO2_t centibar_ppo2)
 
 /* ---- Internal consensus helpers ---- */
 
+/** Cells of each three-cell pairing, in pairwise_differences[] order. */
+static const uint8_t PAIRWISE_CELLS[3][2] = {{0U, 1U}, {0U, 2U}, {1U, 2U}};
+
+/**
+ * @brief Publish a voted mean, saturating over MAX_VALID_PPO2 to PPO2_FAIL.
+ *
+ * Both pairwise engines publish through this and the consensus_publish_*()
+ * helpers below, so once their votes agree the wire value is the same to
+ * the bit: the fixed-point engine votes in integers but takes the mean it
+ * sends from the cells' own readings, exactly as the float engine does.
+ *
+ * @param consensus Consensus being built
+ * @param centibar  Mean of the included cells in centibar
+ * @param precision Value for precision_consensus (bar)
+ * @return Updated ConsensusMsg_t with consensus_ppo2 and precision_consensus set.
+ */
+static ConsensusMsg_t consensus_publish(ConsensusMsg_t consensus,
+                                        PrecisionPPO2_t centibar,
+                                        PrecisionPPO2_t precision)
+{
+    /* Bug #5 fix: saturate instead of assert */
+    if (centibar > (PrecisionPPO2_t)MAX_VALID_PPO2) {
+#ifdef CONFIG_ZBUS
+        OP_ERROR_DETAIL(OP_ERR_MATH, (uint32_t)centibar);
+#endif
+        consensus.consensus_ppo2 = PPO2_FAIL;
+    } else {
+        consensus.consensus_ppo2 = ppo2_centibar_to_wire(centibar);
+    }
+    consensus.precision_consensus = precision;
+
+    return consensus;
+}
+
+/** @brief Publish the mean of the only two included cells, @p a and @p b (bar). */
+static ConsensusMsg_t consensus_publish_two(ConsensusMsg_t consensus,
+                                            PrecisionPPO2_t a,
+                                            PrecisionPPO2_t b)
+{
+    PrecisionPPO2_t average = ((a + b) / HALF_DIVISOR) * CENTIBAR_PER_BAR;
+
+    return consensus_publish(consensus, average, average / CENTIBAR_PER_BAR);
+}
+
+/** @brief Publish the mean of the pair @p a, @p b left after a three-cell
+ *         vote put the third cell out (bar). */
+static ConsensusMsg_t consensus_publish_pair(ConsensusMsg_t consensus,
+                                             PrecisionPPO2_t a,
+                                             PrecisionPPO2_t b)
+{
+    PrecisionPPO2_t pair_average = (a + b) / HALF_DIVISOR;
+
+    return consensus_publish(consensus, pair_average * CENTIBAR_PER_BAR,
+                             pair_average);
+}
+
+/** @brief Publish the mean of three included cells (bar). */
+static ConsensusMsg_t consensus_publish_three(ConsensusMsg_t consensus,
+                                              PrecisionPPO2_t a,
+                                              PrecisionPPO2_t b,
+                                              PrecisionPPO2_t c)
+{
+    PrecisionPPO2_t total_average = ((a + b + c) / THIRD_DIVISOR) *
+                                    CENTIBAR_PER_BAR;
+
+    return consensus_publish(consensus, total_average,
+                             total_average / CENTIBAR_PER_BAR);
+}
+
 /**
  * @brief Compute consensus PPO2 from exactly two included cells.
  *
@@ -85,20 +204,8 @@ static ConsensusMsg_t two_cell_consensus(ConsensusMsg_t consensus)
         }
     } else {
         /* Get our average */
-        PrecisionPPO2_t average = ((included_values[0] + included_values[1]) /
-                                   HALF_DIVISOR) *
-                                  CENTIBAR_PER_BAR;
-
-        /* Bug #5 fix: saturate instead of assert */
-        if (average > (PrecisionPPO2_t)MAX_VALID_PPO2) {
-#ifdef CONFIG_ZBUS
-            OP_ERROR_DETAIL(OP_ERR_MATH, (uint32_t)average);
-#endif
-            consensus.consensus_ppo2 = PPO2_FAIL;
-        } else {
-            consensus.consensus_ppo2 = ppo2_centibar_to_wire(average);
-        }
-        consensus.precision_consensus = average / CENTIBAR_PER_BAR;
+        consensus = consensus_publish_two(consensus, included_values[0],
+                                          included_values[1]);
     }
 
     return consensus;
@@ -166,37 +273,462 @@ static ConsensusMsg_t three_cell_consensus(ConsensusMsg_t consensus)
               CENTIBAR_PER_BAR) > MAX_DEVIATION) {
         /* Vote out the remainder cell */
         consensus.include_array[remainder_cell[min_index]] = false;
-        PrecisionPPO2_t total_average = pairwise_averages[min_index] * CENTIBAR_PER_BAR;
+        consensus = consensus_publish_pair(
+            consensus,
+            consensus.precision_ppo2_array[PAIRWISE_CELLS[min_index][0]],
+            consensus.precision_ppo2_array[PAIRWISE_CELLS[min_index][1]]);
+    } else {
+        /* All 3 cells are within range, use all 3 */
+        consensus = consensus_publish_three(consensus,
+                                            consensus.precision_ppo2_array[0],
+                                            consensus.precision_ppo2_array[1],
+                                            consensus.precision_ppo2_array[2]);
+    }
 
-        /* Bug #5 fix: saturate instead of assert */
-        if (total_average > (PrecisionPPO2_t)MAX_VALID_PPO2) {
-#ifdef CONFIG_ZBUS
-            OP_ERROR_DETAIL(OP_ERR_MATH, (uint32_t)total_average);
-#endif
-            consensus.consensus_ppo2 = PPO2_FAIL;
+    return consensus;
+}
+
+/* ---- Fixed-point consensus helpers ---- */
+
+/**
+ * @brief Convert a PPO2 in bar to centibar Q16, saturating at +-64 bar.
+ *
+ * Exact for any reading on a 2^-10 bar grid below 2.56 bar; elsewhere the
+ * error is at most half a Q16 step, about 8e-6 cbar, which is the same
+ * order as the float reference's own rounding of the centibar average.
+ *
+ * @param bar PPO2 in bar
+ * @return PPO2 in centibar Q16
+ */
+static int32_t ppo2_bar_to_q(PrecisionPPO2_t bar)
+{
+    int32_t q = -PPO2_Q_LIMIT;
+
+    if (bar >= PPO2_Q_LIMIT_BAR) {
+        q = PPO2_Q_LIMIT;
+    } else if (bar > -PPO2_Q_LIMIT_BAR) {
+        q = (int32_t)lroundf(bar * PPO2_Q_PER_BAR);
+    } else {
+        /* Below range or NaN: saturate low, the cell cannot pass the vote */
+    }
+
+    return q;
+}
+
+/**
+ * @brief Absolute difference of two centibar Q16 values.
+ */
+static int32_t ppo2_q_abs_diff(int32_t a, int32_t b)
+{
+    int32_t diff = a - b;
+
+    if (diff < 0) {
+        diff = -diff;
+    }
+
+    return diff;
+}
+
+/**
+ * @brief Round a weighted mean of centibar Q16 values to the wire value.
+ *
+ * Integer twin of ppo2_centibar_to_wire(): rounds half away from zero like
+ * roundf(), and clamps to [0, MAX_VALID_PPO2].
+ *
+ * @param sum_q Weighted sum of the values, centibar Q16
+ * @param den   Total weight * PPO2_Q_ONE_CB
+ * @return PPO2 in centibar as PPO2_t
+ */
+static PPO2_t ppo2_q_to_wire(int64_t sum_q, int64_t den)
+{
+    PPO2_t wire = 0U;
+
+    if (sum_q > 0) {
+        int64_t centibar = (sum_q + (den / 2)) / den;
+
+        if (centibar > (int64_t)MAX_VALID_PPO2) {
+            wire = MAX_VALID_PPO2;
         } else {
-            consensus.consensus_ppo2 = ppo2_centibar_to_wire(total_average);
+            wire = (PPO2_t)centibar;
         }
-        consensus.precision_consensus = pairwise_averages[min_index];
-    } else {
-        /* All 3 cells are within range, use all 3 */
-        PrecisionPPO2_t total_average =
-            ((consensus.precision_ppo2_array[0] +
-              consensus.precision_ppo2_array[1] +
-              consensus.precision_ppo2_array[2]) /
-             THIRD_DIVISOR) *
-            CENTIBAR_PER_BAR;
-
-        /* Bug #5 fix: saturate instead of assert */
-        if (total_average > (PrecisionPPO2_t)MAX_VALID_PPO2) {
+    }
+
+    return wire;
+}
+
+/**
+ * @brief Voted PPO2 from a weighted sum of included cells.
+ *
+ * @param sum_q     Weighted sum of the included cells, centibar Q16
+ * @param weight    Total weight of the included cells (> 0)
+ * @param precision Receives the mean in bar
+ * @return Wire value, or PPO2_FAIL when the mean is over MAX_VALID_PPO2
+ */
+static PPO2_t ppo2_q_mean(int64_t sum_q, int64_t weight,
+                          PrecisionPPO2_t *precision)
+{
+    int64_t den = weight * PPO2_Q_ONE_CB;
+    PPO2_t wire = PPO2_FAIL;
+
+    /* Same saturation as the float path: average > MAX_VALID_PPO2 fails */
+    if (sum_q > ((int64_t)MAX_VALID_PPO2 * den)) {
 #ifdef CONFIG_ZBUS
-            OP_ERROR_DETAIL(OP_ERR_MATH, (uint32_t)total_average);
+        OP_ERROR_DETAIL(OP_ERR_MATH, (uint32_t)(sum_q / den));
 #endif
-            consensus.consensus_ppo2 = PPO2_FAIL;
+        wire = PPO2_FAIL;
+    } else {
+        wire = ppo2_q_to_wire(sum_q, den);
+    }
+    *precision = (PrecisionPPO2_t)sum_q /
+                 ((PrecisionPPO2_t)weight * PPO2_Q_PER_BAR);
+
+    return wire;
+}
+
+/**
+ * @brief Fixed-point twin of two_cell_consensus().
+ *
+ * @param consensus  Partially populated consensus state; written in place.
+ * @return Updated ConsensusMsg_t with consensus_ppo2 and include_array set.
+ */
+static ConsensusMsg_t two_cell_consensus_q(ConsensusMsg_t consensus)
+{
+    uint8_t included_cells[2] = {0};
+    uint8_t idx = 0U;
+
+    for (uint8_t cellIdx = 0U; cellIdx < CELL_MAX_COUNT; ++cellIdx) {
+        if (consensus.include_array[cellIdx] && (idx < TWO_CELL_PAIR)) {
+            included_cells[idx] = cellIdx;
+            ++idx;
+        }
+    }
+
+    PrecisionPPO2_t a = consensus.precision_ppo2_array[included_cells[0]];
+    PrecisionPPO2_t b = consensus.precision_ppo2_array[included_cells[1]];
+
+    if (ppo2_q_abs_diff(ppo2_bar_to_q(a), ppo2_bar_to_q(b)) >
+        MAX_DEVIATION_Q) {
+        for (uint8_t voteIdx = 0U; voteIdx < CELL_MAX_COUNT; ++voteIdx) {
+            consensus.include_array[voteIdx] = false;
+        }
+    } else {
+        consensus = consensus_publish_two(consensus, a, b);
+    }
+
+    return consensus;
+}
+
+/**
+ * @brief Fixed-point twin of three_cell_consensus().
+ *
+ * Pair averages are kept as pair sums so every comparison stays exact: the
+ * remainder test |c - (a + b) / 2| > MAX_DEVIATION becomes
+ * |2c - (a + b)| > 2 * MAX_DEVIATION. The mean sent is then taken from the
+ * readings themselves, as the float engine takes it.
+ *
+ * @param consensus  Partially populated consensus state; written in place.
+ * @return Updated ConsensusMsg_t with consensus_ppo2 and include_array set.
+ */
+static ConsensusMsg_t three_cell_consensus_q(ConsensusMsg_t consensus)
+{
+    const int32_t q[3] = {
+        ppo2_bar_to_q(consensus.precision_ppo2_array[0]),
+        ppo2_bar_to_q(consensus.precision_ppo2_array[1]),
+        ppo2_bar_to_q(consensus.precision_ppo2_array[2]),
+    };
+    const int32_t pairwise_differences[3] = {
+        ppo2_q_abs_diff(q[0], q[1]),
+        ppo2_q_abs_diff(q[0], q[2]),
+        ppo2_q_abs_diff(q[1], q[2]),
+    };
+    const int32_t pairwise_sums[3] = {
+        q[0] + q[1],
+        q[0] + q[2],
+        q[1] + q[2],
+    };
+    const uint8_t remainder_cell[] = {2U, 1U, 0U};
+
+    int32_t min_difference = pairwise_differences[0];
+    uint8_t min_index = 0U;
+
+    for (uint8_t i = 0U; i < PAIRWISE_COUNT; ++i) {
+        if (pairwise_differences[i] < min_difference) {
+            min_difference = pairwise_differences[i];
+            min_index = i;
+        }
+    }
+
+    uint8_t remainder = remainder_cell[min_index];
+
+    if (min_difference > MAX_DEVIATION_Q) {
+        for (uint8_t voteIdx = 0U; voteIdx < CELL_MAX_COUNT; ++voteIdx) {
+            consensus.include_array[voteIdx] = false;
+        }
+    } else if (ppo2_q_abs_diff(q[remainder] * 2, pairwise_sums[min_index]) >
+               (MAX_DEVIATION_Q * 2)) {
+        consensus.include_array[remainder] = false;
+        consensus = consensus_publish_pair(
+            consensus,
+            consensus.precision_ppo2_array[PAIRWISE_CELLS[min_index][0]],
+            consensus.precision_ppo2_array[PAIRWISE_CELLS[min_index][1]]);
+    } else {
+        consensus = consensus_publish_three(consensus,
+                                            consensus.precision_ppo2_array[0],
+                                            consensus.precision_ppo2_array[1],
+                                            consensus.precision_ppo2_array[2]);
+    }
+
+    return consensus;
+}
+
+/* ---- Sorted-window voter ---- */
+
+/** @brief One sensor in the sorted voter: reading and original position. */
+typedef struct {
+    int32_t q;     /**< PPO2, centibar Q16 */
+    uint8_t idx;   /**< Index into the caller's arrays */
+} VoteKey_t;
+
+/** @brief Optimal 12-comparator, depth-5 sorting network for six keys. */
+static const uint8_t SORT6_NETWORK[12][2] = {
+    {0U, 5U}, {1U, 3U}, {2U, 4U},
+    {1U, 2U}, {3U, 4U},
+    {0U, 3U}, {2U, 5U},
+    {0U, 1U}, {2U, 3U}, {4U, 5U},
+    {1U, 2U}, {3U, 4U},
+};
+BUILD_ASSERT(CONSENSUS_MAX_SENSORS == 6U, "SORT6_NETWORK sorts six keys");
+
+/**
+ * @brief Compare-exchange: order by reading, then by original index, so the
+ *        sort is stable and equal readings keep their input order.
+ */
+static void vote_key_order(VoteKey_t *lo, VoteKey_t *hi)
+{
+    if ((lo->q > hi->q) || ((lo->q == hi->q) && (lo->idx > hi->idx))) {
+        VoteKey_t tmp = *lo;
+
+        *lo = *hi;
+        *hi = tmp;
+    }
+}
+
+/**
+ * @brief True when sorted pair @p a beats pair @p b as the cluster seed at
+ *        an equal gap: the pair whose (lower, higher) original indices come
+ *        first, i.e. the pairwise engine's (0,1), (0,2), (1,2) order.
+ */
+static bool vote_seed_precedes(const VoteKey_t keys[], uint8_t a, uint8_t b)
+{
+    uint8_t a_lo = MIN(keys[a].idx, keys[a + 1U].idx);
+    uint8_t a_hi = MAX(keys[a].idx, keys[a + 1U].idx);
+    uint8_t b_lo = MIN(keys[b].idx, keys[b + 1U].idx);
+    uint8_t b_hi = MAX(keys[b].idx, keys[b + 1U].idx);
+
+    return (a_lo < b_lo) || ((a_lo == b_lo) && (a_hi < b_hi));
+}
+
+/**
+ * @brief Distance of a candidate from the cluster mean, scaled by the
+ *        cluster weight so it stays an exact integer: |q * W - S|.
+ */
+static int64_t vote_distance(int32_t q, int64_t sum_q, int64_t weight)
+{
+    int64_t dist = ((int64_t)q * weight) - sum_q;
+
+    if (dist < 0) {
+        dist = -dist;
+    }
+
+    return dist;
+}
+
+/** @brief Weight of one sorted sensor (1 when the caller gave none). */
+static int64_t vote_weight(const uint8_t weights[], const VoteKey_t *key)
+{
+    return (NULL == weights) ? 1 : (int64_t)weights[key->idx];
+}
+
+/**
+ * @brief True when sorted window [lo, hi] agrees: its tightest adjacent pair
+ *        is within MAX_DEVIATION, and every member lies within MAX_DEVIATION
+ *        of that pair's weighted mean.
+ *
+ * @param seed_out Index of the window's tightest pair, written on success
+ */
+static bool vote_window_agrees(const VoteKey_t keys[], const uint8_t weights[],
+                               uint8_t lo, uint8_t hi, uint8_t *seed_out)
+{
+    uint8_t seed = lo;
+    int32_t seed_gap = keys[lo + 1U].q - keys[lo].q;
+    bool agrees = false;
+
+    for (uint8_t i = lo + 1U; i < hi; ++i) {
+        int32_t gap = keys[i + 1U].q - keys[i].q;
+
+        if ((gap < seed_gap) ||
+            ((gap == seed_gap) && vote_seed_precedes(keys, i, seed))) {
+            seed = i;
+            seed_gap = gap;
+        }
+    }
+
+    if (seed_gap <= MAX_DEVIATION_Q) {
+        int64_t w_lo = vote_weight(weights, &keys[seed]);
+        int64_t w_hi = vote_weight(weights, &keys[seed + 1U]);
+        int64_t sum_q = (w_lo * keys[seed].q) + (w_hi * keys[seed + 1U].q);
+        int64_t weight = w_lo + w_hi;
+
+        agrees = true;
+        for (uint8_t i = lo; agrees && (i <= hi); ++i) {
+            if (vote_distance(keys[i].q, sum_q, weight) >
+                ((int64_t)MAX_DEVIATION_Q * weight)) {
+                agrees = false;
+            }
+        }
+        *seed_out = seed;
+    }
+
+    return agrees;
+}
+
+void consensus_vote_sorted(const PrecisionPPO2_t ppo2_bar[],
+                           const uint8_t weights[],
+                           uint8_t count,
+                           ConsensusVote_t *out)
+{
+    VoteKey_t keys[CONSENSUS_MAX_SENSORS] = {0};
+    uint8_t n = 0U;
+
+    out->ppo2 = PPO2_FAIL;
+    out->precision = (PrecisionPPO2_t)PPO2_FAIL;
+    out->included_mask = 0U;
+    out->confidence = 0U;
+
+    for (uint8_t i = 0U; i < CONSENSUS_MAX_SENSORS; ++i) {
+        bool candidate = (i < count) &&
+                         ((NULL == weights) || (weights[i] > 0U));
+
+        if (candidate) {
+            keys[n].q = ppo2_bar_to_q(ppo2_bar[i]);
+            keys[n].idx = i;
+            ++n;
+        }
+    }
+    for (uint8_t i = n; i < CONSENSUS_MAX_SENSORS; ++i) {
+        keys[i].q = VOTE_PAD_Q;
+        keys[i].idx = VOTE_PAD_IDX;
+    }
+
+    for (uint8_t c = 0U; c < ARRAY_SIZE(SORT6_NETWORK); ++c) {
+        vote_key_order(&keys[SORT6_NETWORK[c][0]], &keys[SORT6_NETWORK[c][1]]);
+    }
+
+    if (1U == n) {
+        /* Nothing to vote against: report it, but voted out */
+        out->ppo2 = ppo2_q_to_wire(keys[0].q, PPO2_Q_ONE_CB);
+        out->precision = ppo2_bar[keys[0].idx];
+    } else if (n >= TWO_CELL_PAIR) {
+        /* Scan every window of neighbouring readings (at most 15 for six
+         * sensors) for the widest one that agrees. Equal widths go to the
+         * smaller spread, then to the seed pair order. */
+        bool found = false;
+        uint8_t best_lo = 0U;
+        uint8_t best_hi = 0U;
+        uint8_t best_seed = 0U;
+        int32_t best_spread = 0;
+
+        for (uint8_t lo = 0U; (lo + 1U) < n; ++lo) {
+            for (uint8_t hi = lo + 1U; hi < n; ++hi) {
+                uint8_t seed = 0U;
+                int32_t spread = keys[hi].q - keys[lo].q;
+
+                if (!vote_window_agrees(keys, weights, lo, hi, &seed)) {
+                    /* Not a candidate */
+                } else if ((!found) ||
+                           ((hi - lo) > (best_hi - best_lo)) ||
+                           (((hi - lo) == (best_hi - best_lo)) &&
+                            ((spread < best_spread) ||
+                             ((spread == best_spread) &&
+                              vote_seed_precedes(keys, seed, best_seed))))) {
+                    found = true;
+                    best_lo = lo;
+                    best_hi = hi;
+                    best_seed = seed;
+                    best_spread = spread;
+                } else {
+                    /* Beaten by an earlier window */
+                }
+            }
+        }
+
+        if (found) {
+            int64_t sum_q = 0;
+            int64_t weight = 0;
+
+            for (uint8_t i = best_lo; i <= best_hi; ++i) {
+                int64_t w = vote_weight(weights, &keys[i]);
+
+                sum_q += w * keys[i].q;
+                weight += w;
+                out->included_mask |= (uint8_t)(1U << keys[i].idx);
+            }
+
+            out->confidence = (uint8_t)((best_hi - best_lo) + 1U);
+            out->ppo2 = ppo2_q_mean(sum_q, weight, &out->precision);
+        }
+    } else {
+        /* No candidates: PPO2_FAIL */
+    }
+}
+
+/**
+ * @brief Vote the included cells of a consensus with the sorted voter.
+ *
+ * The mean is then sent as the pairwise engines send it, from the readings
+ * of the cells the vote kept, so for the same vote the wire value matches
+ * theirs to the bit.
+ *
+ * @param consensus  Partially populated consensus state; written in place.
+ * @return Updated ConsensusMsg_t with consensus_ppo2 and include_array set.
+ */
+static ConsensusMsg_t sorted_window_consensus(ConsensusMsg_t consensus)
+{
+    uint8_t weights[CELL_MAX_COUNT] = {0};
+    uint8_t candidates = 0U;
+    ConsensusVote_t vote = {0};
+
+    for (uint8_t i = 0U; i < CELL_MAX_COUNT; ++i) {
+        weights[i] = consensus.include_array[i] ? 1U : 0U;
+        candidates += weights[i];
+    }
+
+    consensus_vote_sorted(consensus.precision_ppo2_array, weights,
+                          CELL_MAX_COUNT, &vote);
+
+    for (uint8_t i = 0U; i < CELL_MAX_COUNT; ++i) {
+        consensus.include_array[i] = (0U != (vote.included_mask & (1U << i)));
+    }
+    if (vote.confidence > 0U) {
+        const PrecisionPPO2_t *bar = consensus.precision_ppo2_array;
+        PrecisionPPO2_t kept[CELL_MAX_COUNT] = {0};
+        uint8_t n = 0U;
+
+        for (uint8_t i = 0U; i < CELL_MAX_COUNT; ++i) {
+            if (consensus.include_array[i]) {
+                kept[n] = bar[i];
+                ++n;
+            }
+        }
+
+        if (PAIRWISE_COUNT == n) {
+            consensus = consensus_publish_three(consensus, kept[0], kept[1],
+                                                kept[2]);
+        } else if (TWO_CELL_PAIR == candidates) {
+            consensus = consensus_publish_two(consensus, kept[0], kept[1]);
         } else {
-            consensus.consensus_ppo2 = ppo2_centibar_to_wire(total_average);
+            consensus = consensus_publish_pair(consensus, kept[0], kept[1]);
         }
-        consensus.precision_consensus = total_average / CENTIBAR_PER_BAR;
     }
 
     return consensus;
@@ -217,13 +749,15 @@ static ConsensusMsg_t three_cell_consensus(ConsensusMsg_t consensus)
  * @param now_ticks       Current kernel uptime in ticks (k_uptime_ticks()).
  * @param staleness_ticks Maximum age (in ticks) a cell reading may be before
  *                        being excluded from the vote.
+ * @param engine          How two or more included cells are voted.
  * @return ConsensusMsg_t with consensus_ppo2, include_array, confidence, and
  *         per-cell arrays populated.
  */
-ConsensusMsg_t consensus_calculate(const OxygenCellMsg_t cells[],
-                                   uint8_t count,
-                                   int64_t now_ticks,
-                                   int64_t staleness_ticks)
+static ConsensusMsg_t consensus_vote(const OxygenCellMsg_t cells[],
+                                     uint8_t count,
+                                     int64_t now_ticks,
+                                     int64_t staleness_ticks,
+                                     VoteEngine_t engine)
 {
     ConsensusMsg_t consensus = {0};
 
@@ -303,14 +837,25 @@ ConsensusMsg_t consensus_calculate(const OxygenCellMsg_t cells[],
                 consensus.include_array[cellIdx] = false;
             }
         }
+    } else if (VOTE_SORTED_WINDOW == engine) {
+        /* Two or more cells: largest cluster around the tightest pair */
+        consensus = sorted_window_consensus(consensus);
     } else if (TWO_CELL_PAIR == includedCellCount) {
         /* If we have 2 cells, ensure they are within the MAX_DEVIATION
          * (otherwise alarm) */
-        consensus = two_cell_consensus(consensus);
+        if (VOTE_PAIRWISE_FIXED == engine) {
+            consensus = two_cell_consensus_q(consensus);
+        } else {
+            consensus = two_cell_consensus(consensus);
+        }
     } else {
         /* All 3 cells were valid, do a pairwise compare to find the
          * closest two */
-        consensus = three_cell_consensus(consensus);
+        if (VOTE_PAIRWISE_FIXED == engine) {
+            consensus = three_cell_consensus_q(consensus);
+        } else {
+            consensus = three_cell_consensus(consensus);
+        }
     }
 
     consensus.confidence = consensus_confidence(&consensus);
@@ -318,6 +863,42 @@ ConsensusMsg_t consensus_calculate(const OxygenCellMsg_t cells[],
     return consensus;
 }
 
+ConsensusMsg_t consensus_calculate(const OxygenCellMsg_t cells[],
+                                   uint8_t count,
+                                   int64_t now_ticks,
+                                   int64_t staleness_ticks)
+{
+    return consensus_vote(cells, count, now_ticks, staleness_ticks,
+                          CONSENSUS_ENGINE);
+}
+
+ConsensusMsg_t consensus_calculate_float(const OxygenCellMsg_t cells[],
+                                         uint8_t count,
+                                         int64_t now_ticks,
+                                         int64_t staleness_ticks)
+{
+    return consensus_vote(cells, count, now_ticks, staleness_ticks,
+                          VOTE_PAIRWISE_FLOAT);
+}
+
+ConsensusMsg_t consensus_calculate_fixed(const OxygenCellMsg_t cells[],
+                                         uint8_t count,
+                                         int64_t now_ticks,
+                                         int64_t staleness_ticks)
+{
+    return consensus_vote(cells, count, now_ticks, staleness_ticks,
+                          VOTE_PAIRWISE_FIXED);
+}
+
+ConsensusMsg_t consensus_calculate_sorted(const OxygenCellMsg_t cells[],
+                                          uint8_t count,
+                                          int64_t now_ticks,
+                                          int64_t staleness_ticks)
+{
+    return consensus_vote(cells, count, now_ticks, staleness_ticks,
+                          VOTE_SORTED_WINDOW);
+}
+
 /**
  * @brief Count the number of cells that were voted in by consensus_calculate.
  *
@@ -371,6 +952,265 @@ Numeric_t analog_calculate_ppo2(int16_t adc_counts, CalCoeff_t cal_coeff)
     return (Numeric_t)abs(adc_counts) * COUNTS_TO_MILLIS * cal_coeff;
 }
 
+/* ---- Analog filter stage ---- */
+
+/**
+ * @brief Divide rounding half away from zero, so a steady input reads back
+ *        exactly whatever its sign.
+ *
+ * @param num Dividend
+ * @param den Divisor (> 0)
+ * @return Rounded quotient
+ */
+static int32_t filter_div_round(int32_t num, int32_t den)
+{
+    int32_t result = 0;
+
+    if (num >= 0) {
+        result = (num + (den / 2)) / den;
+    } else {
+        result = (num - (den / 2)) / den;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Fold one sample into the input-noise tracker.
+ *
+ * Tracks the running mean of the squared first difference, which for white
+ * noise is twice the sample variance and is insensitive to slow drift.
+ *
+ * @param filter Filter state
+ * @param counts New sample
+ */
+static void filter_track_noise(AnalogFilter_t *filter, int16_t counts)
+{
+    if (filter->primed) {
+        int32_t diff = (int32_t)counts - (int32_t)filter->last_in;
+
+        if (diff > FILTER_NOISE_DIFF_CLAMP) {
+            diff = FILTER_NOISE_DIFF_CLAMP;
+        } else if (diff < -FILTER_NOISE_DIFF_CLAMP) {
+            diff = -FILTER_NOISE_DIFF_CLAMP;
+        } else {
+            /* No action required */
+        }
+
+        uint32_t sq_q4 = (uint32_t)(diff * diff) << FILTER_NOISE_FRAC_BITS;
+
+        filter->diff_sq_q4 = (filter->diff_sq_q4 -
+                              (filter->diff_sq_q4 >> FILTER_NOISE_EMA_SHIFT)) +
+                             (sq_q4 >> FILTER_NOISE_EMA_SHIFT);
+    }
+    filter->last_in = counts;
+}
+
+/**
+ * @brief Median of the filter's full window; the mean of the middle pair
+ *        for an even window.
+ *
+ * @param filter Filter state with cfg.taps samples in the window
+ * @return Median counts
+ */
+static int16_t filter_median(const AnalogFilter_t *filter)
+{
+    int16_t sorted[ANALOG_FILTER_MAX_TAPS] = {0};
+    uint8_t n = filter->cfg.taps;
+
+    /* Insertion sort: at most 16 entries, no recursion, no allocation. */
+    for (uint8_t i = 0U; i < n; ++i) {
+        int16_t v = filter->window[i];
+        uint8_t j = i;
+
+        while ((j > 0U) && (sorted[j - 1U] > v)) {
+            sorted[j] = sorted[j - 1U];
+            --j;
+        }
+        sorted[j] = v;
+    }
+
+    int16_t median = sorted[n / 2U];
+
+    if (0U == (n % 2U)) {
+        median = (int16_t)filter_div_round((int32_t)sorted[(n / 2U) - 1U] +
+                                           (int32_t)sorted[n / 2U], 2);
+    }
+
+    return median;
+}
+
+bool analog_filter_init(AnalogFilter_t *filter, AnalogFilterConfig_t cfg)
+{
+    bool valid = (cfg.taps >= 1U) && (cfg.taps <= ANALOG_FILTER_MAX_TAPS);
+
+    if (ANALOG_FILTER_IIR == cfg.kind) {
+        valid = valid && (cfg.iir_shift >= 1U) &&
+                (cfg.iir_shift <= FILTER_IIR_SHIFT_MAX);
+    } else if ((ANALOG_FILTER_NONE != cfg.kind) &&
+               (ANALOG_FILTER_MEAN != cfg.kind) &&
+               (ANALOG_FILTER_MEDIAN != cfg.kind)) {
+        valid = false;
+    } else {
+        /* No action required */
+    }
+
+    (void)memset(filter, 0, sizeof(*filter));
+    if (valid) {
+        filter->cfg = cfg;
+    } else {
+        filter->cfg.kind = ANALOG_FILTER_NONE;
+        filter->cfg.taps = 1U;
+        filter->cfg.iir_shift = 0U;
+    }
+
+    return valid;
+}
+
+bool analog_filter_push(AnalogFilter_t *filter, int16_t counts, int16_t *out)
+{
+    bool ready = false;
+    int32_t result = counts;
+
+    filter_track_noise(filter, counts);
+    ++filter->samples_in;
+
+    switch (filter->cfg.kind) {
+    case ANALOG_FILTER_MEAN:
+    case ANALOG_FILTER_MEDIAN:
+        filter->window[filter->fill] = counts;
+        ++filter->fill;
+        if (filter->fill >= filter->cfg.taps) {
+            if (ANALOG_FILTER_MEAN == filter->cfg.kind) {
+                int32_t sum = 0;
+
+                for (uint8_t i = 0U; i < filter->cfg.taps; ++i) {
+                    sum += filter->window[i];
+                }
+                result = filter_div_round(sum, (int32_t)filter->cfg.taps);
+            } else {
+                result = filter_median(filter);
+            }
+            filter->fill = 0U;
+            ready = true;
+        }
+        break;
+    case ANALOG_FILTER_IIR:
+        if (filter->primed) {
+            /* y += (x - y) * 2^-shift, truncated symmetrically so the
+             * state cannot creep in one direction. */
+            int32_t delta = ((int32_t)counts * FILTER_IIR_ONE_Q8) - filter->iir_q8;
+
+            if (delta >= 0) {
+                filter->iir_q8 += delta >> filter->cfg.iir_shift;
+            } else {
+                filter->iir_q8 -= (-delta) >> filter->cfg.iir_shift;
+            }
+        } else {
+            filter->iir_q8 = (int32_t)counts * FILTER_IIR_ONE_Q8;
+        }
+        ++filter->fill;
+        if (filter->fill >= filter->cfg.taps) {
+            result = filter_div_round(filter->iir_q8, FILTER_IIR_ONE_Q8);
+            filter->fill = 0U;
+            ready = true;
+        }
+        break;
+    default:
+        ready = true;
+        break;
+    }
+    filter->primed = true;
+
+    if (ready) {
+        ++filter->samples_out;
+        *out = (int16_t)result;
+    }
+
+    return ready;
+}
+
+uint16_t analog_filter_noise_gain_permille(AnalogFilterConfig_t cfg)
+{
+    Numeric_t gain = 1.0f;
+    Numeric_t n = (Numeric_t)cfg.taps;
+
+    switch (cfg.kind) {
+    case ANALOG_FILTER_MEAN:
+        gain = 1.0f / sqrtf(n);
+        break;
+    case ANALOG_FILTER_MEDIAN:
+        /* For two samples the median is their mean. */
+        if (cfg.taps <= 2U) {
+            gain = 1.0f / sqrtf(n);
+        } else {
+            gain = sqrtf(FILTER_HALF_PI / n);
+        }
+        break;
+    case ANALOG_FILTER_IIR:
+    {
+        Numeric_t alpha = 1.0f / (Numeric_t)(1UL << cfg.iir_shift);
+
+        gain = sqrtf(alpha / (2.0f - alpha));
+        break;
+    }
+    default:
+        gain = 1.0f;
+        break;
+    }
+
+    if (gain > 1.0f) {
+        gain = 1.0f;
+    }
+
+    return (uint16_t)roundf(gain * FILTER_PERMILLE);
+}
+
+uint16_t analog_filter_group_delay_dsamples(AnalogFilterConfig_t cfg)
+{
+    uint16_t delay = 0U;
+
+    switch (cfg.kind) {
+    case ANALOG_FILTER_MEAN:
+    case ANALOG_FILTER_MEDIAN:
+        delay = (uint16_t)((cfg.taps - 1U) * (FILTER_DSAMPLES_PER_SAMPLE / 2U));
+        break;
+    case ANALOG_FILTER_IIR:
+        delay = (uint16_t)(((1UL << cfg.iir_shift) - 1UL) * FILTER_DSAMPLES_PER_SAMPLE);
+        break;
+    default:
+        delay = 0U;
+        break;
+    }
+
+    return delay;
+}
+
+void analog_filter_stats(const AnalogFilter_t *filter,
+                         uint32_t sample_period_us,
+                         AnalogFilterStats_t *out)
+{
+    /* diff_sq_q4 / 16 is the mean squared first difference = 2 sigma^2. */
+    Numeric_t sigma_counts = sqrtf((Numeric_t)filter->diff_sq_q4 /
+                                   (FILTER_NOISE_Q4_ONE * 2.0f));
+    Numeric_t input_nv = sigma_counts * COUNTS_TO_MILLIS * FILTER_NV_PER_CENTI_MV;
+    uint16_t gain = analog_filter_noise_gain_permille(filter->cfg);
+    uint16_t delay = analog_filter_group_delay_dsamples(filter->cfg);
+
+    out->kind = filter->cfg.kind;
+    out->taps = filter->cfg.taps;
+    out->iir_shift = filter->cfg.iir_shift;
+    out->samples_in = filter->samples_in;
+    out->samples_out = filter->samples_out;
+    out->sample_period_us = sample_period_us;
+    out->input_noise_nv = (uint32_t)roundf(input_nv);
+    out->output_noise_nv = (uint32_t)roundf((input_nv * (Numeric_t)gain) / FILTER_PERMILLE);
+    out->noise_gain_permille = gain;
+    out->group_delay_dsamples = delay;
+    out->group_delay_us = (uint32_t)(((uint64_t)delay * sample_period_us) /
+                                     FILTER_DSAMPLES_PER_SAMPLE);
+}
+
 /* ---- Calibration math ---- */
 
 /**
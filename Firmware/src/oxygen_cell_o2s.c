@@ -27,6 +27,7 @@
 #include "calibration_store.h"
 #include "errors.h"
 #include "heartbeat.h"
+#include "latency_trace.h"
 
 #include <zephyr/sys/printk.h>
 #include <string.h>
@@ -322,6 +323,7 @@ static void o2s_broadcast(struct o2s_cell_state *cell)
         .millivolts = 0U,
         .status = cell->status,
         .timestamp_ticks = k_uptime_ticks(),
+        .sample_seq = latency_trace_next_seq(),
         .raw_sample = 0,
         .temperature_mc = 0,
         .err_code = 0U,
@@ -496,6 +498,7 @@ static bool o2s_setup(struct o2s_cell_state *cell)
             .millivolts = 0U,
             .status = cell->status,
             .timestamp_ticks = k_uptime_ticks(),
+            .sample_seq = 0U,
             .raw_sample = 0,
             .temperature_mc = 0,
             .err_code = 0U,
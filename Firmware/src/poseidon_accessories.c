@@ -3,6 +3,7 @@
 #include "heartbeat.h"
 #include "errors.h"
 #include "i2c_bus_lock.h"
+#include "i2c1_sched.h"
 #include "common.h"
 #include "device_current.h"
 
@@ -41,7 +42,7 @@ LOG_MODULE_REGISTER(poseidon_accessories, LOG_LEVEL_INF);
 #define BEEP_PATTERN_ALARM 0x02U
 #define BEEP_PATTERN_STOP  0x03U
 
-/* Exponential-backoff-with-jitter parameters for send_retry(): a fixed retry
+/* Exponential-backoff-with-jitter parameters for every frame: a fixed retry
  * delay can livelock against the external Poseidon masters we share i2c1 with,
  * so the gap grows (BASE << attempt) and is de-phased by cycle-counter jitter. */
 #define POSEIDON_RETRY_BASE_MS 2U
@@ -372,18 +373,16 @@ static struct i2c_target_config target_cfg = {
     .callbacks = &target_cb,
 };
 
-/**
- * Send one Poseidon frame while the caller owns i2c1_bus_lock().
- *
- * Keeping locking at the group level prevents the ADS sampler from inserting a
- * 60+ ms synchronous conversion between two frames in a heartbeat/output group.
- */
 /* Index of the CRC byte within the 4-byte outbound frame ([CMD, LEN, DATA, CRC]). */
 static const size_t POSEIDON_FRAME_CRC_IDX = 3U;
-/* Tries of (quiet-wait + transfer) attempted by i2c1_transact() before it
- * falls back to bus recovery — see send_frame() below. */
+/* Tries of (quiet-wait + transfer) per frame before the i2c1 scheduler falls
+ * back to bus recovery and one final try. */
 static const uint8_t POSEIDON_SEND_ATTEMPTS = 3U;
+/* The fire-synchronous current read is only useful while the solenoid is
+ * still on; later than this the periodic solicit is as good. */
+static const uint16_t POSEIDON_TRIGGER_DEADLINE_MS = 20U;
 
+/** Send one Poseidon frame. Runs while the bus is held for it. */
 static Status_t send_frame_locked(uint8_t addr, uint8_t cmd, uint8_t data)
 {
     uint8_t frame[4] = {cmd, 0x02U, data, 0};
@@ -393,9 +392,15 @@ static Status_t send_frame_locked(uint8_t addr, uint8_t cmd, uint8_t data)
     return i2c_write(bus, frame, sizeof(frame), addr);
 }
 
-/* i2c1_transact adapter — send one Poseidon frame; the bus lock is held by
- * i2c1_transact, which also does the quiet-wait / retry / recover. */
-struct pos_frame { uint8_t addr; uint8_t cmd; uint8_t data; };
+/* One outbound Poseidon frame, as handed to the i2c1 scheduler. */
+struct pos_frame {
+    uint8_t addr;
+    uint8_t cmd;
+    uint8_t data;
+};
+
+/* i2c1 transfer callback — send one Poseidon frame; the scheduler does the
+ * quiet-wait / retry / recover around it. */
 static Status_t send_frame_xfer(void *ctx)
 {
     const struct pos_frame *f = (const struct pos_frame *)ctx;
@@ -403,16 +408,56 @@ static Status_t send_frame_xfer(void *ctx)
     return send_frame_locked(f->addr, f->cmd, f->data);
 }
 
+/** Describe one frame for the i2c1 scheduler; the peer address is the merge key. */
+static I2c1Txn_t frame_txn(struct pos_frame *f, uint8_t priority, uint16_t deadline_ms)
+{
+    I2c1Txn_t txn = I2C1_TXN(send_frame_xfer, f, I2C1_CLIENT_POSEIDON, priority,
+                             f->addr, POSEIDON_SEND_ATTEMPTS,
+                             POSEIDON_RETRY_BASE_MS, POSEIDON_RETRY_JITTER_MS,
+                             deadline_ms);
+    return txn;
+}
+
 /* Multimaster-safe single Poseidon frame via the shared avoid+retry+recover
- * path. The grouped command sequences (heartbeat/refresh, shutdown) instead hold
- * i2c1_bus_lock() across several send_retry_locked() frames for ordering, and
- * recover through the same i2c1_bus_recover() on failure. */
+ * path. */
 static Status_t send_frame(uint8_t addr, uint8_t cmd, uint8_t data)
 {
     struct pos_frame f = { addr, cmd, data };
+    I2c1Txn_t txn = frame_txn(&f, I2C1_PRIO_ACCESSORY, 0U);
+
+    return i2c1_sched_run(&txn);
+}
 
-    return i2c1_transact(send_frame_xfer, &f, POSEIDON_SEND_ATTEMPTS,
-                 POSEIDON_RETRY_BASE_MS, POSEIDON_RETRY_JITTER_MS);
+/**
+ * Send a command sequence strictly in order: each frame is acknowledged (or
+ * has exhausted its retries) before the next goes out, and consecutive frames
+ * to one peer share a bus hold. Retry backoff is spent off the bus, so a
+ * collision storm on one frame no longer delays other i2c1 clients.
+ *
+ * @param frames Frames, in order
+ * @param txns   Scratch descriptors, one per frame; each .result holds that
+ *               frame's outcome afterwards
+ * @param count  Number of frames
+ */
+static void send_group(struct pos_frame *frames, I2c1Txn_t *txns, size_t count)
+{
+    for (size_t i = 0U; i < count; ++i) {
+        txns[i] = frame_txn(&frames[i], I2C1_PRIO_ACCESSORY, 0U);
+    }
+    (void)i2c1_sched_run_batch(txns, count);
+}
+
+/** First failure among txns[from .. from + count), or 0. */
+static Status_t group_result(const I2c1Txn_t *txns, size_t from, size_t count)
+{
+    Status_t rc = 0;
+
+    for (size_t i = from; i < (from + count); ++i) {
+        if ((rc == 0) && (txns[i].result != 0)) {
+            rc = txns[i].result;
+        }
+    }
+    return rc;
 }
 
 bool poseidon_gauge_voltage_byte(uint8_t *value)
@@ -490,33 +535,13 @@ static bool poseidon_current_provider(int32_t *out_ua, uint32_t *age_ms)
     return seen;
 }
 
-static Status_t send_retry_locked(uint8_t addr, uint8_t cmd, uint8_t data)
-{
-    Status_t rc = -EIO;
-    bool sent = false;
-
-    uint8_t attempt = 0U;
-    while ((attempt < POSEIDON_SEND_ATTEMPTS) && (!sent)) {
-        rc = send_frame_locked(addr, cmd, data);
-        if (rc == 0) {
-            sent = true;
-        } else {
-            uint32_t delay_ms = (uint32_t)POSEIDON_RETRY_BASE_MS << attempt;
-            uint32_t jitter_ms = k_cycle_get_32() % POSEIDON_RETRY_JITTER_MS;
-            uint32_t total_delay_ms = delay_ms + jitter_ms;
-            (void)k_msleep((int32_t)total_delay_ms);
-        }
-        ++attempt;
-    }
-    /* Retries exhausted inside a group lock: a multimaster wedge that won't
-     * self-clear. Recover (recursive lock — same thread) and try once more so a
-     * grouped command sequence isn't dropped by a transient collision. Shares
-     * i2c1_bus_recover() with the single-frame i2c1_transact() path. */
-    if ((!sent) && i2c1_error_is_retryable(rc) && (i2c1_bus_recover() == 0)) {
-        rc = send_frame_locked(addr, cmd, data);
-    }
-    return rc;
-}
+/* refresh_outputs(): frames in the first group addressed to the HUD, and the
+ * most frames the battery tail (init, LED, speaker) can hold. The tail reuses
+ * the first group's descriptors, so it must not be longer. */
+#define REFRESH_HUD_FRAMES 3U
+#define REFRESH_BATTERY_TAIL_MAX 3U
+BUILD_ASSERT(REFRESH_BATTERY_TAIL_MAX <= (REFRESH_HUD_FRAMES + 1U),
+             "battery tail must fit the first group's descriptors");
 
 static void refresh_outputs(AlarmMask_t alarms)
 {
@@ -540,36 +565,49 @@ static void refresh_outputs(AlarmMask_t alarms)
         state = POSEIDON_STATE_ON;
         beep = BEEP_PATTERN_ALARM;
     }
-    /* Reserve the controller for the complete Poseidon group. This only blocks
-     * our ADS thread; external masters still arbitrate normally in hardware. */
-    i2c1_bus_lock();
-    Status_t hud_rc = send_retry_locked(HUD_ADDR, POSEIDON_CMD_HEARTBEAT, POSEIDON_HEARTBEAT_NORMAL);
-    uint32_t hud_rc_bits = (uint32_t)hud_rc;
-    hud_rc_bits |= (uint32_t)send_retry_locked(HUD_ADDR, HUD_CMD_VIBRATOR, state);
-    hud_rc_bits |= (uint32_t)send_retry_locked(HUD_ADDR, HUD_CMD_LED, state);
-    hud_rc = (Status_t)hud_rc_bits;
+    /* HUD heartbeat/vibrator/LED, then the battery heartbeat, as one ordered
+     * group. */
+    struct pos_frame frames[] = {
+        { HUD_ADDR, POSEIDON_CMD_HEARTBEAT, POSEIDON_HEARTBEAT_NORMAL },
+        { HUD_ADDR, HUD_CMD_VIBRATOR, state },
+        { HUD_ADDR, HUD_CMD_LED, state },
+        { BATTERY_ADDR, POSEIDON_CMD_HEARTBEAT, POSEIDON_HEARTBEAT_NORMAL },
+    };
+    I2c1Txn_t txns[ARRAY_SIZE(frames)];
+
+    send_group(frames, txns, ARRAY_SIZE(frames));
+    Status_t hud_rc = group_result(txns, 0U, REFRESH_HUD_FRAMES);
+    Status_t battery_rc = txns[REFRESH_HUD_FRAMES].result;
     /* Order per §6.2.2: heartbeat, then the one-shot init, then LED/speaker.
      * Only latch the init once the 0x2D write actually lands, and defer the
      * speaker (0x0E) until the following cycle so the battery has a ~2 s window
      * to complete its DS2782/EEPROM init and master-mode replies first. */
     bool speaker_armed = battery_inited;
-    Status_t battery_rc = send_retry_locked(BATTERY_ADDR, POSEIDON_CMD_HEARTBEAT, POSEIDON_HEARTBEAT_NORMAL);
-    uint32_t battery_rc_bits = (uint32_t)battery_rc;
+    bool init_sent = false;
+    struct pos_frame tail[REFRESH_BATTERY_TAIL_MAX];
+    size_t tail_count = 0U;
+
     if ((!battery_inited) && (battery_rc == 0)) {
-        battery_rc_bits |= (uint32_t)send_retry_locked(BATTERY_ADDR, BATTERY_CMD_INIT, 0x00U);
-        battery_rc = (Status_t)battery_rc_bits;
-        battery_inited = (battery_rc == 0);
+        tail[tail_count] = (struct pos_frame){ BATTERY_ADDR, BATTERY_CMD_INIT, 0x00U };
+        ++tail_count;
+        init_sent = true;
     }
-    battery_rc_bits |= (uint32_t)send_retry_locked(BATTERY_ADDR, BATTERY_CMD_LED, state);
+    tail[tail_count] = (struct pos_frame){ BATTERY_ADDR, BATTERY_CMD_LED, state };
+    ++tail_count;
     if (speaker_armed) {
-        battery_rc_bits |= (uint32_t)send_retry_locked(BATTERY_ADDR, BATTERY_CMD_SPEAKER, beep);
+        tail[tail_count] = (struct pos_frame){ BATTERY_ADDR, BATTERY_CMD_SPEAKER, beep };
+        ++tail_count;
+    }
+    /* Battery writes can enqueue immediate Battery->Display replies; the bus
+     * release after this group starts the ADC quiet-window guard, and a later
+     * target STOP refreshes it again if such a reply arrives. */
+    send_group(tail, txns, tail_count);
+    if (init_sent) {
+        battery_inited = (txns[0].result == 0);
+    }
+    if (battery_rc == 0) {
+        battery_rc = group_result(txns, 0U, tail_count);
     }
-    battery_rc = (Status_t)battery_rc_bits;
-    /* Battery writes can enqueue immediate Battery->Display replies. Start the
-     * ADC quiet-window guard at the end of this group. A later target STOP
-     * refreshes the timestamp again if such a reply arrives. */
-    i2c1_bus_note_activity();
-    i2c1_bus_unlock();
 
     if ((hud_rc != 0) && (!hud_failed)) {
         OP_ERROR_DETAIL(OP_ERR_I2C_BUS, ((uint32_t)HUD_ADDR << 24) |
@@ -589,15 +627,16 @@ static void refresh_outputs(AlarmMask_t alarms)
  * Solicits only the MSB (reg 0x0E): the LSB is essentially unchanged between
  * baseline and fire so it cancels in the current check's fire-baseline delta,
  * and a single write keeps the fire-start bus time minimal. Runs in the caller's
- * (fire-task) context; briefly holds i2c1, bounded by the accessory thread's own
- * sends through the shared mutex. */
+ * (fire-task) context and jumps the accessory queue; if it cannot start within
+ * POSEIDON_TRIGGER_DEADLINE_MS it is dropped rather than sent after the
+ * on-window, so the fire path never waits out another client's retries. */
 static void poseidon_current_trigger(void)
 {
-    i2c1_bus_lock();
-    (void)send_frame_locked(BATTERY_ADDR, POSEIDON_CMD_DS2782_READ,
-                            DS2782_REG_CURRENT);
-    i2c1_bus_note_activity();
-    i2c1_bus_unlock();
+    struct pos_frame f = { BATTERY_ADDR, POSEIDON_CMD_DS2782_READ, DS2782_REG_CURRENT };
+    I2c1Txn_t txn = frame_txn(&f, I2C1_PRIO_URGENT, POSEIDON_TRIGGER_DEADLINE_MS);
+
+    txn.attempts = 1U;
+    (void)i2c1_sched_run(&txn);
 }
 
 /* Actively read the DS2782 CURRENT register when the battery's on-change 0x06
@@ -629,9 +668,8 @@ static void solicit_current(void)
     bool due = (now - last_solicit) >= interval;
     if (stale && due) {
         last_solicit = now;
-        /* Single solicit — go through the unified avoid+retry+recover helper
-         * (locks, quiet-waits, notes activity, recovers) rather than the group
-         * lock path. This is the hot, collision-prone periodic read. */
+        /* Single solicit — the hot, collision-prone periodic read, through
+         * the scheduler's avoid+retry+recover path like every other frame. */
         Status_t rc = send_frame(BATTERY_ADDR, POSEIDON_CMD_DS2782_READ, solicit_reg);
         bool failed_now = (rc != 0);
         if (!failed_now) {
@@ -709,24 +747,25 @@ void poseidon_accessories_shutdown(void)
          * §6.6): turn the controllable loads off first so the peers' final
          * state doesn't depend on the current alarm/actuator state, then send
          * the deliberate shutdown heartbeat (CMD 0x00 data=0x01) to each peer,
-         * Battery last. Each send_retry_locked() blocks until its write
-         * completes, satisfying "wait for ACK before the next frame". We
+         * Battery last. The group sends each frame only once the previous
+         * one has completed, satisfying "wait for ACK before the next frame". We
          * drive only the HUD and Battery here — this head IS the system Head,
          * so it does not address 0x42 (itself). Merely stopping heartbeats is
          * NOT enough: without the explicit shutdown frame the HUD's 120 s
          * watchdog would later fire its LED/vibrator alarm and raise current. */
-        i2c1_bus_lock();
-        (void)send_retry_locked(HUD_ADDR, HUD_CMD_VIBRATOR, POSEIDON_STATE_OFF);       /* vibrator off */
-        (void)send_retry_locked(HUD_ADDR, HUD_CMD_LED, POSEIDON_STATE_OFF);            /* red LED off */
-        (void)send_retry_locked(BATTERY_ADDR, BATTERY_CMD_LED, POSEIDON_STATE_OFF);    /* buddy LED off */
-        (void)send_retry_locked(BATTERY_ADDR, BATTERY_CMD_SPEAKER,
-                                BEEP_PATTERN_STOP);             /* speaker stop */
-        (void)send_retry_locked(HUD_ADDR, POSEIDON_CMD_HEARTBEAT,
-                                POSEIDON_HEARTBEAT_SHUTDOWN);   /* HUD shutdown */
-        (void)send_retry_locked(BATTERY_ADDR, POSEIDON_CMD_HEARTBEAT,
-                                POSEIDON_HEARTBEAT_SHUTDOWN);   /* Battery last */
-        i2c1_bus_note_activity();
-        i2c1_bus_unlock();
+        struct pos_frame frames[] = {
+            { HUD_ADDR, HUD_CMD_VIBRATOR, POSEIDON_STATE_OFF },         /* vibrator off */
+            { HUD_ADDR, HUD_CMD_LED, POSEIDON_STATE_OFF },              /* red LED off */
+            { BATTERY_ADDR, BATTERY_CMD_LED, POSEIDON_STATE_OFF },      /* buddy LED off */
+            { BATTERY_ADDR, BATTERY_CMD_SPEAKER, BEEP_PATTERN_STOP },   /* speaker stop */
+            { HUD_ADDR, POSEIDON_CMD_HEARTBEAT,
+              POSEIDON_HEARTBEAT_SHUTDOWN },                            /* HUD shutdown */
+            { BATTERY_ADDR, POSEIDON_CMD_HEARTBEAT,
+              POSEIDON_HEARTBEAT_SHUTDOWN },                            /* Battery last */
+        };
+        I2c1Txn_t txns[ARRAY_SIZE(frames)];
+
+        send_group(frames, txns, ARRAY_SIZE(frames));
     }
 }
 
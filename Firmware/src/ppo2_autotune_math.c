@@ -412,6 +412,16 @@ bool autotune_identify_plant(const PIDNumeric_t *duty,
                     model->baseline_duty = baseline_duty;
                     model->final_ppo2_bar = final_y;
                     model->final_duty = final_u;
+                    /* The rate gain is taken at the injector-local lobe, so it
+                     * overstates what a dose leaves behind once mixed. Keep the
+                     * settled rise per duty-second for dose planning, falling
+                     * back to the guarded rate gain when the tail sits inside
+                     * the noise. */
+                    PIDNumeric_t settled = (final_y - baseline_ppo2_bar) / dose;
+                    if (settled <= 0.0f) {
+                        settled = gain / autotune_mixing_guard(model);
+                    }
+                    model->settled_gain = settled;
                     model->valid = true;
                     result = true;
                 }
@@ -421,6 +431,20 @@ bool autotune_identify_plant(const PIDNumeric_t *duty,
     return result;
 }
 
+PIDNumeric_t autotune_mixing_guard(const AutotunePlantModel_t *model)
+{
+    PIDNumeric_t guard = 1.0f;
+
+    if (model != NULL) {
+        PIDNumeric_t excursion_guard =
+            1.0f + (model->mixing_excursion_bar /
+                fmaxf(fabsf(model->final_ppo2_bar - model->baseline_ppo2_bar),
+                      0.01f));
+        guard = local_clampf(excursion_guard, 1.0f, 3.0f);
+    }
+    return guard;
+}
+
 bool autotune_model_pid(const AutotunePlantModel_t *model,
             PIDNumeric_t controller_dt_s,
             PIDNumeric_t gain_min, PIDNumeric_t gain_max,
@@ -447,11 +471,7 @@ bool autotune_model_pid(const AutotunePlantModel_t *model,
         if (delay_guard > lambda) {
             lambda = delay_guard;
         }
-        PIDNumeric_t excursion_guard =
-            1.0f + (model->mixing_excursion_bar /
-                fmaxf(fabsf(model->final_ppo2_bar - model->baseline_ppo2_bar),
-                      0.01f));
-        lambda *= local_clampf(excursion_guard, 1.0f, 3.0f);
+        lambda *= autotune_mixing_guard(model);
 
         PIDNumeric_t kc = 1.0f /
             (model->process_gain * (lambda + model->dead_time_s));
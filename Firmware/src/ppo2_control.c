@@ -28,6 +28,7 @@
 
 #include "ppo2_control.h"
 #include "ppo2_control_math.h"
+#include "ppo2_mpc_math.h"
 #include "runtime_settings.h"
 #include "errors.h"
 #include "common.h"
@@ -42,6 +43,7 @@
 #endif
 #include "divecan_types.h"
 #include "solenoid_current.h"
+#include "latency_trace.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/zbus/zbus.h>
@@ -99,13 +101,39 @@ static const uint32_t MK15_ON_TIME_MS = 1500U;
 /** MK15 accumulator-purge off-time (ms). Empirically tuned. */
 static const uint32_t MK15_OFF_TIME_MS = 6000U;
 
+/** MPC consensus sampling step (ms). The planner works from the mean over the
+ *  previous cycle, so the fire thread samples consensus at this cadence while
+ *  it sleeps; also its heartbeat kick interval in MPC mode. */
+static const uint32_t MPC_SAMPLE_STEP_MS = 500U;
+
 /** PID setpoint conversion: centibar (DiveCAN wire format) to bar (PID input). */
 static const PIDNumeric_t CENTIBAR_TO_BAR = 100.0;
 /** Microseconds per millisecond, for k_usleep arguments. */
 static const uint32_t US_PER_MS = 1000U;
+/** Milliseconds per second, for MPC planner on-times. */
+static const PIDNumeric_t MS_PER_S = 1000.0f;
 /** Default PID setpoint (centibar) when chan_setpoint has no published value. */
 static const PPO2_t DEFAULT_SETPOINT_CB = 70U;
 
+/** Plant model the MPC planner starts from until one is supplied through
+ *  ppo2_control_set_plant_model(). Identified by autotune_identify_plant()
+ *  from a 20 % duty step on the "typical" rebreather_model.py profile at
+ *  1.74 bar ambient: a middle-of-the-envelope loop, so the planner's gap
+ *  derating covers the faster, deeper profiles. */
+static const AutotunePlantModel_t MPC_DEFAULT_PLANT_MODEL = {
+    .process_gain = 0.0679f,
+    .dead_time_s = 5.0f,
+    .time_constant_s = 18.0f,
+    .fit_rmse_bar = 0.003f,
+    .mixing_excursion_bar = 0.038f,
+    .baseline_ppo2_bar = 0.698f,
+    .baseline_duty = 0.097f,
+    .final_ppo2_bar = 0.736f,
+    .final_duty = 0.097f,
+    .settled_gain = 0.018f,
+    .valid = true,
+};
+
 /** PPO2 controller thread stack (bytes). Static WCS = 256 B (scripts/wcs.py);
  *  768 B gives ~3× margin. The legacy 2 KiB allocation was inherited from
  *  the FreeRTOS+SD-logging era and is no longer needed. */
@@ -203,6 +231,66 @@ static bool *getConsensusFailedLatch(void)
     return &consensusFailedLatch;
 }
 
+/** Trace of the consensus the PID last acted on. */
+typedef struct {
+    uint32_t sample_to_consensus_us;
+    uint32_t sample_to_control_us;
+    uint32_t sample_seq;       /**< 0 = untraced (boot default, failed read) */
+    int64_t sample_ticks;
+} ControlTrace_t;
+
+/** Written by the PID thread; read by the fire thread and snapshot readers.
+ *  The 64-bit tick stamp would tear on the M4, hence the lock. */
+static struct k_spinlock control_trace_lock;
+
+static ControlTrace_t *getControlTrace(void)
+{
+    static ControlTrace_t controlTrace;
+    return &controlTrace;
+}
+
+static ControlTrace_t read_control_trace(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&control_trace_lock);
+    ControlTrace_t trace = *getControlTrace();
+
+    k_spin_unlock(&control_trace_lock, key);
+    return trace;
+}
+
+/** Record how old the consensus sample is at the moment the PID uses it. A
+ *  consensus with no contributing sample (boot default) leaves the trace at
+ *  0. The first PID update on a new sample also feeds the latency histograms;
+ *  the cycles that reuse it do not. */
+static void record_input_latency(const ConsensusMsg_t *consensus)
+{
+    int64_t now = k_uptime_ticks();
+    ControlTrace_t next = {0};
+
+    if (consensus->sample_ticks > 0) {
+        next.sample_to_consensus_us = latency_trace_ticks_to_us(
+            consensus->consensus_ticks - consensus->sample_ticks);
+        next.sample_to_control_us = latency_trace_ticks_to_us(
+            now - consensus->sample_ticks);
+        next.sample_seq = consensus->sample_seq;
+        next.sample_ticks = consensus->sample_ticks;
+    }
+
+    /* Single writer, so the unlocked read of our own last seq is safe. */
+    if ((0U != next.sample_seq) &&
+        (next.sample_seq != getControlTrace()->sample_seq)) {
+        (void)latency_trace_record_span(LATENCY_STAGE_CONSENSUS_TO_CONTROL,
+                                        consensus->consensus_ticks, now);
+        latency_trace_record(LATENCY_STAGE_SAMPLE_TO_CONTROL,
+                             next.sample_to_control_us);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&control_trace_lock);
+
+    *getControlTrace() = next;
+    k_spin_unlock(&control_trace_lock, key);
+}
+
 /* ---- Snapshot accessor ---- */
 
 void ppo2_control_get_snapshot(PPO2ControlSnapshot_t *out)
@@ -212,6 +300,11 @@ void ppo2_control_get_snapshot(PPO2ControlSnapshot_t *out)
         out->duty_cycle = *getLatestDutyCycle();
         out->integral_state = (Numeric_t)state->integral_state;
         out->saturation_count = state->saturation_count;
+        ControlTrace_t trace = read_control_trace();
+
+        out->sample_to_consensus_us = trace.sample_to_consensus_us;
+        out->sample_to_control_us = trace.sample_to_control_us;
+        out->sample_seq = trace.sample_seq;
     }
 }
 
@@ -303,6 +396,50 @@ Numeric_t ppo2_control_effective_duty(Numeric_t commanded_duty,
     return effective;
 }
 
+/* ---- MPC plant model ---- */
+
+/** Written by whoever identifies the plant; read by the fire thread once per
+ *  cycle. The struct spans several words, hence the lock. */
+static struct k_spinlock plant_model_lock;
+
+static AutotunePlantModel_t *getPlantModel(void)
+{
+    static AutotunePlantModel_t plantModel;
+    return &plantModel;
+}
+
+/** Bumped on every accepted model so the fire thread knows to reseed. */
+static uint32_t *getPlantModelGeneration(void)
+{
+    static uint32_t plantModelGeneration;
+    return &plantModelGeneration;
+}
+
+bool ppo2_control_set_plant_model(const AutotunePlantModel_t *model)
+{
+    bool accepted = false;
+
+    if ((model != NULL) && model->valid && (mpc_dose_gain(model) > 0.0f)) {
+        k_spinlock_key_t key = k_spin_lock(&plant_model_lock);
+
+        *getPlantModel() = *model;
+        ++(*getPlantModelGeneration());
+        k_spin_unlock(&plant_model_lock, key);
+        accepted = true;
+    }
+    return accepted;
+}
+
+void ppo2_control_get_plant_model(AutotunePlantModel_t *out)
+{
+    if (out != NULL) {
+        k_spinlock_key_t key = k_spin_lock(&plant_model_lock);
+
+        *out = *getPlantModel();
+        k_spin_unlock(&plant_model_lock, key);
+    }
+}
+
 /* ---- Helpers ---- */
 
 /**
@@ -489,8 +626,13 @@ static void poll_solenoid_current(void)
  * Subscribes (via periodic read, not zbus subscriber) to chan_consensus,
  * chan_setpoint.  Updates the live PID state, publishes the duty cycle
  * to chan_duty_cycle for the fire-thread, and handles the cell-failure
- * safety transition.  In PPO2CONTROL_OFF or PPO2CONTROL_MK15 mode the
- * thread suspends itself — there is no PID to run.
+ * safety transition.  In PPO2CONTROL_OFF, PPO2CONTROL_MK15 or
+ * PPO2CONTROL_MPC mode the thread suspends itself — there is no PID to run.
+ *
+ * The cadence stays fixed even though consensus is now event-driven: the
+ * gains are tuned per 100 ms step and pid_update() takes no dt. Consensus is
+ * voted as samples arrive, so the input read here is at most one sensor frame
+ * plus one PID period old; record_input_latency() measures it.
  */
 static void ppo2_pid_thread_fn(void *p1, void *p2, void *p3)
 {
@@ -528,6 +670,7 @@ static void ppo2_pid_thread_fn(void *p1, void *p2, void *p3)
             OP_ERROR_DETAIL(OP_ERR_QUEUE, (uint32_t)(-rc));
             consensus.consensus_ppo2 = PPO2_FAIL;
         }
+        record_input_latency(&consensus);
 
         PPO2_t setpoint = read_setpoint_or_default();
 
@@ -658,6 +801,10 @@ static void run_pid_fire_cycle(void)
 {
     bool *depth_skip_latch = getDepthSkipLatch();
 
+    /* Taken before the duty so a PID update landing in between makes the
+     * traced sample older than the duty's, never newer: SAMPLE_TO_FIRE errs
+     * high by at most one PID period. */
+    ControlTrace_t trace = read_control_trace();
     Numeric_t duty = 0.0f;
     /* Bounded read; 0 (no value) fails safe (below the min fire time → no fire)
      * rather than firing on a stale duty. */
@@ -697,8 +844,10 @@ static void run_pid_fire_cycle(void)
         if (rc < 0) {
             OP_ERROR_DETAIL(OP_ERR_SOLENOID_DISABLED, (uint32_t)(-rc));
         }
-#ifdef CONFIG_FLASH_LOG
         else {
+            (void)latency_trace_record_span(LATENCY_STAGE_SAMPLE_TO_FIRE,
+                                            trace.sample_ticks, k_uptime_ticks());
+#ifdef CONFIG_FLASH_LOG
             /* chan_solenoid_fire is flash-log TELEMETRY, published from the fire
              * thread mid-cycle. Deliberately K_NO_WAIT: a dropped log entry is
              * benign (no state/display consequence), whereas a bounded wait here
@@ -707,10 +856,12 @@ static void run_pid_fire_cycle(void)
                 .kind = SOL_FIRE_EVT_INJECT_START,
                 .requested_on_us = timing.on_duration_us,
                 .off_us = timing.off_duration_us,
+                .sample_seq = trace.sample_seq,
+                .sample_ticks = trace.sample_ticks,
             };
             zbus_pub_checked(&chan_solenoid_fire, &fire_evt, K_NO_WAIT);
-        }
 #endif
+        }
         pid_sleep_kicking_us(timing.on_duration_us);
         inject_solenoid_off();
 #ifdef CONFIG_FLASH_LOG
@@ -793,16 +944,22 @@ static void run_mk15_fire_cycle(void)
         if (fire_rc < 0) {
             OP_ERROR_DETAIL(OP_ERR_SOLENOID_DISABLED, (uint32_t)(-fire_rc));
         }
-#ifdef CONFIG_FLASH_LOG
         else {
+            /* MK15 decides on the consensus directly — no PID hop to trace. */
+            (void)latency_trace_record_span(LATENCY_STAGE_SAMPLE_TO_FIRE,
+                                            consensus.sample_ticks,
+                                            k_uptime_ticks());
+#ifdef CONFIG_FLASH_LOG
             const SolenoidFireEvent_t fire_evt = {
                 .kind = SOL_FIRE_EVT_INJECT_START,
                 .requested_on_us = MK15_ON_TIME_MS * US_PER_MS,
                 .off_us = MK15_OFF_TIME_MS * US_PER_MS,
+                .sample_seq = consensus.sample_seq,
+                .sample_ticks = consensus.sample_ticks,
             };
             zbus_pub_checked(&chan_solenoid_fire, &fire_evt, K_NO_WAIT);
-        }
 #endif
+        }
         mk15_sleep_kicking(MK15_ON_TIME_MS);
         inject_solenoid_off();
 #ifdef CONFIG_FLASH_LOG
@@ -819,6 +976,206 @@ static void run_mk15_fire_cycle(void)
     mk15_sleep_kicking(MK15_OFF_TIME_MS);
 }
 
+/** Consensus accumulated over one MPC cycle. Fire-thread-only state. */
+typedef struct {
+    PIDNumeric_t sum_bar;  /**< sum of valid consensus samples */
+    uint32_t samples;      /**< valid samples in sum_bar */
+    bool failed;           /**< a sample this cycle was PPO2_FAIL or unreadable */
+} MpcCycleMean_t;
+
+static MpcCycleMean_t *getMpcCycleMean(void)
+{
+    static MpcCycleMean_t mpcCycleMean;
+    return &mpcCycleMean;
+}
+
+/** Planner state carried between MPC cycles. Fire-thread-only state. */
+static MpcState_t *getMpcState(void)
+{
+    static MpcState_t mpcState;
+    return &mpcState;
+}
+
+/** Model generation the planner state was last seeded from. Starts one
+ *  behind the store so the first cycle always seeds. */
+static uint32_t *getMpcSeededGeneration(void)
+{
+    static uint32_t mpcSeededGeneration = UINT32_MAX;
+    return &mpcSeededGeneration;
+}
+
+/** Copy the current plant model, reseeding the planner if it changed. */
+static AutotunePlantModel_t read_plant_model_for_mpc(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&plant_model_lock);
+    AutotunePlantModel_t model = *getPlantModel();
+    uint32_t generation = *getPlantModelGeneration();
+
+    k_spin_unlock(&plant_model_lock, key);
+
+    if (generation != *getMpcSeededGeneration()) {
+        MpcState_t *state = getMpcState();
+        MpcState_t seeded = {0};
+
+        /* Fresh drift from the new model, but the pulses already fired are
+         * still landing and must stay in the prediction. */
+        mpc_state_init(&seeded, &model);
+        state->drift_bar_s = seeded.drift_bar_s;
+        mpc_state_invalidate(state);
+        *getMpcSeededGeneration() = generation;
+    }
+    return model;
+}
+
+static void mpc_sample_consensus(MpcCycleMean_t *mean)
+{
+    ConsensusMsg_t consensus = {0};
+    Status_t rc = zbus_chan_read(&chan_consensus, &consensus,
+                            K_MSEC(CHAN_OP_TIMEOUT_MS));
+
+    if (0 != rc) {
+        OP_ERROR_DETAIL(OP_ERR_QUEUE, (uint32_t)(-rc));
+        mean->failed = true;
+    }
+    else if (PPO2_FAIL == consensus.consensus_ppo2) {
+        mean->failed = true;
+    }
+    else {
+        mean->sum_bar += consensus.precision_consensus;
+        ++mean->samples;
+    }
+}
+
+/* Sleep total_ms in MPC_SAMPLE_STEP_MS steps, kicking the heartbeat and
+ * servicing the current judge like pid_sleep_kicking_us(), and fold a
+ * consensus sample into @p mean after every step. */
+static void mpc_sleep_sampling_ms(uint32_t total_ms, MpcCycleMean_t *mean)
+{
+    uint32_t remaining = total_ms;
+    while (remaining > 0U) {
+        heartbeat_kick(HEARTBEAT_SOLENOID_FIRE);
+        poll_solenoid_current();
+        uint32_t chunk = MPC_SAMPLE_STEP_MS;
+        if (remaining < MPC_SAMPLE_STEP_MS) {
+            chunk = remaining;
+        }
+        (void)k_msleep((int32_t)chunk);
+        remaining -= chunk;
+        mpc_sample_consensus(mean);
+    }
+}
+
+static void publish_mpc_duty(uint32_t on_ms)
+{
+    Numeric_t duty = (Numeric_t)on_ms / (Numeric_t)SOLENOID_CYCLE_MS;
+
+    *getLatestDutyCycle() = duty;
+    zbus_pub_checked(&chan_duty_cycle, &duty, K_MSEC(CHAN_OP_TIMEOUT_MS));
+}
+
+/**
+ * @brief One MPC-mode fire cycle.
+ *
+ * Plans this cycle's pulse with mpc_plan_pulse() from the consensus averaged
+ * over the previous cycle, fires it at the start of a SOLENOID_CYCLE_MS
+ * cycle and samples consensus for the next plan while it sleeps. A failed
+ * or unreadable consensus anywhere in the averaging window fires nothing
+ * and drops the planner's drift window (the cell-failure rule of the PID
+ * path). Depth compensation is not applied: the planner doses in delivered
+ * on-time against a model identified at the loop's own conditions.
+ */
+static void run_mpc_fire_cycle(void)
+{
+    MpcState_t *state = getMpcState();
+    MpcCycleMean_t *mean = getMpcCycleMean();
+    AutotunePlantModel_t model = read_plant_model_for_mpc();
+
+    ConsensusMsg_t consensus = {0};
+    Status_t rc = zbus_chan_read(&chan_consensus, &consensus,
+                            K_MSEC(CHAN_OP_TIMEOUT_MS));
+
+    if (0 != rc) {
+        /* Same fail-safe as the MK15 path: never plan on a phantom 0.00 bar. */
+        OP_ERROR_DETAIL(OP_ERR_QUEUE, (uint32_t)(-rc));
+        consensus.consensus_ppo2 = PPO2_FAIL;
+    }
+
+    PPO2_t setpoint = read_setpoint_or_default();
+    PIDNumeric_t d_setpoint = (PIDNumeric_t)setpoint / CENTIBAR_TO_BAR;
+
+    /* The first cycle after boot has no window yet — plan on the sample. */
+    PIDNumeric_t measurement = consensus.precision_consensus;
+    if (mean->samples > 0U) {
+        measurement = mean->sum_bar / (PIDNumeric_t)mean->samples;
+    }
+    bool failed = mean->failed || (PPO2_FAIL == consensus.consensus_ppo2);
+    *mean = (MpcCycleMean_t){0};
+
+    if (calibration_is_running()) {
+        /* See run_pid_fire_cycle(): an ownership inhibit, not a solenoid
+         * fault. Calibration gas would read as drift, so restart the window. */
+        inject_solenoid_off();
+        mpc_state_invalidate(state);
+        publish_mpc_duty(0U);
+        mpc_sleep_sampling_ms(SOLENOID_CYCLE_MS, mean);
+        return;
+    }
+
+    PIDNumeric_t on_s = 0.0f;
+    if (failed) {
+        mpc_state_invalidate(state);
+    }
+    else {
+        const MpcLimits_t limits = {
+            .cycle_s = (PIDNumeric_t)SOLENOID_CYCLE_MS / MS_PER_S,
+            .min_on_s = (PIDNumeric_t)SOLENOID_MIN_FIRE_MS / MS_PER_S,
+            .max_on_s = (PIDNumeric_t)SOLENOID_MAX_FIRE_MS / MS_PER_S,
+        };
+        on_s = mpc_plan_pulse(state, &model, d_setpoint, measurement,
+                      k_uptime_get_32(), &limits);
+    }
+
+    uint32_t on_ms = (uint32_t)(on_s * MS_PER_S);
+    publish_mpc_duty(on_ms);
+
+    if (on_ms > 0U) {
+        uint32_t start_ms = k_uptime_get_32();
+        Status_t fire_rc = inject_solenoid_fire(on_ms * US_PER_MS);
+        if (fire_rc < 0) {
+            OP_ERROR_DETAIL(OP_ERR_SOLENOID_DISABLED, (uint32_t)(-fire_rc));
+        }
+        else {
+            /* Only delivered O2 may enter the prediction. */
+            mpc_record_pulse(state, start_ms, on_s);
+            (void)latency_trace_record_span(LATENCY_STAGE_SAMPLE_TO_FIRE,
+                                            consensus.sample_ticks,
+                                            k_uptime_ticks());
+#ifdef CONFIG_FLASH_LOG
+            const SolenoidFireEvent_t fire_evt = {
+                .kind = SOL_FIRE_EVT_INJECT_START,
+                .requested_on_us = on_ms * US_PER_MS,
+                .off_us = (SOLENOID_CYCLE_MS - on_ms) * US_PER_MS,
+                .sample_seq = consensus.sample_seq,
+                .sample_ticks = consensus.sample_ticks,
+            };
+            zbus_pub_checked(&chan_solenoid_fire, &fire_evt, K_NO_WAIT);
+#endif
+        }
+        mpc_sleep_sampling_ms(on_ms, mean);
+        inject_solenoid_off();
+#ifdef CONFIG_FLASH_LOG
+        const SolenoidFireEvent_t end_evt = {
+            .kind = SOL_FIRE_EVT_INJECT_END,
+            .requested_on_us = on_ms * US_PER_MS,
+            .off_us = (SOLENOID_CYCLE_MS - on_ms) * US_PER_MS,
+        };
+        zbus_pub_checked(&chan_solenoid_fire, &end_evt, K_NO_WAIT);
+#endif
+    }
+
+    mpc_sleep_sampling_ms(SOLENOID_CYCLE_MS - on_ms, mean);
+}
+
 #if CONFIG_SOL_FLUSH_TIME > 0
 
 /** Diver-commanded setpoint (centibar) seen at the last flush check.
@@ -849,7 +1206,7 @@ static PPO2_t read_cmd_setpoint(void)
 /**
  * @brief Fire a flush solenoid if the diver-commanded setpoint changed.
  *
- * Called at the start of every fire cycle (PID and MK15). Compares the
+ * Called at the start of every fire cycle (PID, MK15 and MPC). Compares the
  * diver-commanded setpoint against the last-seen value: an increase fires
  * the O2 flush solenoid, a decrease the diluent flush solenoid, each for
  * CONFIG_SOL_FLUSH_TIME ms (a single fire — BUILD_ASSERT-checked against
@@ -947,7 +1304,7 @@ static void run_setpoint_flush_check(void)
 #endif /* CONFIG_SOL_FLUSH_TIME > 0 */
 
 /**
- * @brief Solenoid fire thread — dispatches to PID or MK15 fire cycle by mode.
+ * @brief Solenoid fire thread — dispatches to PID, MK15 or MPC fire cycle by mode.
  *
  * In PPO2CONTROL_OFF mode the thread suspends itself.
  */
@@ -993,6 +1350,9 @@ static void solenoid_fire_thread_fn(void *p1, void *p2, void *p3)
         else if (PPO2CONTROL_MK15 == mode) {
             run_mk15_fire_cycle();
         }
+        else if (PPO2CONTROL_MPC == mode) {
+            run_mpc_fire_cycle();
+        }
         else {
             /* Defensive — should be suspended above. */
             (void)k_msleep((int32_t)SOLENOID_CYCLE_MS);
@@ -1025,6 +1385,7 @@ void ppo2_control_init(void)
 
     *getLatestDutyCycle() = 0.0f;
     *getConsensusFailedLatch() = false;
+    (void)ppo2_control_set_plant_model(&MPC_DEFAULT_PLANT_MODEL);
 
     Numeric_t duty = 0.0f;
     zbus_pub_checked(&chan_duty_cycle, &duty, K_MSEC(CHAN_OP_TIMEOUT_MS));
@@ -1058,6 +1419,9 @@ void ppo2_control_get_snapshot(PPO2ControlSnapshot_t *out)
         out->duty_cycle = 0.0f;
         out->integral_state = 0.0f;
         out->saturation_count = 0U;
+        out->sample_to_consensus_us = 0U;
+        out->sample_to_control_us = 0U;
+        out->sample_seq = 0U;
     }
 }
 void ppo2_control_set_gains_live(Numeric_t kp, Numeric_t ki, Numeric_t kd)
@@ -1094,5 +1458,18 @@ Numeric_t ppo2_control_effective_duty(Numeric_t commanded_duty,
     return 0.0f;
 }
 
+bool ppo2_control_set_plant_model(const AutotunePlantModel_t *model)
+{
+    ARG_UNUSED(model);
+    return false; /* No solenoid on this variant — nothing to plan. */
+}
+
+void ppo2_control_get_plant_model(AutotunePlantModel_t *out)
+{
+    if (out != NULL) {
+        *out = (AutotunePlantModel_t){0};
+    }
+}
+
 
 #endif /* CONFIG_HAS_O2_SOLENOID */
@@ -5,6 +5,9 @@
  * Direct port of updatePID() and the PIDSolenoidFireTask body from the
  * legacy STM32/FreeRTOS firmware.  No kernel/zbus/logging dependencies so
  * the host-side twister test target can exercise the algorithm in isolation.
+ *
+ * The float port is kept as the reference; CONFIG_PPO2_FIXED_POINT routes
+ * pid_update() and pid_compute_fire_timing() to Q24 integer twins.
  */
 
 #include "ppo2_control_math.h"
@@ -27,6 +30,26 @@ static const PIDNumeric_t PPO2_COMPARE_EPSILON_BAR = 0.00001f;
  * a PPO2-control policy, not a general restriction on explicit O2 commands. */
 static const uint16_t SETPOINT_O2_FLUSH_MAX_PRESSURE_MBAR = 2000U;
 
+/* Fixed-point path: values are int64 counts of 2^-24 (Q24). */
+static const uint8_t PID_Q_FRAC_BITS = 24U;
+static const int64_t PID_Q_ONE = 16777216;
+static const int64_t PID_Q_HALF = 8388608;
+static const PIDNumeric_t PID_Q_ONE_F = 16777216.0f;
+/* Inputs saturate here: gains reach PID_GAIN_MAX (100), and 127 x 2^24
+ * still fits the int32 lroundf() returns on the target. */
+static const PIDNumeric_t PID_Q_LIMIT_F = 127.0f;
+static const int64_t PID_Q_LIMIT = 127 * 16777216;
+static const int64_t PID_Q_RESULT_MAX = INT32_MAX;
+/* INTEGRAL_RESET_OVERSHOOT_BAR - PPO2_COMPARE_EPSILON_BAR = 0.19999 bar */
+static const int64_t PID_Q_INTEGRAL_RESET = (16777216LL * 19999LL) / 100000LL;
+static const int64_t PID_Q_MBAR_PER_BAR = 1000;
+
+#if defined(CONFIG_PPO2_FIXED_POINT)
+static const bool PID_FIXED_POINT = true;
+#else
+static const bool PID_FIXED_POINT = false;
+#endif
+
 void pid_state_init(PIDState_t *state, PIDNumeric_t kp,
             PIDNumeric_t ki, PIDNumeric_t kd)
 {
@@ -51,7 +74,7 @@ void pid_state_reset_dynamic(PIDState_t *state)
     }
 }
 
-PIDNumeric_t pid_update(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
+PIDNumeric_t pid_update_float(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
             PIDState_t *state)
 {
     PIDNumeric_t result = 0.0;
@@ -189,7 +212,7 @@ PIDNumeric_t pid_depth_comp_coeff(uint16_t pressure_mbar)
     return result;
 }
 
-FireTiming_t pid_compute_fire_timing(PIDNumeric_t duty,
+FireTiming_t pid_compute_fire_timing_float(PIDNumeric_t duty,
                      uint16_t pressure_mbar,
                      bool depth_comp_enabled,
                      uint32_t total_cycle_ms,
@@ -249,6 +272,254 @@ FireTiming_t pid_compute_fire_timing(PIDNumeric_t duty,
     return timing;
 }
 
+/* ---- Fixed-point path ---- */
+
+/**
+ * @brief Convert to Q24, saturating at +-PID_Q_LIMIT_F.
+ *
+ * Every value the fixed path writes back into PIDState_t is a Q24 value
+ * inside the float mantissa, so the round trip through the state struct
+ * is exact and the integrator cannot drift from the container.
+ */
+static int64_t pid_to_q(PIDNumeric_t value)
+{
+    int64_t result = -PID_Q_LIMIT;
+
+    if (value >= PID_Q_LIMIT_F) {
+        result = PID_Q_LIMIT;
+    }
+    else if (value > -PID_Q_LIMIT_F) {
+        result = (int64_t)lroundf(value * PID_Q_ONE_F);
+    }
+    else {
+        /* Below range or NaN: saturate low */
+    }
+
+    return result;
+}
+
+/** @brief Q24 to float, saturating to the int32 range first. */
+static PIDNumeric_t pid_from_q(int64_t q)
+{
+    int64_t clamped = q;
+
+    if (clamped > PID_Q_RESULT_MAX) {
+        clamped = PID_Q_RESULT_MAX;
+    }
+    else if (clamped < -PID_Q_RESULT_MAX) {
+        clamped = -PID_Q_RESULT_MAX;
+    }
+    else {
+        /* In range */
+    }
+
+    return (PIDNumeric_t)(int32_t)clamped / PID_Q_ONE_F;
+}
+
+/**
+ * @brief a * b >> 24, rounded half away from zero as lroundf() would.
+ *
+ * Operands are bounded by pid_to_q(), so |a * b| < 2^63: 127 x 254 in Q48.
+ */
+static int64_t pid_q_mul(int64_t a, int64_t b)
+{
+    int64_t product = a * b;
+    int64_t result = 0;
+
+    if (product >= 0) {
+        result = (product + PID_Q_HALF) >> PID_Q_FRAC_BITS;
+    }
+    else {
+        result = -((-product + PID_Q_HALF) >> PID_Q_FRAC_BITS);
+    }
+
+    return result;
+}
+
+PIDNumeric_t pid_update_fixed(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
+            PIDState_t *state)
+{
+    PIDNumeric_t result = 0.0f;
+
+    if (state != NULL) {
+        int64_t meas = pid_to_q(measurement);
+        int64_t error = pid_to_q(d_setpoint) - meas;
+        int64_t previousIntegral = pid_to_q(state->integral_state);
+        int64_t integralMax = pid_to_q(state->integral_max);
+        int64_t integralMin = pid_to_q(state->integral_min);
+        bool hardReset = false;
+
+        int64_t pTerm = pid_q_mul(pid_to_q(state->proportional_gain), error);
+        int64_t integral = previousIntegral +
+                   pid_q_mul(pid_to_q(state->integral_gain), error);
+
+        if (error <= -PID_Q_INTEGRAL_RESET)
+        {
+            integral = 0;
+            hardReset = true;
+        }
+
+        if (integral > integralMax)
+        {
+            integral = integralMax;
+            ++state->saturation_count;
+        }
+        else if (integral < integralMin)
+        {
+            integral = integralMin;
+            ++state->saturation_count;
+        }
+        else
+        {
+            state->saturation_count = 0;
+        }
+
+        int64_t dTerm = pid_q_mul(pid_to_q(state->derivative_gain),
+                      pid_to_q(state->derivative_state) - meas);
+        state->derivative_state = measurement;
+
+        int64_t sum = pTerm + dTerm + integral;
+
+        /* Conditional integration, as pid_update_float() */
+        bool drivesHighSaturation = (sum > PID_Q_ONE) && (error > 0);
+        bool drivesLowSaturation = (sum < 0) && (error < 0);
+        if ((!hardReset) && (drivesHighSaturation || drivesLowSaturation)) {
+            integral = previousIntegral;
+            sum = pTerm + dTerm + integral;
+            ++state->saturation_count;
+        }
+
+        state->integral_state = pid_from_q(integral);
+        result = pid_from_q(sum);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Fixed-point twin of apply_depth_compensation(): duty * 1000 / mbar,
+ *        rounded, re-clamped to the hardware minimum.
+ */
+static int64_t apply_depth_compensation_q(int64_t duty,
+                      uint16_t pressure_mbar,
+                      int64_t min_duty,
+                      bool *skipped_out)
+{
+    int64_t result = duty;
+
+    if (0U == pressure_mbar) {
+        *skipped_out = true;
+    }
+    else
+    {
+        *skipped_out = false;
+        result = ((duty * PID_Q_MBAR_PER_BAR) + ((int64_t)pressure_mbar / 2)) /
+             (int64_t)pressure_mbar;
+
+        if (result < min_duty)
+        {
+            result = min_duty;
+        }
+    }
+
+    return result;
+}
+
+FireTiming_t pid_compute_fire_timing_fixed(PIDNumeric_t duty,
+                     uint16_t pressure_mbar,
+                     bool depth_comp_enabled,
+                     uint32_t total_cycle_ms,
+                     uint32_t min_fire_ms,
+                     uint32_t max_fire_ms)
+{
+    FireTiming_t timing = {
+        .should_fire = false,
+        .depth_comp_skipped = false,
+        .on_duration_us = 0U,
+        .off_duration_us = total_cycle_ms * US_PER_MS,
+    };
+
+    /* A zero-length cycle never fires (the float path gets there through
+     * an infinite minimum duty) */
+    if (total_cycle_ms > 0U) {
+        int64_t maximumDutyCycle = ((int64_t)max_fire_ms * PID_Q_ONE) /
+                       (int64_t)total_cycle_ms;
+        int64_t minimumDutyCycle = ((int64_t)min_fire_ms * PID_Q_ONE) /
+                       (int64_t)total_cycle_ms;
+        int64_t dutyCycle = pid_to_q(duty);
+
+        if (dutyCycle > maximumDutyCycle)
+        {
+            dutyCycle = maximumDutyCycle;
+        }
+        if (dutyCycle < 0)
+        {
+            dutyCycle = 0;
+        }
+
+        if (dutyCycle >= minimumDutyCycle)
+        {
+            if (depth_comp_enabled)
+            {
+                dutyCycle = apply_depth_compensation_q(dutyCycle, pressure_mbar,
+                                       minimumDutyCycle,
+                                       &timing.depth_comp_skipped);
+            }
+
+            int64_t cycle_us = (int64_t)total_cycle_ms * (int64_t)US_PER_MS;
+
+            timing.should_fire = true;
+            timing.on_duration_us = (uint32_t)pid_q_mul(cycle_us, dutyCycle);
+            timing.off_duration_us =
+                (uint32_t)pid_q_mul(cycle_us, PID_Q_ONE - dutyCycle);
+        }
+    }
+
+    return timing;
+}
+
+/* ---- Build-selected entry points ---- */
+
+PIDNumeric_t pid_update(PIDNumeric_t d_setpoint, PIDNumeric_t measurement,
+            PIDState_t *state)
+{
+    PIDNumeric_t result = 0.0f;
+
+    if (PID_FIXED_POINT) {
+        result = pid_update_fixed(d_setpoint, measurement, state);
+    }
+    else {
+        result = pid_update_float(d_setpoint, measurement, state);
+    }
+
+    return result;
+}
+
+FireTiming_t pid_compute_fire_timing(PIDNumeric_t duty,
+                     uint16_t pressure_mbar,
+                     bool depth_comp_enabled,
+                     uint32_t total_cycle_ms,
+                     uint32_t min_fire_ms,
+                     uint32_t max_fire_ms)
+{
+    FireTiming_t timing = {0};
+
+    if (PID_FIXED_POINT) {
+        timing = pid_compute_fire_timing_fixed(duty, pressure_mbar,
+                               depth_comp_enabled,
+                               total_cycle_ms,
+                               min_fire_ms, max_fire_ms);
+    }
+    else {
+        timing = pid_compute_fire_timing_float(duty, pressure_mbar,
+                               depth_comp_enabled,
+                               total_cycle_ms,
+                               min_fire_ms, max_fire_ms);
+    }
+
+    return timing;
+}
+
 SetpointFlushDirection_t setpoint_flush_direction(uint8_t previous_cb,
                           uint8_t current_cb)
 {
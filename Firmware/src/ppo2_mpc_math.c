@@ -0,0 +1,339 @@
+/**
+ * @file ppo2_mpc_math.c
+ * @brief Pure-math model-predictive inject pulse planner.
+ *
+ * No kernel / zbus / logging dependencies so the host ztest target can
+ * exercise prediction and planning in isolation.
+ *
+ * Each pulse is treated as a dose delivered at its midpoint. A dose only
+ * shows up at the cells after the plant dead time and then approaches its
+ * settled value with the rise constant derived below. The share of recent
+ * doses the cells have not seen yet is added to the measurement, as is
+ * the drift while they land, to predict the mixed PPO2 once they settle.
+ * The injector-local lobe (the rise/fall reversal the autotune model
+ * measures) is deliberately not modelled: while it inflates the reading
+ * the planner sees PPO2 as higher than it will settle and holds off,
+ * which costs approach speed but not overshoot.
+ */
+
+#include "ppo2_mpc_math.h"
+#include <stddef.h>
+#include <math.h>
+
+/** Fraction of the settling gap dosed per cycle. Receding-horizon replanning
+ *  closes the rest on later cycles, so a plant with several times the
+ *  modelled dose gain still approaches setpoint from below. */
+static const PIDNumeric_t PLAN_GAIN_MARGIN = 0.25f;
+/** On-time a pulse may add on top of the drift maintenance (s). Spreads a
+ *  large correction over several cycles instead of one long pulse whose
+ *  injector-local lobe would spike the cells. */
+static const PIDNumeric_t PULSE_HEADROOM_S = 1.0f;
+/** Shortest window the drift is estimated over (s). Spans several cycles
+ *  so the lobe of any one pulse averages out of the estimate. */
+static const PIDNumeric_t DRIFT_WINDOW_S = 30.0f;
+/** Longest window the drift may be estimated across (s); beyond it the
+ *  oldest pulses have left the ring. */
+static const PIDNumeric_t MAX_DRIFT_WINDOW_S = 60.0f;
+/** Share of each window estimate folded into the drift. */
+static const PIDNumeric_t DRIFT_ADAPT_GAIN = 0.5f;
+/** Drift magnitude bound (bar/s): beyond any real metabolic/diluent rate. */
+static const PIDNumeric_t DRIFT_LIMIT_BAR_S = 0.01f;
+/** The measured recovery span covers about three mixing time constants. */
+static const PIDNumeric_t MIXING_SPANS = 3.0f;
+/** The cells' rise is this fraction of the mixing time constant. */
+static const PIDNumeric_t RISE_FRACTION = 0.25f;
+/** Lower bound on either time constant (s). */
+static const PIDNumeric_t MIN_TIME_CONSTANT_S = 0.5f;
+/** Milliseconds per second. */
+static const PIDNumeric_t MS_PER_S = 1000.0f;
+
+/** Pulse response shape derived once per plan from the plant model. */
+typedef struct {
+    PIDNumeric_t gain;       /**< settled bar per duty-second */
+    PIDNumeric_t dead_s;     /**< dose-to-first-response delay */
+    PIDNumeric_t mixing_s;   /**< time for a dose to mix through the loop */
+    PIDNumeric_t rise_s;     /**< rise constant at the cells */
+} MpcShape_t;
+
+static PIDNumeric_t local_clampf(PIDNumeric_t value, PIDNumeric_t lo,
+                 PIDNumeric_t hi)
+{
+    PIDNumeric_t result = value;
+
+    if (value < lo) {
+        result = lo;
+    } else if (value > hi) {
+        result = hi;
+    } else {
+        /* Within range — already clamped. */
+    }
+    return result;
+}
+
+static bool model_usable(const AutotunePlantModel_t *model)
+{
+    return (model != NULL) && model->valid &&
+           (mpc_dose_gain(model) > 0.0f);
+}
+
+static MpcShape_t shape_from_model(const AutotunePlantModel_t *model)
+{
+    PIDNumeric_t mixing_s = fmaxf(model->time_constant_s / MIXING_SPANS,
+                      MIN_TIME_CONSTANT_S);
+
+    return (MpcShape_t){
+        .gain = mpc_dose_gain(model),
+        .dead_s = fmaxf(model->dead_time_s, 0.0f),
+        .mixing_s = mixing_s,
+        .rise_s = fmaxf(mixing_s * RISE_FRACTION, MIN_TIME_CONSTANT_S),
+    };
+}
+
+/**
+ * @brief Share of a dose the cells show @p age_s after its midpoint.
+ *
+ * Zero before the dead time, then a first-order rise onto the settled value.
+ *
+ * @param shape Response shape.
+ * @param age_s Seconds since the pulse midpoint; negative while the pulse
+ *              is still in its first half.
+ * @return Visible share of the settled rise, 0..1.
+ */
+static PIDNumeric_t visible_share(const MpcShape_t *shape, PIDNumeric_t age_s)
+{
+    PIDNumeric_t share = 0.0f;
+    PIDNumeric_t seen_s = age_s - shape->dead_s;
+
+    if (seen_s > 0.0f) {
+        share = 1.0f - expf(-seen_s / shape->rise_s);
+    }
+    return share;
+}
+
+/**
+ * @brief Age of a pulse midpoint at @p now_ms, in seconds.
+ *
+ * Unsigned subtraction keeps the age correct across uptime wrap.
+ */
+static PIDNumeric_t pulse_age_s(const MpcPulse_t *pulse, uint32_t now_ms)
+{
+    uint32_t since_start_ms = now_ms - pulse->start_ms;
+
+    return ((PIDNumeric_t)since_start_ms / MS_PER_S) - (0.5f * pulse->on_s);
+}
+
+/**
+ * @brief Duty-seconds of the recorded pulses that became visible between
+ *        @p from_ms and @p to_ms.
+ *
+ * Pulses fired after @p from_ms count from zero visibility, so the sum
+ * covers everything delivered within the window as well as the tails of
+ * earlier pulses.
+ */
+static PIDNumeric_t visible_dose_s(const MpcState_t *state,
+                   const MpcShape_t *shape,
+                   uint32_t from_ms, uint32_t to_ms)
+{
+    PIDNumeric_t dose = 0.0f;
+
+    for (uint8_t i = 0U; i < state->count; ++i) {
+        const MpcPulse_t *pulse = &state->pulses[i];
+        PIDNumeric_t before = 0.0f;
+
+        /* Wrap-safe "fired before the window opened". */
+        if ((int32_t)(from_ms - pulse->start_ms) > 0) {
+            before = visible_share(shape, pulse_age_s(pulse, from_ms));
+        }
+        dose += pulse->on_s *
+            (visible_share(shape, pulse_age_s(pulse, to_ms)) - before);
+    }
+    return dose;
+}
+
+/** Reading the recorded pulses added between @p from_ms and @p to_ms. */
+static PIDNumeric_t pulses_change_bar(const MpcState_t *state,
+                      const MpcShape_t *shape,
+                      uint32_t from_ms, uint32_t to_ms)
+{
+    return shape->gain * visible_dose_s(state, shape, from_ms, to_ms);
+}
+
+/**
+ * @brief Reading the recorded pulses will still add once fully settled.
+ */
+static PIDNumeric_t pulses_unsettled_bar(const MpcState_t *state,
+                     const MpcShape_t *shape, uint32_t now_ms)
+{
+    PIDNumeric_t unsettled = 0.0f;
+
+    for (uint8_t i = 0U; i < state->count; ++i) {
+        const MpcPulse_t *pulse = &state->pulses[i];
+
+        unsettled += shape->gain * pulse->on_s *
+            (1.0f - visible_share(shape, pulse_age_s(pulse, now_ms)));
+    }
+    return unsettled;
+}
+
+/**
+ * @brief Re-estimate the drift once the measurement window is long enough.
+ *
+ * Over the window the measurement moved by what the pulses delivered plus
+ * the drift, so whatever the pulses do not explain is the drift. Windows
+ * of several cycles keep the lobe of individual pulses out of the
+ * estimate; folding it in gradually keeps the planner offset-free against
+ * an unknown metabolic rate and against a model gain that is somewhat off.
+ */
+static void adapt_drift(MpcState_t *state, const MpcShape_t *shape,
+            PIDNumeric_t measured_bar, uint32_t now_ms)
+{
+    if (!state->has_ref) {
+        state->ref_ppo2_bar = measured_bar;
+        state->ref_ms = now_ms;
+        state->has_ref = true;
+    }
+    else {
+        PIDNumeric_t window_s = (PIDNumeric_t)(now_ms - state->ref_ms) /
+                    MS_PER_S;
+
+        if (window_s > MAX_DRIFT_WINDOW_S) {
+            /* Too long since the reference to attribute — restart. */
+            state->ref_ppo2_bar = measured_bar;
+            state->ref_ms = now_ms;
+        } else if (window_s >= DRIFT_WINDOW_S) {
+            PIDNumeric_t estimate = (measured_bar - state->ref_ppo2_bar -
+                         pulses_change_bar(state, shape,
+                                   state->ref_ms, now_ms)) /
+                        window_s;
+
+            state->drift_bar_s = local_clampf(
+                state->drift_bar_s +
+                (DRIFT_ADAPT_GAIN * (estimate - state->drift_bar_s)),
+                -DRIFT_LIMIT_BAR_S, DRIFT_LIMIT_BAR_S);
+            state->ref_ppo2_bar = measured_bar;
+            state->ref_ms = now_ms;
+        } else {
+            /* Window still filling. */
+        }
+    }
+}
+
+void mpc_state_init(MpcState_t *state, const AutotunePlantModel_t *model)
+{
+    if (state != NULL) {
+        *state = (MpcState_t){0};
+        if (model_usable(model)) {
+            /* At the identified operating point the baseline duty exactly
+             * balanced consumption, so that is the drift to expect. */
+            state->drift_bar_s = local_clampf(
+                -mpc_dose_gain(model) * model->baseline_duty,
+                -DRIFT_LIMIT_BAR_S, DRIFT_LIMIT_BAR_S);
+        }
+    }
+}
+
+void mpc_state_invalidate(MpcState_t *state)
+{
+    if (state != NULL) {
+        state->has_ref = false;
+    }
+}
+
+void mpc_record_pulse(MpcState_t *state, uint32_t start_ms, PIDNumeric_t on_s)
+{
+    if ((state != NULL) && (on_s > 0.0f)) {
+        state->pulses[state->next] = (MpcPulse_t){
+            .start_ms = start_ms,
+            .on_s = on_s,
+        };
+        state->next = (uint8_t)((state->next + 1U) % MPC_HISTORY_LEN);
+        if (state->count < MPC_HISTORY_LEN) {
+            ++state->count;
+        }
+    }
+}
+
+PIDNumeric_t mpc_dose_gain(const AutotunePlantModel_t *model)
+{
+    PIDNumeric_t gain = 0.0f;
+
+    if (model != NULL) {
+        gain = model->settled_gain;
+        if (gain <= 0.0f) {
+            /* Model from before settled gains were identified. */
+            gain = model->process_gain / autotune_mixing_guard(model);
+        }
+    }
+    return gain;
+}
+
+PIDNumeric_t mpc_visible_dose_s(const MpcState_t *state,
+                const AutotunePlantModel_t *model,
+                uint32_t from_ms, uint32_t to_ms)
+{
+    PIDNumeric_t dose = 0.0f;
+
+    if ((state != NULL) && (model != NULL)) {
+        MpcShape_t shape = shape_from_model(model);
+
+        dose = visible_dose_s(state, &shape, from_ms, to_ms);
+    }
+    return dose;
+}
+
+PIDNumeric_t mpc_predict_settled(const MpcState_t *state,
+                 const AutotunePlantModel_t *model,
+                 PIDNumeric_t measured_bar, uint32_t now_ms)
+{
+    PIDNumeric_t predicted = measured_bar;
+
+    if ((state != NULL) && model_usable(model)) {
+        MpcShape_t shape = shape_from_model(model);
+
+        /* Consumption continues while the pulses land: charge the drift
+         * over the typical landing delay. */
+        predicted += pulses_unsettled_bar(state, &shape, now_ms) +
+            (state->drift_bar_s * (shape.dead_s + shape.mixing_s));
+    }
+    return predicted;
+}
+
+PIDNumeric_t mpc_plan_pulse(MpcState_t *state,
+                const AutotunePlantModel_t *model,
+                PIDNumeric_t setpoint_bar, PIDNumeric_t measured_bar,
+                uint32_t now_ms, const MpcLimits_t *limits)
+{
+    PIDNumeric_t on_s = 0.0f;
+
+    if ((state == NULL) || (limits == NULL) || (!model_usable(model))) {
+        /* No usable model — never fire blind. */
+    }
+    else {
+        MpcShape_t shape = shape_from_model(model);
+
+        adapt_drift(state, &shape, measured_bar, now_ms);
+
+        /* Dose the drift over the coming cycle in full and only a share of
+         * the gap to the predicted settled PPO2. Taking the drift in full
+         * keeps the steady state on setpoint; derating the gap absorbs a
+         * model gain that is too low. */
+        PIDNumeric_t maintain_s = fmaxf(
+            (-state->drift_bar_s * limits->cycle_s) / shape.gain, 0.0f);
+        PIDNumeric_t gap = setpoint_bar -
+            mpc_predict_settled(state, model, measured_bar, now_ms);
+        PIDNumeric_t dose_s = ((PLAN_GAIN_MARGIN * gap) -
+                       (state->drift_bar_s * limits->cycle_s)) /
+                      shape.gain;
+
+        /* The inject solenoid can only add O2: never fire above setpoint. */
+        if ((measured_bar < setpoint_bar) && (dose_s > 0.0f)) {
+            /* Correction beyond the headroom waits for the next cycle. */
+            on_s = fminf(dose_s, fminf(maintain_s + PULSE_HEADROOM_S,
+                           limits->max_on_s));
+            if (on_s < limits->min_on_s) {
+                on_s = 0.0f;
+            }
+        }
+    }
+    return on_s;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file ppo2_plant_estimator.c
+ * @brief Background recursive plant identification from ordinary diving.
+ *
+ * Autotune identifies the loop once, on the bench, from a dedicated
+ * excitation run. This thread keeps tracking it afterwards using only data
+ * that already flows: inject pulses from chan_solenoid_fire and the voted
+ * PPO2 from chan_consensus. The fit itself lives in ppo2_plant_rls_math.c;
+ * this file only feeds it and publishes the result on chan_plant_estimate.
+ *
+ * The reference is whatever plant model the controller holds
+ * (ppo2_control_get_plant_model()); its dead time and mixing shape the
+ * pulses, and the estimate is reported against it. When the controller is
+ * handed a new model the estimator restarts from it.
+ *
+ * Windows spanning anything the fit does not model are dropped: a
+ * setpoint-change flush (O2 or diluent outside the inject path), cell
+ * calibration gas, and failed consensus.
+ *
+ * The thread deliberately does NOT register a heartbeat slot: the estimate
+ * is advisory telemetry, and a wedged estimator must not reboot the head
+ * mid-dive.
+ */
+
+#include "ppo2_plant_estimator.h"
+#include "ppo2_control.h"
+#include "calibration.h"
+#include "divecan_channels.h"
+#include "oxygen_cell_channels.h"
+#include "oxygen_cell_types.h"
+#include "flash_log.h"
+#include "errors.h"
+#include "common.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(ppo2_plant_estimator, LOG_LEVEL_INF);
+
+/** Float math and zbus reads only; sized like the autotune thread, which
+ *  runs the same kind of work. Verify against the thread analyzer report. */
+#define PLANT_ESTIMATOR_STACK_SIZE 1024
+/** One priority below the control threads (6), like autotune: the
+ *  estimator must never delay a fire cycle. */
+#define PLANT_ESTIMATOR_THREAD_PRIORITY 7
+/** Fire notes buffered between samples. At most one inject per 5 s cycle
+ *  plus the odd flush arrive per 1 s sample, so this only fills if the
+ *  thread stalls — and a stall drops the window anyway. */
+#define PLANT_FIRE_QUEUE_LEN 8
+
+/** Consensus sample period (ms); divides the window evenly. */
+static const uint32_t PLANT_SAMPLE_PERIOD_MS = 1000U;
+/** Fit window (ms). A minute spans enough inject cycles to average out the
+ *  injector-local lobe that shorter windows read as extra gain. */
+static const uint32_t PLANT_WINDOW_MS = 60000U;
+/** Bounded wait for a zbus channel op. */
+static const uint32_t CHAN_TIMEOUT_MS = 10U;
+/** Microseconds per second. */
+static const PIDNumeric_t US_PER_S = 1000000.0f;
+/** Gain -> micro-units scale for integer logging (avoids the %f stack path). */
+static const PIDNumeric_t MICROUNITS = 1000000.0f;
+/** Duty -> permille for integer logging. */
+static const PIDNumeric_t PERMILLE = 1000.0f;
+
+ZBUS_CHAN_DEFINE(chan_plant_estimate,
+    PlantEstimate_t,
+    NULL, NULL,
+    ZBUS_OBSERVERS_EMPTY,
+    ZBUS_MSG_INIT(0));
+
+/** What the fire listener hands to the estimator thread. */
+typedef struct {
+    uint32_t start_ms;  /**< k_uptime_get_32() at publish */
+    PIDNumeric_t on_s;  /**< requested inject time; 0 for a flush */
+    bool flush;         /**< a flush solenoid opened */
+} PlantFireNote_t;
+
+K_MSGQ_DEFINE(plant_fire_msgq, sizeof(PlantFireNote_t), PLANT_FIRE_QUEUE_LEN, 4);
+
+/* ---- chan_solenoid_fire ---- */
+
+/**
+ * @brief Queue inject starts and flushes for the estimator thread.
+ *
+ * Runs in the fire thread's context, so it only stamps and queues. The
+ * fire thread publishes INJECT_START as the solenoid opens, so the publish
+ * uptime is the pulse start.
+ */
+static void plant_fire_listener_cb(const struct zbus_channel *chan)
+{
+    const SolenoidFireEvent_t *evt = zbus_chan_const_msg(chan);
+
+    if (evt != NULL) {
+        PlantFireNote_t note = {
+            .start_ms = k_uptime_get_32(),
+            .on_s = 0.0f,
+            .flush = false,
+        };
+        bool wanted = true;
+
+        if (SOL_FIRE_EVT_INJECT_START == evt->kind) {
+            note.on_s = (PIDNumeric_t)evt->requested_on_us / US_PER_S;
+        } else if (SOL_FIRE_EVT_FLUSH_START == evt->kind) {
+            note.flush = true;
+        } else {
+            wanted = false;
+        }
+        if (wanted) {
+            /* Full only if the thread stalled; that window is dropped. */
+            (void)k_msgq_put(&plant_fire_msgq, &note, K_NO_WAIT);
+        }
+    }
+}
+
+ZBUS_LISTENER_DEFINE(plant_fire_listener, plant_fire_listener_cb);
+ZBUS_CHAN_ADD_OBS(chan_solenoid_fire, plant_fire_listener, 5);
+
+/* ---- Estimator state (estimator thread only) ---- */
+
+/** Module state behind a static accessor (M23_388) — single owner is
+ *  plant_estimator_thread. */
+static PlantRlsState_t *getRlsState(void)
+{
+    static PlantRlsState_t state;
+    return &state;
+}
+
+/** Reference model the estimate is fitted and reported against. */
+static AutotunePlantModel_t *getReference(void)
+{
+    static AutotunePlantModel_t reference;
+    return &reference;
+}
+
+/** Field-wise compare: the structs carry padding, so no memcmp. */
+static bool same_model(const AutotunePlantModel_t *a,
+               const AutotunePlantModel_t *b)
+{
+    return (a->valid == b->valid) &&
+        (a->settled_gain == b->settled_gain) &&
+        (a->process_gain == b->process_gain) &&
+        (a->dead_time_s == b->dead_time_s) &&
+        (a->time_constant_s == b->time_constant_s) &&
+        (a->mixing_excursion_bar == b->mixing_excursion_bar) &&
+        (a->baseline_duty == b->baseline_duty);
+}
+
+/** Restart the fit if the controller was handed a different model. */
+static void follow_reference(PlantRlsState_t *state,
+                 AutotunePlantModel_t *reference)
+{
+    AutotunePlantModel_t model = {0};
+
+    ppo2_control_get_plant_model(&model);
+    if (!same_model(&model, reference)) {
+        *reference = model;
+        plant_rls_init(state, reference);
+        LOG_INF("plant estimator restarted on a new reference model");
+    }
+}
+
+/** Move queued fire notes into the fit; a flush drops the open window. */
+static void drain_fire_notes(PlantRlsState_t *state)
+{
+    PlantFireNote_t note = {0};
+
+    while (0 == k_msgq_get(&plant_fire_msgq, &note, K_NO_WAIT)) {
+        if (note.flush) {
+            plant_rls_invalidate(state);
+        } else {
+            plant_rls_record_pulse(state, note.start_ms, note.on_s);
+        }
+    }
+}
+
+static void publish_estimate(const PlantRlsState_t *state,
+                 const AutotunePlantModel_t *reference)
+{
+    PlantEstimate_t est = {0};
+
+    plant_rls_estimate(state, reference, &est);
+    zbus_pub_checked(&chan_plant_estimate, &est, K_MSEC(CHAN_TIMEOUT_MS));
+    LOG_DBG("plant: gain=%d ugain ratio=%d permille balance=%d permille "
+        "(ref %d) windows=%u/%u%s",
+        (int32_t)(est.settled_gain * MICROUNITS),
+        (int32_t)(est.gain_ratio * PERMILLE),
+        (int32_t)(est.balance_duty * PERMILLE),
+        (int32_t)(est.ref_balance_duty * PERMILLE),
+        (uint32_t)est.gain_updates, (uint32_t)est.updates,
+        est.converged ? " converged" : "");
+}
+
+/* ---- Thread ---- */
+
+static void plant_estimator_thread_fn(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    PlantRlsState_t *state = getRlsState();
+    AutotunePlantModel_t *reference = getReference();
+
+    ppo2_control_get_plant_model(reference);
+    plant_rls_init(state, reference);
+
+    while (true) {
+        (void)k_msleep((int32_t)PLANT_SAMPLE_PERIOD_MS);
+
+        follow_reference(state, reference);
+        drain_fire_notes(state);
+
+        ConsensusMsg_t consensus = {0};
+        Status_t rc = zbus_chan_read(&chan_consensus, &consensus,
+                         K_MSEC(CHAN_TIMEOUT_MS));
+
+        if ((0 != rc) || (PPO2_FAIL == consensus.consensus_ppo2) ||
+            calibration_is_running()) {
+            plant_rls_invalidate(state);
+        } else if (plant_rls_sample(state, reference,
+                        consensus.precision_consensus,
+                        k_uptime_get_32(), PLANT_WINDOW_MS)) {
+            publish_estimate(state, reference);
+        } else {
+            /* Window still filling. */
+        }
+    }
+}
+
+K_THREAD_DEFINE(plant_estimator_thread, PLANT_ESTIMATOR_STACK_SIZE,
+        plant_estimator_thread_fn, NULL, NULL, NULL,
+        PLANT_ESTIMATOR_THREAD_PRIORITY, 0, 0);
@@ -0,0 +1,319 @@
+/**
+ * @file ppo2_plant_rls_math.c
+ * @brief Pure-math recursive least-squares plant tracking.
+ *
+ * No kernel / zbus / logging dependencies so the host ztest target can
+ * exercise the estimator in isolation.
+ *
+ * Window means rather than single samples feed the fit: a minute-long mean
+ * spans many inject cycles, so the ripple of individual pulses and most of
+ * the injector-local lobe (which the reference shape does not model) average
+ * out instead of being fitted as gain. Shorter windows read the lobe as
+ * extra gain, up to several times the settled value. Differencing the means
+ * also removes the unknown absolute PPO2 from the regression.
+ *
+ * Each parameter random-walks between windows (a Kalman-style RLS) rather
+ * than using exponential forgetting: under steady control forgetting
+ * inflates the covariance along the unexcited direction until the next
+ * disturbance throws the estimate. For the same reason the gain only takes
+ * part in windows whose dose departs from the current balance; in the rest
+ * the residual of the held gain is fitted as drift.
+ */
+
+#include "ppo2_plant_rls_math.h"
+#include <stddef.h>
+#include <math.h>
+
+/** Index of the settled gain in theta. */
+#define RLS_GAIN 0U
+/** Index of the drift in theta. */
+#define RLS_DRIFT 1U
+
+/** Gain random walk per window, as a fraction of the reference gain: lets
+ *  the gain follow a loop-volume change at the next excitation. */
+static const PIDNumeric_t GAIN_WALK = 0.03f;
+/** Drift random walk per window (bar/s): metabolic rate shifts faster and
+ *  more often than loop volume, so the drift is allowed to move quicker. */
+static const PIDNumeric_t DRIFT_WALK_BAR_S = 0.0002f;
+/** Seed gain uncertainty as a fraction of the reference gain. */
+static const PIDNumeric_t SEED_GAIN_SPREAD = 1.0f;
+/** Seed drift uncertainty (bar/s). */
+static const PIDNumeric_t SEED_DRIFT_SPREAD_BAR_S = 0.005f;
+/** Expected noise on the change between window means (bar). Sets how far
+ *  one window moves the estimate relative to the covariance. */
+static const PIDNumeric_t WINDOW_NOISE_BAR = 0.005f;
+/** A window excites the gain once its dose departs from the balance by this
+ *  duty; steady control keeps well inside it. */
+static const PIDNumeric_t EXCITATION_DUTY = 0.05f;
+/** ...and once the window mean moved by this much (bar). A dose change the
+ *  reading does not follow is a metabolic shift, not a gain error. */
+static const PIDNumeric_t EXCITATION_BAR = 0.03f;
+/** Gain bounds as multiples of the reference gain. */
+static const PIDNumeric_t MIN_GAIN_RATIO = 0.2f;
+static const PIDNumeric_t MAX_GAIN_RATIO = 5.0f;
+/** Drift magnitude bound (bar/s): beyond any real metabolic/diluent rate. */
+static const PIDNumeric_t DRIFT_LIMIT_BAR_S = 0.01f;
+/** Fitted windows before the estimate may be reported converged. */
+static const uint16_t CONVERGED_MIN_UPDATES = 8U;
+/** Converged once the gain's 1-sigma is within this share of the gain. */
+static const PIDNumeric_t CONVERGED_GAIN_SPREAD = 0.25f;
+/** A window stretched to this many nominal lengths is dropped, not fitted. */
+static const uint32_t MAX_WINDOW_STRETCH = 2U;
+/** Milliseconds per second. */
+static const PIDNumeric_t MS_PER_S = 1000.0f;
+
+static PIDNumeric_t local_clampf(PIDNumeric_t value, PIDNumeric_t lo,
+                 PIDNumeric_t hi)
+{
+    PIDNumeric_t result = value;
+
+    if (value < lo) {
+        result = lo;
+    } else if (value > hi) {
+        result = hi;
+    } else {
+        /* Within range — already clamped. */
+    }
+    return result;
+}
+
+static PIDNumeric_t reference_gain(const AutotunePlantModel_t *model)
+{
+    PIDNumeric_t gain = 0.0f;
+
+    if ((model != NULL) && model->valid) {
+        gain = mpc_dose_gain(model);
+    }
+    return gain;
+}
+
+/** Seed variances: also the cap the covariance diagonal may not exceed. */
+static void seed_variances(const AutotunePlantModel_t *model,
+               PIDNumeric_t var[PLANT_RLS_PARAMS])
+{
+    PIDNumeric_t gain_spread = SEED_GAIN_SPREAD * reference_gain(model);
+
+    var[RLS_GAIN] = gain_spread * gain_spread;
+    var[RLS_DRIFT] = SEED_DRIFT_SPREAD_BAR_S * SEED_DRIFT_SPREAD_BAR_S;
+}
+
+/** Duty that holds PPO2 under the current estimate. */
+static PIDNumeric_t balance_duty(const PlantRlsState_t *state)
+{
+    PIDNumeric_t duty = 0.0f;
+
+    if (state->theta[RLS_GAIN] > 0.0f) {
+        duty = -state->theta[RLS_DRIFT] / state->theta[RLS_GAIN];
+    }
+    return duty;
+}
+
+/**
+ * @brief One recursive least-squares step for y = phi . theta.
+ *
+ * The covariance is carried in parameter units, so the innovation is
+ * weighed against the window noise variance. Each parameter then random-
+ * walks by @p walk, which keeps the estimator responsive to a loop that
+ * changes. Capping the diagonal keeps the covariance bounded while a
+ * direction goes unexcited; off-diagonals are scaled with it so the
+ * matrix stays positive semi-definite.
+ */
+static void rls_update(PlantRlsState_t *state, const PIDNumeric_t phi[PLANT_RLS_PARAMS],
+               PIDNumeric_t y, const PIDNumeric_t walk[PLANT_RLS_PARAMS],
+               const PIDNumeric_t cap[PLANT_RLS_PARAMS])
+{
+    PIDNumeric_t p_phi[PLANT_RLS_PARAMS] = {0};
+    PIDNumeric_t denom = WINDOW_NOISE_BAR * WINDOW_NOISE_BAR;
+    PIDNumeric_t error = y;
+
+    for (uint8_t i = 0U; i < PLANT_RLS_PARAMS; ++i) {
+        for (uint8_t j = 0U; j < PLANT_RLS_PARAMS; ++j) {
+            p_phi[i] += state->cov[i][j] * phi[j];
+        }
+        denom += phi[i] * p_phi[i];
+        error -= phi[i] * state->theta[i];
+    }
+
+    for (uint8_t i = 0U; i < PLANT_RLS_PARAMS; ++i) {
+        state->theta[i] += (p_phi[i] / denom) * error;
+    }
+    /* P = P - P.phi.phi'.P / denom + walk; P is symmetric. */
+    for (uint8_t i = 0U; i < PLANT_RLS_PARAMS; ++i) {
+        for (uint8_t j = 0U; j < PLANT_RLS_PARAMS; ++j) {
+            state->cov[i][j] -= (p_phi[i] * p_phi[j]) / denom;
+        }
+        state->cov[i][i] += walk[i];
+    }
+
+    PIDNumeric_t scale[PLANT_RLS_PARAMS] = {1.0f, 1.0f};
+    for (uint8_t i = 0U; i < PLANT_RLS_PARAMS; ++i) {
+        if (state->cov[i][i] > cap[i]) {
+            scale[i] = sqrtf(cap[i] / state->cov[i][i]);
+        }
+    }
+    for (uint8_t i = 0U; i < PLANT_RLS_PARAMS; ++i) {
+        for (uint8_t j = 0U; j < PLANT_RLS_PARAMS; ++j) {
+            state->cov[i][j] *= scale[i] * scale[j];
+        }
+    }
+}
+
+/**
+ * @brief Fit the closed window against the previous one, then clear it.
+ *
+ * dose_level is rebased to the closed window's mean, so the next window's
+ * mean level is directly the dose change between the two.
+ */
+static bool close_window(PlantRlsState_t *state,
+             const AutotunePlantModel_t *model, uint32_t window_ms)
+{
+    bool updated = false;
+    PIDNumeric_t mean_bar = state->ppo2_sum / (PIDNumeric_t)state->samples;
+    PIDNumeric_t mean_dose = state->dose_sum / (PIDNumeric_t)state->samples;
+
+    if (state->has_prev) {
+        PIDNumeric_t ref_gain = reference_gain(model);
+        PIDNumeric_t window_s = (PIDNumeric_t)window_ms / MS_PER_S;
+        PIDNumeric_t phi[PLANT_RLS_PARAMS] = {mean_dose, window_s};
+        PIDNumeric_t y = mean_bar - state->prev_mean_bar;
+        PIDNumeric_t gain_walk = GAIN_WALK * ref_gain;
+        PIDNumeric_t walk[PLANT_RLS_PARAMS] = {
+            gain_walk * gain_walk,
+            DRIFT_WALK_BAR_S * DRIFT_WALK_BAR_S,
+        };
+        PIDNumeric_t cap[PLANT_RLS_PARAMS] = {0};
+        PIDNumeric_t excess_dose = mean_dose - (balance_duty(state) * window_s);
+
+        if ((fabsf(excess_dose) < (EXCITATION_DUTY * window_s)) ||
+            (fabsf(y) < EXCITATION_BAR)) {
+            /* Dose at the balance, or a dose change the reading did not
+             * follow (the balance itself moved): only the drift is
+             * observable. The gain keeps its random walk so its
+             * uncertainty grows while unconfirmed. */
+            y -= state->theta[RLS_GAIN] * mean_dose;
+            phi[RLS_GAIN] = 0.0f;
+        } else if (state->gain_updates < UINT16_MAX) {
+            ++state->gain_updates;
+        } else {
+            /* Counter saturated. */
+        }
+        seed_variances(model, cap);
+        rls_update(state, phi, y, walk, cap);
+        state->theta[RLS_GAIN] = local_clampf(state->theta[RLS_GAIN],
+                              MIN_GAIN_RATIO * ref_gain,
+                              MAX_GAIN_RATIO * ref_gain);
+        state->theta[RLS_DRIFT] = local_clampf(state->theta[RLS_DRIFT],
+                               -DRIFT_LIMIT_BAR_S,
+                               DRIFT_LIMIT_BAR_S);
+        if (state->updates < UINT16_MAX) {
+            ++state->updates;
+        }
+        updated = true;
+    }
+    state->prev_mean_bar = mean_bar;
+    state->has_prev = true;
+    state->dose_level -= mean_dose;
+    state->ppo2_sum = 0.0f;
+    state->dose_sum = 0.0f;
+    state->samples = 0U;
+    return updated;
+}
+
+void plant_rls_init(PlantRlsState_t *state, const AutotunePlantModel_t *model)
+{
+    if (state != NULL) {
+        PIDNumeric_t var[PLANT_RLS_PARAMS] = {0};
+        PIDNumeric_t ref_gain = reference_gain(model);
+
+        *state = (PlantRlsState_t){0};
+        seed_variances(model, var);
+        state->theta[RLS_GAIN] = ref_gain;
+        if (ref_gain > 0.0f) {
+            state->theta[RLS_DRIFT] = local_clampf(-ref_gain * model->baseline_duty,
+                                   -DRIFT_LIMIT_BAR_S,
+                                   DRIFT_LIMIT_BAR_S);
+        }
+        state->cov[RLS_GAIN][RLS_GAIN] = var[RLS_GAIN];
+        state->cov[RLS_DRIFT][RLS_DRIFT] = var[RLS_DRIFT];
+    }
+}
+
+void plant_rls_invalidate(PlantRlsState_t *state)
+{
+    if (state != NULL) {
+        state->ppo2_sum = 0.0f;
+        state->dose_sum = 0.0f;
+        state->dose_level = 0.0f;
+        state->samples = 0U;
+        state->has_prev = false;
+    }
+}
+
+void plant_rls_record_pulse(PlantRlsState_t *state, uint32_t start_ms,
+                PIDNumeric_t on_s)
+{
+    if (state != NULL) {
+        mpc_record_pulse(&state->pulses, start_ms, on_s);
+    }
+}
+
+bool plant_rls_sample(PlantRlsState_t *state, const AutotunePlantModel_t *model,
+              PIDNumeric_t ppo2_bar, uint32_t now_ms, uint32_t window_ms)
+{
+    bool updated = false;
+
+    if ((state == NULL) || (reference_gain(model) <= 0.0f) || (window_ms == 0U)) {
+        /* No reference shape — nothing to fit against. */
+    } else {
+        if (state->samples > 0U) {
+            uint32_t elapsed_ms = now_ms - state->window_start_ms;
+
+            if (elapsed_ms >= (MAX_WINDOW_STRETCH * window_ms)) {
+                /* Sampling stalled — the means are no longer comparable. */
+                plant_rls_invalidate(state);
+            } else {
+                /* Dose that reached the cells since the previous sample. */
+                state->dose_level += mpc_visible_dose_s(&state->pulses, model,
+                                    state->last_sample_ms,
+                                    now_ms);
+                if (elapsed_ms >= window_ms) {
+                    updated = close_window(state, model, window_ms);
+                }
+            }
+        }
+        if (0U == state->samples) {
+            state->window_start_ms = now_ms;
+        }
+        state->ppo2_sum += ppo2_bar;
+        state->dose_sum += state->dose_level;
+        state->last_sample_ms = now_ms;
+        ++state->samples;
+    }
+    return updated;
+}
+
+void plant_rls_estimate(const PlantRlsState_t *state,
+            const AutotunePlantModel_t *model, PlantEstimate_t *out)
+{
+    if (out != NULL) {
+        *out = (PlantEstimate_t){0};
+        if (state != NULL) {
+            PIDNumeric_t ref_gain = reference_gain(model);
+
+            out->settled_gain = state->theta[RLS_GAIN];
+            out->drift_bar_s = state->theta[RLS_DRIFT];
+            out->balance_duty = balance_duty(state);
+            out->ref_settled_gain = ref_gain;
+            if (ref_gain > 0.0f) {
+                out->ref_balance_duty = model->baseline_duty;
+                out->gain_ratio = out->settled_gain / ref_gain;
+            }
+            out->gain_stddev = sqrtf(fmaxf(state->cov[RLS_GAIN][RLS_GAIN], 0.0f));
+            out->updates = state->updates;
+            out->gain_updates = state->gain_updates;
+            out->converged = (state->updates >= CONVERGED_MIN_UPDATES) &&
+                (out->gain_stddev <=
+                 (CONVERGED_GAIN_SPREAD * out->settled_gain));
+        }
+    }
+}
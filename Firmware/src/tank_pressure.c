@@ -26,7 +26,7 @@
 #include "tank_pressure.h"
 #include "errors.h"
 #include "common.h"
-#include "i2c_bus_lock.h"
+#include "i2c1_sched.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/adc.h>
@@ -51,15 +51,15 @@ LOG_MODULE_REGISTER(tank_pressure, LOG_LEVEL_INF);
 /* On the Poseidon variant the ADS1115 shares i2c1 with the Poseidon accessory
  * masters, so a conversion-trigger write can lose the bus and return -EBUSY
  * (the public STM32 driver reports arbitration loss as generic -EIO).
- * i2c1_bus_lock() removes the collisions
- * against our own masters; these retries ride out the external ones. Tank
- * pressure is slow and display-only, so a few short retries are free.
+ * The i2c1 scheduler removes the collisions against our own masters; these
+ * retries ride out the external ones. Tank pressure is slow and display-only,
+ * so a few short retries are free.
  *
  * Backoff is exponential with jitter (BASE << attempt, plus 0..JITTER-1 ms):
  * a fixed delay lets two contending masters retry in lockstep and livelock,
- * so we grow the gap and de-phase it. k_msleep also yields the CPU so the
- * competing Poseidon master and the external display can drain and release
- * the bus. Worst case ~2+4+8 ms + jitter, well inside the 500 ms cadence. */
+ * so we grow the gap and de-phase it. The wait also leaves the bus to the
+ * competing Poseidon master and the external display so they can drain.
+ * Worst case ~2+4+8 ms + jitter, well inside the 500 ms cadence. */
 #define TANK_ADC_MAX_ATTEMPTS 4
 #define TANK_ADC_RETRY_BASE_MS 2U
 #define TANK_ADC_RETRY_JITTER_MS 3U
@@ -85,6 +85,7 @@ struct transducer_state {
     TransducerMv_t min_mv;
     TransducerMv_t max_mv;
     TransducerLimitBar_t limit_bar;
+    uint16_t bus_addr;               /* ADS1115 address, the scheduler's merge key */
     bool ready;
     int16_t adc_sample_buf;
     struct adc_sequence adc_seq;
@@ -120,11 +121,12 @@ static void transducer_init(struct transducer_state *t)
 }
 
 /**
- * @brief i2c1_transact adapter: perform one ADS1115 conversion read.
+ * @brief i2c1 transfer callback: perform one ADS1115 conversion read.
  *
- * Called with the bus mutex already held (i2c1_transact locks around it), so it
- * does only the transfer. The transducer state carries the channel spec and the
- * sequence buffer set up in transducer_init().
+ * Runs while the bus is held for it (on the i2c1 scheduler thread, or inline
+ * under the bus mutex), so it does only the transfer. The transducer state
+ * carries the channel spec and the sequence buffer set up in
+ * transducer_init().
  *
  * @param ctx struct transducer_state pointer.
  * @return 0 on success (t->adc_sample_buf holds the raw count), else the
@@ -140,13 +142,13 @@ static Status_t transducer_read_xfer(void *ctx)
 /**
  * @brief Read the ADS1115 channel, riding out transient i2c1 contention.
  *
- * Delegates the whole avoid+retry+recover dance to the shared i2c1_transact
- * helper so the tank sampler collides with the Poseidon accessory masters the
- * same way every other i2c1 caller does. External Poseidon masters can still
- * win the bus, so the helper's bounded quiet-wait + exponential-backoff retries
- * absorb the residual multi-master transport errors, and its classify+recover
- * step resets a wedged peripheral without unregistering the target before a
- * final attempt.
+ * Hands the read to the i2c1 scheduler at background priority, so it queues
+ * behind cell reads and Poseidon groups instead of racing them, and the
+ * scheduler's avoid+retry+recover policy handles collisions the same way as
+ * for every other i2c1 client. External Poseidon masters can still win the
+ * bus, so bounded quiet-wait + exponential-backoff retries absorb the residual
+ * multi-master transport errors, and a classify+recover step resets a wedged
+ * peripheral without unregistering the target before a final attempt.
  *
  * @param t Transducer state (must have been through transducer_init()).
  * @return 0 on success (t->adc_sample_buf holds the raw count), else the last
@@ -154,10 +156,12 @@ static Status_t transducer_read_xfer(void *ctx)
  */
 static Status_t transducer_read_retry(struct transducer_state *t)
 {
-    return i2c1_transact(transducer_read_xfer, t,
-                         TANK_ADC_MAX_ATTEMPTS,
-                         TANK_ADC_RETRY_BASE_MS,
-                         TANK_ADC_RETRY_JITTER_MS);
+    I2c1Txn_t txn = I2C1_TXN(transducer_read_xfer, t, I2C1_CLIENT_TANK,
+                             I2C1_PRIO_BACKGROUND, t->bus_addr,
+                             TANK_ADC_MAX_ATTEMPTS, TANK_ADC_RETRY_BASE_MS,
+                             TANK_ADC_RETRY_JITTER_MS, 0U);
+
+    return i2c1_sched_run(&txn);
 }
 
 /**
@@ -215,6 +219,7 @@ static struct transducer_state *get_o2_transducer(void)
         .min_mv = CONFIG_O2_TRANSDUCER_MIN,
         .max_mv = CONFIG_O2_TRANSDUCER_MAX,
         .limit_bar = CONFIG_O2_TRANSDUCER_LIMIT,
+        .bus_addr = I2C1_ADC_CHANNEL_ADDR(CONFIG_O2_TRANSDUCER_CHANNEL),
         .ready = false,
         .adc_sample_buf = 0,
         .adc_seq = {0},
@@ -236,6 +241,7 @@ static struct transducer_state *get_dil_transducer(void)
         .min_mv = CONFIG_DIL_TRANSDUCER_MIN,
         .max_mv = CONFIG_DIL_TRANSDUCER_MAX,
         .limit_bar = CONFIG_DIL_TRANSDUCER_LIMIT,
+        .bus_addr = I2C1_ADC_CHANNEL_ADDR(CONFIG_DIL_TRANSDUCER_CHANNEL),
         .ready = false,
         .adc_sample_buf = 0,
         .adc_seq = {0},
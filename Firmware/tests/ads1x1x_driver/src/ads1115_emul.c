@@ -8,6 +8,12 @@
  * returns its pair-specific value — proving the driver programs the right MUX
  * per channel. With the upstream single-channel driver the second channel never
  * sets up, so the test fails there: it is a regression guard for the fix.
+ *
+ * A CONFIG write with MODE clear (continuous conversion, the driver's scan
+ * mode) also latches the MUX, but CONV reads back 0 — an unsettled input —
+ * until two conversion periods have passed: the conversion running when the
+ * MUX moved is mixed, and it may still be the latest one a period later. The
+ * ads1x1x_scan suite shares this emulator.
  */
 
 #define DT_DRV_COMPAT ti_ads1115
@@ -18,6 +24,7 @@
 #include <zephyr/drivers/i2c_emul.h>
 #include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(ads1115_emul, LOG_LEVEL_INF);
@@ -26,9 +33,15 @@ LOG_MODULE_REGISTER(ads1115_emul, LOG_LEVEL_INF);
 #define ADS1115_REG_CONFIG 0x01
 #define ADS1115_NUM_REGS   4
 #define ADS1115_CONFIG_OS  BIT(15)
+#define ADS1115_CONFIG_MODE BIT(8)
+
+/* Conversion period at the tests' default data rate (128 SPS). */
+#define ADS1115_EMUL_PERIOD_US 7813
 
 struct ads1115_emul_data {
 	uint16_t reg[ADS1115_NUM_REGS]; /* CONV, CONFIG, LO_THRESH, HI_THRESH */
+	bool continuous;                /* last CONFIG write had MODE clear */
+	int64_t mux_set_ticks;          /* when that write moved the MUX */
 };
 
 /* Distinct, deterministic conversion value per differential MUX selection so
@@ -111,6 +124,17 @@ static int ads1115_emul_transfer(const struct emul *target, struct i2c_msg *msgs
 			data->reg[ADS1115_REG_CONV] =
 				(uint16_t)ads1115_emul_conv_for_mux(mux);
 		}
+		if (reg == ADS1115_REG_CONFIG) {
+			data->continuous = (0U == (val & ADS1115_CONFIG_MODE));
+		}
+		if ((reg == ADS1115_REG_CONFIG) && data->continuous) {
+			/* Free-running from here; CONV settles below. */
+			uint8_t mux = (val >> 12) & 0x7;
+
+			data->mux_set_ticks = k_uptime_ticks();
+			data->reg[ADS1115_REG_CONV] =
+				(uint16_t)ads1115_emul_conv_for_mux(mux);
+		}
 		return 0;
 	}
 
@@ -133,6 +157,11 @@ static int ads1115_emul_transfer(const struct emul *target, struct i2c_msg *msgs
 			return -EIO;
 		}
 		out = data->reg[reg];
+		if ((reg == ADS1115_REG_CONV) && data->continuous &&
+		    (k_ticks_to_us_floor64(k_uptime_ticks() - data->mux_set_ticks) <
+		     (2 * ADS1115_EMUL_PERIOD_US))) {
+			out = 0U;
+		}
 		if ((reg == ADS1115_REG_CONFIG) && (emul_os_busy_reads > 0)) {
 			/* Report "conversion still running" so wait_data_ready polls. */
 			out &= (uint16_t)~ADS1115_CONFIG_OS;
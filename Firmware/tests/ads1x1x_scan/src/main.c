@@ -0,0 +1,157 @@
+/*
+ * Driver-level test of the board-local ADS1X1X continuous-conversion scan
+ * mode (CONFIG_ADC_ADS1X1X_LOCAL_SCAN). Two logical channels share ONE
+ * emulated ADS1115; once scanning, the acquisition thread walks the MUX
+ * between them and each channel's ring must only ever hold that channel's
+ * settled value. The emulator reads 0 for two conversion periods after a
+ * MUX move, so a missing settle discard shows up as zeros in a batch.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/devicetree.h>
+
+#include "ads1x1x_scan.h"
+
+/* From the test devicetree (boards/native_sim.overlay): two channels on one
+ * emulated ADS1115 — channel 0 = AIN0-AIN1, channel 1 = AIN2-AIN3. */
+static const struct adc_dt_spec ch0 = ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 0);
+static const struct adc_dt_spec ch1 = ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 1);
+
+/* Emulator's deterministic value per MUX pair: MUX 0 -> 1000, MUX 3 -> 4000. */
+#define EXPECT_CH0_AIN0_1 1000
+#define EXPECT_CH1_AIN2_3 4000
+
+#define RING_DEPTH CONFIG_ADC_ADS1X1X_LOCAL_SCAN_RING_DEPTH
+#define BURST_WAIT K_MSEC(1000)
+
+/* Long enough for several rotations at 128 SPS (~90 ms each). */
+#define BACKLOG_MS 1000
+
+static int start_before_setup_rc;
+
+static void *scan_setup(void)
+{
+	zassert_true(adc_is_ready_dt(&ch0), "ADC device not ready");
+
+	/* Before any channel exists there is nothing to scan. */
+	start_before_setup_rc = ads1x1x_scan_start(ch0.dev);
+
+	zassert_ok(adc_channel_setup_dt(&ch0));
+	zassert_ok(ads1x1x_scan_start(ch0.dev), "first consumer starts the scan");
+	/* The second consumer sets up after the scan started and joins it. */
+	zassert_ok(adc_channel_setup_dt(&ch1));
+	zassert_ok(ads1x1x_scan_start(ch1.dev), "second start is a no-op");
+
+	return NULL;
+}
+
+ZTEST_SUITE(ads1x1x_scan, NULL, scan_setup, NULL, NULL, NULL);
+
+/* Discard whatever the previous test left buffered on a channel. */
+static void flush(const struct adc_dt_spec *spec)
+{
+	struct ads1x1x_scan_sample junk[RING_DEPTH];
+
+	(void)ads1x1x_scan_drain(spec->dev, spec->channel_id, junk, ARRAY_SIZE(junk));
+	(void)ads1x1x_scan_wait(spec->dev, spec->channel_id, K_NO_WAIT);
+}
+
+/* Wait for the next complete burst and return what the ring holds. */
+static size_t next_batch(const struct adc_dt_spec *spec,
+			 struct ads1x1x_scan_sample *out, size_t max)
+{
+	flush(spec);
+	zassert_ok(ads1x1x_scan_wait(spec->dev, spec->channel_id, BURST_WAIT),
+		   "no burst on channel %u", spec->channel_id);
+
+	return ads1x1x_scan_drain(spec->dev, spec->channel_id, out, max);
+}
+
+ZTEST(ads1x1x_scan, test_start_needs_a_channel)
+{
+	zassert_equal(start_before_setup_rc, -EINVAL);
+}
+
+ZTEST(ads1x1x_scan, test_each_channel_reads_only_its_settled_mux)
+{
+	static const struct {
+		const struct adc_dt_spec *spec;
+		int16_t expect;
+	} chans[] = {
+		{ &ch0, EXPECT_CH0_AIN0_1 },
+		{ &ch1, EXPECT_CH1_AIN2_3 },
+	};
+	struct ads1x1x_scan_sample batch[RING_DEPTH];
+
+	/* Several bursts each, so both channels see repeated MUX moves. */
+	for (int round = 0; round < 3; round++) {
+		for (size_t c = 0; c < ARRAY_SIZE(chans); c++) {
+			size_t n = next_batch(chans[c].spec, batch, ARRAY_SIZE(batch));
+
+			zassert_true(n >= (size_t)CONFIG_ADC_ADS1X1X_LOCAL_SCAN_BURST,
+				     "short burst: %zu", n);
+			for (size_t i = 0; i < n; i++) {
+				zassert_equal(batch[i].counts, chans[c].expect,
+					      "channel %zu sample %zu read %d (unsettled?)",
+					      c, i, batch[i].counts);
+			}
+		}
+	}
+}
+
+ZTEST(ads1x1x_scan, test_sample_ticks_are_ordered_and_recent)
+{
+	struct ads1x1x_scan_sample batch[RING_DEPTH];
+	size_t n = next_batch(&ch0, batch, ARRAY_SIZE(batch));
+	int64_t now = k_uptime_ticks();
+
+	zassert_true(n > 0U);
+	for (size_t i = 1; i < n; i++) {
+		zassert_true(batch[i].ticks > batch[i - 1U].ticks,
+			     "sample %zu not newer than the one before", i);
+	}
+	zassert_true(batch[n - 1U].ticks <= now, "sample from the future");
+	zassert_true((now - batch[0].ticks) < k_ms_to_ticks_ceil64(BACKLOG_MS),
+		     "tick stamp widened wrongly");
+}
+
+ZTEST(ads1x1x_scan, test_slow_consumer_is_bounded_by_ring)
+{
+	struct ads1x1x_scan_sample batch[2U * RING_DEPTH];
+	size_t n;
+
+	flush(&ch1);
+	k_msleep(BACKLOG_MS);
+
+	n = ads1x1x_scan_drain(ch1.dev, ch1.channel_id, batch, ARRAY_SIZE(batch));
+	zassert_equal(n, (size_t)RING_DEPTH, "backlog of %zu", n);
+	for (size_t i = 0; i < n; i++) {
+		zassert_equal(batch[i].counts, EXPECT_CH1_AIN2_3);
+	}
+
+	/* Dropping kept the scan going: the next burst still lands. */
+	n = next_batch(&ch1, batch, ARRAY_SIZE(batch));
+	zassert_true(n > 0U);
+}
+
+ZTEST(ads1x1x_scan, test_adc_read_refused_while_scanning)
+{
+	struct adc_sequence seq = {0};
+	int16_t v = 0;
+
+	(void)adc_sequence_init_dt(&ch0, &seq);
+	seq.buffer = &v;
+	seq.buffer_size = sizeof(v);
+
+	zassert_equal(adc_read_dt(&ch0, &seq), -EBUSY);
+}
+
+ZTEST(ads1x1x_scan, test_rejects_bad_channel)
+{
+	struct ads1x1x_scan_sample s;
+
+	zassert_equal(ads1x1x_scan_wait(ch0.dev, 4U, K_NO_WAIT), -EINVAL);
+	zassert_equal(ads1x1x_scan_drain(ch0.dev, 4U, &s, 1U), 0U);
+	zassert_equal(ads1x1x_scan_drain(ch0.dev, 0U, NULL, 1U), 0U);
+}
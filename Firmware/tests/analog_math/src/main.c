@@ -183,3 +183,165 @@ ZTEST(calculate_ppo2, test_small_counts)
     /* 10 * 0.78128 * 0.02 = 0.156 */
     zassert_within(ppo2, 0.156f, 0.01f);
 }
+
+/* ============================================================================
+ * Analog filter stage
+ * ============================================================================
+ * Fixed-point mean / median / IIR with decimation by taps, plus the nominal
+ * noise-gain and group-delay figures reported on the 0xF4NE DID.
+ * ============================================================================ */
+
+/** @brief Suite: analog filter stage (analog_filter_*). */
+ZTEST_SUITE(analog_filter, NULL, NULL, NULL, NULL, NULL);
+
+/** @brief Feed samples and return how many outputs came out; last in *out. */
+static uint32_t feed(AnalogFilter_t *f, const int16_t *in, size_t n, int16_t *out)
+{
+    uint32_t outputs = 0U;
+
+    for (size_t i = 0U; i < n; ++i) {
+        if (analog_filter_push(f, in[i], out)) {
+            ++outputs;
+        }
+    }
+    return outputs;
+}
+
+/** @brief With no filter every sample is published unchanged. */
+ZTEST(analog_filter, test_none_passes_every_sample)
+{
+    AnalogFilter_t f;
+    AnalogFilterConfig_t cfg = {ANALOG_FILTER_NONE, 1U, 0U};
+    int16_t out = 0;
+
+    zassert_true(analog_filter_init(&f, cfg));
+    zassert_true(analog_filter_push(&f, 1234, &out));
+    zassert_equal(out, 1234);
+    zassert_true(analog_filter_push(&f, -7, &out));
+    zassert_equal(out, -7);
+}
+
+/** @brief Mean decimates by taps and rounds half away from zero. */
+ZTEST(analog_filter, test_mean_decimates_and_rounds)
+{
+    AnalogFilter_t f;
+    AnalogFilterConfig_t cfg = {ANALOG_FILTER_MEAN, 4U, 0U};
+    const int16_t pos[] = {10, 11, 12, 13};   /* 11.5 */
+    const int16_t neg[] = {-3, -4, -4, -4};   /* -3.75 */
+    int16_t out = 0;
+
+    zassert_true(analog_filter_init(&f, cfg));
+    zassert_false(analog_filter_push(&f, 10, &out), "no output mid-block");
+    zassert_equal(feed(&f, &pos[1], 3U, &out), 1U);
+    zassert_equal(out, 12);
+    zassert_equal(feed(&f, neg, ARRAY_SIZE(neg), &out), 1U);
+    zassert_equal(out, -4);
+}
+
+/** @brief Median rejects a single spike; an even window averages the middle pair. */
+ZTEST(analog_filter, test_median_rejects_spike)
+{
+    AnalogFilter_t f;
+    AnalogFilterConfig_t odd = {ANALOG_FILTER_MEDIAN, 5U, 0U};
+    AnalogFilterConfig_t even = {ANALOG_FILTER_MEDIAN, 4U, 0U};
+    const int16_t spiky[] = {1000, 1002, 30000, 998, 1001};
+    const int16_t pair[] = {1, 9, 4, 2};      /* middle pair 2, 4 */
+    int16_t out = 0;
+
+    zassert_true(analog_filter_init(&f, odd));
+    zassert_equal(feed(&f, spiky, ARRAY_SIZE(spiky), &out), 1U);
+    zassert_equal(out, 1001);
+
+    zassert_true(analog_filter_init(&f, even));
+    zassert_equal(feed(&f, pair, ARRAY_SIZE(pair), &out), 1U);
+    zassert_equal(out, 3);
+}
+
+/** @brief IIR starts at the first sample and settles exactly on a step, both signs. */
+ZTEST(analog_filter, test_iir_settles_without_bias)
+{
+    AnalogFilter_t f;
+    AnalogFilterConfig_t cfg = {ANALOG_FILTER_IIR, 2U, 2U};
+    int16_t out = 0;
+
+    zassert_true(analog_filter_init(&f, cfg));
+    zassert_false(analog_filter_push(&f, 500, &out));
+    zassert_true(analog_filter_push(&f, 500, &out));
+    zassert_equal(out, 500, "primed with the first sample, no ramp from zero");
+
+    for (int i = 0; i < 64; ++i) {
+        (void)analog_filter_push(&f, 1000, &out);
+    }
+    zassert_equal(out, 1000);
+    for (int i = 0; i < 64; ++i) {
+        (void)analog_filter_push(&f, -1000, &out);
+    }
+    zassert_equal(out, -1000);
+}
+
+/** @brief An out-of-range configuration degrades to unfiltered output. */
+ZTEST(analog_filter, test_invalid_config_falls_back_to_none)
+{
+    AnalogFilter_t f;
+    AnalogFilterConfig_t too_long = {ANALOG_FILTER_MEAN, ANALOG_FILTER_MAX_TAPS + 1U, 0U};
+    AnalogFilterConfig_t no_shift = {ANALOG_FILTER_IIR, 4U, 0U};
+    int16_t out = 0;
+
+    zassert_false(analog_filter_init(&f, too_long));
+    zassert_equal(f.cfg.kind, ANALOG_FILTER_NONE);
+    zassert_true(analog_filter_push(&f, 42, &out));
+    zassert_equal(out, 42);
+
+    zassert_false(analog_filter_init(&f, no_shift));
+    zassert_equal(f.cfg.kind, ANALOG_FILTER_NONE);
+}
+
+/** @brief Nominal noise gain and group delay per filter shape. */
+ZTEST(analog_filter, test_nominal_figures)
+{
+    AnalogFilterConfig_t none = {ANALOG_FILTER_NONE, 1U, 0U};
+    AnalogFilterConfig_t mean4 = {ANALOG_FILTER_MEAN, 4U, 0U};
+    AnalogFilterConfig_t median2 = {ANALOG_FILTER_MEDIAN, 2U, 0U};
+    AnalogFilterConfig_t iir2 = {ANALOG_FILTER_IIR, 4U, 2U};
+
+    zassert_equal(analog_filter_noise_gain_permille(none), 1000U);
+    zassert_equal(analog_filter_group_delay_dsamples(none), 0U);
+
+    zassert_equal(analog_filter_noise_gain_permille(mean4), 500U);
+    zassert_equal(analog_filter_group_delay_dsamples(mean4), 15U, "1.5 samples");
+
+    zassert_equal(analog_filter_noise_gain_permille(median2), 707U,
+                  "median of two is their mean");
+
+    /* alpha = 1/4: sqrt(0.25 / 1.75) = 0.378; delay 2^2 - 1 = 3 samples. */
+    zassert_equal(analog_filter_noise_gain_permille(iir2), 378U);
+    zassert_equal(analog_filter_group_delay_dsamples(iir2), 30U);
+}
+
+/** @brief Stats count samples, scale delay by the period and estimate noise. */
+ZTEST(analog_filter, test_stats_track_noise)
+{
+    AnalogFilter_t f;
+    AnalogFilterConfig_t cfg = {ANALOG_FILTER_MEAN, 4U, 0U};
+    AnalogFilterStats_t st;
+    int16_t out = 0;
+
+    zassert_true(analog_filter_init(&f, cfg));
+    for (int i = 0; i < 400; ++i) {
+        (void)analog_filter_push(&f, 1000, &out);
+    }
+    analog_filter_stats(&f, 10000U, &st);
+    zassert_equal(st.samples_in, 400U);
+    zassert_equal(st.samples_out, 100U);
+    zassert_equal(st.input_noise_nv, 0U, "steady input is noiseless");
+    zassert_equal(st.group_delay_us, 15000U, "1.5 samples at 10 ms");
+
+    /* Alternating +/-10 counts: first difference 20, so sigma = 20/sqrt(2)
+     * ~= 14.1 counts ~= 110 uV at the cell. */
+    for (int i = 0; i < 400; ++i) {
+        (void)analog_filter_push(&f, (int16_t)(((i % 2) == 0) ? 1010 : 990), &out);
+    }
+    analog_filter_stats(&f, 10000U, &st);
+    zassert_within(st.input_noise_nv, 110486U, 2000U);
+    zassert_within(st.output_noise_nv, st.input_noise_nv / 2U, 100U);
+}
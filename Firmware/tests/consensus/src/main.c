@@ -7,6 +7,10 @@
  * 3-cell voting algorithm (outlier exclusion, staleness, status filtering).
  * Uses a permutation helper to verify that the algorithm is insensitive to
  * cell ordering in the input array.
+ *
+ * Every voting test also runs in the consensus_sorted suite against
+ * consensus_calculate_sorted(), proving the N-sensor voter keeps the 2/3-cell
+ * behaviour; consensus_voter covers what only the N-sensor voter can do.
  */
 
 #include <zephyr/ztest.h>
@@ -29,10 +33,43 @@ void op_error_publish(OpError_t code, uint32_t detail)
 #define STALENESS_TICKS 10000LL
 #define NOW_TICKS       0LL
 
+/** @brief Consensus engine under test; set by each suite's before hook. */
+typedef ConsensusMsg_t (*ConsensusEngine_t)(const OxygenCellMsg_t cells[],
+                                            uint8_t count,
+                                            int64_t now_ticks,
+                                            int64_t staleness_ticks);
+
+static ConsensusEngine_t consensus_engine = consensus_calculate;
+
+/** @brief Vote @p cells with the engine of the running suite. */
+static ConsensusMsg_t run_consensus(const OxygenCellMsg_t cells[],
+                                    uint8_t count, int64_t now_ticks,
+                                    int64_t staleness_ticks)
+{
+    return consensus_engine(cells, count, now_ticks, staleness_ticks);
+}
+
+/**
+ * @brief Define a voting test that runs in both the consensus suite
+ *        (consensus_calculate()) and the consensus_sorted suite
+ *        (consensus_calculate_sorted()).
+ */
+#define CONSENSUS_ZTEST(name)                                                 \
+    static void name##_body(void);                                            \
+    ZTEST(consensus, name)                                                    \
+    {                                                                         \
+        name##_body();                                                        \
+    }                                                                         \
+    ZTEST(consensus_sorted, name)                                             \
+    {                                                                         \
+        name##_body();                                                        \
+    }                                                                         \
+    static void name##_body(void)
+
 /**
  * @brief Run a consensus test across all 6 orderings of 3 cells.
  *
- * Verifies that consensus_calculate() produces the same result regardless of
+ * Verifies that the engine under test produces the same result regardless of
  * which physical position each cell occupies in the input array.  Expected
  * arrays are indexed by *logical* cell identity (0=c1, 1=c2, 2=c3); the
  * helper remaps them to match each permutation before asserting.
@@ -61,7 +98,7 @@ static void check_consensus_permutations(
             *cells_src[p2],
         };
 
-        ConsensusMsg_t result = consensus_calculate(
+        ConsensusMsg_t result = run_consensus(
             input, 3, NOW_TICKS, STALENESS_TICKS);
 
         zassert_equal(result.status_array[0],
@@ -125,11 +162,26 @@ static OxygenCellMsg_t make_cell(uint8_t num, PPO2_t ppo2, double prec,
     };
 }
 
+static void use_configured_engine(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    consensus_engine = consensus_calculate;
+}
+
+static void use_sorted_engine(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    consensus_engine = consensus_calculate_sorted;
+}
+
 /** @brief Suite: three-cell consensus voting and averaging algorithm. */
-ZTEST_SUITE(consensus, NULL, NULL, NULL, NULL, NULL);
+ZTEST_SUITE(consensus, NULL, NULL, use_configured_engine, NULL, NULL);
+
+/** @brief Suite: the voting tests again, through the sorted-window voter. */
+ZTEST_SUITE(consensus_sorted, NULL, NULL, use_sorted_engine, NULL, NULL);
 
 /** @brief Three agreeing cells are all included and their PPO2 is averaged. */
-ZTEST(consensus, test_averages_cells)
+CONSENSUS_ZTEST(test_averages_cells)
 {
     OxygenCellMsg_t c1 = make_cell(0, 110, 1.1, 12, CELL_OK, 0);
     OxygenCellMsg_t c2 = make_cell(1, 115, 1.15, 13, CELL_OK, 0);
@@ -147,7 +199,7 @@ ZTEST(consensus, test_averages_cells)
 }
 
 /** @brief A cell reading significantly higher than the other two is excluded from the consensus. */
-ZTEST(consensus, test_excludes_high)
+CONSENSUS_ZTEST(test_excludes_high)
 {
     OxygenCellMsg_t c1 = make_cell(0, 110, 1.1, 0, CELL_OK, 0);
     OxygenCellMsg_t c2 = make_cell(1, 130, 1.3, 0, CELL_OK, 0);
@@ -165,7 +217,7 @@ ZTEST(consensus, test_excludes_high)
 }
 
 /** @brief A cell reading very far above the pair is also excluded (large spread). */
-ZTEST(consensus, test_excludes_very_high)
+CONSENSUS_ZTEST(test_excludes_very_high)
 {
     OxygenCellMsg_t c1 = make_cell(0, 50, 0.5, 0, CELL_OK, 0);
     OxygenCellMsg_t c2 = make_cell(1, 130, 1.3, 0, CELL_OK, 0);
@@ -183,7 +235,7 @@ ZTEST(consensus, test_excludes_very_high)
 }
 
 /** @brief A cell reading significantly lower than the other two is excluded. */
-ZTEST(consensus, test_excludes_low)
+CONSENSUS_ZTEST(test_excludes_low)
 {
     OxygenCellMsg_t c1 = make_cell(0, 120, 1.2, 0, CELL_OK, 0);
     OxygenCellMsg_t c2 = make_cell(1, 130, 1.3, 0, CELL_OK, 0);
@@ -201,7 +253,7 @@ ZTEST(consensus, test_excludes_low)
 }
 
 /** @brief A cell reading very far below the pair is also excluded (large spread). */
-ZTEST(consensus, test_excludes_very_low)
+CONSENSUS_ZTEST(test_excludes_very_low)
 {
     OxygenCellMsg_t c1 = make_cell(0, 120, 1.2, 0, CELL_OK, 0);
     OxygenCellMsg_t c2 = make_cell(1, 130, 1.3, 0, CELL_OK, 0);
@@ -224,7 +276,7 @@ ZTEST(consensus, test_excludes_very_low)
  * Iterates over each cell position to confirm that staleness detection is
  * position-independent.
  */
-ZTEST(consensus, test_excludes_timed_out_cell)
+CONSENSUS_ZTEST(test_excludes_timed_out_cell)
 {
     /* Round-to-nearest of the two-cell average (ppo2_centibar_to_wire):
      * i=0 -> ~106.99999 -> 107, i=1 -> ~109.99999 -> 110, i=2 -> ~112.99999 -> 113.
@@ -268,7 +320,7 @@ ZTEST(consensus, test_excludes_timed_out_cell)
  * Iterates over each cell position to confirm that status filtering is
  * position-independent.
  */
-ZTEST(consensus, test_excludes_failed_cell)
+CONSENSUS_ZTEST(test_excludes_failed_cell)
 {
     /* Round-to-nearest of the two-cell average (ppo2_centibar_to_wire):
      * i=0 -> ~106.99999 -> 107, i=1 -> ~109.99999 -> 110, i=2 -> ~112.99999 -> 113.
@@ -307,7 +359,7 @@ ZTEST(consensus, test_excludes_failed_cell)
 }
 
 /** @brief A cell with CELL_NEED_CAL status is excluded from voting. */
-ZTEST(consensus, test_excludes_cal_cell)
+CONSENSUS_ZTEST(test_excludes_cal_cell)
 {
     /* Round-to-nearest of the two-cell average (ppo2_centibar_to_wire):
      * i=0 -> ~106.99999 -> 107, i=1 -> ~109.99999 -> 110, i=2 -> ~112.99999 -> 113.
@@ -346,7 +398,7 @@ ZTEST(consensus, test_excludes_cal_cell)
 }
 
 /** @brief A cell with CELL_DEGRADED status is excluded from voting. */
-ZTEST(consensus, test_excludes_degraded_cell)
+CONSENSUS_ZTEST(test_excludes_degraded_cell)
 {
     /* Round-to-nearest of the two-cell average (ppo2_centibar_to_wire):
      * i=0 -> ~106.99999 -> 107, i=1 -> ~109.99999 -> 110, i=2 -> ~112.99999 -> 113.
@@ -390,7 +442,7 @@ ZTEST(consensus, test_excludes_degraded_cell)
  * A single surviving cell cannot form a majority vote, so include_array is all
  * false even though the consensus_ppo2 reflects that cell's reading.
  */
-ZTEST(consensus, test_dual_cell_failure)
+CONSENSUS_ZTEST(test_dual_cell_failure)
 {
     uint8_t expected_consensus[] = {120, 110, 100};
 
@@ -420,7 +472,7 @@ ZTEST(consensus, test_dual_cell_failure)
 }
 
 /** @brief Single surviving cell with a diverged value: still used for consensus, voted out. */
-ZTEST(consensus, test_diverged_dual_cell_failure)
+CONSENSUS_ZTEST(test_diverged_dual_cell_failure)
 {
     uint8_t expected_consensus[] = {200, 100, 20};
 
@@ -449,7 +501,7 @@ ZTEST(consensus, test_diverged_dual_cell_failure)
 }
 
 /** @brief All three cells failed: consensus is PPO2_FAIL (0xFF) and all are excluded. */
-ZTEST(consensus, test_all_cells_excluded)
+CONSENSUS_ZTEST(test_all_cells_excluded)
 {
     OxygenCellMsg_t c1 = make_cell(0, 120, 1.2, 0, CELL_FAIL, 0);
     OxygenCellMsg_t c2 = make_cell(1, 110, 1.1, 0, CELL_FAIL, 0);
@@ -472,7 +524,7 @@ ZTEST(consensus, test_all_cells_excluded)
  * The single non-failed, non-zero cell provides the consensus value but cannot
  * form a majority, so include_array is all false.
  */
-ZTEST(consensus, test_fail_and_zeroed_cell)
+CONSENSUS_ZTEST(test_fail_and_zeroed_cell)
 {
     OxygenCellMsg_t c1 = make_cell(0, 25, 1.1, 12, CELL_FAIL, 0);
     OxygenCellMsg_t c2 = make_cell(1, 21, 1.15, 13, CELL_OK, 0);
@@ -492,7 +544,7 @@ ZTEST(consensus, test_fail_and_zeroed_cell)
 /**
  * @brief One CELL_FAIL and one cell reading PPO2_FAIL (0xFF): treated same as zeroed case.
  */
-ZTEST(consensus, test_fail_and_fail_valued_cell)
+CONSENSUS_ZTEST(test_fail_and_fail_valued_cell)
 {
     OxygenCellMsg_t c1 = make_cell(0, 25, 1.1, 12, CELL_FAIL, 0);
     OxygenCellMsg_t c2 = make_cell(1, 21, 1.15, 13, CELL_OK, 0);
@@ -539,11 +591,11 @@ ZTEST(consensus, test_confidence)
 /**
  * @brief Single-cell configuration: value used for consensus, but voted out (no majority possible).
  */
-ZTEST(consensus, test_single_cell)
+CONSENSUS_ZTEST(test_single_cell)
 {
     OxygenCellMsg_t cell = make_cell(0, 100, 1.0, 10, CELL_OK, 0);
 
-    ConsensusMsg_t result = consensus_calculate(&cell, 1, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(&cell, 1, NOW_TICKS,
                             STALENESS_TICKS);
 
     /* Single cell: value used, but voted out (no actual vote possible) */
@@ -553,14 +605,14 @@ ZTEST(consensus, test_single_cell)
 }
 
 /** @brief Two-cell configuration where both agree: both included, consensus is their average. */
-ZTEST(consensus, test_two_cells_agree)
+CONSENSUS_ZTEST(test_two_cells_agree)
 {
     OxygenCellMsg_t cells[2] = {
         make_cell(0, 100, 1.0, 10, CELL_OK, 0),
         make_cell(1, 110, 1.1, 11, CELL_OK, 0),
     };
 
-    ConsensusMsg_t result = consensus_calculate(cells, 2, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(cells, 2, NOW_TICKS,
                             STALENESS_TICKS);
 
     zassert_equal(result.consensus_ppo2, 105);
@@ -570,14 +622,14 @@ ZTEST(consensus, test_two_cells_agree)
 }
 
 /** @brief Two-cell configuration where both diverge: neither wins the vote, consensus = PPO2_FAIL. */
-ZTEST(consensus, test_two_cells_disagree)
+CONSENSUS_ZTEST(test_two_cells_disagree)
 {
     OxygenCellMsg_t cells[2] = {
         make_cell(0, 50, 0.5, 5, CELL_OK, 0),
         make_cell(1, 130, 1.3, 13, CELL_OK, 0),
     };
 
-    ConsensusMsg_t result = consensus_calculate(cells, 2, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(cells, 2, NOW_TICKS,
                             STALENESS_TICKS);
 
     /* Both voted out — consensus stays PPO2_FAIL */
@@ -591,7 +643,7 @@ ZTEST(consensus, test_two_cells_disagree)
  * Prevents wrapping the uint8_t result, which could silently report a safe low
  * reading in place of a dangerously high one.
  */
-ZTEST(consensus, test_overflow_saturates)
+CONSENSUS_ZTEST(test_overflow_saturates)
 {
     OxygenCellMsg_t c1 = make_cell(0, 254, 2.55, 0, CELL_OK, 0);
     OxygenCellMsg_t c2 = make_cell(1, 254, 2.55, 0, CELL_OK, 0);
@@ -599,7 +651,7 @@ ZTEST(consensus, test_overflow_saturates)
 
     OxygenCellMsg_t cells[3] = {c1, c2, c3};
 
-    ConsensusMsg_t result = consensus_calculate(cells, 3, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(cells, 3, NOW_TICKS,
                             STALENESS_TICKS);
 
     /* 2.55 bar * 100 = 255 > MAX_VALID_PPO2(254), must saturate */
@@ -615,14 +667,14 @@ ZTEST(consensus, test_overflow_saturates)
  * uint8_t wire value. Distinct from test_overflow_saturates which drives the
  * three-cell path.
  */
-ZTEST(consensus, test_two_cells_overflow_saturates)
+CONSENSUS_ZTEST(test_two_cells_overflow_saturates)
 {
     OxygenCellMsg_t cells[2] = {
         make_cell(0, 254, 2.55, 0, CELL_OK, 0),
         make_cell(1, 254, 2.55, 0, CELL_OK, 0),
     };
 
-    ConsensusMsg_t result = consensus_calculate(cells, 2, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(cells, 2, NOW_TICKS,
                             STALENESS_TICKS);
 
     /* (2.55 + 2.55) / 2 * 100 = 255 > MAX_VALID_PPO2(254), must saturate */
@@ -636,7 +688,7 @@ ZTEST(consensus, test_two_cells_overflow_saturates)
  * Drives the three-cell path where even the closest pair exceeds
  * MAX_DEVIATION, so all three cells are voted out (no reliable reading).
  */
-ZTEST(consensus, test_three_cells_all_diverge)
+CONSENSUS_ZTEST(test_three_cells_all_diverge)
 {
     OxygenCellMsg_t cells[3] = {
         make_cell(0, 50, 0.50, 0, CELL_OK, 0),
@@ -644,7 +696,7 @@ ZTEST(consensus, test_three_cells_all_diverge)
         make_cell(2, 150, 1.50, 0, CELL_OK, 0),
     };
 
-    ConsensusMsg_t result = consensus_calculate(cells, 3, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(cells, 3, NOW_TICKS,
                             STALENESS_TICKS);
 
     /* Closest pair differs by 0.50 bar = 50 cbar > MAX_DEVIATION(15) */
@@ -660,7 +712,7 @@ ZTEST(consensus, test_three_cells_all_diverge)
  * MAX_VALID_PPO2 and must saturate to PPO2_FAIL. Covers the saturation arm of
  * the two-of-three branch.
  */
-ZTEST(consensus, test_three_cells_pair_overflow_saturates)
+CONSENSUS_ZTEST(test_three_cells_pair_overflow_saturates)
 {
     OxygenCellMsg_t cells[3] = {
         make_cell(0, 254, 2.55, 0, CELL_OK, 0),
@@ -668,7 +720,7 @@ ZTEST(consensus, test_three_cells_pair_overflow_saturates)
         make_cell(2, 50, 0.50, 0, CELL_OK, 0),
     };
 
-    ConsensusMsg_t result = consensus_calculate(cells, 3, NOW_TICKS,
+    ConsensusMsg_t result = run_consensus(cells, 3, NOW_TICKS,
                             STALENESS_TICKS);
 
     /* Pair average 2.55 bar -> 255 cbar > MAX_VALID_PPO2(254), must saturate.
@@ -785,14 +837,14 @@ ZTEST(consensus, test_wire_clamps_range)
  * of 69 centibar (0.69) instead of 70. This drives the full consensus path with
  * agreeing perfect cells at two setpoints and asserts no downward bias.
  */
-ZTEST(consensus, test_perfect_cells_consensus_not_low)
+CONSENSUS_ZTEST(test_perfect_cells_consensus_not_low)
 {
     OxygenCellMsg_t a = make_cell(0, 70, 0.70, 42, CELL_OK, 0);
     OxygenCellMsg_t b = make_cell(1, 70, 0.70, 42, CELL_OK, 0);
     OxygenCellMsg_t c = make_cell(2, 70, 0.70, 42, CELL_OK, 0);
     OxygenCellMsg_t at_070[3] = {a, b, c};
 
-    ConsensusMsg_t r70 = consensus_calculate(at_070, 3, NOW_TICKS,
+    ConsensusMsg_t r70 = run_consensus(at_070, 3, NOW_TICKS,
                           STALENESS_TICKS);
     zassert_equal(r70.consensus_ppo2, 70,
               "three perfect 0.70 cells must read 70, not 69");
@@ -802,7 +854,7 @@ ZTEST(consensus, test_perfect_cells_consensus_not_low)
     OxygenCellMsg_t f = make_cell(2, 130, 1.30, 78, CELL_OK, 0);
     OxygenCellMsg_t at_130[3] = {d, e, f};
 
-    ConsensusMsg_t r130 = consensus_calculate(at_130, 3, NOW_TICKS,
+    ConsensusMsg_t r130 = run_consensus(at_130, 3, NOW_TICKS,
                            STALENESS_TICKS);
     zassert_equal(r130.consensus_ppo2, 130,
               "three perfect 1.30 cells must read 130, not 129");
@@ -812,10 +864,220 @@ ZTEST(consensus, test_perfect_cells_consensus_not_low)
         make_cell(0, 70, 0.70, 42, CELL_OK, 0),
         make_cell(1, 70, 0.70, 42, CELL_OK, 0),
     };
-    ConsensusMsg_t r2 = consensus_calculate(two, 2, NOW_TICKS, STALENESS_TICKS);
+    ConsensusMsg_t r2 = run_consensus(two, 2, NOW_TICKS, STALENESS_TICKS);
     zassert_equal(r2.consensus_ppo2, 70, "two perfect 0.70 cells must read 70");
 }
 
+/* ---- N-sensor sorted-window voter ----
+ *
+ * consensus_vote_sorted() on its own: more sensors than a ConsensusMsg_t
+ * holds, weights, and exact agreement with the pairwise fixed-point engine.
+ */
+
+/** @brief Xorshift32, so the random sweep is reproducible. */
+static uint32_t rng_next(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/** @brief Uniform float in [lo, hi). */
+static float rng_uniform(uint32_t *state, float lo, float hi)
+{
+    return lo + ((hi - lo) * ((float)(rng_next(state) >> 8) / 16777216.0f));
+}
+
+/** @brief Suite: N-sensor sorted-window voter. */
+ZTEST_SUITE(consensus_voter, NULL, NULL, NULL, NULL, NULL);
+
+/** @brief Dual head: four agreeing sensors out-vote a low and a high outlier. */
+ZTEST(consensus_voter, test_six_sensors_two_outliers)
+{
+    const PrecisionPPO2_t bar[6] = {1.00f, 1.02f, 0.98f, 1.01f, 0.60f, 1.40f};
+    ConsensusVote_t vote = {0};
+
+    consensus_vote_sorted(bar, NULL, 6U, &vote);
+
+    zassert_equal(vote.ppo2, 100, "mean of the cluster is 1.0025 bar");
+    zassert_equal(vote.included_mask, 0x0FU, "sensors 4 and 5 voted out");
+    zassert_equal(vote.confidence, 4U, "four sensors agree");
+    zassert_within(vote.precision, 1.0025f, 1e-5f, "precision mean");
+}
+
+/**
+ * @brief A tight minority pair does not out-vote a looser majority: the four
+ *        sensors at 0.70-0.76 bar agree, the pair at 0.50/0.51 is voted out.
+ */
+ZTEST(consensus_voter, test_majority_beats_tight_pair)
+{
+    const PrecisionPPO2_t bar[6] = {0.70f, 0.50f, 0.74f, 0.51f, 0.76f, 0.72f};
+    ConsensusVote_t vote = {0};
+
+    consensus_vote_sorted(bar, NULL, 6U, &vote);
+
+    zassert_equal(vote.ppo2, 73, "mean of the majority is 0.73 bar");
+    zassert_equal(vote.included_mask, 0x35U, "sensors 1 and 3 voted out");
+    zassert_equal(vote.confidence, 4U, "four sensors agree");
+    zassert_within(vote.precision, 0.73f, 1e-5f, "precision mean");
+}
+
+/** @brief Equal-sized clusters: the one with the smaller spread wins. */
+ZTEST(consensus_voter, test_equal_clusters_smaller_spread)
+{
+    const PrecisionPPO2_t bar[4] = {0.60f, 0.70f, 1.20f, 1.22f};
+    ConsensusVote_t vote = {0};
+
+    consensus_vote_sorted(bar, NULL, 4U, &vote);
+
+    zassert_equal(vote.ppo2, 121, "the 0.02 bar pair wins");
+    zassert_equal(vote.included_mask, 0x0CU);
+    zassert_equal(vote.confidence, 2U);
+}
+
+/** @brief Weights scale each sensor's share of the mean. */
+ZTEST(consensus_voter, test_weighted_mean)
+{
+    const PrecisionPPO2_t bar[2] = {1.00f, 1.08f};
+    const uint8_t weights[2] = {3U, 1U};
+    ConsensusVote_t vote = {0};
+
+    consensus_vote_sorted(bar, weights, 2U, &vote);
+
+    zassert_equal(vote.ppo2, 102, "(3 * 1.00 + 1.08) / 4 = 1.02 bar");
+    zassert_equal(vote.included_mask, 0x03U, "both sensors agree");
+    zassert_equal(vote.confidence, 2U);
+    zassert_within(vote.precision, 1.02f, 1e-5f, "weighted precision");
+}
+
+/** @brief Every ordering of six sensors votes the same cluster and mean. */
+ZTEST(consensus_voter, test_six_sensor_permutations)
+{
+    const PrecisionPPO2_t logical[6] = {1.00f, 1.03f, 0.97f, 1.01f, 0.70f, 1.30f};
+    uint8_t perm[6] = {0U, 1U, 2U, 3U, 4U, 5U};
+    ConsensusVote_t reference = {0};
+    uint32_t checked = 0U;
+    bool more = true;
+
+    consensus_vote_sorted(logical, NULL, 6U, &reference);
+    zassert_equal(reference.included_mask, 0x0FU, "outliers voted out");
+
+    /* Walk all 720 orderings in lexicographic order */
+    while (more) {
+        PrecisionPPO2_t bar[6] = {0};
+        uint8_t expected_mask = 0U;
+        ConsensusVote_t vote = {0};
+
+        for (uint8_t i = 0U; i < 6U; ++i) {
+            bar[i] = logical[perm[i]];
+            if (0U != (reference.included_mask & (1U << perm[i]))) {
+                expected_mask |= (uint8_t)(1U << i);
+            }
+        }
+        consensus_vote_sorted(bar, NULL, 6U, &vote);
+
+        zassert_equal(vote.ppo2, reference.ppo2, "perm %u: ppo2", checked);
+        zassert_equal(vote.included_mask, expected_mask, "perm %u: mask", checked);
+        zassert_equal(vote.confidence, reference.confidence,
+                      "perm %u: confidence", checked);
+        ++checked;
+
+        int k = 4;
+
+        while ((k >= 0) && (perm[k] > perm[k + 1])) {
+            --k;
+        }
+        if (k < 0) {
+            more = false;
+        } else {
+            int l = 5;
+
+            while (perm[l] < perm[k]) {
+                --l;
+            }
+            uint8_t tmp = perm[k];
+
+            perm[k] = perm[l];
+            perm[l] = tmp;
+            for (int a = k + 1, b = 5; a < b; ++a, --b) {
+                tmp = perm[a];
+                perm[a] = perm[b];
+                perm[b] = tmp;
+            }
+        }
+    }
+    zassert_equal(checked, 720U, "all orderings checked");
+}
+
+/** @brief A lone candidate is reported but voted out; weight 0 removes one. */
+ZTEST(consensus_voter, test_single_candidate)
+{
+    const PrecisionPPO2_t bar[3] = {0.40f, 1.10f, 1.60f};
+    const uint8_t weights[3] = {0U, 1U, 0U};
+    ConsensusVote_t vote = {0};
+
+    consensus_vote_sorted(bar, weights, 3U, &vote);
+
+    zassert_equal(vote.ppo2, 110, "lone sensor reported");
+    zassert_equal(vote.included_mask, 0U, "but voted out");
+    zassert_equal(vote.confidence, 0U);
+
+    consensus_vote_sorted(bar, NULL, 0U, &vote);
+    zassert_equal(vote.ppo2, PPO2_FAIL, "no sensors fails safe");
+    zassert_equal(vote.confidence, 0U);
+}
+
+/** @brief No pair within MAX_DEVIATION: nothing is included and the vote fails. */
+ZTEST(consensus_voter, test_no_agreeing_pair)
+{
+    const PrecisionPPO2_t bar[4] = {0.50f, 1.00f, 1.50f, 2.00f};
+    ConsensusVote_t vote = {0};
+
+    consensus_vote_sorted(bar, NULL, 4U, &vote);
+
+    zassert_equal(vote.ppo2, PPO2_FAIL, "no cluster fails safe");
+    zassert_equal(vote.included_mask, 0U);
+    zassert_equal(vote.confidence, 0U);
+}
+
+/** @brief Random 2/3-cell votes match the pairwise fixed-point engine bit for bit. */
+ZTEST(consensus_voter, test_matches_pairwise_fixed)
+{
+    uint32_t rng = 0x5EED018U;
+
+    for (uint32_t n = 0U; n < 200000U; ++n) {
+        uint8_t count = (0U == (n & 1U)) ? 3U : 2U;
+        float centre = rng_uniform(&rng, 0.05f, 2.6f);
+        OxygenCellMsg_t cells[3] = {0};
+
+        for (uint8_t i = 0U; i < count; ++i) {
+            PrecisionPPO2_t bar = centre + rng_uniform(&rng, -0.2f, 0.2f);
+            PPO2_t wire = ppo2_centibar_to_wire(bar * 100.0f);
+
+            cells[i] = make_cell(i, (0U == wire) ? 1U : wire, bar, 0,
+                                 CELL_OK, 0);
+        }
+
+        ConsensusMsg_t pairwise = consensus_calculate_fixed(
+            cells, count, NOW_TICKS, STALENESS_TICKS);
+        ConsensusMsg_t sorted = consensus_calculate_sorted(
+            cells, count, NOW_TICKS, STALENESS_TICKS);
+
+        zassert_equal(sorted.consensus_ppo2, pairwise.consensus_ppo2,
+                      "sample %u: consensus", n);
+        zassert_equal(sorted.precision_consensus, pairwise.precision_consensus,
+                      "sample %u: precision", n);
+        for (uint8_t i = 0U; i < CELL_MAX_COUNT; ++i) {
+            zassert_equal(sorted.include_array[i], pairwise.include_array[i],
+                          "sample %u: include[%u]", n, i);
+        }
+    }
+}
+
 /* ---- Calibration-coefficient error reporting (CONFIG_ZBUS build) ----
  *
  * The cal-coefficient helpers in oxygen_cell_math.c are functionally covered
@@ -6,7 +6,11 @@
  * controller (the board's chosen zephyr,canbus), so can_start(), can_send(),
  * and the TX-done callback all complete for real. That lets the tests drive
  * divecan_tx_init / divecan_send / divecan_send_blocking down both their
- * success and failure arms and observe the saturating TX counter.
+ * success and failure arms and observe the TX counter and FIFO statistics.
+ *
+ * divecan_send() only queues; a later divecan_send_blocking() returns once
+ * its own frame, and so every frame queued before it, has completed. The
+ * tests use that to wait for queued frames.
  *
  * Test ordering matters: CONFIG_ZTEST_SHUFFLE is off, so cases run in
  * definition order. The NULL-device arms must run before the CAN device is
@@ -19,8 +23,11 @@
  *   - tx_done_callback()'s error arm and divecan_tx_init()'s can_start()
  *     failure log: the loopback controller never reports a TX error nor fails
  *     to start.
- *   - divecan_send_blocking()'s -ETIMEDOUT arm: the loopback TX thread always
- *     fires the completion callback well inside the 100 ms wait.
+ *   - divecan_send_blocking()'s -ETIMEDOUT arm and the pump's stuck-frame
+ *     arm: the loopback TX thread always fires the completion callback well
+ *     inside the 100 ms wait. tests/divecan_send_lone drives the stuck-frame
+ *     arm against a controller that never ACKs.
+ *   - A full FIFO: the loopback drains it faster than one thread fills it.
  */
 
 #include <zephyr/ztest.h>
@@ -58,6 +65,17 @@ static DiveCANMessage_t make_msg(void)
     return msg;
 }
 
+/** @brief Frames looped back to the test, in bus order. */
+K_MSGQ_DEFINE(loopback_rx_msgq, sizeof(struct can_frame), 32, 4);
+
+static void loopback_rx_cb(const struct device *dev, struct can_frame *frame,
+                           void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(user_data);
+    (void)k_msgq_put(&loopback_rx_msgq, frame, K_NO_WAIT);
+}
+
 /** @brief Suite: real CAN send layer against the loopback controller. */
 ZTEST_SUITE(divecan_send, NULL, NULL, NULL, NULL, NULL);
 
@@ -91,16 +109,17 @@ ZTEST(divecan_send, test_11_init_already_started)
     zassert_equal(divecan_tx_init(can_dev), 0);
 }
 
-/** @brief A successful send returns 0 and advances the saturating TX counter. */
+/** @brief A queued send returns 0 and advances the TX counter once it completes. */
 ZTEST(divecan_send, test_20_send_success_bumps_count)
 {
     DiveCANMessage_t msg = make_msg();
     uint32_t before = divecan_send_get_tx_count();
 
     zassert_equal(divecan_send(&msg), 0);
+    zassert_equal(divecan_send_blocking(&msg), 0);
 
     uint32_t after = divecan_send_get_tx_count();
-    zassert_equal(after, before + 1U, "TX counter must advance by one");
+    zassert_equal(after, before + 2U, "both frames must complete");
 }
 
 /** @brief Blocking send completes via the TX-done callback and bumps the count. */
@@ -115,14 +134,88 @@ ZTEST(divecan_send, test_21_blocking_success)
     zassert_equal(after, before + 1U, "blocking TX counter must advance by one");
 }
 
-/** @brief With the controller stopped, a send fails and takes the error arm. */
+/**
+ * @brief A burst of same-ID frames (an ISO-TP transfer) leaves in queue
+ *        order, and the FIFO statistics account for it.
+ */
+ZTEST(divecan_send, test_22_burst_keeps_order)
+{
+    const uint32_t burst = 20U;
+    struct can_filter filter = {
+        .id = 0x1D000000U,
+        .mask = CAN_EXT_ID_MASK,
+        .flags = CAN_FILTER_IDE,
+    };
+    int filter_id = can_add_rx_filter(can_dev, loopback_rx_cb, NULL, &filter);
+    DivecanTxStats_t before;
+    DivecanTxStats_t after;
+
+    zassert_true(filter_id >= 0);
+    k_msgq_purge(&loopback_rx_msgq);
+    divecan_send_get_stats(&before);
+
+    for (uint32_t i = 0U; i < burst; ++i) {
+        DiveCANMessage_t msg = make_msg();
+
+        msg.data[0] = (uint8_t)i;
+        if ((burst - 1U) == i) {
+            zassert_equal(divecan_send_blocking(&msg), 0);
+        } else {
+            zassert_equal(divecan_send(&msg), 0);
+        }
+    }
+
+    for (uint32_t i = 0U; i < burst; ++i) {
+        struct can_frame frame;
+
+        zassert_ok(k_msgq_get(&loopback_rx_msgq, &frame, K_MSEC(100)));
+        zassert_equal(frame.data[0], (uint8_t)i, "frame %u out of order", i);
+    }
+    can_remove_rx_filter(can_dev, filter_id);
+
+    divecan_send_get_stats(&after);
+    zassert_equal(after.frames_sent, before.frames_sent + burst);
+    zassert_equal(after.tx_errors, before.tx_errors);
+    zassert_equal(after.queue_depth, 32U);
+    zassert_equal(after.queued, 0U);
+    zassert_true(after.queue_high_water >= 1U);
+    zassert_true(after.load_mean_permille > 0U);
+}
+
+/** @brief Serialised statistics: header bytes and the size checks. */
+ZTEST(divecan_send, test_23_stats_serialise)
+{
+    uint8_t buf[DIVECAN_TX_STATS_BYTES] = {0};
+
+    zassert_equal(divecan_send_serialise_stats(NULL, sizeof(buf)), 0U);
+    zassert_equal(divecan_send_serialise_stats(buf, sizeof(buf) - 1U), 0U);
+    zassert_equal(divecan_send_serialise_stats(buf, sizeof(buf)),
+                  DIVECAN_TX_STATS_BYTES);
+    zassert_equal(buf[0], DIVECAN_TX_STATS_VERSION);
+    zassert_equal(buf[1], 32U, "FIFO depth");
+}
+
+/**
+ * @brief With the controller stopped, a queued send is accepted but the
+ *        controller refuses it: counted as a TX error, not as sent.
+ */
 ZTEST(divecan_send, test_30_send_fails_when_stopped)
 {
     DiveCANMessage_t msg = make_msg();
+    DivecanTxStats_t before;
+    DivecanTxStats_t after;
+    uint32_t sent_before = divecan_send_get_tx_count();
 
+    divecan_send_get_stats(&before);
     zassert_ok(can_stop(can_dev));
-    zassert_true(divecan_send(&msg) != 0, "send on a stopped bus must fail");
+    zassert_equal(divecan_send(&msg), 0, "queueing does not touch the bus");
+    zassert_true(divecan_send_blocking(&msg) != 0,
+                 "the frame behind it reports the refusal");
     zassert_ok(can_start(can_dev));
+
+    divecan_send_get_stats(&after);
+    zassert_equal(after.tx_errors, before.tx_errors + 2U);
+    zassert_equal(divecan_send_get_tx_count(), sent_before);
 }
 
 /** @brief With the controller stopped, a blocking send fails on the send arm. */
@@ -0,0 +1,198 @@
+/**
+ * @file main.c
+ * @brief Lone-node tests for the DiveCAN CAN send layer (src/divecan/divecan_send.c).
+ *
+ * A head alone on the bus never sees its frames ACKed; bxCAN keeps retrying
+ * the frame in its mailbox. The zephyr,fake-can controller models that: its
+ * send hook keeps the TX callback and never calls it, its stop hook fails the
+ * pending frame with -ENETDOWN as the STM32 driver does, and the test plays
+ * the peer that finally ACKs.
+ *
+ * The fake's own ztest rule resets every hook before each test, so the suite's
+ * before hook installs them again. Test ordering matters as in the divecan_send
+ * suite: the device is stored once, by the first test.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/can.h>
+#include <zephyr/drivers/can/can_fake.h>
+#include <zephyr/fff.h>
+#include <errno.h>
+
+#include "divecan_tx.h"
+#include "divecan_counters.h"
+#include "errors.h"
+
+DEFINE_FFF_GLOBALS;
+
+/** Broadcast cadence of the PPO2 TX thread (ms). */
+#define BROADCAST_PERIOD_MS 100
+/** Broadcasts in the lone-node test (3 s). From the second one the restart
+ *  waits run 100, 200, 400, 800 and 1600 ms: four restarts fit, the fifth
+ *  does not. Without the back-off there would be one per broadcast. */
+#define LONE_BROADCASTS 30
+
+static const struct device *can_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_canbus));
+
+/** The frame sitting in the fake controller's mailbox. */
+static can_tx_callback_t pending_cb;
+static void *pending_user_data;
+
+static uint32_t can_tx_errors;
+
+/* divecan_send.c reports CAN errors via OP_ERROR/OP_ERROR_DETAIL ->
+ * op_error_publish. This test does not link errors.c, so count them here. */
+void op_error_publish(OpError_t code, uint32_t detail)
+{
+    ARG_UNUSED(detail);
+
+    if (OP_ERR_CAN_TX == code) {
+        ++can_tx_errors;
+    }
+}
+
+/** @brief Complete the pending frame, if any, with @p error. */
+static void finish_pending(int error)
+{
+    can_tx_callback_t cb = pending_cb;
+    void *user_data = pending_user_data;
+
+    pending_cb = NULL;
+    if (NULL != cb) {
+        cb(can_dev, error, user_data);
+    }
+}
+
+/** @brief No other node: the frame stays in the mailbox. */
+static int send_no_ack(const struct device *dev, const struct can_frame *frame,
+                       k_timeout_t timeout, can_tx_callback_t callback,
+                       void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(frame);
+    ARG_UNUSED(timeout);
+
+    pending_cb = callback;
+    pending_user_data = user_data;
+    return 0;
+}
+
+/** @brief A peer on the bus: every frame is ACKed at once. */
+static int send_acked(const struct device *dev, const struct can_frame *frame,
+                      k_timeout_t timeout, can_tx_callback_t callback,
+                      void *user_data)
+{
+    ARG_UNUSED(frame);
+    ARG_UNUSED(timeout);
+
+    callback(dev, 0, user_data);
+    return 0;
+}
+
+/** @brief Stopping the controller aborts the pending frame. */
+static int stop_aborts(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    finish_pending(-ENETDOWN);
+    return 0;
+}
+
+static DiveCANMessage_t make_msg(uint8_t seq)
+{
+    DiveCANMessage_t msg = {0};
+
+    msg.id = 0x0D040004U; /* PPO2 broadcast from the head */
+    msg.length = 4U;
+    msg.data[0] = seq;
+    return msg;
+}
+
+static void lone_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    fake_can_send_fake.custom_fake = send_no_ack;
+    fake_can_stop_fake.custom_fake = stop_aborts;
+    can_tx_errors = 0U;
+}
+
+/** @brief Suite: the send layer with no other node on the bus. */
+ZTEST_SUITE(divecan_send_lone, NULL, NULL, lone_before, NULL, NULL);
+
+ZTEST(divecan_send_lone, test_00_init)
+{
+    zassert_true(device_is_ready(can_dev), "fake CAN must be ready");
+    zassert_ok(divecan_tx_init(can_dev));
+}
+
+/**
+ * @brief Broadcasting alone restarts the controller with a growing wait,
+ *        raises OP_ERR_CAN_TX once, and never holds the sender up.
+ */
+ZTEST(divecan_send_lone, test_10_backs_off_and_latches)
+{
+    for (uint8_t i = 0U; i < LONE_BROADCASTS; ++i) {
+        DiveCANMessage_t msg = make_msg(i);
+        int64_t start = k_uptime_get();
+
+        (void)divecan_send(&msg);
+        zassert_true((k_uptime_get() - start) < BROADCAST_PERIOD_MS,
+                     "a sender must not wait on a stalled bus");
+        k_msleep(BROADCAST_PERIOD_MS);
+    }
+
+    zassert_equal(fake_can_stop_fake.call_count, 4U,
+                  "restarts back off instead of one per frame");
+    zassert_equal(can_tx_errors, 1U, "the stall is reported once");
+}
+
+/**
+ * @brief A peer ACKing the retried frame ends the stall; the next stall is
+ *        reported again and restarts after the first, short wait.
+ */
+ZTEST(divecan_send_lone, test_20_ack_ends_stall)
+{
+    DiveCANMessage_t msg = make_msg(0xA0U);
+
+    fake_can_send_fake.custom_fake = send_acked;
+    finish_pending(0);
+    zassert_ok(divecan_send_blocking(&msg), "frames flow once a peer ACKs");
+    zassert_equal(can_tx_errors, 0U);
+
+    fake_can_send_fake.custom_fake = send_no_ack;
+    RESET_FAKE(fake_can_stop);
+    fake_can_stop_fake.custom_fake = stop_aborts;
+    (void)divecan_send(&msg);
+    (void)divecan_send(&msg);
+    k_msleep(150);
+
+    zassert_equal(fake_can_stop_fake.call_count, 1U);
+    zassert_equal(can_tx_errors, 1U, "a new stall is reported again");
+}
+
+/**
+ * @brief divecan_send_nowait() turns a full FIFO away at once and leaves the
+ *        drop count alone: the caller retries the frame.
+ */
+ZTEST(divecan_send_lone, test_30_nowait_refuses_full_fifo)
+{
+    DiveCANMessage_t msg = make_msg(0xB0U);
+    DivecanTxStats_t before = {0};
+    DivecanTxStats_t after = {0};
+    int rc = 0;
+
+    divecan_send_get_stats(&before);
+    for (int i = 0; (i <= CONFIG_DIVECAN_TX_FIFO_DEPTH) && (0 == rc); ++i) {
+        int64_t start = k_uptime_get();
+
+        rc = divecan_send_nowait(&msg);
+        zassert_true((k_uptime_get() - start) < 5, "nowait must not wait");
+    }
+    divecan_send_get_stats(&after);
+
+    zassert_equal(rc, -EAGAIN, "the stuck FIFO fills up");
+    zassert_equal(after.dropped, before.dropped, "a refusal is not a drop");
+}
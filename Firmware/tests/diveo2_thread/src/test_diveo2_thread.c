@@ -32,8 +32,9 @@
  *     the only caller is the thread (never NULL) and uart_emul TX never fails.
  *   - diveo2_uart_callback()'s UART_RX_DISABLED case + diveo2_rearm_rx(): the
  *     emulator never spontaneously disables RX in steady state.
- *   - diveo2_prepare_message_buffer()'s copyLen>outBufferLen clamp: dead
- *     defensive code (copyLen = outBufferLen - skipped is always <= outBufferLen).
+ *   - diveo2_process_rx()'s overwritten-during-parse arm: needs the DMA to lap
+ *     a whole buffer between the callback and the thread, which the emulator's
+ *     work-queue delivery never does while the thread is runnable.
  *   - diveo2_on_off_str() / apply_broadcast's "already in desired state, skip
  *     #BCST" log branch: reaching it needs a frame to land in the observe window
  *     at the instant the requested state already matches the observed state —
@@ -46,6 +47,7 @@
 #include <zephyr/drivers/serial/uart_emul.h>
 #include <zephyr/zbus/zbus.h>
 #include <zephyr/settings/settings.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "oxygen_cell_types.h"
@@ -455,3 +457,49 @@ ZTEST(diveo2_thread, test_11_feed_rx_edge_cases)
     zassert_true(feed_until_status(VALID_MRAW, CELL_OK, 4000),
                  "cell did not recover after overrun resync");
 }
+
+/* Wait (WITHOUT re-feeding) until the published reading carries @p sample. */
+static bool wait_sample(int32_t sample, int max_ms)
+{
+    bool hit = false;
+    int elapsed = 0;
+
+    while ((elapsed < max_ms) && !hit) {
+        OxygenCellMsg_t msg = {0};
+
+        (void)k_msleep(POLL_STEP_MS);
+        elapsed += POLL_STEP_MS;
+        (void)read_cell_status(&msg);
+        if ((CELL_OK == msg.status) && (sample == msg.raw_sample)) {
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+/**
+ * @brief Frames split across the DMA buffer swap are reassembled, not lost.
+ *
+ * The cell is streaming (test_10 left broadcast on), so every fed frame is
+ * parsed without a poll. Each frame below is 48 bytes and fed exactly once;
+ * 48 never tiles the 86-byte DMA buffer, so the run crosses several buffer
+ * swaps mid-frame and every one of those frames must still publish.
+ */
+ZTEST(diveo2_thread, test_12_frames_split_across_dma_swap)
+{
+    stub_power_set_vbus(5.0f);
+    zassert_true(feed_until_status(VALID_MRAW, CELL_OK, 4000),
+                 "no streaming baseline");
+
+    for (int32_t i = 0; i < 10; ++i) {
+        char frame[64];
+        int32_t sample = 210010 + i;
+
+        (void)snprintf(frame, sizeof(frame),
+                       "#MRAW %d 2500 0 1000 5000 200 1013250 45000\r",
+                       (int)sample);
+        feed(frame);
+        zassert_true(wait_sample(sample, 1500),
+                     "frame %d lost (split across the buffer swap?)", (int)i);
+    }
+}
@@ -0,0 +1,244 @@
+/**
+ * @file main.c
+ * @brief Unit tests for the decimated-download aggregator.
+ *
+ * Folds synthetic consensus, power and cell raw records into
+ * flash_log_aggregate.c's accumulators and reads the FL_TYPE_AGGREGATE
+ * records back. No FCB, no flash, no Zephyr driver model.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <errno.h>
+
+#include "flash_log.h"
+#include "flash_log_entries.h"
+#include "flash_log_aggregate.h"
+
+#define BUCKET_US      10000000U
+#define BASE_TS_US     30000000U
+#define CONSENSUS_CH   9U
+#define POWER_CH       5U
+#define ANALOG_CH      3U
+#define O2S_CH         1U
+
+static FlashLogAggregator_t agg;
+static uint8_t record[FL_AGG_RECORD_MAX];
+
+static void aggregate_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    flash_log_agg_init(&agg, BUCKET_US);
+    (void)memset(record, 0, sizeof(record));
+}
+
+ZTEST_SUITE(flash_log_aggregate, NULL, NULL, aggregate_before, NULL, NULL);
+
+static fl_entry_hdr_t make_hdr(uint8_t type, uint64_t ts, uint16_t len)
+{
+    fl_entry_hdr_t hdr = {
+        .type = type,
+        .flags = 0U,
+        .length = len,
+        .ts_boot_us = ts,
+    };
+    return hdr;
+}
+
+static void fold_consensus(uint64_t ts, uint8_t ppo2, uint16_t milli)
+{
+    fl_payload_consensus_t p = {
+        .consensus_ppo2 = ppo2,
+        .ppo2_array = { ppo2, (uint8_t)(ppo2 + 1U), (uint8_t)(ppo2 + 2U) },
+        .milli_array = { milli, milli, milli },
+        .status_packed = 0x1FFU,
+        .confidence = 3U,
+        .setpoint = 130U,
+    };
+    fl_entry_hdr_t hdr = make_hdr(FL_TYPE_CONSENSUS, ts, (uint16_t)sizeof(p));
+
+    zassert_false(flash_log_agg_must_flush(&agg, &hdr, (const uint8_t *)&p));
+    zassert_ok(flash_log_agg_fold(&agg, &hdr, (const uint8_t *)&p));
+}
+
+static void fold_analog(uint64_t ts, uint8_t cell, uint8_t ppo2)
+{
+    fl_payload_cell_analog_t p = {
+        .cell_index = cell,
+        .ppo2 = ppo2,
+        .raw_adc = -1000 * (int32_t)ppo2,
+        .millivolts = 4000U,
+    };
+    fl_entry_hdr_t hdr = make_hdr(FL_TYPE_CELL_RAW_ANALOG, ts, (uint16_t)sizeof(p));
+
+    zassert_ok(flash_log_agg_fold(&agg, &hdr, (const uint8_t *)&p));
+}
+
+/* Read slot @p slot's whole record and check its header and prefix. */
+static void read_record(size_t slot, uint8_t source, uint8_t key,
+                        uint16_t count, size_t channels)
+{
+    uint16_t len = flash_log_agg_record_len(&agg, slot);
+    fl_entry_hdr_t hdr = {0};
+    fl_payload_aggregate_t prefix = {0};
+
+    zassert_equal(len, sizeof(hdr) + sizeof(prefix) +
+                           (channels * sizeof(fl_agg_channel_t)));
+    flash_log_agg_read(&agg, slot, 0U, record, len);
+    (void)memcpy(&hdr, record, sizeof(hdr));
+    (void)memcpy(&prefix, &record[sizeof(hdr)], sizeof(prefix));
+    zassert_equal(hdr.type, FL_TYPE_AGGREGATE);
+    zassert_equal(hdr.length, len - sizeof(hdr));
+    zassert_equal(hdr.ts_boot_us, BASE_TS_US, "stamped with the bucket start");
+    zassert_equal(prefix.source_type, source);
+    zassert_equal(prefix.key, key);
+    zassert_equal(prefix.count, count);
+    zassert_equal(prefix.span_us, BUCKET_US);
+}
+
+static fl_agg_channel_t channel(size_t i)
+{
+    fl_agg_channel_t ch = {0};
+
+    (void)memcpy(&ch, &record[sizeof(fl_entry_hdr_t) +
+                              sizeof(fl_payload_aggregate_t) +
+                              (i * sizeof(ch))], sizeof(ch));
+    return ch;
+}
+
+/* min / mean / max of every consensus channel, sentinels left out. */
+ZTEST(flash_log_aggregate, test_consensus_min_mean_max)
+{
+    size_t slot = 0U;
+    fl_agg_channel_t ch = {0};
+
+    fold_consensus(BASE_TS_US + 100U, 90U, 1000U);
+    fold_consensus(BASE_TS_US + 200U, 100U, 2000U);
+    fold_consensus(BASE_TS_US + 300U, 110U, 3000U);
+
+    slot = flash_log_agg_next_pending(&agg, 0U);
+    zassert_true(slot < FL_AGG_SLOT_COUNT);
+    zassert_equal(flash_log_agg_next_pending(&agg, slot + 1U), FL_AGG_SLOT_COUNT);
+    read_record(slot, FL_TYPE_CONSENSUS, FL_AGG_NO_KEY, 3U, CONSENSUS_CH);
+
+    ch = channel(0U);
+    zassert_within(ch.min, 90.0f, 0.001f);
+    zassert_within(ch.mean, 100.0f, 0.001f);
+    zassert_within(ch.max, 110.0f, 0.001f);
+    ch = channel(3U);   /* ppo2_array[2] */
+    zassert_within(ch.mean, 102.0f, 0.001f);
+    ch = channel(6U);   /* milli_array[2] */
+    zassert_within(ch.min, 1000.0f, 0.001f);
+    zassert_within(ch.mean, 2000.0f, 0.001f);
+    zassert_within(ch.max, 3000.0f, 0.001f);
+    ch = channel(8U);   /* setpoint */
+    zassert_within(ch.mean, 130.0f, 0.001f);
+}
+
+/* One accumulator per stream: consensus, power, and each cell index. */
+ZTEST(flash_log_aggregate, test_streams_have_own_records)
+{
+    fl_payload_power_snapshot_t pw = {0};
+    fl_entry_hdr_t hdr = make_hdr(FL_TYPE_POWER_SNAPSHOT, BASE_TS_US,
+                                  (uint16_t)sizeof(pw));
+    fl_payload_cell_o2s_t o2s = { .cell_index = 2U, .ppo2 = 70U, .status = 0U };
+    fl_entry_hdr_t o2s_hdr = make_hdr(FL_TYPE_CELL_RAW_O2S, BASE_TS_US + 5U,
+                                      (uint16_t)sizeof(o2s));
+    size_t slots[4] = {0};
+    size_t n = 0U;
+
+    fold_consensus(BASE_TS_US, 100U, 1000U);
+    pw.vbus_voltage = 5.0f;
+    pw.current_ua = -250;
+    zassert_ok(flash_log_agg_fold(&agg, &hdr, (const uint8_t *)&pw));
+    fold_analog(BASE_TS_US + 1U, 0U, 95U);
+    fold_analog(BASE_TS_US + 2U, 0U, 97U);
+    zassert_ok(flash_log_agg_fold(&agg, &o2s_hdr, (const uint8_t *)&o2s));
+
+    for (size_t s = flash_log_agg_next_pending(&agg, 0U); s < FL_AGG_SLOT_COUNT;
+         s = flash_log_agg_next_pending(&agg, s + 1U)) {
+        zassert_true(n < ARRAY_SIZE(slots));
+        slots[n] = s;
+        ++n;
+    }
+    zassert_equal(n, 4U);
+
+    read_record(slots[1], FL_TYPE_POWER_SNAPSHOT, FL_AGG_NO_KEY, 1U, POWER_CH);
+    zassert_within(channel(0U).mean, 5.0f, 0.001f);
+    zassert_within(channel(4U).min, -250.0f, 0.001f);
+    read_record(slots[2], FL_TYPE_CELL_RAW_ANALOG, 0U, 2U, ANALOG_CH);
+    zassert_within(channel(0U).mean, 96.0f, 0.001f);
+    zassert_within(channel(1U).min, -97000.0f, 0.5f);
+    read_record(slots[3], FL_TYPE_CELL_RAW_O2S, 2U, 1U, O2S_CH);
+    zassert_within(channel(0U).max, 70.0f, 0.001f);
+
+    flash_log_agg_clear(&agg);
+    zassert_equal(flash_log_agg_next_pending(&agg, 0U), FL_AGG_SLOT_COUNT);
+}
+
+/* A later bucket, a boot marker, or a cell switching raw type closes the
+ * open bucket; nothing does while nothing is pending. */
+ZTEST(flash_log_aggregate, test_must_flush)
+{
+    fl_entry_hdr_t later = make_hdr(FL_TYPE_DIVE_START, BASE_TS_US + BUCKET_US, 0U);
+    fl_entry_hdr_t same = make_hdr(FL_TYPE_DIVE_START, BASE_TS_US + BUCKET_US - 1U, 0U);
+    fl_entry_hdr_t boot = make_hdr(FL_TYPE_BOOT_MARKER, BASE_TS_US, 0U);
+    fl_payload_cell_o2s_t cell0 = { .cell_index = 0U, .ppo2 = 70U, .status = 0U };
+    fl_payload_cell_o2s_t cell1 = { .cell_index = 1U, .ppo2 = 70U, .status = 0U };
+    fl_entry_hdr_t o2s = make_hdr(FL_TYPE_CELL_RAW_O2S, BASE_TS_US, (uint16_t)sizeof(cell0));
+
+    zassert_false(flash_log_agg_must_flush(&agg, &later, NULL));
+    zassert_false(flash_log_agg_must_flush(&agg, &boot, NULL));
+
+    fold_analog(BASE_TS_US + 10U, 0U, 100U);
+    zassert_true(flash_log_agg_must_flush(&agg, &later, NULL));
+    zassert_false(flash_log_agg_must_flush(&agg, &same, NULL));
+    zassert_true(flash_log_agg_must_flush(&agg, &boot, NULL));
+    zassert_true(flash_log_agg_must_flush(&agg, &o2s, (const uint8_t *)&cell0));
+    zassert_false(flash_log_agg_must_flush(&agg, &o2s, (const uint8_t *)&cell1));
+}
+
+/* Slicing a record across reads reassembles it byte-exactly. */
+ZTEST(flash_log_aggregate, test_read_slices)
+{
+    uint8_t sliced[FL_AGG_RECORD_MAX] = {0};
+    size_t slot = 0U;
+    uint16_t len = 0U;
+
+    fold_consensus(BASE_TS_US + 1U, 80U, 500U);
+    fold_consensus(BASE_TS_US + 2U, 120U, 700U);
+    slot = flash_log_agg_next_pending(&agg, 0U);
+    len = flash_log_agg_record_len(&agg, slot);
+    zassert_equal(len, FL_AGG_RECORD_MAX);
+
+    flash_log_agg_read(&agg, slot, 0U, record, len);
+    for (size_t off = 0U; off < len; off += 7U) {
+        flash_log_agg_read(&agg, slot, off, &sliced[off], MIN(7U, len - off));
+    }
+    zassert_mem_equal(sliced, record, len);
+}
+
+ZTEST(flash_log_aggregate, test_fold_guards)
+{
+    fl_payload_cell_analog_t bad_cell = { .cell_index = FL_AGG_CELL_SLOTS };
+    fl_entry_hdr_t analog = make_hdr(FL_TYPE_CELL_RAW_ANALOG, BASE_TS_US,
+                                     (uint16_t)sizeof(bad_cell));
+    fl_entry_hdr_t short_hdr = make_hdr(FL_TYPE_CELL_RAW_ANALOG, BASE_TS_US,
+                                        (uint16_t)(sizeof(bad_cell) - 1U));
+    fl_entry_hdr_t text = make_hdr(FL_TYPE_LOG_TEXT, BASE_TS_US, 4U);
+
+    zassert_true(flash_log_agg_handles(FL_TYPE_CONSENSUS));
+    zassert_true(flash_log_agg_handles(FL_TYPE_CELL_RAW_DIVEO2));
+    zassert_false(flash_log_agg_handles(FL_TYPE_PID_SNAPSHOT));
+    zassert_false(flash_log_agg_handles(FL_TYPE_AGGREGATE));
+
+    zassert_equal(flash_log_agg_fold(&agg, &analog, (const uint8_t *)&bad_cell),
+                  -EINVAL);
+    bad_cell.cell_index = 0U;
+    zassert_equal(flash_log_agg_fold(&agg, &short_hdr, (const uint8_t *)&bad_cell),
+                  -EINVAL);
+    zassert_equal(flash_log_agg_fold(&agg, &text, (const uint8_t *)&bad_cell),
+                  -EINVAL);
+    zassert_equal(flash_log_agg_next_pending(&agg, 0U), FL_AGG_SLOT_COUNT);
+    zassert_equal(flash_log_agg_record_len(&agg, FL_AGG_SLOT_COUNT), 0U);
+}
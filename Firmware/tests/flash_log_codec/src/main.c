@@ -0,0 +1,313 @@
+/**
+ * @file main.c
+ * @brief Unit tests for the packed telemetry batch codec.
+ *
+ * Stages synthetic sub-records in one buffer the way the writer's batch
+ * staging does, encodes them with flash_log_codec_encode() and decodes them
+ * back with flash_log_codec_decode(). No FCB, no flash, no Zephyr driver
+ * model — just the pure codec from flash_log_codec.c.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <errno.h>
+
+#include "flash_log.h"
+#include "flash_log_entries.h"
+#include "flash_log_codec.h"
+
+#define STAGE_BYTES   1024U
+#define MAX_RECORDS   32U
+#define BASE_TS_US    5000000U
+#define TICK_US       100000U
+
+typedef struct {
+    uint8_t type;
+    uint64_t ts;
+    uint16_t len;
+    size_t off;
+} StagedRecord_t;
+
+static uint8_t stage[STAGE_BYTES];
+static size_t stage_len;
+static StagedRecord_t records[MAX_RECORDS];
+static size_t record_count;
+static uint8_t encoded[2U * STAGE_BYTES];
+static size_t encoded_len;
+static uint8_t decoded[STAGE_BYTES];
+
+static void codec_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    stage_len = 0U;
+    record_count = 0U;
+    encoded_len = 0U;
+}
+
+ZTEST_SUITE(flash_log_codec, NULL, NULL, codec_before, NULL, NULL);
+
+static void stage_record(uint8_t type, uint64_t ts, const void *payload,
+                         uint16_t len)
+{
+    zassert_true((stage_len + len) <= sizeof(stage));
+    zassert_true(record_count < MAX_RECORDS);
+    (void)memcpy(&stage[stage_len], payload, len);
+    records[record_count].type = type;
+    records[record_count].ts = ts;
+    records[record_count].len = len;
+    records[record_count].off = stage_len;
+    stage_len += len;
+    ++record_count;
+}
+
+/* Encode every staged record, checking the sizing pass agrees with the
+ * real one (the writer reserves the FCB entry from the sizing pass). */
+static void encode_all(void)
+{
+    FlashLogCodec_t codec;
+    size_t sized = 0U;
+
+    flash_log_codec_init(&codec, stage, BASE_TS_US);
+    for (size_t i = 0U; i < record_count; ++i) {
+        sized += flash_log_codec_encode(&codec, records[i].type, records[i].ts,
+                                        &stage[records[i].off], records[i].len,
+                                        NULL);
+    }
+    flash_log_codec_init(&codec, stage, BASE_TS_US);
+    for (size_t i = 0U; i < record_count; ++i) {
+        encoded_len += flash_log_codec_encode(&codec, records[i].type,
+                                              records[i].ts,
+                                              &stage[records[i].off],
+                                              records[i].len,
+                                              &encoded[encoded_len]);
+    }
+    zassert_equal(sized, encoded_len, "sizing pass %zu != encode %zu",
+                  sized, encoded_len);
+}
+
+/* Decode the whole container and compare every record with its original. */
+static void decode_and_compare(void)
+{
+    FlashLogCodec_t codec;
+    size_t pos = 0U;
+    size_t out = 0U;
+
+    flash_log_codec_init(&codec, decoded, BASE_TS_US);
+    for (size_t i = 0U; i < record_count; ++i) {
+        fl_entry_hdr_t hdr = {0};
+        size_t used = 0U;
+
+        zassert_ok(flash_log_codec_decode(&codec, &encoded[pos],
+                                          encoded_len - pos, &used, &hdr,
+                                          &decoded[out], sizeof(decoded) - out),
+                   "record %zu failed to decode", i);
+        zassert_equal(hdr.type, records[i].type, "record %zu type", i);
+        zassert_equal(hdr.flags, 0U);
+        zassert_equal(hdr.ts_boot_us, records[i].ts, "record %zu ts", i);
+        zassert_equal(hdr.length, records[i].len, "record %zu length", i);
+        zassert_mem_equal(&decoded[out], &stage[records[i].off],
+                          records[i].len, "record %zu payload", i);
+        pos += used;
+        out += hdr.length;
+    }
+    zassert_equal(pos, encoded_len, "trailing bytes after the last record");
+}
+
+/** @brief Every field-coded and raw type round-trips bit-exactly. */
+ZTEST(flash_log_codec, test_mixed_records_round_trip)
+{
+    fl_payload_consensus_t consensus = {
+        .consensus_ppo2 = 98U,
+        .ppo2_array = { 97U, 98U, 99U },
+        .milli_array = { 1000U, 1010U, 990U },
+        .status_packed = 0x0124U,
+        .confidence = 3U,
+        .setpoint = 70U,
+    };
+    fl_payload_pid_t pid = {
+        .integral = 0.25f, .saturation_count = 2U, .duty = 0.5f, .setpoint = 70U,
+    };
+    fl_payload_cell_diveo2_t diveo2 = {
+        .cell_index = 1U, .ppo2 = 99U, .temperature_mc = -1500,
+        .phase_mdeg = 123456, .ambient_pressure_ubar = 1013000,
+    };
+    fl_payload_cell_analog_t analog = {
+        .cell_index = 0U, .ppo2 = 101U, .raw_adc = -32000, .millivolts = 1234U,
+    };
+    fl_payload_cell_o2s_t o2s = { .cell_index = 7U, .ppo2 = 50U, .status = 1U };
+    fl_payload_error_t error = { .code = 3U, .detail = 0xDEADBEEFU };
+    uint64_t ts = BASE_TS_US;
+
+    for (uint32_t i = 0U; i < 4U; ++i) {
+        stage_record(FL_TYPE_CONSENSUS, ts, &consensus, sizeof(consensus));
+        stage_record(FL_TYPE_PID_SNAPSHOT, ts + 10U, &pid, sizeof(pid));
+        stage_record(FL_TYPE_CELL_RAW_DIVEO2, ts + 20U, &diveo2, sizeof(diveo2));
+        stage_record(FL_TYPE_CELL_RAW_ANALOG, ts + 30U, &analog, sizeof(analog));
+        /* cell_index outside the slot range codes against zero each time. */
+        stage_record(FL_TYPE_CELL_RAW_O2S, ts + 40U, &o2s, sizeof(o2s));
+        stage_record(FL_TYPE_ERROR_EVENT, ts + 50U, &error, sizeof(error));
+        /* Alternate the analog cell so two cells share the type. */
+        analog.cell_index = (uint8_t)((analog.cell_index + 1U) % 2U);
+        consensus.milli_array[i % 3U] = (uint16_t)(consensus.milli_array[i % 3U] + 7U);
+        consensus.ppo2_array[0] = (uint8_t)(consensus.ppo2_array[0] - 1U);
+        pid.integral -= 0.125f;
+        diveo2.temperature_mc -= 10;
+        ts += TICK_US;
+    }
+    /* A consensus payload of the wrong length falls back to raw coding. */
+    stage_record(FL_TYPE_CONSENSUS, ts, &consensus, sizeof(consensus) - 1U);
+
+    encode_all();
+    decode_and_compare();
+}
+
+/** @brief A slot-store decoder needs only one record's worth of output. */
+ZTEST(flash_log_codec, test_slot_store_decodes_one_record_at_a_time)
+{
+    static uint8_t store[FL_CODEC_SLOT_STORE_BYTES];
+    static uint8_t one[FL_CODEC_FIELDS_MAX_BYTES];
+    fl_payload_consensus_t consensus = { .consensus_ppo2 = 98U, .setpoint = 70U };
+    fl_payload_cell_diveo2_t diveo2 = { .ppo2 = 99U, .phase_mdeg = 123456 };
+    fl_payload_cell_analog_t analog = { .ppo2 = 101U, .raw_adc = -32000 };
+    fl_payload_pid_t pid = { .integral = 0.25f, .setpoint = 70U };
+    uint64_t ts = BASE_TS_US;
+    FlashLogCodec_t codec;
+    size_t pos = 0U;
+
+    for (uint8_t i = 0U; i < 6U; ++i) {
+        diveo2.cell_index = (uint8_t)(i % FL_CODEC_CELL_SLOTS);
+        analog.cell_index = (uint8_t)((i + 1U) % FL_CODEC_CELL_SLOTS);
+        stage_record(FL_TYPE_CONSENSUS, ts, &consensus, sizeof(consensus));
+        stage_record(FL_TYPE_CELL_RAW_DIVEO2, ts + 5U, &diveo2, sizeof(diveo2));
+        stage_record(FL_TYPE_CELL_RAW_ANALOG, ts + 6U, &analog, sizeof(analog));
+        stage_record(FL_TYPE_PID_SNAPSHOT, ts + 7U, &pid, sizeof(pid));
+        consensus.consensus_ppo2 = (uint8_t)(consensus.consensus_ppo2 + i);
+        diveo2.temperature_mc += (int32_t)(diveo2.cell_index * 3U);
+        analog.millivolts = (uint16_t)(analog.millivolts + 11U);
+        pid.integral += 0.5f;
+        ts += TICK_US;
+    }
+    encode_all();
+
+    flash_log_codec_init_slots(&codec, store, BASE_TS_US);
+    for (size_t i = 0U; i < record_count; ++i) {
+        fl_entry_hdr_t hdr = {0};
+        size_t used = 0U;
+
+        (void)memset(one, 0xA5, sizeof(one));
+        zassert_ok(flash_log_codec_decode(&codec, &encoded[pos],
+                                          encoded_len - pos, &used, &hdr,
+                                          one, sizeof(one)),
+                   "record %zu failed to decode", i);
+        zassert_equal(hdr.ts_boot_us, records[i].ts, "record %zu ts", i);
+        zassert_equal(hdr.length, records[i].len, "record %zu length", i);
+        zassert_mem_equal(one, &stage[records[i].off], records[i].len,
+                          "record %zu payload", i);
+        pos += used;
+    }
+    zassert_equal(pos, encoded_len, "trailing bytes after the last record");
+}
+
+/** @brief Steady-state records shrink to tag + timestamp + empty mask. */
+ZTEST(flash_log_codec, test_unchanged_consensus_is_five_bytes)
+{
+    fl_payload_consensus_t consensus = {
+        .consensus_ppo2 = 100U, .milli_array = { 1000U, 1000U, 1000U },
+        .confidence = 3U, .setpoint = 70U,
+    };
+
+    stage_record(FL_TYPE_CONSENSUS, BASE_TS_US, &consensus, sizeof(consensus));
+    stage_record(FL_TYPE_CONSENSUS, BASE_TS_US + TICK_US, &consensus,
+                 sizeof(consensus));
+    encode_all();
+
+    FlashLogCodec_t codec;
+
+    flash_log_codec_init(&codec, stage, BASE_TS_US);
+    (void)flash_log_codec_encode(&codec, FL_TYPE_CONSENSUS, BASE_TS_US,
+                                 &stage[records[0].off], records[0].len, NULL);
+    /* tag (1) + zig-zag 100 ms (3) + empty change mask (1). */
+    zassert_equal(flash_log_codec_encode(&codec, FL_TYPE_CONSENSUS,
+                                         BASE_TS_US + TICK_US,
+                                         &stage[records[1].off],
+                                         records[1].len, NULL), 5U);
+    decode_and_compare();
+}
+
+/** @brief Field deltas wrap at the field width; time may step backwards. */
+ZTEST(flash_log_codec, test_wrapping_deltas_and_backward_time)
+{
+    fl_payload_cell_analog_t analog = {
+        .cell_index = 2U, .ppo2 = 0xFFU, .raw_adc = INT32_MAX, .millivolts = 0U,
+    };
+
+    stage_record(FL_TYPE_CELL_RAW_ANALOG, BASE_TS_US, &analog, sizeof(analog));
+    analog.ppo2 = 0U;
+    analog.raw_adc = INT32_MIN;
+    analog.millivolts = 0xFFFFU;
+    stage_record(FL_TYPE_CELL_RAW_ANALOG, BASE_TS_US - 250U, &analog,
+                 sizeof(analog));
+    encode_all();
+
+    /* Second record: tag, ts, key, mask, then one byte per wrapped +/-1
+     * delta — every field moved by exactly one step modulo its width. */
+    FlashLogCodec_t codec;
+
+    flash_log_codec_init(&codec, stage, BASE_TS_US);
+    size_t first = flash_log_codec_encode(&codec, FL_TYPE_CELL_RAW_ANALOG,
+                                          BASE_TS_US, &stage[records[0].off],
+                                          records[0].len, NULL);
+    zassert_equal(encoded_len - first, 1U + 2U + 1U + 1U + 3U);
+    decode_and_compare();
+}
+
+/** @brief Types with the tag bit set cannot be encoded. */
+ZTEST(flash_log_codec, test_untaggable_type_rejected)
+{
+    FlashLogCodec_t codec;
+    uint8_t payload[4] = {0};
+
+    flash_log_codec_init(&codec, payload, BASE_TS_US);
+    zassert_equal(flash_log_codec_encode(&codec, FL_TYPE_BATCH, BASE_TS_US,
+                                         payload, sizeof(payload), encoded), 0U);
+}
+
+/** @brief Malformed, truncated and oversized records fail cleanly. */
+ZTEST(flash_log_codec, test_malformed_records_rejected)
+{
+    FlashLogCodec_t codec;
+    fl_entry_hdr_t hdr = {0};
+    size_t used = 0U;
+    /* Field-coded tag for a type with no schema. */
+    static const uint8_t unknown_schema[] = { 0x80U | FL_TYPE_ERROR_EVENT, 0x00U, 0x00U };
+    /* PID has four fields; mask bit 4 is out of range. */
+    static const uint8_t bad_mask[] = { 0x80U | FL_TYPE_PID_SNAPSHOT, 0x00U, 0x10U };
+    /* Raw record claiming more payload than the container holds. */
+    static const uint8_t short_raw[] = { FL_TYPE_ERROR_EVENT, 0x00U, 0x08U, 0x01U };
+    /* Timestamp varint that never terminates. */
+    static const uint8_t runaway_ts[] = { FL_TYPE_ERROR_EVENT, 0x80U, 0x80U };
+    static const uint8_t raw_ok[] = { FL_TYPE_ERROR_EVENT, 0x00U, 0x02U, 0x01U, 0x02U };
+
+    flash_log_codec_init(&codec, decoded, BASE_TS_US);
+    zassert_equal(flash_log_codec_decode(&codec, unknown_schema,
+                                         sizeof(unknown_schema), &used, &hdr,
+                                         decoded, sizeof(decoded)), -EBADMSG);
+    zassert_equal(flash_log_codec_decode(&codec, bad_mask, sizeof(bad_mask),
+                                         &used, &hdr, decoded,
+                                         sizeof(decoded)), -EBADMSG);
+    zassert_equal(flash_log_codec_decode(&codec, short_raw, sizeof(short_raw),
+                                         &used, &hdr, decoded,
+                                         sizeof(decoded)), -EBADMSG);
+    zassert_equal(flash_log_codec_decode(&codec, runaway_ts, sizeof(runaway_ts),
+                                         &used, &hdr, decoded,
+                                         sizeof(decoded)), -EBADMSG);
+    zassert_equal(flash_log_codec_decode(&codec, raw_ok, 0U, &used, &hdr,
+                                         decoded, sizeof(decoded)), -EBADMSG);
+    zassert_equal(flash_log_codec_decode(&codec, raw_ok, sizeof(raw_ok), &used,
+                                         &hdr, decoded, 1U), -ENOSPC);
+    zassert_ok(flash_log_codec_decode(&codec, raw_ok, sizeof(raw_ok), &used,
+                                      &hdr, decoded, sizeof(decoded)));
+    zassert_equal(used, sizeof(raw_ok));
+    zassert_equal(hdr.length, 2U);
+    zassert_equal(hdr.ts_boot_us, BASE_TS_US);
+}
@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "flash_log_internal.h"
+#include "flash_log_entries.h"
 
 ZTEST_SUITE(flash_log_index_summary, NULL, NULL, NULL, NULL, NULL);
 
@@ -133,3 +134,46 @@ ZTEST(flash_log_index_summary, test_flag_set_but_id_invalid_is_ignored_for_min_m
     zassert_equal(s.boot_id_oldest, 50U, "invalid sentinel skipped, real value wins");
     zassert_equal(s.boot_id_latest, 50U);
 }
+
+/** @brief Sector summary folds markers from raw entries and round-trips. */
+ZTEST(flash_log_index_summary, test_sector_summary_fold_seal_open)
+{
+    uint8_t raw[sizeof(fl_entry_hdr_t) + sizeof(fl_payload_boot_marker_t)] = {0};
+    fl_entry_hdr_t hdr = { .type = FL_TYPE_BOOT_MARKER,
+                           .length = sizeof(fl_payload_boot_marker_t) };
+    fl_payload_boot_marker_t boot = { .boot_id = 12U };
+    fl_payload_dive_marker_t dive = { .dive_number = 4U };
+    FlashLogSectorSummary_t sum;
+    FlashLogIndexEntry_t row = {0};
+
+    flash_log_sector_summary_reset(&sum);
+    (void)memcpy(raw, &hdr, sizeof(hdr));
+    (void)memcpy(&raw[sizeof(hdr)], &boot, sizeof(boot));
+    flash_log_sector_summary_fold_entry(&sum, raw, sizeof(raw));
+    boot.boot_id = 13U;
+    flash_log_sector_summary_fold(&sum, FL_TYPE_BOOT_MARKER,
+                                  (const uint8_t *)&boot, sizeof(boot));
+    flash_log_sector_summary_fold(&sum, FL_TYPE_DIVE_END,
+                                  (const uint8_t *)&dive, sizeof(dive));
+    /* Truncated raw entry and non-marker types are ignored. */
+    flash_log_sector_summary_fold_entry(&sum, raw, sizeof(raw) - 1U);
+    flash_log_sector_summary_fold(&sum, FL_TYPE_CONSENSUS,
+                                  (const uint8_t *)&dive, sizeof(dive));
+
+    zassert_equal(sum.first_boot_id, 12U);
+    zassert_equal(sum.last_boot_id, 13U);
+    zassert_equal(sum.first_dive_id, 4U);
+    zassert_equal(sum.flags, FL_INDEX_FLAG_HAS_BOOT | FL_INDEX_FLAG_HAS_DIVE_END);
+
+    flash_log_sector_summary_seal(&sum, 0x1234U);
+    zassert_true(flash_log_sector_summary_open(&sum, 0x1234U, &row));
+    zassert_equal(row.first_boot_id, 12U);
+    zassert_equal(row.first_dive_id, 4U);
+
+    /* Wrong lap, corrupted field, and an erased tail are all rejected. */
+    zassert_false(flash_log_sector_summary_open(&sum, 0x1235U, &row));
+    sum.first_dive_id = 5U;
+    zassert_false(flash_log_sector_summary_open(&sum, 0x1234U, &row));
+    (void)memset(&sum, 0xFF, sizeof(sum));
+    zassert_false(flash_log_sector_summary_open(&sum, 0xFFFFU, &row));
+}
@@ -0,0 +1,219 @@
+/**
+ * @file main.c
+ * @brief Unit tests for the compressed log-download stream (flash_log_lz.c).
+ *
+ * Drives the compressor the way fl_fill_chunk_compressed() does — bounded
+ * output chunks, input topped up only when asked for — and inflates the
+ * result with an independent reference decoder of the documented bit format.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include "flash_log_lz.h"
+
+#define INPUT_BYTES   4096U
+#define OUTPUT_BYTES  (2U * INPUT_BYTES)
+#define ENTRY_BYTES   26U   /* 12-byte entry header + consensus payload */
+
+static FlashLogLz_t lz;
+static uint8_t input[INPUT_BYTES];
+static uint8_t packed[OUTPUT_BYTES];
+static uint8_t packed_alt[OUTPUT_BYTES];
+static uint8_t inflated[INPUT_BYTES];
+
+ZTEST_SUITE(flash_log_lz, NULL, NULL, NULL, NULL, NULL);
+
+/* Deterministic xorshift so "random" inputs are reproducible. */
+static uint32_t rng_next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/* A TLV-like stream: consensus-shaped entries 100 ms apart, mostly-static
+ * payload with a jittering PPO2 byte. */
+static void fill_log_like(size_t len)
+{
+    uint32_t rng = 0x1234567U;
+    uint64_t ts = 5000000U;
+
+    for (size_t off = 0U; off < len; off += ENTRY_BYTES) {
+        uint8_t entry[ENTRY_BYTES] = { 0x10U, 0x00U, 14U, 0x00U };
+
+        ts += 100000U + (rng_next(&rng) & 0x3FU);
+        for (size_t b = 0U; b < 8U; ++b) {
+            entry[4U + b] = (uint8_t)(ts >> (8U * b));
+        }
+        entry[12] = (uint8_t)(130U + (rng_next(&rng) % 3U));
+        entry[13] = 129U;
+        entry[14] = 131U;
+        entry[15] = 130U;
+        entry[22] = 0x3FU;
+        entry[24] = 100U;
+        entry[25] = 130U;
+        (void)memcpy(&input[off], entry, MIN(ENTRY_BYTES, len - off));
+    }
+}
+
+/**
+ * Compress `len` input bytes, handing the compressor at most `feed` bytes per
+ * refill and draining it `chunk` bytes at a time.
+ */
+static size_t compress(const uint8_t *src, size_t len, size_t feed,
+                       size_t chunk, uint8_t *dst, size_t dst_cap)
+{
+    size_t in_off = 0U;
+    size_t out_len = 0U;
+
+    flash_log_lz_init(&lz);
+    for (int guard = 0; !flash_log_lz_done(&lz); ++guard) {
+        zassert_true(guard < 100000, "compressor stopped making progress");
+        size_t cap = MIN(chunk, dst_cap - out_len);
+        size_t produced = flash_log_lz_poll(&lz, &dst[out_len], cap);
+
+        out_len += produced;
+        if (flash_log_lz_wants_input(&lz)) {
+            uint8_t *sink = NULL;
+            size_t n = MIN(MIN(flash_log_lz_sink(&lz, &sink), feed), len - in_off);
+
+            if (0U == n) {
+                flash_log_lz_finish(&lz);
+            } else {
+                (void)memcpy(sink, &src[in_off], n);
+                flash_log_lz_commit(&lz, n);
+                in_off += n;
+            }
+        }
+    }
+    return out_len;
+}
+
+/* Reference decoder for the bit format in flash_log_lz.h. */
+static size_t inflate(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    size_t bit = 0U;
+    size_t total = len * 8U;
+    size_t out = 0U;
+    bool ok = true;
+
+    while (ok && ((bit + 1U) <= total)) {
+        bool literal = ((src[bit / 8U] >> (7U - (bit % 8U))) & 1U) != 0U;
+        size_t width = literal ? 8U : (FL_LZ_WINDOW_BITS + FL_LZ_LENGTH_BITS);
+        uint32_t value = 0U;
+
+        if ((bit + 1U + width) > total) {
+            break;   /* zero padding of the final byte */
+        }
+        ++bit;
+        for (size_t i = 0U; i < width; ++i, ++bit) {
+            value = (value << 1) | ((src[bit / 8U] >> (7U - (bit % 8U))) & 1U);
+        }
+        if (literal) {
+            zassert_true(out < cap, "inflate overflow");
+            dst[out++] = (uint8_t)value;
+        } else {
+            size_t dist = (value >> FL_LZ_LENGTH_BITS) + 1U;
+            size_t run = (value & ((1U << FL_LZ_LENGTH_BITS) - 1U)) + FL_LZ_MIN_MATCH;
+
+            zassert_true(dist <= out, "backref before stream start");
+            zassert_true((out + run) <= cap, "inflate overflow");
+            for (size_t i = 0U; i < run; ++i, ++out) {
+                dst[out] = dst[out - dist];
+            }
+        }
+    }
+    return out;
+}
+
+static void assert_round_trip(size_t len, size_t packed_len)
+{
+    size_t n = inflate(packed, packed_len, inflated, sizeof(inflated));
+
+    zassert_equal(n, len, "inflated %zu bytes, expected %zu", n, len);
+    zassert_mem_equal(inflated, input, len, "inflated bytes differ");
+}
+
+ZTEST(flash_log_lz, test_log_like_stream_round_trips_and_shrinks)
+{
+    fill_log_like(INPUT_BYTES);
+
+    size_t n = compress(input, INPUT_BYTES, 96U, 253U, packed, sizeof(packed));
+
+    assert_round_trip(INPUT_BYTES, n);
+    zassert_true((n * 2U) < INPUT_BYTES,
+                 "repetitive entry headers should at least halve, got %zu", n);
+}
+
+/* Output depends only on the input bytes, never on how the caller sliced the
+ * input or the chunks — a retried download reproduces the same bytes. */
+ZTEST(flash_log_lz, test_chunking_does_not_change_output)
+{
+    fill_log_like(INPUT_BYTES);
+
+    size_t a = compress(input, INPUT_BYTES, 1000U, 253U, packed, sizeof(packed));
+    size_t b = compress(input, INPUT_BYTES, 1U, 2U, packed_alt, sizeof(packed_alt));
+
+    zassert_equal(a, b, "length depends on slicing (%zu vs %zu)", a, b);
+    zassert_mem_equal(packed, packed_alt, a, "bytes depend on slicing");
+}
+
+ZTEST(flash_log_lz, test_incompressible_input_bounded)
+{
+    uint32_t rng = 0xC0FFEEU;
+
+    for (size_t i = 0U; i < INPUT_BYTES; ++i) {
+        input[i] = (uint8_t)rng_next(&rng);
+    }
+
+    size_t n = compress(input, INPUT_BYTES, 64U, 61U, packed, sizeof(packed));
+
+    assert_round_trip(INPUT_BYTES, n);
+    zassert_true(n <= ((INPUT_BYTES * 9U) / 8U) + 1U,
+                 "worst case is one flag bit per byte, got %zu", n);
+}
+
+/* A run longer than any match is coded as overlapping backrefs. */
+ZTEST(flash_log_lz, test_long_run_overlapping_backrefs)
+{
+    (void)memset(input, 0xA5, 1000U);
+
+    size_t n = compress(input, 1000U, 256U, 253U, packed, sizeof(packed));
+
+    assert_round_trip(1000U, n);
+    zassert_true(n < 130U, "1000-byte run should code in ~60 backrefs, got %zu", n);
+}
+
+/* Repeats exactly at, and just past, the window edge both round-trip. */
+ZTEST(flash_log_lz, test_window_edge_distances)
+{
+    uint32_t rng = 0xBADC0DEU;
+
+    for (size_t i = 0U; i < INPUT_BYTES; ++i) {
+        input[i] = (uint8_t)rng_next(&rng);
+    }
+    (void)memcpy(&input[FL_LZ_WINDOW_BYTES], input, 32U);
+    (void)memcpy(&input[2U * FL_LZ_WINDOW_BYTES + 1U + 64U], &input[64U], 32U);
+
+    size_t n = compress(input, 3U * FL_LZ_WINDOW_BYTES, 50U, 253U, packed,
+                        sizeof(packed));
+
+    assert_round_trip(3U * FL_LZ_WINDOW_BYTES, n);
+}
+
+ZTEST(flash_log_lz, test_empty_and_single_byte)
+{
+    size_t n = compress(input, 0U, 16U, 253U, packed, sizeof(packed));
+
+    zassert_equal(n, 0U, "empty input produces no bytes");
+    zassert_true(flash_log_lz_done(&lz), "empty stream is done");
+
+    input[0] = 0x42U;
+    n = compress(input, 1U, 16U, 253U, packed, sizeof(packed));
+    zassert_equal(n, 2U, "one literal = 9 bits = 2 bytes");
+    assert_round_trip(1U, n);
+    zassert_equal(flash_log_lz_poll(&lz, packed, sizeof(packed)), 0U,
+                  "a finished stream produces nothing more");
+}
@@ -20,11 +20,13 @@
 #include <zephyr/fs/fcb.h>
 #include <zephyr/sys/util.h>
 #include <string.h>
+#include <errno.h>
 
 #include "flash_log.h"
 #include "flash_log_entries.h"
 #include "flash_log_internal.h"
 #include "flash_log_reader.h"
+#include "flash_log_codec.h"
 #include "maintenance_arena.h"
 
 #define TEST_AREA_ID    FIXED_PARTITION_ID(slot1_partition)
@@ -104,6 +106,27 @@ uint32_t flash_log_internal_index_epoch(void)
     return test_index_epoch;
 }
 
+/* The writer's RAM copy of the active sector's summary. Disabled by default
+ * so the reader walks the active sector like any sector without a tail;
+ * test_active_summary_skips_walk opts in. */
+static struct {
+    bool valid;
+    FlashLogIndexEntry_t row;
+} test_active_summary;
+
+Status_t flash_log_internal_active_summary(FlashLogDest_t dest,
+                                           FlashLogIndexEntry_t *out)
+{
+    Status_t rc = -ENODATA;
+
+    ARG_UNUSED(dest);
+    if (test_active_summary.valid) {
+        *out = test_active_summary.row;
+        rc = 0;
+    }
+    return rc;
+}
+
 /* ---- expected clean stream: every [hdr|payload] we wrote, concatenated ---- */
 static uint8_t expected[8 * 1024];
 static size_t  expected_len;
@@ -231,17 +254,20 @@ static void reader_before(void *fixture)
 {
     ARG_UNUSED(fixture);
     text_fcb_ready = false;
+    test_active_summary.valid = false;
 }
 
 ZTEST_SUITE(flash_log_reader, NULL, suite_setup, reader_before, NULL, NULL);
 
 /* ---- TEXT-FCB helpers (multi-sector resolver coverage) ---- */
 
-/* Append one [hdr|payload] entry to the TEXT FCB and record its sector. */
-static size_t text_append(uint8_t type, const void *payload, uint16_t len)
+/* Append one [hdr|payload] entry stamped @p ts_us to the TEXT FCB and record
+ * its sector. */
+static size_t text_append_at(uint8_t type, const void *payload, uint16_t len,
+                             uint64_t ts_us)
 {
     fl_entry_hdr_t hdr = {
-        .type = type, .flags = 0U, .length = len, .ts_boot_us = 0U,
+        .type = type, .flags = 0U, .length = len, .ts_boot_us = ts_us,
     };
     struct fcb_entry loc;
     int rc = fcb_append(&text_fcb, (uint16_t)(sizeof(hdr) + len), &loc);
@@ -261,6 +287,11 @@ static size_t text_append(uint8_t type, const void *payload, uint16_t len)
     return text_last_sector;
 }
 
+static size_t text_append(uint8_t type, const void *payload, uint16_t len)
+{
+    return text_append_at(type, payload, len, 0U);
+}
+
 /* Write non-marker filler until the append cursor reaches @p target sector, so
  * the next marker lands in a chosen sector (and intervening sectors stay
  * marker-free, reproducing a rotation-induced gap). */
@@ -297,7 +328,9 @@ static void text_fcb_reset(void)
     int rc = flash_area_open(TEXT_AREA_ID, &fap);
 
     zassert_ok(rc, "text flash_area_open failed: %d", rc);
-    rc = flash_area_erase(fap, 0, TEXT_N_SECTORS * TEXT_SECTOR_SIZE);
+    /* The sectors and the summary area behind them. */
+    rc = flash_area_erase(fap, 0, TEXT_N_SECTORS *
+                          (TEXT_SECTOR_SIZE + FL_SECTOR_SUMMARY_RESERVE));
     zassert_ok(rc, "text erase failed: %d", rc);
     flash_area_close(fap);
 
@@ -379,6 +412,201 @@ ZTEST(flash_log_reader, test_text_multi_sector_resolvers)
     zassert_equal(summary.boot_count, 3U);
 }
 
+/* ---- Time-range selector ----
+ *
+ * Boot 100 fills sector 0 with late uptimes; boot 200 starts in sector 1 and
+ * stamps its entries TIME_STEP_US apart through sector 5. */
+#define TIME_STEP_US    10U
+#define TIME_ENTRY_LEN  500U
+
+static uint64_t text_fill_timed(size_t target, uint64_t ts)
+{
+    static const uint8_t filler[TIME_ENTRY_LEN] = {0};
+
+    while (text_last_sector < target) {
+        ts += TIME_STEP_US;
+        (void)text_append_at(FL_TYPE_LOG_TEXT, filler, (uint16_t)sizeof(filler),
+                             ts);
+    }
+    return ts;
+}
+
+static void text_write_timed_boots(void)
+{
+    fl_payload_boot_marker_t boot100 = { .boot_id = 100U };
+    fl_payload_boot_marker_t boot200 = { .boot_id = 200U };
+
+    text_fcb_reset();
+    (void)text_append_at(FL_TYPE_BOOT_MARKER, &boot100, sizeof(boot100), 0U);
+    (void)text_fill_timed(1U, 500000U);   /* spills one entry into sector 1 */
+    (void)text_append_at(FL_TYPE_BOOT_MARKER, &boot200, sizeof(boot200), 5U);
+    (void)text_fill_timed(5U, 0U);
+}
+
+/* Drain @p range, checking every entry: returns the entry count and the
+ * lowest / highest timestamps seen. */
+static size_t drain_window(const FlashLogRange_t *range, uint64_t *lo,
+                           uint64_t *hi, size_t *markers)
+{
+    static uint8_t buf[TIME_ENTRY_LEN + sizeof(fl_entry_hdr_t)];
+    FlashLogReader_t r;
+    size_t count = 0U;
+    int n = 0;
+
+    *lo = UINT64_MAX;
+    *hi = 0U;
+    *markers = 0U;
+    flash_log_reader_open(&r, range);
+    while ((n = flash_log_reader_next(&r, buf, sizeof(buf))) > 0) {
+        fl_entry_hdr_t hdr;
+
+        zassert_true((size_t)n >= sizeof(hdr), "whole entry per call");
+        (void)memcpy(&hdr, buf, sizeof(hdr));
+        if (FL_TYPE_BOOT_MARKER == hdr.type) {
+            *markers += 1U;
+        }
+        *lo = MIN(*lo, hdr.ts_boot_us);
+        *hi = MAX(*hi, hdr.ts_boot_us);
+        ++count;
+    }
+    zassert_equal(n, 0, "window drain errored: %d", n);
+    return count;
+}
+
+ZTEST(flash_log_reader, test_time_range_seeks_and_stops)
+{
+    FlashLogRange_t range;
+    uint64_t lo = 0U;
+    uint64_t hi = 0U;
+    size_t markers = 0U;
+
+    text_write_timed_boots();
+
+    /* A window in the middle of boot 200 seeks past its first sectors and
+     * returns exactly the entries stamped inside it. */
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 200U, 150U,
+                                                   250U, &range));
+    zassert_true(range.begin.fe_sector > &text_sectors[1],
+                 "seek must skip the boot's first sector");
+    zassert_equal(drain_window(&range, &lo, &hi, &markers), 11U);
+    zassert_equal(lo, 150U);
+    zassert_equal(hi, 250U);
+    zassert_equal(markers, 0U);
+
+    /* A window at the start of boot 200 must not leak boot 100's tail, whose
+     * uptimes are far later, and must not stop on them either. */
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 200U, 0U,
+                                                   30U, &range));
+    zassert_equal(range.begin.fe_sector, &text_sectors[1]);
+    zassert_equal(drain_window(&range, &lo, &hi, &markers), 4U);
+    zassert_equal(markers, 1U, "boot 200's own marker is inside the window");
+    zassert_equal(hi, 30U);
+
+    /* An open-ended window on boot 100 stops at boot 200's marker. */
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 100U, 0U,
+                                                   UINT64_MAX, &range));
+    (void)drain_window(&range, &lo, &hi, &markers);
+    zassert_equal(markers, 1U, "only boot 100's marker");
+    zassert_true(hi > 500000U, "only boot 100's entries");
+
+    /* A window past the end of the boot is empty. */
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 200U,
+                                                   10000000U, UINT64_MAX,
+                                                   &range));
+    zassert_equal(drain_window(&range, &lo, &hi, &markers), 0U);
+
+    zassert_equal(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 999U, 0U,
+                                                      1U, &range), -ENOENT);
+    zassert_equal(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 200U, 2U,
+                                                      1U, &range), -EINVAL);
+}
+
+/* A batch container that began before the window can carry sub-records inside
+ * it, so the cursor rewinds to the last such container. */
+ZTEST(flash_log_reader, test_time_range_keeps_straddling_batch)
+{
+    static const uint8_t body[64] = {0};
+    fl_payload_boot_marker_t boot = { .boot_id = 300U };
+    FlashLogRange_t range;
+    uint64_t lo = 0U;
+    uint64_t hi = 0U;
+    size_t markers = 0U;
+
+    text_fcb_reset();
+    (void)text_append_at(FL_TYPE_BOOT_MARKER, &boot, sizeof(boot), 0U);
+    (void)text_append_at(FL_TYPE_BATCH_PACKED, body, sizeof(body), 100U);
+    (void)text_append_at(FL_TYPE_BATCH_PACKED, body, sizeof(body), 200U);
+    (void)text_append_at(FL_TYPE_BATCH_PACKED, body, sizeof(body), 300U);
+    (void)text_append_at(FL_TYPE_BATCH_PACKED, body, sizeof(body), 400U);
+
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 300U, 250U,
+                                                   320U, &range));
+    zassert_equal(drain_window(&range, &lo, &hi, &markers), 2U);
+    zassert_equal(lo, 200U, "the container opened at 200 reaches 250");
+    zassert_equal(hi, 300U);
+
+    /* A window that closes before the next container still gets the one
+     * that spans it. */
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 300U, 410U,
+                                                   420U, &range));
+    zassert_equal(drain_window(&range, &lo, &hi, &markers), 1U);
+    zassert_equal(lo, 400U);
+}
+
+ZTEST(flash_log_reader, test_sector_summary_unit_skips_walk)
+{
+    FlashLogIndexSummary_t summary;
+    FlashLogSectorSummary_t unit;
+    fl_payload_boot_marker_t boot = { .boot_id = 700U };
+    uint16_t id = 0U;
+
+    /* Close sector 0 with filler only. */
+    text_fcb_reset();
+    text_fill_to_sector(1U);
+
+    /* Program sector 0's summary unit, in the area behind the last sector
+     * as flash_log.c lays it out, claiming a boot marker that is NOT in the
+     * sector's entries: only the unit can put boot 700 into the index. */
+    flash_log_sector_summary_reset(&unit);
+    flash_log_sector_summary_fold(&unit, FL_TYPE_BOOT_MARKER,
+                                  (const uint8_t *)&boot, sizeof(boot));
+    zassert_true(flash_log_sector_live_id(&text_fcb, &text_sectors[0], &id));
+    flash_log_sector_summary_seal(&unit, id);
+    zassert_equal(flash_log_sector_summary_off(&text_fcb, &text_sectors[0]),
+                  (off_t)(TEXT_N_SECTORS * TEXT_SECTOR_SIZE));
+    zassert_ok(flash_area_write(text_fcb.fap,
+                                flash_log_sector_summary_off(&text_fcb,
+                                                             &text_sectors[0]),
+                                &unit, sizeof(unit)));
+
+    flash_log_reader_invalidate_index();
+    zassert_ok(flash_log_reader_index_summary(FL_DEST_TEXT, &summary));
+    zassert_equal(summary.boot_count, 1U);
+    zassert_equal(summary.boot_id_latest, 700U);
+
+    text_fcb_reset();
+}
+
+ZTEST(flash_log_reader, test_active_summary_skips_walk)
+{
+    FlashLogIndexSummary_t summary;
+    static const uint8_t filler[16] = {0};
+
+    text_fcb_reset();
+    (void)text_append(FL_TYPE_CONSENSUS, filler, (uint16_t)sizeof(filler));
+
+    /* The writer's RAM row for the active sector is used verbatim — the
+     * sector itself holds no boot marker. */
+    test_active_summary.row.first_boot_id = 900U;
+    test_active_summary.row.first_dive_id = FL_INVALID_DIVE_ID;
+    test_active_summary.row.flags = FL_INDEX_FLAG_HAS_BOOT;
+    test_active_summary.valid = true;
+
+    zassert_ok(flash_log_reader_index_summary(FL_DEST_TEXT, &summary));
+    zassert_equal(summary.boot_count, 1U);
+    zassert_equal(summary.boot_id_latest, 900U);
+}
+
 ZTEST(flash_log_reader, test_text_empty_ring_enoent)
 {
     FlashLogRange_t range;
@@ -590,6 +818,96 @@ ZTEST(flash_log_reader, test_exhausted_reader_returns_zero)
                   "exhausted reader must stay finished");
 }
 
+/* Stream `cut` bytes through `chunk`-sized reads, checkpoint, and finish the
+ * range from a second cursor resumed at the checkpoint. */
+static void assert_resume_at(size_t chunk, size_t cut)
+{
+    static uint8_t out[8 * 1024];
+    FlashLogRange_t range = whole_range();
+    FlashLogReader_t r;
+    FlashLogReader_t resumed;
+    FlashLogResumePoint_t point;
+    size_t total = 0;
+
+    flash_log_reader_open(&r, &range);
+    while (total < cut) {
+        int n = flash_log_reader_next(&r, &out[total], MIN(chunk, cut - total));
+
+        zassert_true(n > 0, "next() returned %d before the cut", n);
+        total += (size_t)n;
+    }
+    zassert_ok(flash_log_reader_checkpoint(&r, &point));
+    (void)memset(&resumed, 0xA5, sizeof(resumed));
+    zassert_ok(flash_log_reader_resume(&resumed, &point));
+
+    for (;;) {
+        if (total + chunk > sizeof(out)) {
+            zassert_unreachable("out buffer too small");
+            break;
+        }
+        int n = flash_log_reader_next(&resumed, &out[total], chunk);
+
+        zassert_true(n >= 0, "resumed next() errored: %d", n);
+        if (n == 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    zassert_equal(total, expected_len, "cut %zu: got %zu bytes, expected %zu",
+                  cut, total, expected_len);
+    zassert_mem_equal(out, expected, expected_len, "cut %zu: stream mismatch",
+                      cut);
+}
+
+ZTEST(flash_log_reader, test_checkpoint_resumes_raw_stream)
+{
+    size_t first = sizeof(fl_entry_hdr_t) + entry_payloads[0];
+
+    assert_resume_at(64U, 0U);                    /* before the first entry */
+    assert_resume_at(64U, first);                 /* on an entry boundary */
+    assert_resume_at(64U, first + 3U);            /* inside an entry */
+    assert_resume_at(64U, expected_len - 1U);     /* inside the last entry */
+    assert_resume_at(64U, expected_len);          /* at the end of the range */
+    assert_resume_at(4096U, expected_len);
+}
+
+ZTEST(flash_log_reader, test_checkpoint_guards)
+{
+    static FlashLogFilterScratch_t scratch;
+    static uint8_t buf[64];
+    FlashLogRange_t range = whole_range();
+    FlashLogReader_t r;
+    FlashLogResumePoint_t point;
+
+    flash_log_reader_open(&r, &range);
+    zassert_equal(flash_log_reader_checkpoint(NULL, &point), -EINVAL);
+    zassert_equal(flash_log_reader_checkpoint(&r, NULL), -EINVAL);
+    zassert_equal(flash_log_reader_next(&r, buf, 8U), 8);
+    zassert_ok(flash_log_reader_checkpoint(&r, &point));
+    zassert_equal(point.at, FL_RESUME_IN_ENTRY);
+
+    /* A recycled sector carries another id: the entry is gone. */
+    point.sector_id += 1U;
+    zassert_equal(flash_log_reader_resume(&r, &point), -ESTALE);
+    point.sector_id -= 1U;
+    point.elem_off += 1U;
+    zassert_equal(flash_log_reader_resume(&r, &point), -ESTALE,
+                  "no entry starts at that offset");
+    point.elem_off -= 1U;
+    point.emit_off = UINT16_MAX;
+    zassert_equal(flash_log_reader_resume(&r, &point), -EINVAL);
+    point.bounded = true;
+    point.end_idx = FL_RESUME_NO_SECTOR;
+    zassert_equal(flash_log_reader_resume(&r, &point), -EINVAL);
+    zassert_equal(flash_log_reader_resume(NULL, &point), -EINVAL);
+    zassert_equal(flash_log_reader_resume(&r, NULL), -EINVAL);
+
+    flash_log_reader_open(&r, &range);
+    zassert_ok(flash_log_reader_set_filter(&r, UINT64_MAX, &scratch));
+    zassert_equal(flash_log_reader_checkpoint(&r, &point), -ENOTSUP,
+                  "a filtered cursor has decode state a checkpoint drops");
+}
+
 ZTEST(flash_log_reader, test_index_summary_and_resolvers)
 {
     FlashLogIndexSummary_t summary;
@@ -664,6 +982,10 @@ ZTEST(flash_log_reader, test_resolver_input_and_busy_guards)
               -EINVAL);
     zassert_equal(flash_log_reader_resolve_dive_id(
         FL_DEST_TELEMETRY, 1U, NULL), -EINVAL);
+    zassert_equal(flash_log_reader_resolve_time_range(invalid, 1U, 0U, 1U,
+                                                      &range), -EINVAL);
+    zassert_equal(flash_log_reader_resolve_time_range(
+        FL_DEST_TELEMETRY, 1U, 0U, 1U, NULL), -EINVAL);
 
     zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_FACTORY));
     zassert_equal(flash_log_reader_index_summary(
@@ -676,6 +998,8 @@ ZTEST(flash_log_reader, test_resolver_input_and_busy_guards)
         FL_DEST_TELEMETRY, &range), -EBUSY);
     zassert_equal(flash_log_reader_resolve_dive_id(
         FL_DEST_TELEMETRY, 7U, &range), -EBUSY);
+    zassert_equal(flash_log_reader_resolve_time_range(
+        FL_DEST_TELEMETRY, 10U, 0U, 1U, &range), -EBUSY);
     maint_arena_release(MAINT_ARENA_OWNER_FACTORY);
 }
 
@@ -723,3 +1047,363 @@ ZTEST(flash_log_reader, test_clean_entry_has_no_double_header)
     zassert_equal(total, want, "reader emitted %zu bytes, clean total is %zu "
                   "(double-counted header?)", total, want);
 }
+
+ZTEST(flash_log_reader, test_expand_packed_batch)
+{
+    /* A packed container expands back to the legacy [fl_entry_hdr_t +
+     * payload] sequence: same types, timestamps and payload bytes. */
+    static uint8_t plain[2][sizeof(fl_payload_consensus_t)];
+    static uint8_t packed[128];
+    static uint8_t out[256];
+    const uint64_t base_ts = 7000000U;
+    FlashLogCodec_t codec;
+    size_t packed_len = 0U;
+    size_t out_len = 0U;
+
+    for (size_t i = 0U; i < sizeof(plain[0]); ++i) {
+        plain[0][i] = (uint8_t)(i * 3U);
+        plain[1][i] = (uint8_t)(i * 3U);
+    }
+    plain[1][0] = 0x99U;
+    flash_log_codec_init(&codec, &plain[0][0], base_ts);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_CONSENSUS, base_ts,
+                                         plain[0], sizeof(plain[0]),
+                                         &packed[packed_len]);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_CONSENSUS,
+                                         base_ts + 100000U, plain[1],
+                                         sizeof(plain[1]), &packed[packed_len]);
+
+    fl_entry_hdr_t hdr = {
+        .type = FL_TYPE_BATCH_PACKED,
+        .length = (uint16_t)packed_len,
+        .ts_boot_us = base_ts,
+    };
+
+    zassert_ok(flash_log_reader_expand_batch(&hdr, packed, out, sizeof(out),
+                                             &out_len));
+    zassert_equal(out_len, 2U * (sizeof(fl_entry_hdr_t) + sizeof(plain[0])));
+
+    for (size_t r = 0U; r < 2U; ++r) {
+        fl_entry_hdr_t sub = {0};
+        const uint8_t *rec = &out[r * (sizeof(sub) + sizeof(plain[0]))];
+
+        (void)memcpy(&sub, rec, sizeof(sub));
+        zassert_equal(sub.type, FL_TYPE_CONSENSUS);
+        zassert_equal(sub.length, sizeof(plain[0]));
+        zassert_equal(sub.ts_boot_us, base_ts + (r * 100000U));
+        zassert_mem_equal(&rec[sizeof(sub)], plain[r], sizeof(plain[0]));
+    }
+
+    /* Too small an output, a truncated container, and a legacy entry all
+     * fail cleanly rather than emitting a partial record. */
+    zassert_equal(flash_log_reader_expand_batch(&hdr, packed, out, 20U,
+                                                &out_len), -ENOSPC);
+    zassert_equal(out_len, 0U);
+    hdr.length = (uint16_t)(packed_len - 1U);
+    zassert_equal(flash_log_reader_expand_batch(&hdr, packed, out, sizeof(out),
+                                                &out_len), -EBADMSG);
+    hdr.type = FL_TYPE_BATCH;
+    zassert_equal(flash_log_reader_expand_batch(&hdr, packed, out, sizeof(out),
+                                                &out_len), -EINVAL);
+}
+
+/* ---- record-type filter ---- */
+
+#define FILTER_RECORDS_MAX  16U
+
+/* One expected record of a filtered stream. For an FL_TYPE_AGGREGATE record
+ * the payload is its fl_payload_aggregate_t prefix and mean0 the mean of its
+ * first channel. */
+typedef struct {
+    uint8_t type;
+    uint64_t ts;
+    const uint8_t *payload;
+    uint16_t length;
+    float mean0;
+} FilterRecord_t;
+
+static uint8_t filter_cons[3][sizeof(fl_payload_consensus_t)];
+static uint8_t filter_pid[2][sizeof(fl_payload_pid_t)];
+static uint8_t filter_power[sizeof(fl_payload_power_snapshot_t)];
+static uint8_t filter_fire[sizeof(fl_payload_solenoid_fire_t)];
+static fl_payload_boot_marker_t filter_boot = { .boot_id = 400U };
+static fl_payload_dive_marker_t filter_dive = { .dive_number = 9U };
+
+/* Boot 400 on the TEXT ring: a packed container mixing consensus, PID and
+ * power records, a legacy container holding a solenoid fire and a consensus,
+ * plain power and consensus entries, and a dive-start marker. */
+static void text_write_mixed_boot(void)
+{
+    static uint8_t plain[2U * sizeof(fl_payload_consensus_t) +
+                         2U * sizeof(fl_payload_pid_t) +
+                         sizeof(fl_payload_power_snapshot_t)];
+    static uint8_t packed[256];
+    static uint8_t legacy[2U * sizeof(fl_entry_hdr_t) +
+                          sizeof(filter_fire) + sizeof(filter_cons[2])];
+    FlashLogCodec_t codec;
+    size_t packed_len = 0U;
+    size_t off = 0U;
+
+    for (size_t i = 0U; i < sizeof(filter_cons[0]); ++i) {
+        filter_cons[0][i] = (uint8_t)(i * 5U);
+        filter_cons[1][i] = (uint8_t)(i * 5U);
+        filter_cons[2][i] = (uint8_t)(0xA0U + i);
+    }
+    filter_cons[1][0] = 0x77U;
+    (void)memset(filter_pid[0], 0x31, sizeof(filter_pid[0]));
+    (void)memset(filter_pid[1], 0x32, sizeof(filter_pid[1]));
+    (void)memset(filter_power, 0x55, sizeof(filter_power));
+    (void)memset(filter_fire, 0x66, sizeof(filter_fire));
+
+    /* The encoder references previous records by offset, so every plain
+     * payload lives in one buffer. */
+    const uint8_t *cons0 = &plain[off];
+    (void)memcpy(&plain[off], filter_cons[0], sizeof(filter_cons[0]));
+    off += sizeof(filter_cons[0]);
+    const uint8_t *pid0 = &plain[off];
+    (void)memcpy(&plain[off], filter_pid[0], sizeof(filter_pid[0]));
+    off += sizeof(filter_pid[0]);
+    const uint8_t *power = &plain[off];
+    (void)memcpy(&plain[off], filter_power, sizeof(filter_power));
+    off += sizeof(filter_power);
+    const uint8_t *cons1 = &plain[off];
+    (void)memcpy(&plain[off], filter_cons[1], sizeof(filter_cons[1]));
+    off += sizeof(filter_cons[1]);
+    const uint8_t *pid1 = &plain[off];
+    (void)memcpy(&plain[off], filter_pid[1], sizeof(filter_pid[1]));
+
+    flash_log_codec_init(&codec, plain, 1000U);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_CONSENSUS, 1000U, cons0,
+                                         sizeof(filter_cons[0]), &packed[packed_len]);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_PID_SNAPSHOT, 1010U, pid0,
+                                         sizeof(filter_pid[0]), &packed[packed_len]);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_POWER_SNAPSHOT, 1020U, power,
+                                         sizeof(filter_power), &packed[packed_len]);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_CONSENSUS, 1030U, cons1,
+                                         sizeof(filter_cons[1]), &packed[packed_len]);
+    packed_len += flash_log_codec_encode(&codec, FL_TYPE_PID_SNAPSHOT, 1040U, pid1,
+                                         sizeof(filter_pid[1]), &packed[packed_len]);
+
+    fl_entry_hdr_t sub = {
+        .type = FL_TYPE_SOLENOID_FIRE, .length = sizeof(filter_fire),
+        .ts_boot_us = 2000U,
+    };
+
+    off = 0U;
+    (void)memcpy(&legacy[off], &sub, sizeof(sub));
+    off += sizeof(sub);
+    (void)memcpy(&legacy[off], filter_fire, sizeof(filter_fire));
+    off += sizeof(filter_fire);
+    sub.type = FL_TYPE_CONSENSUS;
+    sub.length = sizeof(filter_cons[2]);
+    sub.ts_boot_us = 2010U;
+    (void)memcpy(&legacy[off], &sub, sizeof(sub));
+    off += sizeof(sub);
+    (void)memcpy(&legacy[off], filter_cons[2], sizeof(filter_cons[2]));
+
+    text_fcb_reset();
+    (void)text_append_at(FL_TYPE_BOOT_MARKER, &filter_boot, sizeof(filter_boot), 0U);
+    (void)text_append_at(FL_TYPE_BATCH_PACKED, packed, (uint16_t)packed_len, 1000U);
+    (void)text_append_at(FL_TYPE_BATCH, legacy, sizeof(legacy), 2000U);
+    (void)text_append_at(FL_TYPE_POWER_SNAPSHOT, filter_power, sizeof(filter_power), 3000U);
+    (void)text_append_at(FL_TYPE_CONSENSUS, filter_cons[2], sizeof(filter_cons[2]),
+                         3100U);
+    (void)text_append_at(FL_TYPE_DIVE_START, &filter_dive, sizeof(filter_dive),
+                         3200U);
+}
+
+/* Drain a filtered cursor over @p range through @p chunk-sized reads, with
+ * @p bucket_us decimation when non-zero, and check the reassembled stream is
+ * exactly @p want, record by record. */
+static void assert_stream(const FlashLogRange_t *range, uint64_t mask,
+                          uint32_t bucket_us, size_t chunk,
+                          const FilterRecord_t *want, size_t want_count)
+{
+    static FlashLogFilterScratch_t scratch;
+    static FlashLogAggregator_t agg;
+    static uint8_t stream[1024];
+    FlashLogReader_t r;
+    size_t total = 0U;
+    size_t off = 0U;
+    size_t count = 0U;
+    int n = 0;
+
+    flash_log_reader_open(&r, range);
+    zassert_ok(flash_log_reader_set_filter(&r, mask, &scratch));
+    if (0U != bucket_us) {
+        zassert_ok(flash_log_reader_set_decimation(&r, bucket_us, &agg));
+    }
+    while ((total + chunk) <= sizeof(stream)) {
+        n = flash_log_reader_next(&r, &stream[total], chunk);
+        if (n <= 0) {
+            break;
+        }
+        zassert_true((size_t)n <= chunk, "over-wrote the buffer");
+        total += (size_t)n;
+    }
+    zassert_equal(n, 0, "filtered drain errored: %d", n);
+
+    while ((off + sizeof(fl_entry_hdr_t)) <= total) {
+        fl_entry_hdr_t hdr;
+
+        (void)memcpy(&hdr, &stream[off], sizeof(hdr));
+        zassert_true(count < want_count, "unexpected record type 0x%02x",
+                     hdr.type);
+        zassert_equal(hdr.type, want[count].type, "record %zu type", count);
+        zassert_equal(hdr.ts_boot_us, want[count].ts, "record %zu ts", count);
+        zassert_equal(hdr.length, want[count].length, "record %zu length", count);
+        if (FL_TYPE_AGGREGATE == hdr.type) {
+            fl_agg_channel_t ch0;
+
+            zassert_mem_equal(&stream[off + sizeof(hdr)], want[count].payload,
+                              sizeof(fl_payload_aggregate_t),
+                              "record %zu prefix", count);
+            (void)memcpy(&ch0, &stream[off + sizeof(hdr) +
+                                       sizeof(fl_payload_aggregate_t)],
+                         sizeof(ch0));
+            zassert_within(ch0.mean, want[count].mean0, 0.001f,
+                           "record %zu mean", count);
+        } else {
+            zassert_mem_equal(&stream[off + sizeof(hdr)], want[count].payload,
+                              hdr.length, "record %zu payload", count);
+        }
+        off += sizeof(hdr) + hdr.length;
+        ++count;
+    }
+    zassert_equal(off, total, "stream ends mid-record");
+    zassert_equal(count, want_count, "got %zu records", count);
+}
+
+ZTEST(flash_log_reader, test_type_filter_flattens_containers)
+{
+    const uint64_t mask = (1ULL << FL_TYPE_CONSENSUS) | (1ULL << FL_TYPE_PID_SNAPSHOT);
+    const FilterRecord_t want[] = {
+        { FL_TYPE_BOOT_MARKER, 0U, (const uint8_t *)&filter_boot, sizeof(filter_boot) },
+        { FL_TYPE_CONSENSUS, 1000U, filter_cons[0], sizeof(filter_cons[0]) },
+        { FL_TYPE_PID_SNAPSHOT, 1010U, filter_pid[0], sizeof(filter_pid[0]) },
+        { FL_TYPE_CONSENSUS, 1030U, filter_cons[1], sizeof(filter_cons[1]) },
+        { FL_TYPE_PID_SNAPSHOT, 1040U, filter_pid[1], sizeof(filter_pid[1]) },
+        { FL_TYPE_CONSENSUS, 2010U, filter_cons[2], sizeof(filter_cons[2]) },
+        { FL_TYPE_CONSENSUS, 3100U, filter_cons[2], sizeof(filter_cons[2]) },
+        { FL_TYPE_DIVE_START, 3200U, (const uint8_t *)&filter_dive, sizeof(filter_dive) },
+    };
+    FlashLogRange_t range;
+
+    text_write_mixed_boot();
+    zassert_ok(flash_log_reader_resolve_all(FL_DEST_TEXT, &range));
+
+    /* Whole records per call, and sliced records, give the same stream. */
+    assert_stream(&range, mask, 0U, 256U, want, ARRAY_SIZE(want));
+    assert_stream(&range, mask, 0U, 5U, want, ARRAY_SIZE(want));
+
+    /* An empty mask still keeps the markers. */
+    const FilterRecord_t markers[] = { want[0], want[ARRAY_SIZE(want) - 1U] };
+
+    assert_stream(&range, 0U, 0U, 256U, markers, ARRAY_SIZE(markers));
+}
+
+ZTEST(flash_log_reader, test_type_filter_applies_time_window)
+{
+    const uint64_t mask = (1ULL << FL_TYPE_CONSENSUS) | (1ULL << FL_TYPE_PID_SNAPSHOT);
+    const FilterRecord_t want[] = {
+        { FL_TYPE_CONSENSUS, 1030U, filter_cons[1], sizeof(filter_cons[1]) },
+        { FL_TYPE_PID_SNAPSHOT, 1040U, filter_pid[1], sizeof(filter_pid[1]) },
+    };
+    FlashLogRange_t range;
+
+    /* Both containers straddle [1025, 2005]; only the sub-records stamped
+     * inside it survive. */
+    text_write_mixed_boot();
+    zassert_ok(flash_log_reader_resolve_time_range(FL_DEST_TEXT, 400U, 1025U,
+                                                   2005U, &range));
+    assert_stream(&range, mask, 0U, 256U, want, ARRAY_SIZE(want));
+}
+
+ZTEST(flash_log_reader, test_type_filter_guards)
+{
+    static FlashLogFilterScratch_t scratch;
+    static uint8_t buf[64];
+    FlashLogRange_t range;
+    FlashLogReader_t r;
+
+    text_write_mixed_boot();
+    zassert_ok(flash_log_reader_resolve_all(FL_DEST_TEXT, &range));
+    flash_log_reader_open(&r, &range);
+    zassert_equal(flash_log_reader_set_filter(NULL, 0U, &scratch), -EINVAL);
+    zassert_equal(flash_log_reader_set_filter(&r, 0U, NULL), -EINVAL);
+    zassert_true(flash_log_reader_next(&r, buf, sizeof(buf)) > 0);
+    zassert_equal(flash_log_reader_set_filter(&r, 0U, &scratch), -EINVAL,
+                  "a started cursor cannot change its filter");
+}
+
+/* ---- decimation ---- */
+
+#define DECIMATE_BUCKET_US  1000U
+#define AGG_LEN(channels) \
+    ((uint16_t)(sizeof(fl_payload_aggregate_t) + ((channels) * sizeof(fl_agg_channel_t))))
+
+ZTEST(flash_log_reader, test_decimation_folds_into_buckets)
+{
+    const uint64_t mask = (1ULL << FL_TYPE_CONSENSUS) |
+                          (1ULL << FL_TYPE_PID_SNAPSHOT) |
+                          (1ULL << FL_TYPE_POWER_SNAPSHOT);
+    static const fl_payload_aggregate_t cons_b1 = {
+        FL_TYPE_CONSENSUS, FL_AGG_NO_KEY, 2U, DECIMATE_BUCKET_US };
+    static const fl_payload_aggregate_t power_b1 = {
+        FL_TYPE_POWER_SNAPSHOT, FL_AGG_NO_KEY, 1U, DECIMATE_BUCKET_US };
+    static const fl_payload_aggregate_t cons_one = {
+        FL_TYPE_CONSENSUS, FL_AGG_NO_KEY, 1U, DECIMATE_BUCKET_US };
+    float power_vbus = 0.0f;
+    FlashLogRange_t range;
+
+    text_write_mixed_boot();
+    (void)memcpy(&power_vbus, filter_power, sizeof(power_vbus));
+    /* Consensus and power fold per 1 ms bucket; PID and the markers stream
+     * as is. A bucket is emitted ahead of the first record past it (the
+     * consensus in the legacy container, then the plain power entry) and
+     * at the end of the range. */
+    const FilterRecord_t want[] = {
+        { FL_TYPE_BOOT_MARKER, 0U, (const uint8_t *)&filter_boot, sizeof(filter_boot) },
+        { FL_TYPE_PID_SNAPSHOT, 1010U, filter_pid[0], sizeof(filter_pid[0]) },
+        { FL_TYPE_PID_SNAPSHOT, 1040U, filter_pid[1], sizeof(filter_pid[1]) },
+        { FL_TYPE_AGGREGATE, 1000U, (const uint8_t *)&cons_b1, AGG_LEN(9U),
+          (float)(0U + 0x77U) / 2.0f },
+        { FL_TYPE_AGGREGATE, 1000U, (const uint8_t *)&power_b1, AGG_LEN(5U),
+          power_vbus },
+        { FL_TYPE_AGGREGATE, 2000U, (const uint8_t *)&cons_one, AGG_LEN(9U),
+          (float)filter_cons[2][0] },
+        { FL_TYPE_DIVE_START, 3200U, (const uint8_t *)&filter_dive, sizeof(filter_dive) },
+        { FL_TYPE_AGGREGATE, 3000U, (const uint8_t *)&cons_one, AGG_LEN(9U),
+          (float)filter_cons[2][0] },
+        { FL_TYPE_AGGREGATE, 3000U, (const uint8_t *)&power_b1, AGG_LEN(5U),
+          power_vbus },
+    };
+
+    zassert_ok(flash_log_reader_resolve_all(FL_DEST_TEXT, &range));
+    assert_stream(&range, mask, DECIMATE_BUCKET_US, 256U, want, ARRAY_SIZE(want));
+    assert_stream(&range, mask, DECIMATE_BUCKET_US, 5U, want, ARRAY_SIZE(want));
+}
+
+ZTEST(flash_log_reader, test_decimation_guards)
+{
+    static FlashLogFilterScratch_t scratch;
+    static FlashLogAggregator_t agg;
+    static uint8_t buf[64];
+    FlashLogRange_t range;
+    FlashLogReader_t r;
+
+    text_write_mixed_boot();
+    zassert_ok(flash_log_reader_resolve_all(FL_DEST_TEXT, &range));
+    flash_log_reader_open(&r, &range);
+    zassert_equal(flash_log_reader_set_decimation(&r, DECIMATE_BUCKET_US, &agg),
+                  -EINVAL, "decimation needs the filtered cursor");
+    zassert_ok(flash_log_reader_set_filter(&r, UINT64_MAX, &scratch));
+    zassert_equal(flash_log_reader_set_decimation(NULL, DECIMATE_BUCKET_US, &agg),
+                  -EINVAL);
+    zassert_equal(flash_log_reader_set_decimation(&r, DECIMATE_BUCKET_US, NULL),
+                  -EINVAL);
+    zassert_equal(flash_log_reader_set_decimation(&r, 0U, &agg), -EINVAL);
+    zassert_true(flash_log_reader_next(&r, buf, sizeof(buf)) > 0);
+    zassert_equal(flash_log_reader_set_decimation(&r, DECIMATE_BUCKET_US, &agg),
+                  -EINVAL, "a started cursor cannot start decimating");
+}
@@ -0,0 +1,228 @@
+/**
+ * @file main.c
+ * @brief Unit tests for the flash-log live tail.
+ *
+ * Offers synthetic records to flash_log_tail.c with chosen timestamps and
+ * drains them back as the push poller would. No FCB, no writer thread, no
+ * UDS transport.
+ */
+
+#include <zephyr/ztest.h>
+#include <string.h>
+#include <errno.h>
+
+#include "flash_log.h"
+#include "flash_log_entries.h"
+#include "flash_log_tail.h"
+
+#define T0_MS          5000U
+#define US_PER_MS      1000ULL
+#define HDR_LEN        ((uint16_t)sizeof(fl_entry_hdr_t))
+#define CONSENSUS_LEN  ((uint16_t)sizeof(fl_payload_consensus_t))
+#define CONSENSUS_REC  (HDR_LEN + CONSENSUS_LEN)
+#define DRAIN_CAP      253U
+
+static uint8_t out[DRAIN_CAP];
+
+static const uint64_t CONSENSUS_ONLY = 1ULL << FL_TYPE_CONSENSUS;
+
+static void tail_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    flash_log_tail_unsubscribe();
+    (void)memset(out, 0, sizeof(out));
+}
+
+ZTEST_SUITE(flash_log_tail, NULL, NULL, tail_before, NULL, NULL);
+
+static void offer_consensus(uint32_t at_ms, uint8_t ppo2)
+{
+    fl_payload_consensus_t p = {
+        .consensus_ppo2 = ppo2,
+        .ppo2_array = { ppo2, ppo2, ppo2 },
+        .milli_array = { 4500U, 4600U, 4700U },
+        .status_packed = 0x1FFU,
+        .confidence = 3U,
+        .setpoint = 130U,
+    };
+
+    flash_log_tail_offer(FL_TYPE_CONSENSUS, (uint64_t)at_ms * US_PER_MS,
+                         &p, CONSENSUS_LEN);
+}
+
+static fl_entry_hdr_t hdr_at(size_t off)
+{
+    fl_entry_hdr_t hdr;
+
+    (void)memcpy(&hdr, &out[off], sizeof(hdr));
+    return hdr;
+}
+
+ZTEST(flash_log_tail, test_subscribe_validation)
+{
+    zassert_equal(flash_log_tail_subscribe(0U, 0U, T0_MS), -EINVAL,
+                  "empty mask refused");
+    zassert_equal(flash_log_tail_subscribe(1ULL << FL_TYPE_CAN_TX, 0U, T0_MS),
+                  -EINVAL, "CAN capture is never tailed");
+    zassert_equal(flash_log_tail_subscribe(1ULL << FL_TYPE_BOOT_MARKER, 0U,
+                                           T0_MS),
+                  -EINVAL, "boot marker does not fit a tail slot");
+    zassert_equal(flash_log_tail_subscribe(CONSENSUS_ONLY,
+                                           FL_TAIL_BUDGET_MIN - 1U, T0_MS),
+                  -EINVAL, "budget below the floor");
+    zassert_equal(flash_log_tail_subscribe(CONSENSUS_ONLY,
+                                           FL_TAIL_BUDGET_MAX + 1U, T0_MS),
+                  -EINVAL, "budget above the ceiling");
+    zassert_ok(flash_log_tail_subscribe(FL_TAIL_TYPES_ALLOWED, 0U, T0_MS),
+               "every allowed type at the default budget");
+}
+
+ZTEST(flash_log_tail, test_record_uses_dclg_framing)
+{
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U, T0_MS));
+    offer_consensus(T0_MS + 10U, 117U);
+
+    uint16_t n = flash_log_tail_drain(out, sizeof(out), T0_MS + 20U);
+    fl_entry_hdr_t hdr = hdr_at(0U);
+    fl_payload_consensus_t p;
+
+    zassert_equal(n, CONSENSUS_REC, "one whole record");
+    zassert_equal(hdr.type, FL_TYPE_CONSENSUS);
+    zassert_equal(hdr.flags, 0U);
+    zassert_equal(hdr.length, CONSENSUS_LEN);
+    zassert_equal(hdr.ts_boot_us, (uint64_t)(T0_MS + 10U) * US_PER_MS,
+                  "the record's own timestamp");
+    (void)memcpy(&p, &out[HDR_LEN], sizeof(p));
+    zassert_equal(p.consensus_ppo2, 117U);
+    zassert_equal(p.milli_array[2], 4700U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS + 30U), 0U,
+                  "queue empty afterwards");
+}
+
+ZTEST(flash_log_tail, test_unselected_and_unsubscribed_ignored)
+{
+    const fl_payload_atmos_pressure_t atmos = { .pressure_mbar = 1013U };
+
+    offer_consensus(T0_MS, 100U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS), 0U,
+                  "nothing tailed without a subscription");
+
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U, T0_MS));
+    flash_log_tail_offer(FL_TYPE_ATMOS_PRESSURE, (uint64_t)T0_MS * US_PER_MS,
+                         &atmos, sizeof(atmos));
+    flash_log_tail_offer(FL_TYPE_CAN_RX, (uint64_t)T0_MS * US_PER_MS,
+                         &atmos, sizeof(atmos));
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS), 0U,
+                  "only selected types are tailed");
+}
+
+ZTEST(flash_log_tail, test_budget_drops_and_flags_gap)
+{
+    /* 64 B/s: the fresh bucket holds 64 B, two 26-byte records. */
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, FL_TAIL_BUDGET_MIN,
+                                        T0_MS));
+    offer_consensus(T0_MS, 1U);
+    offer_consensus(T0_MS, 2U);
+    offer_consensus(T0_MS, 3U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS),
+                  2U * CONSENSUS_REC, "third record over budget");
+
+    /* Half a second refills 32 B: one more record, flagged after the gap. */
+    offer_consensus(T0_MS + 500U, 4U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS + 500U),
+                  CONSENSUS_REC);
+    zassert_equal(hdr_at(0U).flags, FL_ENTRY_FLAG_DROP_PRECEDED,
+                  "first record after a drop carries the flag");
+    zassert_equal(out[HDR_LEN], 4U);
+
+    /* A timestamp slightly behind the refill point earns nothing. */
+    offer_consensus(T0_MS + 499U, 5U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS + 500U), 0U,
+                  "bucket not refilled by an earlier stamp");
+
+    /* A long idle period refills only one second's worth. */
+    for (uint8_t i = 0U; i < 3U; i++) {
+        offer_consensus(T0_MS + 10000U, 10U + i);
+    }
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS + 10000U),
+                  2U * CONSENSUS_REC, "burst capped at one second");
+    zassert_equal(hdr_at(0U).flags, FL_ENTRY_FLAG_DROP_PRECEDED);
+    zassert_equal(hdr_at(CONSENSUS_REC).flags, 0U);
+}
+
+ZTEST(flash_log_tail, test_queue_full_drops_and_flags_gap)
+{
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, FL_TAIL_BUDGET_MAX,
+                                        T0_MS));
+    for (uint8_t i = 0U; i < (CONFIG_FLASH_LOG_TAIL_QUEUE_DEPTH + 2U); i++) {
+        offer_consensus(T0_MS, i);
+    }
+
+    uint16_t n = flash_log_tail_drain(out, sizeof(out), T0_MS);
+
+    zassert_equal(n, CONFIG_FLASH_LOG_TAIL_QUEUE_DEPTH * CONSENSUS_REC,
+                  "queue depth bounds what is kept");
+    zassert_equal(out[HDR_LEN], 0U, "oldest records kept");
+
+    offer_consensus(T0_MS + 1U, 99U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS + 1U),
+                  CONSENSUS_REC);
+    zassert_equal(hdr_at(0U).flags, FL_ENTRY_FLAG_DROP_PRECEDED,
+                  "overflow is flagged like a budget drop");
+}
+
+ZTEST(flash_log_tail, test_drain_moves_whole_records_only)
+{
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, FL_TAIL_BUDGET_MAX,
+                                        T0_MS));
+    offer_consensus(T0_MS, 1U);
+    offer_consensus(T0_MS, 2U);
+    offer_consensus(T0_MS, 3U);
+
+    /* Room for two and a half records. */
+    zassert_equal(flash_log_tail_drain(out, (2U * CONSENSUS_REC) + 13U, T0_MS),
+                  2U * CONSENSUS_REC, "no record split across pushes");
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS),
+                  CONSENSUS_REC, "the third waits for the next push");
+    zassert_equal(out[HDR_LEN], 3U);
+}
+
+ZTEST(flash_log_tail, test_lease_lapses_without_renewal)
+{
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U, T0_MS));
+
+    /* Renewal just before the lease would end keeps the queue. */
+    offer_consensus(T0_MS + FL_TAIL_LEASE_MS - 1U, 1U);
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U,
+                                        T0_MS + FL_TAIL_LEASE_MS - 1U));
+    zassert_equal(flash_log_tail_drain(out, sizeof(out),
+                                       T0_MS + FL_TAIL_LEASE_MS),
+                  CONSENSUS_REC, "renewal keeps queued records");
+
+    /* A full lease after the renewal the subscription ends. */
+    uint32_t lapse_ms = T0_MS + (2U * FL_TAIL_LEASE_MS) - 1U;
+
+    offer_consensus(lapse_ms, 2U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), lapse_ms), 0U,
+                  "no records once the lease has lapsed");
+    offer_consensus(lapse_ms + 1U, 3U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), lapse_ms + 1U), 0U,
+                  "the lapsed subscription stays ended");
+
+    /* A new subscription starts clean. */
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U, lapse_ms + 2U));
+    offer_consensus(lapse_ms + 3U, 4U);
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), lapse_ms + 3U),
+                  CONSENSUS_REC);
+    zassert_equal(hdr_at(0U).flags, 0U, "no stale drop flag");
+}
+
+ZTEST(flash_log_tail, test_unsubscribe_discards_queue)
+{
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U, T0_MS));
+    offer_consensus(T0_MS, 1U);
+    flash_log_tail_unsubscribe();
+    zassert_ok(flash_log_tail_subscribe(CONSENSUS_ONLY, 0U, T0_MS + 1U));
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), T0_MS + 1U), 0U,
+                  "records of an ended subscription are not delivered");
+}
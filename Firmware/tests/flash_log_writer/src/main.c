@@ -5,8 +5,9 @@
  * The inverse of tests/flash_log_reader: the REAL producer (flash_log.c —
  * enqueue API, writer thread, batching, settings subtree, erase) is linked
  * and mounted on two real FCBs backed by flash_simulator partitions.
- * Readback is done with fcb_walk + flash_area_read, recursing into
- * FL_TYPE_BATCH containers exactly the way the reader does.
+ * Readback is done with fcb_walk + flash_area_read, decoding
+ * FL_TYPE_BATCH_PACKED containers with the shared codec exactly the way
+ * the reader does.
  *
  * Failure arms (fcb_append / fcb_rotate / flash_area_write /
  * settings_save_one errors) are driven by linker --wrap shims with scripted
@@ -32,6 +33,7 @@
 #include "flash_log.h"
 #include "flash_log_entries.h"
 #include "flash_log_internal.h"
+#include "flash_log_codec.h"
 
 LOG_MODULE_REGISTER(flash_log_writer_test, LOG_LEVEL_INF);
 
@@ -244,7 +246,7 @@ static const size_t WALK_BUF_BYTES = 4608U; /* > FL_BATCH_BUF_BYTES (4096) */
 static const size_t LAST_PAYLOAD_BYTES = 128U;
 
 /**
- * @brief Walk query: count entries of `type` (recursing into FL_TYPE_BATCH
+ * @brief Walk query: count entries of `type` (decoding FL_TYPE_BATCH_PACKED
  *        containers), optionally filtered by payload length or by the
  *        dive_number field, capturing the last match for field asserts.
  */
@@ -261,6 +263,7 @@ typedef struct {
 } WalkQuery_t;
 
 static uint8_t walk_buf[4608];
+static uint8_t expand_buf[4608];
 
 static void wq_offer(WalkQuery_t *q, const fl_entry_hdr_t *hdr,
                      const uint8_t *payload)
@@ -313,22 +316,29 @@ static int walk_cb(struct fcb_entry_ctx *ctx, void *arg)
                              walk_buf, plen);
         if (0 == rc) {
             wq_offer(q, &hdr, walk_buf);
-            if (FL_TYPE_BATCH == hdr.type) {
-                /* Recurse into the packed [fl_entry_hdr_t + payload]
-                 * sub-record sequence, exactly as a reader would. */
+            if (FL_TYPE_BATCH_PACKED == hdr.type) {
+                /* Decode the packed sub-record sequence with the shared
+                 * codec, exactly as a reader would. The decoded payloads
+                 * land back to back in expand_buf, which doubles as the
+                 * codec's previous-record store. */
+                FlashLogCodec_t codec;
                 size_t off = 0U;
-                bool bounded = true;
+                size_t out = 0U;
+                Status_t drc = 0;
 
-                while (bounded && ((off + sizeof(fl_entry_hdr_t)) <= plen)) {
+                flash_log_codec_init(&codec, expand_buf, hdr.ts_boot_us);
+                while ((0 == drc) && (off < plen)) {
                     fl_entry_hdr_t sub = {0};
-
-                    (void)memcpy(&sub, &walk_buf[off], sizeof(sub));
-                    off += sizeof(sub);
-                    if ((off + sub.length) > plen) {
-                        bounded = false;
-                    } else {
-                        wq_offer(q, &sub, &walk_buf[off]);
-                        off += sub.length;
+                    size_t used = 0U;
+
+                    drc = flash_log_codec_decode(&codec, &walk_buf[off],
+                                                 plen - off, &used, &sub,
+                                                 &expand_buf[out],
+                                                 sizeof(expand_buf) - out);
+                    if (0 == drc) {
+                        wq_offer(q, &sub, &expand_buf[out]);
+                        out += sub.length;
+                        off += used;
                     }
                 }
             }
@@ -801,10 +811,10 @@ ZTEST(flash_log_writer, test_telemetry_types_roundtrip_through_batch)
     flash_log_enqueue_error(NULL);
 
     /* Let the 2 s batch window elapse — everything above lands inside one
-     * or more FL_TYPE_BATCH containers. */
+     * or more FL_TYPE_BATCH_PACKED containers. */
     (void)k_msleep(SETTLE_FLUSH_MS);
 
-    zassert_true(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH) >= 1U);
+    zassert_true(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH_PACKED) >= 1U);
     zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_CAN_RX), 1U,
                   "CAN RX capture must respect the verbose gate");
     zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_CAN_TX), 1U,
@@ -1125,6 +1135,33 @@ ZTEST(flash_log_writer, test_marker_append_enospc_rotate_fails)
                              dive_number), 1U);
 }
 
+ZTEST(flash_log_writer, test_rotate_erases_summary_unit)
+{
+    /* The FCB erases only the sector it rotates out; the writer must blank
+     * that sector's summary unit too, so closing it next lap only programs. */
+    const uint16_t dive_number = 34U;
+    struct fcb *telemetry = flash_log_internal_get_fcb(FL_DEST_TELEMETRY);
+    off_t off = flash_log_sector_summary_off(telemetry, telemetry->f_oldest);
+    static const uint8_t stale[8] = {0};
+    uint8_t back[8] = {0};
+
+    /* A unit left by an earlier lap of the ring. */
+    zassert_ok(flash_area_erase(telemetry->fap, off,
+                                CONFIG_FLASH_LOG_SECTOR_SUMMARY_RESERVE));
+    zassert_ok(flash_area_write(telemetry->fap, off, stale, sizeof(stale)));
+
+    inject_arm(&inject.append, 0, -ENOSPC);
+    flash_log_enqueue_dive_marker(true, dive_number, 0U);
+    (void)k_msleep(SETTLE_MARKER_MS);
+
+    zassert_equal(count_dive(FL_DEST_TELEMETRY, FL_TYPE_DIVE_START,
+                             dive_number), 1U);
+    zassert_ok(flash_area_read(telemetry->fap, off, back, sizeof(back)));
+    for (size_t i = 0U; i < sizeof(back); ++i) {
+        zassert_equal(back[i], 0xFFU, "rotation left the summary unit programmed");
+    }
+}
+
 ZTEST(flash_log_writer, test_marker_flash_write_failure)
 {
     const uint16_t dive_number = 41U;
@@ -1166,7 +1203,7 @@ ZTEST(flash_log_writer, test_batch_append_hard_failure_drops_batch)
     (void)k_msleep(SETTLE_FLUSH_MS);
 
     zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_ERROR_EVENT), 0U);
-    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH), 0U);
+    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH_PACKED), 0U);
 }
 
 ZTEST(flash_log_writer, test_batch_header_write_failure)
@@ -1226,10 +1263,45 @@ ZTEST(flash_log_writer, test_batch_buffer_overflow_forces_early_flush)
 
     zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_CONSENSUS),
                   bulk_count, "every record must survive the early flush");
-    zassert_true(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH) >= 2U,
+    zassert_true(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH_PACKED) >= 2U,
                  "overflow must split the records across >= 2 batches");
 }
 
+ZTEST(flash_log_writer, test_packed_batch_shrinks_consensus_stream)
+{
+    /* Steady-state consensus — the record that dominates the telemetry
+     * budget — must pack to under half of its legacy [fl_entry_hdr_t +
+     * payload] size: after the first record seeds the field deltas, each
+     * one costs a tag, a timestamp delta, a change mask and one field. */
+    const uint32_t record_count = 20U;
+    const uint16_t dive_number = 98U;
+    const size_t legacy_bytes = record_count *
+        (sizeof(fl_entry_hdr_t) + sizeof(fl_payload_consensus_t));
+    ConsensusMsg_t consensus = {0};
+    WalkQuery_t q = {0};
+
+    flash_log_enqueue_dive_marker(true, dive_number, 0U);
+    (void)k_msleep(SETTLE_MARKER_MS);
+
+    consensus.include_array[0] = true;
+    consensus.confidence = 3U;
+    for (uint32_t i = 0U; i < record_count; ++i) {
+        consensus.consensus_ppo2 = (PPO2_t)(100U + (i & 1U));
+        flash_log_enqueue_consensus(&consensus, 70U);
+        (void)k_msleep(BULK_ENQUEUE_GAP_MS);
+    }
+    (void)k_msleep(SETTLE_FLUSH_MS);
+
+    q.type = FL_TYPE_BATCH_PACKED;
+    wq_run(FL_DEST_TELEMETRY, &q);
+    zassert_equal(q.count, 1U, "one flush window, one container");
+    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_CONSENSUS),
+                  record_count, "every record must decode back out");
+    zassert_true(q.last_hdr.length < (legacy_bytes / 2U),
+                 "packed %u B vs legacy %u B",
+                 (unsigned)q.last_hdr.length, (unsigned)legacy_bytes);
+}
+
 ZTEST(flash_log_writer, test_batch_enospc_with_rotate_failure)
 {
     ErrorEvent_t event = {.code = OP_ERR_FLASH, .detail = 0x55U};
@@ -1242,7 +1314,7 @@ ZTEST(flash_log_writer, test_batch_enospc_with_rotate_failure)
     (void)k_msleep(SETTLE_FLUSH_MS);
 
     zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_ERROR_EVENT), 0U);
-    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH), 0U);
+    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH_PACKED), 0U);
 }
 
 ZTEST(flash_log_writer, test_mixed_flush_partitions_record_kinds)
@@ -1261,7 +1333,7 @@ ZTEST(flash_log_writer, test_mixed_flush_partitions_record_kinds)
     (void)k_msleep(SETTLE_MARKER_MS);
 
     zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_ERROR_EVENT), 1U);
-    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH), 1U);
+    zassert_equal(count_type(FL_DEST_TELEMETRY, FL_TYPE_BATCH_PACKED), 1U);
     zassert_equal(count_type(FL_DEST_TEXT, FL_TYPE_LOG_TEXT), 1U);
     zassert_equal(count_dive(FL_DEST_TELEMETRY, FL_TYPE_DIVE_START,
                              dive_number), 1U);
@@ -1290,3 +1362,60 @@ ZTEST(flash_log_writer, test_writer_recovers_from_overrun_deadline)
     zassert_equal(count_type(FL_DEST_TEXT, FL_TYPE_LOG_TEXT), 1U,
                   "record must flush right after the overrun");
 }
+
+/* ============================================================================
+ * Persistent per-sector summary
+ * ============================================================================ */
+
+ZTEST(flash_log_writer, test_sector_close_programs_summary_unit)
+{
+    /* A dive marker lands in the text ring's active sector, then text
+     * records push the ring into the next sector. Closing the first sector
+     * must program its summary into its summary unit, and the new active
+     * sector's (marker-free) summary must be served from the writer's RAM. */
+    const uint16_t dive_number = 77U;
+    static char msg[64];
+    const uint32_t max_puts = 200U;
+    struct fcb *text = flash_log_internal_get_fcb(FL_DEST_TEXT);
+
+    (void)memset(msg, 'S', sizeof(msg));
+    flash_log_enqueue_dive_marker(true, dive_number, 0U);
+    (void)k_msleep(SETTLE_MARKER_MS);
+
+    struct flash_sector *first = text->f_active.fe_sector;
+    FlashLogIndexEntry_t row = {0};
+
+    zassert_ok(flash_log_internal_active_summary(FL_DEST_TEXT, &row));
+    zassert_equal(row.first_dive_id, dive_number);
+    zassert_equal(row.flags, FL_INDEX_FLAG_HAS_DIVE_START);
+
+    for (uint32_t i = 0U; (i < max_puts) && (text->f_active.fe_sector == first);
+         ++i) {
+        flash_log_enqueue_text(2U, 9U, msg, sizeof(msg));
+        (void)k_msleep(SETTLE_MARKER_MS);
+    }
+    (void)k_msleep(SETTLE_FLUSH_MS);
+    zassert_not_equal(text->f_active.fe_sector, first,
+                      "text ring never left its first sector");
+
+    FlashLogSectorSummary_t unit = {0};
+    uint16_t id = 0U;
+
+    /* The FCB owns whole sectors; the unit sits in the area behind them. */
+    zassert_equal(first->fs_size, CONFIG_FLASH_LOG_SECTOR_SIZE);
+    zassert_true(flash_log_sector_live_id(text, first, &id));
+    zassert_ok(flash_area_read(text->fap,
+                               flash_log_sector_summary_off(text, first),
+                               &unit, sizeof(unit)));
+    zassert_true(flash_log_sector_summary_open(&unit, id, &row),
+                 "closed sector carries no valid summary unit");
+    zassert_equal(row.first_dive_id, dive_number);
+    zassert_equal(row.flags, FL_INDEX_FLAG_HAS_DIVE_START);
+    zassert_false(flash_log_sector_summary_open(&unit, (uint16_t)(id + 1U),
+                                                &row),
+                  "a unit must not validate against another lap's id");
+
+    zassert_ok(flash_log_internal_active_summary(FL_DEST_TEXT, &row));
+    zassert_equal(row.flags, 0U);
+    zassert_equal(row.first_dive_id, FL_INVALID_DIVE_ID);
+}
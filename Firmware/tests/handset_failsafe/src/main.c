@@ -5,7 +5,8 @@
  * Pure host build — no Zephyr threads or hardware. Tests
  * handset_failsafe_should_revert() from handset_failsafe.h, the time-triggered
  * decision the DiveCAN RX thread uses to revert the setpoint to 0.70 bar when
- * the handset stops pinging. Time is passed explicitly (like
+ * the handset stops pinging, and handset_failsafe_deadline(), which tells the
+ * thread when to wake for it. Time is passed explicitly (like
  * consensus_calculate()'s `now`/staleness) so no wall-clock waiting is needed.
  */
 
@@ -88,3 +89,31 @@ ZTEST(handset_failsafe, test_wraparound_long_gap_reverts)
     zassert_true(handset_failsafe_should_revert(now, last, true, false, T),
              "wrap with a long true gap must revert");
 }
+
+/* The RX thread sleeps until the deadline: it must be the first uptime at
+ * which the revert fires, including across the rollover. */
+ZTEST(handset_failsafe, test_deadline_is_first_revert)
+{
+    uint32_t lasts[] = {5000U, 0xFFFFFF00U};
+
+    for (size_t i = 0U; i < ARRAY_SIZE(lasts); ++i) {
+        uint32_t deadline = 0U;
+
+        zassert_true(handset_failsafe_deadline(lasts[i], true, false, T,
+                               &deadline));
+        zassert_false(handset_failsafe_should_revert(deadline - 1U, lasts[i],
+                                  true, false, T));
+        zassert_true(handset_failsafe_should_revert(deadline, lasts[i],
+                                 true, false, T));
+    }
+}
+
+/* Nothing to wait for before the first ping or once the fallback latched. */
+ZTEST(handset_failsafe, test_no_deadline_when_disarmed)
+{
+    uint32_t deadline = 0U;
+
+    zassert_false(handset_failsafe_deadline(5000U, false, false, T, &deadline));
+    zassert_false(handset_failsafe_deadline(5000U, true, true, T, &deadline));
+    zassert_equal(deadline, 0U);
+}
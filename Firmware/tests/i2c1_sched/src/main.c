@@ -0,0 +1,321 @@
+/**
+ * @file main.c
+ * @brief Native tests for the i2c1 transaction scheduler.
+ *
+ * The real scheduler thread and bus lock run against a GPIO-emulated i2c1 with
+ * both lines idle; transfers are scripted callbacks that log their order.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include "i2c1_sched.h"
+
+#define TEST_GPIO DEVICE_DT_GET(DT_NODELABEL(test_gpio))
+#define SCL_PIN 0U
+#define SDA_PIN 1U
+
+#define DEV_A 0x48U
+#define DEV_B 0x40U
+#define ORDER_MAX 16U
+#define SUBMITTER_STACK 1024
+#define SUBMITTER_PRIO K_PRIO_PREEMPT(1)
+
+struct probe {
+    uint8_t id;
+    Status_t results[4];
+    uint8_t result_count;
+    uint8_t calls;
+    int64_t first_start_ticks;
+};
+
+static uint8_t order[ORDER_MAX];
+static size_t order_count;
+
+K_SEM_DEFINE(gate_entered, 0, 1);
+K_SEM_DEFINE(gate_open, 0, 1);
+
+static Status_t probe_xfer(void *ctx)
+{
+    struct probe *p = ctx;
+    uint8_t index = p->calls;
+
+    if (p->calls == 0U) {
+        p->first_start_ticks = k_uptime_ticks();
+    }
+    ++p->calls;
+    if (order_count < ORDER_MAX) {
+        order[order_count] = p->id;
+        ++order_count;
+    }
+    if (index >= p->result_count) {
+        index = (p->result_count > 0U) ? (uint8_t)(p->result_count - 1U) : 0U;
+    }
+    return (p->result_count > 0U) ? p->results[index] : 0;
+}
+
+/* Holds the scheduler inside a transfer until gate_open is given. */
+static Status_t gate_xfer(void *ctx)
+{
+    k_sem_give(&gate_entered);
+    (void)k_sem_take(&gate_open, K_MSEC(1000));
+    return probe_xfer(ctx);
+}
+
+static Status_t nested_xfer(void *ctx)
+{
+    I2c1Txn_t inner = I2C1_TXN(probe_xfer, ctx, I2C1_CLIENT_TANK,
+                               I2C1_PRIO_BACKGROUND, I2C1_DEVICE_NONE,
+                               1U, 0U, 0U, 0U);
+
+    return i2c1_sched_run(&inner);
+}
+
+/* Runs one descriptor from its own thread, so several can be queued at once. */
+static void submitter(void *p1, void *p2, void *p3)
+{
+    I2c1Txn_t *txn = p1;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+    (void)i2c1_sched_run(txn);
+}
+
+K_THREAD_STACK_ARRAY_DEFINE(submit_stacks, 3, SUBMITTER_STACK);
+static struct k_thread submit_threads[3];
+
+static void submit_async(size_t slot, I2c1Txn_t *txn)
+{
+    (void)k_thread_create(&submit_threads[slot], submit_stacks[slot],
+                          K_THREAD_STACK_SIZEOF(submit_stacks[slot]),
+                          submitter, txn, NULL, NULL,
+                          SUBMITTER_PRIO, 0, K_NO_WAIT);
+}
+
+static void join(size_t slot)
+{
+    zassert_ok(k_thread_join(&submit_threads[slot], K_MSEC(2000)));
+}
+
+static void sched_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    zassert_ok(gpio_emul_input_set(TEST_GPIO, SCL_PIN, 1));
+    zassert_ok(gpio_emul_input_set(TEST_GPIO, SDA_PIN, 1));
+    (void)memset(order, 0, sizeof(order));
+    order_count = 0U;
+    k_sem_reset(&gate_entered);
+    k_sem_reset(&gate_open);
+    /* Let the cell slot guard lapse after the cell test. */
+    k_msleep(2 * CONFIG_I2C1_SCHED_CELL_SLOT_MS);
+}
+
+ZTEST_SUITE(i2c1_sched, NULL, NULL, sched_before, NULL, NULL);
+
+ZTEST(i2c1_sched, test_rejects_malformed_descriptors)
+{
+    struct probe p = { .id = 1U };
+    I2c1Txn_t ok = I2C1_TXN(probe_xfer, &p, I2C1_CLIENT_TANK,
+                            I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+    I2c1Txn_t bad = ok;
+
+    zassert_equal(i2c1_sched_run(NULL), -EINVAL);
+    zassert_equal(i2c1_sched_run_batch(&ok, 0U), -EINVAL);
+
+    bad.xfer = NULL;
+    zassert_equal(i2c1_sched_run(&bad), -EINVAL);
+    bad = ok;
+    bad.attempts = 0U;
+    zassert_equal(i2c1_sched_run(&bad), -EINVAL);
+    bad = ok;
+    bad.client = I2C1_CLIENT_COUNT;
+    zassert_equal(i2c1_sched_run(&bad), -EINVAL);
+
+    zassert_equal(p.calls, 0U);
+    zassert_ok(i2c1_sched_run(&ok));
+    zassert_equal(p.calls, 1U);
+}
+
+ZTEST(i2c1_sched, test_priority_then_fifo_order)
+{
+    struct probe gate = { .id = 1U };
+    struct probe background = { .id = 2U };
+    struct probe urgent = { .id = 3U };
+    I2c1Txn_t t_gate = I2C1_TXN(gate_xfer, &gate, I2C1_CLIENT_TANK,
+                                I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+    I2c1Txn_t t_background = I2C1_TXN(probe_xfer, &background, I2C1_CLIENT_TANK,
+                                      I2C1_PRIO_BACKGROUND, DEV_B, 1U, 0U, 0U, 0U);
+    I2c1Txn_t t_urgent = I2C1_TXN(probe_xfer, &urgent, I2C1_CLIENT_POSEIDON,
+                                  I2C1_PRIO_URGENT, DEV_B, 1U, 0U, 0U, 0U);
+
+    submit_async(0U, &t_gate);
+    zassert_ok(k_sem_take(&gate_entered, K_MSEC(500)));
+    /* Queued while the gate holds the bus: background first, urgent second. */
+    submit_async(1U, &t_background);
+    submit_async(2U, &t_urgent);
+    k_msleep(1);
+    k_sem_give(&gate_open);
+    join(0U);
+    join(1U);
+    join(2U);
+
+    zassert_equal(order_count, 3U);
+    zassert_equal(order[0], 1U);
+    zassert_equal(order[1], 3U, "urgent must overtake the earlier background");
+    zassert_equal(order[2], 2U);
+    zassert_ok(t_urgent.result);
+    zassert_ok(t_background.result);
+}
+
+ZTEST(i2c1_sched, test_batch_is_ordered_and_merged)
+{
+    struct probe p[3] = { { .id = 1U },
+                          { .id = 2U, .results = { -ENODEV }, .result_count = 1U },
+                          { .id = 3U } };
+    I2c1Txn_t txns[3];
+    I2c1ClientStats_t before;
+    I2c1ClientStats_t after;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(txns); ++i) {
+        txns[i] = (I2c1Txn_t)I2C1_TXN(probe_xfer, &p[i], I2C1_CLIENT_POSEIDON,
+                                      I2C1_PRIO_ACCESSORY, DEV_B, 3U, 0U, 0U, 0U);
+    }
+    /* A hard error ends the hold, so only the second member rides the first
+     * one's hold. */
+    i2c1_sched_stats(I2C1_CLIENT_POSEIDON, &before);
+    zassert_equal(i2c1_sched_run_batch(txns, ARRAY_SIZE(txns)), -ENODEV);
+    i2c1_sched_stats(I2C1_CLIENT_POSEIDON, &after);
+
+    zassert_equal(order_count, 3U);
+    zassert_equal(order[0], 1U);
+    zassert_equal(order[1], 2U);
+    zassert_equal(order[2], 3U);
+    zassert_equal(p[1].calls, 1U, "a hard error is not retried");
+    zassert_ok(txns[0].result);
+    zassert_equal(txns[1].result, -ENODEV);
+    zassert_ok(txns[2].result, "later members still run");
+    zassert_equal(after.txns - before.txns, 3U);
+    zassert_equal(after.failed - before.failed, 1U);
+    zassert_equal(after.merged - before.merged, 1U);
+}
+
+ZTEST(i2c1_sched, test_retry_backoff_does_not_hold_the_bus)
+{
+    struct probe retrying = { .id = 1U, .results = { -EAGAIN, 0 },
+                              .result_count = 2U };
+    struct probe other = { .id = 2U };
+    I2c1Txn_t t_retry = I2C1_TXN(probe_xfer, &retrying, I2C1_CLIENT_POSEIDON,
+                                 I2C1_PRIO_ACCESSORY, DEV_B, 3U, 100U, 0U, 0U);
+    I2c1Txn_t t_other = I2C1_TXN(probe_xfer, &other, I2C1_CLIENT_TANK,
+                                 I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+    I2c1ClientStats_t before;
+    I2c1ClientStats_t after;
+
+    i2c1_sched_stats(I2C1_CLIENT_POSEIDON, &before);
+    submit_async(0U, &t_retry);
+    k_msleep(20);
+    zassert_equal(retrying.calls, 1U);
+
+    /* The first frame is sitting out its 100 ms backoff; the bus is free. */
+    int64_t started = k_uptime_get();
+
+    zassert_ok(i2c1_sched_run(&t_other));
+    zassert_true((k_uptime_get() - started) < 50,
+                 "waited out another client's backoff");
+    zassert_equal(retrying.calls, 1U);
+
+    join(0U);
+    zassert_ok(t_retry.result);
+    zassert_equal(retrying.calls, 2U);
+    i2c1_sched_stats(I2C1_CLIENT_POSEIDON, &after);
+    zassert_equal(after.retries - before.retries, 1U);
+}
+
+ZTEST(i2c1_sched, test_expired_descriptor_is_dropped)
+{
+    struct probe gate = { .id = 1U };
+    struct probe late = { .id = 2U };
+    I2c1Txn_t t_gate = I2C1_TXN(gate_xfer, &gate, I2C1_CLIENT_TANK,
+                                I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+    I2c1Txn_t t_late = I2C1_TXN(probe_xfer, &late, I2C1_CLIENT_POSEIDON,
+                                I2C1_PRIO_URGENT, DEV_B, 1U, 0U, 0U, 5U);
+    I2c1ClientStats_t before;
+    I2c1ClientStats_t after;
+
+    i2c1_sched_stats(I2C1_CLIENT_POSEIDON, &before);
+    submit_async(0U, &t_gate);
+    zassert_ok(k_sem_take(&gate_entered, K_MSEC(500)));
+    submit_async(1U, &t_late);
+    k_msleep(20);
+    k_sem_give(&gate_open);
+    join(0U);
+    join(1U);
+    i2c1_sched_stats(I2C1_CLIENT_POSEIDON, &after);
+
+    zassert_equal(t_late.result, -ETIMEDOUT);
+    zassert_equal(late.calls, 0U, "an expired frame must never be sent");
+    zassert_equal(after.expired - before.expired, 1U);
+    zassert_equal(after.failed - before.failed, 1U);
+}
+
+ZTEST(i2c1_sched, test_xfer_cannot_resubmit)
+{
+    struct probe inner = { .id = 2U };
+    I2c1Txn_t txn = I2C1_TXN(nested_xfer, &inner, I2C1_CLIENT_TANK,
+                             I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+
+    zassert_equal(i2c1_sched_run(&txn), -EDEADLK);
+    zassert_equal(inner.calls, 0U);
+}
+
+ZTEST(i2c1_sched, test_cell_window_holds_back_other_clients)
+{
+    int64_t slot = k_ms_to_ticks_ceil64(CONFIG_I2C1_SCHED_CELL_SLOT_MS);
+    int64_t window = k_ms_to_ticks_ceil64(CONFIG_I2C1_SCHED_CELL_WINDOW_MS);
+    struct probe cell = { .id = 1U };
+    struct probe tank = { .id = 2U };
+    I2c1Txn_t t_cell = I2C1_TXN(probe_xfer, &cell, I2C1_CLIENT_CELL,
+                                I2C1_PRIO_CELL, DEV_A, 1U, 0U, 0U, 0U);
+    I2c1Txn_t t_tank = I2C1_TXN(probe_xfer, &tank, I2C1_CLIENT_TANK,
+                                I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+
+    (void)k_sleep(i2c1_sched_next_cell_slot());
+    zassert_ok(i2c1_sched_run(&t_cell));
+    zassert_true((cell.first_start_ticks % slot) < window,
+                 "the cell read belongs in the window");
+
+    /* Submitted inside the window while cells are active. */
+    zassert_ok(i2c1_sched_run(&t_tank));
+    zassert_true((tank.first_start_ticks % slot) >= window,
+                 "tank read started %lld ticks into the reserved window",
+                 (long long)(tank.first_start_ticks % slot));
+}
+
+ZTEST(i2c1_sched, test_serialised_stats_layout)
+{
+    uint8_t buf[I2C1_SCHED_STATS_BYTES + 1U];
+    struct probe p = { .id = 1U };
+    I2c1Txn_t txn = I2C1_TXN(probe_xfer, &p, I2C1_CLIENT_TANK,
+                             I2C1_PRIO_BACKGROUND, DEV_A, 1U, 0U, 0U, 0U);
+    I2c1ClientStats_t tank;
+
+    zassert_ok(i2c1_sched_run(&txn));
+    zassert_equal(i2c1_sched_serialise(buf, I2C1_SCHED_STATS_BYTES - 1U), 0U);
+    zassert_equal(i2c1_sched_serialise(NULL, sizeof(buf)), 0U);
+    zassert_equal(i2c1_sched_serialise(buf, sizeof(buf)), I2C1_SCHED_STATS_BYTES);
+
+    i2c1_sched_stats(I2C1_CLIENT_TANK, &tank);
+    zassert_equal(buf[0], I2C1_SCHED_STATS_VERSION);
+    zassert_equal(buf[1], I2C1_CLIENT_COUNT);
+
+    const uint8_t *rec = &buf[2U + (I2C1_CLIENT_TANK * I2C1_SCHED_CLIENT_BYTES)];
+    uint32_t txns = sys_get_le32(rec);
+
+    zassert_equal(txns, tank.txns);
+    zassert_true(txns >= 1U);
+    zassert_equal(sys_get_le16(&rec[20]), tank.occupancy_permille);
+}
@@ -54,7 +54,7 @@ DID_LOG_CAN_VERBOSE: Final[int] = 0xF284
 FL_DEST_TELEMETRY: Final[int] = 0
 FL_DEST_TEXT: Final[int] = 1
 FL_TYPE_BOOT_MARKER: Final[int] = 0x01
-FL_TYPE_BATCH: Final[int] = 0xFD
+FL_TYPE_BATCH_PACKED: Final[int] = 0xFC
 
 NRC_INCORRECT_MSG_LEN: Final[int] = 0x13
 NRC_BUSY_REPEAT_REQUEST: Final[int] = 0x21
@@ -258,7 +258,7 @@ def test_latest_boot_round_trip_contains_writer_output(dut) -> None:
     stream = _download_selected(can_bus)
     types = _top_level_types(stream)
     assert FL_TYPE_BOOT_MARKER in types
-    assert FL_TYPE_BATCH in types
+    assert FL_TYPE_BATCH_PACKED in types
 
 
 def test_select_all_walk_free_round_trip(dut) -> None:
@@ -275,7 +275,21 @@ def test_select_all_walk_free_round_trip(dut) -> None:
     stream = _download_selected(can_bus)
     types = _top_level_types(stream)
     assert FL_TYPE_BOOT_MARKER in types
-    assert FL_TYPE_BATCH in types
+    assert FL_TYPE_BATCH_PACKED in types
+
+
+def test_extended_length_blocks_round_trip(dut) -> None:
+    can_bus, shim = dut
+    helpers.sim_sleep(shim, 3.0)
+
+    # A direct-CAN client asking for more than one standard ISO-TP message
+    # gets extended-length 0x36 blocks (12-bit First Frame length).
+    _routine(can_bus, RID_SELECT_ALL, bytes([FL_DEST_TELEMETRY]))
+    _expect_positive(can_bus, SID_ROUTINE_CONTROL)
+    stream = _download_selected(can_bus, requested_block=2048)
+    types = _top_level_types(stream)
+    assert FL_TYPE_BOOT_MARKER in types
+    assert FL_TYPE_BATCH_PACKED in types
 
 
 def test_latest_and_specific_dive_round_trip(dut) -> None:
@@ -0,0 +1,135 @@
+"""Latency budgets of the sample → fire control chain (DIDs 0xF216/0xF217).
+
+The firmware traces every cell sample through the vote, the PID update and
+the inject solenoid (``Firmware/include/latency_trace.h``) and serves the
+per-stage histograms on DID 0xF216. These tests drive the loop below
+setpoint so it fires, then hold each stage to a budget:
+
+  * sample → consensus: the vote runs on every cell publish, so only
+    scheduling delay is allowed.
+  * consensus → control and sample → control: at most one PID period late.
+  * sample → fire: the newest sample at the last PID update before the
+    inject opens, so bounded by a cell sample period plus one PID period.
+
+Budgets are on simulated time; generous enough for the native_sim
+scheduler, tight enough to catch a reintroduced polling timer.
+"""
+
+from __future__ import annotations
+
+import struct
+
+import pytest
+
+import helpers
+import uds as uds_helpers
+
+pytestmark = pytest.mark.rt_ratio(100)
+
+
+# --- DIDs (mirror src/divecan/include/uds_state_did.h) ----------------------
+DID_LATENCY_TRACE = 0xF216
+DID_LATENCY_TRACE_CLEAR = 0xF217
+
+UDS_SID_READ_DATA_BY_ID = 0x22
+UDS_SID_WRITE_DATA_BY_ID = 0x2E
+UDS_POSITIVE_RESPONSE_OFFSET = 0x40
+
+# --- Summary layout (mirror include/latency_trace.h) ------------------------
+LATENCY_SUMMARY_VERSION = 1
+STAGE_SAMPLE_TO_CONSENSUS = 0
+STAGE_CONSENSUS_TO_CONTROL = 1
+STAGE_SAMPLE_TO_CONTROL = 2
+STAGE_SAMPLE_TO_FIRE = 3
+STAGE_COUNT = 4
+_STAGE = struct.Struct("<IIIII")
+
+# --- Budgets (simulated µs) --------------------------------------------------
+PID_PERIOD_US = 100_000
+SAMPLE_TO_CONSENSUS_P99_US = 20_000
+CONTROL_MAX_US = PID_PERIOD_US + 50_000
+# The sample behind a fire is the newest one at the last PID update, so it
+# may also have aged by up to one cell sample period before the next arrived.
+SAMPLE_TO_FIRE_MAX_US = 1_000_000
+
+# Two 5 s PWM cycles plus margin, so at least one inject fire is traced.
+TRACE_WINDOW_S: float = 12.0
+
+
+def _read_did(can_bus, did: int) -> bytes:
+    """RDBI 0x22 → return the data bytes after pad + response SID + echoed DID."""
+    uds_helpers.send_isotp_payload(
+        can_bus,
+        bytes([0x00, UDS_SID_READ_DATA_BY_ID, (did >> 8) & 0xFF, did & 0xFF]))
+    payload = uds_helpers.reassemble_isotp(can_bus)
+    assert payload[1] == UDS_SID_READ_DATA_BY_ID + UDS_POSITIVE_RESPONSE_OFFSET, (
+        f"expected RDBI positive resp, got 0x{payload[1]:02X}: {payload.hex()}")
+    assert ((payload[2] << 8) | payload[3]) == did
+    return bytes(payload[4:])
+
+
+def _read_stages(can_bus) -> list[dict[str, int]]:
+    data = _read_did(can_bus, DID_LATENCY_TRACE)
+    assert data[0] == LATENCY_SUMMARY_VERSION, f"version {data[0]}"
+    assert data[1] == STAGE_COUNT, f"stage count {data[1]}"
+    assert len(data) == 2 + STAGE_COUNT * _STAGE.size, f"length {len(data)}"
+    stages = []
+    for i in range(STAGE_COUNT):
+        count, lo, p50, p99, hi = _STAGE.unpack_from(data, 2 + i * _STAGE.size)
+        assert lo <= p50 <= p99 <= hi, f"stage {i} out of order"
+        stages.append({"count": count, "min": lo, "p50": p50, "p99": p99, "max": hi})
+    return stages
+
+
+def _clear(can_bus) -> None:
+    uds_helpers.send_isotp_payload(
+        can_bus,
+        bytes([0x00, UDS_SID_WRITE_DATA_BY_ID,
+               (DID_LATENCY_TRACE_CLEAR >> 8) & 0xFF,
+               DID_LATENCY_TRACE_CLEAR & 0xFF, 0x00]))
+    payload = uds_helpers.reassemble_isotp(can_bus)
+    assert payload[1] == UDS_SID_WRITE_DATA_BY_ID + UDS_POSITIVE_RESPONSE_OFFSET, (
+        f"expected WDBI positive resp: {payload.hex()}")
+
+
+def test_control_chain_meets_latency_budget(calibrated_dut) -> None:
+    """Below setpoint the loop fires; every stage stays inside its budget."""
+    can_bus, shim = calibrated_dut
+
+    helpers.configure_all_cells(shim, [30, 30, 30])
+    helpers.sim_sleep(shim, 1.0)
+    _clear(can_bus)
+    helpers.sim_sleep(shim, TRACE_WINDOW_S)
+
+    stages = _read_stages(can_bus)
+
+    for stage in (STAGE_SAMPLE_TO_CONSENSUS, STAGE_CONSENSUS_TO_CONTROL,
+                  STAGE_SAMPLE_TO_CONTROL, STAGE_SAMPLE_TO_FIRE):
+        assert stages[stage]["count"] > 0, f"stage {stage} never traced"
+
+    assert stages[STAGE_SAMPLE_TO_CONSENSUS]["p99"] <= SAMPLE_TO_CONSENSUS_P99_US, (
+        f"sample → consensus p99 {stages[STAGE_SAMPLE_TO_CONSENSUS]['p99']} µs")
+    assert stages[STAGE_CONSENSUS_TO_CONTROL]["max"] <= CONTROL_MAX_US, (
+        f"consensus → control max {stages[STAGE_CONSENSUS_TO_CONTROL]['max']} µs")
+    assert stages[STAGE_SAMPLE_TO_CONTROL]["max"] <= CONTROL_MAX_US, (
+        f"sample → control max {stages[STAGE_SAMPLE_TO_CONTROL]['max']} µs")
+    assert stages[STAGE_SAMPLE_TO_FIRE]["max"] <= SAMPLE_TO_FIRE_MAX_US, (
+        f"sample → fire max {stages[STAGE_SAMPLE_TO_FIRE]['max']} µs")
+
+
+def test_clear_resets_every_stage(calibrated_dut) -> None:
+    """0xF217 empties the histograms; the quiet loop does not refill the
+    fire stage while PPO2 sits above setpoint."""
+    can_bus, shim = calibrated_dut
+
+    helpers.configure_all_cells(shim, [200, 200, 200])
+    helpers.sim_sleep(shim, 1.0)
+    _clear(can_bus)
+
+    stages = _read_stages(can_bus)
+    assert stages[STAGE_SAMPLE_TO_FIRE]["count"] == 0
+
+    helpers.sim_sleep(shim, TRACE_WINDOW_S)
+    stages = _read_stages(can_bus)
+    assert stages[STAGE_SAMPLE_TO_CONSENSUS]["count"] > 0, "votes still traced"
+    assert stages[STAGE_SAMPLE_TO_FIRE]["count"] == 0, "no fire above setpoint"
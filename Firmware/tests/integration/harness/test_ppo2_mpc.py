@@ -0,0 +1,197 @@
+"""Integration tests for the model-predictive PPO2 control mode
+(``run_mpc_fire_cycle`` in src/ppo2_control.c, planner in
+src/ppo2_mpc_math.c).
+
+Like MK15, the mode is latched once by the solenoid-fire thread at init, so
+each test persists ``PPO2 Mode`` = MPC to NVS and relaunches the firmware
+before calibrating (the planner never fires on a PPO2_FAIL consensus).
+
+The closed-loop test wires the firmware to the two-compartment
+``RebreatherModel``: the inject solenoid state read back through the shim
+drives the model, and the model's lagged cell readings are injected as the
+cell inputs. The planner starts from its compiled-in plant model (the
+"typical" loop at shallow depth), so the selected profiles also exercise a
+mismatch between the modelled and the real plant. Assertions are on the
+outcome the mode exists for — reaching setpoint from below without the
+sensor-local overshoot — with margin over what the host simulation of the
+same planner shows, since the harness samples the solenoid at a coarser
+step than the firmware fires it.
+
+Flash isolation: the ``firmware`` fixture uses a per-test ``tmp_path`` flash
+(``flash_erase=True``), so persisting MPC here cannot leak into later tests.
+"""
+
+from __future__ import annotations
+
+import time
+
+import pytest
+
+import helpers
+import uds as uds_helpers
+from conftest import relaunch_native_sim_firmware, stop_native_sim_firmware
+from rebreather_model import LOOP_PROFILES, RebreatherModel
+from sim_shim import SharedMemShim
+
+# Slower than the other suites: the plant model is stepped from this process,
+# and each step must stay short relative to the planner's 0.1 s minimum pulse.
+RT_RATIO: float = 20.0
+
+# Integration solenoid map (see startup preamble):
+#   O2_inject=0  O2_inject_2=1  O2_flush=2  dil_flush=3
+INJECT_CHANNELS = (0, 1)
+
+SETPOINT_BAR = 0.70  # firmware default setpoint (DEFAULT_SETPOINT_CB)
+START_BAR = 0.50
+LOW_CELL_CB = 30  # 0.30 bar
+HIGH_CELL_CB = 90  # 0.90 bar
+
+# Sensor overshoot the planner may show over setpoint. PID shows 0.03-0.06
+# bar on these profiles in the host simulation; MPC stays under 0.02.
+MAX_OVERSHOOT_BAR = 0.04
+# Mean reading over the tail window must sit this close to setpoint.
+SETTLE_TOLERANCE_BAR = 0.03
+LOOP_SIM_S = 240.0
+TAIL_SIM_S = 60.0
+
+
+def _persist_mode_and_reboot(can_bus, shim, proc, mode: int):
+    """Persist ``PPO2 Mode`` = ``mode`` to NVS, reboot so the fire thread
+    latches it, and return the fresh ``(proc, shim)``."""
+    uds_helpers.save_setting_value(
+        can_bus, uds_helpers.SETTING_INDEX_PPO2_MODE, mode)
+    flash_path = getattr(proc, "_divecan_flash_file", None)
+    assert flash_path is not None, "firmware fixture must use isolated flash"
+
+    shim.close()
+    stop_native_sim_firmware(proc)
+    new_proc = relaunch_native_sim_firmware(flash_path, rt_ratio=RT_RATIO)
+    new_shim = SharedMemShim()
+    new_shim.wait_ready()
+    new_shim.set_bus_on()
+    return new_proc, new_shim
+
+
+def _inject(shim, reported_ppo2_bar) -> None:
+    bar_to_mv = 100.0 / 2.0  # 50 mV/bar per helpers.configure_cell
+    shim.set_cells(d1=reported_ppo2_bar[0], d2=reported_ppo2_bar[1],
+                   a3=reported_ppo2_bar[2] * bar_to_mv)
+
+
+def _count_inject_fires(shim, sim_window_s: float) -> int:
+    """Rising edges on either inject channel over ``sim_window_s``."""
+    start_us = shim.get_uptime_us()
+    window_us = int(sim_window_s * 1_000_000)
+    prev = [0, 0, 0, 0]
+    rising = 0
+    while (shim.get_uptime_us() - start_us) < window_us:
+        _now, sols = shim.get_state()
+        for ch in INJECT_CHANNELS:
+            if sols[ch] and not prev[ch]:
+                rising += 1
+        prev = sols
+        time.sleep(0.003)
+    return rising
+
+
+def _run_closed_loop(shim, model, sim_s: float):
+    """Step ``model`` against the firmware for ``sim_s`` of simulated time.
+
+    Returns ``(peak_bar, tail_mean_bar, inject_fires)`` over the mean of the
+    three reported cell readings.
+    """
+    start_us = shim.get_uptime_us()
+    last_us = start_us
+    prev_open = False
+    fires = 0
+    peak = 0.0
+    tail_sum = 0.0
+    tail_n = 0
+
+    while True:
+        now_us, sol_state = shim.get_state()
+        sim_rel = (now_us - start_us) / 1_000_000.0
+        if sim_rel >= sim_s:
+            break
+
+        dt_s = (now_us - last_us) / 1_000_000.0
+        last_us = now_us
+        solenoid = any(bool(sol_state[ch]) for ch in INJECT_CHANNELS)
+        if solenoid and not prev_open:
+            fires += 1
+        prev_open = solenoid
+        if dt_s > 0:
+            model.step(dt_s, solenoid_open=solenoid)
+        _inject(shim, model.reported_ppo2)
+
+        reading = sum(model.reported_ppo2) / len(model.reported_ppo2)
+        peak = max(peak, reading)
+        if sim_rel >= sim_s - TAIL_SIM_S:
+            tail_sum += reading
+            tail_n += 1
+
+        time.sleep(0.002)
+
+    assert tail_n > 0, "no samples in the tail window"
+    return peak, tail_sum / tail_n, fires
+
+
+@pytest.mark.rt_ratio(RT_RATIO)
+def test_mpc_fires_below_setpoint_and_holds_above(dut, firmware) -> None:
+    can_bus, shim = dut
+    proc = firmware
+    proc, shim = _persist_mode_and_reboot(
+        can_bus, shim, proc, uds_helpers.PPO2_MODE_MPC)
+    try:
+        helpers.calibrate_board(can_bus, shim)
+
+        helpers.configure_all_cells(shim, [LOW_CELL_CB] * 3)
+        helpers.sim_sleep(shim, 1.0)
+        low_fires = _count_inject_fires(shim, sim_window_s=20.0)
+        assert low_fires >= 2, (
+            f"expected repeated MPC inject pulses below setpoint, got "
+            f"{low_fires}")
+
+        # The inject solenoid can only add O2: above setpoint it must stay shut.
+        helpers.configure_all_cells(shim, [HIGH_CELL_CB] * 3)
+        helpers.sim_sleep(shim, 6.0)  # finish any pulse planned while low
+        high_fires = _count_inject_fires(shim, sim_window_s=20.0)
+        assert high_fires == 0, (
+            f"MPC fired {high_fires} times above setpoint")
+    finally:
+        shim.close()
+        stop_native_sim_firmware(proc)
+
+
+@pytest.mark.slow
+@pytest.mark.rt_ratio(RT_RATIO)
+@pytest.mark.parametrize(
+    "profile_name", ["typical_surface", "typical_shallow", "resting_shallow"])
+def test_mpc_reaches_setpoint_without_overshoot(
+        dut, firmware, profile_name: str) -> None:
+    can_bus, shim = dut
+    proc = firmware
+    proc, shim = _persist_mode_and_reboot(
+        can_bus, shim, proc, uds_helpers.PPO2_MODE_MPC)
+    try:
+        helpers.calibrate_board(can_bus, shim)
+        model = RebreatherModel(profile=LOOP_PROFILES[profile_name])
+        model._f_local = START_BAR / model.profile.ambient_pressure_bar
+        model._f_bulk = model._f_local
+        model._reported_ppo2 = [START_BAR] * 3
+        _inject(shim, model.reported_ppo2)
+        helpers.sim_sleep(shim, 0.5)
+
+        peak, tail_mean, fires = _run_closed_loop(shim, model, LOOP_SIM_S)
+        print(f"\n[mpc] {profile_name}: peak={peak:.3f} "
+              f"tail_mean={tail_mean:.3f} fires={fires}")
+
+        assert fires >= 3, f"expected the planner to dose, got {fires} fires"
+        assert peak <= SETPOINT_BAR + MAX_OVERSHOOT_BAR, (
+            f"{profile_name}: sensor overshoot to {peak:.3f} bar")
+        assert abs(tail_mean - SETPOINT_BAR) <= SETTLE_TOLERANCE_BAR, (
+            f"{profile_name}: settled at {tail_mean:.3f} bar, "
+            f"setpoint {SETPOINT_BAR:.2f}")
+    finally:
+        shim.close()
+        stop_native_sim_firmware(proc)
@@ -551,7 +551,7 @@ def test_wdbi_setting_value_roundtrip(dut) -> None:
     """Writing a setting value via UDS_DID_SETTING_VALUE_BASE+index and
     then reading it back returns the new value.
 
-    Setting index 1 is "PPO2 Mode" (maxValue 2 — Off/PID/MK15).  We
+    Setting index 1 is "PPO2 Mode" (maxValue 3 — Off/PID/MK15/MPC).  We
     write the value 2 (MK15) which is within range, then RDBI it back
     and verify the low byte matches.  Note that PPO2 mode is latched
     at init by ppo2_control, so the change doesn't affect the running
@@ -568,7 +568,7 @@ def test_wdbi_setting_value_roundtrip(dut) -> None:
     DID_SETTING_VALUE_BASE = 0x9130
     DID_SETTING_SAVE_BASE = 0x9350  # 0x9170 is option-label range, not save
 
-    setting_index = 1  # PPO2 Mode — editable, maxValue=2
+    setting_index = 1  # PPO2 Mode — editable, maxValue=3
     new_value = 2  # MK15
 
     # SettingValue wire format is 8-byte big-endian, low byte at offset 7.
@@ -94,7 +94,7 @@ def test_identification_dids(dut, did: int, min_length: int,
 
 @pytest.mark.parametrize(
     ("option", "expected"),
-    [(0, b"Off"), (1, b"PID"), (2, b"MK15")],
+    [(0, b"Off"), (1, b"PID"), (2, b"MK15"), (3, b"MPC")],
 )
 def test_ppo2_mode_option_labels_are_fixed_width(
     dut, option: int, expected: bytes
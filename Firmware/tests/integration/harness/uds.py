@@ -23,6 +23,7 @@ UDS_POSITIVE_RESPONSE_OFFSET: int = 0x40
 UDS_NEGATIVE_RESPONSE_SID: int = 0x7F
 UDS_NRC_INCORRECT_MSG_LEN: int = 0x13
 UDS_NRC_REQUEST_OUT_OF_RANGE: int = 0x31
+UDS_NRC_RESPONSE_PENDING: int = 0x78
 
 # ISO-TP PCI byte types — top nibble selects frame type.
 ISOTP_PCI_SINGLE_FRAME: int = 0x00
@@ -118,15 +119,32 @@ def send_isotp_payload(can_bus, payload: bytes) -> None:
         seq = (seq + 1) & 0x0F
 
 
+def _is_response_pending(payload: bytes) -> bool:
+    return (len(payload) == 4 and payload[0] == 0x00
+            and payload[1] == UDS_NEGATIVE_RESPONSE_SID
+            and payload[3] == UDS_NRC_RESPONSE_PENDING)
+
+
 def reassemble_isotp(can_bus, resp_id: int | None = None,
                      timeout: float = 2.0) -> bytes:
     """Block until a complete ISO-TP message arrives on ``resp_id``.
 
     Returns the UDS payload (PCI stripped, total length matches the
     FF's declared length).  Defaults to the menu response id.
+
+    NRC 0x78 responsePending is the head saying the request is still
+    being served: it is skipped and restarts the timeout, as a tester
+    would.
     """
     if resp_id is None:
         resp_id = menu_response_id()
+    while True:
+        payload = _reassemble_one(can_bus, resp_id, timeout)
+        if not _is_response_pending(payload):
+            return payload
+
+
+def _reassemble_one(can_bus, resp_id: int, timeout: float) -> bytes:
     deadline = time.monotonic() + timeout
 
     first = can_bus.wait_for(resp_id, timeout=timeout)
@@ -210,6 +228,7 @@ CAN_ID_OBOE: int = 1
 PPO2_MODE_OFF: int = 0
 PPO2_MODE_PID: int = 1
 PPO2_MODE_MK15: int = 2
+PPO2_MODE_MPC: int = 3
 
 
 def save_setting_value(can_bus, setting_index: int, value: int) -> None:
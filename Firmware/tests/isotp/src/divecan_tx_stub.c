@@ -17,9 +17,12 @@
  *   test_get_frame_count()     — number of frames captured so far
  *   test_get_frame(n)          — pointer to the n-th captured frame (0-based)
  *   test_get_last_frame()      — pointer to the most recently captured frame
+ *   test_set_tx_fifo_room(n)   — frames divecan_send_nowait() accepts before
+ *                                reporting a full FIFO (-1 = no limit)
  */
 
 #include <string.h>
+#include <errno.h>
 #include <stdint.h>
 #include "divecan_tx.h"
 #include "errors.h"
@@ -40,6 +43,7 @@ void op_error_publish(OpError_t code, uint32_t detail)
 
 static DiveCANMessage_t captured_frames[MAX_CAPTURED_FRAMES];
 static int frame_count;
+static int tx_fifo_room = -1;
 
 /**
  * @brief Clear the captured-frame buffer and reset the count to zero.
@@ -51,6 +55,17 @@ void test_reset_frames(void)
 {
     (void)memset(captured_frames, 0, sizeof(captured_frames));
     frame_count = 0;
+    tx_fifo_room = -1;
+}
+
+/**
+ * @brief Limit the frames divecan_send_nowait() accepts before it reports a
+ *        full FIFO.
+ * @param room Frames still accepted, or -1 for no limit (the default).
+ */
+void test_set_tx_fifo_room(int room)
+{
+    tx_fifo_room = room;
 }
 
 /**
@@ -136,3 +151,26 @@ int divecan_send_blocking(const DiveCANMessage_t *msg)
 {
     return divecan_send(msg);
 }
+
+/**
+ * @brief Stub for divecan_send_nowait() — captures the frame while the
+ *        simulated FIFO has room.
+ *
+ * Real impl: queues the frame only if the CAN TX FIFO has a free slot right
+ * now. Stub: test_set_tx_fifo_room() sets how many more frames fit.
+ *
+ * @param msg Frame the ISO-TP TX queue wanted to transmit.
+ * @return 0 once captured, -EAGAIN while the simulated FIFO is full.
+ */
+int divecan_send_nowait(const DiveCANMessage_t *msg)
+{
+    int result = -EAGAIN;
+
+    if (0 != tx_fifo_room) {
+        if (tx_fifo_room > 0) {
+            --tx_fifo_room;
+        }
+        result = divecan_send(msg);
+    }
+    return result;
+}
@@ -2,7 +2,7 @@
  * @file divecan_tx_stub.h
  * @brief Test inspection API for the divecan_tx_stub used by the isotp suite
  *
- * Declares the four functions that allow isotp tests to query the frame
+ * Declares the functions that allow isotp tests to query the frame
  * capture buffer populated by divecan_tx_stub.c. Include this header in
  * test files instead of declaring the functions inline.
  */
@@ -27,4 +27,10 @@ const DiveCANMessage_t *test_get_frame(int index);
 /** @brief Return a pointer to the most recently captured frame, or NULL if none. */
 const DiveCANMessage_t *test_get_last_frame(void);
 
+/**
+ * @brief Frames divecan_send_nowait() accepts before reporting a full FIFO.
+ * @param room Frames still accepted, or -1 for no limit (reset before each test).
+ */
+void test_set_tx_fifo_room(int room);
+
 #endif
@@ -17,6 +17,7 @@
 
 #include "isotp.h"
 #include "isotp_tx_queue.h"
+#include "isotp_link.h"
 #include "divecan_tx_stub.h"
 
 #define SRC DIVECAN_SOLO
@@ -64,6 +65,7 @@ static void isotp_before(void *fixture)
     ARG_UNUSED(fixture);
     test_reset_frames();
     ISOTP_TxQueue_Init();
+    ISOTP_Link_Init();
     ISOTP_Init(&ctx, SRC, TGT, MSG_ID);
 }
 
@@ -71,6 +73,8 @@ static void isotp_before(void *fixture)
 ZTEST_SUITE(isotp_rx, NULL, isotp_setup, isotp_before, NULL, NULL);
 /** @brief Suite: ISO-TP transmit path — SF/FF/CF generation, FC handling, queue serialization. */
 ZTEST_SUITE(isotp_tx, NULL, isotp_setup, isotp_before, NULL, NULL);
+/** @brief Suite: per-peer link quality — FC pacing, block caps, stats DID. */
+ZTEST_SUITE(isotp_link, NULL, isotp_setup, isotp_before, NULL, NULL);
 
 /** @brief A valid 3-byte SF is accepted, rx_complete is set, and bytes are copied to rx_buffer. */
 ZTEST(isotp_rx, test_sf_basic)
@@ -305,6 +309,24 @@ ZTEST(isotp_rx, test_ncr_no_timeout_within_window)
     zassert_equal(ctx.state, ISOTP_RECEIVING);
 }
 
+/** @brief The reported N_Cr deadline is the first poll time that times the reception out. */
+ZTEST(isotp_rx, test_ncr_deadline_matches_timeout)
+{
+    uint32_t deadline = 0U;
+    zassert_false(ISOTP_NextDeadline(&ctx, &deadline));
+
+    uint8_t ff_data[] = {0x10, 14, 1, 2, 3, 4, 5, 6};
+    DiveCANMessage_t ff = make_msg(TGT, SRC, ff_data, 8);
+    (void)ISOTP_ProcessRxFrame(&ctx, &ff);
+    zassert_true(ISOTP_NextDeadline(&ctx, &deadline));
+
+    ISOTP_Poll(&ctx, deadline - 1U);
+    zassert_equal(ctx.state, ISOTP_RECEIVING);
+    ISOTP_Poll(&ctx, deadline);
+    zassert_equal(ctx.state, ISOTP_IDLE);
+    zassert_false(ISOTP_NextDeadline(&ctx, &deadline));
+}
+
 /** @brief A 4-byte payload is sent as a DiveCAN SF: PCI byte includes padding length, byte[1]=0x00. */
 ZTEST(isotp_tx, test_sf_with_padding)
 {
@@ -551,6 +573,64 @@ ZTEST(isotp_tx, test_broadcast_does_not_stall_dialog)
     zassert_false(ISOTP_TxQueue_IsBusy());
 }
 
+/**
+ * @brief A broadcast whose CFs find the CAN TX FIFO full does not wait for
+ *        room: it carries on from later polls, and a reply queued behind it
+ *        follows once it is done.
+ */
+ZTEST(isotp_tx, test_broadcast_resumes_when_fifo_frees)
+{
+    make_broadcast_ctx();
+
+    /* 26 bytes: FF carries 5, then CFs of 7, 7 and 7. */
+    uint8_t payload[26];
+    for (uint8_t i = 0U; i < sizeof(payload); ++i) {
+        payload[i] = i;
+    }
+    zassert_true(ISOTP_Send(&ctx, payload, sizeof(payload)));
+
+    test_set_tx_fifo_room(1);
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 2, "FF and the one CF that fitted");
+    zassert_true(ISOTP_TxQueue_IsBusy());
+
+    uint32_t deadline = 0U;
+    zassert_true(ISOTP_TxQueue_NextDeadline(&deadline), "retry is scheduled");
+
+    uint8_t reply[] = {0xAAU};
+    zassert_true(ISOTP_TxQueue_Enqueue(SRC, TGT, MSG_ID, reply, sizeof(reply)));
+
+    test_set_tx_fifo_room(-1);
+    k_msleep((int32_t)(deadline - k_uptime_get_32()));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 4);
+    zassert_equal(test_get_frame(2)->data[0], 0x22, "sequence carries on");
+    zassert_equal(test_get_last_frame()->data[0], 0x23);
+    zassert_false(ISOTP_TxQueue_IsBusy());
+
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_true(captured_sf_to((uint8_t)TGT, 0xAA));
+}
+
+/** @brief A broadcast that gets no CF out for N_Bs is dropped. */
+ZTEST(isotp_tx, test_broadcast_dropped_when_fifo_stays_full)
+{
+    make_broadcast_ctx();
+
+    uint8_t payload[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    zassert_true(ISOTP_Send(&ctx, payload, sizeof(payload)));
+
+    test_set_tx_fifo_room(0);
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 1, "only the FF");
+    zassert_true(ISOTP_TxQueue_IsBusy());
+
+    k_msleep(ISOTP_TIMEOUT_N_BS + 1U);
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_false(ISOTP_TxQueue_IsBusy());
+    zassert_equal(test_get_frame_count(), 1);
+}
+
 /**
  * @brief Regression guard: ADDRESSED multi-frame transfers must still honour Flow Control.
  *
@@ -735,6 +815,48 @@ ZTEST(isotp_tx, test_flow_control_stmin_is_honoured)
     zassert_equal(test_get_frame_count(), 2);
 }
 
+/**
+ * @brief Under STmin one CF goes out per elapsed STmin, from later polls,
+ *        and the queue reports when the next one is due.
+ */
+ZTEST(isotp_tx, test_stmin_paces_cfs_from_polls)
+{
+    uint8_t payload[20];
+    for (uint8_t i = 0U; i < sizeof(payload); ++i) {
+        payload[i] = i;
+    }
+    zassert_true(ISOTP_Send(&ctx, payload, sizeof(payload)));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+
+    uint32_t deadline = 0U;
+    zassert_true(ISOTP_TxQueue_NextDeadline(&deadline));  /* N_Bs */
+
+    /* 20 bytes: FF carries 5, then 3 CFs. The first CF follows the FC. */
+    uint8_t fc_data[] = {ISOTP_FC_CTS, 0U, 20U};
+    DiveCANMessage_t fc = make_msg(TGT, SRC, fc_data, sizeof(fc_data));
+    zassert_true(ISOTP_TxQueue_ProcessFC(&fc));
+    zassert_equal(test_get_frame_count(), 2);
+    zassert_true(ISOTP_TxQueue_IsBusy());
+    zassert_true(ISOTP_TxQueue_NextDeadline(&deadline));
+
+    /* Not yet due: nothing sent. */
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 2);
+
+    k_msleep((int32_t)(deadline - k_uptime_get_32()));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 3);
+    zassert_equal(test_get_last_frame()->data[0], 0x22);
+
+    zassert_true(ISOTP_TxQueue_NextDeadline(&deadline));
+    k_msleep((int32_t)(deadline - k_uptime_get_32()));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 4);
+    zassert_equal(test_get_last_frame()->data[0], 0x23);
+    zassert_false(ISOTP_TxQueue_IsBusy());
+    zassert_false(ISOTP_TxQueue_NextDeadline(&deadline));
+}
+
 ZTEST(isotp_tx, test_queue_full_is_reported_while_transfer_active)
 {
     uint8_t long_payload[] = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U};
@@ -772,3 +894,288 @@ ZTEST(isotp_tx, test_queue_full_recovers_after_flow_control_timeout)
     zassert_false(ISOTP_TxQueue_IsBusy());
     zassert_equal(ISOTP_TxQueue_GetPendingCount(), ISOTP_TX_QUEUE_SIZE);
 }
+
+/** @brief A transfer whose last CF ends a BS block is complete — no FC wait. */
+ZTEST(isotp_tx, test_block_ending_on_last_cf_completes)
+{
+    /* 19 bytes: FF=5, then exactly 2 CFs of 7 */
+    uint8_t payload[19] = {0};
+    zassert_true(ISOTP_Send(&ctx, payload, sizeof(payload)));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+
+    uint8_t fc_data[] = {ISOTP_FC_CTS, 2U, 0U};
+    DiveCANMessage_t fc = make_msg(TGT, SRC, fc_data, sizeof(fc_data));
+    zassert_true(ISOTP_TxQueue_ProcessFC(&fc));
+
+    zassert_equal(test_get_frame_count(), 3); /* FF + 2 CFs */
+    zassert_false(ISOTP_TxQueue_IsBusy());
+}
+
+/** @brief Feed one inbound frame from TGT to the context. */
+/** @brief An extended-length message goes out under a 12-bit FF length,
+ *         read straight from the caller's buffer. */
+ZTEST(isotp_tx, test_extended_length_send)
+{
+    static uint8_t payload[1000];
+    for (size_t i = 0U; i < sizeof(payload); ++i) {
+        payload[i] = (uint8_t)(i * 7U);
+    }
+
+    zassert_false(ISOTP_Send(&ctx, payload, sizeof(payload)),
+              "copied sends stay capped at ISOTP_MAX_PAYLOAD");
+    zassert_true(ISOTP_SendExternal(&ctx, payload, sizeof(payload)));
+    zassert_true(ISOTP_TxQueue_ExternalPending());
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+
+    /* FF length counts the pad byte: 1001 = 0x3E9 */
+    const DiveCANMessage_t *ff = test_get_frame(0);
+    zassert_not_null(ff);
+    zassert_equal(ff->data[0], ISOTP_PCI_FF | 0x03U);
+    zassert_equal(ff->data[1], 0xE9U);
+    zassert_mem_equal(&ff->data[3], payload, 5U);
+
+    /* 995 bytes after the FF = 143 CFs; pace them in blocks of 20 so each
+     * block fits the capture buffer. */
+    uint8_t fc_data[] = {ISOTP_FC_CTS, 20U, 0U};
+    DiveCANMessage_t fc = make_msg(TGT, SRC, fc_data, sizeof(fc_data));
+    size_t offset = 5U;
+    uint8_t seq = 1U;
+    while (ISOTP_TxQueue_IsBusy()) {
+        test_reset_frames();
+        zassert_true(ISOTP_TxQueue_ProcessFC(&fc));
+        for (int i = 0; i < test_get_frame_count(); ++i) {
+            const DiveCANMessage_t *cf = test_get_frame(i);
+            size_t n = sizeof(payload) - offset;
+            if (n > ISOTP_CF_DATA_BYTES) {
+                n = ISOTP_CF_DATA_BYTES;
+            }
+            zassert_equal(cf->data[0], ISOTP_PCI_CF | seq);
+            zassert_mem_equal(&cf->data[1], &payload[offset], n);
+            offset += n;
+            seq = (seq + 1U) & ISOTP_SEQ_MASK;
+        }
+    }
+    zassert_equal(offset, sizeof(payload));
+    zassert_false(ISOTP_TxQueue_ExternalPending(),
+              "buffer is released once the last CF is out");
+
+    zassert_false(ISOTP_SendExternal(&ctx, payload, ISOTP_EXT_MAX_PAYLOAD + 1U));
+    zassert_false(ISOTP_SendExternal(&ctx, NULL, 10U));
+}
+
+/** @brief A reply goes to its recorded peer, whatever the context does since. */
+ZTEST(isotp_tx, test_reply_keeps_its_addressing)
+{
+    uint8_t payload[] = {0x6EU, 0xF2U, 0x40U};
+    ISOTPReply_t to = { .source = SRC, .target = TGT, .message_id = MSG_ID };
+
+    ctx.target = DIVECAN_MONITOR;
+    zassert_true(ISOTP_Reply(&to, payload, sizeof(payload)));
+    zassert_true(to.tx_complete);
+    zassert_false(ctx.tx_complete, "the context is not the one answered");
+
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 1);
+    zassert_equal(test_get_last_frame()->id,
+              MSG_ID | ((uint32_t)TGT << 8) | (uint32_t)SRC);
+
+    zassert_false(ISOTP_Reply(&to, payload, 0U));
+    zassert_false(ISOTP_Reply(NULL, payload, sizeof(payload)));
+    zassert_false(ISOTP_ReplyExternal(&to, NULL, 10U));
+}
+
+/** @brief Aborting external sends frees the buffer but keeps copied replies. */
+ZTEST(isotp_tx, test_abort_external_keeps_copied_messages)
+{
+    static uint8_t big[600];
+    uint8_t reply[] = {0xAAU};
+
+    zassert_true(ISOTP_SendExternal(&ctx, big, sizeof(big)));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_true(ISOTP_TxQueue_IsBusy());
+    zassert_true(ISOTP_SendExternal(&ctx, big, sizeof(big)));
+    zassert_true(ISOTP_Send(&ctx, reply, sizeof(reply)));
+
+    ISOTP_TxQueue_AbortExternal();
+    zassert_false(ISOTP_TxQueue_ExternalPending());
+    zassert_false(ISOTP_TxQueue_IsBusy());
+    zassert_equal(ISOTP_TxQueue_GetPendingCount(), 1U);
+
+    test_reset_frames();
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_equal(test_get_frame_count(), 1);
+    zassert_equal(test_get_frame(0)->data[2], 0xAAU);
+}
+
+/** @brief A reaped transfer makes room for the NEW request, not a replay. */
+ZTEST(isotp_tx, test_queue_reap_enqueues_the_new_request)
+{
+    uint8_t long_payload[] = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U};
+    uint8_t first[] = {0x11U};
+    uint8_t second[] = {0x22U};
+    uint8_t third[] = {0x33U};
+
+    zassert_true(ISOTP_Send(&ctx, long_payload, sizeof(long_payload)));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    zassert_true(ISOTP_TxQueue_Enqueue(SRC, TGT, MSG_ID, first, 1U));
+    zassert_true(ISOTP_TxQueue_Enqueue(SRC, TGT, MSG_ID, second, 1U));
+
+    k_msleep(ISOTP_TIMEOUT_N_BS + 1U);
+    test_reset_frames();
+    zassert_true(ISOTP_TxQueue_Enqueue(SRC, TGT, MSG_ID, third, 1U));
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+    ISOTP_TxQueue_Poll(k_uptime_get_32());
+
+    zassert_equal(test_get_frame_count(), 3);
+    zassert_equal(test_get_frame(0)->data[2], 0x11U);
+    zassert_equal(test_get_frame(1)->data[2], 0x22U);
+    zassert_equal(test_get_frame(2)->data[2], 0x33U);
+}
+
+static void rx_frame(const uint8_t *data, uint8_t len)
+{
+    DiveCANMessage_t m = make_msg(TGT, SRC, data, len);
+    (void)ISOTP_ProcessRxFrame(&ctx, &m);
+}
+
+/** @brief Receive a clean 10-byte FF+CF transfer from TGT. */
+static void rx_clean_transfer(void)
+{
+    uint8_t ff[] = {0x10, 10, 1, 2, 3, 4, 5, 6};
+    uint8_t cf[] = {0x21, 7, 8, 9, 10};
+
+    rx_frame(ff, sizeof(ff));
+    rx_frame(cf, sizeof(cf));
+    zassert_true(ctx.rx_complete);
+    ctx.rx_complete = false;
+}
+
+/** @brief An N_Cr timeout slows the FC we advertise, and BS is then enforced. */
+ZTEST(isotp_link, test_rx_timeout_slows_advertised_flow_control)
+{
+    uint8_t ff_short[] = {0x10, 14, 1, 2, 3, 4, 5, 6};
+    rx_frame(ff_short, sizeof(ff_short));
+    zassert_equal(test_get_frame(0)->data[ISOTP_FC_BS_IDX], ISOTP_DEFAULT_BLOCK_SIZE);
+    zassert_equal(test_get_frame(0)->data[ISOTP_FC_STMIN_IDX], ISOTP_DEFAULT_STMIN);
+    ISOTP_Poll(&ctx, ctx.rx_last_frame_time + ISOTP_TIMEOUT_N_CR + 1U);
+
+    /* 200 bytes: FF=6, then 28 CFs — more than one 16-CF block. */
+    test_reset_frames();
+    uint8_t ff_long[] = {0x10, 200, 1, 2, 3, 4, 5, 6};
+    rx_frame(ff_long, sizeof(ff_long));
+    zassert_equal(test_get_frame_count(), 1);
+    zassert_equal(test_get_frame(0)->data[ISOTP_FC_STATUS_IDX], ISOTP_FC_CTS);
+    zassert_equal(test_get_frame(0)->data[ISOTP_FC_BS_IDX], 16);
+    zassert_equal(test_get_frame(0)->data[ISOTP_FC_STMIN_IDX], 1);
+
+    uint8_t cf[8] = {0};
+    for (uint8_t i = 1U; i <= 16U; ++i) {
+        cf[0] = (uint8_t)(ISOTP_PCI_CF | (i & ISOTP_SEQ_MASK));
+        rx_frame(cf, sizeof(cf));
+        zassert_equal(test_get_frame_count(), (i < 16U) ? 1 : 2,
+                  "the next FC goes out exactly at the block boundary");
+    }
+    zassert_equal(test_get_frame(1)->data[ISOTP_FC_BS_IDX], 16);
+    zassert_equal(ctx.state, ISOTP_RECEIVING);
+}
+
+/** @brief A run of clean transfers after a fault climbs back to full speed. */
+ZTEST(isotp_link, test_clean_transfers_restore_full_speed)
+{
+    uint8_t ff[] = {0x10, 20, 1, 2, 3, 4, 5, 6};
+    uint8_t bad_cf[] = {0x22, 0, 0, 0, 0, 0, 0, 0};
+    rx_frame(ff, sizeof(ff));
+    rx_frame(bad_cf, sizeof(bad_cf));
+    zassert_equal(ctx.state, ISOTP_IDLE);
+
+    for (uint32_t i = 0U; i < ISOTP_LINK_PROMOTE_STREAK; ++i) {
+        test_reset_frames();
+        rx_clean_transfer();
+        zassert_equal(test_get_frame(0)->data[ISOTP_FC_BS_IDX], 16,
+                  "still one level down until the streak completes");
+    }
+
+    test_reset_frames();
+    rx_clean_transfer();
+    zassert_equal(test_get_frame(0)->data[ISOTP_FC_BS_IDX], ISOTP_DEFAULT_BLOCK_SIZE);
+}
+
+/** @brief FC refusals from the peer shrink the 0x36 block the UDS layer offers. */
+ZTEST(isotp_link, test_tx_refusals_shrink_uds_block)
+{
+    const uint16_t full = 253U;
+    uint8_t payload[10] = {0};
+    uint8_t ovflw_data[] = {ISOTP_FC_OVFLW, 0U, 0U};
+    DiveCANMessage_t ovflw = make_msg(TGT, SRC, ovflw_data, sizeof(ovflw_data));
+    ISOTPReply_t reply = { .source = SRC, .target = TGT, .message_id = MSG_ID };
+
+    zassert_equal(ISOTP_Link_BlockLimit(&reply, full), full);
+
+    for (int i = 0; i < 2; ++i) {
+        zassert_true(ISOTP_Send(&ctx, payload, sizeof(payload)));
+        ISOTP_TxQueue_Poll(k_uptime_get_32());
+        zassert_true(ISOTP_TxQueue_ProcessFC(&ovflw));
+    }
+    zassert_equal(ISOTP_Link_BlockLimit(&reply, full), 128);
+    zassert_equal(ISOTP_Link_BlockLimit(&reply, 100U), 100,
+              "never offers more than the service's own maximum");
+    zassert_equal(ISOTP_Link_BlockLimit(NULL, full), full);
+
+    ISOTPReply_t other = { .source = SRC, .target = DIVECAN_MONITOR, .message_id = MSG_ID };
+    zassert_equal(ISOTP_Link_BlockLimit(&other, full), full,
+              "other peers keep their own level");
+
+    for (int i = 0; i < 4; ++i) {
+        ISOTP_Link_NoteFault((uint8_t)TGT, ISOTP_LINK_FAULT_TX_TIMEOUT);
+    }
+    zassert_equal(ISOTP_Link_BlockLimit(&reply, full), 64, "bottom rung holds");
+}
+
+/** @brief DID 0xF290 layout: header, one record per peer, LE counters. */
+ZTEST(isotp_link, test_link_stats_layout)
+{
+    uint8_t buf[ISOTP_LINK_STATS_MAX_LEN];
+    uint8_t sf[] = {0x03, 0xAA, 0xBB, 0xCC};
+
+    zassert_equal(ISOTP_Link_FillStats(buf, sizeof(buf)), ISOTP_LINK_STATS_HDR_LEN);
+    zassert_equal(buf[1], 0);
+
+    rx_frame(sf, sizeof(sf));
+    rx_clean_transfer();
+    ISOTP_Link_NoteFault((uint8_t)TGT, ISOTP_LINK_FAULT_RX_TIMEOUT);
+
+    zassert_equal(ISOTP_Link_FillStats(buf, sizeof(buf) - 1U), 0);
+    zassert_equal(ISOTP_Link_FillStats(buf, sizeof(buf)),
+              ISOTP_LINK_STATS_HDR_LEN + ISOTP_LINK_STATS_PEER_LEN);
+
+    const uint8_t *rec = &buf[ISOTP_LINK_STATS_HDR_LEN];
+    zassert_equal(buf[0], ISOTP_LINK_STATS_VERSION);
+    zassert_equal(buf[1], 1);
+    zassert_equal(rec[0], (uint8_t)TGT);
+    zassert_equal(rec[1], 2);                 /* level */
+    zassert_equal(rec[2], 16);                /* BS */
+    zassert_equal(rec[3], 1);                 /* STmin */
+    zassert_equal(rec[4] | (rec[5] << 8), 192); /* block */
+    /* SF + FF + CF in, one FC out */
+    zassert_equal(rec[8] | (rec[9] << 8) | (rec[10] << 16) | (rec[11] << 24), 4);
+    zassert_equal(rec[12] | (rec[13] << 8), 1); /* rx_transfers */
+    zassert_equal(rec[14] | (rec[15] << 8), 1); /* rx_timeouts */
+    zassert_equal(rec[16] | (rec[17] << 8), 0); /* rx_seq_errors */
+}
+
+/** @brief frames/s covers the last closed 1 s window. */
+ZTEST(isotp_link, test_link_frame_rate_window)
+{
+    uint8_t buf[ISOTP_LINK_STATS_MAX_LEN];
+    uint8_t sf[] = {0x01, 0xAA};
+
+    for (int i = 0; i < 10; ++i) {
+        rx_frame(sf, sizeof(sf));
+    }
+    k_msleep(ISOTP_LINK_WINDOW_MS + 10U);
+    (void)ISOTP_Link_FillStats(buf, sizeof(buf));
+
+    const uint8_t *rec = &buf[ISOTP_LINK_STATS_HDR_LEN];
+    uint16_t rate = (uint16_t)(rec[6] | (rec[7] << 8));
+    zassert_true((rate >= 9U) && (rate <= 10U), "rate %u", rate);
+}
@@ -0,0 +1,193 @@
+/**
+ * @file main.c
+ * @brief Unit tests for the sample → fire latency histograms.
+ *
+ * Records synthetic latencies straight into latency_trace.c and reads them
+ * back through latency_trace_stats() and the serialised DID/flash-log
+ * summary. No producers, no flash log.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "latency_trace.h"
+
+#define STAGE       LATENCY_STAGE_SAMPLE_TO_CONTROL
+#define LAST_BUCKET ((uint8_t)(LATENCY_BUCKET_COUNT - 1U))
+#define STAGE_BYTES (5U * sizeof(uint32_t))
+
+static void trace_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    latency_trace_clear();
+}
+
+ZTEST_SUITE(latency_trace, NULL, NULL, trace_before, NULL, NULL);
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void record_n(LatencyStage_t stage, uint32_t us, uint32_t n)
+{
+    for (uint32_t i = 0U; i < n; ++i) {
+        latency_trace_record(stage, us);
+    }
+}
+
+ZTEST(latency_trace, test_bucket_edges)
+{
+    zassert_equal(latency_trace_bucket(0U), 0U);
+    zassert_equal(latency_trace_bucket(127U), 0U);
+    zassert_equal(latency_trace_bucket(128U), 1U);
+    zassert_equal(latency_trace_bucket(191U), 1U);
+    zassert_equal(latency_trace_bucket(192U), 2U);
+    zassert_equal(latency_trace_bucket(256U), 3U);
+    zassert_equal(latency_trace_bucket(UINT32_MAX), LAST_BUCKET,
+                  "huge latencies land in the open last bucket");
+
+    zassert_equal(latency_trace_bucket_upper_us(0U), 128U);
+    zassert_equal(latency_trace_bucket_upper_us(1U), 192U);
+    zassert_equal(latency_trace_bucket_upper_us(2U), 256U);
+    zassert_equal(latency_trace_bucket_upper_us(LAST_BUCKET), UINT32_MAX);
+
+    /* Every closed bucket's edge is the first value of the next bucket. */
+    for (uint8_t b = 0U; b < LAST_BUCKET; ++b) {
+        uint32_t upper = latency_trace_bucket_upper_us(b);
+
+        zassert_equal(latency_trace_bucket(upper - 1U), b, "bucket %u", b);
+        zassert_equal(latency_trace_bucket(upper), b + 1U, "bucket %u", b);
+    }
+    zassert_true(latency_trace_bucket_upper_us(LAST_BUCKET - 1U) > 2000000U,
+                 "closed buckets reach past two seconds");
+}
+
+ZTEST(latency_trace, test_empty_stage_reads_zero)
+{
+    LatencyStats_t st;
+
+    (void)memset(&st, 0xA5, sizeof(st));
+    latency_trace_stats(STAGE, &st);
+    zassert_equal(st.count, 0U);
+    zassert_equal(st.min_us, 0U);
+    zassert_equal(st.p50_us, 0U);
+    zassert_equal(st.p99_us, 0U);
+    zassert_equal(st.max_us, 0U);
+}
+
+ZTEST(latency_trace, test_single_sample_reads_exact)
+{
+    LatencyStats_t st;
+
+    latency_trace_record(STAGE, 1000U);
+    latency_trace_stats(STAGE, &st);
+    zassert_equal(st.count, 1U);
+    zassert_equal(st.min_us, 1000U);
+    zassert_equal(st.p50_us, 1000U, "bucket edge clamped to max");
+    zassert_equal(st.p99_us, 1000U);
+    zassert_equal(st.max_us, 1000U);
+}
+
+ZTEST(latency_trace, test_percentiles)
+{
+    LatencyStats_t st;
+
+    /* 98 fast, 2 slow: the 99th sample is a slow one. */
+    record_n(STAGE, 1000U, 98U);
+    record_n(STAGE, 50000U, 2U);
+    latency_trace_stats(STAGE, &st);
+    zassert_equal(st.count, 100U);
+    zassert_equal(st.min_us, 1000U);
+    zassert_equal(st.p50_us, latency_trace_bucket_upper_us(
+                                 latency_trace_bucket(1000U)),
+                  "median reads its bucket's upper edge");
+    zassert_equal(st.p99_us, 50000U, "p99 clamped to the exact max");
+    zassert_equal(st.max_us, 50000U);
+
+    /* One more fast sample pushes the slow pair out of the 99th rank. */
+    latency_trace_clear();
+    record_n(STAGE, 1000U, 199U);
+    record_n(STAGE, 50000U, 1U);
+    latency_trace_stats(STAGE, &st);
+    zassert_true(st.p99_us < 2000U, "p99 %u", st.p99_us);
+    zassert_equal(st.max_us, 50000U);
+}
+
+ZTEST(latency_trace, test_saturated_bucket_halves_stage)
+{
+    LatencyStats_t st;
+
+    record_n(STAGE, 500U, UINT16_MAX);
+    latency_trace_record(STAGE, 40000U);
+    latency_trace_record(STAGE, 500U);
+    latency_trace_stats(STAGE, &st);
+    zassert_equal(st.count, (uint32_t)UINT16_MAX + 2U, "count stays exact");
+    zassert_equal(st.max_us, 40000U);
+    zassert_true(st.p99_us < 1000U, "distribution shape kept: p99 %u",
+                 st.p99_us);
+
+    latency_trace_stats(LATENCY_STAGE_SAMPLE_TO_FIRE, &st);
+    zassert_equal(st.count, 0U, "other stages untouched");
+}
+
+ZTEST(latency_trace, test_span_and_stage_bounds)
+{
+    LatencyStats_t st;
+    int64_t from = (int64_t)k_ms_to_ticks_ceil64(1000U);
+    int64_t now = from + (int64_t)k_ms_to_ticks_ceil64(20U);
+
+    zassert_equal(latency_trace_record_span(STAGE, 0, now), 0U,
+                  "no sample behind it");
+    latency_trace_record(LATENCY_STAGE_COUNT, 10U);
+    latency_trace_stats(STAGE, &st);
+    zassert_equal(st.count, 0U);
+    latency_trace_stats(LATENCY_STAGE_COUNT, &st);
+    zassert_equal(st.count, 0U);
+
+    uint32_t us = latency_trace_record_span(STAGE, from, now);
+
+    zassert_true((us >= 19000U) && (us <= 21000U), "span %u us", us);
+    latency_trace_stats(STAGE, &st);
+    zassert_equal(st.count, 1U);
+    zassert_equal(st.max_us, us);
+
+    zassert_equal(latency_trace_record_span(STAGE, now, from), 0U,
+                  "a clock step back reads as zero");
+}
+
+ZTEST(latency_trace, test_serialised_summary)
+{
+    uint8_t buf[LATENCY_SUMMARY_BYTES + 4U];
+
+    zassert_equal(latency_trace_serialise(buf, LATENCY_SUMMARY_BYTES - 1U), 0U,
+                  "short buffer refused");
+    zassert_equal(latency_trace_serialise(NULL, sizeof(buf)), 0U);
+
+    latency_trace_record(LATENCY_STAGE_SAMPLE_TO_FIRE, 300000U);
+    zassert_equal(latency_trace_serialise(buf, sizeof(buf)),
+                  LATENCY_SUMMARY_BYTES);
+    zassert_equal(LATENCY_SUMMARY_BYTES, 82U);
+    zassert_equal(buf[0], LATENCY_SUMMARY_VERSION);
+    zassert_equal(buf[1], LATENCY_STAGE_COUNT);
+
+    const uint8_t *fire = &buf[2U + (LATENCY_STAGE_SAMPLE_TO_FIRE * STAGE_BYTES)];
+
+    zassert_equal(get_u32(&fire[0]), 1U, "count");
+    zassert_equal(get_u32(&fire[4]), 300000U, "min");
+    zassert_equal(get_u32(&fire[8]), 300000U, "p50");
+    zassert_equal(get_u32(&fire[12]), 300000U, "p99");
+    zassert_equal(get_u32(&fire[16]), 300000U, "max");
+    zassert_equal(get_u32(&buf[2]), 0U, "empty stage reads zero");
+}
+
+ZTEST(latency_trace, test_sequence_never_zero)
+{
+    uint32_t a = latency_trace_next_seq();
+    uint32_t b = latency_trace_next_seq();
+
+    zassert_not_equal(a, 0U);
+    zassert_equal(b, a + 1U);
+}
@@ -131,3 +131,30 @@ ZTEST(maintenance_arena, test_reset_clears_pin)
     zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_OTA),
                      "reset clears both the owner and the build pin");
 }
+
+/* A reservation-only stream that starts using the scratch bytes (compressed
+ * download) invalidates the log-index cache exactly once; a non-holder's mark
+ * is ignored. */
+ZTEST(maintenance_arena, test_mark_scratch_invalidates_cache_once)
+{
+    zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_LOG_INDEX), NULL);
+    maint_arena_release(MAINT_ARENA_OWNER_LOG_INDEX);
+    zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_LOG_STREAM), NULL);
+    uint32_t gen0 = maint_arena_generation();
+
+    maint_arena_mark_scratch(MAINT_ARENA_OWNER_OTA);
+    zassert_equal(maint_arena_generation(), gen0, "non-holder mark ignored");
+
+    maint_arena_mark_scratch(MAINT_ARENA_OWNER_LOG_STREAM);
+    zassert_equal(maint_arena_generation(), gen0 + 1U,
+                  "first scratch use bumps the generation");
+    maint_arena_mark_scratch(MAINT_ARENA_OWNER_LOG_STREAM);
+    zassert_equal(maint_arena_generation(), gen0 + 1U,
+                  "repeat mark by the same content owner is a no-op");
+
+    maint_arena_release(MAINT_ARENA_OWNER_LOG_STREAM);
+    zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_LOG_INDEX), NULL);
+    zassert_equal(maint_arena_generation(), gen0 + 2U,
+                  "the index re-claim after a compressed stream must rebuild");
+    maint_arena_release(MAINT_ARENA_OWNER_LOG_INDEX);
+}
@@ -31,20 +31,22 @@ typedef struct {
 
 /* Extern declarations for parse functions in oxygen_cell_diveo2.c */
 extern CellStatus_t diveo2_parse_error_code(const char *err_str);
-extern size_t diveo2_prepare_message_buffer(const char *rawBuffer,
-                                            char *outBuffer,
-                                            size_t outBufferLen);
-extern bool diveo2_parse_simple_response(const char *message,
+extern const char *diveo2_frame_view(const char *raw, size_t raw_len,
+                                     size_t *msg_len);
+extern bool diveo2_parse_simple_response(const char *message, size_t len,
                                          int32_t *raw_ppo2_millihpa,
                                          int32_t *temperature_mc,
                                          CellStatus_t *status);
-extern bool diveo2_parse_detailed_response(const char *message,
+extern bool diveo2_parse_detailed_response(const char *message, size_t len,
                                            DiveO2DetailedReading_t *out);
 extern void diveo2_format_tx_command(const char *command, uint8_t *txBuf,
                                      size_t bufLen);
-extern CellProtocol_t diveo2_detect_protocol(const char *message);
+extern CellProtocol_t diveo2_detect_protocol(const char *message, size_t len);
+
+/* The parsers take a (pointer, length) view, as the driver hands them frames
+ * straight out of the DMA buffer; MSG() expands a literal into that pair. */
+#define MSG(lit) (lit), (sizeof(lit) - 1U)
 
-#define DIVEO2_RX_BUF_LEN 86U
 #define DIVEO2_TX_BUF_LEN 8U
 
 /* ============================================================================
@@ -148,88 +150,90 @@ ZTEST(diveo2_error, test_empty_string_ok)
 }
 
 /* ============================================================================
- * Buffer Preparation
+ * Frame View
  * ============================================================================ */
 
-/** @brief Suite: raw UART buffer → clean ASCII message preparation (diveo2_prepare_message_buffer). */
-ZTEST_SUITE(diveo2_buffer, NULL, NULL, NULL, NULL, NULL);
+/** @brief Suite: locating the message inside a raw UART frame in place (diveo2_frame_view). */
+ZTEST_SUITE(diveo2_view, NULL, NULL, NULL, NULL, NULL);
 
-/** @brief A clean message with CRLF terminator is copied verbatim (without CRLF). */
-ZTEST(diveo2_buffer, test_normal_copy)
+/** @brief A clean message with CRLF terminator is viewed where it lies, without the CRLF. */
+ZTEST(diveo2_view, test_normal_view)
 {
-    char out[DIVEO2_RX_BUF_LEN];
-    size_t skipped = diveo2_prepare_message_buffer(
-        "#DOXY 12340 2500 0\r\n", out, sizeof(out));
+    static const char raw[] = "#DOXY 12340 2500 0\r\n";
+    size_t len = 0U;
+    const char *msg = diveo2_frame_view(raw, sizeof(raw) - 1U, &len);
 
-    zassert_equal(0U, skipped);
-    zassert_str_equal("#DOXY 12340 2500 0", out);
+    zassert_equal_ptr(raw, msg);
+    zassert_equal(strlen("#DOXY 12340 2500 0"), len);
 }
 
-/** @brief Leading null bytes (UART DMA artefacts) are skipped; skipped count is returned. */
-ZTEST(diveo2_buffer, test_skips_leading_nulls)
+/** @brief Leading null bytes (UART DMA artefacts) are skipped. */
+ZTEST(diveo2_view, test_skips_leading_nulls)
 {
     char raw[64] = {0};
 
     (void)strcpy(&raw[3], "#DOXY 12340 2500 0\r\n");
 
-    char out[DIVEO2_RX_BUF_LEN];
-    size_t skipped = diveo2_prepare_message_buffer(raw, out, sizeof(out));
+    size_t len = 0U;
+    const char *msg = diveo2_frame_view(raw, sizeof(raw), &len);
 
-    zassert_equal(3U, skipped);
-    zassert_str_equal("#DOXY 12340 2500 0", out);
+    zassert_equal_ptr(&raw[3], msg);
+    zassert_mem_equal("#DOXY 12340 2500 0", msg, len);
+    zassert_equal(strlen("#DOXY 12340 2500 0"), len);
 }
 
-/** @brief Leading CR bytes are also skipped before copying the message body. */
-ZTEST(diveo2_buffer, test_skips_leading_cr)
+/** @brief Leading CR bytes are also skipped before the message body. */
+ZTEST(diveo2_view, test_skips_leading_cr)
 {
-    char out[DIVEO2_RX_BUF_LEN];
-    size_t skipped = diveo2_prepare_message_buffer(
-        "\r\r\r#DOXY 12340 2500 0\r\n", out, sizeof(out));
+    static const char raw[] = "\r\r\r#DOXY 12340 2500 0\r\n";
+    size_t len = 0U;
+    const char *msg = diveo2_frame_view(raw, sizeof(raw) - 1U, &len);
 
-    zassert_equal(3U, skipped);
-    zassert_str_equal("#DOXY 12340 2500 0", out);
+    zassert_equal_ptr(&raw[3], msg);
+    zassert_equal(strlen("#DOXY 12340 2500 0"), len);
 }
 
-/** @brief Copy stops at the first LF; any trailing garbage after CRLF is discarded. */
-ZTEST(diveo2_buffer, test_terminates_at_newline)
+/** @brief The view stops at the first LF; any trailing garbage after CRLF is excluded. */
+ZTEST(diveo2_view, test_terminates_at_newline)
 {
-    char out[DIVEO2_RX_BUF_LEN];
+    static const char raw[] = "#DOXY 12340 2500 0\r\ngarbage";
+    size_t len = 0U;
 
-    (void)diveo2_prepare_message_buffer(
-        "#DOXY 12340 2500 0\r\ngarbage", out, sizeof(out));
-    zassert_str_equal("#DOXY 12340 2500 0", out);
+    (void)diveo2_frame_view(raw, sizeof(raw) - 1U, &len);
+    zassert_equal(strlen("#DOXY 12340 2500 0"), len);
 }
 
-/** @brief Output is always NUL-terminated even when the buffer is smaller than the input. */
-ZTEST(diveo2_buffer, test_always_null_terminated)
+/** @brief The view never extends past raw_len, terminator or not. */
+ZTEST(diveo2_view, test_bounded_by_length)
 {
-    char out[DIVEO2_RX_BUF_LEN];
+    size_t len = 0U;
 
-    (void)diveo2_prepare_message_buffer("#DOXY 12340 2500 0", out, 10);
-    zassert_equal('\0', out[9]);
+    (void)diveo2_frame_view("#DOXY 12340 2500 0", 9U, &len);
+    zassert_equal(9U, len);
 }
 
-/** @brief NULL input produces an empty output string without crashing. */
-ZTEST(diveo2_buffer, test_null_input)
+/** @brief NULL input produces a NULL, empty view without crashing. */
+ZTEST(diveo2_view, test_null_input)
 {
-    char out[DIVEO2_RX_BUF_LEN];
+    size_t len = 1U;
 
-    (void)diveo2_prepare_message_buffer(NULL, out, sizeof(out));
-    zassert_str_equal("", out);
+    zassert_is_null(diveo2_frame_view(NULL, 10U, &len));
+    zassert_equal(0U, len);
 }
 
-/** @brief NULL output pointer is handled gracefully (no crash). */
-ZTEST(diveo2_buffer, test_null_output)
+/** @brief NULL length output is handled gracefully (no crash). */
+ZTEST(diveo2_view, test_null_output)
 {
-    (void)diveo2_prepare_message_buffer("#DOXY 12340 2500 0", NULL, 10);
+    zassert_is_null(diveo2_frame_view("#DOXY 12340 2500 0", 10U, NULL));
 }
 
-/** @brief Zero output buffer length is handled gracefully (no write, no crash). */
-ZTEST(diveo2_buffer, test_zero_length)
+/** @brief A frame of only junk yields an empty view. */
+ZTEST(diveo2_view, test_junk_only)
 {
-    char out[DIVEO2_RX_BUF_LEN];
+    size_t len = 1U;
 
-    (void)diveo2_prepare_message_buffer("#DOXY 12340 2500 0", out, 0);
+    (void)diveo2_frame_view("\r\r", 2U, &len);
+    zassert_equal(0U, len);
 }
 
 /* ============================================================================
@@ -246,7 +250,7 @@ ZTEST(diveo2_simple, test_valid_message)
     CellStatus_t status;
 
     zassert_true(diveo2_parse_simple_response(
-        "#DOXY 12340 2500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 12340 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
     zassert_equal(12340, raw_ppo2_millihpa);
     zassert_equal(2500, temp_mc);
     zassert_equal(CELL_OK, status);
@@ -259,7 +263,7 @@ ZTEST(diveo2_simple, test_error_code)
     CellStatus_t status;
 
     zassert_true(diveo2_parse_simple_response(
-        "#DOXY 10000 2300 2", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 10000 2300 2"), &raw_ppo2_millihpa, &temp_mc, &status));
     zassert_equal(CELL_FAIL, status);
 }
 
@@ -270,7 +274,7 @@ ZTEST(diveo2_simple, test_missing_field)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#DOXY 12340 2500", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 12340 2500"), &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /** @brief A #DRAW message is rejected by the simple parser (wrong command prefix). */
@@ -280,7 +284,7 @@ ZTEST(diveo2_simple, test_wrong_command)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#DRAW 12340 2500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DRAW 12340 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /** @brief Empty string returns false without crashing. */
@@ -290,7 +294,7 @@ ZTEST(diveo2_simple, test_empty_message)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG(""), &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /** @brief NULL message pointer returns false without crashing. */
@@ -300,7 +304,7 @@ ZTEST(diveo2_simple, test_null_message)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        NULL, &raw_ppo2_millihpa, &temp_mc, &status));
+        NULL, 0U, &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /** @brief NULL ppo2 output pointer returns false without crashing. */
@@ -310,7 +314,7 @@ ZTEST(diveo2_simple, test_null_output)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#DOXY 12340 2500 0", NULL, &temp_mc, &status));
+        MSG("#DOXY 12340 2500 0"), NULL, &temp_mc, &status));
 }
 
 /** @brief Negative numeric fields (cold temperature, flooded cell) are parsed correctly. */
@@ -320,7 +324,7 @@ ZTEST(diveo2_simple, test_negative_values)
     CellStatus_t status;
 
     zassert_true(diveo2_parse_simple_response(
-        "#DOXY -100 -500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY -100 -500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
     zassert_equal(-100, raw_ppo2_millihpa);
     zassert_equal(-500, temp_mc);
 }
@@ -332,7 +336,7 @@ ZTEST(diveo2_simple, test_large_values)
     CellStatus_t status;
 
     zassert_true(diveo2_parse_simple_response(
-        "#DOXY 2147483647 1000000 0", &raw_ppo2_millihpa,
+        MSG("#DOXY 2147483647 1000000 0"), &raw_ppo2_millihpa,
         &temp_mc, &status));
     zassert_equal(2147483647, raw_ppo2_millihpa);
     zassert_equal(1000000, temp_mc);
@@ -347,7 +351,7 @@ ZTEST(diveo2_simple, test_zero_ppo2_preserved)
     CellStatus_t status;
 
     zassert_true(diveo2_parse_simple_response(
-        "#DOXY 0 2500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 0 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
     zassert_equal(0, raw_ppo2_millihpa);
     zassert_equal(CELL_OK, status);
 }
@@ -360,7 +364,7 @@ ZTEST(diveo2_simple, test_garbage_ppo2_rejected)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#DOXY 12x40 2500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 12x40 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /** @brief A PPO2 field with trailing garbage ("1234abc") is rejected. */
@@ -370,7 +374,7 @@ ZTEST(diveo2_simple, test_trailing_garbage_ppo2_rejected)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#DOXY 1234abc 2500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 1234abc 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /** @brief A non-numeric error-code field is rejected (would otherwise read 0=OK). */
@@ -380,7 +384,56 @@ ZTEST(diveo2_simple, test_garbage_errcode_rejected)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#DOXY 12340 2500 x", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#DOXY 12340 2500 x"), &raw_ppo2_millihpa, &temp_mc, &status));
+}
+
+/** @brief Parsing stops at the view length: bytes beyond it (the rest of the
+ *  DMA buffer) are never read as part of the last field. */
+ZTEST(diveo2_simple, test_view_not_terminated)
+{
+    static const char dma[] = "#DOXY 12340 2500 0999";
+    int32_t raw_ppo2_millihpa, temp_mc;
+    CellStatus_t status;
+
+    zassert_true(diveo2_parse_simple_response(
+        dma, strlen("#DOXY 12340 2500 0"), &raw_ppo2_millihpa, &temp_mc,
+        &status));
+    zassert_equal(CELL_OK, status, "error field read past the view");
+}
+
+/** @brief Repeated separators are skipped, as strtok_r did. */
+ZTEST(diveo2_simple, test_repeated_spaces)
+{
+    int32_t raw_ppo2_millihpa, temp_mc;
+    CellStatus_t status;
+
+    zassert_true(diveo2_parse_simple_response(
+        MSG("#DOXY  12340   2500 0 "), &raw_ppo2_millihpa, &temp_mc, &status));
+    zassert_equal(12340, raw_ppo2_millihpa);
+    zassert_equal(2500, temp_mc);
+}
+
+/** @brief Out-of-range fields saturate at the int32 limits instead of wrapping. */
+ZTEST(diveo2_simple, test_out_of_range_saturates)
+{
+    int32_t raw_ppo2_millihpa, temp_mc;
+    CellStatus_t status;
+
+    zassert_true(diveo2_parse_simple_response(
+        MSG("#DOXY 99999999999999999999 -2147483649 0"), &raw_ppo2_millihpa,
+        &temp_mc, &status));
+    zassert_equal(INT32_MAX, raw_ppo2_millihpa);
+    zassert_equal(INT32_MIN, temp_mc);
+}
+
+/** @brief A bare sign is not a number. */
+ZTEST(diveo2_simple, test_bare_sign_rejected)
+{
+    int32_t raw_ppo2_millihpa, temp_mc;
+    CellStatus_t status;
+
+    zassert_false(diveo2_parse_simple_response(
+        MSG("#DOXY - 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
 /* ============================================================================
@@ -396,7 +449,7 @@ ZTEST(diveo2_detailed, test_valid_message)
     DiveO2DetailedReading_t r = {0};
 
     zassert_true(diveo2_parse_detailed_response(
-        "#DRAW 12340 2500 0 1000 5000 200 1013250 45000", &r));
+        MSG("#DRAW 12340 2500 0 1000 5000 200 1013250 45000"), &r));
 
     zassert_equal(12340, r.raw_ppo2_millihpa);
     zassert_equal(2500, r.temperature_mc);
@@ -415,7 +468,7 @@ ZTEST(diveo2_detailed, test_error_code)
     DiveO2DetailedReading_t r = {0};
 
     zassert_true(diveo2_parse_detailed_response(
-        "#DRAW 10000 2300 64 900 4500 150 1010000 50000", &r));
+        MSG("#DRAW 10000 2300 64 900 4500 150 1010000 50000"), &r));
 
     zassert_equal(64, r.err_code);
     zassert_equal(CELL_DEGRADED, r.status);
@@ -427,7 +480,7 @@ ZTEST(diveo2_detailed, test_missing_field)
     DiveO2DetailedReading_t r = {0};
 
     zassert_false(diveo2_parse_detailed_response(
-        "#DRAW 12340 2500 0 1000 5000 200 1013250", &r));
+        MSG("#DRAW 12340 2500 0 1000 5000 200 1013250"), &r));
 }
 
 /** @brief A #DOXY message is rejected by the detailed parser (wrong command). */
@@ -436,7 +489,7 @@ ZTEST(diveo2_detailed, test_wrong_command)
     DiveO2DetailedReading_t r = {0};
 
     zassert_false(diveo2_parse_detailed_response(
-        "#DOXY 12340 2500 0", &r));
+        MSG("#DOXY 12340 2500 0"), &r));
 }
 
 /** @brief NULL message pointer returns false without crashing. */
@@ -444,14 +497,14 @@ ZTEST(diveo2_detailed, test_null_message)
 {
     DiveO2DetailedReading_t r = {0};
 
-    zassert_false(diveo2_parse_detailed_response(NULL, &r));
+    zassert_false(diveo2_parse_detailed_response(NULL, 0U, &r));
 }
 
 /** @brief NULL output pointer returns false without crashing. */
 ZTEST(diveo2_detailed, test_null_output)
 {
     zassert_false(diveo2_parse_detailed_response(
-        "#DRAW 12340 2500 0 1000 5000 200 1013250 45000", NULL));
+        MSG("#DRAW 12340 2500 0 1000 5000 200 1013250 45000"), NULL));
 }
 
 /** @brief A captured real-world #DRAW response is parsed correctly end-to-end. */
@@ -460,7 +513,7 @@ ZTEST(diveo2_detailed, test_real_world_message)
     DiveO2DetailedReading_t r = {0};
 
     zassert_true(diveo2_parse_detailed_response(
-        "#DRAW 209800 24500 0 38250 12340 45 1013250 42000", &r));
+        MSG("#DRAW 209800 24500 0 38250 12340 45 1013250 42000"), &r));
 
     zassert_equal(209800, r.raw_ppo2_millihpa);
     zassert_equal(24500, r.temperature_mc);
@@ -579,7 +632,7 @@ ZTEST(diveo2_pyro, test_moxy_simple)
     CellStatus_t status;
 
     zassert_true(diveo2_parse_simple_response(
-        "#MOXY 12340 2500 0", &raw_ppo2_millihpa, &temp_mc, &status));
+        MSG("#MOXY 12340 2500 0"), &raw_ppo2_millihpa, &temp_mc, &status));
     zassert_equal(12340, raw_ppo2_millihpa);
     zassert_equal(2500, temp_mc);
     zassert_equal(CELL_OK, status);
@@ -591,7 +644,7 @@ ZTEST(diveo2_pyro, test_mraw_detailed)
     DiveO2DetailedReading_t r = {0};
 
     zassert_true(diveo2_parse_detailed_response(
-        "#MRAW 12340 2500 0 1000 5000 200 1013250 45000", &r));
+        MSG("#MRAW 12340 2500 0 1000 5000 200 1013250 45000"), &r));
     zassert_equal(12340, r.raw_ppo2_millihpa);
     zassert_equal(2500, r.temperature_mc);
     zassert_equal(1000, r.phase_mdeg);
@@ -606,7 +659,7 @@ ZTEST(diveo2_pyro, test_mraw_rejected_by_simple)
     CellStatus_t status;
 
     zassert_false(diveo2_parse_simple_response(
-        "#MRAW 12340 2500 0 1000 5000 200 1013250 45000",
+        MSG("#MRAW 12340 2500 0 1000 5000 200 1013250 45000"),
         &raw_ppo2_millihpa, &temp_mc, &status));
 }
 
@@ -616,7 +669,7 @@ ZTEST(diveo2_pyro, test_foreign_prefix_rejected)
     DiveO2DetailedReading_t r = {0};
 
     zassert_false(diveo2_parse_detailed_response(
-        "#XRAW 12340 2500 0 1000 5000 200 1013250 45000", &r));
+        MSG("#XRAW 12340 2500 0 1000 5000 200 1013250 45000"), &r));
 }
 
 /** @brief A genuine zero PPO2 in a well-formed detailed frame is preserved. */
@@ -625,7 +678,7 @@ ZTEST(diveo2_detailed, test_zero_ppo2_preserved)
     DiveO2DetailedReading_t r = {0};
 
     zassert_true(diveo2_parse_detailed_response(
-        "#DRAW 0 2500 0 1000 5000 200 1013250 45000", &r));
+        MSG("#DRAW 0 2500 0 1000 5000 200 1013250 45000"), &r));
     zassert_equal(0, r.raw_ppo2_millihpa);
     zassert_equal(CELL_OK, r.status);
 }
@@ -636,7 +689,7 @@ ZTEST(diveo2_detailed, test_garbage_field_rejected)
     DiveO2DetailedReading_t r = {0};
 
     zassert_false(diveo2_parse_detailed_response(
-        "#DRAW 12340 2500 0 1000 5000 abc 1013250 45000", &r));
+        MSG("#DRAW 12340 2500 0 1000 5000 abc 1013250 45000"), &r));
 }
 
 /** @brief A field with trailing garbage ("12340x") is rejected. */
@@ -645,7 +698,7 @@ ZTEST(diveo2_detailed, test_trailing_garbage_rejected)
     DiveO2DetailedReading_t r = {0};
 
     zassert_false(diveo2_parse_detailed_response(
-        "#DRAW 12340x 2500 0 1000 5000 200 1013250 45000", &r));
+        MSG("#DRAW 12340x 2500 0 1000 5000 200 1013250 45000"), &r));
 }
 
 /* ============================================================================
@@ -658,22 +711,22 @@ ZTEST_SUITE(diveo2_protocol, NULL, NULL, NULL, NULL, NULL);
 /** @brief A '#D...' header classifies as DiveO2 (both simple and detailed). */
 ZTEST(diveo2_protocol, test_detect_diveo2)
 {
-    zassert_equal(CELL_PROTO_DIVEO2, diveo2_detect_protocol("#DRAW 1 2 3 4 5 6 7 8"));
-    zassert_equal(CELL_PROTO_DIVEO2, diveo2_detect_protocol("#DOXY 1 2 3"));
+    zassert_equal(CELL_PROTO_DIVEO2, diveo2_detect_protocol(MSG("#DRAW 1 2 3 4 5 6 7 8")));
+    zassert_equal(CELL_PROTO_DIVEO2, diveo2_detect_protocol(MSG("#DOXY 1 2 3")));
 }
 
 /** @brief A '#M...' header classifies as Pyroscience. */
 ZTEST(diveo2_protocol, test_detect_pyro)
 {
-    zassert_equal(CELL_PROTO_PYRO, diveo2_detect_protocol("#MRAW 1 2 3 4 5 6 7 8"));
-    zassert_equal(CELL_PROTO_PYRO, diveo2_detect_protocol("#MOXY 1 2 3"));
+    zassert_equal(CELL_PROTO_PYRO, diveo2_detect_protocol(MSG("#MRAW 1 2 3 4 5 6 7 8")));
+    zassert_equal(CELL_PROTO_PYRO, diveo2_detect_protocol(MSG("#MOXY 1 2 3")));
 }
 
 /** @brief Junk / error / NULL inputs classify as UNKNOWN. */
 ZTEST(diveo2_protocol, test_detect_unknown)
 {
-    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol("#ERRO -26"));
-    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol("garbage"));
-    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol(""));
-    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol(NULL));
+    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol(MSG("#ERRO -26")));
+    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol(MSG("garbage")));
+    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol(MSG("")));
+    zassert_equal(CELL_PROTO_UNKNOWN, diveo2_detect_protocol(NULL, 0U));
 }
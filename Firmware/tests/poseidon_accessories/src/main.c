@@ -4,9 +4,10 @@
  *
  * The production translation unit is included directly so the I2C target
  * callbacks can be driven exactly as the STM32 driver drives them. Hardware
- * I2C calls and the forever-running worker thread are replaced at this boundary;
- * frame parsing, CRCs, retries, gauge state and output sequencing remain the
- * production implementations.
+ * I2C calls, the i2c1 scheduler and the forever-running worker thread are
+ * replaced at this boundary; frame parsing, CRCs, gauge state and output
+ * sequencing remain the production implementations. Retry/recover policy is
+ * the scheduler's and is covered by tests/i2c1_sched.
  */
 
 #include <zephyr/ztest.h>
@@ -22,6 +23,7 @@
 #include "errors.h"
 #include "heartbeat.h"
 #include "i2c_bus_lock.h"
+#include "i2c1_sched.h"
 
 ZBUS_CHAN_DEFINE(chan_alarm_state, AlarmMask_t, NULL, NULL,
              ZBUS_OBSERVERS_EMPTY, ALARM_PPO2_INVALID);
@@ -36,9 +38,12 @@ static size_t captured_count;
 static Status_t write_script[16];
 static size_t write_script_count;
 static size_t write_script_index;
-static unsigned int lock_depth;
 static unsigned int activity_notes;
-static Status_t recover_result;
+static unsigned int batch_calls;
+static size_t last_batch_count;
+static uint8_t last_priority;
+static uint8_t last_attempts;
+static uint16_t last_deadline_ms;
 static OpError_t last_error;
 static uint32_t last_error_detail;
 static device_current_provider_fn registered_provider;
@@ -87,46 +92,38 @@ static int test_i2c_target_register(const struct device *dev,
 #undef i2c_target_register
 #undef i2c_write
 
-void i2c1_bus_lock(void)
-{
-    ++lock_depth;
-}
-
-Status_t i2c1_bus_lock_quiet(void)
-{
-    ++lock_depth;
-    return 0;
-}
-
-void i2c1_bus_unlock(void)
-{
-    zassert_true(lock_depth > 0U);
-    --lock_depth;
-}
-
 void i2c1_bus_note_activity(void)
 {
     ++activity_notes;
 }
 
-Status_t i2c1_bus_recover(void)
+/* One try per member, strictly in order, like the scheduler with every frame
+ * succeeding or failing hard. */
+Status_t i2c1_sched_run_batch(I2c1Txn_t *txns, size_t count)
 {
-    return recover_result;
-}
+    Status_t ret = 0;
 
-bool i2c1_error_is_retryable(Status_t rc)
-{
-    return (rc == -EBUSY) || (rc == -EAGAIN) ||
-           (rc == -ETIMEDOUT) || (rc == -EIO);
+    ++batch_calls;
+    last_batch_count = count;
+    for (size_t i = 0U; i < count; ++i) {
+        const struct pos_frame *f = (const struct pos_frame *)txns[i].ctx;
+
+        zassert_equal(txns[i].client, I2C1_CLIENT_POSEIDON);
+        zassert_equal(txns[i].device, f->addr, "the peer address is the merge key");
+        txns[i].result = txns[i].xfer(txns[i].ctx);
+        if (ret == 0) {
+            ret = txns[i].result;
+        }
+        last_priority = txns[i].priority;
+        last_attempts = txns[i].attempts;
+        last_deadline_ms = txns[i].deadline_ms;
+    }
+    return ret;
 }
 
-Status_t i2c1_transact(I2c1XferFn_t xfer, void *ctx, uint8_t attempts,
-               uint32_t backoff_base_ms, uint32_t backoff_jitter_ms)
+Status_t i2c1_sched_run(I2c1Txn_t *txn)
 {
-    ARG_UNUSED(attempts);
-    ARG_UNUSED(backoff_base_ms);
-    ARG_UNUSED(backoff_jitter_ms);
-    return xfer(ctx);
+    return i2c1_sched_run_batch(txn, 1U);
 }
 
 void op_error_publish(OpError_t code, uint32_t detail)
@@ -162,9 +159,12 @@ static void reset_write_capture(void)
     memset(write_script, 0, sizeof(write_script));
     write_script_count = 0U;
     write_script_index = 0U;
-    lock_depth = 0U;
     activity_notes = 0U;
-    recover_result = -EBUSY;
+    batch_calls = 0U;
+    last_batch_count = 0U;
+    last_priority = 0U;
+    last_attempts = 0U;
+    last_deadline_ms = 0U;
 }
 
 static void reset_gauge(void)
@@ -385,46 +385,51 @@ ZTEST(poseidon_accessories, test_send_frame_builds_wire_crc_and_uses_retry_adapt
     zassert_equal(captured[0].bytes[3], poseidon_crc8(wire, sizeof(wire)));
 }
 
-ZTEST(poseidon_accessories, test_group_retry_success_and_exhaustion)
+ZTEST(poseidon_accessories, test_group_is_ordered_with_per_frame_results)
 {
-    write_script[0] = -EAGAIN;
-    write_script[1] = -EBUSY;
-    write_script[2] = 0;
-    write_script_count = 3U;
-    zassert_ok(send_retry_locked(HUD_ADDR, HUD_CMD_LED, POSEIDON_STATE_OFF));
-    zassert_equal(captured_count, 3U);
+    struct pos_frame frames[] = {
+        { HUD_ADDR, HUD_CMD_VIBRATOR, POSEIDON_STATE_OFF },
+        { HUD_ADDR, HUD_CMD_LED, POSEIDON_STATE_OFF },
+        { BATTERY_ADDR, BATTERY_CMD_LED, POSEIDON_STATE_OFF },
+    };
+    I2c1Txn_t txns[ARRAY_SIZE(frames)];
 
-    reset_write_capture();
-    write_script[0] = -ENODEV;
+    write_script[0] = 0;
     write_script[1] = -ENODEV;
-    write_script[2] = -ENODEV;
+    write_script[2] = 0;
     write_script_count = 3U;
-    zassert_equal(
-        send_retry_locked(HUD_ADDR, HUD_CMD_LED, POSEIDON_STATE_OFF),
-        -ENODEV);
+    send_group(frames, txns, ARRAY_SIZE(frames));
+
+    /* One batch; a failing frame does not stop the ones after it. */
+    zassert_equal(batch_calls, 1U);
     zassert_equal(captured_count, 3U);
+    zassert_equal(captured[0].bytes[0], HUD_CMD_VIBRATOR);
+    zassert_equal(captured[1].bytes[0], HUD_CMD_LED);
+    zassert_equal(captured[2].addr, BATTERY_ADDR);
+    zassert_equal(last_priority, I2C1_PRIO_ACCESSORY);
+    zassert_equal(last_attempts, POSEIDON_SEND_ATTEMPTS);
+    zassert_equal(last_deadline_ms, 0U);
 
-    reset_write_capture();
-    recover_result = 0;
-    write_script[0] = -EIO;
-    write_script[1] = -EIO;
-    write_script[2] = -EIO;
-    write_script[3] = 0;
-    write_script_count = 4U;
-    zassert_ok(send_retry_locked(HUD_ADDR, HUD_CMD_LED, POSEIDON_STATE_OFF));
-    zassert_equal(captured_count, 4U);
+    zassert_ok(txns[0].result);
+    zassert_equal(txns[1].result, -ENODEV);
+    zassert_ok(txns[2].result);
+    zassert_equal(group_result(txns, 0U, 2U), -ENODEV);
+    zassert_ok(group_result(txns, 2U, 1U));
 }
 
 ZTEST(poseidon_accessories, test_refresh_outputs_initialises_then_drives_alarm)
 {
     refresh_outputs(0U);
+    /* Heartbeats group, then the battery tail: init + LED (speaker deferred). */
     zassert_equal(captured_count, 6U);
-    zassert_equal(lock_depth, 0U);
-    zassert_equal(activity_notes, 1U);
+    zassert_equal(batch_calls, 2U);
+    zassert_equal(last_batch_count, 2U);
+    zassert_equal(captured[4].bytes[0], BATTERY_CMD_INIT);
 
     reset_write_capture();
     refresh_outputs(ALARM_PPO2_HIGH);
     zassert_equal(captured_count, 6U);
+    zassert_equal(batch_calls, 2U);
     zassert_equal(captured[1].bytes[2], POSEIDON_STATE_ON);
     zassert_equal(captured[2].bytes[2], POSEIDON_STATE_ON);
     zassert_equal(captured[4].bytes[2], POSEIDON_STATE_ON);
@@ -436,6 +441,10 @@ ZTEST(poseidon_accessories, test_current_trigger_and_periodic_solicit)
 {
     poseidon_current_trigger();
     zassert_equal(captured_count, 1U);
+    /* Jumps the accessory queue, and is dropped rather than sent late. */
+    zassert_equal(last_priority, I2C1_PRIO_URGENT);
+    zassert_equal(last_deadline_ms, POSEIDON_TRIGGER_DEADLINE_MS);
+    zassert_equal(last_attempts, 1U);
     zassert_equal(captured[0].addr, BATTERY_ADDR);
     zassert_equal(captured[0].bytes[0], POSEIDON_CMD_DS2782_READ);
     zassert_equal(captured[0].bytes[2], DS2782_REG_CURRENT);
@@ -481,15 +490,14 @@ ZTEST(poseidon_accessories, test_refresh_outputs_reports_bus_errors)
     write_script_count = 0U;
     refresh_outputs(0U);
 
-    /* Now hard-fail every write with a non-retryable error and deny recovery,
-     * so both the HUD and Battery groups return an error and the
-     * OP_ERROR_DETAIL report arms run. */
+    /* Now hard-fail every write with a non-retryable error so both the HUD
+     * and Battery groups return an error and the OP_ERROR_DETAIL report arms
+     * run. */
     reset_write_capture();
     for (size_t i = 0U; i < ARRAY_SIZE(write_script); ++i) {
         write_script[i] = -ENODEV;
     }
     write_script_count = ARRAY_SIZE(write_script);
-    recover_result = -EBUSY;
     last_error = OP_ERR_NONE;
 
     refresh_outputs(0U);
@@ -507,7 +515,6 @@ ZTEST(poseidon_accessories, test_solicit_current_backoff_and_fail_report)
     k_msleep(CURRENT_SOLICIT_STALE_MS + 1);
     write_script[0] = -EIO;
     write_script_count = 1U;
-    recover_result = -EBUSY;
     last_error = OP_ERR_NONE;
     last_error_detail = 0U;
 
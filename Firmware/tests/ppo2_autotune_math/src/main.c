@@ -39,6 +39,9 @@ ZTEST(autotune_model_suite, test_identifies_delayed_nonmonotonic_response)
     zassert_true(model.time_constant_s >= 2.0f);
     zassert_true(model.mixing_excursion_bar > 0.005f);
     zassert_true(model.process_gain > 0.05f);
+    /* The rate gain is taken at the lobe; what stays once mixed is less. */
+    zassert_true(model.settled_gain > 0.0f);
+    zassert_true(model.settled_gain < model.process_gain);
 }
 
 ZTEST(autotune_model_suite, test_rejects_no_incremental_dose)
@@ -0,0 +1,407 @@
+/**
+ * @file main.c
+ * @brief Fixed-point consensus and PID equivalence against the float path
+ *
+ * Pure host build — no Zephyr threads or hardware. Sweeps the inputs of
+ * consensus_calculate_fixed(), pid_update_fixed() and
+ * pid_compute_fire_timing_fixed() and compares every result with the float
+ * reference, so CONFIG_PPO2_FIXED_POINT can be switched on without changing
+ * what the handset is sent.
+ *
+ * Once the two votes include the same cells, the fixed-point engine sends
+ * the mean the float engine sends, so the wire value and precision must
+ * match bit for bit, half-centibar ties included. Consensus inputs on a
+ * 2^-10 bar grid are exact in float and in Q16, so there the votes agree
+ * too. Off-grid inputs are drawn at random; a sample whose deviation lands
+ * within 1e-3 cbar of a voting threshold is counted but not compared,
+ * because there the float vote is decided by its own rounding.
+ */
+
+#include <zephyr/ztest.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "oxygen_cell_math.h"
+#include "ppo2_control_math.h"
+
+#define STALENESS_TICKS 10000LL
+#define NOW_TICKS       0LL
+
+/* 2^-10 bar steps, up to 2.6 bar so the > MAX_VALID_PPO2 saturation is hit */
+#define GRID_PER_BAR    1024
+#define GRID_MAX        2662
+/* Pair spread swept around each cell: 0.2 bar, past the 0.15 bar deviation */
+#define GRID_SPREAD     205
+/* Coarser steps for the three-cell sweep, which is cubic */
+#define GRID3_STEP      8
+#define GRID3_SPREAD    320
+
+#define RANDOM_SAMPLES     200000U
+#define BOUNDARY_GUARD_CB  1e-3
+#define NEAR_TIE_SAMPLES   200000U
+/* Offset of a near-tie mean from the half centibar: 1e-3 cbar in bar */
+#define NEAR_TIE_SPAN_BAR  1e-5f
+
+/* Fire-cycle constants matched to the production PID fire task. */
+#define FIRE_CYCLE_MS  5000U
+#define FIRE_MIN_MS     200U
+#define FIRE_MAX_MS    4900U
+#define FIRE_TOLERANCE_US 2
+
+/* Per-step PID tolerance: the ported regression suite's EPS */
+#define PID_EPS 1e-4
+
+/** @brief Deterministic xorshift32 so a failure reproduces. */
+static uint32_t rng_next(uint32_t *state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/** @brief Uniform float in [lo, hi). */
+static float rng_uniform(uint32_t *state, float lo, float hi)
+{
+    return lo + ((hi - lo) * ((float)(rng_next(state) >> 8) / 16777216.0f));
+}
+
+/** @brief An included cell reading @p bar: OK, fresh, valid wire value. */
+static OxygenCellMsg_t make_cell(uint8_t num, PrecisionPPO2_t bar)
+{
+    PPO2_t wire = ppo2_centibar_to_wire(bar * 100.0f);
+
+    return (OxygenCellMsg_t){
+        .cell_number = num,
+        .ppo2 = (0U == wire) ? 1U : wire,
+        .precision_ppo2 = bar,
+        .millivolts = 0U,
+        .status = CELL_OK,
+        .timestamp_ticks = NOW_TICKS,
+    };
+}
+
+static void assert_consensus_equal(const OxygenCellMsg_t cells[], uint8_t count)
+{
+    ConsensusMsg_t ref = consensus_calculate_float(cells, count, NOW_TICKS,
+                               STALENESS_TICKS);
+    ConsensusMsg_t fix = consensus_calculate_fixed(cells, count, NOW_TICKS,
+                               STALENESS_TICKS);
+
+    zassert_equal(fix.consensus_ppo2, ref.consensus_ppo2,
+              "wire: %.9f %.9f %.9f",
+              (double)cells[0].precision_ppo2,
+              (double)cells[1].precision_ppo2,
+              (double)cells[count - 1U].precision_ppo2);
+    for (uint8_t i = 0U; i < CELL_MAX_COUNT; ++i) {
+        zassert_equal(fix.include_array[i], ref.include_array[i],
+                  "include[%u]", i);
+    }
+    zassert_equal(fix.confidence, ref.confidence, "confidence");
+    zassert_true(fix.precision_consensus == ref.precision_consensus,
+             "precision: %.9f %.9f", (double)fix.precision_consensus,
+             (double)ref.precision_consensus);
+}
+
+/**
+ * @brief True when any decision the vote can take on @p bar[] sits within
+ *        BOUNDARY_GUARD_CB of its threshold, evaluated in double.
+ *
+ * Rounding the mean and the MAX_VALID_PPO2 saturation are not votes: both
+ * engines do them on the same float mean.
+ */
+static bool near_boundary(const float bar[3], uint8_t count)
+{
+    const double dev = (double)MAX_DEVIATION;
+    const double a = (double)bar[0] * 100.0;
+    const double b = (double)bar[1] * 100.0;
+    bool near = (fabs(fabs(a - b) - dev) < BOUNDARY_GUARD_CB);
+
+    if (3U == count) {
+        const double c = (double)bar[2] * 100.0;
+        const double v[3] = {a, b, c};
+        const uint8_t pair[3][3] = {{0, 1, 2}, {0, 2, 1}, {1, 2, 0}};
+        double diffs[3] = {0};
+
+        for (uint8_t i = 0U; i < 3U; ++i) {
+            double pa = v[pair[i][0]];
+            double pb = v[pair[i][1]];
+            double avg = (pa + pb) / 2.0;
+
+            diffs[i] = fabs(pa - pb);
+            near = near || (fabs(diffs[i] - dev) < BOUNDARY_GUARD_CB) ||
+                   (fabs(fabs(v[pair[i][2]] - avg) - dev) < BOUNDARY_GUARD_CB);
+        }
+        /* The closest pair itself must be unambiguous */
+        near = near || (fabs(diffs[0] - diffs[1]) < BOUNDARY_GUARD_CB) ||
+               (fabs(diffs[0] - diffs[2]) < BOUNDARY_GUARD_CB) ||
+               (fabs(diffs[1] - diffs[2]) < BOUNDARY_GUARD_CB);
+    }
+
+    return near;
+}
+
+/* ============================================================================
+ * Consensus
+ * ============================================================================ */
+
+ZTEST_SUITE(fixed_consensus, NULL, NULL, NULL, NULL, NULL);
+
+/** @brief Every on-grid pair within 0.2 bar of each other, 0.001 to 2.6 bar. */
+ZTEST(fixed_consensus, test_two_cell_grid_sweep)
+{
+    for (int32_t a = 1; a <= GRID_MAX; ++a) {
+        for (int32_t b = a - GRID_SPREAD; b <= (a + GRID_SPREAD); ++b) {
+            if ((b >= 1) && (b <= GRID_MAX)) {
+                OxygenCellMsg_t cells[2] = {
+                    make_cell(0U, (float)a / GRID_PER_BAR),
+                    make_cell(1U, (float)b / GRID_PER_BAR),
+                };
+
+                assert_consensus_equal(cells, 2U);
+            }
+        }
+    }
+}
+
+/** @brief On-grid triples covering all-agree, one outlier and all-apart. */
+ZTEST(fixed_consensus, test_three_cell_grid_sweep)
+{
+    for (int32_t a = GRID3_STEP; a <= GRID_MAX; a += GRID3_STEP) {
+        for (int32_t db = -GRID3_SPREAD; db <= GRID3_SPREAD; db += GRID3_STEP) {
+            for (int32_t dc = -GRID3_SPREAD; dc <= GRID3_SPREAD;
+                 dc += GRID3_STEP) {
+                int32_t b = a + db + 1;  /* offset so the pair sum is odd */
+                int32_t c = a + dc;
+
+                if ((b >= 1) && (c >= 1)) {
+                    OxygenCellMsg_t cells[3] = {
+                        make_cell(0U, (float)a / GRID_PER_BAR),
+                        make_cell(1U, (float)b / GRID_PER_BAR),
+                        make_cell(2U, (float)c / GRID_PER_BAR),
+                    };
+
+                    assert_consensus_equal(cells, 3U);
+                }
+            }
+        }
+    }
+}
+
+/** @brief Random off-grid readings; only boundary-straddling samples skip. */
+ZTEST(fixed_consensus, test_random_off_grid)
+{
+    uint32_t rng = 0x2545F491U;
+    uint32_t skipped = 0U;
+
+    for (uint32_t n = 0U; n < RANDOM_SAMPLES; ++n) {
+        uint8_t count = (0U == (n % 2U)) ? 2U : 3U;
+        float centre = rng_uniform(&rng, 0.05f, 2.6f);
+        float bar[3] = {
+            centre,
+            centre + rng_uniform(&rng, -0.2f, 0.2f),
+            centre + rng_uniform(&rng, -0.2f, 0.2f),
+        };
+
+        if (near_boundary(bar, count)) {
+            ++skipped;
+        } else if ((bar[1] > 0.0f) && (bar[2] > 0.0f)) {
+            OxygenCellMsg_t cells[3] = {
+                make_cell(0U, bar[0]),
+                make_cell(1U, bar[1]),
+                make_cell(2U, bar[2]),
+            };
+
+            assert_consensus_equal(cells, count);
+        } else {
+            /* Negative reading: not a valid cell, nothing to compare */
+        }
+    }
+
+    zassert_true(skipped < (RANDOM_SAMPLES / 100U),
+             "%u boundary samples skipped", skipped);
+}
+
+/**
+ * @brief Means within 1e-3 cbar of a half centibar, where rounding the mean
+ *        in Q16 instead of float would flip the wire value: both engines
+ *        send the same one.
+ */
+ZTEST(fixed_consensus, test_random_near_ties)
+{
+    uint32_t rng = 0x9E3779B9U;
+
+    for (uint32_t n = 0U; n < NEAR_TIE_SAMPLES; ++n) {
+        uint8_t count = (0U == (n % 2U)) ? 2U : 3U;
+        float tie = ((float)(rng_next(&rng) % 250U) + 10.5f) / 100.0f;
+        float mean = tie + rng_uniform(&rng, -NEAR_TIE_SPAN_BAR,
+                                       NEAR_TIE_SPAN_BAR);
+        float half = rng_uniform(&rng, 0.0f, 0.05f);
+        /* Two cells straddle the mean; a third sits on it */
+        float bar[3] = {mean - half, mean + half, mean};
+
+        if (!near_boundary(bar, count)) {
+            OxygenCellMsg_t cells[3] = {
+                make_cell(0U, bar[0]),
+                make_cell(1U, bar[1]),
+                make_cell(2U, bar[2]),
+            };
+
+            assert_consensus_equal(cells, count);
+        }
+    }
+}
+
+/** @brief Exact half-centibar averages round away from zero in both paths. */
+ZTEST(fixed_consensus, test_half_centibar_ties)
+{
+    /* 0.5625 and 0.6875 bar are exact in float: average 62.5 cbar. */
+    OxygenCellMsg_t pair[2] = {make_cell(0U, 0.5625f), make_cell(1U, 0.6875f)};
+    ConsensusMsg_t fix = consensus_calculate_fixed(pair, 2U, NOW_TICKS,
+                               STALENESS_TICKS);
+
+    zassert_equal(fix.consensus_ppo2, 63U, "62.5 cbar rounds up");
+    assert_consensus_equal(pair, 2U);
+
+    /* 254.6875 cbar is over MAX_VALID_PPO2 and must fail, not clamp */
+    OxygenCellMsg_t high[2] = {
+        make_cell(0U, 2.5f), make_cell(1U, 2.59375f),
+    };
+
+    fix = consensus_calculate_fixed(high, 2U, NOW_TICKS, STALENESS_TICKS);
+    zassert_equal(fix.consensus_ppo2, PPO2_FAIL, "over range fails");
+    assert_consensus_equal(high, 2U);
+}
+
+/* ============================================================================
+ * PID
+ * ============================================================================ */
+
+ZTEST_SUITE(fixed_pid, NULL, NULL, NULL, NULL, NULL);
+
+/**
+ * @brief One step from the same state, across gains, setpoints and
+ *        measurements, including the +0.20 bar hard reset and both
+ *        saturation limits.
+ */
+ZTEST(fixed_pid, test_step_tracks_float_reference)
+{
+    static const float gains[][3] = {
+        {0.4f, 0.01f, 0.0f},   /* Production defaults */
+        {1.0f, 0.1f, 0.5f},
+        {5.0f, 0.5f, 2.0f},
+        {0.0f, 1.0f, 0.0f},
+    };
+    static const float integrals[] = {0.0f, 0.0123f, 0.5f, 0.99f, 1.0f};
+    uint32_t rng = 0x9E3779B9U;
+
+    for (size_t g = 0U; g < ARRAY_SIZE(gains); ++g) {
+        for (size_t i = 0U; i < ARRAY_SIZE(integrals); ++i) {
+            for (uint32_t n = 0U; n < 2000U; ++n) {
+                PIDState_t ref = {0};
+
+                pid_state_init(&ref, gains[g][0], gains[g][1], gains[g][2]);
+                ref.integral_state = integrals[i];
+                ref.derivative_state = rng_uniform(&rng, 0.2f, 1.6f);
+
+                PIDState_t fix = ref;
+                float setpoint = (float)(40U + (rng_next(&rng) % 100U)) / 100.0f;
+                float measurement = rng_uniform(&rng, 0.2f, 1.6f);
+
+                /* Skip the hard-reset threshold itself */
+                if (fabsf((setpoint - measurement) + 0.19999f) > 1e-4f) {
+                    float duty_ref = pid_update_float(setpoint, measurement, &ref);
+                    float duty_fix = pid_update_fixed(setpoint, measurement, &fix);
+
+                    zassert_within(duty_fix, duty_ref, PID_EPS,
+                               "sp %f meas %f", (double)setpoint,
+                               (double)measurement);
+                    zassert_within(fix.integral_state, ref.integral_state,
+                               PID_EPS, "integral");
+                    zassert_equal(fix.derivative_state, ref.derivative_state,
+                              "derivative state");
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief A long closed loop: the fixed integrator stays a Q24 value, which
+ *        the float state field holds exactly, and tracks the float run.
+ */
+ZTEST(fixed_pid, test_closed_loop_integrator)
+{
+    PIDState_t ref = {0};
+    PIDState_t fix = {0};
+    float ppo2 = 0.21f;
+
+    pid_state_init(&ref, 0.4f, 0.01f, 0.0f);
+    pid_state_init(&fix, 0.4f, 0.01f, 0.0f);
+
+    for (uint32_t n = 0U; n < 5000U; ++n) {
+        float setpoint = (n < 2500U) ? 0.7f : 1.3f;
+        float duty_ref = pid_update_float(setpoint, ppo2, &ref);
+        float duty_fix = pid_update_fixed(setpoint, ppo2, &fix);
+
+        zassert_within(duty_fix, duty_ref, PID_EPS, "step %u", n);
+
+        float scaled = fix.integral_state * 16777216.0f;
+
+        zassert_equal(scaled, floorf(scaled), "step %u: not Q24", n);
+
+        /* First-order plant driven by the reference duty, metabolising O2 */
+        float drive = fminf(fmaxf(duty_ref, 0.0f), 1.0f);
+
+        ppo2 += (0.01f * drive) - (0.002f * ppo2);
+    }
+}
+
+/** @brief Duty from -0.1 to 1.1 against pressure, with and without depth comp. */
+ZTEST(fixed_pid, test_fire_timing_sweep)
+{
+    /* Nothing below ~300 mbar is breathable ambient; lower pressures scale
+     * the Q24 duty step by 1000 / mbar past the microsecond tolerance. */
+    static const uint16_t pressures[] = {
+        0U, 250U, 500U, 800U, 1000U, 1013U, 1500U, 2000U, 4000U, 10000U,
+        UINT16_MAX,
+    };
+
+    for (int32_t permille = -100; permille <= 1100; ++permille) {
+        float duty = (float)permille / 1000.0f;
+
+        for (size_t p = 0U; p < ARRAY_SIZE(pressures); ++p) {
+            for (uint8_t depth = 0U; depth < 2U; ++depth) {
+                FireTiming_t ref = pid_compute_fire_timing_float(
+                    duty, pressures[p], 1U == depth, FIRE_CYCLE_MS,
+                    FIRE_MIN_MS, FIRE_MAX_MS);
+                FireTiming_t fix = pid_compute_fire_timing_fixed(
+                    duty, pressures[p], 1U == depth, FIRE_CYCLE_MS,
+                    FIRE_MIN_MS, FIRE_MAX_MS);
+
+                zassert_equal(fix.should_fire, ref.should_fire,
+                          "duty %d p %u", permille, pressures[p]);
+                zassert_equal(fix.depth_comp_skipped, ref.depth_comp_skipped,
+                          "skipped");
+                zassert_within((int32_t)(fix.on_duration_us - ref.on_duration_us),
+                           0, FIRE_TOLERANCE_US, "on");
+                zassert_within((int32_t)(fix.off_duration_us - ref.off_duration_us),
+                           0, FIRE_TOLERANCE_US, "off");
+            }
+        }
+    }
+}
+
+/** @brief A zero-length cycle never fires. */
+ZTEST(fixed_pid, test_fire_timing_zero_cycle)
+{
+    FireTiming_t fix = pid_compute_fire_timing_fixed(0.5f, 1000U, true, 0U,
+                             FIRE_MIN_MS, FIRE_MAX_MS);
+
+    zassert_false(fix.should_fire, "zero cycle must not fire");
+    zassert_equal(fix.on_duration_us, 0U, "no on time");
+}
@@ -0,0 +1,203 @@
+/** @file main.c @brief Model-predictive pulse planner regression tests. */
+
+#include <zephyr/ztest.h>
+#include <math.h>
+#include "ppo2_mpc_math.h"
+
+#define EPS 1e-3f
+
+ZTEST_SUITE(mpc_planner_suite, NULL, NULL, NULL, NULL, NULL);
+
+static const MpcLimits_t LIMITS = {
+    .cycle_s = 5.0f,
+    .min_on_s = 0.1f,
+    .max_on_s = 4.9f,
+};
+
+/* Shallow "typical" loop as identified by autotune_identify_plant(). */
+static AutotunePlantModel_t make_model(void)
+{
+    return (AutotunePlantModel_t){
+        .process_gain = 0.068f,
+        .dead_time_s = 5.0f,
+        .time_constant_s = 18.0f,
+        .mixing_excursion_bar = 0.038f,
+        .baseline_ppo2_bar = 0.70f,
+        .baseline_duty = 0.10f,
+        .final_ppo2_bar = 0.74f,
+        .final_duty = 0.10f,
+        .settled_gain = 0.018f,
+        .valid = true,
+    };
+}
+
+ZTEST(mpc_planner_suite, test_never_fires_without_valid_model)
+{
+    AutotunePlantModel_t model = make_model();
+    model.valid = false;
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    zassert_within(mpc_plan_pulse(&state, &model, 0.70f, 0.40f, 0U, &LIMITS),
+               0.0f, EPS);
+    zassert_within(mpc_plan_pulse(&state, NULL, 0.70f, 0.40f, 0U, &LIMITS),
+               0.0f, EPS);
+}
+
+ZTEST(mpc_planner_suite, test_never_fires_above_setpoint)
+{
+    AutotunePlantModel_t model = make_model();
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    zassert_within(mpc_plan_pulse(&state, &model, 0.70f, 0.71f, 0U, &LIMITS),
+               0.0f, EPS);
+}
+
+ZTEST(mpc_planner_suite, test_large_gap_is_spread_over_cycles)
+{
+    AutotunePlantModel_t model = make_model();
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    /* 0.2 bar short would take ~11 s of O2 at the settled gain; one pulse
+     * may only add a bounded amount on top of the drift maintenance. */
+    PIDNumeric_t on_s = mpc_plan_pulse(&state, &model, 0.70f, 0.50f, 0U,
+                       &LIMITS);
+    PIDNumeric_t maintain_s = model.baseline_duty * LIMITS.cycle_s;
+    zassert_true(on_s > maintain_s, "no correction dosed");
+    zassert_true(on_s <= maintain_s + 1.0f + EPS, "pulse %f not bounded",
+             (double)on_s);
+}
+
+ZTEST(mpc_planner_suite, test_pulses_in_flight_hold_off_the_next)
+{
+    AutotunePlantModel_t model = make_model();
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    PIDNumeric_t first = mpc_plan_pulse(&state, &model, 0.70f, 0.66f,
+                        0U, &LIMITS);
+    mpc_record_pulse(&state, 0U, first);
+    /* Unchanged reading one cycle later — still inside the dead time. */
+    PIDNumeric_t second = mpc_plan_pulse(&state, &model, 0.70f, 0.66f,
+                         5000U, &LIMITS);
+
+    zassert_true(mpc_predict_settled(&state, &model, 0.66f, 5000U) > 0.66f);
+    zassert_true(second < first, "in-flight dose ignored: %f >= %f",
+             (double)second, (double)first);
+}
+
+ZTEST(mpc_planner_suite, test_pulse_age_survives_uptime_wrap)
+{
+    AutotunePlantModel_t model = make_model();
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    MpcState_t no_pulses = state;
+
+    mpc_record_pulse(&state, UINT32_MAX - 999U, 2.0f);
+    /* 2 s after the pulse started: inside the dead time, nothing visible. */
+    PIDNumeric_t unsettled =
+        mpc_predict_settled(&state, &model, 0.60f, 1000U) -
+        mpc_predict_settled(&no_pulses, &model, 0.60f, 1000U);
+    zassert_within(unsettled, 2.0f * model.settled_gain, EPS);
+}
+
+ZTEST(mpc_planner_suite, test_history_ring_keeps_newest)
+{
+    AutotunePlantModel_t model = make_model();
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    for (uint32_t i = 0U; i < (2U * MPC_HISTORY_LEN); ++i) {
+        mpc_record_pulse(&state, i * 5000U, 1.0f);
+    }
+    mpc_record_pulse(&state, 0U, 0.0f); /* zero pulses are not recorded */
+    zassert_equal(state.count, MPC_HISTORY_LEN);
+    zassert_equal(state.pulses[(state.next + MPC_HISTORY_LEN - 1U) %
+                   MPC_HISTORY_LEN].start_ms,
+              (2U * MPC_HISTORY_LEN - 1U) * 5000U);
+}
+
+ZTEST(mpc_planner_suite, test_dose_gain_falls_back_to_guarded_rate_gain)
+{
+    AutotunePlantModel_t model = make_model();
+    model.settled_gain = 0.0f;
+
+    zassert_within(mpc_dose_gain(&model),
+               model.process_gain / autotune_mixing_guard(&model), EPS);
+    zassert_true(mpc_dose_gain(&model) < model.process_gain);
+}
+
+ZTEST(mpc_planner_suite, test_invalidate_skips_drift_window)
+{
+    AutotunePlantModel_t model = make_model();
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+    PIDNumeric_t seeded = state.drift_bar_s;
+
+    (void)mpc_plan_pulse(&state, &model, 0.70f, 0.80f, 0U, &LIMITS);
+    mpc_state_invalidate(&state);
+    /* A 0.1 bar fall over the window would pull the drift down hard. */
+    (void)mpc_plan_pulse(&state, &model, 0.70f, 0.70f, 40000U, &LIMITS);
+    zassert_within(state.drift_bar_s, seeded, 1e-6f);
+}
+
+/**
+ * Closed loop against a plant with 1.5x the modelled gain, a cell lag and
+ * a consumption the model does not know: the planner must approach from
+ * below (bounded overshoot) and settle on setpoint via the drift estimate.
+ */
+ZTEST(mpc_planner_suite, test_closed_loop_settles_without_overshoot)
+{
+    const PIDNumeric_t setpoint = 0.70f;
+    const PIDNumeric_t dt_s = 0.1f;
+    const PIDNumeric_t cell_lag_s = 4.0f;
+    const PIDNumeric_t consumption_bar_s = 0.0025f;
+    AutotunePlantModel_t model = make_model();
+    const PIDNumeric_t plant_gain = 1.5f * model.settled_gain;
+    MpcState_t state;
+    mpc_state_init(&state, &model);
+
+    PIDNumeric_t mixed = 0.50f;
+    PIDNumeric_t reading = 0.50f;
+    PIDNumeric_t window_sum = 0.0f;
+    uint32_t window_n = 0U;
+    PIDNumeric_t on_until_s = 0.0f;
+    PIDNumeric_t peak = 0.0f;
+    PIDNumeric_t tail_sum = 0.0f;
+    uint32_t tail_n = 0U;
+
+    for (uint32_t step = 0U; step < 6000U; ++step) {
+        PIDNumeric_t t_s = (PIDNumeric_t)step * dt_s;
+        if ((step % 50U) == 0U) {
+            PIDNumeric_t measured = reading;
+            if (window_n > 0U) {
+                measured = window_sum / (PIDNumeric_t)window_n;
+            }
+            window_sum = 0.0f;
+            window_n = 0U;
+            uint32_t now_ms = step * 100U;
+            PIDNumeric_t on_s = mpc_plan_pulse(&state, &model, setpoint,
+                               measured, now_ms, &LIMITS);
+            mpc_record_pulse(&state, now_ms, on_s);
+            on_until_s = t_s + on_s;
+        }
+        if (t_s < on_until_s) {
+            mixed += plant_gain * dt_s;
+        }
+        mixed -= consumption_bar_s * dt_s;
+        reading += (mixed - reading) * (dt_s / cell_lag_s);
+        window_sum += reading;
+        ++window_n;
+        peak = fmaxf(peak, reading);
+        if (step >= 4500U) {
+            tail_sum += reading;
+            ++tail_n;
+        }
+    }
+
+    zassert_true(peak < setpoint + 0.03f, "overshoot to %f", (double)peak);
+    zassert_within(tail_sum / (PIDNumeric_t)tail_n, setpoint, 0.015f);
+}
@@ -0,0 +1,228 @@
+/** @file main.c @brief Background plant estimator regression tests. */
+
+#include <zephyr/ztest.h>
+#include <math.h>
+#include "ppo2_plant_rls_math.h"
+
+#define EPS 1e-4f
+
+ZTEST_SUITE(plant_rls_suite, NULL, NULL, NULL, NULL, NULL);
+
+static const uint32_t WINDOW_MS = 60000U;
+static const uint32_t SAMPLE_MS = 1000U;
+static const uint32_t CYCLE_MS = 5000U;
+
+/* Shallow "typical" loop as identified by autotune_identify_plant(). */
+static AutotunePlantModel_t make_model(void)
+{
+    return (AutotunePlantModel_t){
+        .process_gain = 0.068f,
+        .dead_time_s = 5.0f,
+        .time_constant_s = 18.0f,
+        .mixing_excursion_bar = 0.038f,
+        .baseline_ppo2_bar = 0.70f,
+        .baseline_duty = 0.10f,
+        .final_ppo2_bar = 0.74f,
+        .final_duty = 0.10f,
+        .settled_gain = 0.018f,
+        .valid = true,
+    };
+}
+
+/** Mixed loop with a lagged cell, held near setpoint by a P controller. */
+typedef struct {
+    PIDNumeric_t gain;             /* bar per duty-second */
+    PIDNumeric_t consumption_bar_s;
+    PIDNumeric_t setpoint;
+    PIDNumeric_t mixed;
+    PIDNumeric_t reading;
+    uint32_t now_ms;
+} Plant_t;
+
+static Plant_t make_plant(PIDNumeric_t gain, PIDNumeric_t consumption_bar_s)
+{
+    return (Plant_t){
+        .gain = gain,
+        .consumption_bar_s = consumption_bar_s,
+        .setpoint = 0.70f,
+        .mixed = 0.70f,
+        .reading = 0.70f,
+    };
+}
+
+/** Step @p plant for @p seconds, feeding fired pulses and 1 s samples to
+ *  the estimator; returns the number of windows that closed. */
+static uint32_t run_plant(Plant_t *plant, PlantRlsState_t *state,
+              const AutotunePlantModel_t *model, uint32_t seconds)
+{
+    const uint32_t dt_ms = 100U;
+    const PIDNumeric_t dt_s = 0.1f;
+    const PIDNumeric_t cell_lag_s = 4.0f;
+    uint32_t end_ms = plant->now_ms + (seconds * 1000U);
+    uint32_t on_until_ms = plant->now_ms;
+    uint32_t closed = 0U;
+
+    while (plant->now_ms < end_ms) {
+        if ((plant->now_ms % CYCLE_MS) == 0U) {
+            PIDNumeric_t duty = (plant->consumption_bar_s / plant->gain) +
+                        (4.0f * (plant->setpoint - plant->reading));
+            /* Whole plant steps, so the recorded pulse is the one delivered. */
+            PIDNumeric_t on_s = roundf(fminf(fmaxf(duty, 0.0f), 0.98f) * 50.0f) / 10.0f;
+
+            if (on_s >= 0.1f) {
+                plant_rls_record_pulse(state, plant->now_ms, on_s);
+                on_until_ms = plant->now_ms + (uint32_t)(on_s * 1000.0f);
+            }
+        }
+        if ((plant->now_ms % SAMPLE_MS) == 0U) {
+            if (plant_rls_sample(state, model, plant->reading,
+                         plant->now_ms, WINDOW_MS)) {
+                ++closed;
+            }
+        }
+        if (plant->now_ms < on_until_ms) {
+            plant->mixed += plant->gain * dt_s;
+        }
+        plant->mixed -= plant->consumption_bar_s * dt_s;
+        plant->reading += (plant->mixed - plant->reading) * (dt_s / cell_lag_s);
+        plant->now_ms += dt_ms;
+    }
+    return closed;
+}
+
+ZTEST(plant_rls_suite, test_seeded_at_reference)
+{
+    AutotunePlantModel_t model = make_model();
+    PlantRlsState_t state;
+    PlantEstimate_t est;
+
+    plant_rls_init(&state, &model);
+    plant_rls_estimate(&state, &model, &est);
+
+    zassert_within(est.settled_gain, model.settled_gain, EPS);
+    zassert_within(est.gain_ratio, 1.0f, EPS);
+    zassert_within(est.balance_duty, model.baseline_duty, EPS);
+    zassert_within(est.ref_balance_duty, model.baseline_duty, EPS);
+    zassert_equal(est.updates, 0U);
+    zassert_false(est.converged);
+}
+
+ZTEST(plant_rls_suite, test_no_fit_without_valid_model)
+{
+    AutotunePlantModel_t model = make_model();
+    model.valid = false;
+    PlantRlsState_t state;
+    Plant_t plant = make_plant(0.018f, 0.0018f);
+
+    plant_rls_init(&state, &model);
+    zassert_equal(run_plant(&plant, &state, &model, 300U), 0U);
+    zassert_equal(run_plant(&plant, &state, NULL, 300U), 0U);
+}
+
+/**
+ * The diver's O2 consumption doubles mid-dive: the balance duty must follow
+ * it, and the gain — unexcited by steady control — must stay put.
+ */
+ZTEST(plant_rls_suite, test_balance_follows_metabolic_shift)
+{
+    AutotunePlantModel_t model = make_model();
+    PlantRlsState_t state;
+    PlantEstimate_t est;
+    Plant_t plant = make_plant(model.settled_gain, 0.0018f);
+
+    plant_rls_init(&state, &model);
+    (void)run_plant(&plant, &state, &model, 900U);
+    plant_rls_estimate(&state, &model, &est);
+    zassert_within(est.balance_duty, 0.10f, 0.01f, "balance %f",
+               (double)est.balance_duty);
+
+    plant.consumption_bar_s = 0.0036f;
+    (void)run_plant(&plant, &state, &model, 900U);
+    plant_rls_estimate(&state, &model, &est);
+    zassert_within(est.balance_duty, 0.20f, 0.02f, "balance %f",
+               (double)est.balance_duty);
+    zassert_within(est.gain_ratio, 1.0f, 0.2f, "gain ratio %f",
+               (double)est.gain_ratio);
+}
+
+/**
+ * Steady control never excites the gain: the estimate must not wander
+ * along the balance line, nor claim to have confirmed the gain.
+ */
+ZTEST(plant_rls_suite, test_steady_control_holds_gain)
+{
+    AutotunePlantModel_t model = make_model();
+    PlantRlsState_t state;
+    PlantEstimate_t est;
+    Plant_t plant = make_plant(0.6f * model.settled_gain, 0.0011f);
+
+    plant_rls_init(&state, &model);
+    (void)run_plant(&plant, &state, &model, 1800U);
+    plant_rls_estimate(&state, &model, &est);
+
+    zassert_true(est.updates >= 25U);
+    zassert_equal(est.gain_updates, 0U);
+    zassert_within(est.gain_ratio, 1.0f, EPS);
+    zassert_false(est.converged);
+}
+
+/**
+ * A loop 0.6x the reference gain (larger volume) only shows once the dose
+ * leaves the balance; a setpoint change must pull the gain towards it.
+ */
+ZTEST(plant_rls_suite, test_setpoint_change_identifies_gain)
+{
+    AutotunePlantModel_t model = make_model();
+    PlantRlsState_t state;
+    PlantEstimate_t est;
+    Plant_t plant = make_plant(0.6f * model.settled_gain, 0.0011f);
+
+    plant_rls_init(&state, &model);
+    (void)run_plant(&plant, &state, &model, 600U);
+    plant.setpoint = 1.0f;
+    (void)run_plant(&plant, &state, &model, 600U);
+    plant.setpoint = 0.70f;
+    (void)run_plant(&plant, &state, &model, 600U);
+    plant_rls_estimate(&state, &model, &est);
+
+    zassert_true(est.gain_updates > 0U);
+    zassert_within(est.gain_ratio, 0.6f, 0.15f, "gain ratio %f",
+               (double)est.gain_ratio);
+    zassert_within(est.balance_duty, 0.0011f / plant.gain, 0.02f);
+    zassert_true(est.converged);
+}
+
+ZTEST(plant_rls_suite, test_sampling_stall_drops_window)
+{
+    AutotunePlantModel_t model = make_model();
+    PlantRlsState_t state;
+
+    plant_rls_init(&state, &model);
+    for (uint32_t t = 0U; t <= 120000U; t += SAMPLE_MS) {
+        (void)plant_rls_sample(&state, &model, 0.70f, t, WINDOW_MS);
+    }
+    uint16_t fitted = state.updates;
+    zassert_equal(fitted, 1U);
+
+    /* A 3-window gap: the open window is dropped, and so is the pairing. */
+    zassert_false(plant_rls_sample(&state, &model, 0.70f, 300000U, WINDOW_MS));
+    for (uint32_t t = 301000U; t < 360000U; t += SAMPLE_MS) {
+        zassert_false(plant_rls_sample(&state, &model, 0.70f, t, WINDOW_MS));
+    }
+    zassert_false(plant_rls_sample(&state, &model, 0.70f, 360000U, WINDOW_MS));
+    zassert_equal(state.updates, fitted);
+}
+
+ZTEST(plant_rls_suite, test_window_survives_uptime_wrap)
+{
+    AutotunePlantModel_t model = make_model();
+    PlantRlsState_t state;
+    uint32_t t = UINT32_MAX - 90000U;
+
+    plant_rls_init(&state, &model);
+    for (uint32_t i = 0U; i <= 120U; ++i) {
+        (void)plant_rls_sample(&state, &model, 0.70f, t, WINDOW_MS);
+        t += SAMPLE_MS;
+    }
+    zassert_equal(state.updates, 1U);
+}
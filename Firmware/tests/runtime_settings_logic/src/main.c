@@ -433,6 +433,7 @@ ZTEST(runtime_settings_logic, test_option_label_resolves_to_own_setting)
         { 0x9160U, "Off" },      /* PPO2 Mode (1), option 0 */
         { 0x9161U, "PID" },      /* PPO2 Mode (1), option 1 */
         { 0x9162U, "MK15" },     /* PPO2 Mode (1), option 2 */
+        { 0x9163U, "MPC" },      /* PPO2 Mode (1), option 3 */
         { 0x9170U, "Dig Ref" },  /* Cal Mode (2),  option 0 */
         { 0x9171U, "Absolute" }, /* Cal Mode (2),  option 1 */
         { 0x9172U, "TotalAbs" }, /* Cal Mode (2),  option 2 */
@@ -12,7 +12,7 @@
 
 #include "common.h"
 #include "errors.h"
-#include "i2c_bus_lock.h"
+#include "i2c1_sched.h"
 #include "tank_pressure.h"
 
 static bool mock_adc_ready;
@@ -93,13 +93,14 @@ void zbus_pub_checked(const struct zbus_channel *chan, const void *msg,
     ARG_UNUSED(timeout);
 }
 
-Status_t i2c1_transact(I2c1XferFn_t xfer, void *ctx, uint8_t attempts,
-               uint32_t backoff_base_ms, uint32_t backoff_jitter_ms)
+Status_t i2c1_sched_run(I2c1Txn_t *txn)
 {
-    ARG_UNUSED(attempts);
-    ARG_UNUSED(backoff_base_ms);
-    ARG_UNUSED(backoff_jitter_ms);
-    return xfer(ctx);
+    zassert_equal(txn->client, I2C1_CLIENT_TANK);
+    zassert_equal(txn->priority, I2C1_PRIO_BACKGROUND,
+                  "tank reads queue behind cells and Poseidon groups");
+    zassert_equal(txn->attempts, TANK_ADC_MAX_ATTEMPTS);
+    txn->result = txn->xfer(txn->ctx);
+    return txn->result;
 }
 
 static const struct adc_dt_spec fake_adc;
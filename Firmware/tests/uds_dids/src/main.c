@@ -13,7 +13,7 @@
  *
  * All external modules (OTA, log download, flash log, solenoid driver,
  * autotune, settings, state DIDs) are replaced with recording stubs;
- * responses are captured by wrapping ISOTP_Send.
+ * responses are captured by wrapping ISOTP_Reply.
  */
 
 #include <zephyr/ztest.h>
@@ -392,6 +392,10 @@ int error_histogram_clear(void)
     return stub.histogram_clear_rc;
 }
 
+void latency_trace_clear(void)
+{
+}
+
 void *maint_arena_claim(MaintArenaOwner_t owner)
 {
     ARG_UNUSED(owner);
@@ -556,9 +560,9 @@ FUNC_NORETURN void __wrap_sys_reboot(int type)
     }
 }
 
-int __wrap_ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *buf, uint16_t len)
+int __wrap_ISOTP_Reply(ISOTPReply_t *to, const uint8_t *buf, uint16_t len)
 {
-    ARG_UNUSED(ctx);
+    ARG_UNUSED(to);
     ++stub.isotp_send_calls;
     if (len <= sizeof(stub.captured_response)) {
         (void)memcpy(stub.captured_response, buf, len);
@@ -570,7 +574,7 @@ int __wrap_ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *buf, uint16_t len)
 /* ---- Test helpers ---- */
 
 static UDSContext_t test_ctx;
-static ISOTPContext_t test_isotp_ctx;
+static ISOTPReply_t test_reply;
 
 static void set_ambient_pressure_mbar(uint16_t mbar)
 {
@@ -690,7 +694,7 @@ static void test_setup(void *fixture)
      * left it claimed (k_sem_give past the limit is a harmless no-op). */
     (void)zbus_chan_finish(&chan_atmos_pressure);
 
-    UDS_Init(&test_ctx, &test_isotp_ctx);
+    UDS_Init(&test_ctx, &test_reply);
     set_ambient_pressure_mbar(SURFACE_PRESSURE_MBAR);
 }
 
@@ -1191,7 +1195,7 @@ ZTEST(uds_dids_core, test_entry_guard_paths)
     uint8_t request[2] = {0x00U, 0x99U};
     UDSContext_t no_transport = {0};
 
-    UDS_Init(NULL, &test_isotp_ctx);
+    UDS_Init(NULL, &test_reply);
     UDS_MaintainSession(NULL);
     UDS_ProcessRequest(NULL, request, sizeof(request));
     UDS_ProcessRequest(&test_ctx, NULL, sizeof(request));
@@ -1201,7 +1205,7 @@ ZTEST(uds_dids_core, test_entry_guard_paths)
                              UDS_NRC_SERVICE_NOT_SUPPORTED);
     UDS_SendResponse(NULL);
     UDS_SendResponse(&no_transport);
-    no_transport.isotp_context = &test_isotp_ctx;
+    no_transport.reply = &test_reply;
     UDS_SendResponse(&no_transport); /* zero response_length */
     zassert_equal(stub.isotp_send_calls, 0, "guards must not transmit");
 
@@ -7,13 +7,16 @@
  *     by-dive, begin-stream, plus the reject/length/out-of-range arms.
  *   - The 0x34 (RequestDownload) / 0x36 (TransferData) / 0x37 (TransferExit)
  *     reader path: happy full-drain, small-block slicing, wrong-sequence,
- *     empty/exhausted stream, and the top-level dispatch + claim shim.
+ *     empty/exhausted stream, the opt-in compressed body, and the top-level
+ *     dispatch + claim shim.
  *   - The stall-abort poll and the selector-result DID fill.
  *
  * uds.c is not linked — the handler only reaches it via UDS_SendResponse() /
  * UDS_SendNegativeResponse(), both stubbed here to capture the assembled
- * response. flash_log.c / zbus / writer threads are not linked either; the
- * reader is handed a test FCB via the flash_log_internal_* stubs.
+ * response. Extended-length blocks bypass uds.c for ISOTP_ReplyExternal(),
+ * stubbed the same way along with the TX queue's external-buffer hooks.
+ * flash_log.c / zbus / writer threads are not linked either; the reader is
+ * handed a test FCB via the flash_log_internal_* stubs.
  */
 
 #include <zephyr/ztest.h>
@@ -28,10 +31,14 @@
 
 #include "uds.h"
 #include "uds_log_download.h"
+#include "isotp_link.h"
+#include "isotp_tx_queue.h"
 #include "flash_log.h"
 #include "flash_log_entries.h"
 #include "flash_log_internal.h"
 #include "flash_log_reader.h"
+#include "flash_log_lz.h"
+#include "flash_log_tail.h"
 #include "maintenance_arena.h"
 #include "common.h"
 
@@ -68,15 +75,26 @@ uint32_t flash_log_internal_index_epoch(void)
     return test_index_epoch;
 }
 
+Status_t flash_log_internal_active_summary(FlashLogDest_t dest,
+                                           FlashLogIndexEntry_t *out)
+{
+    ARG_UNUSED(dest);
+    ARG_UNUSED(out);
+    return -ENODATA; /* no writer: the reader walks the active sector */
+}
+
 /* ---- uds.c / flash_log.c / log-push / errors stubs ---- */
 
 static struct {
     bool     is_negative;
     uint8_t  neg_sid;
     uint8_t  neg_nrc;
-    uint8_t  resp[UDS_MAX_RESPONSE_LENGTH];
+    uint8_t  resp[ISOTP_EXT_MAX_PAYLOAD];
     uint16_t resp_len;
     int      send_calls;
+    int      ext_send_calls;
+    int      ext_abort_calls;
+    bool     ext_pending;
     int      neg_calls;
     int      pause_calls;
     int      resume_calls;
@@ -106,6 +124,29 @@ void UDS_SendResponse(UDSContext_t *ctx)
     ++cap.send_calls;
 }
 
+bool ISOTP_ReplyExternal(ISOTPReply_t *to, const uint8_t *data, uint16_t length)
+{
+    ARG_UNUSED(to);
+    cap.is_negative = false;
+    cap.resp_len = length;
+    if (length <= sizeof(cap.resp)) {
+        (void)memcpy(cap.resp, data, length);
+    }
+    ++cap.ext_send_calls;
+    return true;
+}
+
+bool ISOTP_TxQueue_ExternalPending(void)
+{
+    return cap.ext_pending;
+}
+
+void ISOTP_TxQueue_AbortExternal(void)
+{
+    cap.ext_pending = false;
+    ++cap.ext_abort_calls;
+}
+
 bool flash_log_boot_marker_flushed(void)
 {
     /* The transport tests exercise selector/stream framing on a pre-stamped
@@ -249,15 +290,24 @@ static const uint16_t RID_BY_DIVE      = 0xF102U;
 static const uint16_t RID_BY_RANGE     = 0xF100U;
 static const uint16_t RID_BEGIN_STREAM = 0xF105U;
 static const uint16_t RID_SELECT_ALL   = 0xF106U;
+static const uint16_t RID_RESUME       = 0xF107U;
+static const uint16_t RID_LIVE_TAIL    = 0xF108U;
 static const uint8_t  LOG_HDR_MAGIC[4] = { 0x44U, 0x4CU, 0x43U, 0x47U };
 static const size_t   LOG_HEADER_BYTES = 16U;
 static const uint8_t  ADDR_LEN_FMT = 0x44U;
+static const uint8_t  DATA_FMT_RAW = 0x00U;
+static const uint8_t  DATA_FMT_LZ = 0x10U;
+static const size_t   HDR_FLAGS_IDX = 5U;
+static const size_t   HDR_CODEC_IDX = 7U;
+static const uint8_t  HDR_FLAG_FILTERED = 0x02U;
+static const size_t   HDR_MASK_BYTES = 8U;
+static const uint8_t  HDR_FLAG_DECIMATED = 0x04U;
 static const uint32_t SENTINEL_ADDR = 0xFFFFFFFEU;
 
 /* ---- Request builders / dispatch ---- */
 
 static UDSContext_t test_ctx;
-static ISOTPContext_t test_isotp_ctx;
+static ISOTPReply_t test_reply;
 
 /* Build a RoutineControl (0x31) request and dispatch it. `params` are appended
  * after the RID (i.e. at the selector-payload position). */
@@ -320,14 +370,15 @@ static void begin_stream(void)
 }
 
 /* Build a 0x34 RequestDownload: [pad][SID][dataFmt][addrLenFmt][addr4][size4]. */
-static void send_request_download(uint8_t addr_len_fmt, uint32_t addr,
-                                  uint32_t req_max, uint16_t len)
+static void send_request_download_fmt(uint8_t data_fmt, uint8_t addr_len_fmt,
+                                      uint32_t addr, uint32_t req_max,
+                                      uint16_t len)
 {
     uint8_t req[UDS_MAX_REQUEST_LENGTH] = {0};
 
     req[UDS_PAD_IDX] = 0x00U;
     req[UDS_SID_IDX] = UDS_SID_REQUEST_DOWNLOAD;
-    req[2] = 0x00U;             /* dataFormatIdentifier */
+    req[2] = data_fmt;          /* dataFormatIdentifier */
     req[3] = addr_len_fmt;
     req[4] = (uint8_t)(addr & 0xFFU);
     req[5] = (uint8_t)((addr >> 8) & 0xFFU);
@@ -340,6 +391,12 @@ static void send_request_download(uint8_t addr_len_fmt, uint32_t addr,
     UDS_LogDownload_Handle(&test_ctx, req, len);
 }
 
+static void send_request_download(uint8_t addr_len_fmt, uint32_t addr,
+                                  uint32_t req_max, uint16_t len)
+{
+    send_request_download_fmt(DATA_FMT_RAW, addr_len_fmt, addr, req_max, len);
+}
+
 /* Build a 0x36 TransferData request and dispatch. */
 static void send_transfer_data(uint8_t seq, uint16_t len)
 {
@@ -370,7 +427,8 @@ static void reset_sm(void *fixture)
     UDS_LogDownload_ResetForTest();   /* drop any async selector handshake state */
     (void)memset(&cap, 0, sizeof(cap));
     (void)memset(&test_ctx, 0, sizeof(test_ctx));
-    test_ctx.isotp_context = &test_isotp_ctx;
+    test_ctx.reply = &test_reply;
+    ISOTP_Link_Init();
     send_transfer_exit(2U);
     (void)memset(&cap, 0, sizeof(cap));
 }
@@ -437,9 +495,9 @@ ZTEST(logdl, test_routine_rid_out_of_range)
 {
     uint8_t stream = (uint8_t)FL_DEST_TELEMETRY;
 
-    /* RID above the log-management block (0xF106 select-all is the top). */
-    send_routine(0xF107U, &stream, 1U);
-    zassert_true(cap.is_negative, "0xF107 is unclaimed");
+    /* RID above the log-management block (0xF108 live tail is the top). */
+    send_routine(0xF109U, &stream, 1U);
+    zassert_true(cap.is_negative, "0xF109 is unclaimed");
     zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE, "range NRC");
 
     /* RID below the selector block (below RID_SELECT_BY_RANGE 0xF100). */
@@ -466,9 +524,9 @@ ZTEST(logdl, test_selector_bad_stream_and_length)
     send_routine(RID_BY_DIVE, &stream, 1U);
     zassert_equal(cap.neg_nrc, UDS_NRC_INCORRECT_MSG_LEN, "short by-dive NRC");
 
-    /* by-range is explicitly unimplemented (-ENOTSUP -> out of range). */
+    /* by-range needs 21 (stream + boot id + two u64 timestamps). */
     send_routine(RID_BY_RANGE, &stream, 1U);
-    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE, "by-range NRC");
+    zassert_equal(cap.neg_nrc, UDS_NRC_INCORRECT_MSG_LEN, "short by-range NRC");
 }
 
 ZTEST(logdl, test_selector_by_boot_and_dive)
@@ -522,6 +580,44 @@ ZTEST(logdl, test_selector_async_busy_then_ready)
                   "resolved selector is a positive RoutineControl response");
 }
 
+ZTEST(logdl, test_live_tail_routine)
+{
+    uint8_t params[10] = {0};
+    uint8_t out[FL_TAIL_RECORD_MAX];
+    const fl_payload_atmos_pressure_t p = { .pressure_mbar = 1013U };
+
+    /* Consensus only, default budget. */
+    params[FL_TYPE_CONSENSUS / 8U] = (uint8_t)(1U << (FL_TYPE_CONSENSUS % 8U));
+    send_routine(RID_LIVE_TAIL, params, 8U);
+    zassert_false(cap.is_negative, "mask-only subscription accepted");
+    zassert_equal(cap.resp[2], 0xF1U, "RID echoed");
+    zassert_equal(cap.resp[3], 0x08U, "RID echoed");
+
+    /* Records of other types are not tailed. */
+    flash_log_tail_offer(FL_TYPE_ATMOS_PRESSURE, 1000U, &p, sizeof(p));
+    zassert_equal(flash_log_tail_drain(out, sizeof(out), k_uptime_get_32()), 0U,
+                  "unselected type is not queued");
+
+    /* Budget outside the accepted range, a CAN-capture type, bad length. */
+    params[8] = 0x01U;
+    params[9] = 0x00U;
+    send_routine(RID_LIVE_TAIL, params, 10U);
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE, "1 B/s refused");
+    (void)memset(params, 0, sizeof(params));
+    params[0] = (uint8_t)(1U << FL_TYPE_CAN_TX);
+    send_routine(RID_LIVE_TAIL, params, 8U);
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE,
+                  "CAN capture cannot be tailed");
+    send_routine(RID_LIVE_TAIL, params, 4U);
+    zassert_equal(cap.neg_nrc, UDS_NRC_INCORRECT_MSG_LEN, "short mask");
+
+    /* All-zero mask ends the subscription. */
+    (void)memset(params, 0, sizeof(params));
+    send_routine(RID_LIVE_TAIL, params, 8U);
+    zassert_false(cap.is_negative, "unsubscribe accepted");
+    zassert_equal(cap.pause_calls, 0, "live tail never pauses the writer");
+}
+
 ZTEST(logdl, test_begin_stream_requires_selection)
 {
     /* Begin-stream from IDLE (no selection) -> sequence error. */
@@ -570,8 +666,12 @@ ZTEST(logdl, test_selector_supersedes_live_stream)
 
 /* ---- 0x34 / 0x36 / 0x37 reader path ---- */
 
+/* Stream header of the most recent drain_stream(), mask extension included. */
+static uint8_t drained_header[24];
+
 /* Drain the whole selected boot via 0x36 chunks of the negotiated size,
- * reassembling the body stream (past the 16-byte header of the first chunk). */
+ * reassembling the body stream (past the 16-byte header of the first chunk,
+ * or 24 bytes when it carries a record-type mask). */
 static size_t drain_stream(uint8_t *out, size_t out_cap, int *chunks_out)
 {
     size_t total = 0U;
@@ -595,6 +695,11 @@ static size_t drain_stream(uint8_t *out, size_t out_cap, int *chunks_out)
             zassert_mem_equal(&cap.resp[2], LOG_HDR_MAGIC, sizeof(LOG_HDR_MAGIC),
                               "DCLG magic on first chunk");
             off = LOG_HEADER_BYTES;
+            if (0U != (cap.resp[2U + HDR_FLAGS_IDX] & HDR_FLAG_FILTERED)) {
+                off += HDR_MASK_BYTES;
+            }
+            zassert_true(body >= off, "first chunk carries the whole header");
+            (void)memcpy(drained_header, &cap.resp[2], off);
             header_seen = true;
         }
         if (body == 0U) {
@@ -651,10 +756,82 @@ ZTEST(logdl, test_full_download_flow)
     zassert_equal(cap.suspend_false_calls, 1, "exit resumes log-push");
 }
 
+/* A peer whose ISO-TP link has been dropping frames is offered shorter 0x36
+ * blocks at 0x34 (isotp_link.h); the stream itself is unchanged. */
+ZTEST(logdl, test_lossy_link_shortens_blocks)
+{
+    static uint8_t out[8 * 1024];
+    uint8_t peer = (uint8_t)test_reply.target;
+
+    ISOTP_Link_NoteFault(peer, ISOTP_LINK_FAULT_TX_REFUSED);
+    ISOTP_Link_NoteFault(peer, ISOTP_LINK_FAULT_TX_TIMEOUT);
+
+    select_latest_boot();
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_false(cap.is_negative, "0x34 must be accepted");
+    zassert_equal(((uint16_t)cap.resp[2] << 8) | cap.resp[3], 128U,
+                  "two faults drop the block to the 128 B rung");
+
+    int chunks = 0;
+    size_t total = drain_stream(out, sizeof(out), &chunks);
+
+    zassert_equal(total, expected_len, "streamed %zu, expected %zu",
+                  total, expected_len);
+    zassert_mem_equal(out, expected, expected_len, "stream body mismatch");
+    send_transfer_exit(2U);
+}
+
 /* Walk-free "download all": RID_SELECT_ALL resolves a cleared range (no marker
  * index, no arena, no walk) and must stream every resident entry oldest→newest
  * — i.e. the identical byte stream the whole-boot flow produces here, since the
  * fixture holds a single boot. */
+/* by-range payload: stream, boot_id u32 LE, start_us u64 LE, end_us u64 LE. */
+static void range_params(uint8_t *p, uint32_t boot_id, uint64_t start_us,
+                         uint64_t end_us)
+{
+    p[0] = (uint8_t)FL_DEST_TELEMETRY;
+    for (size_t i = 0U; i < 4U; ++i) {
+        p[1U + i] = (uint8_t)(boot_id >> (8U * i));
+    }
+    for (size_t i = 0U; i < 8U; ++i) {
+        p[5U + i] = (uint8_t)(start_us >> (8U * i));
+        p[13U + i] = (uint8_t)(end_us >> (8U * i));
+    }
+}
+
+ZTEST(logdl, test_selector_by_range)
+{
+    static uint8_t out[8 * 1024];
+    uint8_t params[21];
+
+    /* The fixture's entries are all stamped ts 0: a window covering it
+     * resolves and streams boot 10 from its marker. */
+    range_params(params, 10U, 0U, 1000U);
+    drive_selector(RID_BY_RANGE, params, sizeof(params));
+    zassert_false(cap.is_negative, "boot 10 window must resolve");
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_false(cap.is_negative, "0x34 after by-range must be accepted");
+    size_t total = drain_stream(out, sizeof(out), NULL);
+
+    zassert_equal(total, expected_len, "window covers the whole boot");
+    zassert_mem_equal(out, expected, expected_len, "window stream mismatch");
+    send_transfer_exit(2U);
+
+    /* Unknown boot -> -ENOENT -> conditions not correct. */
+    range_params(params, 99U, 0U, 1000U);
+    drive_selector(RID_BY_RANGE, params, sizeof(params));
+    zassert_equal(cap.neg_nrc, UDS_NRC_CONDITIONS_NOT_CORRECT,
+                  "missing boot -> ENOENT");
+
+    /* start after end -> -EINVAL -> out of range. */
+    range_params(params, 10U, 2000U, 1000U);
+    drive_selector(RID_BY_RANGE, params, sizeof(params));
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE,
+                  "inverted window -> out of range");
+}
+
 ZTEST(logdl, test_select_all_streams_whole_ring)
 {
     static uint8_t out[8 * 1024];
@@ -677,6 +854,277 @@ ZTEST(logdl, test_select_all_streams_whole_ring)
     zassert_equal(cap.resume_calls, 1, "select-all exit resumes the writer");
 }
 
+/* Offsets into the resume token (see the resume-token section of
+ * uds_log_download.c). */
+static const size_t TOKEN_VERSION_IDX = 1U;
+static const size_t TOKEN_SECTOR_ID_IDX = 6U;
+static const size_t TOKEN_BODY_OFF_IDX = 24U;
+
+/* A raw download broken off mid-stream resumes from the token the head
+ * checkpointed: the client keeps the body up to the token's offset, selects
+ * the rest with RID 0xF107 and appends it. */
+ZTEST(logdl, test_resumed_download_flow)
+{
+    static uint8_t out[8 * 1024];
+    uint8_t token[UDS_LOG_RESUME_TOKEN_LEN];
+    uint8_t mask[8] = {0xFFU};
+    size_t kept = 0U;
+
+    select_all();
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 64U, 12U);
+    zassert_false(cap.is_negative, "0x34 must be accepted");
+    for (uint8_t seq = 1U; seq <= 3U; ++seq) {
+        send_transfer_data(seq, 3U);
+        zassert_false(cap.is_negative, "0x36 #%u", seq);
+        size_t off = (1U == seq) ? LOG_HEADER_BYTES : 0U;
+
+        (void)memcpy(&out[kept], &cap.resp[2U + off], cap.resp_len - 2U - off);
+        kept += cap.resp_len - 2U - off;
+    }
+
+    /* Block 3 never reached the client: the token points at its start. */
+    zassert_true(UDS_LogDownload_FillResumeToken(token, sizeof(token)));
+    zassert_false(UDS_LogDownload_FillResumeToken(token, sizeof(token) - 1U));
+    kept = (size_t)token[TOKEN_BODY_OFF_IDX] |
+           ((size_t)token[TOKEN_BODY_OFF_IDX + 1U] << 8);
+    zassert_equal(kept, (64U - LOG_HEADER_BYTES) + 64U,
+                  "the token resumes at block 3");
+
+    send_routine(RID_RESUME, token, sizeof(token) - 1U);
+    zassert_equal(cap.neg_nrc, UDS_NRC_INCORRECT_MSG_LEN);
+    token[TOKEN_VERSION_IDX] += 1U;
+    send_routine(RID_RESUME, token, sizeof(token));
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE, "unknown version");
+    token[TOKEN_VERSION_IDX] -= 1U;
+    token[TOKEN_SECTOR_ID_IDX] += 1U;
+    send_routine(RID_RESUME, token, sizeof(token));
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE, "recycled sector");
+    token[TOKEN_SECTOR_ID_IDX] -= 1U;
+
+    send_routine(RID_RESUME, token, sizeof(token));
+    zassert_false(cap.is_negative, "a live token must resolve");
+    send_routine(RID_BEGIN_STREAM, mask, sizeof(mask));
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE,
+                  "a resumed stream cannot be filtered");
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_false(cap.is_negative, "0x34 after resume must be accepted");
+    kept += drain_stream(&out[kept], sizeof(out) - kept, NULL);
+
+    zassert_equal(kept, expected_len, "resumed %zu, expected %zu",
+                  kept, expected_len);
+    zassert_mem_equal(out, expected, expected_len, "resumed body mismatch");
+    send_transfer_exit(2U);
+
+    /* A filtered stream leaves no checkpoint. */
+    select_all();
+    send_routine(RID_BEGIN_STREAM, mask, sizeof(mask));
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    send_transfer_data(1U, 3U);
+    zassert_false(cap.is_negative);
+    zassert_false(UDS_LogDownload_FillResumeToken(token, sizeof(token)));
+}
+
+/* Reference inflate of the flash_log_lz.h bit stream (independent of the
+ * compressor implementation). */
+static size_t lz_inflate(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    size_t bit = 0U;
+    size_t total = len * 8U;
+    size_t out = 0U;
+
+    while ((bit + 1U) <= total) {
+        bool literal = ((src[bit / 8U] >> (7U - (bit % 8U))) & 1U) != 0U;
+        size_t width = literal ? 8U : (FL_LZ_WINDOW_BITS + FL_LZ_LENGTH_BITS);
+        uint32_t value = 0U;
+
+        if ((bit + 1U + width) > total) {
+            break;   /* zero padding of the final byte */
+        }
+        ++bit;
+        for (size_t i = 0U; i < width; ++i, ++bit) {
+            value = (value << 1) | ((src[bit / 8U] >> (7U - (bit % 8U))) & 1U);
+        }
+        if (literal) {
+            zassert_true(out < cap, "inflate overflow");
+            dst[out++] = (uint8_t)value;
+        } else {
+            size_t dist = (value >> FL_LZ_LENGTH_BITS) + 1U;
+            size_t run = (value & ((1U << FL_LZ_LENGTH_BITS) - 1U)) + FL_LZ_MIN_MATCH;
+
+            zassert_true(dist <= out, "backref before stream start");
+            zassert_true((out + run) <= cap, "inflate overflow");
+            for (size_t i = 0U; i < run; ++i, ++out) {
+                dst[out] = dst[out - dist];
+            }
+        }
+    }
+    return out;
+}
+
+/* An 8-byte record-type mask on begin-stream keeps only the selected types
+ * (markers always pass), drops unselected containers, and is echoed in the
+ * header's mask extension. */
+ZTEST(logdl, test_filtered_download_flow)
+{
+    static uint8_t out[8 * 1024];
+    static uint8_t want[8 * 1024];
+    const uint64_t mask = 1ULL << FL_TYPE_PID_SNAPSHOT;
+    uint8_t params[9] = {0};
+    size_t want_len = 0U;
+
+    for (size_t i = 0U; i < HDR_MASK_BYTES; ++i) {
+        params[i] = (uint8_t)(mask >> (8U * i));
+    }
+
+    /* Only the bare form and the 8-byte mask are accepted. */
+    select_latest_boot();
+    send_routine(RID_BEGIN_STREAM, params, sizeof(params));
+    zassert_equal(cap.neg_nrc, UDS_NRC_INCORRECT_MSG_LEN,
+                  "a 9-byte mask is malformed");
+    zassert_equal(cap.pause_calls, 0, "a rejected mask leaves the writer live");
+
+    send_routine(RID_BEGIN_STREAM, params, HDR_MASK_BYTES);
+    zassert_false(cap.is_negative, "begin-stream with a mask must succeed");
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_false(cap.is_negative, "0x34 must be accepted");
+
+    size_t total = drain_stream(out, sizeof(out), NULL);
+
+    zassert_equal(drained_header[HDR_FLAGS_IDX], HDR_FLAG_FILTERED,
+                  "header flags the filtered stream");
+    zassert_mem_equal(&drained_header[LOG_HEADER_BYTES], params, HDR_MASK_BYTES,
+                      "header echoes the mask");
+
+    /* The fixture's consensus entry and its (malformed) legacy container are
+     * dropped; every marker and the PID snapshot remain. */
+    for (size_t off = 0U; off < expected_len;) {
+        fl_entry_hdr_t hdr;
+
+        (void)memcpy(&hdr, &expected[off], sizeof(hdr));
+        size_t rec = sizeof(hdr) + hdr.length;
+
+        if ((FL_TYPE_CONSENSUS != hdr.type) && (FL_TYPE_BATCH != hdr.type)) {
+            (void)memcpy(&want[want_len], &expected[off], rec);
+            want_len += rec;
+        }
+        off += rec;
+    }
+    zassert_equal(total, want_len, "streamed %zu, expected %zu", total, want_len);
+    zassert_mem_equal(out, want, want_len, "filtered body mismatch");
+}
+
+/* BeginStream with a mask and a bucket length decimates the filtered stream.
+ * The fixture's consensus entry has no well-formed payload to fold, so the
+ * aggregator drops it and no aggregate is due; the body is the filtered one. */
+ZTEST(logdl, test_decimated_download_flow)
+{
+    static uint8_t out[8 * 1024];
+    static uint8_t want[8 * 1024];
+    const uint64_t mask = (1ULL << FL_TYPE_PID_SNAPSHOT) |
+                          (1ULL << FL_TYPE_CONSENSUS);
+    static const uint16_t bad_buckets[] = { 0U, 3601U };
+    uint8_t params[10] = {0};
+    size_t want_len = 0U;
+
+    for (size_t i = 0U; i < HDR_MASK_BYTES; ++i) {
+        params[i] = (uint8_t)(mask >> (8U * i));
+    }
+
+    /* The bucket is 1 s .. 1 h. */
+    select_latest_boot();
+    for (size_t i = 0U; i < ARRAY_SIZE(bad_buckets); ++i) {
+        params[8] = (uint8_t)bad_buckets[i];
+        params[9] = (uint8_t)(bad_buckets[i] >> 8U);
+        send_routine(RID_BEGIN_STREAM, params, sizeof(params));
+        zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE,
+                      "bucket %u s is out of range", bad_buckets[i]);
+    }
+    zassert_equal(cap.pause_calls, 0, "a rejected bucket leaves the writer live");
+
+    params[8] = 10U;
+    params[9] = 0U;
+    send_routine(RID_BEGIN_STREAM, params, sizeof(params));
+    zassert_false(cap.is_negative, "begin-stream with a bucket must succeed");
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_false(cap.is_negative, "0x34 must be accepted");
+
+    size_t total = drain_stream(out, sizeof(out), NULL);
+
+    zassert_equal(drained_header[HDR_FLAGS_IDX],
+                  HDR_FLAG_FILTERED | HDR_FLAG_DECIMATED,
+                  "header flags the decimated stream");
+    zassert_mem_equal(&drained_header[LOG_HEADER_BYTES], params, HDR_MASK_BYTES,
+                      "header echoes the mask");
+
+    for (size_t off = 0U; off < expected_len;) {
+        fl_entry_hdr_t hdr;
+
+        (void)memcpy(&hdr, &expected[off], sizeof(hdr));
+        size_t rec = sizeof(hdr) + hdr.length;
+
+        if ((FL_TYPE_CONSENSUS != hdr.type) && (FL_TYPE_BATCH != hdr.type)) {
+            (void)memcpy(&want[want_len], &expected[off], rec);
+            want_len += rec;
+        }
+        off += rec;
+    }
+    zassert_equal(total, want_len, "streamed %zu, expected %zu", total, want_len);
+    zassert_mem_equal(out, want, want_len, "decimated body mismatch");
+    send_transfer_exit(2U);
+    zassert_false(cap.is_negative, "0x37 after decimated stream");
+}
+
+/* dataFormatIdentifier 0x10 selects the compressed body: the header flags it
+ * and carries the codec parameters, and the body inflates to exactly the raw
+ * TLV stream — at both the full and the minimum block size. */
+ZTEST(logdl, test_compressed_download_flow)
+{
+    static uint8_t packed_body[8 * 1024];
+    static uint8_t plain[8 * 1024];
+    static const uint32_t blocks[] = { 0U, 8U };
+
+    for (size_t b = 0U; b < ARRAY_SIZE(blocks); ++b) {
+        select_latest_boot();
+        begin_stream();
+        send_request_download_fmt(DATA_FMT_LZ, ADDR_LEN_FMT, SENTINEL_ADDR,
+                                  blocks[b], 12U);
+        zassert_false(cap.is_negative, "compressed 0x34 accepted");
+
+        size_t packed_len = drain_stream(packed_body, sizeof(packed_body), NULL);
+
+        zassert_equal(drained_header[HDR_FLAGS_IDX], 0x01U,
+                      "header flags the LZ body");
+        zassert_equal(drained_header[HDR_CODEC_IDX], FL_LZ_PARAMS,
+                      "header carries the codec parameters");
+        zassert_true(packed_len < expected_len,
+                     "compressed body %zu not smaller than raw %zu",
+                     packed_len, expected_len);
+
+        size_t n = lz_inflate(packed_body, packed_len, plain, sizeof(plain));
+
+        zassert_equal(n, expected_len, "inflated %zu, expected %zu", n,
+                      expected_len);
+        zassert_mem_equal(plain, expected, expected_len,
+                          "inflated body mismatch");
+
+        send_transfer_exit(2U);
+        zassert_false(cap.is_negative, "0x37 after compressed stream");
+    }
+
+    /* A raw download afterwards is unaffected by the arena contents. */
+    select_latest_boot();
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    size_t raw_len = drain_stream(plain, sizeof(plain), NULL);
+
+    zassert_equal(drained_header[HDR_FLAGS_IDX], 0U, "raw stream flags clear");
+    zassert_equal(drained_header[HDR_CODEC_IDX], 0U, "raw stream codec byte 0");
+    zassert_equal(raw_len, expected_len, "raw stream after compressed");
+    zassert_mem_equal(plain, expected, expected_len, "raw body after compressed");
+}
+
 ZTEST(logdl, test_small_block_slicing)
 {
     static uint8_t out[8 * 1024];
@@ -711,12 +1159,87 @@ ZTEST(logdl, test_block_negotiation_midrange)
     uint16_t block = (uint16_t)(((uint16_t)cap.resp[2] << 8) | cap.resp[3]);
     zassert_equal(block, 100U, "mid-range request honoured verbatim");
 
-    /* A req_max at/above the full block cap falls back to the full block. */
+    /* A req_max at the full block cap gets exactly the full block. */
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR,
+                          UDS_MAX_RESPONSE_LENGTH - 3U, 12U);
+    zassert_false(cap.is_negative, "0x34 (at-cap) accepted");
+    block = (uint16_t)(((uint16_t)cap.resp[2] << 8) | cap.resp[3]);
+    zassert_equal(block, UDS_MAX_RESPONSE_LENGTH - 3U,
+                  "at-cap request gets the full block");
+
+    /* Beyond it the client is offered an extended-length block, clamped to
+     * the free arena and the 12-bit ISO-TP length. */
     send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 50000U, 12U);
     zassert_false(cap.is_negative, "0x34 (over-cap) accepted");
     block = (uint16_t)(((uint16_t)cap.resp[2] << 8) | cap.resp[3]);
-    zassert_equal(block, UDS_MAX_RESPONSE_LENGTH - 3U,
-                  "over-cap request clamped to the full block");
+    zassert_true(block > (UDS_MAX_RESPONSE_LENGTH - 3U),
+                 "over-cap request gets an extended block");
+    zassert_true(block <= (ISOTP_EXT_MAX_PAYLOAD - 2U),
+                 "extended block fits one ISO-TP message");
+    zassert_true(block <= MAINT_ARENA_SIZE, "extended block fits the arena");
+}
+
+/* An extended-length download streams the same bytes in fewer, larger 0x36
+ * blocks, each sent from the arena instead of response_buffer. */
+ZTEST(logdl, test_extended_block_download_flow)
+{
+    static uint8_t out[8 * 1024];
+    int std_chunks = 0;
+    int ext_chunks = 0;
+
+    select_latest_boot();
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    (void)drain_stream(out, sizeof(out), &std_chunks);
+    send_transfer_exit(2U);
+    zassert_equal(cap.ext_send_calls, 0, "standard blocks use response_buffer");
+
+    select_latest_boot();
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 1500U, 12U);
+    zassert_false(cap.is_negative, "0x34 (extended) accepted");
+    uint16_t block = (uint16_t)(((uint16_t)cap.resp[2] << 8) | cap.resp[3]);
+    zassert_equal(block, 1500U, "in-range extended request honoured verbatim");
+
+    int sends_before = cap.send_calls;
+    size_t total = drain_stream(out, sizeof(out), &ext_chunks);
+
+    zassert_equal(total, expected_len, "streamed %zu, expected %zu",
+                  total, expected_len);
+    zassert_mem_equal(out, expected, expected_len, "extended stream body");
+    zassert_equal(cap.send_calls, sends_before,
+                  "no 0x36 block goes through response_buffer");
+    zassert_equal(cap.ext_send_calls, ext_chunks + 1,
+                  "every block (and the terminator) is sent from the arena");
+    zassert_true(ext_chunks < std_chunks, "%d extended vs %d standard blocks",
+                 ext_chunks, std_chunks);
+    send_transfer_exit(2U);
+}
+
+/* A 0x36 that arrives while the previous extended block is still being sent
+ * from the arena is told to retry; leaving the stream drops the block. */
+ZTEST(logdl, test_extended_block_busy_and_abort)
+{
+    select_latest_boot();
+    begin_stream();
+    send_request_download(ADDR_LEN_FMT, SENTINEL_ADDR, 1024U, 12U);
+    zassert_false(cap.is_negative, "0x34 (extended) accepted");
+
+    send_transfer_data(1U, 3U);
+    zassert_false(cap.is_negative, "first extended block served");
+
+    cap.ext_pending = true;
+    send_transfer_data(2U, 3U);
+    zassert_true(cap.is_negative, "block still in flight");
+    zassert_equal(cap.neg_nrc, NRC_BUSY_REPEAT, "busyRepeatRequest");
+
+    cap.ext_pending = false;
+    send_transfer_data(2U, 3U);
+    zassert_false(cap.is_negative, "retried sequence number is accepted");
+
+    send_transfer_exit(2U);
+    zassert_equal(cap.ext_abort_calls, 1,
+                  "leaving the stream drops any block still in flight");
 }
 
 ZTEST(logdl, test_transfer_seq_wraps_past_255)
@@ -751,6 +1274,14 @@ ZTEST(logdl, test_request_download_guards)
     /* Wrong addressAndLengthFormatIdentifier. */
     send_request_download(0x11U, SENTINEL_ADDR, 0U, 12U);
     zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE, "0x34 fmt NRC");
+
+    /* Unsupported compression or any encryption method. */
+    send_request_download_fmt(0x20U, ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE,
+                  "0x34 unknown compression NRC");
+    send_request_download_fmt(0x11U, ADDR_LEN_FMT, SENTINEL_ADDR, 0U, 12U);
+    zassert_equal(cap.neg_nrc, UDS_NRC_REQUEST_OUT_OF_RANGE,
+                  "0x34 encryption NRC");
 }
 
 ZTEST(logdl, test_transfer_data_guards)
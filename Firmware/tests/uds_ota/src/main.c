@@ -5,7 +5,7 @@
  * Exercises the session-control + OTA service handlers without a real flash
  * backend. All flash_*, flash_img_*, boot_* and sys_reboot symbols are wrapped
  * so the test fixture controls success / failure / payload. Responses are
- * captured by wrapping ISOTP_Send.
+ * captured by wrapping ISOTP_Reply.
  */
 
 #include <zephyr/ztest.h>
@@ -30,6 +30,7 @@
 #include "calibration.h"
 #include "runtime_settings.h"
 #include "maintenance_arena.h"
+#include "external_flash.h"
 
 /* ---- Controllable stubs for symbols uds.c references ----
  *
@@ -54,6 +55,7 @@ static struct {
     int factory_restore_async_calls;
     int factory_capture_async_calls;
     int flash_mass_erase_rc;
+    bool long_op;
 } uds_stub;
 
 static const char * const TEST_SETTING_OPTIONS[] = {
@@ -176,6 +178,7 @@ ssize_t z_impl_hwinfo_get_device_id(uint8_t *buffer, size_t length)
 int error_histogram_clear(void) { return uds_stub.histogram_clear_rc; }
 void error_histogram_pause(void) { }
 void error_histogram_resume(void) { }
+void latency_trace_clear(void) { }
 
 /* uds_ota.c / uds.c reference these but the test doesn't exercise the log-push
  * or autotune subsystems; empty stubs keep the linker happy (int used for the
@@ -208,7 +211,7 @@ int flash_mass_erase_external(void) { return uds_stub.flash_mass_erase_rc; }
 
 void heartbeat_set_long_op(bool in_progress)
 {
-    ARG_UNUSED(in_progress);
+    uds_stub.long_op = in_progress;
 }
 
 /* factory_image_* are referenced by uds.c's OTA write-DID handlers
@@ -263,6 +266,7 @@ typedef struct {
     int  close_calls;
     int  read_calls;
     int  erase_calls;
+    int  long_op_erase_calls;
 } flash_stub_t;
 
 static flash_stub_t flash_stub;
@@ -277,6 +281,7 @@ typedef struct {
     int  flash_img_buffered_write_rc;
     bool last_flush_flag;
     size_t bytes_written_total;
+    uint8_t last_write_first_byte;
     int  flash_img_check_calls;
     int  flash_img_check_rc;
     int  boot_read_bank_header_calls;
@@ -346,6 +351,9 @@ int __wrap_flash_area_erase(const struct flash_area *fa, off_t off, size_t size)
     } else {
         memset(&flash_stub.buffer[off], 0xFF, size);
         flash_stub.erase_calls++;
+        if (uds_stub.long_op) {
+            flash_stub.long_op_erase_calls++;
+        }
     }
     return rc;
 }
@@ -366,6 +374,7 @@ int __wrap_flash_img_buffered_write(struct flash_img_context *ctx,
     ota_stub.last_flush_flag = flush;
     if ((NULL != data) && (len > 0U)) {
         ota_stub.bytes_written_total += len;
+        ota_stub.last_write_first_byte = data[0];
     }
     return ota_stub.flash_img_buffered_write_rc;
 }
@@ -427,9 +436,9 @@ FUNC_NORETURN void __wrap_sys_reboot(int type)
     }
 }
 
-int __wrap_ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *buf, uint16_t len)
+int __wrap_ISOTP_Reply(ISOTPReply_t *to, const uint8_t *buf, uint16_t len)
 {
-    ARG_UNUSED(ctx);
+    ARG_UNUSED(to);
     ota_stub.isotp_send_calls++;
     if (len <= sizeof(ota_stub.captured_response)) {
         memcpy(ota_stub.captured_response, buf, len);
@@ -441,7 +450,7 @@ int __wrap_ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *buf, uint16_t len)
 /* ---- Test helpers ---- */
 
 static UDSContext_t test_ctx;
-static ISOTPContext_t test_isotp_ctx;
+static ISOTPReply_t test_reply;
 
 static void set_ambient_pressure_mbar(uint16_t mbar)
 {
@@ -591,6 +600,9 @@ static void populate_slot1_image_with_leading_tlv(void)
 static void test_setup(void *fixture)
 {
     ARG_UNUSED(fixture);
+    /* A previous test may have left blocks queued for the slot1 writer;
+     * let them land before the stubs they report into are cleared. */
+    UDS_OTA_DrainWriterForTest();
     memset(&flash_stub, 0, sizeof(flash_stub));
     memset(&ota_stub, 0, sizeof(ota_stub));
     memset(&uds_stub, 0, sizeof(uds_stub));
@@ -604,7 +616,7 @@ static void test_setup(void *fixture)
     UDS_OTA_Reset();
 
     /* Fresh UDS context starts in DEFAULT session at surface ambient. */
-    UDS_Init(&test_ctx, &test_isotp_ctx);
+    UDS_Init(&test_ctx, &test_reply);
     set_ambient_pressure_mbar(1013U);
 }
 
@@ -614,7 +626,7 @@ ZTEST(uds_core_reads, test_entry_point_guards_and_session_timeout)
 {
     uint8_t request[] = {0x00U, 0x99U};
 
-    UDS_Init(NULL, &test_isotp_ctx);
+    UDS_Init(NULL, &test_reply);
     UDS_ProcessRequest(NULL, request, sizeof(request));
     UDS_ProcessRequest(&test_ctx, NULL, sizeof(request));
     UDS_ProcessRequest(&test_ctx, request, 0U);
@@ -626,7 +638,7 @@ ZTEST(uds_core_reads, test_entry_point_guards_and_session_timeout)
     UDS_SendNegativeResponse(&no_transport, 0x99U,
                  UDS_NRC_SERVICE_NOT_SUPPORTED);
     UDS_SendResponse(&no_transport);
-    no_transport.isotp_context = &test_isotp_ctx;
+    no_transport.reply = &test_reply;
     UDS_SendResponse(&no_transport);
 
     test_ctx.session = UDS_SESSION_PROGRAMMING;
@@ -635,6 +647,29 @@ ZTEST(uds_core_reads, test_entry_point_guards_and_session_timeout)
     zassert_equal(test_ctx.session, UDS_SESSION_DEFAULT);
 }
 
+ZTEST(uds_core_reads, test_idle_session_lapses_between_requests)
+{
+    uint32_t deadline = 0U;
+
+    zassert_false(UDS_SessionDeadline(&test_ctx, &deadline));
+
+    test_ctx.session = UDS_SESSION_PROGRAMMING;
+    test_ctx.last_activity_ms = 1000U;
+    zassert_true(UDS_SessionDeadline(&test_ctx, &deadline));
+
+    /* Polling is not activity: the session survives up to its deadline and
+     * lapses on it, with no request in between. */
+    UDS_PollSession(&test_ctx, deadline - 1U);
+    zassert_equal(test_ctx.session, UDS_SESSION_PROGRAMMING);
+    zassert_equal(test_ctx.last_activity_ms, 1000U);
+    UDS_PollSession(&test_ctx, deadline);
+    zassert_equal(test_ctx.session, UDS_SESSION_DEFAULT);
+    zassert_false(UDS_SessionDeadline(&test_ctx, &deadline));
+
+    UDS_PollSession(NULL, 0U);
+    zassert_false(UDS_SessionDeadline(NULL, &deadline));
+}
+
 ZTEST(uds_core_reads, test_exact_identifier_reads)
 {
     const uint16_t dids[] = {
@@ -952,7 +987,7 @@ ZTEST(uds_ota_session, test_session_boundary_1200_strict_gt)
               "1200 mbar must allow programming");
 
     /* 1201 mbar must refuse. */
-    UDS_Init(&test_ctx, &test_isotp_ctx);
+    UDS_Init(&test_ctx, &test_reply);
     memset(&ota_stub, 0, sizeof(ota_stub));
     set_ambient_pressure_mbar(1201U);
     send_uds(UDS_SID_DIAG_SESSION_CTRL, body, sizeof(body));
@@ -1051,6 +1086,8 @@ ZTEST(uds_ota_request_download, test_accepted_in_programming_at_surface)
               OTA_DOWNLOAD_LENGTH_FMT, "length format");
     zassert_equal(ota_stub.flash_img_init_id_calls, 1,
               "stream init must run");
+    zassert_equal(flash_stub.erase_calls, 0,
+              "erase-ahead: 0x34 leaves the erase to the writer");
 }
 
 ZTEST(uds_ota_request_download, test_refused_during_dive)
@@ -1167,13 +1204,25 @@ ZTEST(uds_ota_request_download, test_maintenance_arena_ownership_contract)
 ZTEST(uds_ota_request_download, test_erase_failure_releases_arena)
 {
     uint8_t body[10];
+    uint8_t block[32] = {1U};
 
     enter_programming();
     flash_stub.erase_rc = -EIO;
     build_download_body(body, 1024U);
     send_uds(UDS_SID_REQUEST_DOWNLOAD, body, sizeof(body));
+    zassert_equal(ota_stub.captured_response[0],
+              UDS_SID_REQUEST_DOWNLOAD + 0x40U,
+              "erase-ahead: 0x34 does not touch the NOR");
 
+    /* The writer's erase for the first block fails; nothing is
+     * programmed onto the unerased sector and the transfer cannot exit. */
+    send_uds(UDS_SID_TRANSFER_DATA, block, sizeof(block));
+    UDS_OTA_DrainWriterForTest();
+    send_uds(UDS_SID_REQUEST_TRANSFER_EXIT, NULL, 0U);
     zassert_equal(ota_stub.captured_response[2], UDS_NRC_GENERAL_PROG_FAIL);
+    zassert_equal(ota_stub.flash_img_buffered_write_calls, 0);
+
+    UDS_OTA_Reset();
     zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_FACTORY),
              "OTA claim leaked after erase failure");
     maint_arena_release(MAINT_ARENA_OWNER_FACTORY);
@@ -1224,6 +1273,7 @@ ZTEST(uds_ota_transfer_data, test_first_block_seq_1_accepted)
               "positive response SID");
     zassert_equal(ota_stub.captured_response[1], 1U,
               "seq echo");
+    UDS_OTA_DrainWriterForTest();
     zassert_equal(ota_stub.flash_img_buffered_write_calls, 1,
               "must stream the data");
     zassert_equal(ota_stub.bytes_written_total, 63U,
@@ -1259,6 +1309,7 @@ ZTEST(uds_ota_transfer_data, test_seq_increments_modulo_256)
         zassert_equal(ota_stub.captured_response[1], s,
                   "seq %u echoed", s);
     }
+    UDS_OTA_DrainWriterForTest();
     zassert_equal(ota_stub.flash_img_buffered_write_calls, 3,
               "three blocks streamed");
 }
@@ -1286,9 +1337,104 @@ ZTEST(uds_ota_transfer_data, test_short_and_write_failure_refused)
     zassert_equal(ota_stub.captured_response[2],
               UDS_NRC_INCORRECT_MSG_LEN);
 
+    /* The failing block is already acknowledged when it reaches the NOR;
+     * the failure refuses the next block, whose seq stays unconsumed. */
     ota_stub.flash_img_buffered_write_rc = -EIO;
     send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+    zassert_equal(ota_stub.captured_response[0], UDS_SID_TRANSFER_DATA + 0x40U);
+    UDS_OTA_DrainWriterForTest();
+
+    body[0] = 2U;
+    send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
     zassert_equal(ota_stub.captured_response[2], UDS_NRC_GENERAL_PROG_FAIL);
+    send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+    zassert_equal(ota_stub.captured_response[2], UDS_NRC_GENERAL_PROG_FAIL,
+              "the failure stays latched");
+    zassert_equal(ota_stub.flash_img_buffered_write_calls, 1,
+              "nothing is written after the failure");
+
+    send_uds(UDS_SID_REQUEST_TRANSFER_EXIT, NULL, 0U);
+    zassert_equal(ota_stub.captured_response[2], UDS_NRC_GENERAL_PROG_FAIL,
+              "0x37 must not complete a transfer with a hole in slot1");
+    zassert_false(ota_stub.last_flush_flag, "no flush after a failed write");
+}
+
+ZTEST(uds_ota_transfer_data, test_blocks_acknowledged_before_programming)
+{
+    uint8_t body[32];
+
+    start_download(256U);
+    /* Hold the NOR so the writer cannot program: both staging slots fill,
+     * yet each block is acknowledged straight away. */
+    zassert_ok(external_flash_acquire(K_NO_WAIT));
+    for (uint8_t s = 1U; s <= 2U; ++s) {
+        body[0] = s;
+        memset(&body[1], 0x10U + s, sizeof(body) - 1U);
+        send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+        zassert_equal(ota_stub.captured_response[0],
+                  UDS_SID_TRANSFER_DATA + 0x40U);
+        zassert_equal(ota_stub.captured_response[1], s);
+    }
+    zassert_equal(ota_stub.flash_img_buffered_write_calls, 0,
+              "the NOR is held, nothing can be programmed yet");
+    external_flash_release();
+
+    UDS_OTA_DrainWriterForTest();
+    zassert_equal(ota_stub.flash_img_buffered_write_calls, 2);
+    zassert_equal(ota_stub.bytes_written_total, 62U);
+    zassert_equal(ota_stub.last_write_first_byte, 0x12U,
+              "blocks are programmed in arrival order");
+}
+
+ZTEST(uds_ota_transfer_data, test_erase_runs_ahead_of_writes)
+{
+    uint8_t body[32] = {1U};
+
+    start_download(SLOT1_FAKE_SIZE);
+    send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+    UDS_OTA_DrainWriterForTest();
+    zassert_equal(flash_stub.erase_calls, 1,
+              "one erase unit covers the first block");
+    zassert_equal(flash_stub.buffer[CONFIG_OTA_ERASE_AHEAD_UNIT - 1U], 0xFFU);
+    zassert_equal(flash_stub.buffer[CONFIG_OTA_ERASE_AHEAD_UNIT], 0x00U,
+              "nothing erased past the unit being written");
+
+    send_uds(UDS_SID_REQUEST_TRANSFER_EXIT, NULL, 0U);
+    zassert_equal(ota_stub.captured_response[0],
+              UDS_SID_REQUEST_TRANSFER_EXIT + 0x40U);
+    zassert_equal(flash_stub.erase_calls, 2);
+    zassert_equal(flash_stub.buffer[SLOT1_FAKE_SIZE - 1U], 0xFFU,
+              "0x37 erases the rest of slot1, trailer included");
+    zassert_equal(flash_stub.long_op_erase_calls, 1,
+              "the tail erase runs under the heartbeat long-op guard");
+    zassert_false(uds_stub.long_op, "long-op guard released after 0x37");
+}
+
+ZTEST(uds_ota_transfer_data, test_reset_with_blocks_queued)
+{
+    uint8_t body[32] = {1U};
+
+    start_download(256U);
+    zassert_ok(external_flash_acquire(K_NO_WAIT));
+    send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+    body[0] = 2U;
+    send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+    external_flash_release();
+
+    /* Session lapse / dive mid-transfer: the writer is waited out before the
+     * arena goes back, and the next download starts from seq 1. */
+    UDS_OTA_Reset();
+    zassert_not_null(maint_arena_claim(MAINT_ARENA_OWNER_FACTORY),
+             "OTA must hand the arena back on reset");
+    maint_arena_release(MAINT_ARENA_OWNER_FACTORY);
+
+    start_download(256U);
+    body[0] = 1U;
+    send_uds(UDS_SID_TRANSFER_DATA, body, sizeof(body));
+    zassert_equal(ota_stub.captured_response[0], UDS_SID_TRANSFER_DATA + 0x40U,
+              "a reset must not leave the writer latched");
+    UDS_OTA_DrainWriterForTest();
+    zassert_equal(ota_stub.flash_img_buffered_write_calls, 1);
 }
 
 ZTEST(uds_ota_transfer_data, test_unexpected_and_unknown_sid_refused)
@@ -1361,6 +1507,7 @@ ZTEST(uds_ota_transfer_exit, test_exit_flush_failure_refused)
 {
     start_download(64U);
     do_one_transfer(64U, 1U);
+    UDS_OTA_DrainWriterForTest();
     ota_stub.flash_img_buffered_write_rc = -EIO;
 
     send_uds(UDS_SID_REQUEST_TRANSFER_EXIT, NULL, 0U);
@@ -13,7 +13,7 @@
  *
  * MCUBoot APIs (boot_*), factory_image API, and firmware_confirm API are
  * all wrapped — see CMakeLists.txt. Responses are captured by wrapping
- * ISOTP_Send.
+ * ISOTP_Reply.
  */
 
 #include <zephyr/ztest.h>
@@ -42,6 +42,9 @@
 #include "device_current.h"
 #include "power_management.h"
 #include "error_histogram.h"
+#include "latency_trace.h"
+#include "i2c1_sched.h"
+#include "divecan_counters.h"
 #include "errors.h"
 #include "boot_history.h"
 #include "calibration.h"
@@ -89,6 +92,7 @@ static BootCrashRecord_t stub_crash_history[BOOT_HISTORY_DEPTH];
 static size_t stub_crash_history_count;
 static BootRebootRecord_t stub_reboot_history[BOOT_HISTORY_DEPTH];
 static size_t stub_reboot_history_count;
+static AnalogFilterStats_t stub_filter_stats;
 
 Numeric_t power_get_vbus_voltage(const struct device *dev)
 {
@@ -241,6 +245,50 @@ bool device_current_read(int32_t *out_ua, uint32_t *age_ms)
     return stub_current_valid;
 }
 
+/* The analog cell driver is not linked; cell 3 is the only analog cell. */
+bool analog_cell_filter_stats(uint8_t cell_number, AnalogFilterStats_t *out)
+{
+    bool found = (2U == cell_number) && (NULL != out);
+
+    if (found) {
+        *out = stub_filter_stats;
+    }
+    return found;
+}
+
+/* The i2c1 scheduler is not linked (it needs the i2c1 devicetree node);
+ * emit its header and a recognisable tank transfer count. */
+size_t i2c1_sched_serialise(uint8_t *buf, size_t size)
+{
+    size_t written = 0U;
+
+    if ((NULL != buf) && (size >= I2C1_SCHED_STATS_BYTES)) {
+        (void)memset(buf, 0, I2C1_SCHED_STATS_BYTES);
+        buf[0] = I2C1_SCHED_STATS_VERSION;
+        buf[1] = (uint8_t)I2C1_CLIENT_COUNT;
+        buf[2U + I2C1_SCHED_CLIENT_BYTES] = 7U;
+        written = I2C1_SCHED_STATS_BYTES;
+    }
+    return written;
+}
+
+/* The CAN send layer is not linked (it needs the CAN controller); emit its
+ * header and a recognisable high-water mark and sent count. */
+size_t divecan_send_serialise_stats(uint8_t *buf, size_t size)
+{
+    size_t written = 0U;
+
+    if ((NULL != buf) && (size >= DIVECAN_TX_STATS_BYTES)) {
+        (void)memset(buf, 0, DIVECAN_TX_STATS_BYTES);
+        buf[0] = DIVECAN_TX_STATS_VERSION;
+        buf[1] = 32U;
+        buf[3] = 11U;
+        buf[4] = 42U;
+        written = DIVECAN_TX_STATS_BYTES;
+    }
+    return written;
+}
+
 uint8_t ISOTP_TxQueue_GetPendingCount(void) { return 0U; }
 
 int flash_mass_erase_external(void) { return 0; }
@@ -474,9 +522,9 @@ uint32_t __wrap_firmware_confirm_get_pass_mask(void)
     return fx.fw_confirm_pass_mask;
 }
 
-int __wrap_ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *buf, uint16_t len)
+int __wrap_ISOTP_Reply(ISOTPReply_t *to, const uint8_t *buf, uint16_t len)
 {
-    ARG_UNUSED(ctx);
+    ARG_UNUSED(to);
     fx.isotp_send_calls++;
     if (len <= sizeof(fx.captured_response)) {
         (void)memcpy(fx.captured_response, buf, len);
@@ -488,7 +536,7 @@ int __wrap_ISOTP_Send(ISOTPContext_t *ctx, const uint8_t *buf, uint16_t len)
 /* ---- Test scaffolding ---- */
 
 static UDSContext_t test_ctx;
-static ISOTPContext_t test_isotp_ctx;
+static ISOTPReply_t test_reply;
 
 static void set_ambient_pressure_mbar(uint16_t mbar)
 {
@@ -561,6 +609,7 @@ static void test_setup(void *fixture)
     (void)memset(stub_crash_history, 0, sizeof(stub_crash_history));
     stub_reboot_history_count = 0U;
     (void)memset(stub_reboot_history, 0, sizeof(stub_reboot_history));
+    (void)memset(&stub_filter_stats, 0, sizeof(stub_filter_stats));
     reboot_escape_armed = false;
 
     /* Default: bank header reads succeed for slot0 (idx 0), fail for slot1
@@ -585,7 +634,7 @@ static void test_setup(void *fixture)
     fx.fw_confirm_state = POST_CONFIRMED;
     fx.fw_confirm_pass_mask = 0U;
 
-    UDS_Init(&test_ctx, &test_isotp_ctx);
+    UDS_Init(&test_ctx, &test_reply);
     set_ambient_pressure_mbar(1013U);
 }
 
@@ -1173,6 +1222,8 @@ ZTEST(uds_state_did_ota, test_pid_snapshot_dids)
     stub_control_snapshot.duty_cycle = 0.25f;
     stub_control_snapshot.integral_state = -0.75f;
     stub_control_snapshot.saturation_count = 0x1234U;
+    stub_control_snapshot.sample_to_consensus_us = 1500U;
+    stub_control_snapshot.sample_to_control_us = 0x00012345U;
 
     read_did(UDS_DID_DUTY_CYCLE);
     zassert_within(captured_float(), 0.25f, 0.001f);
@@ -1182,6 +1233,12 @@ ZTEST(uds_state_did_ota, test_pid_snapshot_dids)
 
     read_did(UDS_DID_SATURATION_COUNT);
     zassert_equal(captured_u16(), 0x1234U);
+
+    read_did(UDS_DID_SAMPLE_TO_CONSENSUS);
+    zassert_equal(captured_u32(), 1500U);
+
+    read_did(UDS_DID_SAMPLE_TO_CONTROL);
+    zassert_equal(captured_u32(), 0x00012345U);
 }
 
 ZTEST(uds_state_did_ota, test_autotune_status_and_short_buffer)
@@ -1393,6 +1450,67 @@ ZTEST(uds_state_did_ota, test_error_histogram_available_empty_and_short)
         UDS_DID_ERROR_HISTOGRAM, buf, sizeof(buf), &len));
 }
 
+ZTEST(uds_state_did_ota, test_i2c1_bus_stats_read)
+{
+    read_did(UDS_DID_I2C1_BUS_STATS);
+    zassert_equal(fx.captured_response_len, 3U + I2C1_SCHED_STATS_BYTES);
+    zassert_equal(fx.captured_response[3], I2C1_SCHED_STATS_VERSION);
+    zassert_equal(fx.captured_response[4], I2C1_CLIENT_COUNT);
+    zassert_equal(captured_le32_at(5U + I2C1_SCHED_CLIENT_BYTES), 7U,
+                  "tank client transfer count");
+
+    uint8_t buf[I2C1_SCHED_STATS_BYTES] = {0};
+    uint16_t len = 99U;
+    zassert_false(UDS_StateDID_HandleRead(
+        UDS_DID_I2C1_BUS_STATS, buf,
+        (uint16_t)(I2C1_SCHED_STATS_BYTES - 1U), &len));
+    zassert_equal(len, 0U);
+}
+
+ZTEST(uds_state_did_ota, test_can_tx_stats_read)
+{
+    read_did(UDS_DID_CAN_TX_STATS);
+    zassert_equal(fx.captured_response_len, 3U + DIVECAN_TX_STATS_BYTES);
+    zassert_equal(fx.captured_response[3], DIVECAN_TX_STATS_VERSION);
+    zassert_equal(fx.captured_response[4], 32U, "FIFO depth");
+    zassert_equal(fx.captured_response[6], 11U, "FIFO high-water mark");
+    zassert_equal(captured_le32_at(7U), 42U, "frames sent");
+
+    uint8_t buf[DIVECAN_TX_STATS_BYTES] = {0};
+    uint16_t len = 99U;
+    zassert_false(UDS_StateDID_HandleRead(
+        UDS_DID_CAN_TX_STATS, buf,
+        (uint16_t)(DIVECAN_TX_STATS_BYTES - 1U), &len));
+    zassert_equal(len, 0U);
+}
+
+ZTEST(uds_state_did_ota, test_latency_trace_read_and_clear)
+{
+    latency_trace_clear();
+    latency_trace_record(LATENCY_STAGE_SAMPLE_TO_CONSENSUS, 1500U);
+
+    read_did(UDS_DID_LATENCY_TRACE);
+    zassert_equal(fx.captured_response_len, 3U + LATENCY_SUMMARY_BYTES);
+    zassert_equal(fx.captured_response[3], LATENCY_SUMMARY_VERSION);
+    zassert_equal(fx.captured_response[4], LATENCY_STAGE_COUNT);
+    zassert_equal(captured_le32_at(5U), 1U, "sample → consensus count");
+    zassert_equal(captured_le32_at(9U), 1500U, "min");
+    zassert_equal(captured_le32_at(21U), 1500U, "max");
+
+    uint8_t buf[LATENCY_SUMMARY_BYTES] = {0};
+    uint16_t len = 99U;
+    zassert_false(UDS_StateDID_HandleRead(
+        UDS_DID_LATENCY_TRACE, buf,
+        (uint16_t)(LATENCY_SUMMARY_BYTES - 1U), &len));
+    zassert_equal(len, 0U);
+
+    write_did(UDS_DID_LATENCY_TRACE_CLEAR, 0x00U);
+    zassert_equal(fx.captured_response[0],
+                  UDS_SID_WRITE_DATA_BY_ID + 0x40U);
+    read_did(UDS_DID_LATENCY_TRACE);
+    zassert_equal(captured_le32_at(5U), 0U, "cleared");
+}
+
 ZTEST(uds_state_did_ota, test_digital_and_analog_cell_dids)
 {
     ConsensusMsg_t consensus = {
@@ -1491,3 +1609,44 @@ ZTEST(uds_state_did_ota, test_state_did_api_bounds_and_unknowns)
         UDS_DID_MCUBOOT_STATUS, buf, 1U, &len));
     zassert_equal(len, 0U);
 }
+
+ZTEST(uds_state_did_ota, test_analog_filter_stats_did)
+{
+    const uint16_t analog_base =
+        UDS_DID_CELL_BASE + (2U * UDS_DID_CELL_RANGE);
+
+    stub_filter_stats = (AnalogFilterStats_t){
+        .kind = ANALOG_FILTER_MEDIAN,
+        .taps = 5U,
+        .iir_shift = 2U,
+        .samples_in = 1000U,
+        .samples_out = 200U,
+        .sample_period_us = 31250U,
+        .input_noise_nv = 40000U,
+        .output_noise_nv = 22400U,
+        .noise_gain_permille = 560U,
+        .group_delay_dsamples = 20U,
+        .group_delay_us = 62500U,
+    };
+
+    read_did(analog_base + CELL_DID_FILTER_STATS);
+    zassert_equal(fx.captured_response_len, 3U + 32U);
+    zassert_equal(fx.captured_response[3], 1U, "layout version");
+    zassert_equal(fx.captured_response[4], ANALOG_FILTER_MEDIAN);
+    zassert_equal(fx.captured_response[5], 5U, "taps");
+    zassert_equal(fx.captured_response[6], 2U, "iir shift");
+    zassert_equal(captured_le32_at(7U), 1000U, "samples in");
+    zassert_equal(captured_le32_at(11U), 200U, "samples out");
+    zassert_equal(captured_le32_at(15U), 31250U, "period");
+    zassert_equal(captured_le32_at(19U), 40000U, "input noise");
+    zassert_equal(captured_le32_at(23U), 22400U, "output noise");
+    zassert_equal(fx.captured_response[27] | (fx.captured_response[28] << 8),
+                  560U, "noise gain");
+    zassert_equal(fx.captured_response[29] | (fx.captured_response[30] << 8),
+                  20U, "delay in tenths of a sample");
+    zassert_equal(captured_le32_at(31U), 62500U, "delay");
+
+    /* Digital cells have no filter stage. */
+    read_did(UDS_DID_CELL_BASE + CELL_DID_FILTER_STATS);
+    zassert_equal(fx.captured_response[0], UDS_SID_NEGATIVE_RESPONSE);
+}
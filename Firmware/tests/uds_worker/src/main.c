@@ -0,0 +1,254 @@
+/**
+ * @file main.c
+ * @brief UDS request worker unit tests
+ *
+ * Exercises uds_worker.c against stubbed UDS and ISO-TP TX queue layers:
+ * UDS_ProcessRequest() parks on a semaphore so a request can be held on the
+ * worker, and ISOTP_TxQueue_Enqueue() captures the NRCs the worker queues
+ * from the RX-thread side (0x21 busyRepeatRequest, 0x78 responsePending).
+ *
+ * UDS_Worker_Poll() takes the uptime as an argument, so the responsePending
+ * schedule is driven with synthetic timestamps rather than real sleeps.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "uds_worker.h"
+#include "uds.h"
+#include "isotp_tx_queue.h"
+#include "errors.h"
+
+/* uds_worker.c reports refused submits via OP_ERROR_DETAIL ->
+ * op_error_publish. This test does not link errors.c, so stub it. */
+void op_error_publish(OpError_t code, uint32_t detail)
+{
+    ARG_UNUSED(code);
+    ARG_UNUSED(detail);
+}
+
+/* ---- UDS stubs ---- */
+
+static K_SEM_DEFINE(handler_entered, 0, 1);
+static K_SEM_DEFINE(handler_release, 0, 1);
+static uint8_t served_sid;
+
+void UDS_Init(UDSContext_t *ctx, ISOTPReply_t *reply)
+{
+    (void)memset(ctx, 0, sizeof(*ctx));
+    ctx->reply = reply;
+}
+
+/** Hold the request until the test releases it, then answer it the way
+ *  ISOTP_Reply() would. */
+void UDS_ProcessRequest(UDSContext_t *ctx, const uint8_t *request_data,
+            uint16_t request_length)
+{
+    ARG_UNUSED(request_length);
+    served_sid = request_data[UDS_SID_IDX];
+    k_sem_give(&handler_entered);
+    (void)k_sem_take(&handler_release, K_FOREVER);
+    ISOTP_TxQueue_Lock();
+    ctx->reply->tx_complete = true;
+    ISOTP_TxQueue_Unlock();
+}
+
+void UDS_PollSession(UDSContext_t *ctx, uint32_t now)
+{
+    ARG_UNUSED(ctx);
+    ARG_UNUSED(now);
+}
+
+bool UDS_SessionDeadline(const UDSContext_t *ctx, uint32_t *deadline)
+{
+    ARG_UNUSED(ctx);
+    ARG_UNUSED(deadline);
+    return false;
+}
+
+/* ---- ISO-TP TX queue capture ---- */
+
+typedef struct {
+    DiveCANType_t source;
+    DiveCANType_t target;
+    uint32_t message_id;
+    uint8_t data[8];
+    uint16_t length;
+} CapturedTx_t;
+
+static CapturedTx_t last_tx;
+static uint32_t tx_count;
+
+bool ISOTP_TxQueue_Enqueue(DiveCANType_t source, DiveCANType_t target,
+               uint32_t message_id, const uint8_t *data,
+               uint16_t length)
+{
+    last_tx.source = source;
+    last_tx.target = target;
+    last_tx.message_id = message_id;
+    last_tx.length = length;
+    (void)memcpy(last_tx.data, data, MIN(length, sizeof(last_tx.data)));
+    tx_count++;
+    return true;
+}
+
+static K_MUTEX_DEFINE(tx_lock);
+
+void ISOTP_TxQueue_Lock(void)
+{
+    (void)k_mutex_lock(&tx_lock, K_FOREVER);
+}
+
+void ISOTP_TxQueue_Unlock(void)
+{
+    (void)k_mutex_unlock(&tx_lock);
+}
+
+/* ---- Helpers ---- */
+
+#define REQ_SID 0x2EU
+#define OTHER_SID 0x22U
+
+/** @brief A completed dialog context holding a 4-byte request for @p sid. */
+static ISOTPContext_t make_dialog(uint8_t sid, DiveCANType_t peer)
+{
+    ISOTPContext_t dialog = {0};
+
+    dialog.source = DIVECAN_SOLO;
+    dialog.target = peer;
+    dialog.message_id = MENU_ID;
+    dialog.rx_buffer[0] = 0x00U;
+    dialog.rx_buffer[UDS_SID_IDX] = sid;
+    dialog.rx_buffer[2] = 0xF2U;
+    dialog.rx_buffer[3] = 0x40U;
+    dialog.rx_data_length = 4U;
+    dialog.rx_complete = true;
+    return dialog;
+}
+
+/** @brief Let a held request finish and wait for the worker to go idle. */
+static void finish_request(void)
+{
+    k_sem_give(&handler_release);
+    for (uint32_t i = 0U; (i < 100U) && UDS_Worker_IsBusy(); ++i) {
+        k_msleep(1);
+    }
+    zassert_false(UDS_Worker_IsBusy(), "worker did not go idle");
+}
+
+static void *uds_worker_setup(void)
+{
+    UDS_Worker_Init();
+    return NULL;
+}
+
+static void uds_worker_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    k_sem_reset(&handler_entered);
+    k_sem_reset(&handler_release);
+    (void)memset(&last_tx, 0, sizeof(last_tx));
+    tx_count = 0U;
+    served_sid = 0U;
+}
+
+/** @brief Suite: request hand-off, busy refusal and responsePending. */
+ZTEST_SUITE(uds_worker, NULL, uds_worker_setup, uds_worker_before, NULL, NULL);
+
+/** @brief A submitted request runs on the worker, and no NRC is queued for it. */
+ZTEST(uds_worker, test_request_runs_on_worker)
+{
+    ISOTPContext_t dialog = make_dialog(REQ_SID, DIVECAN_CONTROLLER);
+
+    zassert_true(UDS_Worker_Submit(&dialog, 0U));
+    zassert_true(UDS_Worker_IsBusy());
+    zassert_ok(k_sem_take(&handler_entered, K_MSEC(100)),
+           "handler did not run");
+    zassert_equal(served_sid, REQ_SID);
+
+    finish_request();
+    zassert_equal(tx_count, 0U, "no NRC expected for a quick request");
+}
+
+/** @brief A request arriving while one is served is refused with NRC 0x21
+ *  addressed to its own requester. */
+ZTEST(uds_worker, test_busy_refused)
+{
+    ISOTPContext_t first = make_dialog(REQ_SID, DIVECAN_CONTROLLER);
+    ISOTPContext_t second = make_dialog(OTHER_SID, DIVECAN_MONITOR);
+
+    zassert_true(UDS_Worker_Submit(&first, 0U));
+    zassert_ok(k_sem_take(&handler_entered, K_MSEC(100)));
+
+    zassert_false(UDS_Worker_Submit(&second, 10U));
+    zassert_equal(tx_count, 1U);
+    zassert_equal(last_tx.length, 3U);
+    zassert_equal(last_tx.data[0], UDS_SID_NEGATIVE_RESPONSE);
+    zassert_equal(last_tx.data[1], OTHER_SID);
+    zassert_equal(last_tx.data[2], UDS_NRC_BUSY_REPEAT_REQUEST);
+    zassert_equal(last_tx.target, DIVECAN_MONITOR);
+
+    finish_request();
+    zassert_equal(served_sid, REQ_SID, "the refused request must not run");
+}
+
+/** @brief An unanswered request gets NRC 0x78 inside P2server and then every
+ *  UDS_RESPONSE_PENDING_REPEAT_MS, addressed to the original requester even
+ *  if the dialog is retargeted. */
+ZTEST(uds_worker, test_response_pending_schedule)
+{
+    const uint32_t t0 = 5000U;
+    const uint32_t first = t0 + UDS_RESPONSE_PENDING_FIRST_MS;
+    ISOTPContext_t dialog = make_dialog(REQ_SID, DIVECAN_CONTROLLER);
+    uint32_t due = 0U;
+
+    zassert_true(UDS_Worker_Submit(&dialog, t0));
+    zassert_ok(k_sem_take(&handler_entered, K_MSEC(100)));
+    dialog.target = DIVECAN_MONITOR;
+
+    zassert_true(UDS_Worker_NextDeadline(&due));
+    zassert_equal(due, first);
+    zassert_true((due - t0) < UDS_P2_SERVER_MS, "first 0x78 must beat P2server");
+
+    UDS_Worker_Poll(first - 1U);
+    zassert_equal(tx_count, 0U, "responsePending sent early");
+
+    UDS_Worker_Poll(first);
+    zassert_equal(tx_count, 1U);
+    zassert_equal(last_tx.data[0], UDS_SID_NEGATIVE_RESPONSE);
+    zassert_equal(last_tx.data[1], REQ_SID);
+    zassert_equal(last_tx.data[2], UDS_NRC_RESPONSE_PENDING);
+    zassert_equal(last_tx.target, DIVECAN_CONTROLLER);
+    zassert_equal(last_tx.message_id, MENU_ID);
+
+    zassert_true(UDS_Worker_NextDeadline(&due));
+    zassert_true((due - first) < UDS_P2_STAR_SERVER_MS,
+                 "0x78 must repeat within P2*server");
+    UDS_Worker_Poll(first + UDS_RESPONSE_PENDING_REPEAT_MS - 1U);
+    zassert_equal(tx_count, 1U, "responsePending repeated early");
+    UDS_Worker_Poll(first + UDS_RESPONSE_PENDING_REPEAT_MS);
+    zassert_equal(tx_count, 2U);
+
+    finish_request();
+}
+
+/** @brief Once the response is queued no further 0x78 is sent. */
+ZTEST(uds_worker, test_no_pending_after_response)
+{
+    uint32_t due = 0U;
+    ISOTPContext_t dialog = make_dialog(REQ_SID, DIVECAN_CONTROLLER);
+
+    zassert_true(UDS_Worker_Submit(&dialog, 0U));
+    zassert_ok(k_sem_take(&handler_entered, K_MSEC(100)));
+    finish_request();
+
+    zassert_false(UDS_Worker_NextDeadline(&due));
+    UDS_Worker_Poll(10U * UDS_RESPONSE_PENDING_REPEAT_MS);
+    zassert_equal(tx_count, 0U);
+
+    /* The worker takes the next request once idle */
+    zassert_true(UDS_Worker_Submit(&dialog, 0U));
+    zassert_ok(k_sem_take(&handler_entered, K_MSEC(100)));
+    finish_request();
+}
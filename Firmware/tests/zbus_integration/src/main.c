@@ -4,8 +4,8 @@
  *
  * Runs on native_sim with real zbus channels (chan_cell_1/2/3 and chan_consensus)
  * and the real consensus thread. Tests publish OxygenCellMsg_t values, wait
- * for at least one full consensus period so the timer-driven consensus thread
- * is guaranteed to have sampled all three publishes, then read back the
+ * longer than the minimum vote interval so the event-driven consensus thread
+ * is guaranteed to have voted on all three publishes, then read back the
  * resulting ConsensusMsg_t to assert correctness. This complements the
  * pure-math consensus unit tests by verifying the full inter-thread zbus wiring.
  */
@@ -13,9 +13,11 @@
 #include <zephyr/ztest.h>
 #include <zephyr/zbus/zbus.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 
 #include "oxygen_cell_types.h"
 #include "oxygen_cell_channels.h"
+#include "latency_trace.h"
 
 /* The consensus thread now reads chan_setpoint (for the hypoxic-setpoint alarm
  * threshold). In the real build that channel lives in divecan_channels.c, which
@@ -23,6 +25,22 @@
  * links. Seed 70 cb (normal setpoint) to match the production default. */
 ZBUS_CHAN_DEFINE(chan_setpoint, PPO2_t, NULL, NULL, ZBUS_OBSERVERS_EMPTY, 70);
 
+/* Minimum vote interval in consensus_subscriber.c, plus slack for the
+ * thread to run once the hold-off ends. */
+#define VOTE_SETTLE_MS 150
+
+/* Counts chan_consensus publishes, i.e. votes. */
+static atomic_t consensus_votes = ATOMIC_INIT(0);
+
+static void consensus_vote_cb(const struct zbus_channel *chan)
+{
+    ARG_UNUSED(chan);
+    (void)atomic_inc(&consensus_votes);
+}
+
+ZBUS_LISTENER_DEFINE(test_consensus_listener, consensus_vote_cb);
+ZBUS_CHAN_ADD_OBS(chan_consensus, test_consensus_listener, 5);
+
 /** @brief Suite: full zbus channel wiring from cell publishers to consensus subscriber. */
 ZTEST_SUITE(zbus_integration, NULL, NULL, NULL, NULL, NULL);
 
@@ -45,9 +63,9 @@ static OxygenCellMsg_t make_cell(uint8_t num, PPO2_t ppo2, double prec,
  * @brief Publish three cell messages and return the resulting consensus.
  *
  * Publishes to chan_cell_1, chan_cell_2, and chan_cell_3 in sequence, then
- * sleeps longer than one consensus period so the timer-driven consensus
- * thread is guaranteed to have sampled all three publishes at least once,
- * then reads back chan_consensus. All tests share this helper to avoid
+ * sleeps longer than the minimum vote interval so the consensus thread is
+ * guaranteed to have voted after all three publishes, then reads back
+ * chan_consensus. All tests share this helper to avoid
  * duplicating the publish/wait/read boilerplate.
  */
 static ConsensusMsg_t publish_and_read_consensus(OxygenCellMsg_t *c1,
@@ -58,9 +76,9 @@ static ConsensusMsg_t publish_and_read_consensus(OxygenCellMsg_t *c1,
     (void)zbus_chan_pub(&chan_cell_2, c2, K_MSEC(100));
     (void)zbus_chan_pub(&chan_cell_3, c3, K_MSEC(100));
 
-    /* Wait longer than one consensus period (100 ms) so the timer-driven
-     * consensus thread is guaranteed to recompute after all three publishes. */
-    k_msleep(150);
+    /* The first publish is voted at once; the other two land inside the
+     * minimum vote interval and are voted when it ends. */
+    k_msleep(VOTE_SETTLE_MS);
 
     ConsensusMsg_t result = {0};
 
@@ -133,7 +151,7 @@ ZTEST(zbus_integration, test_outlier_excluded)
 /**
  * @brief A cell whose channel read times out is flagged FAILED for that cycle.
  *
- * Claim chan_cell_1's mutex and hold it past a full consensus period so the
+ * Claim chan_cell_1's mutex and republish cell 2 so a vote runs while the
  * consensus thread's bounded (10 ms) read of cell 1 loses the mutex race —
  * exercising the read_cell_or_fail failure arm (mark CELL_FAIL / PPO2_FAIL).
  * Cells 2 and 3 stay readable and healthy, so the published consensus that
@@ -148,9 +166,11 @@ ZTEST(zbus_integration, test_cell_read_timeout_marks_failed)
 
     zassert_ok(zbus_chan_claim(&chan_cell_1, K_MSEC(100)),
                "test must be able to claim cell 1's channel");
-    /* Hold across ~2.5 consensus periods so at least one full cycle runs with
-     * cell 1 unreadable and publishes its result. */
-    k_msleep(250);
+    /* A cell 2 publish triggers a vote with cell 1 unreadable; hold until it
+     * has been published. */
+    c2.timestamp_ticks = k_uptime_ticks();
+    (void)zbus_chan_pub(&chan_cell_2, &c2, K_MSEC(100));
+    k_msleep(VOTE_SETTLE_MS);
 
     ConsensusMsg_t during = {0};
     (void)zbus_chan_read(&chan_consensus, &during, K_MSEC(100));
@@ -181,3 +201,108 @@ ZTEST(zbus_integration, test_arrays_populated)
     zassert_equal(result.status_array[1], CELL_OK);
     zassert_equal(result.status_array[2], CELL_OK);
 }
+
+/**
+ * @brief A lone publish after a quiet spell is voted at once and stamped.
+ *
+ * The vote must not wait for a timer tick: well inside the minimum vote
+ * interval the consensus already carries the new sample, with sample_ticks
+ * equal to that sample's timestamp and consensus_ticks no earlier.
+ */
+ZTEST(zbus_integration, test_publish_voted_immediately)
+{
+    OxygenCellMsg_t c1 = make_cell(0, 100, 1.0, CELL_OK);
+    OxygenCellMsg_t c2 = make_cell(1, 100, 1.0, CELL_OK);
+    OxygenCellMsg_t c3 = make_cell(2, 100, 1.0, CELL_OK);
+    (void)publish_and_read_consensus(&c1, &c2, &c3);
+    k_msleep(VOTE_SETTLE_MS);
+
+    OxygenCellMsg_t fresh = make_cell(0, 101, 1.01, CELL_OK);
+    LatencyStats_t before;
+    LatencyStats_t after;
+
+    fresh.sample_seq = latency_trace_next_seq();
+    latency_trace_stats(LATENCY_STAGE_SAMPLE_TO_CONSENSUS, &before);
+    (void)zbus_chan_pub(&chan_cell_1, &fresh, K_MSEC(100));
+    k_msleep(20);
+
+    ConsensusMsg_t result = {0};
+
+    (void)zbus_chan_read(&chan_consensus, &result, K_MSEC(100));
+    zassert_equal(result.ppo2_array[0], 101, "new sample voted without delay");
+    zassert_equal(result.sample_ticks, fresh.timestamp_ticks,
+                  "stamped with the triggering sample");
+    zassert_equal(result.sample_seq, fresh.sample_seq,
+                  "carries the triggering sample's sequence number");
+    zassert_true(result.consensus_ticks >= result.sample_ticks,
+                 "vote computed after the sample");
+
+    /* Traced once, however many idle re-votes follow. */
+    k_msleep(VOTE_SETTLE_MS);
+    latency_trace_stats(LATENCY_STAGE_SAMPLE_TO_CONSENSUS, &after);
+    zassert_equal(after.count, before.count + 1U,
+                  "one sample → consensus hop recorded");
+}
+
+/**
+ * @brief A newer sample from an excluded cell does not stamp the vote.
+ *
+ * Cell 1 publishes CELL_FAIL after the others: the vote leaves it out, so
+ * sample_ticks must stay on the newest included sample rather than report a
+ * latency for a reading that never reached consensus_ppo2.
+ */
+ZTEST(zbus_integration, test_excluded_cell_not_stamped)
+{
+    OxygenCellMsg_t c2 = make_cell(1, 100, 1.0, CELL_OK);
+    OxygenCellMsg_t c3 = make_cell(2, 100, 1.0, CELL_OK);
+    OxygenCellMsg_t c1 = make_cell(0, 100, 1.0, CELL_OK);
+    (void)publish_and_read_consensus(&c1, &c2, &c3);
+    k_msleep(VOTE_SETTLE_MS);
+
+    OxygenCellMsg_t failed = make_cell(0, 0, 0.0, CELL_FAIL);
+
+    (void)zbus_chan_pub(&chan_cell_1, &failed, K_MSEC(100));
+    k_msleep(VOTE_SETTLE_MS);
+
+    ConsensusMsg_t result = {0};
+
+    (void)zbus_chan_read(&chan_consensus, &result, K_MSEC(100));
+    zassert_false(result.include_array[0], "failed cell excluded");
+    zassert_true(failed.timestamp_ticks > c3.timestamp_ticks,
+                 "failed sample is the newest publish");
+    zassert_true(result.sample_ticks <= c3.timestamp_ticks,
+                 "stamped from an included cell, not the failed one");
+}
+
+/**
+ * @brief A burst of publishes is coalesced into at most two votes.
+ *
+ * Ten back-to-back cell 1 publishes: the first is voted at once (leading
+ * edge), the rest fold into one vote at the end of the minimum interval,
+ * which reads the last value.
+ */
+ZTEST(zbus_integration, test_burst_coalesced)
+{
+    OxygenCellMsg_t c1 = make_cell(0, 100, 1.0, CELL_OK);
+    OxygenCellMsg_t c2 = make_cell(1, 100, 1.0, CELL_OK);
+    OxygenCellMsg_t c3 = make_cell(2, 100, 1.0, CELL_OK);
+    (void)publish_and_read_consensus(&c1, &c2, &c3);
+    k_msleep(VOTE_SETTLE_MS);
+
+    atomic_val_t before = atomic_get(&consensus_votes);
+
+    for (PPO2_t ppo2 = 100U; ppo2 < 110U; ++ppo2) {
+        OxygenCellMsg_t c = make_cell(0, ppo2, (double)ppo2 / 100.0, CELL_OK);
+
+        (void)zbus_chan_pub(&chan_cell_1, &c, K_MSEC(100));
+    }
+    k_msleep(VOTE_SETTLE_MS);
+
+    ConsensusMsg_t result = {0};
+
+    (void)zbus_chan_read(&chan_consensus, &result, K_MSEC(100));
+    zassert_true((atomic_get(&consensus_votes) - before) <= 2,
+                 "burst coalesced (%ld votes)",
+                 (long)(atomic_get(&consensus_votes) - before));
+    zassert_equal(result.ppo2_array[0], 109, "last sample of the burst voted");
+}